@@ -16,7 +16,16 @@ onnxruntime_add_static_library(onnxruntime_mlas
   ${MLAS_SRC_DIR}/qgemm.cpp
   ${MLAS_SRC_DIR}/qdwconv.cpp
   ${MLAS_SRC_DIR}/convolve.cpp
+  ${MLAS_SRC_DIR}/convtranspose.cpp
   ${MLAS_SRC_DIR}/convsym.cpp
+  ${MLAS_SRC_DIR}/winograd.cpp
+  ${MLAS_SRC_DIR}/sconv_nhwc.cpp
+  ${MLAS_SRC_DIR}/fp16_convert.cpp
+  ${MLAS_SRC_DIR}/eltwise.cpp
+  ${MLAS_SRC_DIR}/layernorm.cpp
+  ${MLAS_SRC_DIR}/reduce.cpp
+  ${MLAS_SRC_DIR}/topk.cpp
+  ${MLAS_SRC_DIR}/fused_softmax.cpp
   ${MLAS_SRC_DIR}/pooling.cpp
   ${MLAS_SRC_DIR}/transpose.cpp
   ${MLAS_SRC_DIR}/reorder.cpp
@@ -157,6 +166,7 @@ function(setup_mlas_source_for_windows)
       ${MLAS_SRC_DIR}/qgemm_kernel_sse.cpp
       ${MLAS_SRC_DIR}/qgemm_kernel_sse41.cpp
       ${MLAS_SRC_DIR}/intrinsics/avx512/quantize_avx512f.cpp
+      ${MLAS_SRC_DIR}/intrinsics/avx512/eltwise_avx512f.cpp
       ${MLAS_SRC_DIR}/amd64/QgemmU8S8KernelAmx.asm
       ${MLAS_SRC_DIR}/amd64/QgemmU8S8KernelAvx2.asm
       ${MLAS_SRC_DIR}/amd64/QgemmU8U8KernelAvx2.asm
@@ -486,6 +496,7 @@ else()
           ${MLAS_SRC_DIR}/x86_64/SpoolKernelAvx.S
           ${MLAS_SRC_DIR}/x86_64/SoftmaxKernelAvx.S
           ${MLAS_SRC_DIR}/intrinsics/avx/min_max_elements.cpp
+          ${MLAS_SRC_DIR}/intrinsics/avx/eltwise_avx.cpp
         )
         set_source_files_properties(${mlas_platform_srcs_avx} PROPERTIES COMPILE_FLAGS "-mavx")
 
@@ -515,6 +526,7 @@ else()
           ${MLAS_SRC_DIR}/x86_64/SpoolKernelAvx512F.S
           ${MLAS_SRC_DIR}/x86_64/TransKernelAvx512F.S
           ${MLAS_SRC_DIR}/intrinsics/avx512/quantize_avx512f.cpp
+          ${MLAS_SRC_DIR}/intrinsics/avx512/eltwise_avx512f.cpp
         )
         set_source_files_properties(${mlas_platform_srcs_avx512f} PROPERTIES COMPILE_FLAGS "-mavx512f")
 
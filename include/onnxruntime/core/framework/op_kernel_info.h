@@ -14,6 +14,7 @@ namespace onnxruntime {
 
 class DataTransferManager;
 class FuncManager;
+struct ConfigOptions;
 class OrtValueNameIdxMap;
 struct AllocPlanPerValue;
 
@@ -28,6 +29,7 @@ class OpKernelInfo : public OpNodeProtoHelper<ProtoHelperNodeContext> {
                         const std::unordered_map<int, OrtValue>& constant_initialized_tensors,
                         const OrtValueNameIdxMap& mlvalue_name_idx_map,
                         const DataTransferManager& data_transfer_mgr,
+                        const ConfigOptions& config_options,
                         const AllocatorMap& allocators = {});
 
   OpKernelInfo(const OpKernelInfo& other);
@@ -50,6 +52,9 @@ class OpKernelInfo : public OpNodeProtoHelper<ProtoHelperNodeContext> {
 
   const AllocatorMap& GetAllocators() const { return allocators_; }
 
+  // Configuration of the session that creates the kernel.
+  const ConfigOptions& GetConfigOptions() const noexcept { return config_options_; }
+
  private:
   ORT_DISALLOW_MOVE(OpKernelInfo);
   ORT_DISALLOW_ASSIGNMENT(OpKernelInfo);
@@ -62,6 +67,7 @@ class OpKernelInfo : public OpNodeProtoHelper<ProtoHelperNodeContext> {
   const std::unordered_map<int, OrtValue>& constant_initialized_tensors_;
   const OrtValueNameIdxMap& ort_value_name_idx_map_;
   const DataTransferManager& data_transfer_mgr_;
+  const ConfigOptions& config_options_;
   ProtoHelperNodeContext proto_helper_context_;
   const AllocatorMap& allocators_;
 };
@@ -225,3 +225,14 @@ static const char* const kOrtSessionOptionsOptimizedModelExternalInitializersFil
 // Use this config to control the minimum size of the initializer when externalizing it during serialization
 static const char* const kOrtSessionOptionsOptimizedModelExternalInitializersMinSizeInBytes =
     "session.optimized_model_external_initializers_min_size_in_bytes";
+
+// Allows the CPU EP to run fp32 2D Conv with constant 3x3 weights, unit strides and unit dilations with the
+// Winograd F(4x4,3x3) algorithm. It needs fewer multiplies than im2col/GEMM, but its rounding error is larger
+// and grows with the dynamic range of the input and of the weights, so results no longer match exactly.
+// Conv nodes that the NCHWc transformer rewrites (ORT_ENABLE_ALL on x64) keep using the NCHWc kernels.
+// It requires prepacking, so it has no effect if kOrtSessionOptionsConfigDisablePrepacking is set.
+//
+// Option values:
+// - "0": Winograd is not used. [DEFAULT]
+// - "1": Winograd is used for eligible Conv nodes.
+static const char* const kOrtSessionOptionsMlasConvWinograd = "mlas.enable_conv_winograd";
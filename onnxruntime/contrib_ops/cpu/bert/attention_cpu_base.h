@@ -80,15 +80,18 @@ class AttentionCPUBase : public AttentionBase {
     T* present_value_data = present_value != nullptr ? present_value->MutableData<T>() : nullptr;
 
     const T* relative_position_bias_data = nullptr;
+    bool broadcast_relative_position_bias = false;
     if (relative_position_bias != nullptr) {
       relative_position_bias_data = relative_position_bias->Data<T>();
+      broadcast_relative_position_bias = relative_position_bias->Shape().GetDims()[0] == 1;
     }
 
     ComputeAttentionProbs<T>(static_cast<T*>(attention_probs), Q, K,
                              mask_index_data, mask_index_dims, static_cast<T*>(mask_data), causal,
                              batch_size, sequence_length, kv_sequence_length, past_sequence_length,
                              qk_head_size == 0 ? v_head_size : qk_head_size, past_data, past_key_data,
-                             present_data, present_key_data, tp, relative_position_bias_data);
+                             present_data, present_key_data, tp, relative_position_bias_data,
+                             broadcast_relative_position_bias);
 
     // Compute the attentionScore * Value: out_tmp(B, N, S, H_v) = attention_probs(B, N, S, T) x V(B, N, T, H_v)
     auto out_tmp_data =
@@ -106,9 +109,12 @@ class AttentionCPUBase : public AttentionBase {
 
  private:
   // Helper function to compute the attention probs. It does 2 things:
-  //  attention_probs(B, N, S, T) = 1/sqrt(H) x Q(B, N, S, H) x K'(B, N, T, H -> B, N, H, T) +
-  //                                1 x mask_data(B, N, S, T)
-  //  attention_probs(B, N, S, T) = Softmax(attention_probs)
+  //  attention_probs(B, N, S, T) = Q(B, N, S, H) x K'(B, N, T, H -> B, N, H, T)
+  //  attention_probs(B, N, S, T) = Softmax(1/sqrt(H) x attention_probs + mask_data(B, S, T) +
+  //                                        relative_position_bias(B, N, S, T))
+  // The softmax of each head runs right after its Gemm, while the scores are still in the cache, and applies the
+  // scale, mask and bias in the same pass. The unidirectional mask is part of mask_data, so future positions get
+  // mask_filter_value like the other masked positions.
   template <typename T>
   void ComputeAttentionProbs(T* attention_probs,                        // output buffer with size BxNxSxT
                              const T* Q,                                // Q data. Its size is BxNxSxH
@@ -127,7 +133,8 @@ class AttentionCPUBase : public AttentionBase {
                              T* present,                                // present state
                              T* present_key,                            // present key only (if not using present state)
                              ThreadPool* tp,                            // thread pool
-                             const T* relative_position_bias_data       // bias addition matrix with shape BxNxSxT
+                             const T* relative_position_bias_data,      // bias addition matrix with shape BxNxSxT
+                             bool broadcast_relative_position_bias      // bias has batch size 1, shape 1xNxSxT
   ) const {
     const int total_sequence_length = past_sequence_length + kv_sequence_length;               // T = P + L
     const size_t past_chunk_length = static_cast<size_t>(past_sequence_length) * head_size;    // P x H
@@ -135,77 +142,65 @@ class AttentionCPUBase : public AttentionBase {
     const size_t kv_input_chunk_length = static_cast<size_t>(kv_sequence_length) * head_size;  // L x H
     const size_t present_chunk_length = past_chunk_length + kv_input_chunk_length;             // T x H
 
-    {
-      // mask_data is nullptr when mask_index is nullptr and not unidirectional, otherwise its shape is BxSxT
-      if (mask_data != nullptr) {
-        PrepareMask(mask_index, mask_index_dims, mask_data,
-                    causal, batch_size, sequence_length, past_sequence_length, mask_filter_value_);
-      } else {  // no any mask
-        const int memset_loop_len = batch_size * num_heads_;
-        const double memset_cost = static_cast<double>(sequence_length) * total_sequence_length;
-
-        ThreadPool::TryParallelFor(tp, memset_loop_len, memset_cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
-          for (std::ptrdiff_t i = begin; i != end; ++i) {
-            const int output_offset = static_cast<int>(i) * sequence_length * total_sequence_length;
-            T* output = attention_probs + output_offset;
-            memset(output, 0, static_cast<size_t>(sequence_length) * total_sequence_length * sizeof(T));
-          }
-        });
-      }
+    // mask_data is nullptr when mask_index is nullptr and not unidirectional, otherwise its shape is BxSxT
+    if (mask_data != nullptr) {
+      PrepareMask(mask_index, mask_index_dims, mask_data,
+                  causal, batch_size, sequence_length, past_sequence_length, mask_filter_value_);
+    }
+
+    const int loop_len = batch_size * num_heads_;
+    const float alpha = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(head_size)) : scale_;
+
+    // The cost of Gemm and softmax
+    const double cost = static_cast<double>(head_size + 1) * sequence_length * total_sequence_length;
 
-      const int loop_len = batch_size * num_heads_;
-      const float alpha = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(head_size)) : scale_;
-
-      // The cost of Gemm
-      const double cost = static_cast<double>(head_size) * sequence_length * total_sequence_length;
-
-      ThreadPool::TryParallelFor(tp, loop_len, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
-        for (std::ptrdiff_t i = begin; i != end; ++i) {
-          const int batch_index = static_cast<int>(i) / num_heads_;
-
-          const int output_offset = static_cast<int>(i) * sequence_length * total_sequence_length;
-          const int mask_offset = batch_index * sequence_length * total_sequence_length;
-          T* output = attention_probs + output_offset;
-
-          // Broadcast mask data: (Bx)SxT -> (BxNx)SxT
-          if (mask_data != nullptr) {
-            memcpy(output,
-                   mask_data + mask_offset,
-                   static_cast<size_t>(sequence_length) * total_sequence_length * sizeof(T));
-          }
-
-          const T* k = K + kv_input_chunk_length * i;
-          if (nullptr != present) {
-            // Concatenate past_K and K : (BxNx)PxH, (BxNx)LxH -> (BxNx)TxH
-            k = ConcatStateChunk(past, k, present, past_chunk_length, present_chunk_length, i);
-          } else if (nullptr != present_key) {
-            k = ConcatStateChunk(past_key, k, present_key, past_chunk_length, present_chunk_length, i);
-          }
-
-          // Compute Q*K' + AttentionMask
-          //                     original                 transposed             each iteration
-          // A: Q                (B x N x) S x H          (B x N x) S x H        S x H
-          // B: K'               (B x N x) T x H          (B x N x) H x T        H x T
-          // C: attention_probs  (B x N x) S x T          (B x N x) S x T        S x T
-          math::Gemm<T, ThreadPool>(CblasNoTrans, CblasTrans, sequence_length, total_sequence_length, head_size, alpha,
-                                    Q + q_input_chunk_length * i, k, 1.0,
-                                    output, nullptr);
-
-          if (relative_position_bias_data != nullptr) {
-            for (int j = 0; j < sequence_length * total_sequence_length; j++) {
-              output[j] += relative_position_bias_data[output_offset + j];
-            }
-          }
+    ThreadPool::TryParallelFor(tp, loop_len, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+      for (std::ptrdiff_t i = begin; i != end; ++i) {
+        const int batch_index = static_cast<int>(i) / num_heads_;
+        const int head_index = static_cast<int>(i) % num_heads_;
+
+        const int output_offset = static_cast<int>(i) * sequence_length * total_sequence_length;
+        const int mask_offset = batch_index * sequence_length * total_sequence_length;
+        const int bias_offset = broadcast_relative_position_bias
+                                    ? head_index * sequence_length * total_sequence_length
+                                    : output_offset;
+        T* output = attention_probs + output_offset;
+
+        const T* k = K + kv_input_chunk_length * i;
+        if (nullptr != present) {
+          // Concatenate past_K and K : (BxNx)PxH, (BxNx)LxH -> (BxNx)TxH
+          k = ConcatStateChunk(past, k, present, past_chunk_length, present_chunk_length, i);
+        } else if (nullptr != present_key) {
+          k = ConcatStateChunk(past_key, k, present_key, past_chunk_length, present_chunk_length, i);
         }
-      });
-    }
 
-    // attention_probs(B, N, S, T) = Softmax(attention_probs)
-    {
-      const int N = batch_size * num_heads_ * sequence_length;
-      const int D = total_sequence_length;
-      ComputeAttentionSoftmaxInplace(attention_probs, N, D, tp);
-    }
+        // Compute Q*K'
+        //                     original                 transposed             each iteration
+        // A: Q                (B x N x) S x H          (B x N x) S x H        S x H
+        // B: K'               (B x N x) T x H          (B x N x) H x T        H x T
+        // C: attention_probs  (B x N x) S x T          (B x N x) S x T        S x T
+        math::Gemm<T, ThreadPool>(CblasNoTrans, CblasTrans, sequence_length, total_sequence_length, head_size, 1.0f,
+                                  Q + q_input_chunk_length * i, k, 0.0f,
+                                  output, nullptr);
+
+        // attention_probs(S, T) = Softmax(alpha x attention_probs + mask_data + relative_position_bias)
+        // Broadcast mask data: (Bx)SxT -> (BxNx)SxT
+        MLAS_FUSED_SOFTMAX_PARAMS softmax_params;
+        softmax_params.SequenceLength = static_cast<size_t>(sequence_length);
+        softmax_params.TotalSequenceLength = static_cast<size_t>(total_sequence_length);
+        softmax_params.Scale = alpha;
+        if (mask_data != nullptr) {
+          softmax_params.Mask.Data = mask_data + mask_offset;
+          softmax_params.Mask.RowStride = static_cast<size_t>(total_sequence_length);
+        }
+        if (relative_position_bias_data != nullptr) {
+          softmax_params.Bias.Data = relative_position_bias_data + bias_offset;
+          softmax_params.Bias.RowStride = static_cast<size_t>(total_sequence_length);
+        }
+
+        MlasComputeFusedSoftmax(output, output, softmax_params, nullptr);
+      }
+    });
   }
 
   template <typename T>
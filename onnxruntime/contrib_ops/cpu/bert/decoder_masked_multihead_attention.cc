@@ -0,0 +1,390 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "decoder_masked_multihead_attention.h"
+#include "multihead_attention_helper.h"
+
+#include "core/common/common.h"
+#include "core/common/safeint.h"
+#include "core/framework/allocator.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+static constexpr int kPastInputIndex = 5;
+static constexpr int kPastSequenceLengthInputIndex = 7;
+static constexpr int kBeamWidthInputIndex = 8;
+static constexpr int kCacheIndirectionInputIndex = 9;
+static constexpr int kBiasIndex = 10;
+static constexpr int kPresentOutputIndex = 1;
+
+// The cache is visited in blocks of this many entries. The scores of a block are one GEMV, and the block is folded
+// into the running softmax with a single rescale of the accumulated output.
+static constexpr size_t kKeyBlockSize = 64;
+
+// These ops are internal-only, so register outside of onnx
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    DecoderMaskedMultiHeadAttention,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .MayInplace(kPastInputIndex, kPresentOutputIndex)
+        .MayInplace(kPastInputIndex + 1, kPresentOutputIndex + 1)
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    DecoderMaskedMultiHeadAttention<float>);
+
+template <typename T>
+DecoderMaskedMultiHeadAttention<T>::DecoderMaskedMultiHeadAttention(const OpKernelInfo& info) : OpKernel(info) {
+  int64_t num_heads = 0;
+  ORT_ENFORCE(info.GetAttr("num_heads", &num_heads).IsOK() && num_heads > 0);
+  num_heads_ = static_cast<int>(num_heads);
+  mask_filter_value_ = info.GetAttrOrDefault<float>("mask_filter_value", -10000.0f);
+  scale_ = info.GetAttrOrDefault<float>("scale", 0.0f);
+  past_present_share_buffer_ = info.GetAttrOrDefault<int64_t>("past_present_share_buffer", 0LL) != 0;
+}
+
+template <typename T>
+Status DecoderMaskedMultiHeadAttention<T>::Compute(OpKernelContext* context) const {
+  const Tensor* query = context->Input<Tensor>(0);
+  const Tensor* key = context->Input<Tensor>(1);
+  const Tensor* value = context->Input<Tensor>(2);
+  const Tensor* mask_index = context->Input<Tensor>(3);
+  const Tensor* relative_position_bias = context->Input<Tensor>(4);
+  const Tensor* past_key = context->Input<Tensor>(kPastInputIndex);
+  const Tensor* past_value = context->Input<Tensor>(kPastInputIndex + 1);
+  const Tensor* past_seq_len = context->Input<Tensor>(kPastSequenceLengthInputIndex);
+  const Tensor* beam_width = context->Input<Tensor>(kBeamWidthInputIndex);
+  const Tensor* cache_indir = context->Input<Tensor>(kCacheIndirectionInputIndex);
+  const Tensor* bias = context->Input<Tensor>(kBiasIndex);
+
+  AttentionParameters parameters;
+  bool is_dmmha_packing = (key == nullptr && value == nullptr);
+  // The mask covers the past and the new token, so it is checked below against the total sequence length rather
+  // than against the key padding mask shapes of MultiHeadAttention.
+  ORT_RETURN_IF_ERROR(multihead_attention_helper::CheckInputs<Tensor>(query,
+                                                                      key,
+                                                                      value,
+                                                                      bias,
+                                                                      nullptr,
+                                                                      relative_position_bias,
+                                                                      past_key,
+                                                                      past_value,
+                                                                      past_seq_len,
+                                                                      &parameters,
+                                                                      num_heads_,
+                                                                      mask_filter_value_,
+                                                                      scale_,
+                                                                      past_present_share_buffer_,
+                                                                      is_dmmha_packing));
+
+  const int batch_size = parameters.batch_size;
+  const int sequence_length = parameters.sequence_length;
+  const int num_heads = parameters.num_heads;
+  const int head_size = parameters.head_size;
+  const int hidden_size = parameters.hidden_size;
+
+  // This kernel is for decoding only (i.e.) sequence length has to be 1
+  if (sequence_length != 1) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input sequence length should be 1 to use DecoderMaskedMultiHeadAttention");
+  }
+
+  if (parameters.head_size != parameters.v_head_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                           "QK head size should be same as V head size to use DecoderMaskedMultiHeadAttention");
+  }
+
+  TensorShapeVector output_shape{batch_size, sequence_length, parameters.v_hidden_size};
+  Tensor* output = context->Output(0, output_shape);
+
+  // Decoder cross-attention passes the cache of the encoder output in key and value.
+  const bool is_cross_attention = (past_key == nullptr);
+
+  // The cache of (batch_size, num_heads, max_sequence_length, head_size) read by the attention.
+  const T* k_cache = nullptr;
+  const T* v_cache = nullptr;
+  T* present_key_data = nullptr;
+  T* present_value_data = nullptr;
+  int past_sequence_length = parameters.past_sequence_length;
+  int max_sequence_length = parameters.max_sequence_length;
+  int total_sequence_length = parameters.total_sequence_length;
+
+  if (is_cross_attention) {
+    if (!parameters.pass_past_in_kv) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "DecoderMaskedMultiHeadAttention expects key and value of shape "
+                             "(batch_size, num_heads, kv_sequence_length, head_size) for cross-attention");
+    }
+    if (relative_position_bias != nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                             "DecoderMaskedMultiHeadAttention does not support relative position bias for cross-attention");
+    }
+
+    past_sequence_length = 0;
+    total_sequence_length = parameters.kv_sequence_length;
+    max_sequence_length = parameters.kv_sequence_length;
+    k_cache = key->Data<T>();
+    v_cache = value->Data<T>();
+  } else {
+    if (!past_present_share_buffer_) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "DecoderMaskedMultiHeadAttention self-attention requires past_present_share_buffer");
+    }
+    if (parameters.pass_past_in_kv) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "DecoderMaskedMultiHeadAttention self-attention expects key and value of a single token");
+    }
+    if (past_sequence_length < 0 || past_sequence_length >= max_sequence_length) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "past_sequence_length should be in [0, max_sequence_length), got ",
+                             past_sequence_length, " with max_sequence_length ", max_sequence_length);
+    }
+
+    TensorShapeVector present_shape{batch_size, num_heads, max_sequence_length, head_size};
+    Tensor* present_key = context->Output(kPresentOutputIndex, present_shape);
+    Tensor* present_value = context->Output(kPresentOutputIndex + 1, present_shape);
+    if (present_key == nullptr || present_value == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "DecoderMaskedMultiHeadAttention self-attention requires present_key and present_value");
+    }
+
+    present_key_data = present_key->MutableData<T>();
+    present_value_data = present_value->MutableData<T>();
+
+    // Generation binds present to the buffer of past so the copy only happens when the planner could not share them.
+    if (present_key_data != past_key->Data<T>()) {
+      memcpy(present_key_data, past_key->Data<T>(), past_key->SizeInBytes());
+    }
+    if (present_value_data != past_value->Data<T>()) {
+      memcpy(present_value_data, past_value->Data<T>(), past_value->SizeInBytes());
+    }
+
+    k_cache = present_key_data;
+    v_cache = present_value_data;
+  }
+
+  if (mask_index != nullptr) {
+    const auto& mask_dims = mask_index->Shape().GetDims();
+    if (mask_dims.size() != 2 || mask_dims[0] != batch_size || mask_dims[1] != total_sequence_length) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "DecoderMaskedMultiHeadAttention only supports no mask or 2D key "
+                             "padding mask of shape [batch, total_seq_length] currently, got ",
+                             mask_index->Shape(), " with total_seq_length ", total_sequence_length);
+    }
+  }
+
+  // Beam width (in case we are using this op inside BeamSearch)
+  int beam_width_value = 1;
+  if (beam_width != nullptr) {
+    beam_width_value = static_cast<int>(*beam_width->Data<int32_t>());
+  }
+
+  const int32_t* cache_indir_data = nullptr;
+  if (beam_width_value > 1 && !is_cross_attention) {
+    // If beam width > 1, then cache indirection buffer MUST be present
+    if (cache_indir == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "If beam width is greater than 1, then cache indirection buffer MUST be present");
+    }
+    const auto& cache_indir_dims = cache_indir->Shape().GetDims();
+    if (batch_size % beam_width_value != 0 || cache_indir_dims.size() != 3 ||
+        cache_indir_dims[0] * cache_indir_dims[1] != batch_size || cache_indir_dims[1] != beam_width_value ||
+        cache_indir_dims[2] != max_sequence_length) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'cache_indirection' is expected to have shape "
+                             "(batch_size / beam_width, beam_width, max_sequence_length), got ",
+                             cache_indir->Shape());
+    }
+
+    cache_indir_data = cache_indir->Data<int32_t>();
+    for (int b = 0; b < batch_size; b++) {
+      const int32_t* beam_indices = cache_indir_data + static_cast<size_t>(b) * max_sequence_length;
+      for (int t = 0; t < past_sequence_length; t++) {
+        if (beam_indices[t] < 0 || beam_indices[t] >= beam_width_value) {
+          return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                                 "Input 'cache_indirection' has a beam index out of range: ", beam_indices[t]);
+        }
+      }
+    }
+  }
+
+  // The new token is (batch_size, 1, D) or the packed (batch_size, 1, D + D + D_v).
+  const T* q_data = query->Data<T>();
+  const size_t q_stride = is_dmmha_packing ? 3 * static_cast<size_t>(hidden_size) : static_cast<size_t>(hidden_size);
+  const T* k_data = nullptr;
+  const T* v_data = nullptr;
+  if (!is_cross_attention) {
+    k_data = is_dmmha_packing ? q_data + hidden_size : key->Data<T>();
+    v_data = is_dmmha_packing ? q_data + 2 * static_cast<size_t>(hidden_size) : value->Data<T>();
+  }
+
+  const T* q_bias = nullptr;
+  const T* k_bias = nullptr;
+  const T* v_bias = nullptr;
+  if (bias != nullptr) {
+    q_bias = bias->Data<T>();
+    if (!is_cross_attention) {
+      k_bias = q_bias + hidden_size;
+      v_bias = q_bias + 2 * static_cast<size_t>(hidden_size);
+    }
+  }
+
+  const int32_t* mask_data = mask_index != nullptr ? mask_index->Data<int32_t>() : nullptr;
+  const T* relative_position_bias_data = relative_position_bias != nullptr ? relative_position_bias->Data<T>()
+                                                                           : nullptr;
+
+  // If the scale is not provided - use `1/sqrt(head_size)`
+  const float scale = parameters.scale == 0.0f ? 1.0f / std::sqrt(static_cast<float>(head_size)) : parameters.scale;
+  const float mask_filter_value = mask_filter_value_;
+  const bool broadcast_res_pos_bias = parameters.broadcast_res_pos_bias;
+  T* output_data = output->MutableData<T>();
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+
+  // Per thread scratch: the scaled query, the accumulated output, the scores of a block and, with beams, the
+  // key and value entries of a block gathered from their source beams.
+  const size_t gather_size = cache_indir_data != nullptr ? 2 * kKeyBlockSize * head_size : 0;
+  const size_t scratch_size = 2 * static_cast<size_t>(head_size) + kKeyBlockSize + gather_size;
+
+  const size_t head_cache_size = SafeInt<size_t>(max_sequence_length) * head_size;
+  const double cost = static_cast<double>(total_sequence_length) * (2.0 * head_size + 4.0);
+
+  ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(batch_size) * num_heads, cost,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        auto scratch = IAllocator::MakeUniquePtr<T>(allocator, scratch_size);
+        T* q = scratch.get();
+        T* accumulator = q + head_size;
+        T* scores = accumulator + head_size;
+        T* k_gather = scores + kKeyBlockSize;
+        T* v_gather = k_gather + kKeyBlockSize * head_size;
+
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          const int batch_index = static_cast<int>(i / num_heads);
+          const int head_index = static_cast<int>(i % num_heads);
+          const size_t head_offset = static_cast<size_t>(head_index) * head_size;
+          const size_t cache_offset = static_cast<size_t>(i) * head_cache_size;
+
+          const T* q_src = q_data + batch_index * q_stride + head_offset;
+          for (int j = 0; j < head_size; j++) {
+            q[j] = (q_bias != nullptr ? q_src[j] + q_bias[head_offset + j] : q_src[j]) * scale;
+          }
+
+          // Append the key and value of the new token to the cache of this sequence and head.
+          if (!is_cross_attention) {
+            const T* k_src = k_data + batch_index * q_stride + head_offset;
+            const T* v_src = v_data + batch_index * q_stride + head_offset;
+            T* k_dest = present_key_data + cache_offset + static_cast<size_t>(past_sequence_length) * head_size;
+            T* v_dest = present_value_data + cache_offset + static_cast<size_t>(past_sequence_length) * head_size;
+            for (int j = 0; j < head_size; j++) {
+              k_dest[j] = k_bias != nullptr ? k_src[j] + k_bias[head_offset + j] : k_src[j];
+              v_dest[j] = v_bias != nullptr ? v_src[j] + v_bias[head_offset + j] : v_src[j];
+            }
+          }
+
+          // The beams of a batch entry are consecutive, entries of earlier tokens come from beam
+          // first_beam + beam_indices[t] while the new token is always in the cache of its own beam.
+          const int32_t* beam_indices = nullptr;
+          size_t first_beam = 0;
+          if (cache_indir_data != nullptr) {
+            beam_indices = cache_indir_data + static_cast<size_t>(batch_index) * max_sequence_length;
+            first_beam = static_cast<size_t>(batch_index - batch_index % beam_width_value);
+          }
+
+          const int32_t* mask_row = mask_data != nullptr
+                                        ? mask_data + static_cast<size_t>(batch_index) * total_sequence_length
+                                        : nullptr;
+          const T* bias_row = nullptr;
+          if (relative_position_bias_data != nullptr) {
+            const size_t bias_batch = broadcast_res_pos_bias ? 0 : static_cast<size_t>(batch_index);
+            bias_row = relative_position_bias_data + (bias_batch * num_heads + head_index) * total_sequence_length;
+          }
+
+          // Streaming softmax over the cache: the running max, the running sum of exp(score - max) and the
+          // output accumulated with the same weights are rescaled whenever a block raises the max.
+          float running_max = std::numeric_limits<float>::lowest();
+          float running_sum = 0.0f;
+          std::fill_n(accumulator, head_size, 0.0f);
+
+          for (size_t block_start = 0; block_start < static_cast<size_t>(total_sequence_length);
+               block_start += kKeyBlockSize) {
+            const size_t block_size = std::min(kKeyBlockSize, total_sequence_length - block_start);
+
+            const T* k_block = k_cache + cache_offset + block_start * head_size;
+            const T* v_block = v_cache + cache_offset + block_start * head_size;
+            if (beam_indices != nullptr) {
+              for (size_t r = 0; r < block_size; r++) {
+                const size_t t = block_start + r;
+                size_t src_offset = cache_offset + t * head_size;
+                if (t < static_cast<size_t>(past_sequence_length)) {
+                  src_offset = ((first_beam + beam_indices[t]) * num_heads + head_index) * head_cache_size +
+                               t * head_size;
+                }
+                memcpy(k_gather + r * head_size, k_cache + src_offset, head_size * sizeof(T));
+                memcpy(v_gather + r * head_size, v_cache + src_offset, head_size * sizeof(T));
+              }
+              k_block = k_gather;
+              v_block = v_gather;
+            }
+
+            // scores(1, block_size) = q(1, H) x K_block'(H, block_size)
+            MlasGemm(CblasNoTrans, CblasTrans, 1, block_size, head_size, 1.0f,
+                     q, head_size, k_block, head_size, 0.0f, scores, block_size, nullptr);
+
+            float block_max = std::numeric_limits<float>::lowest();
+            for (size_t r = 0; r < block_size; r++) {
+              if (mask_row != nullptr && mask_row[block_start + r] == 0) {
+                scores[r] += mask_filter_value;
+              }
+              if (bias_row != nullptr) {
+                scores[r] += bias_row[block_start + r];
+              }
+              block_max = std::max(block_max, scores[r]);
+            }
+
+            if (block_max > running_max) {
+              const float rescale = std::exp(running_max - block_max);
+              running_sum *= rescale;
+              for (int j = 0; j < head_size; j++) {
+                accumulator[j] *= rescale;
+              }
+              running_max = block_max;
+            }
+
+            for (size_t r = 0; r < block_size; r++) {
+              scores[r] -= running_max;
+            }
+            MlasComputeExp(scores, scores, block_size);
+            for (size_t r = 0; r < block_size; r++) {
+              running_sum += scores[r];
+            }
+
+            // accumulator(1, H) += scores(1, block_size) x V_block(block_size, H)
+            MlasGemm(CblasNoTrans, CblasNoTrans, 1, head_size, block_size, 1.0f,
+                     scores, block_size, v_block, head_size, 1.0f, accumulator, head_size, nullptr);
+          }
+
+          T* out = output_data + static_cast<size_t>(batch_index) * parameters.v_hidden_size + head_offset;
+          const float inv_sum = 1.0f / running_sum;
+          for (int j = 0; j < head_size; j++) {
+            out[j] = accumulator[j] * inv_sum;
+          }
+        }
+      });
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Attention of a single new token per sequence, used for each decoding step of generation.
+//
+// For self attention, the key and value of the new token are appended in place at position past_sequence_length of a
+// cache of max_sequence_length entries shared by past and present, and only that single query is computed against
+// the cache. When beam search passes cache_indirection, the entries of the earlier tokens are read from the beam they
+// came from, so the cache never needs to be reordered between steps.
+template <typename T>
+class DecoderMaskedMultiHeadAttention final : public OpKernel {
+ public:
+  DecoderMaskedMultiHeadAttention(const OpKernelInfo& info);
+  Status Compute(OpKernelContext* context) const override;
+
+ protected:
+  int num_heads_;  // number of attention heads
+  float mask_filter_value_;
+  float scale_;
+  bool past_present_share_buffer_;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
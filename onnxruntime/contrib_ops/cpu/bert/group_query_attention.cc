@@ -0,0 +1,275 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "group_query_attention.h"
+
+#include "core/common/common.h"
+#include "core/common/safeint.h"
+#include "core/framework/allocator.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+static constexpr int kPastKeyInputIndex = 3;
+static constexpr int kPastValueInputIndex = 4;
+static constexpr int kSeqlensKInputIndex = 5;
+static constexpr int kTotalSequenceLengthInputIndex = 6;
+static constexpr int kPresentKeyOutputIndex = 1;
+static constexpr int kPresentValueOutputIndex = 2;
+
+// These ops are internal-only, so register outside of onnx
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    GroupQueryAttention,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .MayInplace(kPastKeyInputIndex, kPresentKeyOutputIndex)
+        .MayInplace(kPastValueInputIndex, kPresentValueOutputIndex)
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("M", DataTypeImpl::GetTensorType<int32_t>()),
+    GroupQueryAttention<float>);
+
+template <typename T>
+GroupQueryAttention<T>::GroupQueryAttention(const OpKernelInfo& info) : OpKernel(info) {
+  int64_t num_heads = 0;
+  int64_t kv_num_heads = 0;
+  ORT_ENFORCE(info.GetAttr("num_heads", &num_heads).IsOK() && num_heads > 0);
+  ORT_ENFORCE(info.GetAttr("kv_num_heads", &kv_num_heads).IsOK() && kv_num_heads > 0 &&
+                  num_heads % kv_num_heads == 0,
+              "num_heads should be a multiple of kv_num_heads, got ", num_heads, " and ", kv_num_heads);
+  num_heads_ = static_cast<int>(num_heads);
+  kv_num_heads_ = static_cast<int>(kv_num_heads);
+  scale_ = info.GetAttrOrDefault<float>("scale", 0.0f);
+}
+
+template <typename T>
+Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
+  const Tensor* query = context->Input<Tensor>(0);
+  const Tensor* key = context->Input<Tensor>(1);
+  const Tensor* value = context->Input<Tensor>(2);
+  const Tensor* past_key = context->Input<Tensor>(kPastKeyInputIndex);
+  const Tensor* past_value = context->Input<Tensor>(kPastValueInputIndex);
+  const Tensor* seqlens_k = context->Input<Tensor>(kSeqlensKInputIndex);
+  const Tensor* total_sequence_length = context->Input<Tensor>(kTotalSequenceLengthInputIndex);
+
+  const auto& query_dims = query->Shape().GetDims();
+  if (query_dims.size() != 3) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'query' is expected to have 3 dimensions, got ",
+                           query_dims.size());
+  }
+  const int64_t batch_size = query_dims[0];
+  const int64_t sequence_length = query_dims[1];
+  const int64_t hidden_size = query_dims[2];
+  const int num_heads = num_heads_;
+  const int kv_num_heads = kv_num_heads_;
+  if (hidden_size % num_heads != 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "hidden_size should be divisible by num_heads, got hidden_size ", hidden_size);
+  }
+  const int64_t head_size = hidden_size / num_heads;
+  const int64_t kv_hidden_size = head_size * kv_num_heads;
+
+  const auto& key_dims = key->Shape().GetDims();
+  if (key_dims.size() != 3 || key_dims[0] != batch_size || key_dims[1] != sequence_length ||
+      key_dims[2] != kv_hidden_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'key' is expected to have shape (batch_size, sequence_length, kv_num_heads * "
+                           "head_size), got ",
+                           key->Shape());
+  }
+  if (value->Shape() != key->Shape()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'value' is expected to have the shape of 'key' ", key->Shape(), ", got ",
+                           value->Shape());
+  }
+
+  if ((past_key == nullptr) != (past_value == nullptr)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'past_key' and 'past_value' shall be both present "
+                           "or both absent");
+  }
+  int64_t past_buffer_length = 0;
+  if (past_key != nullptr) {
+    const auto& past_dims = past_key->Shape().GetDims();
+    if (past_dims.size() != 4 || past_dims[0] != batch_size || past_dims[1] != kv_num_heads ||
+        past_dims[3] != head_size) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'past_key' is expected to have shape (batch_size, kv_num_heads, "
+                             "past_sequence_length, head_size), got ",
+                             past_key->Shape());
+    }
+    if (past_value->Shape() != past_key->Shape()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'past_value' is expected to have the shape of 'past_key' ", past_key->Shape(),
+                             ", got ", past_value->Shape());
+    }
+    past_buffer_length = past_dims[2];
+  }
+
+  if (seqlens_k->Shape().NumDimensions() != 1 || seqlens_k->Shape()[0] != batch_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'seqlens_k' is expected to have shape (batch_size), got ", seqlens_k->Shape());
+  }
+  if (total_sequence_length->Shape().Size() != 1) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'total_sequence_length' is expected to have one element, got ",
+                           total_sequence_length->Shape());
+  }
+
+  const int64_t present_length = std::max(past_buffer_length,
+                                          static_cast<int64_t>(*total_sequence_length->Data<int32_t>()));
+
+  // The loops below write and read the present buffers at these lengths, check them before use.
+  const int32_t* past_data = seqlens_k->Data<int32_t>();
+  for (int64_t b = 0; b < batch_size; b++) {
+    if (past_data[b] < 0 || past_data[b] > past_buffer_length) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'seqlens_k' of sequence ", b, " is ",
+                             past_data[b], ", which is out of the past of ", past_buffer_length, " tokens");
+    }
+    if (past_data[b] + sequence_length > present_length) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Sequence ", b, " has ",
+                             past_data[b] + sequence_length, " tokens, more than the total_sequence_length ",
+                             present_length);
+    }
+  }
+
+  Tensor* output = context->Output(0, query->Shape());
+  const TensorShape present_shape({batch_size, static_cast<int64_t>(kv_num_heads), present_length, head_size});
+  Tensor* present_key = context->Output(kPresentKeyOutputIndex, present_shape);
+  Tensor* present_value = context->Output(kPresentValueOutputIndex, present_shape);
+
+  T* k_present = present_key->MutableData<T>();
+  T* v_present = present_value->MutableData<T>();
+  const size_t present_head_size = SafeInt<size_t>(present_length) * head_size;
+
+  // With a past allocated for the longest sequence the planner shares the past and present buffers, so there is
+  // nothing to copy. Otherwise each present head starts with its past and the positions after it are zeroed.
+  const size_t past_head_size = static_cast<size_t>(past_buffer_length * head_size);
+  auto copy_past = [&](const Tensor* past, T* present) {
+    const T* past_buffer = past == nullptr ? nullptr : past->Data<T>();
+    if (present == past_buffer) {
+      return;
+    }
+    for (int64_t i = 0; i < batch_size * kv_num_heads; i++) {
+      T* present_head = present + i * present_head_size;
+      if (past_head_size > 0) {
+        memcpy(present_head, past_buffer + i * past_head_size, past_head_size * sizeof(T));
+      }
+      std::fill(present_head + past_head_size, present_head + present_head_size, 0.0f);
+    }
+  };
+  copy_past(past_key, k_present);
+  copy_past(past_value, v_present);
+
+  if (batch_size == 0 || sequence_length == 0) {
+    return Status::OK();
+  }
+
+  const T* q_data = query->Data<T>();
+  const T* k_data = key->Data<T>();
+  const T* v_data = value->Data<T>();
+  T* output_data = output->MutableData<T>();
+
+  const float scale = scale_ == 0.0f ? 1.0f / std::sqrt(static_cast<float>(head_size)) : scale_;
+  const size_t H = static_cast<size_t>(head_size);
+  const size_t S = static_cast<size_t>(sequence_length);
+  const size_t group_size = static_cast<size_t>(num_heads / kv_num_heads);
+
+  // Append the key and value of the new tokens after the past of each sequence.
+  for (int64_t b = 0; b < batch_size; b++) {
+    for (int kv_head = 0; kv_head < kv_num_heads; kv_head++) {
+      const size_t dest_offset = static_cast<size_t>(b * kv_num_heads + kv_head) * present_head_size +
+                                 static_cast<size_t>(past_data[b]) * H;
+      for (size_t s = 0; s < S; s++) {
+        const size_t src_offset = (static_cast<size_t>(b) * S + s) * static_cast<size_t>(kv_hidden_size) +
+                                  static_cast<size_t>(kv_head) * H;
+        memcpy(k_present + dest_offset + s * H, k_data + src_offset, H * sizeof(T));
+        memcpy(v_present + dest_offset + s * H, v_data + src_offset, H * sizeof(T));
+      }
+    }
+  }
+
+  // One token per sequence puts the query heads of a group in consecutive rows that see the same positions.
+  const bool is_decoding = S == 1;
+  const size_t max_rows = is_decoding ? group_size : S;
+  const size_t scratch_size = SafeInt<size_t>(max_rows) * static_cast<size_t>(present_length);
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+
+  const double cost = static_cast<double>(group_size) * static_cast<double>(S) *
+                      static_cast<double>(present_length) * static_cast<double>(2 * H + 4);
+
+  ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(batch_size) * kv_num_heads, cost,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        auto scratch = IAllocator::MakeUniquePtr<T>(allocator, scratch_size);
+        T* scores = scratch.get();
+
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          const size_t batch_index = static_cast<size_t>(i / kv_num_heads);
+          const size_t kv_head = static_cast<size_t>(i % kv_num_heads);
+          const size_t past_length = static_cast<size_t>(past_data[batch_index]);
+          const size_t total_length = past_length + S;
+          const T* k = k_present + static_cast<size_t>(i) * present_head_size;
+          const T* v = v_present + static_cast<size_t>(i) * present_head_size;
+
+          // Row r of the rows attends to the positions up to past_length + r * row_step: the rows are either the
+          // tokens of one head, or the heads of the group for one token.
+          auto attend = [&](const T* q, size_t ldq, size_t rows, size_t row_step, T* out, size_t ldo) {
+            // scores(rows, total_length) = scale * q(rows, H) x K'(H, total_length)
+            MlasGemm(CblasNoTrans, CblasTrans, rows, total_length, H, scale,
+                     q, ldq, k, H, 0.0f, scores, total_length, nullptr);
+
+            for (size_t r = 0; r < rows; r++) {
+              T* row_scores = scores + r * total_length;
+              const size_t visible = past_length + r * row_step + 1;
+              const float row_max = *std::max_element(row_scores, row_scores + visible);
+              for (size_t c = 0; c < visible; c++) {
+                row_scores[c] -= row_max;
+              }
+              MlasComputeExp(row_scores, row_scores, visible);
+              float row_sum = 0.0f;
+              for (size_t c = 0; c < visible; c++) {
+                row_sum += row_scores[c];
+              }
+              const float inv_sum = 1.0f / row_sum;
+              for (size_t c = 0; c < visible; c++) {
+                row_scores[c] *= inv_sum;
+              }
+              std::fill(row_scores + visible, row_scores + total_length, 0.0f);
+            }
+
+            // out(rows, H) = scores(rows, total_length) x V(total_length, H)
+            MlasGemm(CblasNoTrans, CblasNoTrans, rows, H, total_length, 1.0f,
+                     scores, total_length, v, H, 0.0f, out, ldo, nullptr);
+          };
+
+          const size_t first_head_offset = kv_head * group_size * H;
+          const size_t batch_offset = batch_index * S * static_cast<size_t>(hidden_size);
+          if (is_decoding) {
+            attend(q_data + batch_offset + first_head_offset, H, group_size, 0,
+                   output_data + batch_offset + first_head_offset, H);
+          } else {
+            for (size_t j = 0; j < group_size; j++) {
+              const size_t offset = batch_offset + first_head_offset + j * H;
+              attend(q_data + offset, static_cast<size_t>(hidden_size), S, 1,
+                     output_data + offset, static_cast<size_t>(hidden_size));
+            }
+          }
+        }
+      });
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Causal self attention where groups of query heads share a key and value head.
+//
+// The key and value of the new tokens are appended to present_key and present_value at the past length of each
+// sequence, which can be the same buffers as past_key and past_value. Every query head then reads the key and value
+// head of its group in place, so the shared heads are never repeated. When one token is decoded, the query heads of
+// a group are consecutive rows and attend to the same positions, so they share the GEMMs of the group.
+template <typename T>
+class GroupQueryAttention final : public OpKernel {
+ public:
+  GroupQueryAttention(const OpKernelInfo& info);
+  Status Compute(OpKernelContext* context) const override;
+
+ protected:
+  int num_heads_;     // number of attention heads of query
+  int kv_num_heads_;  // number of attention heads of key and value
+  float scale_;       // scale for softmax. Default is 0.0f, which will be replaced by 1/sqrt(head_size)
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,375 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "longformer_attention.h"
+
+#include "core/common/common.h"
+#include "core/common/safeint.h"
+#include "core/framework/allocator.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+// These ops are internal-only, so register outside of onnx
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    LongformerAttention,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    LongformerAttention<float>);
+
+template <typename T>
+LongformerAttention<T>::LongformerAttention(const OpKernelInfo& info) : OpKernel(info), LongformerAttentionBase(info) {
+}
+
+namespace {
+
+enum Projection {
+  kQuery = 0,
+  kKey = 1,
+  kValue = 2,
+  kGlobalQuery = 3,
+  kGlobalKey = 4,
+  kGlobalValue = 5
+};
+
+// Returns the weights and the bias of a projection. Format 1 has merged weights of shape (hidden_size, 3 * hidden_size)
+// and a bias of (3 * hidden_size) for Q, K, V and for global Q, K, V. Format 0 has weights of shape
+// (3, hidden_size, hidden_size), the bias of Q, K, V, global K and global V in bias, and the bias of global Q in
+// global_bias.
+template <typename T>
+void GetProjectionWeights(Projection projection, bool use_merged_qkv_weights, size_t hidden_size,
+                          const T* weights, const T* bias, const T* global_weights, const T* global_bias,
+                          const T*& projection_weights, size_t& ldb, const T*& projection_bias) {
+  const bool is_global = projection >= kGlobalQuery;
+  const size_t index = static_cast<size_t>(projection) % 3;
+  if (use_merged_qkv_weights) {
+    projection_weights = (is_global ? global_weights : weights) + index * hidden_size;
+    ldb = 3 * hidden_size;
+    projection_bias = (is_global ? global_bias : bias) + index * hidden_size;
+  } else {
+    projection_weights = (is_global ? global_weights : weights) + index * hidden_size * hidden_size;
+    ldb = hidden_size;
+    projection_bias = projection == kGlobalQuery ? global_bias : bias + (is_global ? index + 2 : index) * hidden_size;
+  }
+}
+
+// output(rows, head_size) = input(rows, hidden_size) x weights(hidden_size, head_size) + bias(head_size)
+template <typename T>
+void ProjectHead(const T* input, size_t rows, size_t hidden_size,
+                 const T* weights, size_t ldb, const T* bias, size_t head_size, T* output) {
+  for (size_t r = 0; r < rows; r++) {
+    memcpy(output + r * head_size, bias, head_size * sizeof(T));
+  }
+  MlasGemm(CblasNoTrans, CblasNoTrans, rows, head_size, hidden_size, 1.0f,
+           input, hidden_size, weights, ldb,
+           1.0f, output, head_size, nullptr);
+}
+
+}  // namespace
+
+template <typename T>
+Status LongformerAttention<T>::Compute(OpKernelContext* context) const {
+  const Tensor* input = context->Input<Tensor>(0);
+  const Tensor* weights = context->Input<Tensor>(1);
+  const Tensor* bias = context->Input<Tensor>(2);
+  const Tensor* attention_mask = context->Input<Tensor>(3);
+  const Tensor* global_weights = context->Input<Tensor>(4);
+  const Tensor* global_bias = context->Input<Tensor>(5);
+  const Tensor* global_attention_mask = context->Input<Tensor>(6);
+  ORT_RETURN_IF_ERROR(CheckInputs(input->Shape(), weights->Shape(), bias->Shape(), attention_mask->Shape(),
+                                  global_weights->Shape(), global_bias->Shape(), global_attention_mask->Shape()));
+
+  const auto& shape = input->Shape();
+  const size_t batch_size = static_cast<size_t>(shape[0]);
+  const size_t sequence_length = static_cast<size_t>(shape[1]);
+  const size_t hidden_size = static_cast<size_t>(shape[2]);
+  const size_t num_heads = static_cast<size_t>(num_heads_);
+  const size_t head_size = hidden_size / num_heads;
+  const size_t window = static_cast<size_t>(window_);
+
+  Tensor* output = context->Output(0, shape);
+
+  const T* input_data = input->Data<T>();
+  const T* weights_data = weights->Data<T>();
+  const T* bias_data = bias->Data<T>();
+  const T* mask_data = attention_mask->Data<T>();
+  const T* global_weights_data = global_weights->Data<T>();
+  const T* global_bias_data = global_bias->Data<T>();
+  const int32_t* global_data = global_attention_mask->Data<int32_t>();
+  T* output_data = output->MutableData<T>();
+  const bool use_merged_qkv_weights = (weights->Shape().NumDimensions() == 2);
+
+  // Positions of the global tokens of each batch.
+  std::vector<std::vector<size_t>> global_index(batch_size);
+  size_t max_num_global = 0;
+  for (size_t b = 0; b < batch_size; b++) {
+    for (size_t s = 0; s < sequence_length; s++) {
+      if (global_data[b * sequence_length + s] != 0) {
+        global_index[b].push_back(s);
+      }
+    }
+    max_num_global = std::max(max_num_global, global_index[b].size());
+  }
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+  ThreadPool* tp = context->GetOperatorThreadPool();
+
+  // Q, K and V of all tokens, then global K and V when there are global tokens, each with shape (B, N, S, H).
+  // Global Q is only needed for the global tokens, so it is projected with their attention.
+  const Projection buffer_projections[] = {kQuery, kKey, kValue, kGlobalKey, kGlobalValue};
+  const size_t num_projections = max_num_global > 0 ? 5 : 3;
+  const size_t projection_size = SafeInt<size_t>(batch_size) * sequence_length * hidden_size;
+  auto qkv = IAllocator::MakeUniquePtr<T>(allocator, SafeInt<size_t>(projection_size) * num_projections);
+  const T* q_data = qkv.get();
+  const T* k_data = q_data + projection_size;
+  const T* v_data = k_data + projection_size;
+  const T* global_k_data = v_data + projection_size;
+  const T* global_v_data = global_k_data + projection_size;
+
+  const size_t head_stride = sequence_length * head_size;
+  {
+    const double cost = static_cast<double>(sequence_length) * static_cast<double>(head_size) *
+                        static_cast<double>(hidden_size);
+    ThreadPool::TryParallelFor(
+        tp, static_cast<std::ptrdiff_t>(batch_size * num_heads * num_projections), cost,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+          for (std::ptrdiff_t i = begin; i != end; ++i) {
+            const size_t batch_index = static_cast<size_t>(i) / (num_heads * num_projections);
+            const size_t head_index = (static_cast<size_t>(i) / num_projections) % num_heads;
+            const size_t buffer_index = static_cast<size_t>(i) % num_projections;
+
+            const T* projection_weights = nullptr;
+            const T* projection_bias = nullptr;
+            size_t ldb = 0;
+            GetProjectionWeights(buffer_projections[buffer_index], use_merged_qkv_weights, hidden_size,
+                                 weights_data, bias_data, global_weights_data, global_bias_data,
+                                 projection_weights, ldb, projection_bias);
+
+            T* dest = qkv.get() + buffer_index * projection_size + (batch_index * num_heads + head_index) * head_stride;
+            ProjectHead(input_data + batch_index * sequence_length * hidden_size, sequence_length, hidden_size,
+                        projection_weights + head_index * head_size, ldb, projection_bias + head_index * head_size,
+                        head_size, dest);
+          }
+        });
+  }
+
+  const float scale = 1.0f / std::sqrt(static_cast<float>(head_size));
+
+  // Local attention. A block of W rows attends to the keys in [row_begin - W, row_begin + 2W), and a row to the keys
+  // in [row - W, row + W] of that band and to the global tokens outside of its window. The sequence length is a
+  // multiple of 2W, so the blocks cover the sequence exactly.
+  const size_t num_blocks = sequence_length / window;
+  const size_t band_size = 3 * window;
+  const size_t local_scratch_size = SafeInt<size_t>(window) * (band_size + max_num_global) +
+                                    SafeInt<size_t>(2) * max_num_global * head_size;
+  {
+    const double cost = static_cast<double>(window) * static_cast<double>(band_size + max_num_global) *
+                        static_cast<double>(2 * head_size + 4);
+    ThreadPool::TryParallelFor(
+        tp, static_cast<std::ptrdiff_t>(batch_size * num_heads * num_blocks), cost,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+          auto scratch = IAllocator::MakeUniquePtr<T>(allocator, local_scratch_size);
+
+          for (std::ptrdiff_t i = begin; i != end; ++i) {
+            const size_t batch_index = static_cast<size_t>(i) / (num_heads * num_blocks);
+            const size_t head_index = (static_cast<size_t>(i) / num_blocks) % num_heads;
+            const size_t row_begin = (static_cast<size_t>(i) % num_blocks) * window;
+            const size_t column_begin = row_begin >= window ? row_begin - window : 0;
+            const size_t band = std::min(sequence_length, row_begin + 2 * window) - column_begin;
+
+            const size_t head_offset = (batch_index * num_heads + head_index) * head_stride;
+            const T* q = q_data + head_offset;
+            const T* k = k_data + head_offset;
+            const T* v = v_data + head_offset;
+            const T* mask = mask_data + batch_index * sequence_length;
+            const std::vector<size_t>& globals = global_index[batch_index];
+            const size_t num_global = globals.size();
+
+            T* scores = scratch.get();
+            T* global_scores = scores + window * band_size;
+            T* global_keys = global_scores + window * max_num_global;
+            T* global_values = global_keys + max_num_global * head_size;
+
+            // scores(W, band) = Q(W, H) x K(band, H)'
+            MlasGemm(CblasNoTrans, CblasTrans, window, band, head_size, 1.0f,
+                     q + row_begin * head_size, head_size, k + column_begin * head_size, head_size,
+                     0.0f, scores, band, nullptr);
+
+            // global_scores(W, G) = Q(W, H) x K_global(G, H)', where K_global are the keys of the global tokens.
+            if (num_global > 0) {
+              for (size_t g = 0; g < num_global; g++) {
+                memcpy(global_keys + g * head_size, k + globals[g] * head_size, head_size * sizeof(T));
+                memcpy(global_values + g * head_size, v + globals[g] * head_size, head_size * sizeof(T));
+              }
+              MlasGemm(CblasNoTrans, CblasTrans, window, num_global, head_size, 1.0f,
+                       q + row_begin * head_size, head_size, global_keys, head_size,
+                       0.0f, global_scores, num_global, nullptr);
+            }
+
+            for (size_t r = 0; r < window; r++) {
+              const size_t row = row_begin + r;
+              T* row_scores = scores + r * band;
+              T* row_global_scores = global_scores + r * num_global;
+
+              // The window of the row in the band. Global tokens in the window are only counted once.
+              const size_t first = (row >= window ? row - window : 0) - column_begin;
+              const size_t last = std::min(sequence_length, row + window + 1) - column_begin;
+              auto in_window = [row, window](size_t column) { return column + window >= row && column <= row + window; };
+
+              // The rows of masked tokens are zero, like in Huggingface transformers.
+              if (mask[row] < 0.0f) {
+                std::fill_n(row_scores, band, 0.0f);
+                std::fill_n(row_global_scores, num_global, 0.0f);
+                continue;
+              }
+
+              float max_score = std::numeric_limits<float>::lowest();
+              for (size_t c = first; c < last; c++) {
+                row_scores[c] = row_scores[c] * scale + mask[column_begin + c];
+                max_score = std::max(max_score, row_scores[c]);
+              }
+              for (size_t g = 0; g < num_global; g++) {
+                if (!in_window(globals[g])) {
+                  row_global_scores[g] = row_global_scores[g] * scale + mask[globals[g]];
+                  max_score = std::max(max_score, row_global_scores[g]);
+                }
+              }
+
+              for (size_t c = first; c < last; c++) {
+                row_scores[c] -= max_score;
+              }
+              MlasComputeExp(row_scores + first, row_scores + first, last - first);
+              std::fill(row_scores, row_scores + first, 0.0f);
+              std::fill(row_scores + last, row_scores + band, 0.0f);
+              float sum = 0.0f;
+              for (size_t c = first; c < last; c++) {
+                sum += row_scores[c];
+              }
+              for (size_t g = 0; g < num_global; g++) {
+                row_global_scores[g] = in_window(globals[g]) ? 0.0f : std::exp(row_global_scores[g] - max_score);
+                sum += row_global_scores[g];
+              }
+
+              const float inv_sum = 1.0f / sum;
+              for (size_t c = first; c < last; c++) {
+                row_scores[c] *= inv_sum;
+              }
+              for (size_t g = 0; g < num_global; g++) {
+                row_global_scores[g] *= inv_sum;
+              }
+            }
+
+            // output(W, H) = scores(W, band) x V(band, H) + global_scores(W, G) x V_global(G, H)
+            T* out = output_data + (batch_index * sequence_length + row_begin) * hidden_size + head_index * head_size;
+            MlasGemm(CblasNoTrans, CblasNoTrans, window, head_size, band, 1.0f,
+                     scores, band, v + column_begin * head_size, head_size,
+                     0.0f, out, hidden_size, nullptr);
+            if (num_global > 0) {
+              MlasGemm(CblasNoTrans, CblasNoTrans, window, head_size, num_global, 1.0f,
+                       global_scores, num_global, global_values, head_size,
+                       1.0f, out, hidden_size, nullptr);
+            }
+          }
+        });
+  }
+
+  if (max_num_global == 0) {
+    return Status::OK();
+  }
+
+  // Global attention. The global tokens attend to all tokens with the global Q, K and V, and their output replaces
+  // the output of the local attention.
+  auto global_input = IAllocator::MakeUniquePtr<T>(allocator,
+                                                   SafeInt<size_t>(batch_size) * max_num_global * hidden_size);
+  for (size_t b = 0; b < batch_size; b++) {
+    for (size_t g = 0; g < global_index[b].size(); g++) {
+      memcpy(global_input.get() + (b * max_num_global + g) * hidden_size,
+             input_data + (b * sequence_length + global_index[b][g]) * hidden_size,
+             hidden_size * sizeof(T));
+    }
+  }
+
+  const size_t global_scratch_size = SafeInt<size_t>(max_num_global) * (sequence_length + 2 * head_size);
+  {
+    const double cost = static_cast<double>(max_num_global) *
+                        (static_cast<double>(hidden_size + 2 * sequence_length) * static_cast<double>(head_size) +
+                         static_cast<double>(sequence_length) * 4.0);
+    ThreadPool::TryParallelFor(
+        tp, static_cast<std::ptrdiff_t>(batch_size * num_heads), cost,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+          auto scratch = IAllocator::MakeUniquePtr<T>(allocator, global_scratch_size);
+
+          for (std::ptrdiff_t i = begin; i != end; ++i) {
+            const size_t batch_index = static_cast<size_t>(i) / num_heads;
+            const size_t head_index = static_cast<size_t>(i) % num_heads;
+            const std::vector<size_t>& globals = global_index[batch_index];
+            const size_t num_global = globals.size();
+            if (num_global == 0) {
+              continue;
+            }
+
+            const size_t head_offset = (batch_index * num_heads + head_index) * head_stride;
+            const T* mask = mask_data + batch_index * sequence_length;
+
+            T* global_q = scratch.get();
+            T* scores = global_q + num_global * head_size;
+            T* global_output = scores + num_global * sequence_length;
+
+            const T* projection_weights = nullptr;
+            const T* projection_bias = nullptr;
+            size_t ldb = 0;
+            GetProjectionWeights(kGlobalQuery, use_merged_qkv_weights, hidden_size,
+                                 weights_data, bias_data, global_weights_data, global_bias_data,
+                                 projection_weights, ldb, projection_bias);
+            ProjectHead(global_input.get() + batch_index * max_num_global * hidden_size, num_global, hidden_size,
+                        projection_weights + head_index * head_size, ldb, projection_bias + head_index * head_size,
+                        head_size, global_q);
+
+            // scores(G, S) = Q_global(G, H) x K_global(S, H)' * scale
+            MlasGemm(CblasNoTrans, CblasTrans, num_global, sequence_length, head_size, scale,
+                     global_q, head_size, global_k_data + head_offset, head_size,
+                     0.0f, scores, sequence_length, nullptr);
+
+            for (size_t g = 0; g < num_global; g++) {
+              T* row_scores = scores + g * sequence_length;
+              if (mask[globals[g]] < 0.0f) {
+                std::fill_n(row_scores, sequence_length, 0.0f);
+                continue;
+              }
+              for (size_t s = 0; s < sequence_length; s++) {
+                row_scores[s] += mask[s];
+              }
+              MlasComputeSoftmax(row_scores, row_scores, 1, sequence_length, false, nullptr);
+            }
+
+            // output(G, H) = scores(G, S) x V_global(S, H)
+            MlasGemm(CblasNoTrans, CblasNoTrans, num_global, head_size, sequence_length, 1.0f,
+                     scores, sequence_length, global_v_data + head_offset, head_size,
+                     0.0f, global_output, head_size, nullptr);
+
+            for (size_t g = 0; g < num_global; g++) {
+              memcpy(output_data + (batch_index * sequence_length + globals[g]) * hidden_size + head_index * head_size,
+                     global_output + g * head_size, head_size * sizeof(T));
+            }
+          }
+        });
+  }
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
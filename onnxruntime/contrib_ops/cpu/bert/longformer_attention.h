@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+#include "contrib_ops/cpu/bert/longformer_attention_base.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Longformer self attention with a sliding window of W tokens on each side, and global tokens that attend to and are
+// attended by all tokens.
+//
+// The sequence is processed in blocks of W rows: the keys in the window of a block span at most 3W columns, so the
+// scores and the output of a block are two GEMMs over that band plus two GEMMs with the global keys and values.
+// Each (batch, head, block) is independent and the scratch of a thread is O(W * (3W + G)) for G global tokens,
+// instead of the (S, S) scores of full attention.
+template <typename T>
+class LongformerAttention final : public OpKernel, public LongformerAttentionBase {
+ public:
+  LongformerAttention(const OpKernelInfo& info);
+  Status Compute(OpKernelContext* context) const override;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
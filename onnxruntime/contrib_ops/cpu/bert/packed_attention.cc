@@ -0,0 +1,318 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "packed_attention_cpu_base.h"
+
+#include "core/common/narrow.h"
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
+#include <vector>
+
+using onnxruntime::narrow;
+
+namespace onnxruntime {
+namespace contrib {
+
+template <typename T>
+class PackedAttention final : public OpKernel, public PackedAttentionCPUBase {
+ public:
+  explicit PackedAttention(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+
+  Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                 /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
+  Status UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
+                                   int input_idx,
+                                   /*out*/ bool& used_shared_buffers) override;
+
+ private:
+  Status CheckInputs(const TensorShape& input_shape,
+                     const TensorShape& weights_shape,
+                     const TensorShape& bias_shape,
+                     const TensorShape& token_offset_shape,
+                     const TensorShape& cu_seq_len_shape,
+                     const Tensor* relative_position_bias,
+                     PackedAttentionParameters& parameters) const;
+
+  std::vector<int64_t> qkv_hidden_sizes_;  // Q, K, V hidden sizes parsed from the qkv_hidden_sizes attribute.
+  IAllocatorUniquePtr<void> packed_weights_;
+  TensorShape weight_shape_;
+};
+
+// These ops are internal-only, so register outside of onnx
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    PackedAttention,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    PackedAttention<float>);
+
+template <typename T>
+PackedAttention<T>::PackedAttention(const OpKernelInfo& info) : OpKernel(info), PackedAttentionCPUBase(info) {
+  if (!info.GetAttrs<int64_t>("qkv_hidden_sizes", qkv_hidden_sizes_).IsOK()) {
+    qkv_hidden_sizes_.clear();
+  }
+}
+
+template <typename T>
+Status PackedAttention<T>::PrePack(const Tensor& weights, int input_idx, AllocatorPtr alloc,
+                                   /*out*/ bool& is_packed,
+                                   /*out*/ PrePackedWeights* prepacked_weights) {
+  // The Q, K and V projections of all the tokens are a single GEMM, the weights are packed as one matrix.
+  is_packed = false;
+
+  if (1 != input_idx) {
+    return Status::OK();
+  }
+
+  weight_shape_ = weights.Shape();
+  const auto& weights_dims = weight_shape_.GetDims();
+  if (weights_dims.size() != 2) {
+    return Status::OK();
+  }
+
+  const size_t input_hidden_size = narrow<size_t>(weights_dims[0]);
+  const size_t qkv_hidden_size = narrow<size_t>(weights_dims[1]);
+
+  const size_t packed_weights_size = MlasGemmPackBSize(qkv_hidden_size, input_hidden_size);
+  if (packed_weights_size == 0) {
+    return Status::OK();
+  }
+
+  packed_weights_ = IAllocator::MakeUniquePtr<void>(alloc, packed_weights_size, true);
+  // Initialize memory to 0 as there could be some padding associated with pre-packed
+  // buffer memory and we do not want it uninitialized and generate different hashes
+  // if and when we try to cache this pre-packed buffer for sharing between sessions.
+  memset(packed_weights_.get(), 0, packed_weights_size);
+  MlasGemmPackB(CblasNoTrans, qkv_hidden_size, input_hidden_size, weights.Data<T>(), qkv_hidden_size,
+                packed_weights_.get());
+
+  if (prepacked_weights != nullptr) {
+    prepacked_weights->buffers_.push_back(std::move(packed_weights_));
+    prepacked_weights->buffer_sizes_.push_back(packed_weights_size);
+  }
+
+  is_packed = true;
+  return Status::OK();
+}
+
+template <typename T>
+Status PackedAttention<T>::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
+                                                     int input_idx,
+                                                     /*out*/ bool& used_shared_buffers) {
+  if (1 != input_idx) {
+    return Status::OK();
+  }
+
+  used_shared_buffers = true;
+  packed_weights_ = std::move(prepacked_buffers[0]);
+
+  return Status::OK();
+}
+
+template <typename T>
+Status PackedAttention<T>::CheckInputs(const TensorShape& input_shape,
+                                       const TensorShape& weights_shape,
+                                       const TensorShape& bias_shape,
+                                       const TensorShape& token_offset_shape,
+                                       const TensorShape& cu_seq_len_shape,
+                                       const Tensor* relative_position_bias,
+                                       PackedAttentionParameters& parameters) const {
+  // Abbreviation and Meanings:
+  //   T:    token_count
+  //   B:    batch_size
+  //   S:    sequence_length (input sequence length of query)
+  //   N:    num_heads
+  //   H:    head size for Q and K, aka q_head_size or v_head_size or qk_head_size
+  //   H_v:  v_head_size
+  //   D_i:  input hidden size
+  //   D:    hidden size for Q and K (D = N * H), aka q_hidden_size or k_hidden_size or qk_hidden_size
+  //   D_v:  v_hidden_size = num_heads * v_head_size
+
+  // Input shapes:
+  //   input:                  : (T, D_i)
+  //   weights      (Q/K/V)    : (D_i, D + D + D_v)
+  //   bias         (Q/K/V)    : (D + D + D_v)
+  //   token_offset            : (B, S)
+  //   cu_seq_len_shape        : (B + 1)
+  //   relative_position_bias  : (B, N, S, S), (1, N, S, S) or NULL
+  const auto& input_dims = input_shape.GetDims();
+  if (input_dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'input' is expected to have 2 dimensions in packing mode, got ",
+                           input_dims.size());
+  }
+  int64_t token_count = input_dims[0];
+  int64_t input_hidden_size = input_dims[1];
+
+  const auto& token_offset_dims = token_offset_shape.GetDims();
+  if (token_offset_dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'packing_token_offset' is expected to have 2 dimensions in packing mode, got ",
+                           token_offset_dims.size());
+  }
+
+  int64_t batch_size = token_offset_dims[0];
+  int64_t sequence_length = token_offset_dims[1];
+
+  const auto& bias_dims = bias_shape.GetDims();
+  if (bias_dims.size() != 1) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'bias' is expected to have 1 dimension, got ",
+                           bias_dims.size());
+  }
+
+  const auto& weights_dims = weights_shape.GetDims();
+  if (weights_dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'weights' is expected to have 2 dimensions, got ",
+                           weights_dims.size());
+  }
+  if (weights_dims[0] != input_hidden_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 1 dimension 0 should have same length as dimension 1 of input 0");
+  }
+
+  if (bias_dims[0] != weights_dims[1]) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'bias' dimension 0 should have same length as dimension 1 of input 'weights'");
+  }
+
+  const auto& cu_seq_len_dims = cu_seq_len_shape.GetDims();
+  if (cu_seq_len_dims.size() != 1 || cu_seq_len_dims[0] != batch_size + 1) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'cumulative_sequence_length' should have 1 dimension with size equal to batch_size + 1");
+  }
+
+  const int num_heads = GetNumHeads();
+  int64_t q_hidden_size = bias_dims[0] / static_cast<int64_t>(3);
+  int64_t k_hidden_size = q_hidden_size;
+  int64_t v_hidden_size = k_hidden_size;
+  if (qkv_hidden_sizes_.size() != 0) {
+    if (qkv_hidden_sizes_.size() != 3) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "qkv_hidden_sizes attribute should have 3 elements");
+    }
+
+    q_hidden_size = qkv_hidden_sizes_[0];
+    k_hidden_size = qkv_hidden_sizes_[1];
+    v_hidden_size = qkv_hidden_sizes_[2];
+  }
+
+  for (int64_t hidden_size : {q_hidden_size, k_hidden_size, v_hidden_size}) {
+    if (hidden_size % num_heads != 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "hidden_size should be divisible by num_heads:", hidden_size);
+    }
+  }
+
+  if (q_hidden_size != k_hidden_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "qkv_hidden_sizes first element should be same as the second");
+  }
+
+  if (bias_dims[0] != q_hidden_size + k_hidden_size + v_hidden_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'bias' dimension 0 should have same length as sum of Q/K/V hidden sizes:",
+                           " q_hidden_size=", q_hidden_size, " k_hidden_size=", k_hidden_size, " v_hidden_size=",
+                           v_hidden_size, "bias_dims[0]=", bias_dims[0]);
+  }
+
+  bool broadcast_res_pos_bias = false;
+  ORT_RETURN_IF_ERROR(CheckRelativePositionBias(relative_position_bias, batch_size, sequence_length,
+                                                broadcast_res_pos_bias));
+
+  parameters.batch_size = static_cast<int>(batch_size);
+  parameters.sequence_length = static_cast<int>(sequence_length);
+  parameters.input_hidden_size = static_cast<int>(input_hidden_size);
+  parameters.hidden_size = static_cast<int>(q_hidden_size);
+  parameters.v_hidden_size = static_cast<int>(v_hidden_size);
+  parameters.head_size = static_cast<int>(q_hidden_size) / num_heads;
+  parameters.v_head_size = static_cast<int>(v_hidden_size) / num_heads;
+  parameters.num_heads = num_heads;
+  parameters.scale = GetScale();
+  parameters.token_count = static_cast<int32_t>(token_count);
+  parameters.has_relative_position_bias = nullptr != relative_position_bias;
+  parameters.broadcast_res_pos_bias = broadcast_res_pos_bias;
+
+  return Status::OK();
+}
+
+template <typename T>
+Status PackedAttention<T>::Compute(OpKernelContext* context) const {
+  const Tensor* input = context->Input<Tensor>(0);
+  const Tensor* weights = packed_weights_ ? nullptr : context->Input<Tensor>(1);
+  const Tensor* bias = context->Input<Tensor>(2);
+  const Tensor* token_offset = context->Input<Tensor>(3);
+  const Tensor* cumulative_sequence_length = context->Input<Tensor>(4);
+  const Tensor* relative_position_bias = context->Input<Tensor>(5);
+
+  PackedAttentionParameters parameters;
+  ORT_RETURN_IF_ERROR(CheckInputs(input->Shape(),
+                                  weights ? weights->Shape() : weight_shape_,
+                                  bias->Shape(),
+                                  token_offset->Shape(),
+                                  cumulative_sequence_length->Shape(),
+                                  relative_position_bias,
+                                  parameters));
+
+  const int32_t* cu_seq_len = cumulative_sequence_length->Data<int32_t>();
+  ORT_RETURN_IF_ERROR(CheckCumulativeSequenceLength(cu_seq_len, parameters));
+
+  TensorShapeVector output_shape{parameters.token_count, parameters.v_hidden_size};
+  Tensor* output = context->Output(0, output_shape);
+  if (parameters.token_count == 0) {
+    return Status::OK();
+  }
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+
+  auto* tp = context->GetOperatorThreadPool();
+
+  const size_t token_count = static_cast<size_t>(parameters.token_count);
+  const size_t input_hidden_size = static_cast<size_t>(parameters.input_hidden_size);
+  const size_t qkv_hidden_size = static_cast<size_t>(parameters.hidden_size) * 2 + parameters.v_hidden_size;
+
+  // QKV(T, D + D + D_v) = input(T, D_i) x weights(D_i, D + D + D_v) + bias. The rows only hold real tokens, so
+  // this is one GEMM over the packed tokens: the padding is never projected.
+  auto qkv_data = allocator->Alloc(SafeInt<size_t>(token_count) * qkv_hidden_size * sizeof(T));
+  BufferUniquePtr qkv_buffer(qkv_data, BufferDeleter(std::move(allocator)));
+  T* qkv = static_cast<T*>(qkv_data);
+
+  const T* bias_data = bias->Data<T>();
+  for (size_t t = 0; t < token_count; t++) {
+    memcpy(qkv + t * qkv_hidden_size, bias_data, qkv_hidden_size * sizeof(T));
+  }
+
+  if (packed_weights_) {
+    MlasGemm(CblasNoTrans, token_count, qkv_hidden_size, input_hidden_size, 1.0f,
+             input->Data<T>(), input_hidden_size, packed_weights_.get(),
+             1.0f, qkv, qkv_hidden_size, tp);
+  } else {
+    MlasGemm(CblasNoTrans, CblasNoTrans, token_count, qkv_hidden_size, input_hidden_size, 1.0f,
+             input->Data<T>(), input_hidden_size, weights->Data<T>(), qkv_hidden_size,
+             1.0f, qkv, qkv_hidden_size, tp);
+  }
+
+  // Heads are contiguous in each of the Q, K and V column ranges of a QKV row.
+  const T* Q = qkv;
+  const T* K = Q + parameters.hidden_size;
+  const T* V = K + parameters.hidden_size;
+  return ApplyPackedAttention(Q, qkv_hidden_size, K, qkv_hidden_size, V, qkv_hidden_size,
+                              static_cast<size_t>(parameters.head_size),
+                              static_cast<size_t>(parameters.v_head_size),
+                              cu_seq_len,
+                              relative_position_bias != nullptr ? relative_position_bias->Data<T>() : nullptr,
+                              parameters, output->MutableData<T>(), context);
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
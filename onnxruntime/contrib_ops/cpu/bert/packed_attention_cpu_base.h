@@ -0,0 +1,194 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cmath>
+
+#include "attention_common.h"
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Shared part of PackedAttention and PackedMultiHeadAttention on CPU.
+//
+// In packing mode the tokens of all the sequences are stored back to back without padding: sequence b owns the rows
+// cumulative_sequence_length[b] to cumulative_sequence_length[b + 1] - 1 of Q, K, V and of the output. Each sequence
+// only attends to its own tokens, so the attention of sequence b and head n is two GEMMs of its own length on
+// strided views of the packed rows and no FLOP is spent on padding. Neither a mask nor a transpose is needed.
+class PackedAttentionCPUBase {
+ protected:
+  explicit PackedAttentionCPUBase(const OpKernelInfo& info) {
+    int64_t num_heads = 0;
+    ORT_ENFORCE(info.GetAttr("num_heads", &num_heads).IsOK() && num_heads > 0);
+    num_heads_ = static_cast<int>(num_heads);
+
+    scale_ = info.GetAttrOrDefault<float>("scale", 0.0f);
+  }
+
+  int GetNumHeads() const { return num_heads_; }
+  float GetScale() const { return scale_; }
+
+  Status CheckRelativePositionBias(const Tensor* relative_position_bias,
+                                   int64_t batch_size,
+                                   int64_t sequence_length,
+                                   bool& broadcast_res_pos_bias) const {
+    broadcast_res_pos_bias = false;
+    if (relative_position_bias == nullptr) {
+      return Status::OK();
+    }
+
+    const auto& relative_position_bias_dims = relative_position_bias->Shape().GetDims();
+    if (relative_position_bias_dims.size() != 4) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'relative_position_bias' is expected to have 4 dimensions, got ",
+                             relative_position_bias_dims.size());
+    }
+
+    if (relative_position_bias_dims[0] != batch_size && relative_position_bias_dims[0] != 1) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'relative_position_bias' dimension 0 should be same as batch_size or 1, got ",
+                             relative_position_bias_dims[0]);
+    }
+    broadcast_res_pos_bias = (relative_position_bias_dims[0] == 1);
+
+    if (relative_position_bias_dims[1] != num_heads_) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'relative_position_bias' dimension 1 should be same as number of heads, got ",
+                             relative_position_bias_dims[1]);
+    }
+
+    if (relative_position_bias_dims[2] != sequence_length || relative_position_bias_dims[3] != sequence_length) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'relative_position_bias' dimension 2 and 3 should be same as sequence_length, got ",
+                             relative_position_bias_dims[2], " and ", relative_position_bias_dims[3]);
+    }
+
+    return Status::OK();
+  }
+
+  // The GEMMs below index the packed rows with the content of cumulative_sequence_length, check it before use.
+  static Status CheckCumulativeSequenceLength(const int32_t* cumulative_sequence_length,
+                                              const PackedAttentionParameters& parameters) {
+    if (cumulative_sequence_length[0] != 0 ||
+        cumulative_sequence_length[parameters.batch_size] != parameters.token_count) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'cumulative_sequence_length' should start with 0 and end with token_count ",
+                             parameters.token_count);
+    }
+
+    for (int b = 0; b < parameters.batch_size; b++) {
+      const int32_t length = cumulative_sequence_length[b + 1] - cumulative_sequence_length[b];
+      if (length < 0 || length > parameters.sequence_length) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                               "Input 'cumulative_sequence_length' has a sequence of ", length,
+                               " tokens, expected between 0 and ", parameters.sequence_length);
+      }
+    }
+
+    return Status::OK();
+  }
+
+  // Computes output(t, n * H_v : (n + 1) * H_v) = Softmax(scale x Q_n K_n' + relative_position_bias) V_n for each
+  // sequence, where Q_n, K_n and V_n are the rows of the sequence restricted to head n. Row t of Q starts at
+  // Q + t * ldq and its head n at an offset of n * qk_head_stride, same for K; V uses ldv and v_head_stride.
+  template <typename T>
+  Status ApplyPackedAttention(const T* Q, size_t ldq,
+                              const T* K, size_t ldk,
+                              const T* V, size_t ldv,
+                              size_t qk_head_stride,
+                              size_t v_head_stride,
+                              const int32_t* cumulative_sequence_length,
+                              const T* relative_position_bias,
+                              const PackedAttentionParameters& parameters,
+                              T* output,
+                              OpKernelContext* context) const {
+    const int batch_size = parameters.batch_size;
+    const int sequence_length = parameters.sequence_length;
+    const int num_heads = parameters.num_heads;
+    const size_t head_size = static_cast<size_t>(parameters.head_size);
+    const size_t v_head_size = static_cast<size_t>(parameters.v_head_size);
+    const size_t v_hidden_size = static_cast<size_t>(parameters.v_hidden_size);
+    const float alpha = parameters.scale == 0.0f ? 1.0f / std::sqrt(static_cast<float>(head_size))
+                                                 : parameters.scale;
+
+    // The scores of sequence b and head n are a L_b x L_b block, L_b being the length of the sequence.
+    InlinedVector<size_t> probs_offset(static_cast<size_t>(batch_size) + 1);
+    probs_offset[0] = 0;
+    for (int b = 0; b < batch_size; b++) {
+      const size_t length = static_cast<size_t>(cumulative_sequence_length[b + 1] - cumulative_sequence_length[b]);
+      probs_offset[b + 1] = probs_offset[b] + SafeInt<size_t>(length) * length * num_heads;
+    }
+    if (probs_offset[batch_size] == 0) {
+      return Status::OK();
+    }
+
+    AllocatorPtr allocator;
+    ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+    auto attention_probs = allocator->Alloc(SafeInt<size_t>(probs_offset[batch_size]) * sizeof(T));
+    BufferUniquePtr scratch_buffer(attention_probs, BufferDeleter(std::move(allocator)));
+    T* probs_data = static_cast<T*>(attention_probs);
+
+    // The sequences have different lengths, the cost of a (sequence, head) pair is estimated with the mean
+    // length so that the thread pool splits the work in comparable blocks.
+    const double mean_square_length = static_cast<double>(probs_offset[batch_size]) / (batch_size * num_heads);
+    const double cost = mean_square_length * static_cast<double>(head_size + v_head_size + 1);
+
+    const std::ptrdiff_t loop_len = static_cast<std::ptrdiff_t>(batch_size) * num_heads;
+    concurrency::ThreadPool::TryParallelFor(
+        context->GetOperatorThreadPool(), loop_len, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+          for (std::ptrdiff_t i = begin; i != end; ++i) {
+            const int batch_index = static_cast<int>(i / num_heads);
+            const int head_index = static_cast<int>(i % num_heads);
+            const size_t token_begin = static_cast<size_t>(cumulative_sequence_length[batch_index]);
+            const size_t length = static_cast<size_t>(cumulative_sequence_length[batch_index + 1]) - token_begin;
+            if (length == 0) {
+              continue;
+            }
+
+            T* probs = probs_data + probs_offset[batch_index] + length * length * head_index;
+
+            // probs(L, L) = Q_n(L, H) x K_n'(H, L)
+            MlasGemm(CblasNoTrans, CblasTrans, length, length, head_size, 1.0f,
+                     Q + token_begin * ldq + head_index * qk_head_stride, ldq,
+                     K + token_begin * ldk + head_index * qk_head_stride, ldk,
+                     0.0f, probs, length, nullptr);
+
+            // probs(L, L) = Softmax(alpha x probs + relative_position_bias(L, L)), the bias of the sequence is the
+            // top left L x L block of its S x S matrix.
+            MLAS_FUSED_SOFTMAX_PARAMS softmax_params;
+            softmax_params.SequenceLength = length;
+            softmax_params.TotalSequenceLength = length;
+            softmax_params.Scale = alpha;
+            if (relative_position_bias != nullptr) {
+              const size_t bias_batch = parameters.broadcast_res_pos_bias ? 0 : static_cast<size_t>(batch_index);
+              softmax_params.Bias.Data = relative_position_bias +
+                                         (bias_batch * num_heads + head_index) * sequence_length * sequence_length;
+              softmax_params.Bias.RowStride = static_cast<size_t>(sequence_length);
+            }
+            MlasComputeFusedSoftmax(probs, probs, softmax_params, nullptr);
+
+            // output(L, H_v) = probs(L, L) x V_n(L, H_v), written in place in the packed output rows.
+            MlasGemm(CblasNoTrans, CblasNoTrans, length, v_head_size, length, 1.0f,
+                     probs, length,
+                     V + token_begin * ldv + head_index * v_head_stride, ldv,
+                     0.0f, output + token_begin * v_hidden_size + head_index * v_head_size, v_hidden_size, nullptr);
+          }
+        });
+
+    return Status::OK();
+  }
+
+  int num_heads_;  // number of attention heads
+  float scale_;    // scale for softmax. Default is 0.0f, which will be replaced by 1/sqrt(head_size)
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,296 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "packed_attention_cpu_base.h"
+
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+template <typename T>
+class PackedMultiHeadAttention final : public OpKernel, public PackedAttentionCPUBase {
+ public:
+  explicit PackedMultiHeadAttention(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  Status CheckInputs(const TensorShape& query_shape,
+                     const Tensor* key,
+                     const Tensor* value,
+                     const Tensor* bias,
+                     const TensorShape& token_offset_shape,
+                     const TensorShape& cu_seq_len_shape,
+                     const Tensor* relative_position_bias,
+                     PackedAttentionParameters& parameters) const;
+};
+
+// These ops are internal-only, so register outside of onnx
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    PackedMultiHeadAttention,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    PackedMultiHeadAttention<float>);
+
+template <typename T>
+PackedMultiHeadAttention<T>::PackedMultiHeadAttention(const OpKernelInfo& info)
+    : OpKernel(info), PackedAttentionCPUBase(info) {
+}
+
+template <typename T>
+Status PackedMultiHeadAttention<T>::CheckInputs(const TensorShape& query_shape,
+                                                const Tensor* key,
+                                                const Tensor* value,
+                                                const Tensor* bias,
+                                                const TensorShape& token_offset_shape,
+                                                const TensorShape& cu_seq_len_shape,
+                                                const Tensor* relative_position_bias,
+                                                PackedAttentionParameters& parameters) const {
+  // Shapes of inputs and output:
+  // When Q, K and V are not packed:
+  //   Input 'query':                      (token_count, hidden_size)
+  //   Input 'key':                        (token_count, hidden_size)
+  //   Input 'value':                      (token_count, v_hidden_size)
+  // When Q, K and V are packed:
+  //   Input 'query':                      (token_count, num_heads, 3, head_size)
+  //   Input 'key':                        None
+  //   Input 'value':                      None
+  // Input 'token_offset':                 (batch_size, sequence_length)
+  // Input 'cumulative_sequence_length':   (batch_size + 1)
+  // Input 'relative_position_bias':       (batch_size or 1, num_heads, sequence_length, sequence_length) or None
+  // Output 'output':                      (token_count, v_hidden_size)
+
+  const int num_heads = GetNumHeads();
+  const auto& query_dims = query_shape.GetDims();
+  if (query_dims.size() != 2 && query_dims.size() != 4) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'query' is expected to have 2 or 4 dimensions in packing mode, got ",
+                           query_dims.size());
+  }
+  int64_t token_count = query_dims[0];
+  int64_t hidden_size = (query_dims.size() == 2) ? query_dims[1] : (query_dims[1] * query_dims[3]);
+
+  const auto& token_offset_dims = token_offset_shape.GetDims();
+  if (token_offset_dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'token_offset' is expected to have 2 dimensions in packing mode, got ",
+                           token_offset_dims.size());
+  }
+
+  int64_t batch_size = token_offset_dims[0];
+  int64_t sequence_length = token_offset_dims[1];
+
+  int64_t v_hidden_size = hidden_size;
+  if (query_dims.size() == 4) {
+    if (key != nullptr || value != nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'key' and 'value' is expected to be empty when 'query' has 4 dimensions in packing mode");
+    }
+    if (query_dims[1] != num_heads || query_dims[2] != 3) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'query' with 4 dimensions is expected to have shape "
+                             "(token_count, num_heads, 3, head_size), got ",
+                             query_shape);
+    }
+  } else {  // query_dims.size() == 2
+    if (key == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'key' is expected when 'query' has 2 dimensions in packing mode");
+    }
+
+    const auto& key_dims = key->Shape().GetDims();
+    if (key_dims.size() != 2) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'key' is expected to have 2 dimension, got ",
+                             key_dims.size());
+    }
+    if (key_dims != query_dims) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'query' and 'key' is expected to have same shape");
+    }
+
+    if (value == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'value' is expected when 'query' has 2 dimensions in packing mode");
+    }
+    const auto& value_dims = value->Shape().GetDims();
+    if (value_dims.size() != 2) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'value' is expected to have 2 dimensions, got ",
+                             value_dims.size());
+    }
+    if (value_dims[0] != token_count) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 2 dimension 0 should have same length as dimension 0 of input 0");
+    }
+    v_hidden_size = value_dims[1];
+
+    if (hidden_size % num_heads != 0 || v_hidden_size % num_heads != 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "hidden_size and v_hidden_size should be divisible by num_heads, got ",
+                             hidden_size, " and ", v_hidden_size);
+    }
+  }
+
+  if (bias != nullptr) {
+    const auto& bias_dims = bias->Shape().GetDims();
+    if (bias_dims.size() != 1) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'bias' is expected to have 1 dimension, got ",
+                             bias_dims.size());
+    }
+
+    if (bias_dims[0] != hidden_size + hidden_size + v_hidden_size) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'bias' size is expected to be ",
+                             hidden_size + hidden_size + v_hidden_size, ", got ", bias_dims[0]);
+    }
+  }
+
+  const auto& cu_seq_len_dims = cu_seq_len_shape.GetDims();
+  if (cu_seq_len_dims.size() != 1 || cu_seq_len_dims[0] != batch_size + 1) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'cumulative_sequence_length' should have 1 dimension with size equal to batch_size + 1");
+  }
+
+  bool broadcast_res_pos_bias = false;
+  ORT_RETURN_IF_ERROR(CheckRelativePositionBias(relative_position_bias, batch_size, sequence_length,
+                                                broadcast_res_pos_bias));
+
+  parameters.batch_size = static_cast<int>(batch_size);
+  parameters.sequence_length = static_cast<int>(sequence_length);
+  parameters.input_hidden_size = -1;  // not applicable
+  parameters.hidden_size = static_cast<int>(hidden_size);
+  parameters.v_hidden_size = static_cast<int>(v_hidden_size);
+  parameters.head_size = static_cast<int>(hidden_size) / num_heads;
+  parameters.v_head_size = static_cast<int>(v_hidden_size) / num_heads;
+  parameters.num_heads = num_heads;
+  parameters.scale = GetScale();
+  parameters.token_count = static_cast<int32_t>(token_count);
+  parameters.has_relative_position_bias = (nullptr != relative_position_bias);
+  parameters.broadcast_res_pos_bias = broadcast_res_pos_bias;
+
+  return Status::OK();
+}
+
+template <typename T>
+Status PackedMultiHeadAttention<T>::Compute(OpKernelContext* context) const {
+  const Tensor* query = context->Input<Tensor>(0);
+  const Tensor* key = context->Input<Tensor>(1);
+  const Tensor* value = context->Input<Tensor>(2);
+  const Tensor* bias = context->Input<Tensor>(3);
+  const Tensor* token_offset = context->Input<Tensor>(4);
+  const Tensor* cumulative_sequence_length = context->Input<Tensor>(5);
+  const Tensor* relative_position_bias = context->Input<Tensor>(6);
+
+  PackedAttentionParameters parameters;
+  ORT_RETURN_IF_ERROR(CheckInputs(query->Shape(),
+                                  key,
+                                  value,
+                                  bias,
+                                  token_offset->Shape(),
+                                  cumulative_sequence_length->Shape(),
+                                  relative_position_bias,
+                                  parameters));
+
+  const int32_t* cu_seq_len = cumulative_sequence_length->Data<int32_t>();
+  ORT_RETURN_IF_ERROR(CheckCumulativeSequenceLength(cu_seq_len, parameters));
+
+  TensorShapeVector output_shape{parameters.token_count, parameters.v_hidden_size};
+  Tensor* output = context->Output(0, output_shape);
+  if (parameters.token_count == 0) {
+    return Status::OK();
+  }
+
+  const T* relative_position_bias_data = relative_position_bias != nullptr ? relative_position_bias->Data<T>()
+                                                                           : nullptr;
+
+  const size_t token_count = static_cast<size_t>(parameters.token_count);
+  const size_t num_heads = static_cast<size_t>(parameters.num_heads);
+  const size_t head_size = static_cast<size_t>(parameters.head_size);
+  const size_t v_head_size = static_cast<size_t>(parameters.v_head_size);
+  const size_t hidden_size = static_cast<size_t>(parameters.hidden_size);
+  const size_t v_hidden_size = static_cast<size_t>(parameters.v_hidden_size);
+  const bool is_packed_qkv = (key == nullptr);
+
+  // Without bias the attention reads the inputs in place:
+  //   query (T, D), key (T, D), value (T, D_v): head n of a row is at n * H (n * H_v for value).
+  //   packed query (T, N, 3, H): Q, K and V of head n are at (3n, 3n + 1, 3n + 2) * H in a row of N * 3 * H.
+  if (bias == nullptr) {
+    const T* query_data = query->Data<T>();
+    if (is_packed_qkv) {
+      const size_t ld = num_heads * 3 * head_size;
+      return ApplyPackedAttention(query_data, ld, query_data + head_size, ld, query_data + 2 * head_size, ld,
+                                  3 * head_size, 3 * head_size, cu_seq_len, relative_position_bias_data,
+                                  parameters, output->MutableData<T>(), context);
+    }
+
+    return ApplyPackedAttention(query_data, hidden_size, key->Data<T>(), hidden_size, value->Data<T>(), v_hidden_size,
+                                head_size, v_head_size, cu_seq_len, relative_position_bias_data,
+                                parameters, output->MutableData<T>(), context);
+  }
+
+  // With bias, QKV(T, D + D + D_v) = [Q, K, V] + bias is built once, then used like the projection of
+  // PackedAttention.
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+
+  const size_t qkv_hidden_size = hidden_size + hidden_size + v_hidden_size;
+  auto qkv_data = allocator->Alloc(SafeInt<size_t>(token_count) * qkv_hidden_size * sizeof(T));
+  BufferUniquePtr qkv_buffer(qkv_data, BufferDeleter(std::move(allocator)));
+  T* qkv = static_cast<T*>(qkv_data);
+
+  const T* bias_data = bias->Data<T>();
+  const T* query_data = query->Data<T>();
+  const T* key_data = is_packed_qkv ? nullptr : key->Data<T>();
+  const T* value_data = is_packed_qkv ? nullptr : value->Data<T>();
+
+  ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(token_count),
+      static_cast<double>(qkv_hidden_size), [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t t = begin; t != end; ++t) {
+          T* dest = qkv + static_cast<size_t>(t) * qkv_hidden_size;
+          if (is_packed_qkv) {
+            // (N, 3, H) -> (3, N, H)
+            const T* src = query_data + static_cast<size_t>(t) * qkv_hidden_size;
+            for (size_t n = 0; n < num_heads; n++) {
+              for (size_t m = 0; m < 3; m++) {
+                T* d = dest + m * hidden_size + n * head_size;
+                const T* b = bias_data + m * hidden_size + n * head_size;
+                for (size_t h = 0; h < head_size; h++) {
+                  d[h] = src[h] + b[h];
+                }
+                src += head_size;
+              }
+            }
+          } else {
+            const T* src[3] = {query_data + static_cast<size_t>(t) * hidden_size,
+                               key_data + static_cast<size_t>(t) * hidden_size,
+                               value_data + static_cast<size_t>(t) * v_hidden_size};
+            const size_t width[3] = {hidden_size, hidden_size, v_hidden_size};
+            const T* b = bias_data;
+            for (size_t m = 0; m < 3; m++) {
+              for (size_t i = 0; i < width[m]; i++) {
+                dest[i] = src[m][i] + b[i];
+              }
+              dest += width[m];
+              b += width[m];
+            }
+          }
+        }
+      });
+
+  const T* Q = qkv;
+  const T* K = Q + hidden_size;
+  const T* V = K + hidden_size;
+  return ApplyPackedAttention(Q, qkv_hidden_size, K, qkv_hidden_size, V, qkv_hidden_size,
+                              head_size, v_head_size, cu_seq_len, relative_position_bias_data,
+                              parameters, output->MutableData<T>(), context);
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,306 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "paged_attention.h"
+
+#include "core/common/common.h"
+#include "core/common/safeint.h"
+#include "core/framework/allocator.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+static constexpr int kKeyCacheInputIndex = 3;
+static constexpr int kValueCacheInputIndex = 4;
+static constexpr int kPageTableInputIndex = 5;
+static constexpr int kPastSequenceLengthsInputIndex = 6;
+static constexpr int kCumulativeSequenceLengthInputIndex = 7;
+static constexpr int kKeyCacheOutputIndex = 1;
+static constexpr int kValueCacheOutputIndex = 2;
+
+// These ops are internal-only, so register outside of onnx
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    PagedAttention,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .MayInplace(kKeyCacheInputIndex, kKeyCacheOutputIndex)
+        .MayInplace(kValueCacheInputIndex, kValueCacheOutputIndex)
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("M", DataTypeImpl::GetTensorType<int32_t>()),
+    PagedAttention<float>);
+
+template <typename T>
+PagedAttention<T>::PagedAttention(const OpKernelInfo& info) : OpKernel(info) {
+  int64_t num_heads = 0;
+  ORT_ENFORCE(info.GetAttr("num_heads", &num_heads).IsOK() && num_heads > 0);
+  num_heads_ = static_cast<int>(num_heads);
+  scale_ = info.GetAttrOrDefault<float>("scale", 0.0f);
+}
+
+template <typename T>
+Status PagedAttention<T>::Compute(OpKernelContext* context) const {
+  const Tensor* query = context->Input<Tensor>(0);
+  const Tensor* key = context->Input<Tensor>(1);
+  const Tensor* value = context->Input<Tensor>(2);
+  const Tensor* key_cache = context->Input<Tensor>(kKeyCacheInputIndex);
+  const Tensor* value_cache = context->Input<Tensor>(kValueCacheInputIndex);
+  const Tensor* page_table = context->Input<Tensor>(kPageTableInputIndex);
+  const Tensor* past_sequence_lengths = context->Input<Tensor>(kPastSequenceLengthsInputIndex);
+  const Tensor* cumulative_sequence_length = context->Input<Tensor>(kCumulativeSequenceLengthInputIndex);
+
+  const auto& query_dims = query->Shape().GetDims();
+  if (query_dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'query' is expected to have 2 dimensions, got ",
+                           query_dims.size());
+  }
+  if (key->Shape() != query->Shape() || value->Shape() != query->Shape()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'key' and 'value' are expected to have the shape of 'query' ", query->Shape(),
+                           ", got ", key->Shape(), " and ", value->Shape());
+  }
+
+  const int64_t token_count = query_dims[0];
+  const int64_t hidden_size = query_dims[1];
+  const int num_heads = num_heads_;
+  if (hidden_size % num_heads != 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "hidden_size should be divisible by num_heads, got hidden_size ", hidden_size);
+  }
+  const size_t head_size = static_cast<size_t>(hidden_size / num_heads);
+
+  const auto& cache_dims = key_cache->Shape().GetDims();
+  if (cache_dims.size() != 4 || cache_dims[1] != num_heads || cache_dims[3] != static_cast<int64_t>(head_size)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'key_cache' is expected to have shape (num_pages, num_heads, page_size, head_size), "
+                           "got ", key_cache->Shape());
+  }
+  if (value_cache->Shape() != key_cache->Shape()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'value_cache' is expected to have the shape of 'key_cache' ", key_cache->Shape(),
+                           ", got ", value_cache->Shape());
+  }
+  const int64_t num_pages = cache_dims[0];
+  const size_t page_size = static_cast<size_t>(cache_dims[2]);
+
+  const auto& page_table_dims = page_table->Shape().GetDims();
+  if (page_table_dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'page_table' is expected to have 2 dimensions, got ",
+                           page_table_dims.size());
+  }
+  const int64_t batch_size = page_table_dims[0];
+  const int64_t max_pages_per_sequence = page_table_dims[1];
+
+  if (past_sequence_lengths->Shape().NumDimensions() != 1 || past_sequence_lengths->Shape()[0] != batch_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'past_sequence_lengths' is expected to have shape (batch_size), got ",
+                           past_sequence_lengths->Shape());
+  }
+  if (cumulative_sequence_length->Shape().NumDimensions() != 1 ||
+      cumulative_sequence_length->Shape()[0] != batch_size + 1) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'cumulative_sequence_length' is expected to have shape (batch_size + 1), got ",
+                           cumulative_sequence_length->Shape());
+  }
+
+  // The loops below index the packed rows and the pages with these inputs, check them before use.
+  const int32_t* pages_data = page_table->Data<int32_t>();
+  const int32_t* past_data = past_sequence_lengths->Data<int32_t>();
+  const int32_t* cumulative_data = cumulative_sequence_length->Data<int32_t>();
+  if (cumulative_data[0] != 0 || cumulative_data[batch_size] != token_count) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'cumulative_sequence_length' should start with 0 and end with token_count ",
+                           token_count);
+  }
+
+  double total_work = 0.0;
+  for (int64_t b = 0; b < batch_size; b++) {
+    const int32_t new_length = cumulative_data[b + 1] - cumulative_data[b];
+    if (new_length < 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'cumulative_sequence_length' should not be decreasing");
+    }
+    if (past_data[b] < 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'past_sequence_lengths' should not be negative, got ", past_data[b]);
+    }
+
+    const int64_t total_length = static_cast<int64_t>(past_data[b]) + new_length;
+    const int64_t pages = (total_length + static_cast<int64_t>(page_size) - 1) / static_cast<int64_t>(page_size);
+    if (pages > max_pages_per_sequence) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Sequence ", b, " has ", total_length,
+                             " tokens which do not fit in the ", max_pages_per_sequence, " pages of 'page_table'");
+    }
+    for (int64_t p = 0; p < pages; p++) {
+      const int32_t page = pages_data[b * max_pages_per_sequence + p];
+      if (page < 0 || page >= num_pages) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'page_table' has a page out of range: ", page);
+      }
+    }
+
+    total_work += static_cast<double>(new_length) * static_cast<double>(total_length);
+  }
+
+  Tensor* output = context->Output(0, query->Shape());
+  Tensor* key_cache_out = context->Output(kKeyCacheOutputIndex, key_cache->Shape());
+  Tensor* value_cache_out = context->Output(kValueCacheOutputIndex, value_cache->Shape());
+
+  T* k_cache = key_cache_out->MutableData<T>();
+  T* v_cache = value_cache_out->MutableData<T>();
+
+  // The pool is bound to the same buffer for input and output, the copy only happens when the planner could not
+  // share them.
+  if (k_cache != key_cache->Data<T>()) {
+    memcpy(k_cache, key_cache->Data<T>(), key_cache->SizeInBytes());
+  }
+  if (v_cache != value_cache->Data<T>()) {
+    memcpy(v_cache, value_cache->Data<T>(), value_cache->SizeInBytes());
+  }
+
+  if (token_count == 0) {
+    return Status::OK();
+  }
+
+  const T* q_data = query->Data<T>();
+  const T* k_data = key->Data<T>();
+  const T* v_data = value->Data<T>();
+  T* output_data = output->MutableData<T>();
+
+  const float scale = scale_ == 0.0f ? 1.0f / std::sqrt(static_cast<float>(head_size)) : scale_;
+  const size_t ld = static_cast<size_t>(hidden_size);
+  const size_t page_head_size = page_size * head_size;
+
+  // Per thread scratch, sized for the longest run of new tokens: the scaled query, the accumulated output, the
+  // scores of a page and the running max and sum of each row.
+  int32_t max_new_length = 0;
+  for (int64_t b = 0; b < batch_size; b++) {
+    max_new_length = std::max(max_new_length, cumulative_data[b + 1] - cumulative_data[b]);
+  }
+  const size_t scratch_size = SafeInt<size_t>(max_new_length) * (2 * head_size + page_size + 2);
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+
+  // The sequences have different lengths, the cost of a (sequence, head) pair is estimated with the mean
+  // so that the thread pool splits the work in comparable blocks.
+  const double cost = total_work / static_cast<double>(batch_size) * static_cast<double>(2 * head_size + 4);
+
+  ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(batch_size) * num_heads, cost,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        auto scratch = IAllocator::MakeUniquePtr<T>(allocator, scratch_size);
+
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          const int64_t batch_index = static_cast<int64_t>(i / num_heads);
+          const size_t head_index = static_cast<size_t>(i % num_heads);
+          const size_t head_offset = head_index * head_size;
+          const size_t token_begin = static_cast<size_t>(cumulative_data[batch_index]);
+          const size_t new_length = static_cast<size_t>(cumulative_data[batch_index + 1]) - token_begin;
+          if (new_length == 0) {
+            continue;
+          }
+
+          const size_t past_length = static_cast<size_t>(past_data[batch_index]);
+          const size_t total_length = past_length + new_length;
+          const int32_t* pages = pages_data + batch_index * max_pages_per_sequence;
+
+          T* q = scratch.get();
+          T* accumulator = q + new_length * head_size;
+          T* scores = accumulator + new_length * head_size;
+          T* row_max = scores + new_length * page_size;
+          T* row_sum = row_max + new_length;
+
+          // Append the key and value of the new tokens to the pages of this sequence and head.
+          for (size_t j = 0; j < new_length; j++) {
+            const size_t position = past_length + j;
+            const size_t dest_offset = (static_cast<size_t>(pages[position / page_size]) * num_heads + head_index) *
+                                           page_head_size +
+                                       (position % page_size) * head_size;
+            const size_t src_offset = (token_begin + j) * ld + head_offset;
+            memcpy(k_cache + dest_offset, k_data + src_offset, head_size * sizeof(T));
+            memcpy(v_cache + dest_offset, v_data + src_offset, head_size * sizeof(T));
+
+            const T* q_src = q_data + src_offset;
+            for (size_t h = 0; h < head_size; h++) {
+              q[j * head_size + h] = q_src[h] * scale;
+            }
+          }
+
+          std::fill_n(accumulator, new_length * head_size, 0.0f);
+          std::fill_n(row_max, new_length, std::numeric_limits<float>::lowest());
+          std::fill_n(row_sum, new_length, 0.0f);
+
+          // Streaming softmax over the pages: row j is the token at position past_length + j and only attends to
+          // the positions up to its own, so the rows before first_row have nothing to see in the page.
+          for (size_t block_start = 0; block_start < total_length; block_start += page_size) {
+            const size_t block_size = std::min(page_size, total_length - block_start);
+            const size_t first_row = block_start > past_length ? block_start - past_length : 0;
+            const size_t rows = new_length - first_row;
+
+            const size_t page_offset = (static_cast<size_t>(pages[block_start / page_size]) * num_heads + head_index) *
+                                       page_head_size;
+            const T* k_page = k_cache + page_offset;
+            const T* v_page = v_cache + page_offset;
+
+            // scores(rows, block_size) = q(rows, H) x K_page'(H, block_size)
+            MlasGemm(CblasNoTrans, CblasTrans, rows, block_size, head_size, 1.0f,
+                     q + first_row * head_size, head_size, k_page, head_size,
+                     0.0f, scores, block_size, nullptr);
+
+            for (size_t r = 0; r < rows; r++) {
+              const size_t j = first_row + r;
+              T* row_scores = scores + r * block_size;
+              T* row_accumulator = accumulator + j * head_size;
+              const size_t visible = std::min(block_size, past_length + j + 1 - block_start);
+
+              const float block_max = *std::max_element(row_scores, row_scores + visible);
+              if (block_max > row_max[j]) {
+                const float rescale = std::exp(row_max[j] - block_max);
+                row_sum[j] *= rescale;
+                for (size_t h = 0; h < head_size; h++) {
+                  row_accumulator[h] *= rescale;
+                }
+                row_max[j] = block_max;
+              }
+
+              for (size_t c = 0; c < visible; c++) {
+                row_scores[c] -= row_max[j];
+              }
+              MlasComputeExp(row_scores, row_scores, visible);
+              std::fill(row_scores + visible, row_scores + block_size, 0.0f);
+              for (size_t c = 0; c < visible; c++) {
+                row_sum[j] += row_scores[c];
+              }
+            }
+
+            // accumulator(rows, H) += scores(rows, block_size) x V_page(block_size, H)
+            MlasGemm(CblasNoTrans, CblasNoTrans, rows, head_size, block_size, 1.0f,
+                     scores, block_size, v_page, head_size,
+                     1.0f, accumulator + first_row * head_size, head_size, nullptr);
+          }
+
+          for (size_t j = 0; j < new_length; j++) {
+            T* out = output_data + (token_begin + j) * ld + head_offset;
+            const float inv_sum = 1.0f / row_sum[j];
+            for (size_t h = 0; h < head_size; h++) {
+              out[h] = accumulator[j * head_size + h] * inv_sum;
+            }
+          }
+        }
+      });
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Self attention of a ragged batch over a key and value cache stored in pages of a shared pool.
+//
+// The new tokens of sequence b are appended to its pages at positions past_sequence_lengths[b] onwards, then the
+// attention of each (sequence, head) visits the cache one page at a time: a page of one head is a contiguous
+// (page_size, head_size) block, so its scores and its contribution to the output are two GEMMs folded into a
+// running softmax. Sequences in the same batch can have any length and neither padding nor a mask is needed.
+template <typename T>
+class PagedAttention final : public OpKernel {
+ public:
+  PagedAttention(const OpKernelInfo& info);
+  Status Compute(OpKernelContext* context) const override;
+
+ protected:
+  int num_heads_;  // number of attention heads
+  float scale_;    // scale for softmax. Default is 0.0f, which will be replaced by 1/sqrt(head_size)
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/common.h"
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
+
+#include <algorithm>
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+template <typename T>
+class RemovePadding final : public OpKernel {
+ public:
+  explicit RemovePadding(const OpKernelInfo& info) : OpKernel(info) {}
+  Status Compute(OpKernelContext* context) const override;
+};
+
+// These ops are internal-only, so register outside of onnx
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    RemovePadding,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    RemovePadding<float>);
+
+template <typename T>
+Status RemovePadding<T>::Compute(OpKernelContext* context) const {
+  // shape of inputs:
+  //   input:                   (batch_size, sequence_length, hidden_size)
+  //   sequence_token_count:    (batch_size)
+  // shape of outputs:
+  //   output:                  (total_tokens, hidden_size)
+  //   token_offset:            (batch_size, sequence_length)
+  //   cumulated_seq_len:       (batch_size + 1)
+  //   max_token_count:         (1)
+
+  const Tensor* input = context->Input<Tensor>(0);
+  const Tensor* sequence_token_count = context->Input<Tensor>(1);
+
+  const auto& dims = input->Shape().GetDims();
+  if (dims.size() != 3) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'input' is expected to have 3 dimensions, got ",
+                           dims.size());
+  }
+  int64_t batch_size = dims[0];
+  int64_t sequence_length = dims[1];
+  int64_t hidden_size = dims[2];
+
+  if (sequence_token_count->Shape().Size() != batch_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'sequence_token_count' is expected to have batch_size elements, got ",
+                           sequence_token_count->Shape().Size());
+  }
+
+  TensorShapeVector token_offset_shape{batch_size, sequence_length};
+  Tensor* token_offset = context->Output(1, token_offset_shape);
+
+  TensorShapeVector cumulated_seq_len_shape{batch_size + 1};
+  Tensor* cumulated_seq_len = context->Output(2, cumulated_seq_len_shape);
+
+  // Offset of the non-padding tokens first, then of the paddings. The padding is on the right so the tokens of a
+  // sequence are consecutive in both the padded input and the packed output.
+  const int32_t* token_count_data = sequence_token_count->Data<int32_t>();
+  int32_t* token_offset_data = token_offset->MutableData<int32_t>();
+  int32_t* cumulated_seq_len_data = cumulated_seq_len->MutableData<int32_t>();
+
+  int32_t max_token_count = 0;
+  int32_t index = 0;
+  cumulated_seq_len_data[0] = 0;
+  for (int64_t b = 0; b < batch_size; b++) {
+    const int32_t count = token_count_data[b];
+    if (count < 0 || count > sequence_length) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'sequence_token_count' should be between 0 and sequence_length, got ", count);
+    }
+    max_token_count = std::max(max_token_count, count);
+    cumulated_seq_len_data[b + 1] = cumulated_seq_len_data[b] + count;
+
+    for (int32_t s = 0; s < count; s++) {
+      token_offset_data[index++] = static_cast<int32_t>(b * sequence_length + s);
+    }
+  }
+
+  for (int64_t b = 0; b < batch_size; b++) {
+    for (int64_t s = token_count_data[b]; s < sequence_length; s++) {
+      token_offset_data[index++] = static_cast<int32_t>(b * sequence_length + s);
+    }
+  }
+
+  const int64_t total_token_count = cumulated_seq_len_data[batch_size];
+
+  TensorShapeVector output_shape{total_token_count, hidden_size};
+  Tensor* output = context->Output(0, output_shape);
+
+  TensorShapeVector max_token_count_shape{1};
+  Tensor* max_token_count_tensor = context->Output(3, max_token_count_shape);
+  max_token_count_tensor->MutableData<int32_t>()[0] = max_token_count;
+
+  // Each sequence is a single block copy.
+  const T* input_data = input->Data<T>();
+  T* output_data = output->MutableData<T>();
+  const size_t row_bytes = SafeInt<size_t>(hidden_size) * sizeof(T);
+  ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(batch_size),
+      TensorOpCost{static_cast<double>(row_bytes) * sequence_length,
+                   static_cast<double>(row_bytes) * sequence_length, 0},
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t b = begin; b != end; ++b) {
+          memcpy(output_data + static_cast<size_t>(cumulated_seq_len_data[b]) * hidden_size,
+                 input_data + static_cast<size_t>(b) * sequence_length * hidden_size,
+                 row_bytes * token_count_data[b]);
+        }
+      });
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/common.h"
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+template <typename T>
+class RestorePadding final : public OpKernel {
+ public:
+  explicit RestorePadding(const OpKernelInfo& info) : OpKernel(info) {}
+  Status Compute(OpKernelContext* context) const override;
+};
+
+// These ops are internal-only, so register outside of onnx
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    RestorePadding,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    RestorePadding<float>);
+
+template <typename T>
+Status RestorePadding<T>::Compute(OpKernelContext* context) const {
+  // shape of inputs:
+  //   input:                (total_tokens, hidden_size)
+  //   token_offset:         (batch_size, sequence_length)
+  // shape of outputs:
+  //   output:               (batch_size, sequence_length, hidden_size)
+
+  const Tensor* input = context->Input<Tensor>(0);
+  const Tensor* token_offset = context->Input<Tensor>(1);
+
+  const auto& dims = input->Shape().GetDims();
+  if (dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'input' is expected to have 2 dimensions, got ",
+                           dims.size());
+  }
+  int64_t total_tokens = dims[0];
+  int64_t hidden_size = dims[1];
+
+  const auto& token_offset_dims = token_offset->Shape().GetDims();
+  if (token_offset_dims.size() != 2) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'token_offset' is expected to have 2 dimensions, got ",
+                           token_offset_dims.size());
+  }
+  int64_t batch_size = token_offset_dims[0];
+  int64_t sequence_length = token_offset_dims[1];
+  const int64_t padded_tokens = batch_size * sequence_length;
+  if (total_tokens > padded_tokens) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'input' has ", total_tokens,
+                           " tokens, more than batch_size x sequence_length = ", padded_tokens);
+  }
+
+  TensorShapeVector output_shape{batch_size, sequence_length, hidden_size};
+  Tensor* output = context->Output(0, output_shape);
+
+  // Row i of the padded output is token i of the input when i is among the first total_tokens entries of
+  // token_offset and a padding filled with zeros otherwise.
+  const int32_t* token_offset_data = token_offset->Data<int32_t>();
+  for (int64_t i = 0; i < padded_tokens; i++) {
+    if (token_offset_data[i] < 0 || token_offset_data[i] >= padded_tokens) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'token_offset' has an offset out of range: ",
+                             token_offset_data[i]);
+    }
+  }
+
+  const T* input_data = input->Data<T>();
+  T* output_data = output->MutableData<T>();
+  const size_t row_bytes = SafeInt<size_t>(hidden_size) * sizeof(T);
+  ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(padded_tokens),
+      TensorOpCost{static_cast<double>(row_bytes), static_cast<double>(row_bytes), 0},
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          T* dest = output_data + static_cast<size_t>(token_offset_data[i]) * hidden_size;
+          if (i < total_tokens) {
+            memcpy(dest, input_data + static_cast<size_t>(i) * hidden_size, row_bytes);
+          } else {
+            memset(dest, 0, row_bytes);
+          }
+        }
+      });
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "rotary_embedding.h"
+
+#include "core/common/common.h"
+#include "core/platform/threadpool.h"
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+// These ops are internal-only, so register outside of onnx
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    RotaryEmbedding,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("M", DataTypeImpl::GetTensorType<int64_t>()),
+    RotaryEmbedding<float>);
+
+template <typename T>
+RotaryEmbedding<T>::RotaryEmbedding(const OpKernelInfo& info) : OpKernel(info) {
+  interleaved_ = info.GetAttrOrDefault<int64_t>("interleaved", 0) == 1;
+}
+
+template <typename T>
+Status RotaryEmbedding<T>::Compute(OpKernelContext* context) const {
+  const Tensor* input = context->Input<Tensor>(0);
+  const Tensor* position_ids = context->Input<Tensor>(1);
+  const Tensor* cos_cache = context->Input<Tensor>(2);
+  const Tensor* sin_cache = context->Input<Tensor>(3);
+
+  const auto& cache_dims = cos_cache->Shape().GetDims();
+  if (cache_dims.size() != 2 || cache_dims[1] == 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'cos_cache' is expected to have shape (max_sequence_length, head_size / 2), got ",
+                           cos_cache->Shape());
+  }
+  if (sin_cache->Shape() != cos_cache->Shape()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'sin_cache' is expected to have the shape of 'cos_cache' ", cos_cache->Shape(),
+                           ", got ", sin_cache->Shape());
+  }
+  const int64_t max_sequence_length = cache_dims[0];
+  const int64_t half_head_size = cache_dims[1];
+  const int64_t head_size = 2 * half_head_size;
+
+  // Rows of head_size elements are laid out as (batch_size, sequence_length, num_heads) for 3D input and as
+  // (batch_size, num_heads, sequence_length) for 4D input.
+  const auto& input_dims = input->Shape().GetDims();
+  int64_t batch_size = 0;
+  int64_t sequence_length = 0;
+  int64_t num_heads = 0;
+  if (input_dims.size() == 3) {
+    if (input_dims[2] % head_size != 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "The last dimension of 'input' should be a multiple of head_size ", head_size, ", got ",
+                             input_dims[2]);
+    }
+    batch_size = input_dims[0];
+    sequence_length = input_dims[1];
+    num_heads = input_dims[2] / head_size;
+  } else if (input_dims.size() == 4) {
+    if (input_dims[3] != head_size) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "The last dimension of 'input' should be head_size ", head_size, ", got ", input_dims[3]);
+    }
+    batch_size = input_dims[0];
+    num_heads = input_dims[1];
+    sequence_length = input_dims[2];
+  } else {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'input' is expected to have 3 or 4 dimensions, got ",
+                           input_dims.size());
+  }
+
+  const auto& position_dims = position_ids->Shape().GetDims();
+  const bool is_start_position = position_dims.size() == 1 && position_dims[0] == 1;
+  if (!is_start_position &&
+      (position_dims.size() != 2 || position_dims[0] != batch_size || position_dims[1] != sequence_length)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'position_ids' is expected to have shape (1) or (batch_size, sequence_length), got ",
+                           position_ids->Shape());
+  }
+
+  // Check the positions once here so that the rows can read the tables without bounds checks.
+  const int64_t* positions = position_ids->Data<int64_t>();
+  if (is_start_position) {
+    if (positions[0] < 0 || positions[0] + sequence_length > max_sequence_length) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Positions from ", positions[0], " to ",
+                             positions[0] + sequence_length - 1, " are out of the range of 'cos_cache' with ",
+                             max_sequence_length, " positions");
+    }
+  } else {
+    for (int64_t i = 0; i < batch_size * sequence_length; i++) {
+      if (positions[i] < 0 || positions[i] >= max_sequence_length) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Position ", positions[i],
+                               " is out of the range of 'cos_cache' with ", max_sequence_length, " positions");
+      }
+    }
+  }
+
+  Tensor* output = context->Output(0, input->Shape());
+  const int64_t row_count = batch_size * sequence_length * num_heads;
+  if (row_count == 0) {
+    return Status::OK();
+  }
+
+  const T* input_data = input->Data<T>();
+  const T* cos_data = cos_cache->Data<T>();
+  const T* sin_data = sin_cache->Data<T>();
+  T* output_data = output->MutableData<T>();
+  const bool is_4d = input_dims.size() == 4;
+  const bool interleaved = interleaved_;
+
+  ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(row_count),
+      static_cast<double>(head_size * 4),
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          const int64_t row = static_cast<int64_t>(i);
+          const int64_t b = row / (sequence_length * num_heads);
+          const int64_t s = is_4d ? row % sequence_length : (row / num_heads) % sequence_length;
+          const int64_t position = is_start_position ? positions[0] + s : positions[b * sequence_length + s];
+
+          const T* x = input_data + row * head_size;
+          T* y = output_data + row * head_size;
+          const T* cos = cos_data + position * half_head_size;
+          const T* sin = sin_data + position * half_head_size;
+
+          if (interleaved) {
+            for (int64_t h = 0; h < half_head_size; h++) {
+              const T x1 = x[2 * h];
+              const T x2 = x[2 * h + 1];
+              y[2 * h] = x1 * cos[h] - x2 * sin[h];
+              y[2 * h + 1] = x2 * cos[h] + x1 * sin[h];
+            }
+          } else {
+            for (int64_t h = 0; h < half_head_size; h++) {
+              const T x1 = x[h];
+              const T x2 = x[h + half_head_size];
+              y[h] = x1 * cos[h] - x2 * sin[h];
+              y[h + half_head_size] = x2 * cos[h] + x1 * sin[h];
+            }
+          }
+        }
+      });
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Rotary position embedding with the cosine and sine of every position read from cached tables, so no
+// trigonometric function is evaluated at run time. Each head of each token is rotated independently.
+template <typename T>
+class RotaryEmbedding final : public OpKernel {
+ public:
+  RotaryEmbedding(const OpKernelInfo& info);
+  Status Compute(OpKernelContext* context) const override;
+
+ protected:
+  bool interleaved_;  // rotate adjacent pairs instead of the two halves of each head
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -10,7 +10,7 @@ namespace contrib {
 template <typename T>
 class ConvTransposeWithDynamicPads : public ConvTranspose<T> {
  public:
-  ConvTransposeWithDynamicPads(const OpKernelInfo& info) : ConvTranspose<T>(info) {}
+  ConvTransposeWithDynamicPads(const OpKernelInfo& info) : ConvTranspose<T>(info, true) {}
 
   Status Compute(OpKernelContext* context) const override {
     return ConvTranspose<T>::DoConvTranspose(context, true);
@@ -26,5 +26,19 @@ namespace contrib {
 REGISTER_CONTRIB_KERNELS(float)
 REGISTER_CONTRIB_KERNELS(double)
 
+// the contrib op schema only allows float or double for U, so float16 uses float for the mean and inv_std_dev.
+ONNX_OPERATOR_VERSIONED_TYPED_KERNEL_EX(LayerNormalization, kOnnxDomain, 1, 16, MLFloat16, kCpuExecutionProvider,
+                                        KernelDefBuilder()
+                                            .TypeConstraint("T", DataTypeImpl::GetTensorType<MLFloat16>())
+                                            .TypeConstraint("U", DataTypeImpl::GetTensorType<float>())
+                                            .TypeConstraint("V", DataTypeImpl::GetTensorType<MLFloat16>()),
+                                        LayerNorm<false>);
+ONNX_OPERATOR_TYPED_KERNEL_EX(SimplifiedLayerNormalization, kOnnxDomain, 1, MLFloat16, kCpuExecutionProvider,
+                              KernelDefBuilder()
+                                  .TypeConstraint("T", DataTypeImpl::GetTensorType<MLFloat16>())
+                                  .TypeConstraint("U", DataTypeImpl::GetTensorType<float>())
+                                  .TypeConstraint("V", DataTypeImpl::GetTensorType<MLFloat16>()),
+                              LayerNorm<true>);
+
 }  // namespace contrib
 }  // namespace onnxruntime
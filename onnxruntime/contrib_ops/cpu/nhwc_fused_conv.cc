@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//
+// This file contains implementation of a fp32 convolution operator for
+// tensors in channels last (NHWC) format.
+//
+
+#include "core/providers/cpu/nn/fused_conv_gemm.h"
+
+namespace onnxruntime {
+
+//
+// The FP32 convolution runs the shared channels last driver in
+// fused_conv_gemm.h with the single precision GEMM and depthwise kernels. The
+// output is seeded with the fused Sum input and the bias so that the GEMM
+// accumulates on top of them, then the activation is applied in place.
+//
+
+template <>
+size_t FusedConvGemm<float>::PackedFilterSize(size_t N, size_t K) {
+  return MlasGemmPackBSize(N, K);
+}
+
+template <>
+void FusedConvGemm<float>::PackFilter(size_t N, size_t K, const float* B, size_t ldb, void* packed_B) {
+  MlasGemmPackB(CblasNoTrans, N, K, B, ldb, packed_B);
+}
+
+template <>
+void FusedConvGemm<float>::ComputeDepthwise(const float* const* input, const float* filter, const float* bias,
+                                            const float* add_src, float* output, size_t channels,
+                                            size_t output_count, size_t kernel_size,
+                                            bool fuse_add_activation) const {
+  MlasConvDepthwise(input, filter, bias, output, channels, output_count, kernel_size);
+
+  if (fuse_add_activation) {
+    if (add_src != nullptr) {
+      const size_t output_size = output_count * channels;
+      for (size_t i = 0; i < output_size; i++) {
+        output[i] += add_src[i];
+      }
+    }
+    MlasActivation(&activation_, output, nullptr, output_count, channels, channels);
+  }
+}
+
+template <>
+void FusedConvGemm<float>::ComputeGemm(size_t M, size_t N, size_t K, const float* A, size_t lda,
+                                       const void* packed_B, const float* B, size_t ldb, const float* bias,
+                                       const float* add_src, float* C, size_t ldc,
+                                       bool fuse_add_activation) const {
+  if (!fuse_add_activation) {
+    add_src = nullptr;
+  }
+
+  float beta = 0.0f;
+  if (add_src != nullptr || bias != nullptr) {
+    for (size_t m = 0; m < M; m++) {
+      for (size_t n = 0; n < N; n++) {
+        float value = add_src == nullptr ? 0.0f : add_src[m * ldc + n];
+        if (bias != nullptr) {
+          value += bias[n];
+        }
+        C[m * ldc + n] = value;
+      }
+    }
+    beta = 1.0f;
+  }
+
+  MLAS_SGEMM_DATA_PARAMS gemm_params;
+  gemm_params.A = A;
+  gemm_params.lda = lda;
+  if (packed_B != nullptr) {
+    gemm_params.B = static_cast<const float*>(packed_B);
+    gemm_params.BIsPacked = true;
+  } else {
+    gemm_params.B = B;
+    gemm_params.ldb = ldb;
+  }
+  gemm_params.C = C;
+  gemm_params.ldc = ldc;
+  gemm_params.beta = beta;
+
+  MlasGemm(CblasNoTrans, CblasNoTrans, M, N, K, gemm_params, nullptr);
+
+  if (fuse_add_activation) {
+    MlasActivation(&activation_, C, nullptr, M, N, ldc);
+  }
+}
+
+template <>
+void FusedConvGemm<float>::ApplySumActivation(float* output, const float* sum, size_t channels,
+                                              size_t image_size) const {
+  const size_t output_size = channels * image_size;
+  for (size_t i = 0; i < output_size; i++) {
+    output[i] += sum[i];
+  }
+  MlasActivation(&activation_, output, nullptr, channels, image_size, image_size);
+}
+
+namespace contrib {
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NhwcFusedConv,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    FusedConvGemm<float>);
+
+}  // namespace contrib
+}  // namespace onnxruntime
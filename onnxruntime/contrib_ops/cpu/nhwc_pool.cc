@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/cpu/nn/nhwc_pool.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// The FP32 pooling runs the shared channels last kernel in nhwc_pool.h. It is
+// registered in the internal NHWC domain only, for use by the NHWC transformer.
+
+//
+// Operator definitions
+//
+
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    MaxPool,
+    kMSInternalNHWCDomain,
+    12,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NhwcPool<float>);
+
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    AveragePool,
+    kMSInternalNHWCDomain,
+    11,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NhwcPool<float>);
+
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    GlobalAveragePool,
+    kMSInternalNHWCDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NhwcPool<float>);
+
+}  // namespace contrib
+}  // namespace onnxruntime
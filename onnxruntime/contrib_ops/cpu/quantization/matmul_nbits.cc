@@ -0,0 +1,405 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//
+// This module defines MatMulNBits operator, matmul of float32 with right hand
+// side quantized block-wise along K into 4 or 8 bits, with the scales and
+// optional zero points as separate inputs.
+//
+
+#include "core/common/narrow.h"
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/mlas/inc/mlas_q4.h"
+#include "core/platform/threadpool.h"
+#include "core/providers/common.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+namespace {
+
+// Lowest accuracy of the computation that is allowed for input A.
+constexpr int64_t kAccuracyLevelInt8 = 4;
+
+// Columns of B that are dequantized and multiplied together by one task.
+constexpr size_t kColumnTile = 64;
+
+// Zero point of a block: zero_points holds 8 / nbits blocks per byte with the first block in the low bits, and the
+// blocks of every column start at a new byte.
+uint8_t GetZeroPoint(const uint8_t* zero_points, size_t nbits, size_t k_blocks, size_t n, size_t block) {
+  if (zero_points == nullptr) {
+    return static_cast<uint8_t>(1 << (nbits - 1));
+  }
+  if (nbits == 8) {
+    return zero_points[n * k_blocks + block];
+  }
+  const uint8_t zp_pair = zero_points[n * ((k_blocks + 1) / 2) + block / 2];
+  return (block & 1) ? static_cast<uint8_t>(zp_pair >> 4) : static_cast<uint8_t>(zp_pair & 0x0F);
+}
+
+// Unpack count values of a block: 4 bits values are in pairs, with element 2i in the low bits of byte i.
+void UnpackBlock(const uint8_t* blob, size_t nbits, size_t count, uint8_t* values) {
+  if (nbits == 8) {
+    memcpy(values, blob, count);
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    values[i] = static_cast<uint8_t>((blob[i / 2] >> ((i & 1) * 4)) & 0x0F);
+  }
+}
+
+}  // namespace
+
+class MatMulNBits final : public OpKernel {
+ public:
+  MatMulNBits(const OpKernelInfo& info) : OpKernel(info) {
+    int64_t K, N, block_size, nbits;
+    ORT_ENFORCE(info.GetAttr<int64_t>("K", &K).IsOK() && K > 0);
+    ORT_ENFORCE(info.GetAttr<int64_t>("N", &N).IsOK() && N > 0);
+    ORT_ENFORCE(info.GetAttr<int64_t>("block_size", &block_size).IsOK());
+    ORT_ENFORCE(info.GetAttr<int64_t>("bits", &nbits).IsOK());
+    ORT_ENFORCE(nbits == 4 || nbits == 8, "MatMulNBits only supports 4 or 8 bits, got ", nbits);
+    ORT_ENFORCE(block_size >= 16 && block_size <= 256 && (block_size & (block_size - 1)) == 0,
+                "MatMulNBits block_size shall be a power of 2 in [16, 256], got ", block_size);
+    K_ = narrow<size_t>(K);
+    N_ = narrow<size_t>(N);
+    block_size_ = narrow<size_t>(block_size);
+    nbits_ = narrow<size_t>(nbits);
+    accuracy_level_ = info.GetAttrOrDefault<int64_t>("accuracy_level", static_cast<int64_t>(0));
+
+    // B can only be packed together with its scales and zero points, so they shall be constant too.
+    const auto& input_defs = info.node().InputDefs();
+    has_zero_points_ = input_defs.size() > 3 && input_defs[3]->Exists();
+    if (!info.TryGetConstantInput(2, &scales_) ||
+        (has_zero_points_ && !info.TryGetConstantInput(3, &zero_points_))) {
+      scales_ = nullptr;
+      zero_points_ = nullptr;
+    }
+  }
+
+  Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                 /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
+  Status UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers, int input_idx,
+                                   /*out*/ bool& used_shared_buffers) override;
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  // Dequantize B in tiles of columns, and multiply each tile with SGEMM.
+  void ComputeFp32(const float* a_data, const uint8_t* b_data, const float* scales, const uint8_t* zero_points,
+                   float* y_data, size_t M, AllocatorPtr& allocator, concurrency::ThreadPool* thread_pool) const;
+
+  // Quantize A to int8 per block of K, and accumulate the integer dot products of the blocks.
+  void ComputeInt8(const float* a_data, const uint8_t* b_data, const float* scales, const uint8_t* zero_points,
+                   float* y_data, size_t M, AllocatorPtr& allocator, concurrency::ThreadPool* thread_pool) const;
+
+  size_t K_;
+  size_t N_;
+  size_t block_size_;
+  size_t nbits_;
+  int64_t accuracy_level_;
+  bool has_zero_points_{false};
+
+  // Constant scales and zero points, used to pack B.
+  const Tensor* scales_{nullptr};
+  const Tensor* zero_points_{nullptr};
+
+  // B with its scales and zero points in the blob of MlasQ4GemmPackB, when its block layout is one of MLAS.
+  IAllocatorUniquePtr<void> packed_b_;
+  MLAS_BLK_QUANT_TYPE mlas_quant_type_{BlkQ4Sym};
+};
+
+Status MatMulNBits::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                            /*out*/ bool& is_packed,
+                            /*out*/ PrePackedWeights* prepacked_weights) {
+  is_packed = false;
+  if (input_idx != 1 || nbits_ != 4 || scales_ == nullptr) {
+    return Status::OK();
+  }
+
+  const size_t k_blocks = (K_ + block_size_ - 1) / block_size_;
+  if (tensor.Shape().Size() != static_cast<int64_t>(N_ * k_blocks * block_size_ / 2) ||
+      scales_->Shape().Size() != static_cast<int64_t>(N_ * k_blocks) ||
+      (zero_points_ != nullptr && zero_points_->Shape().Size() != static_cast<int64_t>(N_ * ((k_blocks + 1) / 2)))) {
+    // Leave the shapes to be reported by Compute.
+    return Status::OK();
+  }
+
+  // Zero points of 8 are the symmetric quantization of MLAS, which has layouts for more block sizes.
+  const uint8_t* zero_points = zero_points_ != nullptr ? zero_points_->Data<uint8_t>() : nullptr;
+  bool symmetric = true;
+  for (size_t n = 0; n < N_ && zero_points != nullptr && symmetric; n++) {
+    for (size_t block = 0; block < k_blocks; block++) {
+      if (GetZeroPoint(zero_points, nbits_, k_blocks, n, block) != 8) {
+        symmetric = false;
+        break;
+      }
+    }
+  }
+
+  if (block_size_ == 32) {
+    mlas_quant_type_ = symmetric ? BlkQ4Sym : BlkQ4Zp8;
+  } else if (block_size_ == 64 && symmetric) {
+    mlas_quant_type_ = BlkQ4Sym64;
+  } else if (block_size_ == 128 && symmetric) {
+    mlas_quant_type_ = BlkQ4Sym128;
+  } else {
+    return Status::OK();
+  }
+
+  // The size is 0 when the host has no kernel for the layout.
+  const size_t packed_b_size = MlasQ4GemmPackBSize(mlas_quant_type_, N_, K_);
+  if (packed_b_size == 0) {
+    return Status::OK();
+  }
+
+  packed_b_ = IAllocator::MakeUniquePtr<void>(alloc, packed_b_size, true);
+  memset(packed_b_.get(), 0, packed_b_size);
+  MlasQ4GemmPackBQuantized(mlas_quant_type_, packed_b_.get(), tensor.Data<uint8_t>(), scales_->Data<float>(),
+                           zero_points, N_, K_);
+
+  bool share_prepacked_weights = (prepacked_weights != nullptr);
+  if (share_prepacked_weights) {
+    prepacked_weights->buffers_.push_back(std::move(packed_b_));
+    prepacked_weights->buffer_sizes_.push_back(packed_b_size);
+  }
+
+  is_packed = true;
+  return Status::OK();
+}
+
+Status MatMulNBits::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers, int input_idx,
+                                              /*out*/ bool& used_shared_buffers) {
+  used_shared_buffers = false;
+
+  if (input_idx == 1) {
+    used_shared_buffers = true;
+    packed_b_ = std::move(prepacked_buffers[0]);
+  }
+
+  return Status::OK();
+}
+
+void MatMulNBits::ComputeFp32(const float* a_data, const uint8_t* b_data, const float* scales,
+                              const uint8_t* zero_points, float* y_data, size_t M, AllocatorPtr& allocator,
+                              concurrency::ThreadPool* thread_pool) const {
+  const size_t k_blocks = (K_ + block_size_ - 1) / block_size_;
+  const size_t blob_size = block_size_ * nbits_ / 8;
+  const size_t tiles = (N_ + kColumnTile - 1) / kColumnTile;
+
+  const double cost = static_cast<double>(M * K_ * kColumnTile * 2);
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(tiles), cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        // Columns of the tile are rows of K values, which is B transposed.
+        auto tile_buffer = IAllocator::MakeUniquePtr<float>(allocator, SafeInt<size_t>(kColumnTile) * K_);
+        std::vector<uint8_t> values(block_size_);
+
+        for (std::ptrdiff_t tile = begin; tile != end; tile++) {
+          const size_t n_start = static_cast<size_t>(tile) * kColumnTile;
+          const size_t n_count = std::min(kColumnTile, N_ - n_start);
+
+          for (size_t i = 0; i < n_count; i++) {
+            const size_t n = n_start + i;
+            float* column = tile_buffer.get() + i * K_;
+            for (size_t block = 0; block < k_blocks; block++) {
+              const size_t k = block * block_size_;
+              const size_t count = std::min(block_size_, K_ - k);
+              UnpackBlock(b_data + (n * k_blocks + block) * blob_size, nbits_, count, values.data());
+
+              const float scale = scales[n * k_blocks + block];
+              const int zero_point = GetZeroPoint(zero_points, nbits_, k_blocks, n, block);
+              for (size_t l = 0; l < count; l++) {
+                column[k + l] = static_cast<float>(static_cast<int>(values[l]) - zero_point) * scale;
+              }
+            }
+          }
+
+          MlasGemm(CblasNoTrans, CblasTrans, M, n_count, K_, 1.0f, a_data, K_, tile_buffer.get(), K_, 0.0f,
+                   y_data + n_start, N_, nullptr);
+        }
+      });
+}
+
+void MatMulNBits::ComputeInt8(const float* a_data, const uint8_t* b_data, const float* scales,
+                              const uint8_t* zero_points, float* y_data, size_t M, AllocatorPtr& allocator,
+                              concurrency::ThreadPool* thread_pool) const {
+  const size_t k_blocks = (K_ + block_size_ - 1) / block_size_;
+  const size_t blob_size = block_size_ * nbits_ / 8;
+  const size_t padded_k = k_blocks * block_size_;
+
+  // Symmetric quantization of A per block, with the sum of the block to apply the zero point of B once.
+  auto a_quant = IAllocator::MakeUniquePtr<int8_t>(allocator, SafeInt<size_t>(M) * padded_k);
+  auto a_scales = IAllocator::MakeUniquePtr<float>(allocator, SafeInt<size_t>(M) * k_blocks);
+  auto a_sums = IAllocator::MakeUniquePtr<int32_t>(allocator, SafeInt<size_t>(M) * k_blocks);
+
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(M * k_blocks), static_cast<double>(block_size_ * 4),
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i != end; i++) {
+          const size_t m = static_cast<size_t>(i) / k_blocks;
+          const size_t k = (static_cast<size_t>(i) % k_blocks) * block_size_;
+          const size_t count = std::min(block_size_, K_ - k);
+          const float* src = a_data + m * K_ + k;
+          int8_t* dst = a_quant.get() + m * padded_k + k;
+
+          float amax = 0.0f;
+          for (size_t l = 0; l < count; l++) {
+            amax = std::max(amax, std::fabs(src[l]));
+          }
+          const float scale = amax / 127.0f;
+          const float inverse_scale = amax > 0.0f ? 127.0f / amax : 0.0f;
+
+          int32_t sum = 0;
+          for (size_t l = 0; l < block_size_; l++) {
+            const int32_t q = l < count ? static_cast<int32_t>(std::nearbyint(src[l] * inverse_scale)) : 0;
+            dst[l] = static_cast<int8_t>(q);
+            sum += q;
+          }
+          a_scales.get()[i] = scale;
+          a_sums.get()[i] = sum;
+        }
+      });
+
+  const size_t tiles = (N_ + kColumnTile - 1) / kColumnTile;
+  const double cost = static_cast<double>(M * padded_k * kColumnTile * 2);
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(tiles), cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        std::vector<uint8_t> values(block_size_);
+        std::vector<float> sums(M);
+
+        for (std::ptrdiff_t tile = begin; tile != end; tile++) {
+          const size_t n_start = static_cast<size_t>(tile) * kColumnTile;
+          const size_t n_end = std::min(n_start + kColumnTile, N_);
+
+          for (size_t n = n_start; n < n_end; n++) {
+            std::fill(sums.begin(), sums.end(), 0.0f);
+            for (size_t block = 0; block < k_blocks; block++) {
+              // The padding of the block is multiplied by the zeros of A.
+              UnpackBlock(b_data + (n * k_blocks + block) * blob_size, nbits_, block_size_, values.data());
+              const float scale = scales[n * k_blocks + block];
+              const int32_t zero_point = GetZeroPoint(zero_points, nbits_, k_blocks, n, block);
+
+              for (size_t m = 0; m < M; m++) {
+                const int8_t* a_block = a_quant.get() + m * padded_k + block * block_size_;
+                int32_t dot = 0;
+                for (size_t l = 0; l < block_size_; l++) {
+                  dot += static_cast<int32_t>(a_block[l]) * static_cast<int32_t>(values[l]);
+                }
+                const size_t a_index = m * k_blocks + block;
+                dot -= zero_point * a_sums.get()[a_index];
+                sums[m] += static_cast<float>(dot) * a_scales.get()[a_index] * scale;
+              }
+            }
+
+            for (size_t m = 0; m < M; m++) {
+              y_data[m * N_ + n] = sums[m];
+            }
+          }
+        }
+      });
+}
+
+Status MatMulNBits::Compute(OpKernelContext* ctx) const {
+  concurrency::ThreadPool* thread_pool = ctx->GetOperatorThreadPool();
+
+  const Tensor* a = ctx->Input<Tensor>(0);
+  const auto& a_shape = a->Shape();
+  if (a_shape.NumDimensions() == 0 || a_shape[a_shape.NumDimensions() - 1] != static_cast<int64_t>(K_)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'A' is expected to have K=", K_, " in the last dimension, got ", a_shape);
+  }
+
+  // B is a 2D matrix, so all dimensions of A but the last are rows of the product.
+  TensorShapeVector y_dims = a_shape.AsShapeVector();
+  y_dims.back() = static_cast<int64_t>(N_);
+  Tensor* y = ctx->Output(0, y_dims);
+  const size_t M = static_cast<size_t>(a_shape.Size()) / K_;
+  if (y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  const auto* a_data = a->Data<float>();
+  auto* y_data = y->MutableData<float>();
+
+  if (packed_b_ != nullptr) {
+    const bool int8_activation = accuracy_level_ == kAccuracyLevelInt8 &&
+                                 MlasQ80BlkQuantSize(mlas_quant_type_, M, K_) > 0;
+    if (int8_activation) {
+      AllocatorPtr allocator;
+      ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&allocator));
+      const size_t a_quant_size = MlasQ80BlkQuantSize(mlas_quant_type_, M, K_);
+      auto a_quant = IAllocator::MakeUniquePtr<int8_t>(allocator, a_quant_size);
+      MlasQ80BlkQuant(mlas_quant_type_, a_quant.get(), a_data, M, K_, K_, thread_pool);
+
+      MLAS_Q8Q4_GEMM_DATA_PARAMS gemm_params;
+      gemm_params.A = a_quant.get();
+      gemm_params.B = packed_b_.get();
+      gemm_params.C = y_data;
+      gemm_params.ldc = N_;
+      MlasQ8Q4GemmBatch(mlas_quant_type_, M, N_, K_, 1, &gemm_params, thread_pool);
+    } else {
+      MLAS_Q4_GEMM_DATA_PARAMS gemm_params;
+      gemm_params.A = a_data;
+      gemm_params.lda = K_;
+      gemm_params.B = packed_b_.get();
+      gemm_params.C = y_data;
+      gemm_params.ldc = N_;
+      MlasQ4GemmBatch(mlas_quant_type_, M, N_, K_, 1, &gemm_params, thread_pool);
+    }
+    return Status::OK();
+  }
+
+  const Tensor* b = ctx->Input<Tensor>(1);
+  const Tensor* scales = ctx->Input<Tensor>(2);
+  const Tensor* zero_points = ctx->Input<Tensor>(3);
+
+  const size_t k_blocks = (K_ + block_size_ - 1) / block_size_;
+  const size_t blob_size = block_size_ * nbits_ / 8;
+  const TensorShape expected_b_shape({static_cast<int64_t>(N_), static_cast<int64_t>(k_blocks),
+                                      static_cast<int64_t>(blob_size)});
+  if (b->Shape() != expected_b_shape) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'B' is expected to have shape ", expected_b_shape, ", got ", b->Shape());
+  }
+  if (scales->Shape().Size() != static_cast<int64_t>(N_ * k_blocks)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'scales' is expected to have N * ceil(K / block_size) = ", N_ * k_blocks,
+                           " elements, got ", scales->Shape());
+  }
+  const size_t zero_points_per_column = (k_blocks * nbits_ + 7) / 8;
+  if (zero_points != nullptr && zero_points->Shape().Size() != static_cast<int64_t>(N_ * zero_points_per_column)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'zero_points' is expected to have N * ceil(ceil(K / block_size) * bits / 8) = ",
+                           N_ * zero_points_per_column, " elements, got ", zero_points->Shape());
+  }
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&allocator));
+  const uint8_t* zero_points_data = zero_points != nullptr ? zero_points->Data<uint8_t>() : nullptr;
+  if (accuracy_level_ == kAccuracyLevelInt8) {
+    ComputeInt8(a_data, b->Data<uint8_t>(), scales->Data<float>(), zero_points_data, y_data, M, allocator,
+                thread_pool);
+  } else {
+    ComputeFp32(a_data, b->Data<uint8_t>(), scales->Data<float>(), zero_points_data, y_data, M, allocator,
+                thread_pool);
+  }
+
+  return Status::OK();
+}
+
+ONNX_OPERATOR_KERNEL_EX(
+    MatMulNBits,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T1", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("T2", DataTypeImpl::GetTensorType<uint8_t>()),
+    MatMulNBits);
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -31,6 +31,12 @@ class Tokenizer final : public OpKernel {
                          size_t N, size_t C,
                          gsl::span<const int64_t> input_dims) const;
 
+  // Writes the tokens of every row followed by the padding. The tokens of all the rows are views
+  // of the input strings stored back to back, row i owns [row_offsets[i], row_offsets[i + 1]).
+  void OutputTokens(OpKernelContext* ctx, gsl::span<const int64_t> input_dims,
+                    const std::vector<re2::StringPiece>& tokens,
+                    const std::vector<size_t>& row_offsets) const;
+
   bool mark_{false};
   std::string pad_value_;
   int64_t mincharnum_{0};
@@ -114,37 +120,22 @@ Tokenizer::Tokenizer(const OpKernelInfo& info) : OpKernel(info) {
   }
 }
 
-Status Tokenizer::CharTokenize(OpKernelContext* ctx, size_t N, size_t C,
-                               gsl::span<const int64_t> input_dims) const {
-  // With char tokenzation we get as many tokens as the number of
-  // utf8 characters in the string. So for every string we calculate its character(utf8) length
-  // add padding and add start/end test separators if necessary
+void Tokenizer::OutputTokens(OpKernelContext* ctx, gsl::span<const int64_t> input_dims,
+                             const std::vector<re2::StringPiece>& tokens,
+                             const std::vector<size_t>& row_offsets) const {
   size_t max_tokens = 0;
-  auto X = ctx->Input<Tensor>(0);
-  auto const input_data = X->Data<std::string>();
-  auto curr_input = input_data;
-  auto const last = input_data + N * C;
-  while (curr_input != last) {
-    const auto& s = *curr_input;
-    size_t tokens = 0;  // length in utf8 chars
-    if (!utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(),
-                       tokens)) {
-      // Please do not include the input text in the error message as it could
-      // be deemed as a compliance violation by teams using this operator
-      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                    "Input string contains invalid utf8 chars");
-    }
-    max_tokens = std::max(max_tokens, tokens);
-    ++curr_input;
+  for (size_t row = 0; row + 1 < row_offsets.size(); ++row) {
+    max_tokens = std::max(max_tokens, row_offsets[row + 1] - row_offsets[row]);
   }
 
   std::vector<int64_t> output_dims(input_dims.begin(), input_dims.end());
-  // Check if we have no output due to apparently empty strings input.
+  // Check if we have no output due to either empty input
+  // everything is a separator
   if (max_tokens == 0) {
     output_dims.push_back(0);
     TensorShape output_shape(output_dims);
     ctx->Output(0, output_shape);
-    return Status::OK();
+    return;
   }
 
   if (mark_) {
@@ -153,42 +144,89 @@ Status Tokenizer::CharTokenize(OpKernelContext* ctx, size_t N, size_t C,
 
   output_dims.push_back(max_tokens);
   TensorShape output_shape(output_dims);
+
   auto output_tensor = ctx->Output(0, output_shape);
   auto const output_data = output_tensor->MutableData<std::string>();
+
+#ifdef _DEBUG
+  const size_t max_output_index = (row_offsets.size() - 1) * max_tokens;
+#endif
   size_t output_index = 0;
-  curr_input = input_data;
-  while (curr_input != last) {
-    const auto& s = *curr_input;
+  for (size_t row = 0; row + 1 < row_offsets.size(); ++row) {
+#ifdef _DEBUG
+    size_t c_idx = output_index;
+#endif
     if (mark_) {
       (output_data + output_index)->assign(&start_text, 1);
       ++output_index;
     }
-    size_t tokens = 0;
-    const size_t str_len = s.size();
-    for (size_t token_idx = 0; token_idx < str_len;) {
-      size_t tlen = 0;
-      bool result = utf8_bytes(static_cast<unsigned char>(s[token_idx]), tlen);
-      assert(result);
-      (void)result;
-      assert(token_idx + tlen <= str_len);
-      *(output_data + output_index) = s.substr(token_idx, tlen);
+    // Output tokens for this row
+    for (size_t t = row_offsets[row]; t < row_offsets[row + 1]; ++t) {
+      (output_data + output_index)->assign(tokens[t].data(), tokens[t].size());
       ++output_index;
-      token_idx += tlen;
-      ++tokens;
     }
     if (mark_) {
       (output_data + output_index)->assign(&end_text, 1);
       ++output_index;
     }
-    // Padding strings
-    assert(tokens + (static_cast<size_t>(mark_) * 2) <= max_tokens);
-    const size_t pads = max_tokens - (static_cast<size_t>(mark_) * 2) - tokens;
+    const size_t pads = max_tokens - (static_cast<size_t>(mark_) * 2) - (row_offsets[row + 1] - row_offsets[row]);
     for (size_t p = 0; p < pads; ++p) {
       *(output_data + output_index) = pad_value_;
       ++output_index;
     }
+#ifdef _DEBUG
+    assert(output_index <= max_output_index);
+    assert((output_index - c_idx) <= max_tokens);
+#endif
+  }
+}
+
+Status Tokenizer::CharTokenize(OpKernelContext* ctx, size_t N, size_t C,
+                               gsl::span<const int64_t> input_dims) const {
+  // With char tokenzation we get as many tokens as the number of
+  // utf8 characters in the string. So for every string we calculate its character(utf8) length
+  // add padding and add start/end test separators if necessary
+  auto X = ctx->Input<Tensor>(0);
+  auto const input_data = X->Data<std::string>();
+  auto curr_input = input_data;
+  auto const last = input_data + N * C;
+
+  std::vector<re2::StringPiece> tokens;
+  std::vector<size_t> row_offsets;
+  row_offsets.reserve(N * C + 1);
+  row_offsets.push_back(0);
+  while (curr_input != last) {
+    const auto& s = *curr_input;
+    size_t chars = 0;  // length in utf8 chars
+    if (!utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(),
+                       chars)) {
+      // Please do not include the input text in the error message as it could
+      // be deemed as a compliance violation by teams using this operator
+      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                    "Input string contains invalid utf8 chars");
+    }
+    const size_t str_len = s.size();
+    if (chars == str_len) {
+      // ASCII: every byte is a character
+      for (size_t token_idx = 0; token_idx < str_len; ++token_idx) {
+        tokens.emplace_back(s.data() + token_idx, 1);
+      }
+    } else {
+      for (size_t token_idx = 0; token_idx < str_len;) {
+        size_t tlen = 0;
+        bool result = utf8_bytes(static_cast<unsigned char>(s[token_idx]), tlen);
+        assert(result);
+        (void)result;
+        assert(token_idx + tlen <= str_len);
+        tokens.emplace_back(s.data() + token_idx, tlen);
+        token_idx += tlen;
+      }
+    }
+    row_offsets.push_back(tokens.size());
     ++curr_input;
   }
+
+  OutputTokens(ctx, input_dims, tokens, row_offsets);
   return Status::OK();
 }
 
@@ -196,8 +234,10 @@ Status Tokenizer::SeparatorExpressionTokenizer(OpKernelContext* ctx,
                                                size_t N, size_t C,
                                                gsl::span<const int64_t> input_dims) const {
   using namespace re2;
-  std::vector<std::vector<StringPiece>> rows;
-  rows.reserve(N * C);
+  std::vector<StringPiece> tokens;
+  std::vector<size_t> row_offsets;
+  row_offsets.reserve(N * C + 1);
+  row_offsets.push_back(0);
 
   // We do not constraint the search to match
   // on the beginning or end of the string
@@ -205,11 +245,13 @@ Status Tokenizer::SeparatorExpressionTokenizer(OpKernelContext* ctx,
 
   // Scan all strings and attempt to find separators in them
   // collect all the output tokens here
-  size_t max_tokens = 0;
   auto X = ctx->Input<Tensor>(0);
   auto const input_data = X->Data<std::string>();
   auto curr_input = input_data;
   auto const last = input_data + N * C;
+  // The tokens of the current string before and after a separator, reused for every string.
+  std::vector<StringPiece> row;
+  std::vector<StringPiece> row_tokens;
   while (curr_input != last) {
     const auto& s = *curr_input;
     size_t utf8_chars = 0;  // length in utf8 chars
@@ -219,10 +261,11 @@ Status Tokenizer::SeparatorExpressionTokenizer(OpKernelContext* ctx,
                     "Input string contains invalid utf8 chars: " + s);
     }
 
-    std::vector<StringPiece> row{s};
+    row.clear();
+    row.emplace_back(s);
 
     for (const auto& sep : separators_) {
-      std::vector<StringPiece> tokens;
+      row_tokens.clear();
       for (const auto& text : row) {
         const auto end_pos = text.length();
         size_t start_pos = 0;
@@ -245,7 +288,7 @@ Status Tokenizer::SeparatorExpressionTokenizer(OpKernelContext* ctx,
                             "Match contains invalid utf8 chars: " + std::string{submatch});
             }
             if (utf8_chars >= size_t(mincharnum_)) {
-              tokens.emplace_back(text.data() + start_pos, token_len);
+              row_tokens.emplace_back(text.data() + start_pos, token_len);
             }
             // Update starting position
             // Guard against empty string match
@@ -264,72 +307,20 @@ Status Tokenizer::SeparatorExpressionTokenizer(OpKernelContext* ctx,
             utf8_len(reinterpret_cast<const unsigned char*>(text.data() + start_pos),
                      trailing_len, utf8_chars);
             if (utf8_chars >= size_t(mincharnum_)) {
-              tokens.emplace_back(text.data() + start_pos, trailing_len);
+              row_tokens.emplace_back(text.data() + start_pos, trailing_len);
             }
           }
         } while (match);
       }  // row
       // Replace the row with the results of this tokenezation
-      row.swap(tokens);
+      row.swap(row_tokens);
     }  // separators_
-    max_tokens = std::max(max_tokens, row.size());
-    rows.push_back(std::move(row));
+    tokens.insert(tokens.end(), row.begin(), row.end());
+    row_offsets.push_back(tokens.size());
     ++curr_input;
   }
 
-  std::vector<int64_t> output_dims(input_dims.begin(), input_dims.end());
-  // Check if we have no output due to either empty input
-  // everything is a separator
-  if (max_tokens == 0) {
-    output_dims.push_back(0);
-    TensorShape output_shape(output_dims);
-    ctx->Output(0, output_shape);
-    return Status::OK();
-  }
-
-  if (mark_) {
-    max_tokens += 2;  // Start/end markers as separate tokens
-  }
-
-  output_dims.push_back(max_tokens);
-  TensorShape output_shape(output_dims);
-
-  auto output_tensor = ctx->Output(0, output_shape);
-  auto const output_data = output_tensor->MutableData<std::string>();
-
-#ifdef _DEBUG
-  const size_t max_output_index = N * C * max_tokens;
-#endif
-  size_t output_index = 0;
-  curr_input = input_data;
-  for (auto& row : rows) {
-#ifdef _DEBUG
-    size_t c_idx = output_index;
-#endif
-    if (mark_) {
-      (output_data + output_index)->assign(&start_text, 1);
-      ++output_index;
-    }
-    // Output tokens for this row
-    for (const auto& token : row) {
-      (output_data + output_index)->assign(token.data(), token.size());
-      ++output_index;
-    }
-    if (mark_) {
-      (output_data + output_index)->assign(&end_text, 1);
-      ++output_index;
-    }
-    const size_t pads = max_tokens - (static_cast<size_t>(mark_) * 2) - row.size();
-    for (size_t p = 0; p < pads; ++p) {
-      *(output_data + output_index) = pad_value_;
-      ++output_index;
-    }
-#ifdef _DEBUG
-    assert(output_index <= max_output_index);
-    assert((output_index - c_idx) <= max_tokens);
-#endif
-    ++curr_input;
-  }
+  OutputTokens(ctx, input_dims, tokens, row_offsets);
   return Status::OK();
 }
 
@@ -337,12 +328,11 @@ Status Tokenizer::TokenExpression(OpKernelContext* ctx,
                                   size_t N, size_t C,
                                   gsl::span<const int64_t> input_dims) const {
   using namespace re2;
-  // Represents a token that will be output after
-  // first is the index, second is the size;
-  std::vector<std::vector<StringPiece>> tokens;
-  tokens.reserve(N * C);
+  std::vector<StringPiece> tokens;
+  std::vector<size_t> row_offsets;
+  row_offsets.reserve(N * C + 1);
+  row_offsets.push_back(0);
 
-  size_t max_tokens = 0;
   auto X = ctx->Input<Tensor>(0);
   auto const input_data = X->Data<std::string>();
   auto curr_input = input_data;
@@ -362,9 +352,6 @@ Status Tokenizer::TokenExpression(OpKernelContext* ctx,
                     "Input string contains invalid utf8 chars: " + s);
     }
 
-    tokens.emplace_back();
-    auto& row = tokens.back();
-
     StringPiece text(s);
     const auto end_pos = s.length();
     size_t start_pos = 0;
@@ -387,7 +374,7 @@ Status Tokenizer::TokenExpression(OpKernelContext* ctx,
                         "Match contains invalid utf8 chars: " + std::string{submatch});
         }
         if (utf8_chars >= size_t(mincharnum_)) {
-          row.push_back(submatch);
+          tokens.push_back(submatch);
           start_pos = match_pos + token_len;
         } else {
           size_t bytes = 0;
@@ -396,66 +383,11 @@ Status Tokenizer::TokenExpression(OpKernelContext* ctx,
         }
       }
     } while (match);
-    max_tokens = std::max(max_tokens, row.size());
-    ++curr_input;
-  }
-
-  // Check for empty output
-  std::vector<int64_t> output_dims(input_dims.begin(), input_dims.end());
-  // Check if we have no output due to either empty input
-  // everything is a separator
-  if (max_tokens == 0) {
-    output_dims.push_back(0);
-    TensorShape output_shape(output_dims);
-    ctx->Output(0, output_shape);
-    return Status::OK();
-  }
-
-  if (mark_) {
-    max_tokens += 2;  // Start/end markers as separate tokens
-  }
-
-  output_dims.push_back(max_tokens);
-  TensorShape output_shape(output_dims);
-
-  auto output_tensor = ctx->Output(0, output_shape);
-  auto const output_data = output_tensor->MutableData<std::string>();
-
-#ifdef _DEBUG
-  const size_t max_output_index = N * C * max_tokens;
-#endif
-  curr_input = input_data;
-  size_t output_index = 0;
-  for (const auto& row : tokens) {
-    assert(curr_input != last);
-#ifdef _DEBUG
-    size_t c_idx = output_index;
-#endif
-    if (mark_) {
-      (output_data + output_index)->assign(&start_text, 1);
-      ++output_index;
-    }
-    // Output tokens for this row
-    for (const auto& token : row) {
-      (output_data + output_index)->assign(token.data(), token.length());
-      ++output_index;
-    }
-    if (mark_) {
-      (output_data + output_index)->assign(&end_text, 1);
-      ++output_index;
-    }
-    const size_t pads = max_tokens - (static_cast<size_t>(mark_) * 2) - row.size();
-    for (size_t p = 0; p < pads; ++p) {
-      *(output_data + output_index) = pad_value_;
-      ++output_index;
-    }
-#ifdef _DEBUG
-    assert(output_index <= max_output_index);
-    assert((output_index - c_idx) <= max_tokens);
-#endif
+    row_offsets.push_back(tokens.size());
     ++curr_input;
   }
 
+  OutputTokens(ctx, input_dims, tokens, row_offsets);
   return Status::OK();
 }
 
@@ -78,6 +78,13 @@ void BeamSearch::Init(const OpKernelInfo& info) {
     if (info.GetAttr<ONNX_NAMESPACE::GraphProto>("init_decoder", &proto).IsOK()) {
       has_init_decoder_ = true;
     }
+
+    // Check if the past state of prompt prefixes is cached across runs.
+    const int64_t prompt_cache_size = info.GetAttrOrDefault<int64_t>("prompt_cache_size", 0);
+    ORT_ENFORCE(prompt_cache_size >= 0, "prompt_cache_size shall be non-negative. Got ", prompt_cache_size);
+    if (prompt_cache_size > 0) {
+      prompt_cache_ = std::make_unique<PromptCache>(static_cast<size_t>(prompt_cache_size));
+    }
   }
 
   // Make sure the decoder sub-graph attribute is present for all model types.
@@ -221,6 +228,7 @@ Status BeamSearch::Compute(OpKernelContext* ctx) const {
       ORT_RETURN_IF_ERROR(impl.InitializeCuda(reorder_past_state_func_, cuda_device_prop_, cuda_device_arch_));
 #endif
       ORT_RETURN_IF_ERROR(impl.Initialize());
+      impl.SetPromptCache(prompt_cache_.get());
 
       return impl.Execute(init_run_decoder_feeds_fetches_manager_, *decoder_feeds_fetches_manager_);
     } else {  // Output float16
@@ -244,6 +252,7 @@ Status BeamSearch::Compute(OpKernelContext* ctx) const {
       ORT_RETURN_IF_ERROR(impl.InitializeCuda(reorder_past_state_func_, cuda_device_prop_, cuda_device_arch_));
 #endif
       ORT_RETURN_IF_ERROR(impl.Initialize());
+      impl.SetPromptCache(prompt_cache_.get());
 
       return impl.Execute(init_run_decoder_feeds_fetches_manager_, *decoder_feeds_fetches_manager_);
     }
@@ -14,6 +14,7 @@
 #include "contrib_ops/cpu/transformers/subgraph_whisper_encoder.h"
 #include "contrib_ops/cpu/transformers/subgraph_whisper_decoder.h"
 #include "contrib_ops/cpu/transformers/generation_device_helper.h"
+#include "contrib_ops/cpu/transformers/prompt_cache.h"
 
 namespace onnxruntime {
 class FeedsFetchesManager;
@@ -175,6 +176,9 @@ class BeamSearch : public IControlFlowKernel {
   BeamSearchParameters parameters_;
 
   bool has_init_decoder_ = false;
+
+  // Past state of prompt prefixes shared by the runs of the node (if the `prompt_cache_size` attribute is positive).
+  std::unique_ptr<PromptCache> prompt_cache_;
 };
 
 }  // namespace transformers
@@ -48,9 +48,9 @@ struct BeamSearchState : IBeamSearchState<T> {
       this->remaining_scores = this->scores;
     }
 
-    if (has_decoder_masked_attention) {
+    if (has_decoder_masked_attention && allocator->Info().device.Type() == OrtDevice::GPU) {
       // We need a temp staging buffer to do the past 'K' state re-ordering that is needed
-      // when using DecoderMaskedSelfAttention
+      // when using DecoderMaskedSelfAttention on CUDA. The CPU kernels read the past state as is.
       TensorShape staging_for_past_state_reorder_buffer_shape = {static_cast<int64_t>(batch_beam_size), parameters.num_heads, parameters.max_length, parameters.head_size};
 
       Tensor temp(DataTypeImpl::GetType<T>(), staging_for_past_state_reorder_buffer_shape, allocator);
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "contrib_ops/cpu/transformers/beam_search_impl_base.h"
+#include "contrib_ops/cpu/transformers/prompt_cache.h"
 
 #include "core/common/span_utils.h"
 
@@ -65,6 +66,9 @@ class BeamSearchGpt : public BeamSearchBase<T> {
   }
 #endif
 
+  // Use the past state of prompt prefixes from previous runs, and add the prompt of this run to the cache.
+  void SetPromptCache(PromptCache* prompt_cache) { prompt_cache_ = prompt_cache; }
+
   // Execute beam search in iterations util stopping criteria is reached.
   // In each iteration, GPT subgraph is called, and next token for each sequence is generated.
   Status Execute(const FeedsFetchesManager* init_run_feeds_fetches_manager,
@@ -96,6 +100,8 @@ class BeamSearchGpt : public BeamSearchBase<T> {
   GptSubgraph* init_run_gpt_subgraph_ = nullptr;
   GptSubgraph& gpt_subgraph_;
 
+  PromptCache* prompt_cache_ = nullptr;
+
   // Device specific functions
   GenerationDeviceHelper::CreateGptInputsFunc create_inputs_func_;
   GenerationDeviceHelper::AddToFeedsFunc add_to_feeds_func_;
@@ -223,6 +229,18 @@ Status BeamSearchGpt<T>::Execute(const FeedsFetchesManager* init_run_feeds_fetch
   ORT_RETURN_IF_ERROR(CreateInitialFeeds(cpu_state.sequence_lengths, expanded_input_ids_in_cpu, feeds, buffer,
                                          gpt_subgraph_.has_decoder_masked_attention_));
 
+  // The first run starts from the past state of the longest cached prefix of the prompt. The cache is only used
+  // when the first run is done by the decoder with a past state of variable length on CPU.
+  const bool use_prompt_cache = prompt_cache_ != nullptr && !this->IsCuda() &&
+                                init_run_decoder_session_state_ == nullptr &&
+                                !gpt_subgraph_.past_present_share_buffer_;
+  if (use_prompt_cache) {
+    int cached_length = 0;
+    ORT_RETURN_IF_ERROR(SeedGptFeedsFromPromptCache(*prompt_cache_, gpt_subgraph_.GetFirstPastInputIndex(),
+                                                    gpt_subgraph_.num_layers, this->temp_space_allocator_, feeds,
+                                                    cached_length));
+  }
+
   if (gpt_subgraph_.past_present_share_buffer_) {  // Reuse past and present
     fetches.reserve(static_cast<size_t>(gpt_subgraph_.GetFirstPresentOutputIndex()) + gpt_subgraph_.num_layers);
     fetches.resize(gpt_subgraph_.GetFirstPresentOutputIndex(), OrtValue());
@@ -321,6 +339,12 @@ Status BeamSearchGpt<T>::Execute(const FeedsFetchesManager* init_run_feeds_fetch
 
     ORT_RETURN_IF_ERROR(status);
 
+    if (use_prompt_cache && iteration_counter == 1) {
+      ORT_RETURN_IF_ERROR(AddGptPromptToPromptCache(*prompt_cache_, expanded_input_ids_in_cpu.Get<Tensor>(),
+                                                    feeds[2].Get<Tensor>(), gpt_subgraph_.GetFirstPresentOutputIndex(),
+                                                    gpt_subgraph_.num_layers, fetches));
+    }
+
     const OrtValue& logits = fetches[0];
     gsl::span<int32_t> beam_next_tokens;
     ORT_RETURN_IF_ERROR(this->GenerateNextToken(logits,
@@ -339,7 +363,7 @@ Status BeamSearchGpt<T>::Execute(const FeedsFetchesManager* init_run_feeds_fetch
 #ifdef USE_CUDA
     // Reorder past state after first run if the GPT subgraph (the one used after the first iteration)
     // contains DecoderMaskedSelfAttention nodes
-    if (iteration_counter == 1 && gpt_subgraph_.has_decoder_masked_attention_) {
+    if (iteration_counter == 1 && gpt_subgraph_.has_decoder_masked_attention_ && this->IsCuda()) {
       size_t offset = static_cast<size_t>(gpt_subgraph_.GetFirstPresentOutputIndex());
       // We will use the same staging buffer while transposing all the layers' past state
       // and this is okay because we use the same stream to do the staging copy and the transpose
@@ -364,10 +388,10 @@ Status BeamSearchGpt<T>::Execute(const FeedsFetchesManager* init_run_feeds_fetch
       ORT_RETURN_IF_ERROR(UpdateFeeds(fetches, feeds, current_length,
                                       position_ids, increase_position,
                                       ReinterpretAsSpan<const int32_t>(beam_next_tokens),
-                                      gpt_subgraph_.has_decoder_masked_attention_
+                                      gpt_subgraph_.has_decoder_masked_attention_ && this->IsCuda()
                                           ? place_holder
                                           : ReinterpretAsSpan<const int32_t>(this->beam_scorer_->GetNextIndicesCPU()),
-                                      gpt_subgraph_.has_decoder_masked_attention_
+                                      gpt_subgraph_.has_decoder_masked_attention_ && this->IsCuda()
                                           ? ReinterpretAsSpan<const int32_t>(this->beam_scorer_->GetNextIndicesGPU())
                                           : place_holder,
                                       current_length - 1,
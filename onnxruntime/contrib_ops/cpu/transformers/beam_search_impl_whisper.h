@@ -267,22 +267,35 @@ Status BeamSearchWhisper<T>::Execute(const FeedsFetchesManager& encoder_feeds_fe
 
     if (decoder_subgraph_.has_decoder_masked_attention_) {
       size_t offset = static_cast<size_t>(decoder_subgraph_.GetFirstPastInputIndex());
-      // Need to check cross attention's past key tensor size, suppose all layers cross attention key size are same
-      auto first_cross_attention_key = decoder_feeds[offset + 2 * static_cast<size_t>(decoder_subgraph_.num_layers)].GetMutable<Tensor>();
-      auto cross_attention_past_key_sz = first_cross_attention_key->Shape().Size();
-      beam_state.EnsurePastStateReorderStagingBuffer(this->temp_space_allocator_, cross_attention_past_key_sz);
-
+      size_t cache_indir_input_offset = offset + 4 * static_cast<size_t>(decoder_subgraph_.num_layers) + 2;
+      if (this->IsCuda()) {
 #ifdef USE_CUDA
-      // Here we only need to reorder the past key for self-attention and cross-attention.
-      for (size_t i = 0; i < 2 * static_cast<size_t>(decoder_subgraph_.num_layers); ++i) {
-        ORT_RETURN_IF_ERROR(reorder_past_state_func_(cuda_device_prop_,
-                                                     *decoder_feeds[offset + 2 * i].GetMutable<Tensor>(),
-                                                     beam_state.staging_for_past_state_reorder,
-                                                     this->ort_stream_));
-      }
-      size_t cache_indir_input_offset = static_cast<size_t>(decoder_subgraph_.GetFirstPastInputIndex()) + 4 * static_cast<size_t>(decoder_subgraph_.num_layers) + 2;
-      ORT_RETURN_IF_ERROR(init_cache_indir_func_(*decoder_feeds[cache_indir_input_offset].GetMutable<Tensor>(), this->ort_stream_));
+        // Need to check cross attention's past key tensor size, suppose all layers cross attention key size are same
+        auto first_cross_attention_key = decoder_feeds[offset + 2 * static_cast<size_t>(decoder_subgraph_.num_layers)].GetMutable<Tensor>();
+        auto cross_attention_past_key_sz = first_cross_attention_key->Shape().Size();
+        beam_state.EnsurePastStateReorderStagingBuffer(this->temp_space_allocator_, cross_attention_past_key_sz);
+
+        // Here we only need to reorder the past key for self-attention and cross-attention.
+        for (size_t i = 0; i < 2 * static_cast<size_t>(decoder_subgraph_.num_layers); ++i) {
+          ORT_RETURN_IF_ERROR(reorder_past_state_func_(cuda_device_prop_,
+                                                       *decoder_feeds[offset + 2 * i].GetMutable<Tensor>(),
+                                                       beam_state.staging_for_past_state_reorder,
+                                                       this->ort_stream_));
+        }
+        ORT_RETURN_IF_ERROR(init_cache_indir_func_(*decoder_feeds[cache_indir_input_offset].GetMutable<Tensor>(), this->ort_stream_));
 #endif
+      } else {
+        // The CPU kernels read the past state in its original layout, only the cache indirection is initialized.
+        // The decoder input tokens are the same for all beams, and the first step writes the last generated token
+        // in the past state of each beam.
+        Tensor* cache_indir = decoder_feeds[cache_indir_input_offset].GetMutable<Tensor>();
+        memset(cache_indir->MutableDataRaw(), 0, cache_indir->SizeInBytes());
+        const int64_t max_sequence_length = cache_indir->Shape()[2];
+        int32_t* cache_indir_data = cache_indir->MutableData<int32_t>();
+        for (int i = 0; i < parameters->batch_size * parameters->num_beams; i++) {
+          cache_indir_data[i * max_sequence_length + current_length - 1] = i % parameters->num_beams;
+        }
+      }
     }
   }
 
@@ -355,10 +368,10 @@ Status BeamSearchWhisper<T>::Execute(const FeedsFetchesManager& encoder_feeds_fe
           decoder_feeds,
           num_present_outputs,
           ReinterpretAsSpan<const int32_t>(beam_next_tokens),
-          decoder_subgraph_.has_decoder_masked_attention_
+          decoder_subgraph_.has_decoder_masked_attention_ && this->IsCuda()
               ? place_holder
               : ReinterpretAsSpan<const int32_t>(this->beam_scorer_->GetNextIndicesCPU()),
-          decoder_subgraph_.has_decoder_masked_attention_
+          decoder_subgraph_.has_decoder_masked_attention_ && this->IsCuda()
               ? ReinterpretAsSpan<const int32_t>(this->beam_scorer_->GetNextIndicesGPU())
               : place_holder,
           parameters->num_beams,
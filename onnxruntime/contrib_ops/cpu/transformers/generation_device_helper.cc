@@ -555,6 +555,46 @@ Status DeviceCopy(gsl::span<T> target, gsl::span<const T> source, Stream* /*stre
   return Status::OK();
 }
 
+// Update the cache indirection of DecoderMaskedMultiHeadAttention after beams are reordered: entry (b, i, t) is the
+// beam of batch b that holds the key and value of time step t for the beam i. The past state stays in place.
+static void UpdateCacheIndirection(gsl::span<const int32_t> beam_indices,
+                                   int num_beams,
+                                   int input_sequence_len,
+                                   int current_length,
+                                   AllocatorPtr allocator,
+                                   OrtValue& cache_indirection) {
+  // Keep the old buffer alive while the new one is filled.
+  const OrtValue old_cache_indirection_value = cache_indirection;
+  const Tensor& old_cache_indirection = old_cache_indirection_value.Get<Tensor>();
+  const TensorShape& shape = old_cache_indirection.Shape();
+  ORT_ENFORCE(shape.NumDimensions() == 3 && shape[1] == num_beams);
+  ORT_ENFORCE(beam_indices.size() == static_cast<size_t>(shape[0] * num_beams),
+              "Beam indices must be present on CPU while using DecoderMaskedMultiHeadAttention with BeamSearch");
+  const int64_t max_sequence_length = shape[2];
+  ORT_ENFORCE(current_length <= max_sequence_length);
+
+  Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(), shape, allocator, cache_indirection);
+  const int32_t* src = old_cache_indirection.Data<int32_t>();
+  int32_t* tgt = cache_indirection.GetMutable<Tensor>()->MutableData<int32_t>();
+
+  const int64_t batch_size = shape[0];
+  // Same as the CUDA kernel: time steps of the input sequence always come from beam 0, the new one from the beam
+  // itself and the others from the parent beam.
+  const int input_end = std::min(input_sequence_len, current_length);
+  for (int64_t b = 0; b < batch_size; b++) {
+    for (int i = 0; i < num_beams; i++) {
+      int32_t* tgt_row = tgt + (b * num_beams + i) * max_sequence_length;
+      const int src_beam = beam_indices[SafeInt<size_t>(b) * num_beams + i] % num_beams;
+      const int32_t* src_row = src + (b * num_beams + src_beam) * max_sequence_length;
+      std::fill_n(tgt_row, input_end, 0);
+      if (current_length > input_sequence_len) {
+        std::copy(src_row + input_end, src_row + current_length - 1, tgt_row + input_end);
+        tgt_row[current_length - 1] = i;
+      }
+    }
+  }
+}
+
 // Copy present state to past state for GPT model
 template <typename T>
 void PickGptPastState(const std::vector<OrtValue>& last_outputs,
@@ -619,8 +659,6 @@ Status UpdateGptFeeds(
   // next_inputs: input_ids, position_id, attention_mask, past_0, past_1
   ORT_UNUSED_PARAMETER(stream);
   ORT_UNUSED_PARAMETER(beam_indices_gpu);
-  ORT_UNUSED_PARAMETER(input_sequence_len);
-  ORT_UNUSED_PARAMETER(need_cache_indir);
 
   // The following updates inputs for subgraph
 
@@ -664,8 +702,15 @@ Status UpdateGptFeeds(
   next_inputs[2] = attention_mask;
 
   if (past_present_share_buffer) {
-    int32_t* past_seq_len_data = const_cast<int32_t*>(next_inputs.back().Get<Tensor>().Data<int32_t>());
-    *past_seq_len_data = past_sequence_len;
+    // Update past sequence length input
+    const ptrdiff_t past_sequence_length_idx = (static_cast<ptrdiff_t>(last_outputs.size()) - gpt_subgraph_first_present_output_idx) + gpt_subgraph_first_past_input_idx;
+    *(next_inputs[past_sequence_length_idx].GetMutable<Tensor>()->MutableData<int32_t>()) = past_sequence_len;
+
+    // The cache indirection feed comes 2 feeds after the `past_sequence_length` feed
+    if (need_cache_indir) {
+      UpdateCacheIndirection(beam_indices_cpu, num_beams, input_sequence_len, current_length, allocator,
+                             next_inputs[past_sequence_length_idx + 2]);
+    }
     return Status::OK();
   }
 
@@ -676,6 +721,8 @@ Status UpdateGptFeeds(
       next_inputs[i + k] = last_outputs[i];
     }
   } else {
+    // GPT decoders share the past buffer only with DecoderMaskedSelfAttention, which has no CPU kernel,
+    // so on CPU the past state of the selected beams is always gathered here.
     PickGptPastState<T>(last_outputs, next_inputs, beam_indices_cpu,
                         gpt_subgraph_first_past_input_idx,
                         gpt_subgraph_first_present_output_idx, allocator);
@@ -813,9 +860,6 @@ Status UpdateDecoderFeeds(
     const transformers::IConsoleDumper* dumper) {
   ORT_UNUSED_PARAMETER(stream);
   ORT_UNUSED_PARAMETER(beam_indices_gpu);
-  ORT_UNUSED_PARAMETER(input_sequence_len);
-  ORT_UNUSED_PARAMETER(past_present_share_buffer);
-  ORT_UNUSED_PARAMETER(need_cache_indir);
   // last_outputs: logits, present_key_self_0, present_value_self_0, ...
   // next_inputs: input_ids,
   //              encoder_attention_mask, encoder_hidden_states(optional),
@@ -856,6 +900,20 @@ Status UpdateDecoderFeeds(
 
   // Update past state
   ORT_ENFORCE(last_outputs.size() >= static_cast<size_t>(1) + num_present_tensors);
+
+  if (past_present_share_buffer) {
+    // Update past sequence length input
+    const ptrdiff_t past_sequence_length_idx = 2 * (static_cast<ptrdiff_t>(last_outputs.size()) - t5_decoder_first_present_output_idx) + t5_decoder_first_past_input_idx;
+    *(next_inputs[past_sequence_length_idx].GetMutable<Tensor>()->MutableData<int32_t>()) = current_length - 1;
+
+    // The past state is written in place, so beams are reordered through the cache indirection only.
+    if (need_cache_indir) {
+      UpdateCacheIndirection(beam_indices, num_beams, input_sequence_len, current_length, allocator,
+                             next_inputs[past_sequence_length_idx + 2]);
+    }
+    return Status::OK();
+  }
+
   // TODO(tianleiwu): remove num_beams==1 once GreedySearch operator is available.
   if (num_beams == 1) {
     // feed present_* output to past_* inputs one by one
@@ -88,8 +88,8 @@ struct ISamplingState {
   size_t temp_storage_bytes;
   std::default_random_engine generator;
 
-  gsl::span<T> sorted_scores;
-  gsl::span<T> cumulative_probs;
+  gsl::span<T> probs;                    // shape (batch_size, vocab_size), softmax of next token scores (CPU only)
+  gsl::span<int32_t> candidate_indices;  // shape (batch_size, vocab_size), tokens selected by top-p (CPU only)
 };
 
 struct ISequences {
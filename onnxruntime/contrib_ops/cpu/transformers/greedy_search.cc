@@ -94,6 +94,18 @@ void GreedySearch::Init(const OpKernelInfo& info) {
     if (info.GetAttr<ONNX_NAMESPACE::GraphProto>("init_decoder", &proto).IsOK()) {
       has_init_decoder_ = true;
     }
+
+    // Check if the draft_decoder sub-graph attribute for speculative decoding is present.
+    if (info.GetAttr<ONNX_NAMESPACE::GraphProto>("draft_decoder", &proto).IsOK()) {
+      has_draft_decoder_ = true;
+    }
+
+    // Check if the past state of prompt prefixes is cached across runs.
+    const int64_t prompt_cache_size = info.GetAttrOrDefault<int64_t>("prompt_cache_size", 0);
+    ORT_ENFORCE(prompt_cache_size >= 0, "prompt_cache_size shall be non-negative. Got ", prompt_cache_size);
+    if (prompt_cache_size > 0) {
+      prompt_cache_ = std::make_unique<PromptCache>(static_cast<size_t>(prompt_cache_size));
+    }
   }
 
   // Make sure the decoder sub-graph attribute is present for all model types.
@@ -132,6 +144,11 @@ Status GreedySearch::SetupSubgraphExecutionInfo(const SessionState& session_stat
 
       init_run_gpt_subgraph_ = std::move(res.second);
       init_run_decoder_feeds_fetches_manager_ = init_run_gpt_subgraph_->GetFeedsFetchesManager();
+    } else if (attribute_name == "draft_decoder") {
+      ORT_ENFORCE(draft_gpt_subgraph_ == nullptr, "SetupSubgraphExecutionInfo should only be called once for each subgraph.");
+      // The parameters come from the decoder subgraph, so the draft subgraph does not update them.
+      draft_gpt_subgraph_ = std::make_unique<GptSubgraph>(node, attribute_name, subgraph_session_state.GetGraphViewer());
+      ORT_RETURN_IF_ERROR(draft_gpt_subgraph_->Setup(session_state, subgraph_session_state));
     }
   } else if (parameters_.model_type == IGenerationParameters::kModelTypeT5) {  // encoder-decoder like T5
     ORT_THROW("Not Implemented");
@@ -178,6 +195,12 @@ Status GreedySearch::Compute(OpKernelContext* ctx) const {
                 "past_present_share_buffer mode must be same for init decoder and decoder subgraphes");
   }
 
+  auto* draft_decoder_session_state = ctx_internal->SubgraphSessionState("draft_decoder");
+  if (has_draft_decoder_) {
+    ORT_ENFORCE(draft_decoder_session_state, "Subgraph SessionState was not found for 'draft_decoder' attribute.");
+    ORT_ENFORCE(draft_gpt_subgraph_, "CreateFeedsFetchesManager must be called prior to execution of graph.");
+  }
+
   concurrency::ThreadPool* thread_pool = ctx->GetOperatorThreadPool();
 
   // make a copy since we will update the parameters based on inputs later
@@ -207,6 +230,10 @@ Status GreedySearch::Compute(OpKernelContext* ctx) const {
       ORT_RETURN_IF_ERROR(impl.InitializeCuda(reorder_past_state_func_, cuda_device_prop_, cuda_device_arch_));
 #endif
       ORT_RETURN_IF_ERROR(impl.Initialize());
+      if (has_draft_decoder_) {
+        ORT_RETURN_IF_ERROR(impl.InitializeDraftDecoder(*draft_decoder_session_state, *draft_gpt_subgraph_));
+      }
+      impl.SetPromptCache(prompt_cache_.get());
 
       return impl.Execute(init_run_decoder_feeds_fetches_manager_, *decoder_feeds_fetches_manager_);
     } else {
@@ -231,6 +258,10 @@ Status GreedySearch::Compute(OpKernelContext* ctx) const {
       ORT_RETURN_IF_ERROR(impl.InitializeCuda(reorder_past_state_func_, cuda_device_prop_, cuda_device_arch_));
 #endif
       ORT_RETURN_IF_ERROR(impl.Initialize());
+      if (has_draft_decoder_) {
+        ORT_RETURN_IF_ERROR(impl.InitializeDraftDecoder(*draft_decoder_session_state, *draft_gpt_subgraph_));
+      }
+      impl.SetPromptCache(prompt_cache_.get());
 
       return impl.Execute(init_run_decoder_feeds_fetches_manager_, *decoder_feeds_fetches_manager_);
     }
@@ -12,6 +12,7 @@
 #include "contrib_ops/cpu/transformers/subgraph_t5_encoder.h"
 #include "contrib_ops/cpu/transformers/subgraph_t5_decoder.h"
 #include "contrib_ops/cpu/transformers/generation_device_helper.h"
+#include "contrib_ops/cpu/transformers/prompt_cache.h"
 
 namespace onnxruntime {
 class FeedsFetchesManager;
@@ -113,6 +114,9 @@ class GreedySearch : public IControlFlowKernel {
   std::unique_ptr<GptSubgraph> init_run_gpt_subgraph_;
   std::unique_ptr<GptSubgraph> gpt_subgraph_;
 
+  // The draft_gpt_subgraph_ (if the `draft_decoder` attribute is present) proposes tokens for speculative decoding.
+  std::unique_ptr<GptSubgraph> draft_gpt_subgraph_;
+
   // Relevant only for T5
   // Same concept as above.
   // The encoder will be used for the first run and the decoder will
@@ -129,6 +133,11 @@ class GreedySearch : public IControlFlowKernel {
   GreedySearchParameters parameters_;
 
   bool has_init_decoder_ = false;
+
+  bool has_draft_decoder_ = false;
+
+  // Past state of prompt prefixes shared by the runs of the node (if the `prompt_cache_size` attribute is positive).
+  std::unique_ptr<PromptCache> prompt_cache_;
 };
 
 }  // namespace transformers
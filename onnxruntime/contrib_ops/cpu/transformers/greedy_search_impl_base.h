@@ -48,8 +48,8 @@ struct SamplingState : public ISamplingState<T> {
       }
     } else {
       // TODO: Some buffer can be reused for CPU
-      this->sorted_scores = AllocateBuffer<T>(cpu_allocator, sorted_scores_buffer_, SafeInt<size_t>(total_count));
-      this->cumulative_probs = AllocateBuffer<T>(cpu_allocator, cumulative_probs_buffer_, SafeInt<size_t>(total_count));
+      this->probs = AllocateBuffer<T>(cpu_allocator, probs_buffer_, SafeInt<size_t>(total_count));
+      this->candidate_indices = AllocateBuffer<int32_t>(cpu_allocator, candidate_indices_buffer_, SafeInt<size_t>(total_count));
     }
   }
 
@@ -65,8 +65,8 @@ struct SamplingState : public ISamplingState<T> {
   BufferUniquePtr h_sampled_all_buffer_;
   BufferUniquePtr d_indices_buffer_;
   BufferUniquePtr d_presence_mask_buffer_;
-  BufferUniquePtr sorted_scores_buffer_;
-  BufferUniquePtr cumulative_probs_buffer_;
+  BufferUniquePtr probs_buffer_;
+  BufferUniquePtr candidate_indices_buffer_;
 };
 
 template <typename T>
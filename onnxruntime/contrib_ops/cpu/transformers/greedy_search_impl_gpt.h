@@ -3,10 +3,14 @@
 
 #pragma once
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 #include "core/common/span_utils.h"
 #include "contrib_ops/cpu/transformers/greedy_search_impl_base.h"
+#include "contrib_ops/cpu/transformers/prompt_cache.h"
+#include "contrib_ops/cpu/transformers/sampling_cpu_helper.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -79,12 +83,59 @@ class GreedySearchGpt : public GreedySearchBase<T, ParametersT> {
   }
 #endif
 
+  // Use speculative decoding: the draft decoder of a smaller model proposes tokens, and the decoder verifies them
+  // in one run instead of running once per token.
+  Status InitializeDraftDecoder(const SessionState& draft_decoder_session_state,
+                                GptSubgraph& draft_gpt_subgraph);
+
+  // Use the past state of prompt prefixes from previous runs, and add the prompt of this run to the cache.
+  void SetPromptCache(PromptCache* prompt_cache) { prompt_cache_ = prompt_cache; }
+
   // Execute beam search in iterations util stopping criteria is reached.
   // In each iteration, GPT subgraph is called, and next token for each sequence is generated.
   Status Execute(const FeedsFetchesManager* init_run_feeds_fetches_manager,
                  const FeedsFetchesManager& feeds_fetches_manager);
 
  private:
+  struct SpeculativeDecodingState {
+    std::vector<OrtValue> draft_feeds;
+    std::vector<OrtValue> draft_fetches;
+    int draft_past_length = 0;                   // leading tokens of each sequence in the draft past state
+    std::vector<int32_t> prompt_attention_mask;  // (batch_size, sequence_length)
+    std::vector<int32_t> draft_tokens;           // (batch_size, num_speculative_tokens)
+    std::vector<float> draft_probs;              // (batch_size, num_speculative_tokens, vocab_size), for sampling
+    std::vector<float> probs;                    // (vocab_size), for sampling
+  };
+
+  // Run the draft decoder over the prompt and set up the state of speculative decoding.
+  Status InitializeSpeculativeDecoding(const std::vector<OrtValue>& feeds,
+                                       gsl::span<int32_t>& sequence_lengths,
+                                       OrtValue& draft_expanded_input_ids,
+                                       IAllocatorUniquePtr<char>& draft_buffer,
+                                       SpeculativeDecodingState& speculative_state);
+
+  // Feed tokens [past_length, total_length) of the sequences to a decoder whose last run produced the present state
+  // of at least past_length tokens. The present state after past_length tokens, like the key and value of rejected
+  // draft tokens, is dropped.
+  Status UpdateSpeculativeFeeds(const GptSubgraph& subgraph,
+                                const std::vector<OrtValue>& last_outputs,
+                                std::vector<OrtValue>& next_inputs,
+                                const SpeculativeDecodingState& speculative_state,
+                                const GreedySearchState<T>& greedy_state,
+                                int past_length,
+                                int total_length);
+
+  // Generate up to num_speculative_tokens + 1 tokens with one decoder run. Set is_done when all sequences meet eos.
+  Status ExecuteSpeculativeStep(const FeedsFetchesManager& feeds_fetches_manager,
+                                std::vector<OrtValue>& feeds,
+                                std::vector<OrtValue>& fetches,
+                                SpeculativeDecodingState& speculative_state,
+                                GreedySearchState<T>& greedy_state,
+                                SamplingState<T>& sampling_state,
+                                int& current_length,
+                                int& iteration_counter,
+                                bool& is_done);
+
   // Prepare the inputs for first inference of subgraph
   Status CreateInitialFeeds(gsl::span<int32_t>& sequence_lengths,
                             OrtValue& expanded_input_ids,
@@ -105,6 +156,11 @@ class GreedySearchGpt : public GreedySearchBase<T, ParametersT> {
   GptSubgraph* init_run_gpt_subgraph_ = nullptr;
   GptSubgraph& gpt_subgraph_;
 
+  const SessionState* draft_decoder_session_state_ = nullptr;
+  GptSubgraph* draft_gpt_subgraph_ = nullptr;
+
+  PromptCache* prompt_cache_ = nullptr;
+
   // Device specific functions
   GenerationDeviceHelper::CreateGptInputsFunc create_inputs_func_;
   GenerationDeviceHelper::AddToFeedsFunc add_to_feeds_func_;
@@ -187,6 +243,367 @@ Status GreedySearchGpt<T, ParametersT>::UpdateFeeds(
                             false);
 }
 
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::InitializeDraftDecoder(const SessionState& draft_decoder_session_state,
+                                                               GptSubgraph& draft_gpt_subgraph) {
+  ORT_RETURN_IF(this->IsCuda(), "Speculative decoding with draft_decoder is only supported on CPU");
+  ORT_RETURN_IF(gpt_subgraph_.past_present_share_buffer_ || draft_gpt_subgraph.past_present_share_buffer_,
+                "Speculative decoding does not support past and present sharing a buffer");
+  ORT_RETURN_IF(draft_gpt_subgraph.vocab_size != gpt_subgraph_.vocab_size,
+                "draft_decoder shall have the same vocabulary size as decoder. Got ",
+                draft_gpt_subgraph.vocab_size, " and ", gpt_subgraph_.vocab_size);
+  ORT_RETURN_IF(draft_gpt_subgraph.IsOutputFloat16() != gpt_subgraph_.IsOutputFloat16(),
+                "draft_decoder shall have the same logits data type as decoder");
+
+  draft_decoder_session_state_ = &draft_decoder_session_state;
+  draft_gpt_subgraph_ = &draft_gpt_subgraph;
+  return Status::OK();
+}
+
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::InitializeSpeculativeDecoding(const std::vector<OrtValue>& feeds,
+                                                                      gsl::span<int32_t>& sequence_lengths,
+                                                                      OrtValue& draft_expanded_input_ids,
+                                                                      IAllocatorUniquePtr<char>& draft_buffer,
+                                                                      SpeculativeDecodingState& speculative_state) {
+  const ParametersT* parameters = this->parameters_;
+  const Tensor& input_ids = this->context_.GetInputOrtValue(0)->Get<Tensor>();
+  const OrtValue* attn_mask_value = this->context_.GetInputOrtValue(6);
+
+  // The attention mask of the prompt marks the padding. Later tokens are never padding.
+  gsl::span<const int32_t> prompt_attention_mask = feeds[2].Get<Tensor>().DataAsSpan<int32_t>();
+  speculative_state.prompt_attention_mask.assign(prompt_attention_mask.begin(), prompt_attention_mask.end());
+
+  const size_t draft_size = SafeInt<size_t>(parameters->BatchBeamSize()) * parameters->num_speculative_tokens;
+  speculative_state.draft_tokens.resize(draft_size);
+  if (std::is_same<ParametersT, SamplingParameters>::value) {
+    speculative_state.draft_probs.resize(draft_size * parameters->vocab_size);
+    speculative_state.probs.resize(static_cast<size_t>(parameters->vocab_size));
+  }
+
+  ORT_RETURN_IF_ERROR(draft_gpt_subgraph_->CreateInitialFeeds(input_ids,
+                                                              this->implicit_inputs_,
+                                                              parameters->num_beams,
+                                                              parameters->pad_token_id,
+                                                              sequence_lengths,
+                                                              draft_expanded_input_ids,
+                                                              attn_mask_value,
+                                                              speculative_state.draft_feeds,
+                                                              this->create_inputs_func_,
+                                                              this->add_to_feeds_func_,
+                                                              draft_buffer,
+                                                              this->ort_stream_));
+
+  ORT_RETURN_IF_ERROR(utils::ExecuteSubgraph(*draft_decoder_session_state_,
+                                             *draft_gpt_subgraph_->GetFeedsFetchesManager(),
+                                             speculative_state.draft_feeds,
+                                             speculative_state.draft_fetches,
+                                             {},
+                                             ExecutionMode::ORT_SEQUENTIAL,
+                                             this->context_.GetTerminateFlag(),
+                                             this->context_.Logger(),
+                                             this->ort_stream_));
+  speculative_state.draft_past_length = parameters->sequence_length;
+  return Status::OK();
+}
+
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::UpdateSpeculativeFeeds(const GptSubgraph& subgraph,
+                                                               const std::vector<OrtValue>& last_outputs,
+                                                               std::vector<OrtValue>& next_inputs,
+                                                               const SpeculativeDecodingState& speculative_state,
+                                                               const GreedySearchState<T>& greedy_state,
+                                                               int past_length,
+                                                               int total_length) {
+  const ParametersT* parameters = this->parameters_;
+  const int batch_size = parameters->BatchBeamSize();
+  const int prompt_length = parameters->sequence_length;
+  const int input_length = total_length - past_length;
+  ORT_ENFORCE(past_length >= prompt_length && input_length > 0);
+
+  auto int32_type = DataTypeImpl::GetType<int32_t>();
+  int64_t input_dims[] = {batch_size, input_length};
+  TensorShape input_shape(&input_dims[0], 2);
+  OrtValue input_ids;
+  OrtValue position_ids;
+  Tensor::InitOrtValue(int32_type, input_shape, this->temp_space_allocator_, input_ids);
+  Tensor::InitOrtValue(int32_type, input_shape, this->temp_space_allocator_, position_ids);
+
+  int64_t mask_dims[] = {batch_size, total_length};
+  TensorShape mask_shape(&mask_dims[0], 2);
+  OrtValue attention_mask;
+  Tensor::InitOrtValue(int32_type, mask_shape, this->temp_space_allocator_, attention_mask);
+
+  int32_t* input_ids_data = input_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  int32_t* position_data = position_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  int32_t* mask_data = attention_mask.GetMutable<Tensor>()->MutableData<int32_t>();
+  for (int i = 0; i < batch_size; i++) {
+    gsl::span<const int32_t> sequence = greedy_state.sequences.GetSequence(i);
+    for (int j = 0; j < input_length; j++) {
+      // Generated tokens are placed after the tokens of the prompt that are not padding.
+      input_ids_data[i * input_length + j] = sequence[SafeInt<size_t>(past_length) + j];
+      position_data[i * input_length + j] = greedy_state.sequence_lengths[i] + past_length + j - prompt_length;
+    }
+    for (int j = 0; j < total_length; j++) {
+      mask_data[i * total_length + j] = (j < prompt_length)
+                                            ? speculative_state.prompt_attention_mask[SafeInt<size_t>(i) * prompt_length + j]
+                                            : 1;
+    }
+  }
+  next_inputs[0] = input_ids;
+  next_inputs[1] = position_ids;
+  next_inputs[2] = attention_mask;
+
+  // present_* has shape (2, batch_size, num_heads, sequence_length, head_size). Keep the first past_length tokens.
+  const int first_past = subgraph.GetFirstPastInputIndex();
+  const int first_present = subgraph.GetFirstPresentOutputIndex();
+  for (size_t i = static_cast<size_t>(first_present); i < last_outputs.size(); ++i) {
+    const OrtValue& present = last_outputs[i];
+    const TensorShape& present_shape = present.Get<Tensor>().Shape();
+    ORT_RETURN_IF(present_shape.NumDimensions() != 5 || present_shape[3] < past_length,
+                  "Present state shall have 5 dimensions and at least ", past_length, " tokens");
+
+    OrtValue past = present;
+    if (present_shape[3] > past_length) {
+      TensorShape past_shape = present_shape;
+      past_shape[3] = past_length;
+      Tensor::InitOrtValue(DataTypeImpl::GetType<T>(), past_shape, this->temp_space_allocator_, past);
+
+      const size_t rows = SafeInt<size_t>(present_shape[0]) * present_shape[1] * present_shape[2];
+      const size_t head_size = onnxruntime::narrow<size_t>(present_shape[4]);
+      const size_t present_row_size = SafeInt<size_t>(present_shape[3]) * head_size;
+      const size_t past_row_size = SafeInt<size_t>(past_length) * head_size;
+      const T* present_data = present.Get<Tensor>().Data<T>();
+      T* past_data = past.GetMutable<Tensor>()->MutableData<T>();
+      for (size_t row = 0; row < rows; row++) {
+        memcpy(past_data + row * past_row_size, present_data + row * present_row_size, past_row_size * sizeof(T));
+      }
+    }
+    next_inputs[i - first_present + first_past] = past;
+  }
+
+  return Status::OK();
+}
+
+// Probabilities of the next token given its scores after the logits processors.
+template <typename T>
+void NextTokenProbabilities(gsl::span<const T> scores, gsl::span<float> probs) {
+  float max_score = std::numeric_limits<float>::lowest();
+  for (const T& score : scores) {
+    max_score = std::max(max_score, static_cast<float>(score));
+  }
+
+  float sum = 0.0f;
+  for (size_t i = 0; i < scores.size(); i++) {
+    probs[i] = std::exp(static_cast<float>(scores[i]) - max_score);
+    sum += probs[i];
+  }
+
+  for (float& prob : probs) {
+    prob /= sum;
+  }
+}
+
+// Sample from the distribution max(0, p - q) normalized, which replaces a draft token rejected by speculative
+// sampling. The probabilities p are overwritten.
+inline int32_t SampleResidual(gsl::span<float> p, const float* q, std::default_random_engine& generator) {
+  float sum = 0.0f;
+  for (size_t i = 0; i < p.size(); i++) {
+    p[i] = std::max(p[i] - q[i], 0.0f);
+    sum += p[i];
+  }
+
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+  float threshold = distribution(generator) * sum;
+  int32_t token = 0;
+  for (size_t i = 0; i < p.size(); i++) {
+    if (p[i] > 0.0f) {
+      token = static_cast<int32_t>(i);
+      threshold -= p[i];
+      if (threshold < 0.0f) {
+        break;
+      }
+    }
+  }
+  return token;
+}
+
+// The draft decoder proposes k tokens d_1..d_k, one run each, then a single decoder run over the last token and the
+// proposed ones scores all of them. Position j of that run gives the decoder token after d_1..d_j, so d_{j+1} is
+// accepted when it matches. The first rejected token is replaced by the decoder token, and the decoder token after
+// d_k is added when all are accepted, so each decoder run generates between 1 and k + 1 tokens.
+//
+// In sampling, d_{j+1} is accepted with probability min(1, p(d) / q(d)) where p and q are the distributions of the
+// decoder and the draft decoder, and a rejected token is replaced by a sample from max(0, p - q). The tokens follow
+// the decoder distribution as they would without speculation.
+//
+// All the sequences of the batch keep the same number of tokens: generation goes on from the first position where
+// a sequence that has not met eos rejects the draft.
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::ExecuteSpeculativeStep(const FeedsFetchesManager& feeds_fetches_manager,
+                                                               std::vector<OrtValue>& feeds,
+                                                               std::vector<OrtValue>& fetches,
+                                                               SpeculativeDecodingState& speculative_state,
+                                                               GreedySearchState<T>& greedy_state,
+                                                               SamplingState<T>& sampling_state,
+                                                               int& current_length,
+                                                               int& iteration_counter,
+                                                               bool& is_done) {
+  const ParametersT* parameters = this->parameters_;
+  const bool use_sampling = std::is_same<ParametersT, SamplingParameters>::value;
+  const int batch_size = parameters->BatchBeamSize();
+  const int vocab_size = parameters->vocab_size;
+  const int num_speculative_tokens = parameters->num_speculative_tokens;
+  gsl::span<int32_t> next_tokens = greedy_state.next_tokens;
+  gsl::span<bool>& eos_meet = greedy_state.eos_meet;
+
+  // Leave room for the token of the decoder after the draft tokens.
+  const int num_draft_tokens = std::min(num_speculative_tokens, parameters->max_length - current_length - 1);
+  const int step = iteration_counter + 1;
+
+  // The first draft run also feeds the tokens that the draft decoder has not seen yet.
+  for (int i = 0; i < num_draft_tokens; i++) {
+    ORT_RETURN_IF_ERROR(UpdateSpeculativeFeeds(*draft_gpt_subgraph_, speculative_state.draft_fetches,
+                                               speculative_state.draft_feeds, speculative_state, greedy_state,
+                                               speculative_state.draft_past_length, current_length + i));
+    speculative_state.draft_fetches.clear();
+    ORT_RETURN_IF_ERROR(utils::ExecuteSubgraph(*draft_decoder_session_state_,
+                                               *draft_gpt_subgraph_->GetFeedsFetchesManager(),
+                                               speculative_state.draft_feeds,
+                                               speculative_state.draft_fetches,
+                                               {},
+                                               ExecutionMode::ORT_SEQUENTIAL,
+                                               this->context_.GetTerminateFlag(),
+                                               this->context_.Logger(),
+                                               this->ort_stream_));
+    speculative_state.draft_past_length = current_length + i;
+
+    ORT_RETURN_IF_ERROR(this->ProcessLogits(speculative_state.draft_fetches[0], greedy_state, sampling_state,
+                                            this->temp_space_allocator_, step));
+
+    for (int b = 0; b < batch_size; b++) {
+      if (eos_meet[b]) {
+        next_tokens[b] = parameters->pad_token_id;
+      }
+      speculative_state.draft_tokens[SafeInt<size_t>(b) * num_speculative_tokens + i] = next_tokens[b];
+
+      if (use_sampling) {
+        const size_t offset = (SafeInt<size_t>(b) * num_speculative_tokens + i) * vocab_size;
+        NextTokenProbabilities<T>(
+            greedy_state.next_token_scores.subspan(SafeInt<size_t>(b) * vocab_size, vocab_size),
+            gsl::make_span(speculative_state.draft_probs.data() + offset, static_cast<size_t>(vocab_size)));
+      }
+    }
+
+    greedy_state.sequences.AppendNextTokenToSequences(next_tokens);
+  }
+
+  // One decoder run over the last token and the draft tokens.
+  ORT_RETURN_IF_ERROR(UpdateSpeculativeFeeds(gpt_subgraph_, fetches, feeds, speculative_state, greedy_state,
+                                             current_length - 1, current_length + num_draft_tokens));
+  fetches.clear();
+#ifdef DEBUG_NODE_INPUTS_OUTPUTS
+  const_cast<SessionState&>(this->decoder_session_state_).IncrementGraphExecutionCounter();
+#endif
+  ORT_RETURN_IF_ERROR(utils::ExecuteSubgraph(this->decoder_session_state_,
+                                             feeds_fetches_manager,
+                                             feeds,
+                                             fetches,
+                                             {},
+                                             ExecutionMode::ORT_SEQUENTIAL,
+                                             this->context_.GetTerminateFlag(),
+                                             this->context_.Logger(),
+                                             this->ort_stream_));
+
+  // Tokens are appended again as they are accepted, so that the logits processors see the tokens before each
+  // position.
+  greedy_state.sequences.TruncateSequences(current_length);
+
+  // Logits has shape (batch_size, num_draft_tokens + 1, vocab_size).
+  const int input_length = num_draft_tokens + 1;
+  const T* logits_data = fetches[0].Get<Tensor>().Data<T>();
+  int64_t position_logits_dims[] = {batch_size, 1, vocab_size};
+  TensorShape position_logits_shape(&position_logits_dims[0], 3);
+  OrtValue position_logits;
+  Tensor::InitOrtValue(DataTypeImpl::GetType<T>(), position_logits_shape, this->temp_space_allocator_,
+                       position_logits);
+  T* position_logits_data = position_logits.GetMutable<Tensor>()->MutableData<T>();
+
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+  const int start_length = current_length;
+  for (int j = 0; j < input_length; j++) {
+    for (int b = 0; b < batch_size; b++) {
+      memcpy(position_logits_data + SafeInt<size_t>(b) * vocab_size,
+             logits_data + (SafeInt<size_t>(b) * input_length + j) * vocab_size,
+             SafeInt<size_t>(vocab_size) * sizeof(T));
+    }
+
+    // next_tokens is the decoder token after the draft tokens before position j. In sampling, the tokens at the
+    // positions of draft tokens come from the acceptance test below, so the scores are filtered without drawing a
+    // sample that would be thrown away.
+    if (use_sampling && j < num_draft_tokens) {
+      ORT_RETURN_IF_ERROR(this->process_logits_func_(position_logits, &greedy_state, &sampling_state,
+                                                     &greedy_state.sequences, this->temp_space_allocator_,
+                                                     this->thread_pool_, &this->logits_processors_, parameters,
+                                                     false, step + j, this->ort_stream_, this->GetConsoleDumper()));
+      SamplingCpuHelper::FilterNextTokenScores<T>(this->thread_pool_, greedy_state.next_token_scores,
+                                                  &sampling_state, parameters);
+    } else {
+      ORT_RETURN_IF_ERROR(this->ProcessLogits(position_logits, greedy_state, sampling_state,
+                                              this->temp_space_allocator_, step + j));
+    }
+
+    bool rejected = (j == num_draft_tokens);
+    for (int b = 0; b < batch_size && j < num_draft_tokens; b++) {
+      if (eos_meet[b]) {
+        continue;
+      }
+
+      const int32_t draft_token = speculative_state.draft_tokens[SafeInt<size_t>(b) * num_speculative_tokens + j];
+      if (use_sampling) {
+        gsl::span<float> probs = gsl::make_span(speculative_state.probs);
+        NextTokenProbabilities<T>(greedy_state.next_token_scores.subspan(SafeInt<size_t>(b) * vocab_size, vocab_size),
+                                  probs);
+        const float* draft_probs = speculative_state.draft_probs.data() +
+                                   (SafeInt<size_t>(b) * num_speculative_tokens + j) * vocab_size;
+        if (distribution(sampling_state.generator) * draft_probs[draft_token] < probs[draft_token]) {
+          next_tokens[b] = draft_token;
+        } else {
+          next_tokens[b] = SampleResidual(probs, draft_probs, sampling_state.generator);
+          rejected = true;
+        }
+      } else if (next_tokens[b] != draft_token) {
+        rejected = true;
+      }
+    }
+
+    for (int b = 0; b < batch_size; b++) {
+      if (next_tokens[b] == parameters->eos_token_id || eos_meet[b] == true) {
+        eos_meet[b] = true;
+        next_tokens[b] = parameters->pad_token_id;
+      }
+    }
+    greedy_state.sequences.AppendNextTokenToSequences(next_tokens);
+
+    // When all batches are finished, stop earlier to avoid wasting computation.
+    is_done = std::all_of(eos_meet.begin(), eos_meet.end(), [](bool eos) { return eos; });
+    if (is_done) {
+      break;
+    }
+
+    ++current_length;
+    if (rejected) {
+      break;
+    }
+  }
+
+  iteration_counter += current_length - start_length;
+
+  // The draft past state is valid up to the first token that differs from the draft.
+  speculative_state.draft_past_length = std::min(speculative_state.draft_past_length, current_length - 1);
+  return Status::OK();
+}
+
 template <typename T, typename ParametersT>
 Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_run_feeds_fetches_manager,
                                                 const FeedsFetchesManager& feeds_fetches_manager) {
@@ -228,6 +645,28 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
   OrtValue expanded_input_ids_in_cpu;
   ORT_RETURN_IF_ERROR(CreateInitialFeeds(greedy_state.sequence_lengths, expanded_input_ids_in_cpu, feeds, buffer));
 
+  const bool use_speculative_decoding = (draft_gpt_subgraph_ != nullptr);
+
+  // The first run starts from the past state of the longest cached prefix of the prompt. The cache is only used
+  // when the first run is done by the decoder with a past state of variable length on CPU.
+  const bool use_prompt_cache = prompt_cache_ != nullptr && !this->IsCuda() &&
+                                init_run_decoder_session_state_ == nullptr &&
+                                !gpt_subgraph_.past_present_share_buffer_ && !use_speculative_decoding;
+  if (use_prompt_cache) {
+    int cached_length = 0;
+    ORT_RETURN_IF_ERROR(SeedGptFeedsFromPromptCache(*prompt_cache_, gpt_subgraph_.GetFirstPastInputIndex(),
+                                                    gpt_subgraph_.num_layers, this->temp_space_allocator_, feeds,
+                                                    cached_length));
+  }
+
+  SpeculativeDecodingState speculative_state;
+  IAllocatorUniquePtr<char> draft_buffer;
+  OrtValue draft_expanded_input_ids;
+  if (use_speculative_decoding) {
+    ORT_RETURN_IF_ERROR(InitializeSpeculativeDecoding(feeds, greedy_state.sequence_lengths, draft_expanded_input_ids,
+                                                      draft_buffer, speculative_state));
+  }
+
   if (gpt_subgraph_.past_present_share_buffer_) {  // Reuse past and present
     fetches.reserve(static_cast<size_t>(gpt_subgraph_.GetFirstPresentOutputIndex()) + gpt_subgraph_.num_layers);
     fetches.resize(gpt_subgraph_.GetFirstPresentOutputIndex(), OrtValue());
@@ -278,6 +717,18 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
     dumper->Print("past", feeds[3]);
 #endif
 
+    // After the first iteration, each decoder run verifies the tokens proposed by the draft decoder.
+    if (use_speculative_decoding && iteration_counter > 0) {
+      bool is_done = false;
+      ORT_RETURN_IF_ERROR(ExecuteSpeculativeStep(feeds_fetches_manager, feeds, fetches, speculative_state,
+                                                 greedy_state, sampling_state, current_length, iteration_counter,
+                                                 is_done));
+      if (is_done) {
+        break;
+      }
+      continue;
+    }
+
     // For the first iteration use the init_run_decoder subgraph (if present)
     if (iteration_counter++ == 0 &&
         init_run_decoder_session_state_ != nullptr) {
@@ -310,6 +761,12 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
 
     ORT_RETURN_IF_ERROR(status);
 
+    if (use_prompt_cache && iteration_counter == 1) {
+      ORT_RETURN_IF_ERROR(AddGptPromptToPromptCache(*prompt_cache_, expanded_input_ids_in_cpu.Get<Tensor>(),
+                                                    feeds[2].Get<Tensor>(), gpt_subgraph_.GetFirstPresentOutputIndex(),
+                                                    gpt_subgraph_.num_layers, fetches));
+    }
+
     const OrtValue& logits = fetches[0];
     gsl::span<int32_t> next_tokens;
 
@@ -355,8 +812,8 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
     }
 #endif
 
-    // Prepare inputs for next round of subgraph call.
-    if (current_length < parameters->max_length) {
+    // Prepare inputs for next round of subgraph call. Speculative decoding prepares its own inputs.
+    if (current_length < parameters->max_length && !use_speculative_decoding) {
       bool increase_position = (iteration_counter > 1);
 
       ORT_RETURN_IF_ERROR(UpdateFeeds(fetches, feeds, current_length,
@@ -369,7 +826,7 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
       for (int idx = 0; idx < gpt_subgraph_.GetFirstPresentOutputIndex(); idx++) {
         fetches[idx] = OrtValue();
       }
-    } else {
+    } else if (!use_speculative_decoding) {
       fetches.clear();
     }
   }
@@ -0,0 +1,314 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/common/safeint.h"
+#include "core/framework/tensor.h"
+#include "contrib_ops/cpu/transformers/prompt_cache.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+PromptCache::PromptCache(size_t max_bytes, int block_size) : max_bytes_(max_bytes), block_size_(block_size) {
+  ORT_ENFORCE(block_size > 0);
+}
+
+size_t PromptCache::SizeInBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_in_bytes_;
+}
+
+size_t PromptCache::NumBlocks() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+uint64_t PromptCache::BlockKey(uint64_t parent_key, gsl::span<const int32_t> block_tokens) const {
+  uint64_t key = parent_key;
+  for (int32_t token : block_tokens) {
+    key ^= static_cast<uint64_t>(static_cast<uint32_t>(token)) + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+  }
+  return key;
+}
+
+PromptCache::Entry* PromptCache::FindEntry(uint64_t key, uint64_t parent_key, gsl::span<const int32_t> block_tokens) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+
+  // A different prefix with the same key is a miss.
+  const Block& block = *it->second.block;
+  if (block.parent_key != parent_key ||
+      !std::equal(block.tokens.begin(), block.tokens.end(), block_tokens.begin(), block_tokens.end())) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+void PromptCache::Touch(Entry& entry) {
+  lru_.splice(lru_.begin(), lru_, entry.lru_position);
+}
+
+bool PromptCache::EvictUntilFits(size_t bytes, size_t num_kept) {
+  // Nothing is evicted when the kept blocks leave no room.
+  size_t kept_bytes = 0;
+  auto kept = lru_.begin();
+  for (size_t i = 0; i < num_kept && kept != lru_.end(); ++i, ++kept) {
+    kept_bytes += entries_.at(*kept).block->data.size();
+  }
+  if (kept_bytes + bytes > max_bytes_) {
+    return false;
+  }
+
+  while (size_in_bytes_ + bytes > max_bytes_ && lru_.size() > num_kept) {
+    auto it = entries_.find(lru_.back());
+    size_in_bytes_ -= it->second.block->data.size();
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+  return size_in_bytes_ + bytes <= max_bytes_;
+}
+
+std::vector<std::shared_ptr<const PromptCache::Block>> PromptCache::Find(gsl::span<const int32_t> tokens,
+                                                                         size_t max_length) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const size_t block_size = static_cast<size_t>(block_size_);
+  const size_t length = std::min(tokens.size(), max_length);
+  std::vector<Entry*> entries;
+  uint64_t parent_key = 0;
+  for (size_t end = block_size; end <= length; end += block_size) {
+    gsl::span<const int32_t> block_tokens = tokens.subspan(end - block_size, block_size);
+    const uint64_t key = BlockKey(parent_key, block_tokens);
+    Entry* entry = FindEntry(key, parent_key, block_tokens);
+    if (entry == nullptr) {
+      break;
+    }
+    entries.push_back(entry);
+    parent_key = key;
+  }
+
+  std::vector<std::shared_ptr<const Block>> blocks;
+  blocks.reserve(entries.size());
+  for (Entry* entry : entries) {
+    blocks.push_back(entry->block);
+  }
+  for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+    Touch(**it);
+  }
+  return blocks;
+}
+
+void PromptCache::Add(gsl::span<const int32_t> tokens,
+                      size_t block_bytes,
+                      const std::function<void(size_t, gsl::span<uint8_t>)>& fill) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Blocks of the prompt are touched as they are visited, so eviction for a new block never takes the blocks
+  // before it. The prompt is cached up to the first block that does not fit.
+  const size_t block_size = static_cast<size_t>(block_size_);
+  std::vector<Entry*> entries;
+  uint64_t parent_key = 0;
+  for (size_t end = block_size; end <= tokens.size(); end += block_size) {
+    gsl::span<const int32_t> block_tokens = tokens.subspan(end - block_size, block_size);
+    const uint64_t key = BlockKey(parent_key, block_tokens);
+    Entry* entry = FindEntry(key, parent_key, block_tokens);
+    if (entry != nullptr) {
+      Touch(*entry);
+    } else {
+      // Another prefix with the same key keeps its block.
+      if (entries_.count(key) != 0 || !EvictUntilFits(block_bytes, entries.size())) {
+        break;
+      }
+
+      auto block = std::make_shared<Block>();
+      block->parent_key = parent_key;
+      block->tokens.assign(block_tokens.begin(), block_tokens.end());
+      block->data.resize(block_bytes);
+      fill(end / block_size - 1, gsl::make_span(block->data));
+
+      lru_.push_front(key);
+      entry = &entries_.emplace(key, Entry{std::move(block), lru_.begin()}).first->second;
+      size_in_bytes_ += block_bytes;
+    }
+    entries.push_back(entry);
+    parent_key = key;
+  }
+
+  for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+    Touch(**it);
+  }
+}
+
+Status SeedGptFeedsFromPromptCache(PromptCache& prompt_cache,
+                                   int first_past_input_index,
+                                   int num_layers,
+                                   AllocatorPtr allocator,
+                                   std::vector<OrtValue>& feeds,
+                                   int& cached_length) {
+  cached_length = 0;
+
+  // Feeds are input_ids, position_ids and attention_mask of shape (batch_size, sequence_length), then the past state.
+  const Tensor& input_ids = feeds[0].Get<Tensor>();
+  const TensorShape& input_ids_shape = input_ids.Shape();
+  ORT_RETURN_IF(input_ids_shape.NumDimensions() != 2, "input_ids shall have 2 dimensions");
+  const int64_t batch_size = input_ids_shape[0];
+  const int64_t sequence_length = input_ids_shape[1];
+
+  // With padding, the positions of the tokens of a prompt depend on the other prompts of the batch.
+  gsl::span<const int32_t> attention_mask = feeds[2].Get<Tensor>().DataAsSpan<int32_t>();
+  if (std::any_of(attention_mask.begin(), attention_mask.end(), [](int32_t mask) { return mask != 1; })) {
+    return Status::OK();
+  }
+
+  gsl::span<const int32_t> input_ids_data = input_ids.DataAsSpan<int32_t>();
+  const size_t sequence_size = static_cast<size_t>(sequence_length);
+  std::vector<std::vector<std::shared_ptr<const PromptCache::Block>>> blocks(static_cast<size_t>(batch_size));
+  size_t num_blocks = sequence_size;
+  for (size_t b = 0; b < blocks.size(); b++) {
+    blocks[b] = prompt_cache.Find(input_ids_data.subspan(b * sequence_size, sequence_size), sequence_size - 1);
+    num_blocks = std::min(num_blocks, blocks[b].size());
+  }
+  if (num_blocks == 0) {
+    return Status::OK();
+  }
+
+  const Tensor& empty_past = feeds[first_past_input_index].Get<Tensor>();
+  const TensorShape& empty_past_shape = empty_past.Shape();
+  ORT_RETURN_IF(empty_past_shape.NumDimensions() != 5 || empty_past_shape[3] != 0,
+                "The past state of the first run shall be empty with 5 dimensions");
+  // The empty past state is released when the past state of the first layer replaces it.
+  const MLDataType element_type = empty_past.DataType();
+  const int64_t num_heads = empty_past_shape[2];
+  const int64_t head_size = empty_past_shape[4];
+  const int64_t block_size = prompt_cache.BlockSize();
+  const int64_t past_length = static_cast<int64_t>(num_blocks) * block_size;
+  const int64_t new_length = sequence_length - past_length;
+
+  // A block holds the past state of all layers with shape (num_layers, 2, num_heads, block_size, head_size).
+  const size_t head_block_bytes = SafeInt<size_t>(block_size) * head_size * element_type->Size();
+  const size_t block_bytes = SafeInt<size_t>(num_layers) * 2 * num_heads * head_block_bytes;
+  for (const auto& row_blocks : blocks) {
+    for (size_t i = 0; i < num_blocks; i++) {
+      ORT_RETURN_IF(row_blocks[i]->data.size() != block_bytes,
+                    "The prompt cache has blocks of ", row_blocks[i]->data.size(), " bytes, expected ", block_bytes);
+    }
+  }
+
+  // Past state of each layer has shape (2, batch_size, num_heads, past_length, head_size).
+  for (int layer = 0; layer < num_layers; layer++) {
+    OrtValue past;
+    Tensor::InitOrtValue(element_type, TensorShape{2, batch_size, num_heads, past_length, head_size},
+                         allocator, past);
+    uint8_t* past_data = static_cast<uint8_t*>(past.GetMutable<Tensor>()->MutableDataRaw());
+    for (int64_t kv = 0; kv < 2; kv++) {
+      for (int64_t b = 0; b < batch_size; b++) {
+        for (int64_t h = 0; h < num_heads; h++) {
+          const size_t head_offset = ((SafeInt<size_t>(layer) * 2 + kv) * num_heads + h) * head_block_bytes;
+          const size_t past_offset = ((SafeInt<size_t>(kv) * batch_size + b) * num_heads + h) * num_blocks *
+                                     head_block_bytes;
+          uint8_t* destination = past_data + past_offset;
+          for (size_t i = 0; i < num_blocks; i++) {
+            memcpy(destination + i * head_block_bytes,
+                   blocks[static_cast<size_t>(b)][i]->data.data() + head_offset,
+                   head_block_bytes);
+          }
+        }
+      }
+    }
+    feeds[static_cast<size_t>(first_past_input_index) + layer] = past;
+  }
+
+  // The run feeds the tokens after the cached prefix, with their positions in the prompt.
+  auto int32_type = DataTypeImpl::GetType<int32_t>();
+  gsl::span<const int32_t> position_ids_data = feeds[1].Get<Tensor>().DataAsSpan<int32_t>();
+  OrtValue new_input_ids;
+  OrtValue new_position_ids;
+  Tensor::InitOrtValue(int32_type, TensorShape{batch_size, new_length}, allocator, new_input_ids);
+  Tensor::InitOrtValue(int32_type, TensorShape{batch_size, new_length}, allocator, new_position_ids);
+  int32_t* new_input_ids_data = new_input_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  int32_t* new_position_ids_data = new_position_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  for (int64_t b = 0; b < batch_size; b++) {
+    const size_t source_offset = SafeInt<size_t>(b) * sequence_length + past_length;
+    const size_t target_offset = SafeInt<size_t>(b) * new_length;
+    std::copy_n(input_ids_data.begin() + source_offset, new_length, new_input_ids_data + target_offset);
+    std::copy_n(position_ids_data.begin() + source_offset, new_length, new_position_ids_data + target_offset);
+  }
+  feeds[0] = new_input_ids;
+  feeds[1] = new_position_ids;
+
+  cached_length = static_cast<int>(past_length);
+  return Status::OK();
+}
+
+Status AddGptPromptToPromptCache(PromptCache& prompt_cache,
+                                 const Tensor& input_ids,
+                                 const Tensor& attention_mask,
+                                 int first_present_output_index,
+                                 int num_layers,
+                                 const std::vector<OrtValue>& fetches) {
+  gsl::span<const int32_t> attention_mask_data = attention_mask.DataAsSpan<int32_t>();
+  if (std::any_of(attention_mask_data.begin(), attention_mask_data.end(), [](int32_t mask) { return mask != 1; })) {
+    return Status::OK();
+  }
+
+  const TensorShape& input_ids_shape = input_ids.Shape();
+  ORT_RETURN_IF(input_ids_shape.NumDimensions() != 2, "input_ids shall have 2 dimensions");
+  const int64_t batch_size = input_ids_shape[0];
+  const int64_t sequence_length = input_ids_shape[1];
+  const int64_t block_size = prompt_cache.BlockSize();
+  if (sequence_length < block_size) {
+    return Status::OK();
+  }
+
+  const Tensor& first_present = fetches[static_cast<size_t>(first_present_output_index)].Get<Tensor>();
+  const TensorShape& present_shape = first_present.Shape();
+  ORT_RETURN_IF(present_shape.NumDimensions() != 5 || present_shape[1] != batch_size ||
+                    present_shape[3] != sequence_length,
+                "Present state of the first run shall have shape (2, ", batch_size, ", num_heads, ",
+                sequence_length, ", head_size), got ", present_shape);
+  const int64_t num_heads = present_shape[2];
+  const int64_t head_size = present_shape[4];
+
+  const size_t element_size = first_present.DataType()->Size();
+  const size_t head_block_bytes = SafeInt<size_t>(block_size) * head_size * element_size;
+  const size_t block_bytes = SafeInt<size_t>(num_layers) * 2 * num_heads * head_block_bytes;
+  const size_t head_present_bytes = SafeInt<size_t>(sequence_length) * head_size * element_size;
+
+  std::vector<const uint8_t*> presents(static_cast<size_t>(num_layers));
+  for (int layer = 0; layer < num_layers; layer++) {
+    const Tensor& present = fetches[static_cast<size_t>(first_present_output_index) + layer].Get<Tensor>();
+    ORT_RETURN_IF(present.Shape() != present_shape, "Present state of all layers shall have the same shape");
+    presents[static_cast<size_t>(layer)] = static_cast<const uint8_t*>(present.DataRaw());
+  }
+
+  gsl::span<const int32_t> input_ids_data = input_ids.DataAsSpan<int32_t>();
+  const size_t sequence_size = static_cast<size_t>(sequence_length);
+  for (int64_t b = 0; b < batch_size; b++) {
+    auto fill = [&](size_t block_index, gsl::span<uint8_t> data) {
+      for (int layer = 0; layer < num_layers; layer++) {
+        for (int64_t kv = 0; kv < 2; kv++) {
+          for (int64_t h = 0; h < num_heads; h++) {
+            const size_t source_offset = ((SafeInt<size_t>(kv) * batch_size + b) * num_heads + h) * head_present_bytes +
+                                         block_index * head_block_bytes;
+            const size_t target_offset = ((SafeInt<size_t>(layer) * 2 + kv) * num_heads + h) * head_block_bytes;
+            memcpy(data.data() + target_offset, presents[static_cast<size_t>(layer)] + source_offset,
+                   head_block_bytes);
+          }
+        }
+      }
+    };
+    prompt_cache.Add(input_ids_data.subspan(static_cast<size_t>(b) * sequence_size, sequence_size), block_bytes,
+                     fill);
+  }
+
+  return Status::OK();
+}
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifndef SHARED_PROVIDER
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+#endif
+
+#include "core/common/gsl.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+// Cache of the past state of prompt prefixes, shared by the runs of a generation operator in a session.
+//
+// Prompts are split in blocks of block_size tokens. A block is keyed by the hash of all the tokens from the start of
+// the prompt to its end, chained from the key of the previous block, and holds the past state of its own tokens.
+// Prompts that start with the same tokens, like a shared system prompt, share the blocks of that prefix.
+//
+// Blocks are evicted in least recently used order when their total size exceeds max_bytes. A lookup or an insertion
+// touches the blocks of a prompt from the last to the first one, so a block is never used less recently than the
+// blocks after it and prefixes are evicted from their end.
+class PromptCache {
+ public:
+  struct Block {
+    uint64_t parent_key;          // key of the previous block, 0 for the first block of a prompt
+    std::vector<int32_t> tokens;  // the block_size tokens of the block
+    std::vector<uint8_t> data;    // past state of the tokens, in a layout defined by the caller
+  };
+
+  static constexpr int kDefaultBlockSize = 16;
+
+  PromptCache(size_t max_bytes, int block_size = kDefaultBlockSize);
+
+  int BlockSize() const { return block_size_; }
+  size_t SizeInBytes() const;
+  size_t NumBlocks() const;
+
+  // Returns the blocks of the longest cached prefix of tokens with at most max_length tokens.
+  std::vector<std::shared_ptr<const Block>> Find(gsl::span<const int32_t> tokens, size_t max_length);
+
+  // Adds the blocks of the full blocks of tokens that are not cached yet. fill(block_index, data) writes the past
+  // state of a block to data, which has block_bytes bytes.
+  void Add(gsl::span<const int32_t> tokens,
+           size_t block_bytes,
+           const std::function<void(size_t, gsl::span<uint8_t>)>& fill);
+
+ private:
+  struct Entry {
+    std::shared_ptr<const Block> block;
+    std::list<uint64_t>::iterator lru_position;
+  };
+
+  uint64_t BlockKey(uint64_t parent_key, gsl::span<const int32_t> block_tokens) const;
+
+  // Returns the entry of a block when it is cached for the given previous block.
+  Entry* FindEntry(uint64_t key, uint64_t parent_key, gsl::span<const int32_t> block_tokens);
+
+  void Touch(Entry& entry);
+
+  // Evicts blocks until bytes more fit, except the num_kept most recently used ones. Returns false if they don't fit.
+  bool EvictUntilFits(size_t bytes, size_t num_kept);
+
+  size_t max_bytes_;
+  int block_size_;
+
+  mutable std::mutex mutex_;
+  size_t size_in_bytes_ = 0;
+  std::unordered_map<uint64_t, Entry> entries_;
+  std::list<uint64_t> lru_;  // keys, the most recently used first
+};
+
+// Replaces the initial feeds of a GPT decoder run over the whole prompt by a run over the tokens after the longest
+// prefix cached for all the sequences, with the past state of the prefix from the cache. At least one token is left
+// to produce the logits. cached_length is the length of the prefix, 0 when the feeds are unchanged, which is always
+// the case for prompts with padding.
+Status SeedGptFeedsFromPromptCache(PromptCache& prompt_cache,
+                                   int first_past_input_index,
+                                   int num_layers,
+                                   AllocatorPtr allocator,
+                                   std::vector<OrtValue>& feeds,
+                                   int& cached_length);
+
+// Adds the past state of the prompt to the cache from the present outputs of the first GPT decoder run, which has
+// shape (2, batch_size, num_heads, sequence_length, head_size) for each layer. Prompts with padding are not added.
+Status AddGptPromptToPromptCache(PromptCache& prompt_cache,
+                                 const Tensor& input_ids,
+                                 const Tensor& attention_mask,
+                                 int first_present_output_index,
+                                 int num_layers,
+                                 const std::vector<OrtValue>& fetches);
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
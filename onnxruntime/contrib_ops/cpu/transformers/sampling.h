@@ -9,6 +9,7 @@
 #include "core/providers/cpu/controlflow/utils.h"
 #include "contrib_ops/cpu/transformers/subgraph_gpt.h"
 #include "contrib_ops/cpu/transformers/generation_device_helper.h"
+#include "contrib_ops/cpu/transformers/prompt_cache.h"
 #include "contrib_ops/cpu/transformers/sampling_parameters.h"
 
 namespace onnxruntime {
@@ -103,6 +104,9 @@ class Sampling : public IControlFlowKernel {
   std::unique_ptr<GptSubgraph> init_run_gpt_subgraph_;
   std::unique_ptr<GptSubgraph> gpt_subgraph_;
 
+  // The draft_gpt_subgraph_ (if the `draft_decoder` attribute is present) proposes tokens for speculative decoding.
+  std::unique_ptr<GptSubgraph> draft_gpt_subgraph_;
+
   FeedsFetchesManager* decoder_feeds_fetches_manager_;
   FeedsFetchesManager* init_run_decoder_feeds_fetches_manager_;
 
@@ -111,6 +115,11 @@ class Sampling : public IControlFlowKernel {
   SamplingParameters parameters_;
 
   bool has_init_decoder_ = false;
+
+  bool has_draft_decoder_ = false;
+
+  // Past state of prompt prefixes shared by the runs of the node (if the `prompt_cache_size` attribute is positive).
+  std::unique_ptr<PromptCache> prompt_cache_;
 };
 
 }  // namespace transformers
@@ -2,56 +2,170 @@
 // Licensed under the MIT License.
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include "core/common/inlined_containers.h"
+#include "core/common/safeint.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "contrib_ops/cpu/transformers/generation_shared.h"
+
 namespace onnxruntime {
 namespace contrib {
 namespace SamplingCpuHelper {
 
+// Orders the tokens by decreasing score up to the top-p cutoff and returns the number of tokens to keep, which are
+// the first ones in candidates. Instead of sorting the whole vocabulary, the top k tokens are selected with a
+// partial sort and k is doubled until the cumulative probability reaches top_p, so that a peaked distribution
+// only costs a linear scan.
 template <typename T>
-void filter_scores(std::vector<size_t>& sorted_indice,
-                   gsl::span<T>& next_token_score,
-                   const transformers::IGenerationParameters* parameters,
-                   size_t chunk_offset,
-                   size_t offset) {
-  size_t real_index = sorted_indice[chunk_offset + offset];
-  next_token_score[chunk_offset + real_index] = (T)parameters->filter_value;
+size_t SelectTopP(gsl::span<const T> scores,
+                  gsl::span<const float> probs,
+                  gsl::span<int32_t> candidates,
+                  const transformers::IGenerationParameters* parameters) {
+  constexpr size_t kInitialTopK = 64;
+  const size_t vocab_size = scores.size();
+
+  std::iota(candidates.begin(), candidates.end(), 0);
+
+  // Ties are ordered by token id, so the kept tokens do not depend on the sort implementation.
+  auto greater = [&scores](int32_t a, int32_t b) {
+    return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+  };
+
+  size_t sorted_count = 0;
+  auto sort_head = [&](size_t count) {
+    if (count > sorted_count) {
+      const size_t end = std::min(vocab_size, std::max({count, 2 * sorted_count, kInitialTopK}));
+      std::partial_sort(candidates.begin() + sorted_count, candidates.begin() + end, candidates.end(), greater);
+      sorted_count = end;
+    }
+  };
+
+  const double top_p = static_cast<double>(parameters->top_p);
+  double cumulative_prob = 0.0;
+  size_t keep_count = 0;
+  if (parameters->custom_sampling) {
+    // Keep tokens up to the first one where the cumulative probability exceeds top_p.
+    do {
+      sort_head(keep_count + 1);
+      cumulative_prob += probs[candidates[keep_count++]];
+    } while (keep_count < vocab_size && cumulative_prob <= top_p);
+  } else {
+    // The tail of the distribution is removed while its probability is at most 1 - top_p, which keeps tokens up to
+    // the first one where the cumulative probability reaches top_p, and at least min_tokens_to_keep tokens.
+    while (keep_count < vocab_size && cumulative_prob < top_p) {
+      sort_head(keep_count + 1);
+      cumulative_prob += probs[candidates[keep_count++]];
+    }
+    keep_count = std::max(keep_count, static_cast<size_t>(std::max(parameters->min_tokens_to_keep, 0)));
+  }
+
+  keep_count = std::min(std::max(keep_count, size_t{1}), vocab_size);
+  sort_head(keep_count);
+  return keep_count;
 }
 
+// torch.multinomial() of one sample from the scores of the given tokens, which must be in increasing order, or
+// of all tokens when tokens is nullptr. Scores that are not finite are excluded. It computes the distribution
+// like MultinomialComputeShared() so that a seed generates the same tokens.
 template <typename T>
-void cumulate_and_filter_custom(gsl::span<T>& next_token_scores,
-                                gsl::span<T>& cumulative_probs,
-                                const transformers::IGenerationParameters* parameters,
-                                std::vector<size_t>& sorted_indices) {
-  for (size_t i = 0; i < static_cast<size_t>(parameters->batch_size); i++) {
-    size_t offset = i * parameters->vocab_size;
-    if (cumulative_probs[offset] > parameters->top_p) {
-      filter_scores(sorted_indices, next_token_scores, parameters, offset, 1);
+int32_t SampleToken(gsl::span<const T> scores, const int32_t* tokens, size_t count, double uniform) {
+  auto token_at = [tokens](size_t i) { return tokens != nullptr ? tokens[i] : static_cast<int32_t>(i); };
+
+  float max_score = std::numeric_limits<float>::lowest();
+  for (size_t i = 0; i < count; i++) {
+    const float score = static_cast<float>(scores[token_at(i)]);
+    if (std::isfinite(score)) {
+      max_score = std::max(max_score, score);
+    }
+  }
+  const double max_logit = static_cast<double>(max_score);
+
+  double total = 0.0;
+  for (size_t i = 0; i < count; i++) {
+    const float score = static_cast<float>(scores[token_at(i)]);
+    if (std::isfinite(score)) {
+      total += std::exp(static_cast<double>(score) - max_logit);
     }
-    for (size_t j = 1; j < static_cast<size_t>(parameters->vocab_size) - 1; j++) {
-      cumulative_probs[j + offset] += cumulative_probs[j + offset - 1];
-      if (cumulative_probs[j + offset] > parameters->top_p) {
-        filter_scores(sorted_indices, next_token_scores, parameters, offset, j + 1);
+  }
+
+  const double target = uniform * total;
+  double running_total = 0.0;
+  for (size_t i = 0; i < count; i++) {
+    const float score = static_cast<float>(scores[token_at(i)]);
+    if (std::isfinite(score)) {
+      running_total += std::exp(static_cast<double>(score) - max_logit);
+      if (running_total > target) {
+        return token_at(i);
       }
     }
   }
+
+  // All scores are filtered, which is only possible when min_tokens_to_keep does not apply.
+  return token_at(0);
 }
 
+// Replaces the scores of the tokens outside of top_p by filter_value and returns the number of tokens kept. The
+// kept tokens are the first ones in candidates when fewer than vocab_size are kept.
 template <typename T>
-void cumulate_and_filter(gsl::span<T>& next_token_scores,
-                         gsl::span<T>& cumulative_probs,
-                         const transformers::IGenerationParameters* parameters,
-                         std::vector<size_t>& sorted_indices) {
-  for (size_t i = 0; i < static_cast<size_t>(parameters->batch_size); i++) {
-    size_t offset = i * parameters->vocab_size;
-    if (cumulative_probs[offset] <= 1 - parameters->top_p) {
-      filter_scores(sorted_indices, next_token_scores, parameters, offset, 0);
+size_t FilterTopP(gsl::span<T> scores,
+                  gsl::span<T> probs,
+                  gsl::span<int32_t> candidates,
+                  const transformers::IGenerationParameters* parameters) {
+  const size_t vocab_size = scores.size();
+
+  // top_p of 1 keeps every token, so the softmax and the selection are skipped.
+  if (parameters->top_p >= 1.0f) {
+    return vocab_size;
+  }
+
+  MlasComputeSoftmax(scores.data(), probs.data(), 1, vocab_size, false, nullptr);
+  const size_t keep_count = SelectTopP<T>(scores, probs, candidates, parameters);
+
+  if (keep_count < vocab_size) {
+    // The probabilities are no longer needed, so they hold the scores of the kept tokens while the row is filtered.
+    for (size_t j = 0; j < keep_count; j++) {
+      probs[j] = scores[candidates[j]];
     }
-    for (size_t j = 1; j < static_cast<size_t>(parameters->vocab_size) - static_cast<size_t>(parameters->min_tokens_to_keep); j++) {
-      cumulative_probs[j + offset] += cumulative_probs[j + offset - 1];
-      if (cumulative_probs[j + offset] <= 1 - parameters->top_p) {
-        filter_scores(sorted_indices, next_token_scores, parameters, offset, j);
-      }
+    std::fill(scores.begin(), scores.end(), static_cast<T>(parameters->filter_value));
+    for (size_t j = 0; j < keep_count; j++) {
+      scores[candidates[j]] = probs[j];
     }
   }
+
+  return keep_count;
+}
+
+// Applies the top-p filter of Sample() to the scores of every sequence without drawing the next tokens.
+template <typename T>
+void FilterNextTokenScores(onnxruntime::concurrency::ThreadPool* thread_pool,
+                           gsl::span<T>& next_token_scores,
+                           transformers::ISamplingState<T>* sampling_state,
+                           const transformers::IGenerationParameters* parameters) {
+  if (parameters->top_p >= 1.0f) {
+    return;
+  }
+
+  const size_t batch_size = static_cast<size_t>(parameters->batch_size);
+  const size_t vocab_size = static_cast<size_t>(parameters->vocab_size);
+  gsl::span<T>& probs = sampling_state->probs;
+  gsl::span<int32_t>& candidates = sampling_state->candidate_indices;
+
+  const double bytes_per_row = static_cast<double>(vocab_size * sizeof(T));
+  const TensorOpCost cost{bytes_per_row * 2, bytes_per_row * 2, static_cast<double>(vocab_size) * 12.0};
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(batch_size), cost,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          const size_t offset = SafeInt<size_t>(i) * vocab_size;
+          FilterTopP<T>(next_token_scores.subspan(offset, vocab_size), probs.subspan(offset, vocab_size),
+                        candidates.subspan(offset, vocab_size), parameters);
+        }
+      });
 }
 
 template <typename T>
@@ -62,99 +176,51 @@ Status Sample(AllocatorPtr& allocator,
               transformers::IGreedySearchState<T>* greedy_state,
               const transformers::IGenerationParameters* parameters,
               const transformers::IConsoleDumper* dumper) {
+  ORT_UNUSED_PARAMETER(allocator);
   ORT_UNUSED_PARAMETER(dumper);
 
-  gsl::span<T>& sorted_scores = sampling_state->sorted_scores;
-  memcpy(sorted_scores.data(), next_token_scores.data(), next_token_scores.size_bytes());
-  std::vector<size_t> sorted_indices(static_cast<size_t>(parameters->batch_size) * static_cast<size_t>(parameters->vocab_size));
+  const size_t batch_size = static_cast<size_t>(parameters->batch_size);
+  const size_t vocab_size = static_cast<size_t>(parameters->vocab_size);
 
-  std::function<bool(T, T)> predicator;
-  if (parameters->custom_sampling) {
-    predicator = std::greater<T>();
-  } else {
-    predicator = std::less<T>();
+  // One uniform number is drawn per sequence in the order of the batch before the rows are sampled in parallel,
+  // so the generated tokens only depend on the seed and not on the number of threads.
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  InlinedVector<double> uniforms(batch_size);
+  for (double& uniform : uniforms) {
+    uniform = distribution(sampling_state->generator);
   }
 
-  // TODO: This could be optimized with allocated buffer and handwritten sort algorithm
-  for (size_t i = 0; i < static_cast<size_t>(parameters->batch_size); i++) {
-    auto indices_begin = sorted_indices.begin() + i * parameters->vocab_size;
-    auto indices_end = sorted_indices.begin() + (i + 1) * parameters->vocab_size;
-    gsl::span<T> next_token_score = next_token_scores.subspan(i * parameters->vocab_size, parameters->vocab_size);
-    std::iota(indices_begin, indices_end, 0);
-    std::sort(indices_begin, indices_end,
-              [&next_token_score, &predicator](size_t i1, size_t i2) {
-                return predicator(next_token_score[i1], next_token_score[i2]);
-              });
-
-    std::sort(sorted_scores.begin() + i * parameters->vocab_size,
-              sorted_scores.begin() + (i + 1) * parameters->vocab_size,
-              predicator);
-  }
+  const bool filtered_are_excluded = std::isinf(parameters->filter_value) && parameters->filter_value < 0.0f;
+
+  gsl::span<T>& probs = sampling_state->probs;
+  gsl::span<int32_t>& candidates = sampling_state->candidate_indices;
+  gsl::span<int32_t>& next_tokens = greedy_state->next_tokens;
+
+  const double bytes_per_row = static_cast<double>(vocab_size * sizeof(T));
+  const TensorOpCost cost{bytes_per_row * 2, bytes_per_row * 2, static_cast<double>(vocab_size) * 16.0};
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(batch_size), cost,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          const size_t offset = SafeInt<size_t>(i) * vocab_size;
+          gsl::span<T> scores = next_token_scores.subspan(offset, vocab_size);
+          gsl::span<int32_t> row_candidates = candidates.subspan(offset, vocab_size);
+
+          const size_t keep_count = FilterTopP<T>(scores, probs.subspan(offset, vocab_size), row_candidates,
+                                                  parameters);
+
+          if (keep_count < vocab_size && filtered_are_excluded) {
+            std::sort(row_candidates.begin(), row_candidates.begin() + keep_count);
+            next_tokens[i] = SampleToken<T>(scores, row_candidates.data(), keep_count, uniforms[i]);
+          } else {
+            next_tokens[i] = SampleToken<T>(scores, nullptr, vocab_size, uniforms[i]);
+          }
+        }
+      });
 
 #ifdef DEBUG_GENERATION
-  dumper->Print("sorted_scores", sorted_scores.data(), parameters->batch_size, parameters->vocab_size);
-  dumper->Print("sorted_indices", sorted_indices.data(), parameters->batch_size, parameters->vocab_size);
-#endif
-
-  gsl::span<T>& cumulative_probs = sampling_state->cumulative_probs;
-
-  ORT_RETURN_IF_ERROR(SoftmaxCPU<T>(parameters->batch_size,
-                                    parameters->vocab_size,
-                                    sorted_scores.data(),
-                                    cumulative_probs.data(),
-                                    false,
-                                    thread_pool));
-
-  if (parameters->custom_sampling) {
-    cumulate_and_filter_custom(next_token_scores, cumulative_probs, parameters, sorted_indices);
-  } else {
-    cumulate_and_filter(next_token_scores, cumulative_probs, parameters, sorted_indices);
-  }
-
-#ifdef DEBUG_GENERATION
-  dumper->Print("cumulative_probs after filtering", cumulative_probs.data(), parameters->batch_size, parameters->vocab_size);
   dumper->Print("next_token_scores after filtering", next_token_scores.data(), parameters->batch_size, parameters->vocab_size);
-#endif
-
-  // torch.multinomial()
-  int64_t next_token_probs_dims[] = {static_cast<int64_t>(parameters->batch_size), parameters->vocab_size};
-  TensorShape next_token_probs_shape(&next_token_probs_dims[0], 2);
-  auto element_type = DataTypeImpl::GetType<T>();
-  OrtValue next_token_probs_value;
-  Tensor::InitOrtValue(element_type,
-                       next_token_probs_shape,
-                       next_token_scores.data(),
-                       allocator->Info(),
-                       next_token_probs_value);
-  const Tensor& input = next_token_probs_value.Get<Tensor>();
-
-  std::default_random_engine& generator = sampling_state->generator;
-
-  int64_t sampled_idx_dims[] = {static_cast<int64_t>(parameters->batch_size), 1};
-  TensorShape sampled_idx_shape(&sampled_idx_dims[0], 2);
-
-  gsl::span<int32_t>& next_token_idx = greedy_state->next_tokens;
-
-  OrtValue sampled_idx_ov;
-  Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(),
-                       sampled_idx_shape,
-                       next_token_idx.data(),
-                       allocator->Info(),
-                       sampled_idx_ov);
-  Tensor* sampled_idx = sampled_idx_ov.GetMutable<Tensor>();
-
-  // Copy the allocator because MultinomialComputeShared() uses move(allocator)
-  AllocatorPtr allocatortemp = allocator;
-  ORT_RETURN_IF_ERROR(MultinomialComputeShared<int32_t>(allocatortemp,
-                                                        input,
-                                                        parameters->batch_size,
-                                                        parameters->vocab_size,
-                                                        1,
-                                                        generator,
-                                                        *sampled_idx));
-  // TODO: update presense_mask()
-#ifdef DEBUG_GENERATION
-  dumper->Print("sampled_idx", *sampled_idx);
+  dumper->Print("sampled_idx", next_tokens.data(), parameters->batch_size, 1);
 #endif
 
   return Status::OK();
@@ -19,6 +19,8 @@ void SamplingParameters::ParseFromAttributes(const OpKernelInfo& info) {
   presence_penalty = info.GetAttrOrDefault<float>("presence_penalty", 0.0f);
   custom_sampling = static_cast<int>(info.GetAttrOrDefault<int64_t>("custom", 0));
   vocab_size = static_cast<int>(info.GetAttrOrDefault<int64_t>("vocab_size", -1));
+  num_speculative_tokens = static_cast<int>(info.GetAttrOrDefault<int64_t>("num_speculative_tokens", 4));
+  ORT_ENFORCE(num_speculative_tokens > 0, "num_speculative_tokens shall be greater than 0, got ", num_speculative_tokens);
 }
 
 void SamplingParameters::ParseFromInputs(OpKernelContext* context) {
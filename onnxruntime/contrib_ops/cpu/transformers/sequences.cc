@@ -86,6 +86,11 @@ void Sequences::AfterDeviceAppendedNextToken() {
   current_sequences_buffer ^= 1;
 }
 
+void Sequences::TruncateSequences(int sequence_length) {
+  ORT_ENFORCE(sequence_length >= 0 && sequence_length <= current_length_);
+  current_length_ = sequence_length;
+}
+
 }  // namespace transformers
 }  // namespace contrib
 }  // namespace onnxruntime
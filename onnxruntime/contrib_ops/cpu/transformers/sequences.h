@@ -40,6 +40,9 @@ class Sequences : public ISequences {
 
   void AfterDeviceAppendedNextToken();
 
+  // Drop the tokens after the given length, like the draft tokens rejected in speculative decoding.
+  void TruncateSequences(int sequence_length);
+
  private:
   // Two buffers of shape (batch_size, num_beams, max_seq_length) to store sequences.
   // At each time, there is only one buffer is active. The other one will be active in next token.
@@ -5,6 +5,8 @@
 
 #include "core/common/common.h"
 
+#include <cstring>
+
 namespace onnxruntime {
 namespace utf8_util {
 
@@ -31,6 +33,28 @@ inline bool utf8_bytes(unsigned char ch, size_t& len) {
   return false;
 }
 
+// Returns the number of leading ASCII bytes in the string.
+// Checks 8 bytes at a time: most of the text processed by the string operators is ASCII.
+inline size_t utf8_ascii_prefix(const unsigned char* s, size_t len) {
+  constexpr uint64_t high_bits = 0x8080808080808080ULL;
+  size_t idx = 0;
+  for (; idx + sizeof(uint64_t) <= len; idx += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, s + idx, sizeof(word));
+    if ((word & high_bits) != 0) {
+      break;
+    }
+  }
+  while (idx < len && s[idx] < 0x80u) {
+    ++idx;
+  }
+  return idx;
+}
+
+inline bool utf8_is_ascii(const unsigned char* s, size_t len) {
+  return utf8_ascii_prefix(s, len) == len;
+}
+
 // Computes length of the utf8 string in characters
 inline bool utf8_len(const unsigned char* s, size_t bytes, size_t& len) {
   size_t result = 0;
@@ -52,6 +76,13 @@ inline bool utf8_validate(const unsigned char* s, size_t len, size_t& utf8_chars
   size_t utf8_len = 0;
   size_t idx = 0;
   while (idx < len) {
+    // ASCII runs are valid characters of one byte
+    const size_t ascii = utf8_ascii_prefix(s + idx, len - idx);
+    idx += ascii;
+    utf8_len += ascii;
+    if (idx == len) {
+      break;
+    }
     size_t bytes = 0;
     auto ch = s[idx];
     if (utf8_bytes(ch, bytes)) {
@@ -848,6 +848,252 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
           MultiHeadAttentionTypeAndShapeInference(ctx, 5, is_dmmha_packing);
         }));
 
+constexpr const char* PagedAttention_ver1_doc = R"DOC(
+Multi-head self attention of a batch of sequences whose key and value cache lives in fixed size pages.
+
+The cache of all the sequences is one pool of num_pages pages, each holding the key (or value) of page_size tokens
+of every head. The page_table lists the pages of each sequence in order: token t of sequence b is in slot
+t % page_size of page page_table[b, t / page_size]. Pages do not have to be contiguous or ordered, so sequences
+can join and leave the batch between decoding steps and only own the pages they fill.
+
+The query, key and value contain the new tokens of all the sequences packed without padding: sequence b owns rows
+cumulative_sequence_length[b] to cumulative_sequence_length[b + 1] - 1, e.g., the whole prompt when the sequence
+joins and one token per decoding step after that. The key and value of the new tokens are written to the cache at
+positions past_sequence_lengths[b] onwards, then each new token attends causally to all the tokens of its sequence.
+The pages that hold those positions must be in the page table. key_cache_out and value_cache_out can share the
+buffers of key_cache and value_cache.
+)DOC";
+
+// Shape inference for PagedAttention. Here are the shapes of inputs and output:
+// Input 'query':                        (token_count, hidden_size)
+// Input 'key':                          (token_count, hidden_size)
+// Input 'value':                        (token_count, hidden_size)
+// Input 'key_cache':                    (num_pages, num_heads, page_size, head_size)
+// Input 'value_cache':                  (num_pages, num_heads, page_size, head_size)
+// Input 'page_table':                   (batch_size, max_pages_per_sequence)
+// Input 'past_sequence_lengths':        (batch_size)
+// Input 'cumulative_sequence_length':   (batch_size + 1)
+// Output 'output':                      (token_count, hidden_size)
+// Output 'key_cache_out':               (num_pages, num_heads, page_size, head_size)
+// Output 'value_cache_out':             (num_pages, num_heads, page_size, head_size)
+ONNX_MS_OPERATOR_SET_SCHEMA(
+    PagedAttention, 1,
+    OpSchema()
+        .SetDoc(PagedAttention_ver1_doc)
+        .Attr("num_heads", "Number of attention heads", AttributeProto::INT)
+        .Attr("scale",
+              "Custom scale will be used if specified. Default value is 1/sqrt(head_size)",
+              AttributeProto::FLOAT,
+              OPTIONAL_VALUE)
+        .Input(0,
+               "query",
+               "Query of the new tokens with shape (token_count, hidden_size)",
+               "T")
+        .Input(1,
+               "key",
+               "Key of the new tokens with shape (token_count, hidden_size)",
+               "T")
+        .Input(2,
+               "value",
+               "Value of the new tokens with shape (token_count, hidden_size)",
+               "T")
+        .Input(3,
+               "key_cache",
+               "Pool of key pages with shape (num_pages, num_heads, page_size, head_size)",
+               "T")
+        .Input(4,
+               "value_cache",
+               "Pool of value pages with shape (num_pages, num_heads, page_size, head_size)",
+               "T")
+        .Input(5,
+               "page_table",
+               "Pages of each sequence in order with shape (batch_size, max_pages_per_sequence). "
+               "Entries past the last page of a sequence are not used.",
+               "M")
+        .Input(6,
+               "past_sequence_lengths",
+               "Number of tokens of each sequence already in the cache, with shape (batch_size)",
+               "M")
+        .Input(7,
+               "cumulative_sequence_length",
+               "A tensor with shape (batch_size + 1). It specifies the cumulative number of new tokens.",
+               "M")
+        .Output(0,
+                "output",
+                "output tensor with shape (token_count, hidden_size)",
+                "T")
+        .Output(1,
+                "key_cache_out",
+                "Pool of key pages with the key of the new tokens, with shape "
+                "(num_pages, num_heads, page_size, head_size)",
+                "T")
+        .Output(2,
+                "value_cache_out",
+                "Pool of value pages with the value of the new tokens, with shape "
+                "(num_pages, num_heads, page_size, head_size)",
+                "T")
+        .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output to float tensors.")
+        .TypeConstraint("M", {"tensor(int32)"}, "Constrain page table and sequence lengths to integer types")
+        .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+          ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 0);
+          ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 3, 1);
+          ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 4, 2);
+          if (hasInputShape(ctx, 0)) {
+            propagateShapeFromInputToOutput(ctx, 0, 0);
+          }
+          if (hasInputShape(ctx, 3)) {
+            propagateShapeFromInputToOutput(ctx, 3, 1);
+          }
+          if (hasInputShape(ctx, 4)) {
+            propagateShapeFromInputToOutput(ctx, 4, 2);
+          }
+        }));
+
+constexpr const char* GroupQueryAttention_ver1_doc = R"DOC(
+Causal self attention where each group of num_heads / kv_num_heads query heads shares one head of key and value,
+as in grouped-query attention (multi-query attention when kv_num_heads is 1). The query heads read their shared key
+and value head directly, so key and value are not repeated to num_heads heads.
+
+The key and value of the new tokens of sequence b are appended to the past at position seqlens_k[b], and each new
+token attends to all the tokens of its sequence up to its own position. Sequences of a batch can have different
+past lengths, with the past of each sequence at the start of its buffer.
+
+present_key and present_value hold max(past_sequence_length, total_sequence_length) tokens. When past_key and
+past_value are allocated for the longest sequence, present_key and present_value share their buffers and only the
+new tokens are written.
+)DOC";
+
+// Shape inference for GroupQueryAttention. Here are the shapes of inputs and output:
+// Input 'query':                    (batch_size, sequence_length, num_heads * head_size)
+// Input 'key':                      (batch_size, sequence_length, kv_num_heads * head_size)
+// Input 'value':                    (batch_size, sequence_length, kv_num_heads * head_size)
+// Input 'past_key':                 (batch_size, kv_num_heads, past_sequence_length, head_size)
+// Input 'past_value':               (batch_size, kv_num_heads, past_sequence_length, head_size)
+// Input 'seqlens_k':                (batch_size)
+// Input 'total_sequence_length':    (1)
+// Output 'output':                  (batch_size, sequence_length, num_heads * head_size)
+// Output 'present_key':             (batch_size, kv_num_heads, present_sequence_length, head_size)
+// Output 'present_value':           (batch_size, kv_num_heads, present_sequence_length, head_size)
+ONNX_MS_OPERATOR_SET_SCHEMA(
+    GroupQueryAttention, 1,
+    OpSchema()
+        .SetDoc(GroupQueryAttention_ver1_doc)
+        .Attr("num_heads", "Number of attention heads for query", AttributeProto::INT)
+        .Attr("kv_num_heads", "Number of attention heads for key and value", AttributeProto::INT)
+        .Attr("scale",
+              "Custom scale will be used if specified. Default value is 1/sqrt(head_size)",
+              AttributeProto::FLOAT,
+              OPTIONAL_VALUE)
+        .Input(0,
+               "query",
+               "Query with shape (batch_size, sequence_length, num_heads * head_size)",
+               "T")
+        .Input(1,
+               "key",
+               "Key with shape (batch_size, sequence_length, kv_num_heads * head_size)",
+               "T")
+        .Input(2,
+               "value",
+               "Value with shape (batch_size, sequence_length, kv_num_heads * head_size)",
+               "T")
+        .Input(3,
+               "past_key",
+               "Past key with shape (batch_size, kv_num_heads, past_sequence_length, head_size)",
+               "T",
+               OpSchema::Optional)
+        .Input(4,
+               "past_value",
+               "Past value with shape (batch_size, kv_num_heads, past_sequence_length, head_size)",
+               "T",
+               OpSchema::Optional)
+        .Input(5,
+               "seqlens_k",
+               "Number of tokens of each sequence in the past, with shape (batch_size)",
+               "M")
+        .Input(6,
+               "total_sequence_length",
+               "Scalar tensor of the longest past and new tokens of the sequences",
+               "M")
+        .Output(0,
+                "output",
+                "Output tensor with shape (batch_size, sequence_length, num_heads * head_size)",
+                "T")
+        .Output(1,
+                "present_key",
+                "Past key with the key of the new tokens, with shape "
+                "(batch_size, kv_num_heads, present_sequence_length, head_size)",
+                "T")
+        .Output(2,
+                "present_value",
+                "Past value with the value of the new tokens, with shape "
+                "(batch_size, kv_num_heads, present_sequence_length, head_size)",
+                "T")
+        .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output to float tensors.")
+        .TypeConstraint("M", {"tensor(int32)"}, "Constrain sequence lengths to integer types")
+        .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+          ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 0, 0);
+          ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 1, 1);
+          ONNX_NAMESPACE::propagateElemTypeFromInputToOutput(ctx, 2, 2);
+          if (hasInputShape(ctx, 0)) {
+            propagateShapeFromInputToOutput(ctx, 0, 0);
+          }
+
+          // The length of present depends on the value of total_sequence_length, only the rank is known.
+          if (hasInputShape(ctx, 3)) {
+            auto& past_shape = getInputShape(ctx, 3);
+            if (past_shape.dim_size() != 4) {
+              fail_shape_inference("The past_key input shall be 4 dimensions");
+            }
+            ONNX_NAMESPACE::TensorShapeProto present_shape;
+            *present_shape.add_dim() = past_shape.dim(0);
+            *present_shape.add_dim() = past_shape.dim(1);
+            present_shape.add_dim();
+            *present_shape.add_dim() = past_shape.dim(3);
+            updateOutputShape(ctx, 1, present_shape);
+            updateOutputShape(ctx, 2, present_shape);
+          }
+        }));
+
+constexpr const char* RotaryEmbedding_ver1_doc = R"DOC(
+Rotary position embedding of GPT-NeoX and LLaMA style models. Each pair (x1, x2) of elements of a head at position
+p becomes (x1 * cos - x2 * sin, x2 * cos + x1 * sin), where cos and sin are read from row p of the cos_cache and
+sin_cache tables. The pairs are the two halves of the head, or adjacent elements when interleaved is 1.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(
+    RotaryEmbedding, 1,
+    OpSchema()
+        .SetDoc(RotaryEmbedding_ver1_doc)
+        .Attr("interleaved",
+              "Rotate adjacent pairs of elements (1) instead of the two halves of each head (0). Default value is 0.",
+              AttributeProto::INT,
+              OPTIONAL_VALUE)
+        .Input(0,
+               "input",
+               "3D tensor with shape (batch_size, sequence_length, num_heads * head_size) or "
+               "4D tensor with shape (batch_size, num_heads, sequence_length, head_size)",
+               "T")
+        .Input(1,
+               "position_ids",
+               "2D tensor with shape (batch_size, sequence_length), or 1D tensor with shape (1) holding the position "
+               "of the first token of every sequence",
+               "M")
+        .Input(2,
+               "cos_cache",
+               "Cosine of each position and rotation angle, with shape (max_sequence_length, head_size / 2)",
+               "T")
+        .Input(3,
+               "sin_cache",
+               "Sine of each position and rotation angle, with shape (max_sequence_length, head_size / 2)",
+               "T")
+        .Output(0,
+                "output",
+                "Tensor with the same shape as input",
+                "T")
+        .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output to float tensors.")
+        .TypeConstraint("M", {"tensor(int64)"}, "Constrain position ids to integer types")
+        .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput));
+
 constexpr const char* MultiHeadAttention_ver1_doc = R"DOC(
 Multi-Head Self/Cross Attention. Bias from input projection is included.
 
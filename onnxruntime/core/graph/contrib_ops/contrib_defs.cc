@@ -1062,7 +1062,11 @@ ONNX_MS_OPERATOR_SET_SCHEMA(GridSample, 1,
 
 ONNX_MS_OPERATOR_SET_SCHEMA(BeamSearch, 1,
                             OpSchema()
-                                .SetDoc("Beam Search for text generation. Supports GPT-2 decoder.")
+                                .SetDoc("Beam Search for text generation. Supports GPT-2 decoder. "
+                                        "On CPU, T5 and Whisper decoders that share the past and present buffers and take a "
+                                        "cache_indirection input read the past state of the selected beams through the cache "
+                                        "indirection. The GPT-2 decoder has no such path on CPU, and its past state is copied "
+                                        "for the selected beams after every step.")
                                 .Attr("eos_token_id", "The id of the end-of-sequence token", AttributeProto::INT)
                                 .Attr("pad_token_id", "The id of the padding token", AttributeProto::INT)
                                 .Attr("decoder_start_token_id", "The id of the token that indicates decoding starts.", AttributeProto::INT, static_cast<int64_t>(-1))
@@ -1075,6 +1079,12 @@ ONNX_MS_OPERATOR_SET_SCHEMA(BeamSearch, 1,
                                       "This is relevant only for the GPT2 model. If this attribute is missing, the `decoder` subgraph will be used for all decoding runs",
                                       AttributeProto::GRAPH, OPTIONAL_VALUE)
                                 .Attr("decoder", "Decoder subgraph to execute in a loop.", AttributeProto::GRAPH)
+                                .Attr("prompt_cache_size",
+                                      "Maximum size in bytes of the past state of prompt prefixes cached across runs, so that prompts starting with the same tokens "
+                                      "only run the decoder on the tokens after the cached prefix. 0 disables the cache. "
+                                      "This is relevant only for the GPT2 model without `init_decoder` and without past and present sharing a buffer, "
+                                      "and only supported on CPU. Prompts with padding are not cached.",
+                                      AttributeProto::INT, static_cast<int64_t>(0))
                                 .Attr("vocab_size",
                                       "Size of the vocabulary. "
                                       "If not provided, it will be inferred from the decoder subgraph's output shape",
@@ -1124,6 +1134,20 @@ ONNX_MS_OPERATOR_SET_SCHEMA(GreedySearch, 1,
                                       "This is relevant only for the GPT2 model. If this attribute is missing, the `decoder` subgraph will be used for all decoding runs",
                                       AttributeProto::GRAPH, OPTIONAL_VALUE)
                                 .Attr("decoder", "Decoder subgraph to execute in a loop.", AttributeProto::GRAPH)
+                                .Attr("draft_decoder",
+                                      "Decoder subgraph of a smaller draft model with the same inputs and outputs as `decoder`, used for speculative decoding. "
+                                      "It proposes `num_speculative_tokens` tokens, which `decoder` verifies in one run. "
+                                      "This is relevant only for the GPT2 model without past and present sharing a buffer, and only supported on CPU.",
+                                      AttributeProto::GRAPH, OPTIONAL_VALUE)
+                                .Attr("num_speculative_tokens",
+                                      "Number of tokens proposed by `draft_decoder` before each run of `decoder`. It is ignored when `draft_decoder` is missing",
+                                      AttributeProto::INT, static_cast<int64_t>(4))
+                                .Attr("prompt_cache_size",
+                                      "Maximum size in bytes of the past state of prompt prefixes cached across runs, so that prompts starting with the same tokens "
+                                      "only run the decoder on the tokens after the cached prefix. 0 disables the cache. "
+                                      "This is relevant only for the GPT2 model without `init_decoder` or `draft_decoder` and without past and present sharing a buffer, "
+                                      "and only supported on CPU. Prompts with padding are not cached.",
+                                      AttributeProto::INT, static_cast<int64_t>(0))
                                 .Attr("vocab_size",
                                       "Size of the vocabulary. "
                                       "If not provided, it will be inferred from the decoder subgraph's output shape",
@@ -1165,6 +1189,20 @@ ONNX_MS_OPERATOR_SET_SCHEMA(Sampling, 1,
                                       "This is relevant only for the GPT2 model. If this attribute is missing, the `decoder` subgraph will be used for all decoding runs",
                                       AttributeProto::GRAPH, OPTIONAL_VALUE)
                                 .Attr("decoder", "Decoder subgraph to execute in a loop.", AttributeProto::GRAPH)
+                                .Attr("draft_decoder",
+                                      "Decoder subgraph of a smaller draft model with the same inputs and outputs as `decoder`, used for speculative decoding. "
+                                      "It proposes `num_speculative_tokens` tokens, which `decoder` verifies in one run. "
+                                      "This is relevant only for the GPT2 model without past and present sharing a buffer, and only supported on CPU.",
+                                      AttributeProto::GRAPH, OPTIONAL_VALUE)
+                                .Attr("num_speculative_tokens",
+                                      "Number of tokens proposed by `draft_decoder` before each run of `decoder`. It is ignored when `draft_decoder` is missing",
+                                      AttributeProto::INT, static_cast<int64_t>(4))
+                                .Attr("prompt_cache_size",
+                                      "Maximum size in bytes of the past state of prompt prefixes cached across runs, so that prompts starting with the same tokens "
+                                      "only run the decoder on the tokens after the cached prefix. 0 disables the cache. "
+                                      "This is relevant only for the GPT2 model without `init_decoder` or `draft_decoder` and without past and present sharing a buffer, "
+                                      "and only supported on CPU. Prompts with padding are not cached.",
+                                      AttributeProto::INT, static_cast<int64_t>(0))
                                 .Attr("vocab_size",
                                       "Size of the vocabulary. "
                                       "If not provided, it will be inferred from the decoder subgraph's output shape",
@@ -1820,6 +1858,67 @@ no offset
                                 }));
 #endif
 
+constexpr const char* MatMulNBits_ver1_doc = R"DOC(
+MatMulNBits is a MatMul with weight quantized with N bits (e.g., 4 or 8). It does Matrix Multiplication like MatMul
+(https://github.com/onnx/onnx/blob/main/docs/Operators.md#matmul) with the differences:
+  1. Input B is a 2D constant Matrix. Its input feature count and output feature count are specified by attribute 'K'
+     and 'N'.
+  2. Input B is quantized with x bits which is specified by attribute 'bits'. It is quantized blockwise along
+     dimension K, with a block size specified by attribute 'block_size'. The block size is a power of 2 in [16, 256].
+  3. Input B's scale and zero point are specified by input scales and zero_points.
+
+Input B is stored as uint8_t with shape: [N][n_blocks_per_col][blob_size] in which:
+  - n_blocks_per_col = (K + block_size - 1) / block_size
+  - blob_size = block_size / 8 * bits
+  For 4 bits, element 2i of a block is in the low 4 bits of byte i of the blob, and element 2i+1 in the high 4 bits.
+  The last block of a column is padded to the block size.
+
+Input scales is stored in float with shape [N * n_blocks_per_col].
+Input zero_points is optional, stored as uint8_t with shape [N * ((n_blocks_per_col * bits + 7) / 8)]. The zero points
+of the blocks of a column are packed in bits, the first block in the low bits, and every column starts at a new byte.
+Without zero_points, the zero point is 2^(bits - 1), e.g. 8 for 4 bits.
+
+Attribute 'accuracy_level' is the lowest accuracy of input A allowed for the computation: 0 (unset) and 1 compute in
+float, 4 allows input A to be quantized dynamically to int8 per block.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(
+    MatMulNBits, 1,
+    OpSchema()
+        .SetDoc(MatMulNBits_ver1_doc)
+        .Attr("K", "size of each input feature", AttributeProto::INT)
+        .Attr("N", "size of each output feature", AttributeProto::INT)
+        .Attr("bits", "number of bits used for weight quantization, 4 or 8", AttributeProto::INT)
+        .Attr("block_size", "size of the blocks along K, a power of 2 in [16, 256]", AttributeProto::INT)
+        .Attr("accuracy_level",
+              "The lowest accuracy of input A allowed for the computation: 0 (unset), 1 (fp32) or 4 (int8).",
+              AttributeProto::INT, static_cast<int64_t>(0))
+        .Input(0, "A", "The input tensor, not quantized", "T1")
+        .Input(1, "B", "Packed uint8 constant of shape [N, n_blocks_per_col, blob_size]", "T2")
+        .Input(2, "scales", "quantization scale", "T1")
+        .Input(3, "zero_points", "quantization zero points", "T2", OpSchema::Optional)
+        .Output(0, "Y", "tensor. The output tensor has the same rank as the input. ", "T1")
+        .TypeConstraint("T1", {"tensor(float)"}, "Constrain input and output types to float tensors.")
+        .TypeConstraint("T2", {"tensor(uint8)"}, "Constrain quantized weight types to uint8.")
+        .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+          propagateElemTypeFromInputToOutput(ctx, 0, 0);
+          if (!hasInputShape(ctx, 0)) {
+            return;
+          }
+
+          // The last dimension of A is replaced by N.
+          const auto& a_shape = getInputShape(ctx, 0);
+          if (a_shape.dim_size() == 0) {
+            fail_shape_inference("Input A of MatMulNBits shall have rank of at least 1.");
+          }
+          ONNX_NAMESPACE::TensorShapeProto y_shape;
+          for (int i = 0; i < a_shape.dim_size() - 1; i++) {
+            *y_shape.add_dim() = a_shape.dim(i);
+          }
+          y_shape.add_dim()->set_dim_value(getAttribute(ctx, "N", 0));
+          updateOutputShape(ctx, 0, y_shape);
+        }));
+
 constexpr const char* TransposeMatMul_doc = R"DOC(
 Duplicate of FusedMatMul. Going forward FusedMatMul should be used. This OP will be supported for backward compatibility.
 Matrix product that behaves like numpy.matmul: https://docs.scipy.org/doc/numpy-1.13.0/reference/generated/numpy.matmul.html
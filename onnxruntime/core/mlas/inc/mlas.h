@@ -115,6 +115,7 @@ namespace onnxruntime {
         class ThreadPool;
     };
     struct MLFloat16;
+    struct BFloat16;
 };  // namespace onnxruntime
 
 using MLAS_THREADPOOL = onnxruntime::concurrency::ThreadPool;
@@ -751,6 +752,7 @@ enum MLAS_CONV_ALGORITHM {
     MlasConvAlgorithmGemmDirect,
     MlasConvAlgorithmExpandThenGemm,
     MlasConvAlgorithmExpandThenGemmSegmented,
+    MlasConvAlgorithmWinograd,
 #if defined(MLAS_TARGET_WASM_SCALAR)
     MlasConvAlgorithmDepthwise,
 #endif
@@ -783,6 +785,11 @@ struct MLAS_CONV_PARAMETERS {
         struct {
             size_t ThreadStrideN;
         } ExpandThenGemmSegmented;
+        struct {
+            const void* PackedFilter;
+            size_t TileRowsPerBlock;
+            size_t BlockCount;
+        } Winograd;
     } u;
 };
 
@@ -802,7 +809,8 @@ MlasConvPrepare(MLAS_CONV_PARAMETERS* Parameters,
                 const MLAS_ACTIVATION* Activation,
                 size_t* WorkingBufferSize,
                 float Beta,
-                MLAS_THREADPOOL* ThreadPool);
+                MLAS_THREADPOOL* ThreadPool,
+                const void* WinogradPackedFilter = nullptr);
 
 void
 MLASCALL
@@ -816,6 +824,149 @@ MlasConv(
     MLAS_THREADPOOL* ThreadPool
     );
 
+/**
+ * @brief Returns the size in bytes of the buffer needed to hold the
+ *        Winograd F(4x4,3x3) transformed filter for a 3x3 convolution.
+ *
+ * @param GroupCount     Number of channel groups
+ * @param InputChannels  Number of input channels per group
+ * @param FilterCount    Number of output channels per group
+ * @return  size of the packing buffer in bytes
+*/
+size_t
+MLASCALL
+MlasConvWinogradPackFilterSize(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount
+    );
+
+/**
+ * @brief Transforms a 3x3 OIHW filter to the Winograd F(4x4,3x3) domain and
+ *        packs the result for use by MlasConv. The packed buffer is passed to
+ *        MlasConvPrepare, which then selects MlasConvAlgorithmWinograd for
+ *        eligible convolutions.
+ *
+ *        The Winograd algorithm trades a small amount of numerical accuracy
+ *        for fewer multiplies, so callers opt in by supplying this buffer.
+ *
+ * @param GroupCount     Number of channel groups
+ * @param InputChannels  Number of input channels per group
+ * @param FilterCount    Number of output channels per group
+ * @param Filter         Address of the filter tensor
+ * @param PackedFilter   Address of the packed buffer, sized by
+ *                       MlasConvWinogradPackFilterSize
+*/
+void
+MLASCALL
+MlasConvWinogradPackFilter(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const float* Filter,
+    void* PackedFilter
+    );
+
+//
+// Transposed convolution routines.
+//
+
+struct MLAS_CONV_TRANSPOSE_PARAMETERS {
+    size_t BatchCount;
+    size_t GroupCount;
+    size_t InputChannels;
+    size_t FilterCount;
+    size_t InputShape[2];
+    size_t KernelShape[2];
+    size_t DilationShape[2];
+    size_t Padding[4];
+    size_t StrideShape[2];
+    size_t OutputShape[2];
+    size_t InputSize;
+    size_t OutputSize;
+    size_t TileSize;
+    size_t TilesPerPhase;
+    size_t WorkingBufferSizePerThread;
+    ptrdiff_t ThreadCount;
+};
+
+/**
+ * @brief Returns the size in bytes of the buffer needed to hold a packed
+ *        two dimensional transposed convolution filter.
+ *
+ * @param GroupCount     Number of channel groups
+ * @param InputChannels  Number of input channels per group
+ * @param FilterCount    Number of output channels per group
+ * @param KernelShape    Two dimensional kernel shape
+ * @return  size of the packing buffer in bytes
+*/
+size_t
+MLASCALL
+MlasConvTransposePackFilterSize(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const int64_t* KernelShape
+    );
+
+/**
+ * @brief Packs a two dimensional transposed convolution filter, with layout
+ *        [GroupCount * InputChannels][FilterCount][KernelHeight][KernelWidth],
+ *        into one matrix per stride phase for use by MlasConvTranspose.
+ *
+ * @param GroupCount     Number of channel groups
+ * @param InputChannels  Number of input channels per group
+ * @param FilterCount    Number of output channels per group
+ * @param KernelShape    Two dimensional kernel shape
+ * @param DilationShape  Two dimensional dilation shape
+ * @param StrideShape    Two dimensional stride shape
+ * @param Filter         Address of the filter tensor
+ * @param PackedFilter   Address of the packed buffer, sized by
+ *                       MlasConvTransposePackFilterSize
+*/
+void
+MLASCALL
+MlasConvTransposePackFilter(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* StrideShape,
+    const float* Filter,
+    float* PackedFilter
+    );
+
+void
+MLASCALL
+MlasConvTransposePrepare(
+    MLAS_CONV_TRANSPOSE_PARAMETERS* Parameters,
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t FilterCount,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MLASCALL
+MlasConvTranspose(
+    const MLAS_CONV_TRANSPOSE_PARAMETERS* Parameters,
+    const float* Input,
+    const float* PackedFilter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 void
 MLASCALL
 MlasConvDepthwise(
@@ -831,6 +982,30 @@ MlasConvDepthwise(
     size_t KernelSize
     );
 
+/**
+ * @brief Indirect Depthwise convolution for fp32 NHWC
+ * @param Input         Supplies the indirect buffer for NHWC input, padding
+ *                      entries must point to a vector of zeros
+ * @param Filter        Supplies the filter tensor in HWC format
+ * @param Bias          Optionally supplies the bias vector
+ * @param Output        Supplies the address for the result tensor
+ * @param Channels      # of input channels
+ * @param OutputCount   # of output pixels
+ * @param KernelSize    # kernel size
+ * @return
+*/
+void
+MLASCALL
+MlasConvDepthwise(
+    const float* const* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t Channels,
+    size_t OutputCount,
+    size_t KernelSize
+    );
+
 //
 // Symmetric quantized integer convolution routines.
 //
@@ -974,6 +1149,47 @@ MlasMaximumPool(
     size_t KernelSize
     );
 
+/**
+ * @brief Max Pooling for fp32 NHWC
+ * @param Input         Indirect buffer to activations, nullptr entries are
+ *                      excluded from the pooling window
+ * @param Output        Address of the result tensor
+ * @param Channels      C in NHWC
+ * @param OutputCount   Number of output pixels
+ * @param KernelSize    Size of the kernel
+ * @return
+*/
+void
+MLASCALL
+MlasNhwcMaxPool(
+    const float* const* Input,
+    float* Output,
+    size_t Channels,
+    size_t OutputCount,
+    size_t KernelSize
+    );
+
+/**
+ * @brief Avg Pooling for fp32 NHWC
+ * @param Input         Indirect buffer to activations, nullptr entries are
+ *                      excluded from the average and entries pointing to
+ *                      zeros are included
+ * @param Output        Address of the output data
+ * @param Channels      C in NHWC
+ * @param OutputCount   Number of output pixels
+ * @param KernelSize    size of the kernel
+ * @return
+*/
+void
+MLASCALL
+MlasNhwcAvgPool(
+    const float* const* Input,
+    float* Output,
+    size_t Channels,
+    size_t OutputCount,
+    size_t KernelSize
+    );
+
 //
 // Miscellaneous compute routines.
 //
@@ -1013,6 +1229,60 @@ MlasComputeSoftmax(
     MLAS_THREADPOOL* ThreadPool
     );
 
+/**
+ * @brief Describes an additive input of the fused softmax. The values added
+ *        to query row s of head h of batch b start at
+ *        Data + b * BatchStride + h * HeadStride + s * RowStride. A zero
+ *        stride broadcasts the input along that dimension.
+ */
+struct MLAS_SOFTMAX_ADDEND {
+    const float* Data = nullptr; /**< Supplies the values, else nullptr if unused */
+    size_t BatchStride = 0;      /**< Supplies the element stride between batches */
+    size_t HeadStride = 0;       /**< Supplies the element stride between heads */
+    size_t RowStride = 0;        /**< Supplies the element stride between query rows */
+};
+
+/**
+ * @brief Parameters of the fused attention softmax over scores of shape
+ *        BatchCount x HeadCount x SequenceLength x TotalSequenceLength.
+ */
+struct MLAS_FUSED_SOFTMAX_PARAMS {
+    size_t BatchCount = 1;          /**< Supplies the batch count (B) */
+    size_t HeadCount = 1;           /**< Supplies the head count (N) */
+    size_t SequenceLength = 0;      /**< Supplies the query rows per head (S) */
+    size_t TotalSequenceLength = 0; /**< Supplies the columns per query row (T) */
+    float Scale = 1.0f;             /**< Supplies the multiplier applied to the scores */
+    MLAS_SOFTMAX_ADDEND Mask;       /**< Supplies the additive attention mask */
+    MLAS_SOFTMAX_ADDEND Bias;       /**< Supplies the additive attention bias */
+    bool Causal = false;            /**< Supplies true to mask columns after PastSequenceLength + s */
+    size_t PastSequenceLength = 0;  /**< Supplies the past sequence length for the causal mask */
+};
+
+/**
+ * @brief Computes Softmax(Scale * Input + Mask + Bias) over the rows of the
+ *        attention scores in a single pass over memory. With a causal mask,
+ *        query row s only attends to the first PastSequenceLength + s + 1
+ *        columns and the remaining outputs of the row are zero.
+ *
+ *        N.B. A single precision output may alias the input.
+ *
+ * @tparam T          Output type, float or MLAS_FP16
+ * @param Input       Supplies the scores, B x N x S x T
+ * @param Output      Supplies the probabilities, B x N x S x T
+ * @param Params      Supplies the shape, scale and masking parameters
+ * @param ThreadPool  Supplies the thread pool object to use, else nullptr
+ *                    if the base library threading support should be used.
+ */
+template<typename T>
+void
+MLASCALL
+MlasComputeFusedSoftmax(
+    const float* Input,
+    T* Output,
+    const MLAS_FUSED_SOFTMAX_PARAMS& Params,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 void
 MLASCALL
 MlasComputeTanh(
@@ -1083,6 +1353,37 @@ MlasTranspose(
     size_t N
     );
 
+#define MLAS_TRANSPOSE_MAXIMUM_RANK 8
+
+/**
+ * @brief Transposes an N-D tensor: output axis k corresponds to input axis
+ *        Permutation[k].
+ *
+ *        Unit dimensions are dropped and axes that stay adjacent are merged
+ *        before the remaining axes are transposed in cache tiles.
+ *
+ * @param Input         Supplies the input tensor.
+ * @param Output        Supplies the output tensor.
+ * @param ElementSize   Supplies the element size in bytes: 1, 2, 4 or 8.
+ * @param Rank          Supplies the rank of the input tensor, at most
+ *                      MLAS_TRANSPOSE_MAXIMUM_RANK.
+ * @param InputShape    Supplies the shape of the input tensor.
+ * @param Permutation   Supplies the input axis for each output axis.
+ * @param ThreadPool    Supplies the thread pool object to use, else nullptr
+ *                      if the base library threading support should be used.
+ */
+void
+MLASCALL
+MlasTransposeNd(
+    const void* Input,
+    void* Output,
+    size_t ElementSize,
+    size_t Rank,
+    const size_t* InputShape,
+    const size_t* Permutation,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 //
 // Buffer reordering routines.
 //
@@ -1394,6 +1695,281 @@ MlasQLinearMul(
     bool IsScalarB
     );
 
+//
+// Broadcast element-wise routines.
+//
+
+enum MLAS_ELTWISE_BINARY_KIND {
+    MlasEltwiseAdd,
+    MlasEltwiseSub,
+    MlasEltwiseMul,
+    MlasEltwiseDiv,
+    MlasEltwiseMin,
+    MlasEltwiseMax,
+    MlasEltwisePow,
+};
+
+#define MLAS_ELTWISE_MAXIMUM_RANK 8
+
+/**
+ * @brief Computes C = op(A, B) for tensors with N-D broadcasting.
+ *
+ *        The shapes are collapsed into the smallest number of dimensions
+ *        before iterating, so broadcasts on inner dimensions run as stride-0
+ *        inner loops instead of short independent spans. The work is split
+ *        across the thread pool based on the number of output elements.
+ *
+ *        Supported types are float, MLAS_FP16, int32_t and int64_t. MLAS_FP16
+ *        values are computed in single precision. MlasEltwisePow is only
+ *        supported for float and MLAS_FP16.
+ *
+ * @param Kind          Supplies the binary operation.
+ * @param Rank          Supplies the rank of the output tensor, at most
+ *                      MLAS_ELTWISE_MAXIMUM_RANK.
+ * @param OutputShape   Supplies the shape of the output tensor.
+ * @param A             Supplies the address of the first input tensor.
+ * @param StridesA      Supplies the element strides of the first input for
+ *                      each output dimension, zero for broadcast dimensions.
+ * @param B             Supplies the address of the second input tensor.
+ * @param StridesB      Supplies the element strides of the second input for
+ *                      each output dimension, zero for broadcast dimensions.
+ * @param C             Supplies the address of the contiguous output tensor.
+ * @param ThreadPool    Supplies the thread pool object to use, else nullptr if
+ *                      the base library threading support should be used.
+ */
+template<typename T>
+void
+MLASCALL
+MlasEltwiseBinary(
+    MLAS_ELTWISE_BINARY_KIND Kind,
+    size_t Rank,
+    const size_t* OutputShape,
+    const T* A,
+    const size_t* StridesA,
+    const T* B,
+    const size_t* StridesB,
+    T* C,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+/**
+ * @brief Computes C = Condition ? A : B for tensors with N-D broadcasting.
+ *
+ *        The shapes are collapsed and partitioned like MlasEltwiseBinary.
+ *
+ *        Supported types are float, int32_t and int64_t.
+ *
+ * @param Rank              Supplies the rank of the output tensor, at most
+ *                          MLAS_ELTWISE_MAXIMUM_RANK.
+ * @param OutputShape       Supplies the shape of the output tensor.
+ * @param Condition         Supplies the address of the condition tensor.
+ * @param StridesCondition  Supplies the element strides of the condition for
+ *                          each output dimension, zero for broadcast dimensions.
+ * @param A                 Supplies the address of the tensor selected where
+ *                          the condition is true.
+ * @param StridesA          Supplies the element strides of A for each output
+ *                          dimension, zero for broadcast dimensions.
+ * @param B                 Supplies the address of the tensor selected where
+ *                          the condition is false.
+ * @param StridesB          Supplies the element strides of B for each output
+ *                          dimension, zero for broadcast dimensions.
+ * @param C                 Supplies the address of the contiguous output tensor.
+ * @param ThreadPool        Supplies the thread pool object to use, else nullptr if
+ *                          the base library threading support should be used.
+ */
+template<typename T>
+void
+MLASCALL
+MlasEltwiseSelect(
+    size_t Rank,
+    const size_t* OutputShape,
+    const bool* Condition,
+    const size_t* StridesCondition,
+    const T* A,
+    const size_t* StridesA,
+    const T* B,
+    const size_t* StridesB,
+    T* C,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// Layer normalization routines.
+//
+
+/**
+ * @brief Normalizes a row of N elements, optionally fused with the residual
+ *        add of SkipLayerNormalization:
+ *
+ *            X = Input + Skip + Bias
+ *            Output = (X - Mean(X)) / sqrt(Var(X) + Epsilon) * Gamma + Beta
+ *
+ *        The simplified (RMS) variant does not subtract the mean and uses
+ *        the mean of the squares as the variance.
+ *
+ *        Supported types are float and MLAS_FP16. MLAS_FP16 rows are
+ *        computed in single precision.
+ *
+ * @param Input         Supplies the input row.
+ * @param Skip          Optionally supplies the skip (residual) row.
+ * @param Bias          Optionally supplies the bias vector, used only if
+ *                      Skip is supplied.
+ * @param Gamma         Supplies the scale vector.
+ * @param Beta          Optionally supplies the shift vector.
+ * @param Output        Supplies the output row.
+ * @param SkipOutput    Optionally supplies the row that receives
+ *                      Input + Skip + Bias, used only if Skip is supplied.
+ * @param N             Supplies the number of elements of the row.
+ * @param Epsilon       Supplies the value added to the variance.
+ * @param Simplified    Supplies true to compute the RMS normalization.
+ * @param Mean          Optionally receives the mean of the row, zero for
+ *                      the simplified variant.
+ * @param InvStdDev     Optionally receives the inverse standard deviation
+ *                      of the row.
+ */
+template<typename T>
+void
+MLASCALL
+MlasLayerNormalization(
+    const T* Input,
+    const T* Skip,
+    const T* Bias,
+    const T* Gamma,
+    const T* Beta,
+    T* Output,
+    T* SkipOutput,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float* Mean,
+    float* InvStdDev
+    );
+
+//
+// Multi-axis reduction routines.
+//
+
+enum MLAS_REDUCE_KIND {
+    MlasReduceSum,
+    MlasReduceMean,
+    MlasReduceSumSquare,
+    MlasReduceMax,
+    MlasReduceMin,
+};
+
+#define MLAS_REDUCE_MAXIMUM_RANK 8
+
+/**
+ * @brief Reduces a tensor over any set of axes.
+ *
+ *        Unit dimensions are dropped and adjacent dimensions that are both
+ *        reduced or both kept are merged, so any axis pattern runs as either
+ *        contiguous row reductions or contiguous column accumulations. The
+ *        outputs are split across the thread pool, or the reduced positions
+ *        when there are too few outputs.
+ *
+ *        Supported types are float, MLAS_FP16, int32_t and int64_t. MLAS_FP16
+ *        values are accumulated in single precision. An empty reduction
+ *        produces the identity of the operation.
+ *
+ * @param Kind          Supplies the reduction operation.
+ * @param Rank          Supplies the rank of the input tensor, at most
+ *                      MLAS_REDUCE_MAXIMUM_RANK.
+ * @param InputShape    Supplies the shape of the input tensor.
+ * @param ReduceAxes    Supplies a flag per dimension, true if the dimension
+ *                      is reduced.
+ * @param Input         Supplies the address of the input tensor.
+ * @param Output        Supplies the address of the output tensor, holding the
+ *                      kept dimensions in input order.
+ * @param ThreadPool    Supplies the thread pool object to use, else nullptr if
+ *                      the base library threading support should be used.
+ */
+template<typename T>
+void
+MLASCALL
+MlasReduce(
+    MLAS_REDUCE_KIND Kind,
+    size_t Rank,
+    const size_t* InputShape,
+    const bool* ReduceAxes,
+    const T* Input,
+    T* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+/**
+ * @brief Computes the mean and the population variance of a tensor over any
+ *        set of axes with Welford updates, in a single pass over the input.
+ *
+ * @param Rank          Supplies the rank of the input tensor, at most
+ *                      MLAS_REDUCE_MAXIMUM_RANK.
+ * @param InputShape    Supplies the shape of the input tensor.
+ * @param ReduceAxes    Supplies a flag per dimension, true if the dimension
+ *                      is reduced.
+ * @param Input         Supplies the address of the input tensor.
+ * @param Mean          Supplies the address of the mean output tensor.
+ * @param Variance      Supplies the address of the variance output tensor.
+ * @param ThreadPool    Supplies the thread pool object to use, else nullptr if
+ *                      the base library threading support should be used.
+ */
+void
+MLASCALL
+MlasReduceMeanVariance(
+    size_t Rank,
+    const size_t* InputShape,
+    const bool* ReduceAxes,
+    const float* Input,
+    float* Mean,
+    float* Variance,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// Top-K selection routines.
+//
+
+/**
+ * @brief Selects the K largest (or smallest) elements of each contiguous row.
+ *
+ *        Each row is scanned against a running threshold, the K-th best
+ *        value seen so far, and only elements that beat the threshold are
+ *        appended to a candidate buffer that is periodically reduced back to
+ *        K entries. Rows are split across the thread pool; when there are
+ *        fewer rows than threads, long rows are also split into segments
+ *        whose candidates are merged afterwards.
+ *
+ *        Ties are broken by selecting the lower index first. Supported types
+ *        are float, MLAS_FP16 and MLAS_BF16; the selected values are copied
+ *        from the input unchanged.
+ *
+ * @param Input         Supplies the input rows.
+ * @param Rows          Supplies the number of rows.
+ * @param N             Supplies the number of elements in each row.
+ * @param K             Supplies the number of elements to select, at most N.
+ * @param Largest       Supplies true to select the largest elements, else
+ *                      the smallest elements.
+ * @param Sorted        Supplies true to order the selected elements from best
+ *                      to worst, else the order is unspecified.
+ * @param Values        Supplies the Rows x K output values.
+ * @param Indices       Supplies the Rows x K output indices within each row.
+ * @param ThreadPool    Supplies the thread pool object to use, else nullptr if
+ *                      the base library threading support should be used.
+ */
+template<typename T>
+void
+MLASCALL
+MlasTopK(
+    const T* Input,
+    size_t Rows,
+    size_t N,
+    size_t K,
+    bool Largest,
+    bool Sorted,
+    T* Values,
+    int64_t* Indices,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 //
 // Half precision routines
 //
@@ -1401,6 +1977,8 @@ MlasQLinearMul(
 // Any type with size=2 should work
 using MLAS_FP16 = onnxruntime::MLFloat16;
 
+using MLAS_BF16 = onnxruntime::BFloat16;
+
 constexpr size_t FP16_SIZE = sizeof(uint16_t);
 
 /**
@@ -95,6 +95,38 @@ MlasQ4GemmUnPackB(
     );
 
 
+/**
+ * @brief Prepack int4 weight tensor that is already block quantized, with
+ *        its scales and zero points, into the blob of MlasQ4GemmPackB
+ *
+ * @param QType       type of block quantization, the data must be quantized
+ *                    with the same block size
+ * @param PackedBuf   destination buffer, MlasQ4GemmPackBSize(QType, N, K) bytes
+ * @param QuantData   the quantized data, each column is stored as KBlocks
+ *                    blocks padded to the block size, with element 2i in
+ *                    the low 4 bits and element 2i+1 in the high 4 bits of
+ *                    byte i of the block
+ * @param Scales      the scales, KBlocks per column
+ * @param ZeroPoints  the zero points, two blocks per byte with the first one
+ *                    in the low 4 bits, (KBlocks + 1) / 2 bytes per column.
+ *                    Only used by BlkQ4Zp8, nullptr means 8 for all blocks.
+ *                    The symmetric types always use 8.
+ * @param N           the number of columns of matrix B.
+ * @param K           the number of rows of matrix B.
+ */
+void
+MLASCALL
+MlasQ4GemmPackBQuantized(
+    MLAS_BLK_QUANT_TYPE QType,
+    void* PackedBuf,
+    const uint8_t* QuantData,
+    const float* Scales,
+    const uint8_t* ZeroPoints,
+    size_t N,
+    size_t K
+    );
+
+
 template<typename T>
 class MLAS_GEMM_POSTPROCESSOR
 {
@@ -874,6 +874,15 @@ Return Value:
 
     const MLAS_CONV_ALGORITHM Algorithm = Parameters->Algorithm;
 
+    //
+    // The Winograd algorithm schedules all batches and groups itself.
+    //
+
+    if (Algorithm == MlasConvAlgorithmWinograd) {
+        MlasConvWinograd(Parameters, Input, Bias, WorkingBuffer, Output, ThreadPool);
+        return;
+    }
+
     //
     // Schedule batches of GEMMs across multiple threads.
     //
@@ -1002,6 +1011,15 @@ Return Value:
 
                     break;
                 }
+
+                case MlasConvAlgorithmWinograd:
+                {
+                    //
+                    // Handled above across all batches and groups.
+                    //
+
+                    break;
+                }
             }
 
             //
@@ -1041,7 +1059,8 @@ MlasConvPrepare(
     const MLAS_ACTIVATION* Activation,
     size_t* WorkingBufferSize,
     float Beta,
-    MLAS_THREADPOOL* ThreadPool
+    MLAS_THREADPOOL* ThreadPool,
+    const void* WinogradPackedFilter
     )
 /*++
 
@@ -1088,6 +1107,10 @@ Arguments:
     ThreadPool - Supplies the thread pool object to use, else nullptr if the
         base library threading support should be used.
 
+    WinogradPackedFilter - Optionally supplies the filter transformed by
+        MlasConvWinogradPackFilter. If supplied and the convolution is
+        eligible, the Winograd algorithm is selected.
+
 Return Value:
 
     None.
@@ -1168,6 +1191,16 @@ Return Value:
 
     *WorkingBufferSize = 0;
 
+    //
+    // Use the Winograd algorithm if the caller supplied a transformed filter
+    // and the convolution shape is eligible.
+    //
+
+    if (WinogradPackedFilter != nullptr &&
+        MlasConvWinogradPrepare(Parameters, WinogradPackedFilter, WorkingBufferSize, ThreadPool)) {
+        return;
+    }
+
     if (AllStridesAreOne && AllPaddingIsZero) {
 
         //
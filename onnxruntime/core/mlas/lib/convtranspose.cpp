@@ -0,0 +1,769 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    convtranspose.cpp
+
+Abstract:
+
+    This module implements the transposed convolution operation.
+
+    The output is decomposed by stride phase (sub-pixel decomposition): the
+    output positions whose padded coordinates are congruent modulo the stride
+    receive contributions from a fixed subset of the kernel taps, and each of
+    those taps reads the input at a fixed offset. Every stride phase is thus a
+    unit stride convolution with a smaller kernel. The filter is packed once
+    per phase as a FilterCount x (Taps * InputChannels) matrix. Each tile of
+    phase output positions gathers its input panel into a per-thread buffer,
+    runs a single SGEMM, and scatters the results with the bias added directly
+    into the output tensor.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of input panel elements targeted per tile and the limits
+// on the number of phase output positions per tile.
+//
+
+#define MLAS_CONV_TRANSPOSE_PANEL_ELEMENTS      (32 * 1024)
+#define MLAS_CONV_TRANSPOSE_MINIMUM_TILE        32
+#define MLAS_CONV_TRANSPOSE_MAXIMUM_TILE        512
+
+struct MLAS_CONV_TRANSPOSE_WORK_BLOCK {
+    const MLAS_CONV_TRANSPOSE_PARAMETERS* Parameters;
+    const float* Input;
+    const float* PackedFilter;
+    const float* Bias;
+    float* WorkingBuffer;
+    float* Output;
+};
+
+MLAS_FORCEINLINE
+size_t
+MlasConvTransposeCountTaps(
+    size_t KernelSize,
+    size_t Dilation,
+    size_t Stride,
+    size_t Residue,
+    size_t* TapsBefore
+    )
+/*++
+
+Routine Description:
+
+    This routine counts the kernel taps along one dimension that contribute to
+    the stride phase with the supplied residue.
+
+Arguments:
+
+    KernelSize - Supplies the kernel size along the dimension.
+
+    Dilation - Supplies the dilation along the dimension.
+
+    Stride - Supplies the stride along the dimension.
+
+    Residue - Supplies the stride phase.
+
+    TapsBefore - Optionally receives the number of taps that belong to the
+        stride phases before the supplied residue.
+
+Return Value:
+
+    Returns the number of taps in the stride phase.
+
+--*/
+{
+    size_t Taps = 0;
+    size_t Before = 0;
+
+    for (size_t k = 0; k < KernelSize; k++) {
+        size_t r = (k * Dilation) % Stride;
+        if (r == Residue) {
+            Taps++;
+        } else if (r < Residue) {
+            Before++;
+        }
+    }
+
+    if (TapsBefore != nullptr) {
+        *TapsBefore = Before;
+    }
+
+    return Taps;
+}
+
+MLAS_FORCEINLINE
+void
+MlasConvTransposePhaseRange(
+    size_t OutputSize,
+    size_t Padding,
+    size_t Stride,
+    size_t Residue,
+    size_t* Start,
+    size_t* Count
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the range of phase indices Q along one dimension for
+    which the output coordinate Q * Stride + Residue - Padding lies inside the
+    output.
+
+Arguments:
+
+    OutputSize - Supplies the output size along the dimension.
+
+    Padding - Supplies the leading padding along the dimension.
+
+    Stride - Supplies the stride along the dimension.
+
+    Residue - Supplies the stride phase.
+
+    Start - Receives the first phase index.
+
+    Count - Receives the number of phase indices.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    size_t First = (Padding > Residue) ? (Padding - Residue + Stride - 1) / Stride : 0;
+
+    if (OutputSize + Padding <= Residue) {
+        *Start = First;
+        *Count = 0;
+        return;
+    }
+
+    size_t Last = (OutputSize + Padding - Residue - 1) / Stride;
+
+    *Start = First;
+    *Count = (Last >= First) ? Last - First + 1 : 0;
+}
+
+size_t
+MLASCALL
+MlasConvTransposePackFilterSize(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const int64_t* KernelShape
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the size in bytes of the packed filter buffer.
+
+Arguments:
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of output channels per group.
+
+    KernelShape - Supplies the two dimensional kernel shape.
+
+Return Value:
+
+    Returns the size of the packed filter buffer in bytes.
+
+--*/
+{
+    return GroupCount * InputChannels * FilterCount * size_t(KernelShape[0]) *
+        size_t(KernelShape[1]) * sizeof(float);
+}
+
+void
+MLASCALL
+MlasConvTransposePackFilter(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* StrideShape,
+    const float* Filter,
+    float* PackedFilter
+    )
+/*++
+
+Routine Description:
+
+    This routine packs a transposed convolution filter with layout
+    [GroupCount * InputChannels][FilterCount][KernelHeight][KernelWidth].
+
+    For each group and each stride phase, the taps of the phase are gathered
+    into a row major matrix of FilterCount rows by Taps * InputChannels
+    columns.
+
+Arguments:
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of output channels per group.
+
+    KernelShape - Supplies the two dimensional kernel shape.
+
+    DilationShape - Supplies the two dimensional dilation shape.
+
+    StrideShape - Supplies the two dimensional stride shape.
+
+    Filter - Supplies the filter tensor.
+
+    PackedFilter - Supplies the packed filter buffer, sized by
+        MlasConvTransposePackFilterSize.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t KernelHeight = size_t(KernelShape[0]);
+    const size_t KernelWidth = size_t(KernelShape[1]);
+    const size_t DilationHeight = size_t(DilationShape[0]);
+    const size_t DilationWidth = size_t(DilationShape[1]);
+    const size_t StrideHeight = size_t(StrideShape[0]);
+    const size_t StrideWidth = size_t(StrideShape[1]);
+    const size_t KernelSize = KernelHeight * KernelWidth;
+
+    for (size_t g = 0; g < GroupCount; g++) {
+
+        const float* filter = Filter + g * InputChannels * FilterCount * KernelSize;
+
+        for (size_t rh = 0; rh < StrideHeight; rh++) {
+
+            for (size_t rw = 0; rw < StrideWidth; rw++) {
+
+                const size_t Taps =
+                    MlasConvTransposeCountTaps(KernelHeight, DilationHeight, StrideHeight, rh, nullptr) *
+                    MlasConvTransposeCountTaps(KernelWidth, DilationWidth, StrideWidth, rw, nullptr);
+                const size_t K = Taps * InputChannels;
+
+                size_t t = 0;
+
+                for (size_t kh = 0; kh < KernelHeight; kh++) {
+
+                    if ((kh * DilationHeight) % StrideHeight != rh) {
+                        continue;
+                    }
+
+                    for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+                        if ((kw * DilationWidth) % StrideWidth != rw) {
+                            continue;
+                        }
+
+                        for (size_t f = 0; f < FilterCount; f++) {
+                            for (size_t ic = 0; ic < InputChannels; ic++) {
+                                PackedFilter[f * K + t * InputChannels + ic] =
+                                    filter[(ic * FilterCount + f) * KernelSize + kh * KernelWidth + kw];
+                            }
+                        }
+
+                        t++;
+                    }
+                }
+
+                PackedFilter += FilterCount * K;
+            }
+        }
+    }
+}
+
+void
+MLASCALL
+MlasConvTransposePrepare(
+    MLAS_CONV_TRANSPOSE_PARAMETERS* Parameters,
+    size_t BatchCount,
+    size_t GroupCount,
+    size_t InputChannels,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    size_t FilterCount,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine prepares for a two dimensional transposed convolution
+    operation by computing required parameters including the required working
+    buffer size for intermediate results.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the provided and computed
+        parameters for the transposed convolution operation.
+
+    BatchCount - Supplies the batch size.
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    InputShape - Supplies the two dimensional input shape.
+
+    KernelShape - Supplies the two dimensional kernel shape.
+
+    DilationShape - Supplies the two dimensional dilation shape.
+
+    Padding - Supplies the leading and trailing padding (top, left, bottom,
+        right). The padding must not be negative.
+
+    StrideShape - Supplies the two dimensional stride shape.
+
+    OutputShape - Supplies the two dimensional output shape.
+
+    FilterCount - Supplies the number of output channels per group.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    Parameters->BatchCount = BatchCount;
+    Parameters->GroupCount = GroupCount;
+    Parameters->InputChannels = InputChannels;
+    Parameters->FilterCount = FilterCount;
+
+    for (size_t dim = 0; dim < 2; dim++) {
+        Parameters->InputShape[dim] = size_t(InputShape[dim]);
+        Parameters->KernelShape[dim] = size_t(KernelShape[dim]);
+        Parameters->DilationShape[dim] = size_t(DilationShape[dim]);
+        Parameters->Padding[dim] = size_t(Padding[dim]);
+        Parameters->Padding[dim + 2] = size_t(Padding[dim + 2]);
+        Parameters->StrideShape[dim] = size_t(StrideShape[dim]);
+        Parameters->OutputShape[dim] = size_t(OutputShape[dim]);
+    }
+
+    Parameters->InputSize = Parameters->InputShape[0] * Parameters->InputShape[1];
+    Parameters->OutputSize = Parameters->OutputShape[0] * Parameters->OutputShape[1];
+
+    //
+    // Find the largest number of taps in any stride phase to size the input
+    // panel.
+    //
+
+    size_t MaximumTapsHeight = 0;
+    size_t MaximumTapsWidth = 0;
+
+    for (size_t rh = 0; rh < Parameters->StrideShape[0]; rh++) {
+        MaximumTapsHeight = std::max(MaximumTapsHeight, MlasConvTransposeCountTaps(Parameters->KernelShape[0],
+            Parameters->DilationShape[0], Parameters->StrideShape[0], rh, nullptr));
+    }
+
+    for (size_t rw = 0; rw < Parameters->StrideShape[1]; rw++) {
+        MaximumTapsWidth = std::max(MaximumTapsWidth, MlasConvTransposeCountTaps(Parameters->KernelShape[1],
+            Parameters->DilationShape[1], Parameters->StrideShape[1], rw, nullptr));
+    }
+
+    const size_t MaximumK = std::max<size_t>(MaximumTapsHeight * MaximumTapsWidth * InputChannels, 1);
+
+    //
+    // Size the tiles so that the input panel stays cache resident, but do
+    // not exceed the number of positions in a stride phase.
+    //
+
+    const size_t PhasePositions =
+        MlasDivRoundup(Parameters->OutputShape[0], Parameters->StrideShape[0]) *
+        MlasDivRoundup(Parameters->OutputShape[1], Parameters->StrideShape[1]);
+
+    size_t TileSize = MLAS_CONV_TRANSPOSE_PANEL_ELEMENTS / MaximumK;
+    TileSize = std::min<size_t>(std::max<size_t>(TileSize, MLAS_CONV_TRANSPOSE_MINIMUM_TILE), MLAS_CONV_TRANSPOSE_MAXIMUM_TILE);
+    TileSize = (TileSize / 16) * 16;
+    TileSize = std::min(TileSize, (PhasePositions + 15) / 16 * 16);
+
+    Parameters->TileSize = TileSize;
+    Parameters->TilesPerPhase = MlasDivRoundup(PhasePositions, TileSize);
+    Parameters->WorkingBufferSizePerThread = (MaximumK + FilterCount) * TileSize;
+
+    const size_t TotalWork = BatchCount * GroupCount * Parameters->StrideShape[0] *
+        Parameters->StrideShape[1] * Parameters->TilesPerPhase;
+
+    ptrdiff_t ThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (size_t(ThreadCount) > TotalWork) {
+        ThreadCount = ptrdiff_t(std::max<size_t>(TotalWork, 1));
+    }
+
+    Parameters->ThreadCount = ThreadCount;
+
+    *WorkingBufferSize = size_t(ThreadCount) * Parameters->WorkingBufferSizePerThread;
+}
+
+void
+MlasConvTransposeTile(
+    const MLAS_CONV_TRANSPOSE_PARAMETERS* Parameters,
+    const float* Input,
+    const float* PackedFilter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    size_t ResidueHeight,
+    size_t ResidueWidth,
+    size_t TileStart
+    )
+/*++
+
+Routine Description:
+
+    This routine computes one tile of phase output positions for a single
+    image and channel group.
+
+Arguments:
+
+    Parameters - Supplies the transposed convolution parameters.
+
+    Input - Supplies the input channels of the group.
+
+    PackedFilter - Supplies the packed filter of the group.
+
+    Bias - Supplies the bias of the group, else nullptr.
+
+    WorkingBuffer - Supplies the per-thread working buffer.
+
+    Output - Supplies the output channels of the group.
+
+    ResidueHeight - Supplies the stride phase along the height.
+
+    ResidueWidth - Supplies the stride phase along the width.
+
+    TileStart - Supplies the index of the first phase output position.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t InputSize = Parameters->InputSize;
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t KernelHeight = Parameters->KernelShape[0];
+    const size_t KernelWidth = Parameters->KernelShape[1];
+    const size_t DilationHeight = Parameters->DilationShape[0];
+    const size_t DilationWidth = Parameters->DilationShape[1];
+    const size_t StrideHeight = Parameters->StrideShape[0];
+    const size_t StrideWidth = Parameters->StrideShape[1];
+
+    size_t PhaseStartHeight;
+    size_t PhaseHeight;
+    size_t PhaseStartWidth;
+    size_t PhaseWidth;
+
+    MlasConvTransposePhaseRange(Parameters->OutputShape[0], Parameters->Padding[0], StrideHeight,
+        ResidueHeight, &PhaseStartHeight, &PhaseHeight);
+    MlasConvTransposePhaseRange(OutputWidth, Parameters->Padding[1], StrideWidth,
+        ResidueWidth, &PhaseStartWidth, &PhaseWidth);
+
+    const size_t PhasePositions = PhaseHeight * PhaseWidth;
+
+    if (TileStart >= PhasePositions) {
+        return;
+    }
+
+    const size_t CountN = std::min(Parameters->TileSize, PhasePositions - TileStart);
+
+    size_t TapsBeforeHeight;
+    size_t TapsBeforeWidth;
+    const size_t TapsHeight = MlasConvTransposeCountTaps(KernelHeight, DilationHeight, StrideHeight,
+        ResidueHeight, &TapsBeforeHeight);
+    const size_t TapsWidth = MlasConvTransposeCountTaps(KernelWidth, DilationWidth, StrideWidth,
+        ResidueWidth, &TapsBeforeWidth);
+    const size_t K = TapsHeight * TapsWidth * InputChannels;
+
+    float* Panel = WorkingBuffer;
+    float* Accumulator = WorkingBuffer + (Parameters->WorkingBufferSizePerThread - FilterCount * Parameters->TileSize);
+
+    if (K > 0) {
+
+        //
+        // Locate the packed filter of this stride phase. The phases are
+        // stored in row major order of (ResidueHeight, ResidueWidth).
+        //
+
+        const float* filter = PackedFilter +
+            FilterCount * InputChannels * (TapsBeforeHeight * KernelWidth + TapsHeight * TapsBeforeWidth);
+
+        //
+        // Gather the input panel of Taps * InputChannels rows by CountN
+        // columns. Positions that read outside of the input are zero.
+        //
+
+        size_t t = 0;
+
+        for (size_t kh = 0; kh < KernelHeight; kh++) {
+
+            if ((kh * DilationHeight) % StrideHeight != ResidueHeight) {
+                continue;
+            }
+
+            const ptrdiff_t OffsetHeight = ptrdiff_t((kh * DilationHeight - ResidueHeight) / StrideHeight);
+
+            for (size_t kw = 0; kw < KernelWidth; kw++) {
+
+                if ((kw * DilationWidth) % StrideWidth != ResidueWidth) {
+                    continue;
+                }
+
+                const ptrdiff_t OffsetWidth = ptrdiff_t((kw * DilationWidth - ResidueWidth) / StrideWidth);
+
+                float* panel = Panel + t * InputChannels * CountN;
+
+                size_t q = TileStart / PhaseWidth;
+                size_t p = TileStart % PhaseWidth;
+                size_t n = 0;
+
+                while (n < CountN) {
+
+                    const size_t SegmentLength = std::min(PhaseWidth - p, CountN - n);
+                    const ptrdiff_t ih = ptrdiff_t(PhaseStartHeight + q) - OffsetHeight;
+                    const ptrdiff_t iw = ptrdiff_t(PhaseStartWidth + p) - OffsetWidth;
+
+                    if (ih < 0 || size_t(ih) >= InputHeight) {
+
+                        for (size_t ic = 0; ic < InputChannels; ic++) {
+                            std::fill_n(panel + ic * CountN + n, SegmentLength, 0.0f);
+                        }
+
+                    } else {
+
+                        //
+                        // Split the segment into the leading and trailing
+                        // padding and the contiguous input span.
+                        //
+
+                        const size_t LeadingZeros = (iw < 0) ? std::min(SegmentLength, size_t(-iw)) : 0;
+                        const ptrdiff_t SpanEnd = std::min(iw + ptrdiff_t(SegmentLength), ptrdiff_t(InputWidth));
+                        const ptrdiff_t SpanStart = iw + ptrdiff_t(LeadingZeros);
+                        const size_t SpanLength = (SpanEnd > SpanStart) ? size_t(SpanEnd - SpanStart) : 0;
+                        const size_t TrailingZeros = SegmentLength - LeadingZeros - SpanLength;
+
+                        const float* input = Input + size_t(ih) * InputWidth + size_t(SpanStart);
+
+                        for (size_t ic = 0; ic < InputChannels; ic++) {
+                            float* row = panel + ic * CountN + n;
+                            std::fill_n(row, LeadingZeros, 0.0f);
+                            std::copy_n(input + ic * InputSize, SpanLength, row + LeadingZeros);
+                            std::fill_n(row + LeadingZeros + SpanLength, TrailingZeros, 0.0f);
+                        }
+                    }
+
+                    n += SegmentLength;
+                    q++;
+                    p = 0;
+                }
+
+                t++;
+            }
+        }
+
+        MlasSgemmOperation(CblasNoTrans, CblasNoTrans, FilterCount, CountN, K, 1.0f, filter, K,
+            Panel, CountN, 0.0f, Accumulator, CountN);
+    }
+
+    //
+    // Scatter the tile to the output with the bias added.
+    //
+
+    for (size_t f = 0; f < FilterCount; f++) {
+
+        const float bias = (Bias != nullptr) ? Bias[f] : 0.0f;
+        const float* accumulator = Accumulator + f * CountN;
+        float* output = Output + f * OutputSize;
+
+        size_t q = TileStart / PhaseWidth;
+        size_t p = TileStart % PhaseWidth;
+        size_t n = 0;
+
+        while (n < CountN) {
+
+            const size_t SegmentLength = std::min(PhaseWidth - p, CountN - n);
+            const size_t oh = (PhaseStartHeight + q) * StrideHeight + ResidueHeight - Parameters->Padding[0];
+            const size_t ow = (PhaseStartWidth + p) * StrideWidth + ResidueWidth - Parameters->Padding[1];
+
+            float* row = output + oh * OutputWidth + ow;
+
+            if (K > 0) {
+                for (size_t j = 0; j < SegmentLength; j++) {
+                    row[j * StrideWidth] = accumulator[n + j] + bias;
+                }
+            } else {
+                for (size_t j = 0; j < SegmentLength; j++) {
+                    row[j * StrideWidth] = bias;
+                }
+            }
+
+            n += SegmentLength;
+            q++;
+            p = 0;
+        }
+    }
+}
+
+void
+MlasConvTransposeThreaded(
+    void* Context,
+    ptrdiff_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    transposed convolution operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (MLAS_CONV_TRANSPOSE_WORK_BLOCK*)Context;
+    const MLAS_CONV_TRANSPOSE_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t StrideHeight = Parameters->StrideShape[0];
+    const size_t StrideWidth = Parameters->StrideShape[1];
+    const size_t TilesPerPhase = Parameters->TilesPerPhase;
+
+    const size_t InputGroupSize = Parameters->InputChannels * Parameters->InputSize;
+    const size_t OutputGroupSize = Parameters->FilterCount * Parameters->OutputSize;
+    const size_t FilterGroupSize = Parameters->InputChannels * Parameters->FilterCount *
+        Parameters->KernelShape[0] * Parameters->KernelShape[1];
+
+    const size_t TotalWork = Parameters->BatchCount * GroupCount * StrideHeight * StrideWidth * TilesPerPhase;
+
+    size_t WorkIndex;
+    size_t WorkRemaining;
+
+    MlasPartitionWork(Index, Parameters->ThreadCount, TotalWork, &WorkIndex, &WorkRemaining);
+
+    float* WorkingBuffer = WorkBlock->WorkingBuffer + size_t(Index) * Parameters->WorkingBufferSizePerThread;
+
+    while (WorkRemaining > 0) {
+
+        //
+        // Decompose the work index into (image, group, phase, tile). The tile
+        // index varies fastest so that a thread reuses the packed filter of a
+        // phase across consecutive tiles.
+        //
+
+        size_t w = WorkIndex;
+        const size_t Tile = w % TilesPerPhase;
+        w /= TilesPerPhase;
+        const size_t ResidueWidth = w % StrideWidth;
+        w /= StrideWidth;
+        const size_t ResidueHeight = w % StrideHeight;
+        w /= StrideHeight;
+        const size_t Group = w % GroupCount;
+        const size_t Image = w / GroupCount;
+
+        const size_t ImageGroup = Image * GroupCount + Group;
+
+        MlasConvTransposeTile(Parameters,
+            WorkBlock->Input + ImageGroup * InputGroupSize,
+            WorkBlock->PackedFilter + Group * FilterGroupSize,
+            (WorkBlock->Bias != nullptr) ? WorkBlock->Bias + Group * Parameters->FilterCount : nullptr,
+            WorkingBuffer,
+            WorkBlock->Output + ImageGroup * OutputGroupSize,
+            ResidueHeight,
+            ResidueWidth,
+            Tile * Parameters->TileSize);
+
+        WorkIndex++;
+        WorkRemaining--;
+    }
+}
+
+void
+MLASCALL
+MlasConvTranspose(
+    const MLAS_CONV_TRANSPOSE_PARAMETERS* Parameters,
+    const float* Input,
+    const float* PackedFilter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the two dimensional transposed convolution
+    operation.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the transposed
+        convolution parameters.
+
+    Input - Supplies the input tensor.
+
+    PackedFilter - Supplies the filter packed by MlasConvTransposePackFilter
+        with the same kernel, dilation and stride shapes.
+
+    Bias - Optionally supplies the bias vector.
+
+    WorkingBuffer - Supplies a working buffer sized to the number of elements
+        returned by MlasConvTransposePrepare.
+
+    Output - Supplies the output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_CONV_TRANSPOSE_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Parameters = Parameters;
+    WorkBlock.Input = Input;
+    WorkBlock.PackedFilter = PackedFilter;
+    WorkBlock.Bias = Bias;
+    WorkBlock.WorkingBuffer = WorkingBuffer;
+    WorkBlock.Output = Output;
+
+    MlasExecuteThreaded(MlasConvTransposeThreaded, &WorkBlock, Parameters->ThreadCount, ThreadPool);
+}
@@ -0,0 +1,1159 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    eltwise.cpp
+
+Abstract:
+
+    This module implements the broadcast element-wise binary and select
+    operations.
+
+    The tensor shapes are first collapsed by dropping unit dimensions and by
+    merging adjacent dimensions that are contiguous for both inputs. The
+    output is then processed as a flat range of elements split across the
+    thread pool, where each thread walks the collapsed shape and invokes a
+    vectorized row kernel for the innermost dimension. The row kernel has
+    specialized loops for the vector/vector, scalar/vector and vector/scalar
+    cases, so broadcasts on inner dimensions become stride-0 loops.
+
+    The row kernels in this module use 128-bit vectors. On AMD64 the single
+    precision operations other than Pow use the AVX or AVX512F row kernels
+    from the platform dispatch instead. The int32 and fp16 rows stay 128-bit.
+
+    Pow has no vector form in MLAS, so only the exponents of 2 and 3 that the
+    Pow operator special cases are vectorized, as multiplies. Integer division
+    has no vector instruction on the MLAS targets, and MLAS has no 64-bit
+    integer vector wrappers, so those rows are plain loops that the compiler
+    may auto-vectorize.
+
+--*/
+
+#include "mlasi.h"
+#include "mlas_float16.h"
+
+//
+// Define the number of output elements each thread should process before
+// using another thread.
+//
+
+constexpr size_t MLAS_ELTWISE_THREAD_COMPLEXITY = 16384;
+
+//
+// Define the granularity of the thread partitions in output elements so that
+// the threads do not share cache lines of the output.
+//
+
+constexpr size_t MLAS_ELTWISE_THREAD_GRANULARITY = 16;
+
+//
+// Define the scalar operations.
+//
+
+template<MLAS_ELTWISE_BINARY_KIND Kind, typename T>
+MLAS_FORCEINLINE
+T
+MlasEltwiseScalar(
+    T a,
+    T b
+    )
+{
+    if constexpr (Kind == MlasEltwiseAdd) {
+        return a + b;
+    } else if constexpr (Kind == MlasEltwiseSub) {
+        return a - b;
+    } else if constexpr (Kind == MlasEltwiseMul) {
+        return a * b;
+    } else if constexpr (Kind == MlasEltwiseDiv) {
+        return a / b;
+    } else if constexpr (Kind == MlasEltwiseMin) {
+        if constexpr (std::is_same<T, float>::value) {
+            //
+            // Use the vector operation so that the tail of a row follows
+            // the same operand order and NaN rule as the rest of the row.
+            //
+            return MlasExtractLaneFloat32x4<0>(
+                MlasMinimumFloat32x4(MlasBroadcastFloat32x4(a), MlasBroadcastFloat32x4(b)));
+        } else {
+            return std::min(a, b);
+        }
+    } else if constexpr (Kind == MlasEltwisePow) {
+        return T(std::pow(a, b));
+    } else {
+        if constexpr (std::is_same<T, float>::value) {
+            return MlasExtractLaneFloat32x4<0>(
+                MlasMaximumFloat32x4(MlasBroadcastFloat32x4(a), MlasBroadcastFloat32x4(b)));
+        } else {
+            return std::max(a, b);
+        }
+    }
+}
+
+//
+// Define the vector operations.
+//
+
+template<MLAS_ELTWISE_BINARY_KIND Kind>
+MLAS_FORCEINLINE
+MLAS_FLOAT32X4
+MlasEltwiseVector(
+    MLAS_FLOAT32X4 a,
+    MLAS_FLOAT32X4 b
+    )
+{
+    if constexpr (Kind == MlasEltwiseAdd) {
+        return MlasAddFloat32x4(a, b);
+    } else if constexpr (Kind == MlasEltwiseSub) {
+        return MlasSubtractFloat32x4(a, b);
+    } else if constexpr (Kind == MlasEltwiseMul) {
+        return MlasMultiplyFloat32x4(a, b);
+    } else if constexpr (Kind == MlasEltwiseDiv) {
+        return MlasDivideFloat32x4(a, b);
+    } else if constexpr (Kind == MlasEltwiseMin) {
+        return MlasMinimumFloat32x4(a, b);
+    } else {
+        return MlasMaximumFloat32x4(a, b);
+    }
+}
+
+template<MLAS_ELTWISE_BINARY_KIND Kind>
+MLAS_FORCEINLINE
+MLAS_INT32X4
+MlasEltwiseVector(
+    MLAS_INT32X4 a,
+    MLAS_INT32X4 b
+    )
+{
+    if constexpr (Kind == MlasEltwiseAdd) {
+        return MlasAddInt32x4(a, b);
+    } else if constexpr (Kind == MlasEltwiseSub) {
+        return MlasSubtractInt32x4(a, b);
+    } else if constexpr (Kind == MlasEltwiseMul) {
+        return MlasMultiplyInt32x4(a, b);
+    } else if constexpr (Kind == MlasEltwiseMin) {
+        return MlasMinimumInt32x4(a, b);
+    } else {
+        static_assert(Kind == MlasEltwiseMax, "unsupported int32 vector operation");
+        return MlasMaximumInt32x4(a, b);
+    }
+}
+
+//
+// Define the vector traits used by the row kernels. Types and operations
+// without a vector implementation use scalar loops that the compiler may
+// auto-vectorize.
+//
+
+template<MLAS_ELTWISE_BINARY_KIND Kind, typename T>
+struct MLAS_ELTWISE_VECTOR_TRAITS
+{
+    static constexpr bool Enabled = false;
+};
+
+template<MLAS_ELTWISE_BINARY_KIND Kind>
+struct MLAS_ELTWISE_VECTOR_TRAITS<Kind, float>
+{
+    static constexpr bool Enabled = (Kind != MlasEltwisePow);
+    using VectorType = MLAS_FLOAT32X4;
+
+    static VectorType Load(const float* p) { return MlasLoadFloat32x4(p); }
+    static VectorType Broadcast(float v) { return MlasBroadcastFloat32x4(v); }
+    static void Store(float* p, VectorType v) { MlasStoreFloat32x4(p, v); }
+};
+
+template<MLAS_ELTWISE_BINARY_KIND Kind>
+struct MLAS_ELTWISE_VECTOR_TRAITS<Kind, int32_t>
+{
+    static constexpr bool Enabled = (Kind == MlasEltwiseAdd || Kind == MlasEltwiseSub ||
+                                     Kind == MlasEltwiseMul || Kind == MlasEltwiseMin ||
+                                     Kind == MlasEltwiseMax);
+    using VectorType = MLAS_INT32X4;
+
+    static VectorType Load(const int32_t* p) { return MlasLoadInt32x4(p); }
+    static VectorType Broadcast(int32_t v) { return MlasBroadcastInt32x4(v); }
+    static void Store(int32_t* p, VectorType v) { MlasStoreInt32x4(p, v); }
+};
+
+template<MLAS_ELTWISE_BINARY_KIND Kind, typename T>
+void
+MlasEltwiseRow(
+    const T* A,
+    size_t StrideA,
+    const T* B,
+    size_t StrideB,
+    T* C,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the binary operation for one row of the innermost
+    dimension.
+
+Arguments:
+
+    A - Supplies the first input row.
+
+    StrideA - Supplies the element stride of the first input, zero if the
+        input is broadcast along the row.
+
+    B - Supplies the second input row.
+
+    StrideB - Supplies the element stride of the second input, zero if the
+        input is broadcast along the row.
+
+    C - Supplies the contiguous output row.
+
+    N - Supplies the number of elements in the row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    using Traits = MLAS_ELTWISE_VECTOR_TRAITS<Kind, T>;
+
+    //
+    // Square and cube the row with vector multiplies for the common
+    // broadcast exponents. The cube is computed in blocks through a local
+    // buffer so that the output may alias the input.
+    //
+
+    if constexpr (Kind == MlasEltwisePow) {
+
+        if (StrideB == 0 && *B == T(2)) {
+            MlasEltwiseRow<MlasEltwiseMul, T>(A, StrideA, A, StrideA, C, N);
+            return;
+        }
+
+        if (StrideB == 0 && *B == T(3)) {
+
+            constexpr size_t BlockSize = 64;
+
+            T Square[BlockSize];
+
+            while (N > 0) {
+
+                const size_t n = std::min(N, BlockSize);
+
+                MlasEltwiseRow<MlasEltwiseMul, T>(A, StrideA, A, StrideA, Square, n);
+                MlasEltwiseRow<MlasEltwiseMul, T>(Square, 1, A, StrideA, C, n);
+
+                A += n * StrideA;
+                C += n;
+                N -= n;
+            }
+
+            return;
+        }
+    }
+
+    if (StrideA == 1 && StrideB == 1) {
+
+        if constexpr (Traits::Enabled) {
+
+            while (N >= 16) {
+
+                auto c0 = MlasEltwiseVector<Kind>(Traits::Load(A), Traits::Load(B));
+                auto c1 = MlasEltwiseVector<Kind>(Traits::Load(A + 4), Traits::Load(B + 4));
+                auto c2 = MlasEltwiseVector<Kind>(Traits::Load(A + 8), Traits::Load(B + 8));
+                auto c3 = MlasEltwiseVector<Kind>(Traits::Load(A + 12), Traits::Load(B + 12));
+
+                Traits::Store(C, c0);
+                Traits::Store(C + 4, c1);
+                Traits::Store(C + 8, c2);
+                Traits::Store(C + 12, c3);
+
+                A += 16;
+                B += 16;
+                C += 16;
+                N -= 16;
+            }
+
+            while (N >= 4) {
+
+                Traits::Store(C, MlasEltwiseVector<Kind>(Traits::Load(A), Traits::Load(B)));
+
+                A += 4;
+                B += 4;
+                C += 4;
+                N -= 4;
+            }
+        }
+
+        for (size_t n = 0; n < N; n++) {
+            C[n] = MlasEltwiseScalar<Kind>(A[n], B[n]);
+        }
+
+    } else if (StrideA == 0 && StrideB == 1) {
+
+        const T a = *A;
+
+        if constexpr (Traits::Enabled) {
+
+            const auto va = Traits::Broadcast(a);
+
+            while (N >= 16) {
+
+                auto c0 = MlasEltwiseVector<Kind>(va, Traits::Load(B));
+                auto c1 = MlasEltwiseVector<Kind>(va, Traits::Load(B + 4));
+                auto c2 = MlasEltwiseVector<Kind>(va, Traits::Load(B + 8));
+                auto c3 = MlasEltwiseVector<Kind>(va, Traits::Load(B + 12));
+
+                Traits::Store(C, c0);
+                Traits::Store(C + 4, c1);
+                Traits::Store(C + 8, c2);
+                Traits::Store(C + 12, c3);
+
+                B += 16;
+                C += 16;
+                N -= 16;
+            }
+
+            while (N >= 4) {
+
+                Traits::Store(C, MlasEltwiseVector<Kind>(va, Traits::Load(B)));
+
+                B += 4;
+                C += 4;
+                N -= 4;
+            }
+        }
+
+        for (size_t n = 0; n < N; n++) {
+            C[n] = MlasEltwiseScalar<Kind>(a, B[n]);
+        }
+
+    } else if (StrideA == 1 && StrideB == 0) {
+
+        const T b = *B;
+
+        if constexpr (Traits::Enabled) {
+
+            const auto vb = Traits::Broadcast(b);
+
+            while (N >= 16) {
+
+                auto c0 = MlasEltwiseVector<Kind>(Traits::Load(A), vb);
+                auto c1 = MlasEltwiseVector<Kind>(Traits::Load(A + 4), vb);
+                auto c2 = MlasEltwiseVector<Kind>(Traits::Load(A + 8), vb);
+                auto c3 = MlasEltwiseVector<Kind>(Traits::Load(A + 12), vb);
+
+                Traits::Store(C, c0);
+                Traits::Store(C + 4, c1);
+                Traits::Store(C + 8, c2);
+                Traits::Store(C + 12, c3);
+
+                A += 16;
+                C += 16;
+                N -= 16;
+            }
+
+            while (N >= 4) {
+
+                Traits::Store(C, MlasEltwiseVector<Kind>(Traits::Load(A), vb));
+
+                A += 4;
+                C += 4;
+                N -= 4;
+            }
+        }
+
+        for (size_t n = 0; n < N; n++) {
+            C[n] = MlasEltwiseScalar<Kind>(A[n], b);
+        }
+
+    } else if (StrideA == 0 && StrideB == 0) {
+
+        std::fill_n(C, N, MlasEltwiseScalar<Kind>(*A, *B));
+
+    } else {
+
+        for (size_t n = 0; n < N; n++) {
+            C[n] = MlasEltwiseScalar<Kind>(A[n * StrideA], B[n * StrideB]);
+        }
+    }
+}
+
+template<MLAS_ELTWISE_BINARY_KIND Kind>
+void
+MlasEltwiseRowHalf(
+    const MLAS_FP16* A,
+    size_t StrideA,
+    const MLAS_FP16* B,
+    size_t StrideB,
+    MLAS_FP16* C,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the binary operation for one row of half precision
+    values by converting blocks of the row to single precision.
+
+Arguments:
+
+    See MlasEltwiseRow.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t BlockSize = 64;
+
+    float BufferA[BlockSize];
+    float BufferB[BlockSize];
+    float BufferC[BlockSize];
+
+    while (N > 0) {
+
+        const size_t n = std::min(N, BlockSize);
+
+        for (size_t i = 0; i < (StrideA == 0 ? 1 : n); i++) {
+            BufferA[i] = MLAS_Half2Float(A[i * StrideA].val);
+        }
+
+        for (size_t i = 0; i < (StrideB == 0 ? 1 : n); i++) {
+            BufferB[i] = MLAS_Half2Float(B[i * StrideB].val);
+        }
+
+        MlasEltwiseRow<Kind, float>(BufferA, StrideA == 0 ? 0 : 1, BufferB, StrideB == 0 ? 0 : 1, BufferC, n);
+
+        for (size_t i = 0; i < n; i++) {
+            C[i].val = MLAS_Float2Half(BufferC[i]);
+        }
+
+        A += n * StrideA;
+        B += n * StrideB;
+        C += n;
+        N -= n;
+    }
+}
+
+
+//
+// Define the lane bytes used to build a selection mask from four condition
+// bytes. The AND with the broadcast condition bytes keeps byte i of the
+// condition in lane i independent of the byte order of the target.
+//
+
+MLAS_DECLSPEC_ALIGN(static const uint8_t MlasEltwiseSelectLaneBytes[16], 16) = {
+    1, 0, 0, 0,
+    0, 1, 0, 0,
+    0, 0, 1, 0,
+    0, 0, 0, 1,
+};
+
+MLAS_FORCEINLINE
+MLAS_FLOAT32X4
+MlasEltwiseSelectMask(
+    const bool* Condition,
+    MLAS_INT32X4 LaneBits
+    )
+{
+    int32_t Bytes;
+    memcpy(&Bytes, Condition, sizeof(Bytes));
+
+    MLAS_INT32X4 Lanes = MlasAndInt32x4(MlasBroadcastInt32x4(Bytes), LaneBits);
+
+    return MlasGreaterThanFloat32x4(MlasCastToFloat32x4(Lanes), MlasZeroFloat32x4());
+}
+
+template<typename T, typename VectorType>
+MLAS_FORCEINLINE
+VectorType
+MlasEltwiseSelectVector(
+    MLAS_FLOAT32X4 Mask,
+    VectorType a,
+    VectorType b
+    )
+{
+    if constexpr (std::is_same<T, float>::value) {
+        return MlasBlendFloat32x4(b, a, Mask);
+    } else {
+        return MlasBlendInt32x4(b, a, MlasReinterpretAsInt32x4(Mask));
+    }
+}
+
+template<typename T>
+void
+MlasEltwiseSelectRow(
+    const bool* Condition,
+    size_t StrideCondition,
+    const T* A,
+    size_t StrideA,
+    const T* B,
+    size_t StrideB,
+    T* C,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the select operation for one row of the innermost
+    dimension.
+
+Arguments:
+
+    Condition - Supplies the condition row.
+
+    StrideCondition - Supplies the element stride of the condition, zero if
+        the condition is broadcast along the row.
+
+    A - Supplies the row selected where the condition is true.
+
+    StrideA - Supplies the element stride of A, zero if A is broadcast along
+        the row.
+
+    B - Supplies the row selected where the condition is false.
+
+    StrideB - Supplies the element stride of B, zero if B is broadcast along
+        the row.
+
+    C - Supplies the contiguous output row.
+
+    N - Supplies the number of elements in the row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    //
+    // A broadcast condition selects the same input for the whole row.
+    //
+
+    if (StrideCondition == 0) {
+
+        const T* Source = *Condition ? A : B;
+        const size_t StrideSource = *Condition ? StrideA : StrideB;
+
+        if (StrideSource == 0) {
+            std::fill_n(C, N, *Source);
+        } else if (StrideSource == 1) {
+            std::copy_n(Source, N, C);
+        } else {
+            for (size_t n = 0; n < N; n++) {
+                C[n] = Source[n * StrideSource];
+            }
+        }
+
+        return;
+    }
+
+    size_t n = 0;
+
+    using Traits = MLAS_ELTWISE_VECTOR_TRAITS<MlasEltwiseAdd, T>;
+
+    if constexpr (Traits::Enabled) {
+
+        if (StrideCondition == 1 && StrideA <= 1 && StrideB <= 1) {
+
+            int32_t LaneMask[4];
+            memcpy(LaneMask, MlasEltwiseSelectLaneBytes, sizeof(LaneMask));
+            const MLAS_INT32X4 LaneBits = MlasLoadInt32x4(LaneMask);
+
+            const auto BroadcastA = Traits::Broadcast(*A);
+            const auto BroadcastB = Traits::Broadcast(*B);
+
+            for (; n + 4 <= N; n += 4) {
+
+                const auto a = (StrideA == 0) ? BroadcastA : Traits::Load(A + n);
+                const auto b = (StrideB == 0) ? BroadcastB : Traits::Load(B + n);
+
+                Traits::Store(C + n, MlasEltwiseSelectVector<T>(MlasEltwiseSelectMask(Condition + n, LaneBits), a, b));
+            }
+        }
+    }
+
+    for (; n < N; n++) {
+        C[n] = Condition[n * StrideCondition] ? A[n * StrideA] : B[n * StrideB];
+    }
+}
+
+template<typename T>
+struct MLAS_ELTWISE_WORK_BLOCK
+{
+    void (*RowRoutine)(const T* A, size_t StrideA, const T* B, size_t StrideB, T* C, size_t N);
+    size_t Rank;
+    size_t Shape[MLAS_ELTWISE_MAXIMUM_RANK];
+    size_t StridesCondition[MLAS_ELTWISE_MAXIMUM_RANK];
+    size_t StridesA[MLAS_ELTWISE_MAXIMUM_RANK];
+    size_t StridesB[MLAS_ELTWISE_MAXIMUM_RANK];
+    const bool* Condition;
+    const T* A;
+    const T* B;
+    T* C;
+    size_t TotalElements;
+    ptrdiff_t ThreadCount;
+};
+
+template<typename T>
+void
+MlasEltwiseThreaded(
+    void* Context,
+    ptrdiff_t ThreadId
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    broadcast element-wise operation. The select operation is used if the
+    work block has a condition, else the binary row routine.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    ThreadId - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (const MLAS_ELTWISE_WORK_BLOCK<T>*)Context;
+
+    //
+    // Partition the operation along the flattened output elements.
+    //
+
+    const size_t TotalBlocks = MlasDivRoundup(WorkBlock->TotalElements, MLAS_ELTWISE_THREAD_GRANULARITY);
+
+    size_t BlockIndex;
+    size_t BlockCount;
+
+    MlasPartitionWork(ThreadId, WorkBlock->ThreadCount, TotalBlocks, &BlockIndex, &BlockCount);
+
+    size_t Start = BlockIndex * MLAS_ELTWISE_THREAD_GRANULARITY;
+    size_t Count = std::min(BlockCount * MLAS_ELTWISE_THREAD_GRANULARITY, WorkBlock->TotalElements - Start);
+
+    if (Count == 0) {
+        return;
+    }
+
+    const size_t Rank = WorkBlock->Rank;
+    const size_t* Shape = WorkBlock->Shape;
+    const size_t* StridesCondition = WorkBlock->StridesCondition;
+    const size_t* StridesA = WorkBlock->StridesA;
+    const size_t* StridesB = WorkBlock->StridesB;
+
+    //
+    // Decompose the starting element into the index of each dimension.
+    //
+
+    size_t Index[MLAS_ELTWISE_MAXIMUM_RANK];
+    size_t OffsetCondition = 0;
+    size_t OffsetA = 0;
+    size_t OffsetB = 0;
+    size_t Remaining = Start;
+
+    for (size_t d = Rank; d > 0; d--) {
+        Index[d - 1] = Remaining % Shape[d - 1];
+        Remaining /= Shape[d - 1];
+        OffsetCondition += Index[d - 1] * StridesCondition[d - 1];
+        OffsetA += Index[d - 1] * StridesA[d - 1];
+        OffsetB += Index[d - 1] * StridesB[d - 1];
+    }
+
+    const size_t InnerSize = Shape[Rank - 1];
+    const size_t InnerStrideCondition = StridesCondition[Rank - 1];
+    const size_t InnerStrideA = StridesA[Rank - 1];
+    const size_t InnerStrideB = StridesB[Rank - 1];
+
+    T* C = WorkBlock->C + Start;
+
+    while (Count > 0) {
+
+        const size_t n = std::min(InnerSize - Index[Rank - 1], Count);
+
+        if (WorkBlock->Condition != nullptr) {
+            MlasEltwiseSelectRow<T>(WorkBlock->Condition + OffsetCondition, InnerStrideCondition,
+                                    WorkBlock->A + OffsetA, InnerStrideA, WorkBlock->B + OffsetB, InnerStrideB, C, n);
+        } else {
+            WorkBlock->RowRoutine(WorkBlock->A + OffsetA, InnerStrideA, WorkBlock->B + OffsetB, InnerStrideB, C, n);
+        }
+
+        C += n;
+        Count -= n;
+
+        //
+        // Advance to the start of the next row.
+        //
+
+        Index[Rank - 1] += n;
+        OffsetCondition += n * InnerStrideCondition;
+        OffsetA += n * InnerStrideA;
+        OffsetB += n * InnerStrideB;
+
+        if (Index[Rank - 1] < InnerSize) {
+            continue;
+        }
+
+        Index[Rank - 1] = 0;
+        OffsetCondition -= InnerSize * InnerStrideCondition;
+        OffsetA -= InnerSize * InnerStrideA;
+        OffsetB -= InnerSize * InnerStrideB;
+
+        for (size_t d = Rank - 1; d > 0; d--) {
+
+            Index[d - 1]++;
+            OffsetCondition += StridesCondition[d - 1];
+            OffsetA += StridesA[d - 1];
+            OffsetB += StridesB[d - 1];
+
+            if (Index[d - 1] < Shape[d - 1]) {
+                break;
+            }
+
+            Index[d - 1] = 0;
+            OffsetCondition -= Shape[d - 1] * StridesCondition[d - 1];
+            OffsetA -= Shape[d - 1] * StridesA[d - 1];
+            OffsetB -= Shape[d - 1] * StridesB[d - 1];
+        }
+    }
+}
+
+template<typename T>
+void
+MlasEltwiseExecute(
+    MLAS_ELTWISE_WORK_BLOCK<T>& WorkBlock,
+    size_t Rank,
+    const size_t* OutputShape,
+    const size_t* StridesCondition,
+    const size_t* StridesA,
+    const size_t* StridesB,
+    size_t ElementComplexity,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine collapses the broadcast shapes into the work block and
+    executes the operation across the thread pool.
+
+Arguments:
+
+    WorkBlock - Supplies the work block with the row routine and the tensor
+        addresses.
+
+    Rank - Supplies the rank of the output tensor.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    StridesCondition - Supplies the element strides of the condition, or
+        nullptr for a binary operation.
+
+    StridesA - Supplies the element strides of the first input.
+
+    StridesB - Supplies the element strides of the second input.
+
+    ElementComplexity - Supplies the relative cost of an output element.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (Rank > MLAS_ELTWISE_MAXIMUM_RANK) {
+        MLAS_THROW_EX(std::invalid_argument, "Element-wise tensor rank exceeds MLAS_ELTWISE_MAXIMUM_RANK");
+    }
+
+    //
+    // Collapse the shape by dropping unit dimensions and merging each
+    // dimension into the previous dimension when all inputs are contiguous
+    // across the pair. Dimensions broadcast for all inputs always merge.
+    //
+
+    size_t CollapsedRank = 0;
+    size_t TotalElements = 1;
+
+    for (size_t d = 0; d < Rank; d++) {
+
+        const size_t Size = OutputShape[d];
+        const size_t StrideCondition = (StridesCondition != nullptr) ? StridesCondition[d] : 0;
+
+        TotalElements *= Size;
+
+        if (Size == 1) {
+            continue;
+        }
+
+        if (CollapsedRank > 0 &&
+            WorkBlock.StridesCondition[CollapsedRank - 1] == StrideCondition * Size &&
+            WorkBlock.StridesA[CollapsedRank - 1] == StridesA[d] * Size &&
+            WorkBlock.StridesB[CollapsedRank - 1] == StridesB[d] * Size) {
+
+            WorkBlock.Shape[CollapsedRank - 1] *= Size;
+            WorkBlock.StridesCondition[CollapsedRank - 1] = StrideCondition;
+            WorkBlock.StridesA[CollapsedRank - 1] = StridesA[d];
+            WorkBlock.StridesB[CollapsedRank - 1] = StridesB[d];
+
+        } else {
+
+            WorkBlock.Shape[CollapsedRank] = Size;
+            WorkBlock.StridesCondition[CollapsedRank] = StrideCondition;
+            WorkBlock.StridesA[CollapsedRank] = StridesA[d];
+            WorkBlock.StridesB[CollapsedRank] = StridesB[d];
+            CollapsedRank++;
+        }
+    }
+
+    if (TotalElements == 0) {
+        return;
+    }
+
+    if (CollapsedRank == 0) {
+        WorkBlock.Shape[0] = 1;
+        WorkBlock.StridesCondition[0] = 0;
+        WorkBlock.StridesA[0] = 0;
+        WorkBlock.StridesB[0] = 0;
+        CollapsedRank = 1;
+    }
+
+    WorkBlock.Rank = CollapsedRank;
+    WorkBlock.TotalElements = TotalElements;
+
+    //
+    // Compute the number of target threads given the number of output
+    // elements.
+    //
+
+    const size_t Complexity = TotalElements * ElementComplexity;
+
+    ptrdiff_t ThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    const size_t BlockCount = (Complexity / MLAS_ELTWISE_THREAD_COMPLEXITY) + 1;
+
+    if (size_t(ThreadCount) > BlockCount) {
+        ThreadCount = ptrdiff_t(BlockCount);
+    }
+
+    WorkBlock.ThreadCount = ThreadCount;
+
+    MlasExecuteThreaded(MlasEltwiseThreaded<T>, &WorkBlock, ThreadCount, ThreadPool);
+}
+
+template<typename T>
+struct MLAS_ELTWISE_ROW_DISPATCH
+{
+    template<MLAS_ELTWISE_BINARY_KIND Kind>
+    static constexpr auto Routine = &MlasEltwiseRow<Kind, T>;
+};
+
+template<>
+struct MLAS_ELTWISE_ROW_DISPATCH<MLAS_FP16>
+{
+    template<MLAS_ELTWISE_BINARY_KIND Kind>
+    static constexpr auto Routine = &MlasEltwiseRowHalf<Kind>;
+};
+
+template<typename T>
+void
+MLASCALL
+MlasEltwiseBinary(
+    MLAS_ELTWISE_BINARY_KIND Kind,
+    size_t Rank,
+    const size_t* OutputShape,
+    const T* A,
+    const size_t* StridesA,
+    const T* B,
+    const size_t* StridesB,
+    T* C,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine computes C = op(A, B) for tensors with N-D broadcasting.
+
+Arguments:
+
+    Kind - Supplies the binary operation.
+
+    Rank - Supplies the rank of the output tensor.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    A - Supplies the first input tensor.
+
+    StridesA - Supplies the element strides of the first input for each output
+        dimension, zero for broadcast dimensions.
+
+    B - Supplies the second input tensor.
+
+    StridesB - Supplies the element strides of the second input for each
+        output dimension, zero for broadcast dimensions.
+
+    C - Supplies the contiguous output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_ELTWISE_WORK_BLOCK<T> WorkBlock;
+
+    switch (Kind) {
+        case MlasEltwiseAdd:
+            WorkBlock.RowRoutine = MLAS_ELTWISE_ROW_DISPATCH<T>::template Routine<MlasEltwiseAdd>;
+            break;
+        case MlasEltwiseSub:
+            WorkBlock.RowRoutine = MLAS_ELTWISE_ROW_DISPATCH<T>::template Routine<MlasEltwiseSub>;
+            break;
+        case MlasEltwiseMul:
+            WorkBlock.RowRoutine = MLAS_ELTWISE_ROW_DISPATCH<T>::template Routine<MlasEltwiseMul>;
+            break;
+        case MlasEltwiseDiv:
+            WorkBlock.RowRoutine = MLAS_ELTWISE_ROW_DISPATCH<T>::template Routine<MlasEltwiseDiv>;
+            break;
+        case MlasEltwiseMin:
+            WorkBlock.RowRoutine = MLAS_ELTWISE_ROW_DISPATCH<T>::template Routine<MlasEltwiseMin>;
+            break;
+        case MlasEltwiseMax:
+            WorkBlock.RowRoutine = MLAS_ELTWISE_ROW_DISPATCH<T>::template Routine<MlasEltwiseMax>;
+            break;
+        case MlasEltwisePow:
+            if constexpr (std::is_integral<T>::value) {
+                MLAS_THROW_EX(std::invalid_argument, "Element-wise Pow is not supported for integer types");
+            } else {
+                WorkBlock.RowRoutine = MLAS_ELTWISE_ROW_DISPATCH<T>::template Routine<MlasEltwisePow>;
+            }
+            break;
+        default:
+            MLAS_THROW_EX(std::invalid_argument, "Unknown element-wise operation");
+    }
+
+#if defined(MLAS_TARGET_AMD64)
+
+    //
+    // Use the wider single precision row kernels of the platform if the
+    // operation has a vector form.
+    //
+
+    if constexpr (std::is_same<T, float>::value) {
+
+        const MLAS_ELTWISE_BINARY_FLOAT_DISPATCH* Dispatch = GetMlasPlatform().EltwiseBinaryFloatDispatch;
+
+        if (Dispatch != nullptr && Kind != MlasEltwisePow) {
+            WorkBlock.RowRoutine = Dispatch->Kernels[Kind];
+        }
+    }
+
+#endif
+
+    WorkBlock.Condition = nullptr;
+    WorkBlock.A = A;
+    WorkBlock.B = B;
+    WorkBlock.C = C;
+
+    //
+    // Division, Pow and fp16 are weighted as more expensive per element.
+    //
+
+    size_t ElementComplexity = 1;
+
+    if (Kind == MlasEltwiseDiv || std::is_same<T, MLAS_FP16>::value) {
+        ElementComplexity = 4;
+    } else if (Kind == MlasEltwisePow) {
+        ElementComplexity = 16;
+    }
+
+    MlasEltwiseExecute(WorkBlock, Rank, OutputShape, nullptr, StridesA, StridesB, ElementComplexity, ThreadPool);
+}
+
+template<typename T>
+void
+MLASCALL
+MlasEltwiseSelect(
+    size_t Rank,
+    const size_t* OutputShape,
+    const bool* Condition,
+    const size_t* StridesCondition,
+    const T* A,
+    const size_t* StridesA,
+    const T* B,
+    const size_t* StridesB,
+    T* C,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine computes C = Condition ? A : B for tensors with N-D
+    broadcasting.
+
+Arguments:
+
+    Rank - Supplies the rank of the output tensor.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    Condition - Supplies the condition tensor.
+
+    StridesCondition - Supplies the element strides of the condition for each
+        output dimension, zero for broadcast dimensions.
+
+    A - Supplies the tensor selected where the condition is true.
+
+    StridesA - Supplies the element strides of A for each output dimension,
+        zero for broadcast dimensions.
+
+    B - Supplies the tensor selected where the condition is false.
+
+    StridesB - Supplies the element strides of B for each output dimension,
+        zero for broadcast dimensions.
+
+    C - Supplies the contiguous output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_ELTWISE_WORK_BLOCK<T> WorkBlock;
+
+    WorkBlock.RowRoutine = nullptr;
+    WorkBlock.Condition = Condition;
+    WorkBlock.A = A;
+    WorkBlock.B = B;
+    WorkBlock.C = C;
+
+    MlasEltwiseExecute(WorkBlock, Rank, OutputShape, StridesCondition, StridesA, StridesB, 1, ThreadPool);
+}
+
+template
+void
+MLASCALL
+MlasEltwiseBinary<float>(
+    MLAS_ELTWISE_BINARY_KIND Kind,
+    size_t Rank,
+    const size_t* OutputShape,
+    const float* A,
+    const size_t* StridesA,
+    const float* B,
+    const size_t* StridesB,
+    float* C,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasEltwiseBinary<MLAS_FP16>(
+    MLAS_ELTWISE_BINARY_KIND Kind,
+    size_t Rank,
+    const size_t* OutputShape,
+    const MLAS_FP16* A,
+    const size_t* StridesA,
+    const MLAS_FP16* B,
+    const size_t* StridesB,
+    MLAS_FP16* C,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasEltwiseBinary<int32_t>(
+    MLAS_ELTWISE_BINARY_KIND Kind,
+    size_t Rank,
+    const size_t* OutputShape,
+    const int32_t* A,
+    const size_t* StridesA,
+    const int32_t* B,
+    const size_t* StridesB,
+    int32_t* C,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasEltwiseBinary<int64_t>(
+    MLAS_ELTWISE_BINARY_KIND Kind,
+    size_t Rank,
+    const size_t* OutputShape,
+    const int64_t* A,
+    const size_t* StridesA,
+    const int64_t* B,
+    const size_t* StridesB,
+    int64_t* C,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasEltwiseSelect<float>(
+    size_t Rank,
+    const size_t* OutputShape,
+    const bool* Condition,
+    const size_t* StridesCondition,
+    const float* A,
+    const size_t* StridesA,
+    const float* B,
+    const size_t* StridesB,
+    float* C,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasEltwiseSelect<int32_t>(
+    size_t Rank,
+    const size_t* OutputShape,
+    const bool* Condition,
+    const size_t* StridesCondition,
+    const int32_t* A,
+    const size_t* StridesA,
+    const int32_t* B,
+    const size_t* StridesB,
+    int32_t* C,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasEltwiseSelect<int64_t>(
+    size_t Rank,
+    const size_t* OutputShape,
+    const bool* Condition,
+    const size_t* StridesCondition,
+    const int64_t* A,
+    const size_t* StridesA,
+    const int64_t* B,
+    const size_t* StridesB,
+    int64_t* C,
+    MLAS_THREADPOOL* ThreadPool
+    );
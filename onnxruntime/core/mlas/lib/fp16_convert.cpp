@@ -0,0 +1,153 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    fp16_convert.cpp
+
+Abstract:
+
+    This module implements the block conversions between half and single
+    precision that are shared by the routines which process half precision
+    rows in single precision blocks.
+
+    These are branch free forms of MLAS_Half2Float and MLAS_Float2Half so
+    that the compiler can vectorize the loops on all targets.
+
+--*/
+
+#include "mlasi.h"
+
+void
+MLASCALL
+MlasConvertHalfToFloatBlock(
+    const MLAS_FP16* Source,
+    float* Destination,
+    size_t Count
+    )
+/*++
+
+Routine Description:
+
+    This routine converts a block of half precision values to single
+    precision.
+
+    The exponent is rebiased by a floating point multiply, which also
+    normalizes denormal values, and infinity/NaN values are selected with a
+    mask. The loop has no branches so that the compiler can vectorize it.
+
+Arguments:
+
+    Source - Supplies the half precision values.
+
+    Destination - Supplies the single precision values.
+
+    Count - Supplies the number of elements.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const uint16_t* source = reinterpret_cast<const uint16_t*>(Source);
+
+    constexpr uint32_t ShiftedExponent = 0x7c00 << 13;
+    constexpr float ExponentAdjust = 5.192296858534828e+33f;  // 2^112
+
+    for (size_t i = 0; i < Count; i++) {
+
+        const uint32_t h = source[i];
+        const uint32_t ExponentMantissa = (h & 0x7fff) << 13;
+
+        float Value;
+        std::memcpy(&Value, &ExponentMantissa, sizeof(Value));
+        Value *= ExponentAdjust;
+
+        uint32_t Bits;
+        std::memcpy(&Bits, &Value, sizeof(Bits));
+        Bits |= (0u - uint32_t(ExponentMantissa >= ShiftedExponent)) & 0x7f800000;
+        Bits |= (h & 0x8000) << 16;
+
+        std::memcpy(&Destination[i], &Bits, sizeof(Bits));
+    }
+}
+
+void
+MLASCALL
+MlasConvertFloatToHalfBlock(
+    const float* Source,
+    MLAS_FP16* Destination,
+    size_t Count
+    )
+/*++
+
+Routine Description:
+
+    This routine converts a block of single precision values to half
+    precision with round to nearest even.
+
+    The normal, denormal and infinity/NaN results are all computed and then
+    selected with masks. The loop has no branches so that the compiler can
+    vectorize it.
+
+Arguments:
+
+    Source - Supplies the single precision values.
+
+    Destination - Supplies the half precision values.
+
+    Count - Supplies the number of elements.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    uint16_t* destination = reinterpret_cast<uint16_t*>(Destination);
+
+    constexpr uint32_t Infinity32 = 255 << 23;
+    constexpr uint32_t Maximum16 = (127 + 16) << 23;
+    constexpr uint32_t MinimumNormal16 = 113 << 23;
+    constexpr uint32_t DenormalMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+    constexpr float DenormalMagicValue = 0.5f;
+
+    for (size_t i = 0; i < Count; i++) {
+
+        uint32_t Magnitude;
+        std::memcpy(&Magnitude, &Source[i], sizeof(Magnitude));
+
+        const uint32_t Sign = Magnitude & 0x80000000u;
+        Magnitude ^= Sign;
+
+        float DenormalValue;
+        std::memcpy(&DenormalValue, &Magnitude, sizeof(DenormalValue));
+        DenormalValue += DenormalMagicValue;
+        uint32_t Denormal;
+        std::memcpy(&Denormal, &DenormalValue, sizeof(Denormal));
+        Denormal -= DenormalMagic;
+
+        const uint32_t Normal = (Magnitude + ((uint32_t)(15 - 127) << 23) + 0xfff + ((Magnitude >> 13) & 1)) >> 13;
+
+        //
+        // The magnitude has the sign bit cleared, so signed comparisons are
+        // used as these map directly to vector instructions.
+        //
+
+        const int32_t SignedMagnitude = int32_t(Magnitude);
+
+        const uint32_t Special = 0x7c00 | (uint32_t(SignedMagnitude > int32_t(Infinity32)) << 9);
+
+        const uint32_t DenormalMask = 0u - uint32_t(SignedMagnitude < int32_t(MinimumNormal16));
+        const uint32_t SpecialMask = 0u - uint32_t(SignedMagnitude >= int32_t(Maximum16));
+
+        uint32_t Value = (Denormal & DenormalMask) | (Normal & ~DenormalMask);
+        Value = (Special & SpecialMask) | (Value & ~SpecialMask);
+
+        destination[i] = uint16_t(Value | (Sign >> 16));
+    }
+}
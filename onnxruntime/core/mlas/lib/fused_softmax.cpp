@@ -0,0 +1,353 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    fused_softmax.cpp
+
+Abstract:
+
+    This module implements the fused attention softmax operation.
+
+    The attention operators scale the scores, add the attention mask and the
+    attention bias, and then apply a softmax over each query row. Done as
+    separate operations, each step is another pass over the full scores
+    buffer. This implementation applies the scale, the additive inputs and
+    the causal mask while finding the row maximum, so the scores are read
+    from memory once and the remaining softmax steps run on a row that is
+    still in the cache.
+
+--*/
+
+#include "mlasi.h"
+#include "mlas_float16.h"
+
+#include <vector>
+
+//
+// Define the number of score elements each thread should process before
+// using another thread.
+//
+
+constexpr size_t MLAS_FUSED_SOFTMAX_THREAD_COMPLEXITY = 16384;
+
+template<typename T>
+struct MLAS_FUSED_SOFTMAX_WORK_BLOCK {
+    const float* Input;
+    T* Output;
+    const MLAS_FUSED_SOFTMAX_PARAMS* Params;
+    size_t Rows;
+    ptrdiff_t ThreadCount;
+};
+
+typedef
+float
+(MLAS_FUSED_SOFTMAX_PREPARE_ROW_ROUTINE)(
+    const float* Input,
+    const float* Mask,
+    const float* Bias,
+    float* Row,
+    size_t N,
+    float Scale
+    );
+
+template<bool HasMask, bool HasBias>
+float
+MlasFusedSoftmaxPrepareRow(
+    const float* Input,
+    const float* Mask,
+    const float* Bias,
+    float* Row,
+    size_t N,
+    float Scale
+    )
+/*++
+
+Routine Description:
+
+    This routine computes Scale * Input + Mask + Bias for a row of scores and
+    returns the maximum of the row.
+
+Arguments:
+
+    Input - Supplies the scores of the row.
+
+    Mask - Supplies the additive mask of the row if HasMask is true.
+
+    Bias - Supplies the additive bias of the row if HasBias is true.
+
+    Row - Supplies the output row, which may alias the input.
+
+    N - Supplies the number of elements of the row.
+
+    Scale - Supplies the multiplier applied to the scores.
+
+Return Value:
+
+    Returns the maximum value of the output row.
+
+--*/
+{
+    const MLAS_FLOAT32X4 ScaleVector = MlasBroadcastFloat32x4(Scale);
+    MLAS_FLOAT32X4 MaximumVector = MlasBroadcastFloat32x4(std::numeric_limits<float>::lowest());
+
+    size_t i = 0;
+
+    for (; i + 4 <= N; i += 4) {
+
+        MLAS_FLOAT32X4 Vector = MlasMultiplyFloat32x4(MlasLoadFloat32x4(Input + i), ScaleVector);
+
+        if constexpr (HasMask) {
+            Vector = MlasAddFloat32x4(Vector, MlasLoadFloat32x4(Mask + i));
+        }
+
+        if constexpr (HasBias) {
+            Vector = MlasAddFloat32x4(Vector, MlasLoadFloat32x4(Bias + i));
+        }
+
+        MaximumVector = MlasMaximumFloat32x4(MaximumVector, Vector);
+        MlasStoreFloat32x4(Row + i, Vector);
+    }
+
+    float Maximum = MlasReduceMaximumFloat32x4(MaximumVector);
+
+    for (; i < N; i++) {
+
+        float Value = Input[i] * Scale;
+
+        if constexpr (HasMask) {
+            Value += Mask[i];
+        }
+
+        if constexpr (HasBias) {
+            Value += Bias[i];
+        }
+
+        Maximum = std::max(Maximum, Value);
+        Row[i] = Value;
+    }
+
+    return Maximum;
+}
+
+template<typename T>
+void
+MlasComputeFusedSoftmaxThreaded(
+    void* Context,
+    ptrdiff_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    fused softmax operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (MLAS_FUSED_SOFTMAX_WORK_BLOCK<T>*)Context;
+    const MLAS_FUSED_SOFTMAX_PARAMS& Params = *WorkBlock->Params;
+
+    size_t RowStart;
+    size_t RowCount;
+
+    MlasPartitionWork(Index, WorkBlock->ThreadCount, WorkBlock->Rows, &RowStart, &RowCount);
+
+    const size_t S = Params.SequenceLength;
+    const size_t D = Params.TotalSequenceLength;
+
+    const MLAS_SOFTMAX_ADDEND& Mask = Params.Mask;
+    const MLAS_SOFTMAX_ADDEND& Bias = Params.Bias;
+
+    static MLAS_FUSED_SOFTMAX_PREPARE_ROW_ROUTINE* const PrepareRowRoutines[2][2] = {
+        {MlasFusedSoftmaxPrepareRow<false, false>, MlasFusedSoftmaxPrepareRow<false, true>},
+        {MlasFusedSoftmaxPrepareRow<true, false>, MlasFusedSoftmaxPrepareRow<true, true>},
+    };
+
+    MLAS_FUSED_SOFTMAX_PREPARE_ROW_ROUTINE* PrepareRow =
+        PrepareRowRoutines[Mask.Data != nullptr][Bias.Data != nullptr];
+
+    //
+    // Half precision outputs are computed in a single precision row buffer
+    // and converted once normalized.
+    //
+
+    std::vector<float> RowBuffer;
+
+    if constexpr (!std::is_same<T, float>::value) {
+        RowBuffer.resize(D);
+    }
+
+    for (size_t r = RowStart; r < RowStart + RowCount; r++) {
+
+        const size_t s = r % S;
+        const size_t h = (r / S) % Params.HeadCount;
+        const size_t b = r / (S * Params.HeadCount);
+
+        const float* MaskRow = nullptr;
+        const float* BiasRow = nullptr;
+
+        if (Mask.Data != nullptr) {
+            MaskRow = Mask.Data + b * Mask.BatchStride + h * Mask.HeadStride + s * Mask.RowStride;
+        }
+
+        if (Bias.Data != nullptr) {
+            BiasRow = Bias.Data + b * Bias.BatchStride + h * Bias.HeadStride + s * Bias.RowStride;
+        }
+
+        //
+        // A causal query row attends to the past and to the query rows up to
+        // and including itself.
+        //
+
+        size_t N = D;
+
+        if (Params.Causal) {
+            N = std::min(D, Params.PastSequenceLength + s + 1);
+        }
+
+        T* Output = WorkBlock->Output + r * D;
+        float* Row;
+
+        if constexpr (std::is_same<T, float>::value) {
+            Row = Output;
+        } else {
+            Row = RowBuffer.data();
+        }
+
+        float Maximum = PrepareRow(WorkBlock->Input + r * D, MaskRow, BiasRow, Row, N, Params.Scale);
+        float NegativeMaximum = -Maximum;
+
+#if defined(MLAS_TARGET_AMD64)
+        float Accumulation = GetMlasPlatform().ComputeSumExpF32Kernel(Row, Row, N, &NegativeMaximum);
+#else
+        float Accumulation = MlasComputeSumExpF32Kernel(Row, Row, N, &NegativeMaximum);
+#endif
+
+        float Parameters[] = { 1.0f / Accumulation };
+
+        if constexpr (std::is_same<T, float>::value) {
+
+#if defined(MLAS_TARGET_AMD64)
+            GetMlasPlatform().ComputeSoftmaxOutputF32Kernel(Row, N, Parameters);
+#else
+            MlasComputeSoftmaxOutputF32Kernel(Row, N, Parameters);
+#endif
+
+            std::fill_n(Output + N, D - N, 0.0f);
+
+        } else {
+
+            for (size_t i = 0; i < N; i++) {
+                Output[i].val = MLAS_Float2Half(Row[i] * Parameters[0]);
+            }
+
+            for (size_t i = N; i < D; i++) {
+                Output[i].val = 0;
+            }
+        }
+    }
+}
+
+template<typename T>
+void
+MLASCALL
+MlasComputeFusedSoftmax(
+    const float* Input,
+    T* Output,
+    const MLAS_FUSED_SOFTMAX_PARAMS& Params,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine computes Softmax(Scale * Input + Mask + Bias) over each query
+    row of the attention scores, with an optional causal mask.
+
+Arguments:
+
+    Input - Supplies the scores.
+
+    Output - Supplies the probabilities. A single precision output may alias
+        the input.
+
+    Params - Supplies the shape, scale and masking parameters.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t Rows = Params.BatchCount * Params.HeadCount * Params.SequenceLength;
+    const size_t D = Params.TotalSequenceLength;
+
+    if (Rows == 0 || D == 0) {
+        return;
+    }
+
+    MLAS_FUSED_SOFTMAX_WORK_BLOCK<T> WorkBlock;
+
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+    WorkBlock.Params = &Params;
+    WorkBlock.Rows = Rows;
+
+    //
+    // Compute the number of target threads given the number of score
+    // elements, limited to the number of rows.
+    //
+
+    ptrdiff_t ThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (size_t(ThreadCount) > Rows) {
+        ThreadCount = ptrdiff_t(Rows);
+    }
+
+    const size_t TargetThreadCount = (Rows * D / MLAS_FUSED_SOFTMAX_THREAD_COMPLEXITY) + 1;
+
+    if (size_t(ThreadCount) > TargetThreadCount) {
+        ThreadCount = ptrdiff_t(TargetThreadCount);
+    }
+
+    WorkBlock.ThreadCount = ThreadCount;
+
+    MlasExecuteThreaded(MlasComputeFusedSoftmaxThreaded<T>, &WorkBlock, ThreadCount, ThreadPool);
+}
+
+template
+void
+MLASCALL
+MlasComputeFusedSoftmax<float>(
+    const float* Input,
+    float* Output,
+    const MLAS_FUSED_SOFTMAX_PARAMS& Params,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasComputeFusedSoftmax<MLAS_FP16>(
+    const float* Input,
+    MLAS_FP16* Output,
+    const MLAS_FUSED_SOFTMAX_PARAMS& Params,
+    MLAS_THREADPOOL* ThreadPool
+    );
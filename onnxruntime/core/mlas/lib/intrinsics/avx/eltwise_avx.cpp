@@ -0,0 +1,235 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    eltwise_avx.cpp
+
+Abstract:
+
+    This module implements the single precision element-wise binary row
+    kernels with AVX instructions.
+
+    The kernels follow MlasEltwiseRow in eltwise.cpp, with 256-bit vectors
+    and masked loads and stores for the tail of a row. The minimum and
+    maximum operations keep the operand order of the SSE kernels, so a NaN
+    in either input gives the second input.
+
+--*/
+
+#include "mlasi.h"
+
+template<MLAS_ELTWISE_BINARY_KIND Kind>
+MLAS_FORCEINLINE
+__m256
+MlasEltwiseVectorAvx(
+    __m256 a,
+    __m256 b
+    )
+{
+    if constexpr (Kind == MlasEltwiseAdd) {
+        return _mm256_add_ps(a, b);
+    } else if constexpr (Kind == MlasEltwiseSub) {
+        return _mm256_sub_ps(a, b);
+    } else if constexpr (Kind == MlasEltwiseMul) {
+        return _mm256_mul_ps(a, b);
+    } else if constexpr (Kind == MlasEltwiseDiv) {
+        return _mm256_div_ps(a, b);
+    } else if constexpr (Kind == MlasEltwiseMin) {
+        return _mm256_min_ps(a, b);
+    } else {
+        static_assert(Kind == MlasEltwiseMax, "unsupported float vector operation");
+        return _mm256_max_ps(a, b);
+    }
+}
+
+MLAS_FORCEINLINE
+__m256i
+MlasEltwiseTailMaskAvx(
+    size_t N
+    )
+{
+    const __m256 Index = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+
+    return _mm256_castps_si256(_mm256_cmp_ps(Index, _mm256_set1_ps(float(N)), _CMP_LT_OQ));
+}
+
+template<MLAS_ELTWISE_BINARY_KIND Kind>
+void
+MLASCALL
+MlasEltwiseBinaryFloatKernelAvx(
+    const float* A,
+    size_t StrideA,
+    const float* B,
+    size_t StrideB,
+    float* C,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the binary operation for one row of the innermost
+    dimension.
+
+Arguments:
+
+    A - Supplies the first input row.
+
+    StrideA - Supplies the element stride of the first input, zero if the
+        input is broadcast along the row.
+
+    B - Supplies the second input row.
+
+    StrideB - Supplies the element stride of the second input, zero if the
+        input is broadcast along the row.
+
+    C - Supplies the contiguous output row.
+
+    N - Supplies the number of elements in the row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (StrideA == 1 && StrideB == 1) {
+
+        while (N >= 32) {
+
+            __m256 c0 = MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A), _mm256_loadu_ps(B));
+            __m256 c1 = MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A + 8), _mm256_loadu_ps(B + 8));
+            __m256 c2 = MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A + 16), _mm256_loadu_ps(B + 16));
+            __m256 c3 = MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A + 24), _mm256_loadu_ps(B + 24));
+
+            _mm256_storeu_ps(C, c0);
+            _mm256_storeu_ps(C + 8, c1);
+            _mm256_storeu_ps(C + 16, c2);
+            _mm256_storeu_ps(C + 24, c3);
+
+            A += 32;
+            B += 32;
+            C += 32;
+            N -= 32;
+        }
+
+        while (N >= 8) {
+
+            _mm256_storeu_ps(C, MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A), _mm256_loadu_ps(B)));
+
+            A += 8;
+            B += 8;
+            C += 8;
+            N -= 8;
+        }
+
+        if (N > 0) {
+
+            const __m256i Mask = MlasEltwiseTailMaskAvx(N);
+
+            _mm256_maskstore_ps(C, Mask, MlasEltwiseVectorAvx<Kind>(_mm256_maskload_ps(A, Mask),
+                                                                    _mm256_maskload_ps(B, Mask)));
+        }
+
+    } else if (StrideA == 0 && StrideB == 1) {
+
+        const __m256 va = _mm256_broadcast_ss(A);
+
+        while (N >= 32) {
+
+            __m256 c0 = MlasEltwiseVectorAvx<Kind>(va, _mm256_loadu_ps(B));
+            __m256 c1 = MlasEltwiseVectorAvx<Kind>(va, _mm256_loadu_ps(B + 8));
+            __m256 c2 = MlasEltwiseVectorAvx<Kind>(va, _mm256_loadu_ps(B + 16));
+            __m256 c3 = MlasEltwiseVectorAvx<Kind>(va, _mm256_loadu_ps(B + 24));
+
+            _mm256_storeu_ps(C, c0);
+            _mm256_storeu_ps(C + 8, c1);
+            _mm256_storeu_ps(C + 16, c2);
+            _mm256_storeu_ps(C + 24, c3);
+
+            B += 32;
+            C += 32;
+            N -= 32;
+        }
+
+        while (N >= 8) {
+
+            _mm256_storeu_ps(C, MlasEltwiseVectorAvx<Kind>(va, _mm256_loadu_ps(B)));
+
+            B += 8;
+            C += 8;
+            N -= 8;
+        }
+
+        if (N > 0) {
+
+            const __m256i Mask = MlasEltwiseTailMaskAvx(N);
+
+            _mm256_maskstore_ps(C, Mask, MlasEltwiseVectorAvx<Kind>(va, _mm256_maskload_ps(B, Mask)));
+        }
+
+    } else if (StrideA == 1 && StrideB == 0) {
+
+        const __m256 vb = _mm256_broadcast_ss(B);
+
+        while (N >= 32) {
+
+            __m256 c0 = MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A), vb);
+            __m256 c1 = MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A + 8), vb);
+            __m256 c2 = MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A + 16), vb);
+            __m256 c3 = MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A + 24), vb);
+
+            _mm256_storeu_ps(C, c0);
+            _mm256_storeu_ps(C + 8, c1);
+            _mm256_storeu_ps(C + 16, c2);
+            _mm256_storeu_ps(C + 24, c3);
+
+            A += 32;
+            C += 32;
+            N -= 32;
+        }
+
+        while (N >= 8) {
+
+            _mm256_storeu_ps(C, MlasEltwiseVectorAvx<Kind>(_mm256_loadu_ps(A), vb));
+
+            A += 8;
+            C += 8;
+            N -= 8;
+        }
+
+        if (N > 0) {
+
+            const __m256i Mask = MlasEltwiseTailMaskAvx(N);
+
+            _mm256_maskstore_ps(C, Mask, MlasEltwiseVectorAvx<Kind>(_mm256_maskload_ps(A, Mask), vb));
+        }
+
+    } else {
+
+        //
+        // Compute each element from broadcast vectors so that the operand
+        // order and NaN rule match the vector loops.
+        //
+
+        for (size_t n = 0; n < N; n++) {
+            C[n] = _mm256_cvtss_f32(MlasEltwiseVectorAvx<Kind>(_mm256_set1_ps(A[n * StrideA]),
+                                                               _mm256_set1_ps(B[n * StrideB])));
+        }
+    }
+}
+
+const MLAS_ELTWISE_BINARY_FLOAT_DISPATCH MlasEltwiseBinaryFloatDispatchAvx = {
+    {
+        MlasEltwiseBinaryFloatKernelAvx<MlasEltwiseAdd>,
+        MlasEltwiseBinaryFloatKernelAvx<MlasEltwiseSub>,
+        MlasEltwiseBinaryFloatKernelAvx<MlasEltwiseMul>,
+        MlasEltwiseBinaryFloatKernelAvx<MlasEltwiseDiv>,
+        MlasEltwiseBinaryFloatKernelAvx<MlasEltwiseMin>,
+        MlasEltwiseBinaryFloatKernelAvx<MlasEltwiseMax>,
+    }
+};
@@ -0,0 +1,222 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    eltwise_avx512f.cpp
+
+Abstract:
+
+    This module implements the single precision element-wise binary row
+    kernels with AVX512F instructions.
+
+    The kernels follow MlasEltwiseRow in eltwise.cpp, with 512-bit vectors
+    and opmask loads and stores for the tail of a row.
+
+--*/
+
+#include "mlasi.h"
+
+template<MLAS_ELTWISE_BINARY_KIND Kind>
+MLAS_FORCEINLINE
+__m512
+MlasEltwiseVectorAvx512F(
+    __m512 a,
+    __m512 b
+    )
+{
+    if constexpr (Kind == MlasEltwiseAdd) {
+        return _mm512_add_ps(a, b);
+    } else if constexpr (Kind == MlasEltwiseSub) {
+        return _mm512_sub_ps(a, b);
+    } else if constexpr (Kind == MlasEltwiseMul) {
+        return _mm512_mul_ps(a, b);
+    } else if constexpr (Kind == MlasEltwiseDiv) {
+        return _mm512_div_ps(a, b);
+    } else if constexpr (Kind == MlasEltwiseMin) {
+        return _mm512_min_ps(a, b);
+    } else {
+        static_assert(Kind == MlasEltwiseMax, "unsupported float vector operation");
+        return _mm512_max_ps(a, b);
+    }
+}
+
+template<MLAS_ELTWISE_BINARY_KIND Kind>
+void
+MLASCALL
+MlasEltwiseBinaryFloatKernelAvx512F(
+    const float* A,
+    size_t StrideA,
+    const float* B,
+    size_t StrideB,
+    float* C,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the binary operation for one row of the innermost
+    dimension.
+
+Arguments:
+
+    A - Supplies the first input row.
+
+    StrideA - Supplies the element stride of the first input, zero if the
+        input is broadcast along the row.
+
+    B - Supplies the second input row.
+
+    StrideB - Supplies the element stride of the second input, zero if the
+        input is broadcast along the row.
+
+    C - Supplies the contiguous output row.
+
+    N - Supplies the number of elements in the row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (StrideA == 1 && StrideB == 1) {
+
+        while (N >= 64) {
+
+            __m512 c0 = MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A), _mm512_loadu_ps(B));
+            __m512 c1 = MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A + 16), _mm512_loadu_ps(B + 16));
+            __m512 c2 = MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A + 32), _mm512_loadu_ps(B + 32));
+            __m512 c3 = MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A + 48), _mm512_loadu_ps(B + 48));
+
+            _mm512_storeu_ps(C, c0);
+            _mm512_storeu_ps(C + 16, c1);
+            _mm512_storeu_ps(C + 32, c2);
+            _mm512_storeu_ps(C + 48, c3);
+
+            A += 64;
+            B += 64;
+            C += 64;
+            N -= 64;
+        }
+
+        while (N >= 16) {
+
+            _mm512_storeu_ps(C, MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A), _mm512_loadu_ps(B)));
+
+            A += 16;
+            B += 16;
+            C += 16;
+            N -= 16;
+        }
+
+        if (N > 0) {
+
+            const __mmask16 Mask = __mmask16((1u << N) - 1);
+
+            _mm512_mask_storeu_ps(C, Mask, MlasEltwiseVectorAvx512F<Kind>(_mm512_maskz_loadu_ps(Mask, A),
+                                                                          _mm512_maskz_loadu_ps(Mask, B)));
+        }
+
+    } else if (StrideA == 0 && StrideB == 1) {
+
+        const __m512 va = _mm512_set1_ps(*A);
+
+        while (N >= 64) {
+
+            __m512 c0 = MlasEltwiseVectorAvx512F<Kind>(va, _mm512_loadu_ps(B));
+            __m512 c1 = MlasEltwiseVectorAvx512F<Kind>(va, _mm512_loadu_ps(B + 16));
+            __m512 c2 = MlasEltwiseVectorAvx512F<Kind>(va, _mm512_loadu_ps(B + 32));
+            __m512 c3 = MlasEltwiseVectorAvx512F<Kind>(va, _mm512_loadu_ps(B + 48));
+
+            _mm512_storeu_ps(C, c0);
+            _mm512_storeu_ps(C + 16, c1);
+            _mm512_storeu_ps(C + 32, c2);
+            _mm512_storeu_ps(C + 48, c3);
+
+            B += 64;
+            C += 64;
+            N -= 64;
+        }
+
+        while (N >= 16) {
+
+            _mm512_storeu_ps(C, MlasEltwiseVectorAvx512F<Kind>(va, _mm512_loadu_ps(B)));
+
+            B += 16;
+            C += 16;
+            N -= 16;
+        }
+
+        if (N > 0) {
+
+            const __mmask16 Mask = __mmask16((1u << N) - 1);
+
+            _mm512_mask_storeu_ps(C, Mask, MlasEltwiseVectorAvx512F<Kind>(va, _mm512_maskz_loadu_ps(Mask, B)));
+        }
+
+    } else if (StrideA == 1 && StrideB == 0) {
+
+        const __m512 vb = _mm512_set1_ps(*B);
+
+        while (N >= 64) {
+
+            __m512 c0 = MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A), vb);
+            __m512 c1 = MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A + 16), vb);
+            __m512 c2 = MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A + 32), vb);
+            __m512 c3 = MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A + 48), vb);
+
+            _mm512_storeu_ps(C, c0);
+            _mm512_storeu_ps(C + 16, c1);
+            _mm512_storeu_ps(C + 32, c2);
+            _mm512_storeu_ps(C + 48, c3);
+
+            A += 64;
+            C += 64;
+            N -= 64;
+        }
+
+        while (N >= 16) {
+
+            _mm512_storeu_ps(C, MlasEltwiseVectorAvx512F<Kind>(_mm512_loadu_ps(A), vb));
+
+            A += 16;
+            C += 16;
+            N -= 16;
+        }
+
+        if (N > 0) {
+
+            const __mmask16 Mask = __mmask16((1u << N) - 1);
+
+            _mm512_mask_storeu_ps(C, Mask, MlasEltwiseVectorAvx512F<Kind>(_mm512_maskz_loadu_ps(Mask, A), vb));
+        }
+
+    } else {
+
+        //
+        // Compute each element from broadcast vectors so that the operand
+        // order and NaN rule match the vector loops.
+        //
+
+        for (size_t n = 0; n < N; n++) {
+            C[n] = _mm512_cvtss_f32(MlasEltwiseVectorAvx512F<Kind>(_mm512_set1_ps(A[n * StrideA]),
+                                                                   _mm512_set1_ps(B[n * StrideB])));
+        }
+    }
+}
+
+const MLAS_ELTWISE_BINARY_FLOAT_DISPATCH MlasEltwiseBinaryFloatDispatchAvx512F = {
+    {
+        MlasEltwiseBinaryFloatKernelAvx512F<MlasEltwiseAdd>,
+        MlasEltwiseBinaryFloatKernelAvx512F<MlasEltwiseSub>,
+        MlasEltwiseBinaryFloatKernelAvx512F<MlasEltwiseMul>,
+        MlasEltwiseBinaryFloatKernelAvx512F<MlasEltwiseDiv>,
+        MlasEltwiseBinaryFloatKernelAvx512F<MlasEltwiseMin>,
+        MlasEltwiseBinaryFloatKernelAvx512F<MlasEltwiseMax>,
+    }
+};
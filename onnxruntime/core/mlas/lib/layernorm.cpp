@@ -0,0 +1,547 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    layernorm.cpp
+
+Abstract:
+
+    This module implements the layer normalization routines, including the
+    root mean square (simplified) variant and the fused residual add used by
+    SkipLayerNormalization.
+
+    The routines make two passes over a row. The first pass optionally adds
+    the skip and bias vectors and accumulates the sum and sum of squares.
+    The second pass applies the normalization with the scale and shift
+    vectors. Half precision rows are processed in single precision blocks.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of elements of a half precision block that is converted
+// to single precision.
+//
+
+constexpr size_t MLAS_LAYER_NORM_HALF_BLOCK_SIZE = 256;
+
+template<bool HasSkip, bool HasBias>
+void
+MlasLayerNormAccumulate(
+    const float* Input,
+    const float* Skip,
+    const float* Bias,
+    float* Output,
+    float* SkipOutput,
+    size_t N,
+    float& Sum,
+    float& SumSquare
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the optional residual sum of the input, skip and
+    bias vectors and accumulates the sum and sum of squares of the result.
+
+Arguments:
+
+    Input - Supplies the input vector.
+
+    Skip - Supplies the skip vector if HasSkip is true.
+
+    Bias - Supplies the bias vector if HasBias is true.
+
+    Output - Supplies the vector that receives the residual sum if HasSkip is
+        true.
+
+    SkipOutput - Optionally supplies a second vector that receives the
+        residual sum.
+
+    N - Supplies the number of elements.
+
+    Sum - Supplies the running sum, updated on return.
+
+    SumSquare - Supplies the running sum of squares, updated on return.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_FLOAT32X4 Sum0 = MlasZeroFloat32x4();
+    MLAS_FLOAT32X4 Sum1 = MlasZeroFloat32x4();
+    MLAS_FLOAT32X4 SumSquare0 = MlasZeroFloat32x4();
+    MLAS_FLOAT32X4 SumSquare1 = MlasZeroFloat32x4();
+
+    size_t n = 0;
+
+    auto LoadValue = [&](size_t i) {
+        MLAS_FLOAT32X4 Value = MlasLoadFloat32x4(Input + i);
+        if constexpr (HasSkip) {
+            Value = MlasAddFloat32x4(Value, MlasLoadFloat32x4(Skip + i));
+            if constexpr (HasBias) {
+                Value = MlasAddFloat32x4(Value, MlasLoadFloat32x4(Bias + i));
+            }
+            MlasStoreFloat32x4(Output + i, Value);
+            if (SkipOutput != nullptr) {
+                MlasStoreFloat32x4(SkipOutput + i, Value);
+            }
+        }
+        return Value;
+    };
+
+    for (; n + 8 <= N; n += 8) {
+
+        MLAS_FLOAT32X4 Value0 = LoadValue(n);
+        MLAS_FLOAT32X4 Value1 = LoadValue(n + 4);
+
+        Sum0 = MlasAddFloat32x4(Sum0, Value0);
+        Sum1 = MlasAddFloat32x4(Sum1, Value1);
+        SumSquare0 = MlasMultiplyAddFloat32x4(Value0, Value0, SumSquare0);
+        SumSquare1 = MlasMultiplyAddFloat32x4(Value1, Value1, SumSquare1);
+    }
+
+    for (; n + 4 <= N; n += 4) {
+
+        MLAS_FLOAT32X4 Value = LoadValue(n);
+
+        Sum0 = MlasAddFloat32x4(Sum0, Value);
+        SumSquare0 = MlasMultiplyAddFloat32x4(Value, Value, SumSquare0);
+    }
+
+    float RowSum = MlasReduceAddFloat32x4(MlasAddFloat32x4(Sum0, Sum1));
+    float RowSumSquare = MlasReduceAddFloat32x4(MlasAddFloat32x4(SumSquare0, SumSquare1));
+
+    for (; n < N; n++) {
+
+        float Value = Input[n];
+
+        if constexpr (HasSkip) {
+            Value += Skip[n];
+            if constexpr (HasBias) {
+                Value += Bias[n];
+            }
+            Output[n] = Value;
+            if (SkipOutput != nullptr) {
+                SkipOutput[n] = Value;
+            }
+        }
+
+        RowSum += Value;
+        RowSumSquare += Value * Value;
+    }
+
+    Sum += RowSum;
+    SumSquare += RowSumSquare;
+}
+
+template<bool HasBeta>
+void
+MlasLayerNormApply(
+    const float* Input,
+    const float* Gamma,
+    const float* Beta,
+    float* Output,
+    size_t N,
+    float Mean,
+    float InvStdDev
+    )
+/*++
+
+Routine Description:
+
+    This routine computes Output = (Input - Mean) * InvStdDev * Gamma + Beta.
+
+Arguments:
+
+    Input - Supplies the input vector. May alias Output.
+
+    Gamma - Supplies the scale vector.
+
+    Beta - Supplies the shift vector if HasBeta is true.
+
+    Output - Supplies the output vector.
+
+    N - Supplies the number of elements.
+
+    Mean - Supplies the mean of the row, zero for the simplified variant.
+
+    InvStdDev - Supplies the inverse standard deviation of the row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_FLOAT32X4 MeanVector = MlasBroadcastFloat32x4(Mean);
+    const MLAS_FLOAT32X4 InvStdDevVector = MlasBroadcastFloat32x4(InvStdDev);
+
+    auto ApplyVector = [&](size_t i) {
+        MLAS_FLOAT32X4 Value = MlasSubtractFloat32x4(MlasLoadFloat32x4(Input + i), MeanVector);
+        MLAS_FLOAT32X4 Scale = MlasMultiplyFloat32x4(MlasLoadFloat32x4(Gamma + i), InvStdDevVector);
+        if constexpr (HasBeta) {
+            Value = MlasMultiplyAddFloat32x4(Value, Scale, MlasLoadFloat32x4(Beta + i));
+        } else {
+            Value = MlasMultiplyFloat32x4(Value, Scale);
+        }
+        MlasStoreFloat32x4(Output + i, Value);
+    };
+
+    size_t n = 0;
+
+    for (; n + 8 <= N; n += 8) {
+        ApplyVector(n);
+        ApplyVector(n + 4);
+    }
+
+    for (; n + 4 <= N; n += 4) {
+        ApplyVector(n);
+    }
+
+    for (; n < N; n++) {
+        float Value = (Input[n] - Mean) * (Gamma[n] * InvStdDev);
+        if constexpr (HasBeta) {
+            Value += Beta[n];
+        }
+        Output[n] = Value;
+    }
+}
+
+void
+MlasLayerNormAccumulateDispatch(
+    const float* Input,
+    const float* Skip,
+    const float* Bias,
+    float* Output,
+    float* SkipOutput,
+    size_t N,
+    float& Sum,
+    float& SumSquare
+    )
+{
+    if (Skip == nullptr) {
+        MlasLayerNormAccumulate<false, false>(Input, nullptr, nullptr, nullptr, nullptr, N, Sum, SumSquare);
+    } else if (Bias == nullptr) {
+        MlasLayerNormAccumulate<true, false>(Input, Skip, nullptr, Output, SkipOutput, N, Sum, SumSquare);
+    } else {
+        MlasLayerNormAccumulate<true, true>(Input, Skip, Bias, Output, SkipOutput, N, Sum, SumSquare);
+    }
+}
+
+void
+MlasLayerNormApplyDispatch(
+    const float* Input,
+    const float* Gamma,
+    const float* Beta,
+    float* Output,
+    size_t N,
+    float Mean,
+    float InvStdDev
+    )
+{
+    if (Beta == nullptr) {
+        MlasLayerNormApply<false>(Input, Gamma, nullptr, Output, N, Mean, InvStdDev);
+    } else {
+        MlasLayerNormApply<true>(Input, Gamma, Beta, Output, N, Mean, InvStdDev);
+    }
+}
+
+MLAS_FORCEINLINE
+void
+MlasLayerNormComputeStatistics(
+    float Sum,
+    float SumSquare,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float& Mean,
+    float& InvStdDev
+    )
+{
+    Mean = Sum / float(N);
+
+    if (Simplified) {
+        InvStdDev = 1.0f / std::sqrt(SumSquare / float(N) + Epsilon);
+        Mean = 0.0f;
+    } else {
+        InvStdDev = 1.0f / std::sqrt(std::max(SumSquare / float(N) - Mean * Mean, 0.0f) + Epsilon);
+    }
+}
+
+void
+MlasLayerNormRow(
+    const float* Input,
+    const float* Skip,
+    const float* Bias,
+    const float* Gamma,
+    const float* Beta,
+    float* Output,
+    float* SkipOutput,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float& Mean,
+    float& InvStdDev
+    )
+/*++
+
+Routine Description:
+
+    This routine normalizes a single precision row.
+
+    The residual sum is staged in the output buffer, so the second pass reads
+    one vector instead of recomputing the sum.
+
+Arguments:
+
+    See MlasLayerNormalization.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float Sum = 0.0f;
+    float SumSquare = 0.0f;
+
+    MlasLayerNormAccumulateDispatch(Input, Skip, Bias, Output, SkipOutput, N, Sum, SumSquare);
+
+    MlasLayerNormComputeStatistics(Sum, SumSquare, N, Epsilon, Simplified, Mean, InvStdDev);
+
+    MlasLayerNormApplyDispatch((Skip != nullptr) ? Output : Input, Gamma, Beta, Output, N, Mean, InvStdDev);
+}
+
+void
+MlasLayerNormRow(
+    const MLAS_FP16* Input,
+    const MLAS_FP16* Skip,
+    const MLAS_FP16* Bias,
+    const MLAS_FP16* Gamma,
+    const MLAS_FP16* Beta,
+    MLAS_FP16* Output,
+    MLAS_FP16* SkipOutput,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float& Mean,
+    float& InvStdDev
+    )
+/*++
+
+Routine Description:
+
+    This routine normalizes a half precision row.
+
+    Each pass converts blocks of the row to single precision. The residual sum
+    is recomputed in single precision by the second pass so that the result
+    is not rounded to half precision between the passes.
+
+Arguments:
+
+    See MlasLayerNormalization.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    float BufferInput[MLAS_LAYER_NORM_HALF_BLOCK_SIZE];
+    float BufferSkip[MLAS_LAYER_NORM_HALF_BLOCK_SIZE];
+    float BufferBias[MLAS_LAYER_NORM_HALF_BLOCK_SIZE];
+    float BufferGamma[MLAS_LAYER_NORM_HALF_BLOCK_SIZE];
+    float BufferBeta[MLAS_LAYER_NORM_HALF_BLOCK_SIZE];
+
+    auto LoadResidualBlock = [&](size_t Offset, size_t Count) {
+        MlasConvertHalfToFloatBlock(Input + Offset, BufferInput, Count);
+        if (Skip != nullptr) {
+            MlasConvertHalfToFloatBlock(Skip + Offset, BufferSkip, Count);
+        }
+        if (Bias != nullptr) {
+            MlasConvertHalfToFloatBlock(Bias + Offset, BufferBias, Count);
+        }
+    };
+
+    //
+    // Accumulate the statistics of the row.
+    //
+
+    float Sum = 0.0f;
+    float SumSquare = 0.0f;
+
+    for (size_t Offset = 0; Offset < N; Offset += MLAS_LAYER_NORM_HALF_BLOCK_SIZE) {
+
+        const size_t Count = std::min(N - Offset, MLAS_LAYER_NORM_HALF_BLOCK_SIZE);
+
+        LoadResidualBlock(Offset, Count);
+
+        MlasLayerNormAccumulateDispatch(BufferInput, (Skip != nullptr) ? BufferSkip : nullptr,
+            (Bias != nullptr) ? BufferBias : nullptr, BufferInput, nullptr, Count, Sum, SumSquare);
+
+        if (SkipOutput != nullptr) {
+            MlasConvertFloatToHalfBlock(BufferInput, SkipOutput + Offset, Count);
+        }
+    }
+
+    MlasLayerNormComputeStatistics(Sum, SumSquare, N, Epsilon, Simplified, Mean, InvStdDev);
+
+    //
+    // Apply the normalization to the row.
+    //
+
+    for (size_t Offset = 0; Offset < N; Offset += MLAS_LAYER_NORM_HALF_BLOCK_SIZE) {
+
+        const size_t Count = std::min(N - Offset, MLAS_LAYER_NORM_HALF_BLOCK_SIZE);
+
+        if (Skip != nullptr) {
+            LoadResidualBlock(Offset, Count);
+            float Unused = 0.0f;
+            MlasLayerNormAccumulateDispatch(BufferInput, BufferSkip, (Bias != nullptr) ? BufferBias : nullptr,
+                BufferInput, nullptr, Count, Unused, Unused);
+        } else {
+            MlasConvertHalfToFloatBlock(Input + Offset, BufferInput, Count);
+        }
+
+        MlasConvertHalfToFloatBlock(Gamma + Offset, BufferGamma, Count);
+        if (Beta != nullptr) {
+            MlasConvertHalfToFloatBlock(Beta + Offset, BufferBeta, Count);
+        }
+
+        MlasLayerNormApplyDispatch(BufferInput, BufferGamma, (Beta != nullptr) ? BufferBeta : nullptr,
+            BufferInput, Count, Mean, InvStdDev);
+
+        MlasConvertFloatToHalfBlock(BufferInput, Output + Offset, Count);
+    }
+}
+
+template<typename T>
+void
+MLASCALL
+MlasLayerNormalization(
+    const T* Input,
+    const T* Skip,
+    const T* Bias,
+    const T* Gamma,
+    const T* Beta,
+    T* Output,
+    T* SkipOutput,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float* Mean,
+    float* InvStdDev
+    )
+/*++
+
+Routine Description:
+
+    This routine normalizes a row of N elements:
+
+        X = Input + Skip + Bias
+        Output = (X - Mean(X)) / sqrt(Var(X) + Epsilon) * Gamma + Beta
+
+    For the simplified (RMS) variant, the mean is not subtracted and the
+    variance is replaced by the mean of the squares.
+
+Arguments:
+
+    Input - Supplies the input row.
+
+    Skip - Optionally supplies the skip (residual) row.
+
+    Bias - Optionally supplies the bias vector, used only if Skip is supplied.
+
+    Gamma - Supplies the scale vector.
+
+    Beta - Optionally supplies the shift vector.
+
+    Output - Supplies the output row.
+
+    SkipOutput - Optionally supplies the row that receives Input + Skip + Bias,
+        used only if Skip is supplied.
+
+    N - Supplies the number of elements of the row.
+
+    Epsilon - Supplies the value added to the variance.
+
+    Simplified - Supplies true to compute the RMS normalization.
+
+    Mean - Optionally receives the mean of the row, zero for the simplified
+        variant.
+
+    InvStdDev - Optionally receives the inverse standard deviation of the row.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (N == 0) {
+        return;
+    }
+
+    if (Skip == nullptr) {
+        Bias = nullptr;
+        SkipOutput = nullptr;
+    }
+
+    float RowMean;
+    float RowInvStdDev;
+
+    MlasLayerNormRow(Input, Skip, Bias, Gamma, Beta, Output, SkipOutput, N, Epsilon, Simplified,
+        RowMean, RowInvStdDev);
+
+    if (Mean != nullptr) {
+        *Mean = RowMean;
+    }
+
+    if (InvStdDev != nullptr) {
+        *InvStdDev = RowInvStdDev;
+    }
+}
+
+template
+void
+MLASCALL
+MlasLayerNormalization<float>(
+    const float* Input,
+    const float* Skip,
+    const float* Bias,
+    const float* Gamma,
+    const float* Beta,
+    float* Output,
+    float* SkipOutput,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float* Mean,
+    float* InvStdDev
+    );
+
+template
+void
+MLASCALL
+MlasLayerNormalization<MLAS_FP16>(
+    const MLAS_FP16* Input,
+    const MLAS_FP16* Skip,
+    const MLAS_FP16* Bias,
+    const MLAS_FP16* Gamma,
+    const MLAS_FP16* Beta,
+    MLAS_FP16* Output,
+    MLAS_FP16* SkipOutput,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float* Mean,
+    float* InvStdDev
+    );
@@ -19,6 +19,7 @@ Abstract:
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -263,11 +264,62 @@ operator!=(const MLFloat16& left, const MLFloat16& right)
     return left.val != right.val;
 }
 
+struct BFloat16 {
+    uint16_t val{0};
+
+    BFloat16() = default;
+
+    explicit BFloat16(float ff)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &ff, sizeof(bits));
+        if (std::isnan(ff)) {
+            val = 0x7FC1;
+        } else {
+            // Round to nearest even.
+            val = static_cast<uint16_t>((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+        }
+    }
+
+    float ToFloat() const
+    {
+        const uint32_t bits = uint32_t(val) << 16;
+        float ff;
+        std::memcpy(&ff, &bits, sizeof(ff));
+        return ff;
+    }
+
+    operator float() const { return ToFloat(); }
+};
+
 }
 
 #endif  // BUILD_MLAS_NO_ONNXRUNTIME
 
 static_assert(sizeof(MLAS_FP16) == FP16_SIZE);
+static_assert(sizeof(MLAS_BF16) == sizeof(uint16_t));
+
+//
+// Block conversions between half and single precision. These are branch free
+// so that the compiler can vectorize them, unlike the per element
+// MLAS_Half2Float and MLAS_Float2Half.
+//
+
+void
+MLASCALL
+MlasConvertHalfToFloatBlock(
+    const MLAS_FP16* Source,
+    float* Destination,
+    size_t Count
+    );
+
+void
+MLASCALL
+MlasConvertFloatToHalfBlock(
+    const float* Source,
+    MLAS_FP16* Destination,
+    size_t Count
+    );
 
 
 //
@@ -574,6 +626,17 @@ void
     size_t N
     );
 
+typedef
+void
+(MLASCALL MLAS_ELTWISE_BINARY_FLOAT_KERNEL)(
+    const float* A,
+    size_t StrideA,
+    const float* B,
+    size_t StrideB,
+    float* C,
+    size_t N
+    );
+
 typedef
 void
 (MLASCALL MLAS_QLINEAR_BINARY_OP_S8_KERNEL)(
@@ -814,6 +877,45 @@ MlasSgemmOperation(
     size_t ldc
     );
 
+void
+MlasSgemmPackedOperation(
+    CBLAS_TRANSPOSE TransA,
+    size_t M,
+    size_t RangeStartN,
+    size_t RangeCountN,
+    size_t K,
+    float alpha,
+    const float* A,
+    size_t lda,
+    const void* PackedB,
+    size_t AlignedN,
+    float beta,
+    float* C,
+    size_t ldc
+    );
+
+//
+// Winograd convolution routines.
+//
+
+bool
+MlasConvWinogradPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    const void* PackedFilter,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 //
 // Quantized integer matrix/matrix dispatch structure.
 //
@@ -863,6 +965,18 @@ struct MLAS_FPQ4GEMM_DISPATCH;
 
 extern const MLAS_FPQ4GEMM_DISPATCH MlasFpQ4GemmDispatchAvx512;
 
+//
+// Element-wise binary row kernels for the single precision operations with a
+// vector form, indexed by MLAS_ELTWISE_BINARY_KIND.
+//
+
+struct MLAS_ELTWISE_BINARY_FLOAT_DISPATCH {
+    MLAS_ELTWISE_BINARY_FLOAT_KERNEL* Kernels[MlasEltwiseMax + 1];
+};
+
+extern const MLAS_ELTWISE_BINARY_FLOAT_DISPATCH MlasEltwiseBinaryFloatDispatchAvx;
+extern const MLAS_ELTWISE_BINARY_FLOAT_DISPATCH MlasEltwiseBinaryFloatDispatchAvx512F;
+
 //
 // Quantized depthwise convolution kernels.
 //
@@ -977,6 +1091,7 @@ struct MLAS_PLATFORM {
     MLAS_COMPUTE_LOGSOFTMAX_OUTPUT_FLOAT_KERNEL* ComputeLogSoftmaxOutputF32Kernel;
     MLAS_REDUCE_MAXIMUM_FLOAT_KERNEL* ReduceMaximumF32Kernel;
     MLAS_REDUCE_MINIMUM_MAXIMUM_FLOAT_KERNEL* ReduceMinimumMaximumF32Kernel;
+    const MLAS_ELTWISE_BINARY_FLOAT_DISPATCH* EltwiseBinaryFloatDispatch;
     MLAS_QUANTIZE_LINEAR_S8_KERNEL* QuantizeLinearS8Kernel;
     MLAS_QUANTIZE_LINEAR_U8_KERNEL* QuantizeLinearU8Kernel;
     uint32_t NchwcBlockSize;
@@ -1332,6 +1447,28 @@ MlasSubtractInt32x4(MLAS_INT32X4 Vector1, MLAS_INT32X4 Vector2)
 #endif
 }
 
+MLAS_FORCEINLINE
+MLAS_INT32X4
+MlasMultiplyInt32x4(MLAS_INT32X4 Vector1, MLAS_INT32X4 Vector2)
+{
+#if defined(MLAS_NEON_INTRINSICS)
+    return vmulq_s32(Vector1, Vector2);
+#elif defined(MLAS_SSE41_INTRINSICS)
+    return _mm_mullo_epi32(Vector1, Vector2);
+#elif defined(MLAS_SSE2_INTRINSICS)
+    // The low 32 bits of the products are the same for signed and unsigned
+    // operands, so multiply the even and odd lanes as unsigned and interleave.
+    __m128i Even = _mm_mul_epu32(Vector1, Vector2);
+    __m128i Odd = _mm_mul_epu32(_mm_srli_epi64(Vector1, 32), _mm_srli_epi64(Vector2, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(Even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(Odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#elif defined(MLAS_WASM_SIMD_INTRINSICS)
+    return wasm_i32x4_mul(Vector1, Vector2);
+#else
+    return Vector1 * Vector2;
+#endif
+}
+
 MLAS_FORCEINLINE
 MLAS_INT32X4
 MlasAndInt32x4(MLAS_INT32X4 Vector1, MLAS_INT32X4 Vector2)
@@ -192,6 +192,81 @@ MlasQ4GemmPackB(
     }
 }
 
+template<typename T>
+MLAS_FORCEINLINE
+void
+MlasQ4GemmPackBQuantizedImpl(
+    void* PackedBuf,
+    const uint8_t* QuantData,
+    const float* Scales,
+    const uint8_t* ZeroPoints,
+    size_t N,
+    size_t K
+    )
+{
+    auto* dst_ptr = reinterpret_cast<uint8_t*>(PackedBuf);
+    const size_t KBlocks = MlasDivRoundup(K, T::BlkLen);
+    const size_t ZpStride = (KBlocks + 1) / 2;
+
+    for (size_t n = 0; n < N; n++) {
+        const uint8_t* src = QuantData + n * KBlocks * (T::BlkLen / 2);
+
+        for (size_t b = 0; b < KBlocks; b++) {
+            const size_t klen = std::min(T::BlkLen, K - b * T::BlkLen);
+
+            uint8_t zp = 8;
+            if constexpr (std::is_same_v<T, MLAS_Q4TYPE_BLK1>) {
+                if (ZeroPoints != nullptr) {
+                    const uint8_t zp_pair = ZeroPoints[n * ZpStride + b / 2];
+                    zp = (b & 1) ? (zp_pair >> 4) : (zp_pair & 0x0F);
+                }
+                MlasQ4BlkZeroPoint<T>(dst_ptr) = zp;
+            }
+            MlasQ4BlkScale<T>(dst_ptr) = Scales[n * KBlocks + b];
+            uint8_t* data = MlasQ4BlkData<T>(dst_ptr);
+
+            // Values are interleaved by pairs in the source, and by halves of
+            // every 32 values in the blob. Padding is set to the zero point.
+            auto value = [&](size_t l) -> uint8_t {
+                return l < klen ? static_cast<uint8_t>((src[l / 2] >> ((l & 1) * 4)) & 0x0F) : zp;
+            };
+            for (size_t kk = 0; kk < T::BlkLen; kk += 32) {
+                for (size_t l = 0; l < 16; l++) {
+                    data[l] = static_cast<uint8_t>(value(kk + l) | (value(kk + l + 16) << 4));
+                }
+                data += 16;
+            }
+
+            dst_ptr += T::BlobSize;
+            src += T::BlkLen / 2;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasQ4GemmPackBQuantized(
+    MLAS_BLK_QUANT_TYPE QType,
+    void* PackedBuf,
+    const uint8_t* QuantData,
+    const float* Scales,
+    const uint8_t* ZeroPoints,
+    size_t N,
+    size_t K
+    )
+{
+    switch (QType) {
+        case BlkQ4Sym:
+            return MlasQ4GemmPackBQuantizedImpl<MLAS_Q4TYPE_BLK0>(PackedBuf, QuantData, Scales, ZeroPoints, N, K);
+        case BlkQ4Sym64:
+            return MlasQ4GemmPackBQuantizedImpl<MLAS_Q4TYPE_BLK2>(PackedBuf, QuantData, Scales, ZeroPoints, N, K);
+        case BlkQ4Sym128:
+            return MlasQ4GemmPackBQuantizedImpl<MLAS_Q4TYPE_BLK4>(PackedBuf, QuantData, Scales, ZeroPoints, N, K);
+        default:
+            return MlasQ4GemmPackBQuantizedImpl<MLAS_Q4TYPE_BLK1>(PackedBuf, QuantData, Scales, ZeroPoints, N, K);
+    }
+}
+
 template<typename T>
 MLAS_FORCEINLINE
 void
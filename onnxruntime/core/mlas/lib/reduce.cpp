@@ -0,0 +1,1250 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    reduce.cpp
+
+Abstract:
+
+    This module implements the multi-axis reduction operations.
+
+    The input shape is first collapsed by dropping unit dimensions and by
+    merging adjacent dimensions that are both reduced or both kept. The
+    innermost collapsed dimension then selects one of two vectorized inner
+    kernels:
+
+        If the innermost dimension is reduced, each output reduces contiguous
+        rows (horizontal reduction).
+
+        If the innermost dimension is kept, each block of outputs accumulates
+        contiguous column vectors from every reduced position (vertical
+        reduction).
+
+    The outer kept dimensions are partitioned across the thread pool. When
+    there are too few outputs to occupy the threads, the reduced positions
+    are partitioned instead and the per-thread partial results are combined.
+
+    The variance reduction uses Welford updates for columns and Chan's
+    pairwise combination for rows and partial results.
+
+--*/
+
+#include "mlasi.h"
+#include "mlas_float16.h"
+
+#include <vector>
+
+//
+// Define the number of input elements each thread should process before
+// using another thread.
+//
+
+constexpr size_t MLAS_REDUCE_THREAD_COMPLEXITY = 65536;
+
+//
+// Define the number of columns accumulated by the vertical kernel in one
+// pass over the reduced positions.
+//
+
+constexpr size_t MLAS_REDUCE_COLUMN_CHUNK = 256;
+
+//
+// Define the granularity of the column partitions so that the threads do not
+// share cache lines of the output.
+//
+
+constexpr size_t MLAS_REDUCE_COLUMN_GRANULARITY = 16;
+
+//
+// Define the minimum number of row elements per partition when a row is split
+// across threads.
+//
+
+constexpr size_t MLAS_REDUCE_ROW_GRANULARITY = 4096;
+
+template<typename T>
+struct MLAS_REDUCE_WORK_BLOCK
+{
+    size_t KeptRank;
+    size_t KeptShape[MLAS_REDUCE_MAXIMUM_RANK];
+    size_t KeptStride[MLAS_REDUCE_MAXIMUM_RANK];
+    size_t ReducedRank;
+    size_t ReducedShape[MLAS_REDUCE_MAXIMUM_RANK];
+    size_t ReducedStride[MLAS_REDUCE_MAXIMUM_RANK];
+    size_t OuterKeptCount;
+    size_t OuterReducedCount;
+    size_t InnerSize;
+    bool InnerReduced;
+    size_t ReduceCount;
+    size_t OutputCount;
+    size_t ColumnBlockSize;
+    size_t ColumnBlocks;
+    size_t RowBlockSize;
+    size_t RowBlocks;
+    const T* Input;
+    T* Output;
+    float* Mean;
+    float* Variance;
+    void* Partials;
+    size_t* PartialCounts;
+    ptrdiff_t ThreadCount;
+};
+
+//
+// Define the scalar and vector operations for each reduction.
+//
+
+template<MLAS_REDUCE_KIND Kind, typename T>
+MLAS_FORCEINLINE
+T
+MlasReduceIdentity()
+{
+    if constexpr (Kind == MlasReduceMax) {
+        return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::lowest();
+    } else if constexpr (Kind == MlasReduceMin) {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::max();
+    } else {
+        return T(0);
+    }
+}
+
+template<MLAS_REDUCE_KIND Kind, typename T>
+MLAS_FORCEINLINE
+T
+MlasReduceCombine(
+    T Accumulator,
+    T Value
+    )
+{
+    if constexpr (Kind == MlasReduceMax) {
+        return std::max(Accumulator, Value);
+    } else if constexpr (Kind == MlasReduceMin) {
+        return std::min(Accumulator, Value);
+    } else {
+        return Accumulator + Value;
+    }
+}
+
+template<MLAS_REDUCE_KIND Kind, typename T>
+MLAS_FORCEINLINE
+T
+MlasReduceAccumulate(
+    T Accumulator,
+    T Value
+    )
+{
+    if constexpr (Kind == MlasReduceSumSquare) {
+        return Accumulator + Value * Value;
+    } else {
+        return MlasReduceCombine<Kind>(Accumulator, Value);
+    }
+}
+
+//
+// Define the vector traits used by the inner kernels. Types and operations
+// without a vector implementation use scalar loops that the compiler may
+// auto-vectorize.
+//
+
+template<MLAS_REDUCE_KIND Kind, typename T>
+struct MLAS_REDUCE_VECTOR_TRAITS
+{
+    static constexpr bool Enabled = false;
+};
+
+template<MLAS_REDUCE_KIND Kind>
+struct MLAS_REDUCE_VECTOR_TRAITS<Kind, float>
+{
+    static constexpr bool Enabled = true;
+    using VectorType = MLAS_FLOAT32X4;
+
+    static VectorType Load(const float* p) { return MlasLoadFloat32x4(p); }
+    static VectorType Broadcast(float v) { return MlasBroadcastFloat32x4(v); }
+    static void Store(float* p, VectorType v) { MlasStoreFloat32x4(p, v); }
+
+    static VectorType Accumulate(VectorType Accumulator, VectorType Value)
+    {
+        if constexpr (Kind == MlasReduceMax) {
+            return MlasMaximumFloat32x4(Accumulator, Value);
+        } else if constexpr (Kind == MlasReduceMin) {
+            return MlasMinimumFloat32x4(Accumulator, Value);
+        } else if constexpr (Kind == MlasReduceSumSquare) {
+            return MlasMultiplyAddFloat32x4(Value, Value, Accumulator);
+        } else {
+            return MlasAddFloat32x4(Accumulator, Value);
+        }
+    }
+
+    static VectorType Combine(VectorType Vector1, VectorType Vector2)
+    {
+        if constexpr (Kind == MlasReduceMax) {
+            return MlasMaximumFloat32x4(Vector1, Vector2);
+        } else if constexpr (Kind == MlasReduceMin) {
+            return MlasMinimumFloat32x4(Vector1, Vector2);
+        } else {
+            return MlasAddFloat32x4(Vector1, Vector2);
+        }
+    }
+
+    static float Horizontal(VectorType Vector)
+    {
+        if constexpr (Kind == MlasReduceMax) {
+            return MlasReduceMaximumFloat32x4(Vector);
+        } else if constexpr (Kind == MlasReduceMin) {
+            return MlasReduceMinimumFloat32x4(Vector);
+        } else {
+            return MlasReduceAddFloat32x4(Vector);
+        }
+    }
+};
+
+template<MLAS_REDUCE_KIND Kind>
+struct MLAS_REDUCE_VECTOR_TRAITS<Kind, int32_t>
+{
+    static constexpr bool Enabled = (Kind != MlasReduceSumSquare);
+    using VectorType = MLAS_INT32X4;
+
+    static VectorType Load(const int32_t* p) { return MlasLoadInt32x4(p); }
+    static VectorType Broadcast(int32_t v) { return MlasBroadcastInt32x4(v); }
+    static void Store(int32_t* p, VectorType v) { MlasStoreInt32x4(p, v); }
+
+    static VectorType Accumulate(VectorType Accumulator, VectorType Value)
+    {
+        return Combine(Accumulator, Value);
+    }
+
+    static VectorType Combine(VectorType Vector1, VectorType Vector2)
+    {
+        if constexpr (Kind == MlasReduceMax) {
+            return MlasMaximumInt32x4(Vector1, Vector2);
+        } else if constexpr (Kind == MlasReduceMin) {
+            return MlasMinimumInt32x4(Vector1, Vector2);
+        } else {
+            return MlasAddInt32x4(Vector1, Vector2);
+        }
+    }
+
+    static int32_t Horizontal(VectorType Vector)
+    {
+        int32_t Lanes[4];
+        MlasStoreInt32x4(Lanes, Vector);
+        return MlasReduceCombine<Kind>(MlasReduceCombine<Kind>(Lanes[0], Lanes[1]),
+                                       MlasReduceCombine<Kind>(Lanes[2], Lanes[3]));
+    }
+};
+
+template<MLAS_REDUCE_KIND Kind, typename T>
+T
+MlasReduceRowKernel(
+    const T* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces a contiguous row of elements to a single value.
+
+Arguments:
+
+    Input - Supplies the input row.
+
+    N - Supplies the number of elements in the row.
+
+Return Value:
+
+    Returns the reduced value, without the mean scaling.
+
+--*/
+{
+    using Traits = MLAS_REDUCE_VECTOR_TRAITS<Kind, T>;
+
+    T Value = MlasReduceIdentity<Kind, T>();
+
+    if constexpr (Traits::Enabled) {
+
+        if (N >= 4) {
+
+            auto Identity = Traits::Broadcast(MlasReduceIdentity<Kind, T>());
+            auto Accumulator0 = Identity;
+            auto Accumulator1 = Identity;
+            auto Accumulator2 = Identity;
+            auto Accumulator3 = Identity;
+
+            while (N >= 16) {
+                Accumulator0 = Traits::Accumulate(Accumulator0, Traits::Load(Input));
+                Accumulator1 = Traits::Accumulate(Accumulator1, Traits::Load(Input + 4));
+                Accumulator2 = Traits::Accumulate(Accumulator2, Traits::Load(Input + 8));
+                Accumulator3 = Traits::Accumulate(Accumulator3, Traits::Load(Input + 12));
+                Input += 16;
+                N -= 16;
+            }
+
+            while (N >= 4) {
+                Accumulator0 = Traits::Accumulate(Accumulator0, Traits::Load(Input));
+                Input += 4;
+                N -= 4;
+            }
+
+            Accumulator0 = Traits::Combine(Accumulator0, Accumulator1);
+            Accumulator2 = Traits::Combine(Accumulator2, Accumulator3);
+            Value = Traits::Horizontal(Traits::Combine(Accumulator0, Accumulator2));
+        }
+    }
+
+    for (size_t i = 0; i < N; i++) {
+        Value = MlasReduceAccumulate<Kind>(Value, Input[i]);
+    }
+
+    return Value;
+}
+
+template<MLAS_REDUCE_KIND Kind, typename T>
+void
+MlasReduceColumnKernel(
+    const T* Input,
+    T* Accumulator,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine accumulates a contiguous vector of elements into a vector of
+    accumulators.
+
+Arguments:
+
+    Input - Supplies the input vector.
+
+    Accumulator - Supplies the accumulator vector.
+
+    N - Supplies the number of elements in the vectors.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    using Traits = MLAS_REDUCE_VECTOR_TRAITS<Kind, T>;
+
+    if constexpr (Traits::Enabled) {
+
+        while (N >= 4) {
+            Traits::Store(Accumulator, Traits::Accumulate(Traits::Load(Accumulator), Traits::Load(Input)));
+            Input += 4;
+            Accumulator += 4;
+            N -= 4;
+        }
+    }
+
+    for (size_t i = 0; i < N; i++) {
+        Accumulator[i] = MlasReduceAccumulate<Kind>(Accumulator[i], Input[i]);
+    }
+}
+
+void
+MlasReduceConvertHalfToFloat(
+    const MLAS_FP16* Input,
+    float* Output,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine converts a block of half precision elements to single
+    precision for the single precision inner kernels.
+
+Arguments:
+
+    Input - Supplies the half precision elements.
+
+    Output - Supplies the single precision buffer.
+
+    N - Supplies the number of elements to convert.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    for (size_t i = 0; i < N; i++) {
+        Output[i] = MLAS_Half2Float(Input[i].val);
+    }
+}
+
+//
+// Define the reduction operations used by the threaded routines.
+//
+// Acc is the state of one output. Row reduces a contiguous row to a state,
+// Combine merges two states covering Count1 and Count2 reduced elements, and
+// Store finalizes the state of an output. The column routines hold the states
+// of up to MLAS_REDUCE_COLUMN_CHUNK adjacent outputs, where Count is the
+// number of reduced positions already accumulated.
+//
+
+template<MLAS_REDUCE_KIND Kind, typename T>
+struct MLAS_REDUCE_OPERATION
+{
+    using ElementType = T;
+    using Acc = typename std::conditional<std::is_same<T, MLAS_FP16>::value, float, T>::type;
+
+    struct ColumnState {
+        Acc Value[MLAS_REDUCE_COLUMN_CHUNK];
+        float Buffer[std::is_same<T, MLAS_FP16>::value ? MLAS_REDUCE_COLUMN_CHUNK : 1];
+    };
+
+    static Acc Identity() { return MlasReduceIdentity<Kind, Acc>(); }
+
+    static Acc Row(const T* Input, size_t N)
+    {
+        if constexpr (std::is_same<T, MLAS_FP16>::value) {
+
+            float Buffer[MLAS_REDUCE_COLUMN_CHUNK];
+            float Value = Identity();
+
+            while (N > 0) {
+                const size_t n = std::min(N, MLAS_REDUCE_COLUMN_CHUNK);
+                MlasReduceConvertHalfToFloat(Input, Buffer, n);
+                Value = MlasReduceCombine<Kind>(Value, MlasReduceRowKernel<Kind, float>(Buffer, n));
+                Input += n;
+                N -= n;
+            }
+
+            return Value;
+
+        } else {
+            return MlasReduceRowKernel<Kind, T>(Input, N);
+        }
+    }
+
+    static Acc Combine(Acc Value1, size_t, Acc Value2, size_t)
+    {
+        return MlasReduceCombine<Kind>(Value1, Value2);
+    }
+
+    static void ColumnsInit(ColumnState& State, size_t N)
+    {
+        std::fill_n(State.Value, N, Identity());
+    }
+
+    static void Columns(ColumnState& State, const T* Input, size_t N, size_t)
+    {
+        if constexpr (std::is_same<T, MLAS_FP16>::value) {
+            MlasReduceConvertHalfToFloat(Input, State.Buffer, N);
+            MlasReduceColumnKernel<Kind, float>(State.Buffer, State.Value, N);
+        } else {
+            MlasReduceColumnKernel<Kind, T>(Input, State.Value, N);
+        }
+    }
+
+    static Acc ColumnValue(const ColumnState& State, size_t Index) { return State.Value[Index]; }
+
+    static void Store(const MLAS_REDUCE_WORK_BLOCK<T>* WorkBlock, size_t OutputIndex, Acc Value, size_t Count)
+    {
+        if constexpr (Kind == MlasReduceMean) {
+            if constexpr (std::is_integral<Acc>::value) {
+                Value = (Count > 0) ? Value / Acc(Count) : Value;
+            } else {
+                Value = Value / Acc(Count);
+            }
+        }
+
+        if constexpr (std::is_same<T, MLAS_FP16>::value) {
+            WorkBlock->Output[OutputIndex].val = MLAS_Float2Half(Value);
+        } else {
+            WorkBlock->Output[OutputIndex] = Value;
+        }
+    }
+};
+
+struct MLAS_REDUCE_MEAN_VARIANCE_OPERATION
+{
+    using ElementType = float;
+
+    struct Acc {
+        float Mean;
+        float M2;
+    };
+
+    struct ColumnState {
+        float Mean[MLAS_REDUCE_COLUMN_CHUNK];
+        float M2[MLAS_REDUCE_COLUMN_CHUNK];
+    };
+
+    static Acc Identity() { return Acc{0.0f, 0.0f}; }
+
+    static Acc Row(const float* Input, size_t N)
+    {
+        //
+        // Compute the mean and the sum of squared deviations of each block
+        // with two passes over the (cache resident) block, then merge the
+        // blocks.
+        //
+
+        constexpr size_t BlockSize = 1024;
+
+        Acc Value = Identity();
+        size_t Count = 0;
+
+        while (N > 0) {
+
+            const size_t n = std::min(N, BlockSize);
+            const float Mean = MlasReduceRowKernel<MlasReduceSum, float>(Input, n) / float(n);
+
+            MLAS_FLOAT32X4 MeanVector = MlasBroadcastFloat32x4(Mean);
+            MLAS_FLOAT32X4 M2Vector = MlasZeroFloat32x4();
+            size_t i = 0;
+
+            for (; i + 4 <= n; i += 4) {
+                MLAS_FLOAT32X4 Delta = MlasSubtractFloat32x4(MlasLoadFloat32x4(Input + i), MeanVector);
+                M2Vector = MlasMultiplyAddFloat32x4(Delta, Delta, M2Vector);
+            }
+
+            float M2 = MlasReduceAddFloat32x4(M2Vector);
+
+            for (; i < n; i++) {
+                const float Delta = Input[i] - Mean;
+                M2 += Delta * Delta;
+            }
+
+            Value = Combine(Value, Count, Acc{Mean, M2}, n);
+            Count += n;
+            Input += n;
+            N -= n;
+        }
+
+        return Value;
+    }
+
+    static Acc Combine(Acc Value1, size_t Count1, Acc Value2, size_t Count2)
+    {
+        if (Count1 == 0) {
+            return Value2;
+        }
+        if (Count2 == 0) {
+            return Value1;
+        }
+
+        const float Count = float(Count1 + Count2);
+        const float Delta = Value2.Mean - Value1.Mean;
+
+        Acc Value;
+        Value.Mean = Value1.Mean + Delta * (float(Count2) / Count);
+        Value.M2 = Value1.M2 + Value2.M2 + Delta * Delta * (float(Count1) * float(Count2) / Count);
+        return Value;
+    }
+
+    static void ColumnsInit(ColumnState& State, size_t N)
+    {
+        std::fill_n(State.Mean, N, 0.0f);
+        std::fill_n(State.M2, N, 0.0f);
+    }
+
+    static void Columns(ColumnState& State, const float* Input, size_t N, size_t Count)
+    {
+        const float Scale = 1.0f / float(Count + 1);
+        MLAS_FLOAT32X4 ScaleVector = MlasBroadcastFloat32x4(Scale);
+        size_t i = 0;
+
+        for (; i + 4 <= N; i += 4) {
+            MLAS_FLOAT32X4 x = MlasLoadFloat32x4(Input + i);
+            MLAS_FLOAT32X4 Mean = MlasLoadFloat32x4(State.Mean + i);
+            MLAS_FLOAT32X4 Delta = MlasSubtractFloat32x4(x, Mean);
+            Mean = MlasMultiplyAddFloat32x4(Delta, ScaleVector, Mean);
+            MLAS_FLOAT32X4 M2 = MlasLoadFloat32x4(State.M2 + i);
+            M2 = MlasMultiplyAddFloat32x4(Delta, MlasSubtractFloat32x4(x, Mean), M2);
+            MlasStoreFloat32x4(State.Mean + i, Mean);
+            MlasStoreFloat32x4(State.M2 + i, M2);
+        }
+
+        for (; i < N; i++) {
+            const float Delta = Input[i] - State.Mean[i];
+            State.Mean[i] += Delta * Scale;
+            State.M2[i] += Delta * (Input[i] - State.Mean[i]);
+        }
+    }
+
+    static Acc ColumnValue(const ColumnState& State, size_t Index)
+    {
+        return Acc{State.Mean[Index], State.M2[Index]};
+    }
+
+    static void Store(const MLAS_REDUCE_WORK_BLOCK<float>* WorkBlock, size_t OutputIndex, Acc Value, size_t Count)
+    {
+        WorkBlock->Mean[OutputIndex] = Value.Mean;
+        WorkBlock->Variance[OutputIndex] = Value.M2 / float(Count);
+    }
+};
+
+//
+// Define the helpers that walk the outer dimensions.
+//
+
+template<typename T>
+size_t
+MlasReduceKeptOffset(
+    const MLAS_REDUCE_WORK_BLOCK<T>* WorkBlock,
+    size_t Index
+    )
+{
+    size_t Offset = 0;
+
+    for (size_t d = WorkBlock->KeptRank; d > 0; d--) {
+        Offset += (Index % WorkBlock->KeptShape[d - 1]) * WorkBlock->KeptStride[d - 1];
+        Index /= WorkBlock->KeptShape[d - 1];
+    }
+
+    return Offset;
+}
+
+template<typename T>
+struct MLAS_REDUCE_ODOMETER
+{
+    size_t Index[MLAS_REDUCE_MAXIMUM_RANK];
+    size_t Offset;
+
+    void Seek(const MLAS_REDUCE_WORK_BLOCK<T>* WorkBlock, size_t Linear)
+    {
+        Offset = 0;
+
+        for (size_t d = WorkBlock->ReducedRank; d > 0; d--) {
+            Index[d - 1] = Linear % WorkBlock->ReducedShape[d - 1];
+            Offset += Index[d - 1] * WorkBlock->ReducedStride[d - 1];
+            Linear /= WorkBlock->ReducedShape[d - 1];
+        }
+    }
+
+    void Next(const MLAS_REDUCE_WORK_BLOCK<T>* WorkBlock)
+    {
+        for (size_t d = WorkBlock->ReducedRank; d > 0; d--) {
+            Offset += WorkBlock->ReducedStride[d - 1];
+            if (++Index[d - 1] < WorkBlock->ReducedShape[d - 1]) {
+                return;
+            }
+            Offset -= WorkBlock->ReducedShape[d - 1] * WorkBlock->ReducedStride[d - 1];
+            Index[d - 1] = 0;
+        }
+    }
+};
+
+template<typename Op>
+void
+MlasReduceOutputThreaded(
+    void* Context,
+    ptrdiff_t ThreadId
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to compute a range of
+    outputs. Each output block reads every reduced position.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    ThreadId - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    using T = typename Op::ElementType;
+    const auto* WorkBlock = (const MLAS_REDUCE_WORK_BLOCK<T>*)Context;
+
+    const size_t InnerSize = WorkBlock->InnerSize;
+    const size_t OuterReducedCount = WorkBlock->OuterReducedCount;
+    const size_t TotalUnits = WorkBlock->InnerReduced ? WorkBlock->OuterKeptCount
+                                                      : WorkBlock->OuterKeptCount * WorkBlock->ColumnBlocks;
+
+    size_t UnitIndex;
+    size_t UnitCount;
+
+    MlasPartitionWork(ThreadId, WorkBlock->ThreadCount, TotalUnits, &UnitIndex, &UnitCount);
+
+    MLAS_REDUCE_ODOMETER<T> Odometer;
+
+    for (size_t Unit = UnitIndex; Unit < UnitIndex + UnitCount; Unit++) {
+
+        if (WorkBlock->InnerReduced) {
+
+            const T* Input = WorkBlock->Input + MlasReduceKeptOffset(WorkBlock, Unit);
+
+            typename Op::Acc Value = Op::Identity();
+            size_t Count = 0;
+
+            Odometer.Seek(WorkBlock, 0);
+
+            for (size_t r = 0; r < OuterReducedCount; r++) {
+                Value = Op::Combine(Value, Count, Op::Row(Input + Odometer.Offset, InnerSize), InnerSize);
+                Count += InnerSize;
+                Odometer.Next(WorkBlock);
+            }
+
+            Op::Store(WorkBlock, Unit, Value, WorkBlock->ReduceCount);
+
+        } else {
+
+            const size_t OuterIndex = Unit / WorkBlock->ColumnBlocks;
+            const size_t ColumnStart = (Unit % WorkBlock->ColumnBlocks) * WorkBlock->ColumnBlockSize;
+            const size_t ColumnEnd = std::min(ColumnStart + WorkBlock->ColumnBlockSize, InnerSize);
+
+            const T* Input = WorkBlock->Input + MlasReduceKeptOffset(WorkBlock, OuterIndex);
+
+            typename Op::ColumnState State;
+
+            for (size_t c = ColumnStart; c < ColumnEnd; c += MLAS_REDUCE_COLUMN_CHUNK) {
+
+                const size_t n = std::min(ColumnEnd - c, MLAS_REDUCE_COLUMN_CHUNK);
+
+                Op::ColumnsInit(State, n);
+                Odometer.Seek(WorkBlock, 0);
+
+                for (size_t r = 0; r < OuterReducedCount; r++) {
+                    Op::Columns(State, Input + Odometer.Offset + c, n, r);
+                    Odometer.Next(WorkBlock);
+                }
+
+                for (size_t i = 0; i < n; i++) {
+                    Op::Store(WorkBlock, OuterIndex * InnerSize + c + i, Op::ColumnValue(State, i),
+                              WorkBlock->ReduceCount);
+                }
+            }
+        }
+    }
+}
+
+template<typename Op>
+void
+MlasReduceSplitThreaded(
+    void* Context,
+    ptrdiff_t ThreadId
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to compute the partial
+    results of every output over a range of the reduced positions.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    ThreadId - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    using T = typename Op::ElementType;
+    const auto* WorkBlock = (const MLAS_REDUCE_WORK_BLOCK<T>*)Context;
+
+    const size_t InnerSize = WorkBlock->InnerSize;
+    const size_t RowBlocks = WorkBlock->RowBlocks;
+    const size_t TotalSegments = WorkBlock->OuterReducedCount * RowBlocks;
+
+    size_t SegmentIndex;
+    size_t SegmentCount;
+
+    MlasPartitionWork(ThreadId, WorkBlock->ThreadCount, TotalSegments, &SegmentIndex, &SegmentCount);
+
+    auto* Partials = static_cast<typename Op::Acc*>(WorkBlock->Partials) + ThreadId * WorkBlock->OutputCount;
+    size_t Count = 0;
+
+    MLAS_REDUCE_ODOMETER<T> Odometer;
+
+    for (size_t OuterIndex = 0; OuterIndex < WorkBlock->OuterKeptCount; OuterIndex++) {
+
+        const T* Input = WorkBlock->Input + MlasReduceKeptOffset(WorkBlock, OuterIndex);
+
+        if (WorkBlock->InnerReduced) {
+
+            typename Op::Acc Value = Op::Identity();
+            Count = 0;
+
+            Odometer.Seek(WorkBlock, SegmentIndex / RowBlocks);
+
+            for (size_t s = SegmentIndex; s < SegmentIndex + SegmentCount; s++) {
+
+                const size_t RowStart = (s % RowBlocks) * WorkBlock->RowBlockSize;
+                const size_t n = std::min(WorkBlock->RowBlockSize, InnerSize - RowStart);
+
+                Value = Op::Combine(Value, Count, Op::Row(Input + Odometer.Offset + RowStart, n), n);
+                Count += n;
+
+                if ((s % RowBlocks) == RowBlocks - 1) {
+                    Odometer.Next(WorkBlock);
+                }
+            }
+
+            Partials[OuterIndex] = Value;
+
+        } else {
+
+            typename Op::ColumnState State;
+
+            for (size_t c = 0; c < InnerSize; c += MLAS_REDUCE_COLUMN_CHUNK) {
+
+                const size_t n = std::min(InnerSize - c, MLAS_REDUCE_COLUMN_CHUNK);
+
+                Op::ColumnsInit(State, n);
+                Odometer.Seek(WorkBlock, SegmentIndex);
+
+                for (size_t s = 0; s < SegmentCount; s++) {
+                    Op::Columns(State, Input + Odometer.Offset + c, n, s);
+                    Odometer.Next(WorkBlock);
+                }
+
+                for (size_t i = 0; i < n; i++) {
+                    Partials[OuterIndex * InnerSize + c + i] = Op::ColumnValue(State, i);
+                }
+            }
+
+            Count = SegmentCount;
+        }
+    }
+
+    WorkBlock->PartialCounts[ThreadId] = Count;
+}
+
+template<typename Op>
+void
+MlasReduceExecute(
+    size_t Rank,
+    const size_t* InputShape,
+    const bool* ReduceAxes,
+    MLAS_REDUCE_WORK_BLOCK<typename Op::ElementType>& WorkBlock,
+    size_t ElementCost,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine collapses the input shape, selects the thread partitioning
+    and executes a reduction operation.
+
+Arguments:
+
+    Rank - Supplies the rank of the input tensor.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    ReduceAxes - Supplies a flag for each dimension that is true if the
+        dimension is reduced.
+
+    WorkBlock - Supplies the work block with the input and output buffers
+        initialized.
+
+    ElementCost - Supplies the relative cost of processing one element.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (Rank > MLAS_REDUCE_MAXIMUM_RANK) {
+        MLAS_THROW_EX(std::invalid_argument, "Reduction tensor rank exceeds MLAS_REDUCE_MAXIMUM_RANK");
+    }
+
+    //
+    // Collapse the shape by dropping unit dimensions and merging adjacent
+    // dimensions that are both reduced or both kept.
+    //
+
+    size_t Shape[MLAS_REDUCE_MAXIMUM_RANK];
+    bool Reduce[MLAS_REDUCE_MAXIMUM_RANK];
+    size_t CollapsedRank = 0;
+    size_t TotalElements = 1;
+    size_t ReduceCount = 1;
+
+    for (size_t d = 0; d < Rank; d++) {
+
+        const size_t Size = InputShape[d];
+
+        TotalElements *= Size;
+
+        if (ReduceAxes[d]) {
+            ReduceCount *= Size;
+        }
+
+        if (Size == 1) {
+            continue;
+        }
+
+        if (CollapsedRank > 0 && Reduce[CollapsedRank - 1] == ReduceAxes[d]) {
+            Shape[CollapsedRank - 1] *= Size;
+        } else {
+            Shape[CollapsedRank] = Size;
+            Reduce[CollapsedRank] = ReduceAxes[d];
+            CollapsedRank++;
+        }
+    }
+
+    if (ReduceCount == 0) {
+
+        //
+        // Every output reduces an empty set.
+        //
+
+        size_t OutputCount = 1;
+
+        for (size_t d = 0; d < Rank; d++) {
+            if (!ReduceAxes[d]) {
+                OutputCount *= InputShape[d];
+            }
+        }
+
+        for (size_t i = 0; i < OutputCount; i++) {
+            Op::Store(&WorkBlock, i, Op::Identity(), 0);
+        }
+        return;
+    }
+
+    if (TotalElements == 0) {
+        return;
+    }
+
+    if (CollapsedRank == 0) {
+        Shape[0] = 1;
+        Reduce[0] = true;
+        CollapsedRank = 1;
+    }
+
+    //
+    // Split the outer dimensions into the kept and reduced dimensions with
+    // their input strides.
+    //
+
+    WorkBlock.InnerSize = Shape[CollapsedRank - 1];
+    WorkBlock.InnerReduced = Reduce[CollapsedRank - 1];
+    WorkBlock.KeptRank = 0;
+    WorkBlock.ReducedRank = 0;
+    WorkBlock.OuterKeptCount = 1;
+    WorkBlock.OuterReducedCount = 1;
+
+    size_t Stride = WorkBlock.InnerSize;
+
+    for (size_t d = CollapsedRank - 1; d > 0; d--) {
+
+        const size_t Size = Shape[d - 1];
+
+        if (Reduce[d - 1]) {
+            WorkBlock.ReducedShape[WorkBlock.ReducedRank] = Size;
+            WorkBlock.ReducedStride[WorkBlock.ReducedRank] = Stride;
+            WorkBlock.ReducedRank++;
+            WorkBlock.OuterReducedCount *= Size;
+        } else {
+            WorkBlock.KeptShape[WorkBlock.KeptRank] = Size;
+            WorkBlock.KeptStride[WorkBlock.KeptRank] = Stride;
+            WorkBlock.KeptRank++;
+            WorkBlock.OuterKeptCount *= Size;
+        }
+
+        Stride *= Size;
+    }
+
+    std::reverse(WorkBlock.KeptShape, WorkBlock.KeptShape + WorkBlock.KeptRank);
+    std::reverse(WorkBlock.KeptStride, WorkBlock.KeptStride + WorkBlock.KeptRank);
+    std::reverse(WorkBlock.ReducedShape, WorkBlock.ReducedShape + WorkBlock.ReducedRank);
+    std::reverse(WorkBlock.ReducedStride, WorkBlock.ReducedStride + WorkBlock.ReducedRank);
+
+    WorkBlock.ReduceCount = ReduceCount;
+    WorkBlock.OutputCount = TotalElements / ReduceCount;
+
+    //
+    // Compute the number of target threads given the amount of input.
+    //
+
+    ptrdiff_t ThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    const size_t TargetThreadCount = (TotalElements * ElementCost / MLAS_REDUCE_THREAD_COMPLEXITY) + 1;
+
+    if (size_t(ThreadCount) > TargetThreadCount) {
+        ThreadCount = ptrdiff_t(TargetThreadCount);
+    }
+
+    //
+    // Partition the columns of a kept inner dimension when there are fewer
+    // outer outputs than threads.
+    //
+
+    size_t TotalUnits = WorkBlock.OuterKeptCount;
+
+    WorkBlock.ColumnBlocks = 1;
+    WorkBlock.ColumnBlockSize = WorkBlock.InnerSize;
+
+    if (!WorkBlock.InnerReduced && size_t(ThreadCount) > WorkBlock.OuterKeptCount) {
+
+        size_t ColumnBlocks = MlasDivRoundup(size_t(ThreadCount), WorkBlock.OuterKeptCount);
+        ColumnBlocks = std::min(ColumnBlocks, MlasDivRoundup(WorkBlock.InnerSize, MLAS_REDUCE_COLUMN_GRANULARITY));
+
+        size_t ColumnBlockSize = MlasDivRoundup(WorkBlock.InnerSize, ColumnBlocks);
+        ColumnBlockSize = MlasDivRoundup(ColumnBlockSize, MLAS_REDUCE_COLUMN_GRANULARITY) * MLAS_REDUCE_COLUMN_GRANULARITY;
+
+        WorkBlock.ColumnBlockSize = ColumnBlockSize;
+        WorkBlock.ColumnBlocks = MlasDivRoundup(WorkBlock.InnerSize, ColumnBlockSize);
+        TotalUnits *= WorkBlock.ColumnBlocks;
+    }
+
+    //
+    // Partition the reduced positions when there are still fewer output
+    // units than threads, with rows split into blocks if needed.
+    //
+
+    if (ThreadCount > 1 && TotalUnits < size_t(ThreadCount)) {
+
+        WorkBlock.RowBlocks = 1;
+        WorkBlock.RowBlockSize = WorkBlock.InnerSize;
+
+        if (WorkBlock.InnerReduced && WorkBlock.OuterReducedCount < size_t(ThreadCount)) {
+
+            const size_t RowBlocks = MlasDivRoundup(size_t(ThreadCount), WorkBlock.OuterReducedCount);
+            size_t RowBlockSize = std::max(MlasDivRoundup(WorkBlock.InnerSize, RowBlocks), MLAS_REDUCE_ROW_GRANULARITY);
+            RowBlockSize = std::min(RowBlockSize, WorkBlock.InnerSize);
+
+            WorkBlock.RowBlockSize = RowBlockSize;
+            WorkBlock.RowBlocks = MlasDivRoundup(WorkBlock.InnerSize, RowBlockSize);
+        }
+
+        const size_t TotalSegments = WorkBlock.OuterReducedCount * WorkBlock.RowBlocks;
+
+        if (TotalSegments > 1) {
+
+            if (size_t(ThreadCount) > TotalSegments) {
+                ThreadCount = ptrdiff_t(TotalSegments);
+            }
+
+            std::vector<typename Op::Acc> Partials(size_t(ThreadCount) * WorkBlock.OutputCount);
+            std::vector<size_t> PartialCounts(static_cast<size_t>(ThreadCount));
+
+            WorkBlock.Partials = Partials.data();
+            WorkBlock.PartialCounts = PartialCounts.data();
+            WorkBlock.ThreadCount = ThreadCount;
+
+            MlasExecuteThreaded(MlasReduceSplitThreaded<Op>, &WorkBlock, ThreadCount, ThreadPool);
+
+            for (size_t i = 0; i < WorkBlock.OutputCount; i++) {
+
+                typename Op::Acc Value = Partials[i];
+                size_t Count = PartialCounts[0];
+
+                for (ptrdiff_t t = 1; t < ThreadCount; t++) {
+                    Value = Op::Combine(Value, Count, Partials[size_t(t) * WorkBlock.OutputCount + i], PartialCounts[t]);
+                    Count += PartialCounts[t];
+                }
+
+                Op::Store(&WorkBlock, i, Value, ReduceCount);
+            }
+
+            return;
+        }
+    }
+
+    if (size_t(ThreadCount) > TotalUnits) {
+        ThreadCount = ptrdiff_t(TotalUnits);
+    }
+
+    WorkBlock.ThreadCount = ThreadCount;
+
+    MlasExecuteThreaded(MlasReduceOutputThreaded<Op>, &WorkBlock, ThreadCount, ThreadPool);
+}
+
+template<typename T>
+void
+MLASCALL
+MlasReduce(
+    MLAS_REDUCE_KIND Kind,
+    size_t Rank,
+    const size_t* InputShape,
+    const bool* ReduceAxes,
+    const T* Input,
+    T* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces a tensor over any set of axes.
+
+Arguments:
+
+    Kind - Supplies the reduction operation.
+
+    Rank - Supplies the rank of the input tensor.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    ReduceAxes - Supplies a flag for each dimension that is true if the
+        dimension is reduced.
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor, with the kept dimensions in input
+        order.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_REDUCE_WORK_BLOCK<T> WorkBlock;
+
+    WorkBlock.Input = Input;
+    WorkBlock.Output = Output;
+
+    const size_t ElementCost = std::is_same<T, MLAS_FP16>::value ? 2 : 1;
+
+    switch (Kind) {
+        case MlasReduceSum:
+            MlasReduceExecute<MLAS_REDUCE_OPERATION<MlasReduceSum, T>>(
+                Rank, InputShape, ReduceAxes, WorkBlock, ElementCost, ThreadPool);
+            break;
+        case MlasReduceMean:
+            MlasReduceExecute<MLAS_REDUCE_OPERATION<MlasReduceMean, T>>(
+                Rank, InputShape, ReduceAxes, WorkBlock, ElementCost, ThreadPool);
+            break;
+        case MlasReduceSumSquare:
+            MlasReduceExecute<MLAS_REDUCE_OPERATION<MlasReduceSumSquare, T>>(
+                Rank, InputShape, ReduceAxes, WorkBlock, ElementCost, ThreadPool);
+            break;
+        case MlasReduceMax:
+            MlasReduceExecute<MLAS_REDUCE_OPERATION<MlasReduceMax, T>>(
+                Rank, InputShape, ReduceAxes, WorkBlock, ElementCost, ThreadPool);
+            break;
+        case MlasReduceMin:
+            MlasReduceExecute<MLAS_REDUCE_OPERATION<MlasReduceMin, T>>(
+                Rank, InputShape, ReduceAxes, WorkBlock, ElementCost, ThreadPool);
+            break;
+        default:
+            MLAS_THROW_EX(std::invalid_argument, "Unknown reduction operation");
+    }
+}
+
+void
+MLASCALL
+MlasReduceMeanVariance(
+    size_t Rank,
+    const size_t* InputShape,
+    const bool* ReduceAxes,
+    const float* Input,
+    float* Mean,
+    float* Variance,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the mean and the population variance of a tensor
+    over any set of axes.
+
+Arguments:
+
+    Rank - Supplies the rank of the input tensor.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    ReduceAxes - Supplies a flag for each dimension that is true if the
+        dimension is reduced.
+
+    Input - Supplies the input tensor.
+
+    Mean - Supplies the mean output tensor.
+
+    Variance - Supplies the variance output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_REDUCE_WORK_BLOCK<float> WorkBlock;
+
+    WorkBlock.Input = Input;
+    WorkBlock.Mean = Mean;
+    WorkBlock.Variance = Variance;
+
+    MlasReduceExecute<MLAS_REDUCE_MEAN_VARIANCE_OPERATION>(Rank, InputShape, ReduceAxes, WorkBlock, 2, ThreadPool);
+}
+
+template
+void
+MLASCALL
+MlasReduce<float>(
+    MLAS_REDUCE_KIND Kind,
+    size_t Rank,
+    const size_t* InputShape,
+    const bool* ReduceAxes,
+    const float* Input,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasReduce<MLAS_FP16>(
+    MLAS_REDUCE_KIND Kind,
+    size_t Rank,
+    const size_t* InputShape,
+    const bool* ReduceAxes,
+    const MLAS_FP16* Input,
+    MLAS_FP16* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasReduce<int32_t>(
+    MLAS_REDUCE_KIND Kind,
+    size_t Rank,
+    const size_t* InputShape,
+    const bool* ReduceAxes,
+    const int32_t* Input,
+    int32_t* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasReduce<int64_t>(
+    MLAS_REDUCE_KIND Kind,
+    size_t Rank,
+    const size_t* InputShape,
+    const bool* ReduceAxes,
+    const int64_t* Input,
+    int64_t* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
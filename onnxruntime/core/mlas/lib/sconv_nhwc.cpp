@@ -0,0 +1,388 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    sconv_nhwc.cpp
+
+Abstract:
+
+    This module implements the single precision depthwise convolution and
+    pooling routines for tensors in NHWC format.
+
+    The routines consume an indirection buffer that supplies KernelSize
+    pointers for each output pixel, where each pointer addresses the
+    contiguous channels of an input pixel.
+
+--*/
+
+#include "mlasi.h"
+
+void
+MLASCALL
+MlasConvDepthwise(
+    const float* const* Input,
+    const float* Filter,
+    const float* Bias,
+    float* Output,
+    size_t Channels,
+    size_t OutputCount,
+    size_t KernelSize
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision depthwise convolution for
+    tensors in NHWC format.
+
+Arguments:
+
+    Input - Supplies the indirection buffer for the input tensor. Padding
+        positions must point to a buffer of Channels zero values.
+
+    Filter - Supplies the filter tensor in HWC format, one filter per channel.
+
+    Bias - Optionally supplies the bias vector.
+
+    Output - Supplies the output tensor in NHWC format.
+
+    Channels - Supplies the number of channels.
+
+    OutputCount - Supplies the number of output pixels.
+
+    KernelSize - Supplies the number of elements of the kernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (OutputCount > 0) {
+
+        size_t ChannelOffset = 0;
+        size_t c = Channels;
+
+        while (c >= 16) {
+
+            MLAS_FLOAT32X4 Accumulator0 = MlasZeroFloat32x4();
+            MLAS_FLOAT32X4 Accumulator1 = MlasZeroFloat32x4();
+            MLAS_FLOAT32X4 Accumulator2 = MlasZeroFloat32x4();
+            MLAS_FLOAT32X4 Accumulator3 = MlasZeroFloat32x4();
+
+            if (Bias != nullptr) {
+                Accumulator0 = MlasLoadFloat32x4(&Bias[ChannelOffset]);
+                Accumulator1 = MlasLoadFloat32x4(&Bias[ChannelOffset + 4]);
+                Accumulator2 = MlasLoadFloat32x4(&Bias[ChannelOffset + 8]);
+                Accumulator3 = MlasLoadFloat32x4(&Bias[ChannelOffset + 12]);
+            }
+
+            const float* filter = Filter + ChannelOffset;
+
+            for (size_t k = 0; k < KernelSize; k++) {
+
+                const float* input = Input[k] + ChannelOffset;
+
+                Accumulator0 = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(input), MlasLoadFloat32x4(filter), Accumulator0);
+                Accumulator1 = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(input + 4), MlasLoadFloat32x4(filter + 4), Accumulator1);
+                Accumulator2 = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(input + 8), MlasLoadFloat32x4(filter + 8), Accumulator2);
+                Accumulator3 = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(input + 12), MlasLoadFloat32x4(filter + 12), Accumulator3);
+
+                filter += Channels;
+            }
+
+            MlasStoreFloat32x4(&Output[0], Accumulator0);
+            MlasStoreFloat32x4(&Output[4], Accumulator1);
+            MlasStoreFloat32x4(&Output[8], Accumulator2);
+            MlasStoreFloat32x4(&Output[12], Accumulator3);
+
+            Output += 16;
+            ChannelOffset += 16;
+            c -= 16;
+        }
+
+        while (c >= 4) {
+
+            MLAS_FLOAT32X4 Accumulator = (Bias != nullptr) ?
+                MlasLoadFloat32x4(&Bias[ChannelOffset]) : MlasZeroFloat32x4();
+
+            const float* filter = Filter + ChannelOffset;
+
+            for (size_t k = 0; k < KernelSize; k++) {
+                Accumulator = MlasMultiplyAddFloat32x4(MlasLoadFloat32x4(Input[k] + ChannelOffset),
+                    MlasLoadFloat32x4(filter), Accumulator);
+                filter += Channels;
+            }
+
+            MlasStoreFloat32x4(Output, Accumulator);
+
+            Output += 4;
+            ChannelOffset += 4;
+            c -= 4;
+        }
+
+        while (c > 0) {
+
+            float Accumulator = (Bias != nullptr) ? Bias[ChannelOffset] : 0.0f;
+
+            const float* filter = Filter + ChannelOffset;
+
+            for (size_t k = 0; k < KernelSize; k++) {
+                Accumulator += Input[k][ChannelOffset] * filter[0];
+                filter += Channels;
+            }
+
+            *Output++ = Accumulator;
+
+            ChannelOffset += 1;
+            c -= 1;
+        }
+
+        Input += KernelSize;
+        OutputCount -= 1;
+    }
+}
+
+//
+// Define the aggregation policies for the pooling routines.
+//
+
+struct MLAS_NHWC_MAXIMUM_POOLING
+{
+    static MLAS_FLOAT32X4 InitialVector() { return MlasBroadcastFloat32x4(std::numeric_limits<float>::lowest()); }
+
+    static float InitialValue() { return std::numeric_limits<float>::lowest(); }
+
+    static MLAS_FLOAT32X4 Aggregate(MLAS_FLOAT32X4 Vector, MLAS_FLOAT32X4 Element) { return MlasMaximumFloat32x4(Vector, Element); }
+
+    static float Aggregate(float Value, float Element) { return std::max(Value, Element); }
+
+    static MLAS_FLOAT32X4 Summarize(MLAS_FLOAT32X4 Vector, size_t Count) { MLAS_UNREFERENCED_PARAMETER(Count); return Vector; }
+
+    static float Summarize(float Value, size_t Count) { MLAS_UNREFERENCED_PARAMETER(Count); return Value; }
+};
+
+struct MLAS_NHWC_AVERAGE_POOLING
+{
+    static MLAS_FLOAT32X4 InitialVector() { return MlasZeroFloat32x4(); }
+
+    static float InitialValue() { return 0.0f; }
+
+    static MLAS_FLOAT32X4 Aggregate(MLAS_FLOAT32X4 Vector, MLAS_FLOAT32X4 Element) { return MlasAddFloat32x4(Vector, Element); }
+
+    static float Aggregate(float Value, float Element) { return Value + Element; }
+
+    static MLAS_FLOAT32X4 Summarize(MLAS_FLOAT32X4 Vector, size_t Count) { return MlasMultiplyFloat32x4(Vector, MlasBroadcastFloat32x4(1.0f / float(Count))); }
+
+    static float Summarize(float Value, size_t Count) { return Value / float(Count); }
+};
+
+template<typename PoolingType>
+void
+MlasNhwcPoolKernel(
+    const float* const* Input,
+    float* Output,
+    size_t Channels,
+    size_t OutputCount,
+    size_t KernelSize
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision pooling operation for
+    tensors in NHWC format.
+
+Arguments:
+
+    Input - Supplies the indirection buffer for the input tensor. Padding
+        positions that are excluded from the pooling operation are nullptr.
+
+    Output - Supplies the output tensor in NHWC format.
+
+    Channels - Supplies the number of channels.
+
+    OutputCount - Supplies the number of output pixels.
+
+    KernelSize - Supplies the number of elements of the kernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (OutputCount > 0) {
+
+        //
+        // Count the number of valid elements of the pooling window.
+        //
+
+        size_t ValidCount = 0;
+
+        for (size_t k = 0; k < KernelSize; k++) {
+            if (Input[k] != nullptr) {
+                ValidCount++;
+            }
+        }
+
+        if (ValidCount == 0) {
+            std::fill_n(Output, Channels, 0.0f);
+            Output += Channels;
+            Input += KernelSize;
+            OutputCount -= 1;
+            continue;
+        }
+
+        size_t ChannelOffset = 0;
+        size_t c = Channels;
+
+        while (c >= 16) {
+
+            MLAS_FLOAT32X4 Vector0 = PoolingType::InitialVector();
+            MLAS_FLOAT32X4 Vector1 = Vector0;
+            MLAS_FLOAT32X4 Vector2 = Vector0;
+            MLAS_FLOAT32X4 Vector3 = Vector0;
+
+            for (size_t k = 0; k < KernelSize; k++) {
+
+                if (Input[k] == nullptr) {
+                    continue;
+                }
+
+                const float* input = Input[k] + ChannelOffset;
+
+                Vector0 = PoolingType::Aggregate(Vector0, MlasLoadFloat32x4(input));
+                Vector1 = PoolingType::Aggregate(Vector1, MlasLoadFloat32x4(input + 4));
+                Vector2 = PoolingType::Aggregate(Vector2, MlasLoadFloat32x4(input + 8));
+                Vector3 = PoolingType::Aggregate(Vector3, MlasLoadFloat32x4(input + 12));
+            }
+
+            MlasStoreFloat32x4(&Output[0], PoolingType::Summarize(Vector0, ValidCount));
+            MlasStoreFloat32x4(&Output[4], PoolingType::Summarize(Vector1, ValidCount));
+            MlasStoreFloat32x4(&Output[8], PoolingType::Summarize(Vector2, ValidCount));
+            MlasStoreFloat32x4(&Output[12], PoolingType::Summarize(Vector3, ValidCount));
+
+            Output += 16;
+            ChannelOffset += 16;
+            c -= 16;
+        }
+
+        while (c >= 4) {
+
+            MLAS_FLOAT32X4 Vector = PoolingType::InitialVector();
+
+            for (size_t k = 0; k < KernelSize; k++) {
+                if (Input[k] != nullptr) {
+                    Vector = PoolingType::Aggregate(Vector, MlasLoadFloat32x4(Input[k] + ChannelOffset));
+                }
+            }
+
+            MlasStoreFloat32x4(Output, PoolingType::Summarize(Vector, ValidCount));
+
+            Output += 4;
+            ChannelOffset += 4;
+            c -= 4;
+        }
+
+        while (c > 0) {
+
+            float Value = PoolingType::InitialValue();
+
+            for (size_t k = 0; k < KernelSize; k++) {
+                if (Input[k] != nullptr) {
+                    Value = PoolingType::Aggregate(Value, Input[k][ChannelOffset]);
+                }
+            }
+
+            *Output++ = PoolingType::Summarize(Value, ValidCount);
+
+            ChannelOffset += 1;
+            c -= 1;
+        }
+
+        Input += KernelSize;
+        OutputCount -= 1;
+    }
+}
+
+void
+MLASCALL
+MlasNhwcMaxPool(
+    const float* const* Input,
+    float* Output,
+    size_t Channels,
+    size_t OutputCount,
+    size_t KernelSize
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision maximum pooling operation
+    for tensors in NHWC format.
+
+Arguments:
+
+    Input - Supplies the indirection buffer for the input tensor.
+
+    Output - Supplies the output tensor in NHWC format.
+
+    Channels - Supplies the number of channels.
+
+    OutputCount - Supplies the number of output pixels.
+
+    KernelSize - Supplies the number of elements of the kernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasNhwcPoolKernel<MLAS_NHWC_MAXIMUM_POOLING>(Input, Output, Channels, OutputCount, KernelSize);
+}
+
+void
+MLASCALL
+MlasNhwcAvgPool(
+    const float* const* Input,
+    float* Output,
+    size_t Channels,
+    size_t OutputCount,
+    size_t KernelSize
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision average pooling operation
+    for tensors in NHWC format.
+
+    Padding positions that supply nullptr are excluded from the average, while
+    padding positions that point to zero values are included.
+
+Arguments:
+
+    Input - Supplies the indirection buffer for the input tensor.
+
+    Output - Supplies the output tensor in NHWC format.
+
+    Channels - Supplies the number of channels.
+
+    OutputCount - Supplies the number of output pixels.
+
+    KernelSize - Supplies the number of elements of the kernel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MlasNhwcPoolKernel<MLAS_NHWC_AVERAGE_POOLING>(Input, Output, Channels, OutputCount, KernelSize);
+}
@@ -0,0 +1,585 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    topk.cpp
+
+Abstract:
+
+    This module implements the top-K selection operation.
+
+    Each row is converted to single precision keys, negated when selecting
+    the smallest elements, so that the selection always looks for the
+    largest keys. A running threshold holds the K-th best key found so far:
+    blocks of keys whose vector maximum does not beat the threshold are
+    skipped, and the remaining keys that beat the threshold are appended to
+    a candidate buffer. When the buffer fills, it is reduced to the best K
+    candidates with a partial sort and the threshold is raised.
+
+    For the small K typical of ranking and sampling, almost every block is
+    rejected by a few vector maximum operations after the first few
+    thousand elements.
+
+--*/
+
+#include "mlasi.h"
+
+#include <vector>
+
+//
+// Define the number of input elements each thread should process before
+// using another thread.
+//
+
+constexpr size_t MLAS_TOPK_THREAD_COMPLEXITY = 65536;
+
+//
+// Define the minimum number of elements of a row segment when a row is split
+// across threads.
+//
+
+constexpr size_t MLAS_TOPK_MINIMUM_SEGMENT = 16384;
+
+//
+// Define the number of keys converted and filtered per block.
+//
+
+constexpr size_t MLAS_TOPK_BLOCK_SIZE = 64;
+
+struct MLAS_TOPK_CANDIDATE {
+    float Key;
+    int64_t Index;
+};
+
+template<typename T>
+struct MLAS_TOPK_WORK_BLOCK {
+    const T* Input;
+    size_t Rows;
+    size_t N;
+    size_t K;
+    bool Largest;
+    bool Sorted;
+    T* Values;
+    int64_t* Indices;
+    size_t Segments;
+    size_t SegmentSize;
+    MLAS_TOPK_CANDIDATE* Candidates;
+    size_t* CandidateCounts;
+    ptrdiff_t ThreadCount;
+};
+
+MLAS_FORCEINLINE
+bool
+MlasTopKBetter(
+    const MLAS_TOPK_CANDIDATE& Candidate1,
+    const MLAS_TOPK_CANDIDATE& Candidate2
+    )
+{
+    return Candidate1.Key > Candidate2.Key ||
+           (Candidate1.Key == Candidate2.Key && Candidate1.Index < Candidate2.Index);
+}
+
+template<typename T>
+const float*
+MlasTopKConvertKeys(
+    const T* Input,
+    float* Keys,
+    size_t N,
+    bool Largest
+    )
+/*++
+
+Routine Description:
+
+    This routine converts a block of input elements to single precision keys
+    where larger keys are better.
+
+Arguments:
+
+    Input - Supplies the input elements.
+
+    Keys - Supplies a buffer of MLAS_TOPK_BLOCK_SIZE keys.
+
+    N - Supplies the number of elements to convert.
+
+    Largest - Supplies true if the largest elements are selected.
+
+Return Value:
+
+    Returns the address of the keys, which is the input itself for single
+    precision elements when selecting the largest elements.
+
+--*/
+{
+    if constexpr (std::is_same<T, float>::value) {
+
+        if (Largest) {
+            return Input;
+        }
+
+        size_t i = 0;
+
+        for (; i + 4 <= N; i += 4) {
+            MlasStoreFloat32x4(Keys + i, MlasSubtractFloat32x4(MlasZeroFloat32x4(), MlasLoadFloat32x4(Input + i)));
+        }
+
+        for (; i < N; i++) {
+            Keys[i] = -Input[i];
+        }
+
+    } else if constexpr (std::is_same<T, MLAS_FP16>::value) {
+
+        MlasConvertHalfToFloatBlock(Input, Keys, N);
+
+        if (!Largest) {
+
+            size_t i = 0;
+
+            for (; i + 4 <= N; i += 4) {
+                MlasStoreFloat32x4(Keys + i, MlasSubtractFloat32x4(MlasZeroFloat32x4(), MlasLoadFloat32x4(Keys + i)));
+            }
+
+            for (; i < N; i++) {
+                Keys[i] = -Keys[i];
+            }
+        }
+
+    } else {
+
+        const uint32_t SignFlip = Largest ? 0 : 0x80000000;
+
+        for (size_t i = 0; i < N; i++) {
+            uint32_t Bits = uint32_t(Input[i].val) << 16;
+            Bits ^= SignFlip;
+            float Value;
+            std::memcpy(&Value, &Bits, sizeof(Value));
+            Keys[i] = Value;
+        }
+    }
+
+    return Keys;
+}
+
+MLAS_FORCEINLINE
+float
+MlasTopKBlockMaximum(
+    const float* Keys
+    )
+{
+    MLAS_FLOAT32X4 Maximum0 = MlasMaximumFloat32x4(MlasLoadFloat32x4(Keys), MlasLoadFloat32x4(Keys + 4));
+    MLAS_FLOAT32X4 Maximum1 = MlasMaximumFloat32x4(MlasLoadFloat32x4(Keys + 8), MlasLoadFloat32x4(Keys + 12));
+
+    for (size_t i = 16; i < MLAS_TOPK_BLOCK_SIZE; i += 16) {
+        Maximum0 = MlasMaximumFloat32x4(Maximum0, MlasLoadFloat32x4(Keys + i));
+        Maximum1 = MlasMaximumFloat32x4(Maximum1, MlasLoadFloat32x4(Keys + i + 4));
+        Maximum0 = MlasMaximumFloat32x4(Maximum0, MlasLoadFloat32x4(Keys + i + 8));
+        Maximum1 = MlasMaximumFloat32x4(Maximum1, MlasLoadFloat32x4(Keys + i + 12));
+    }
+
+    return MlasReduceMaximumFloat32x4(MlasMaximumFloat32x4(Maximum0, Maximum1));
+}
+
+template<typename T>
+size_t
+MlasTopKSelectSegment(
+    const T* Input,
+    size_t Begin,
+    size_t End,
+    size_t K,
+    bool Largest,
+    MLAS_TOPK_CANDIDATE* Buffer,
+    size_t Capacity
+    )
+/*++
+
+Routine Description:
+
+    This routine selects the best K elements of a range of a row.
+
+Arguments:
+
+    Input - Supplies the input row.
+
+    Begin - Supplies the index of the first element of the range.
+
+    End - Supplies the index after the last element of the range.
+
+    K - Supplies the number of elements to select.
+
+    Largest - Supplies true if the largest elements are selected.
+
+    Buffer - Supplies the candidate buffer.
+
+    Capacity - Supplies the number of candidates of the buffer, greater than
+        K unless the range holds at most K elements.
+
+Return Value:
+
+    Returns the number of selected candidates, stored unordered at the start
+    of the buffer.
+
+--*/
+{
+    MLAS_DECLSPEC_ALIGN(float KeyBuffer[MLAS_TOPK_BLOCK_SIZE], 16);
+
+    size_t Count = 0;
+    float Threshold = std::numeric_limits<float>::infinity();
+
+    for (size_t b = Begin; b < End; b += MLAS_TOPK_BLOCK_SIZE) {
+
+        const size_t n = std::min(End - b, MLAS_TOPK_BLOCK_SIZE);
+        const float* Keys = MlasTopKConvertKeys(Input + b, KeyBuffer, n, Largest);
+
+        size_t i = 0;
+
+        //
+        // The first K elements are accepted unconditionally. The worst of
+        // these bounds the K-th best key from below.
+        //
+
+        if (Count < K) {
+
+            for (; i < n && Count < K; i++) {
+                Buffer[Count++] = MLAS_TOPK_CANDIDATE{Keys[i], int64_t(b + i)};
+            }
+
+            if (Count == K) {
+                for (size_t j = 0; j < K; j++) {
+                    Threshold = std::min(Threshold, Buffer[j].Key);
+                }
+            }
+
+        } else if (n == MLAS_TOPK_BLOCK_SIZE && !(MlasTopKBlockMaximum(Keys) > Threshold)) {
+            continue;
+        }
+
+        //
+        // Later elements that equal the threshold lose the tie to the
+        // earlier element holding it, so only keys that strictly beat the
+        // threshold become candidates.
+        //
+
+        for (; i < n; i++) {
+
+            if (Keys[i] > Threshold) {
+
+                Buffer[Count++] = MLAS_TOPK_CANDIDATE{Keys[i], int64_t(b + i)};
+
+                if (Count == Capacity) {
+                    std::nth_element(Buffer, Buffer + K - 1, Buffer + Count, MlasTopKBetter);
+                    Threshold = Buffer[K - 1].Key;
+                    Count = K;
+                }
+            }
+        }
+    }
+
+    if (Count > K) {
+        std::nth_element(Buffer, Buffer + K - 1, Buffer + Count, MlasTopKBetter);
+        Count = K;
+    }
+
+    return Count;
+}
+
+template<typename T>
+void
+MlasTopKStoreRow(
+    const MLAS_TOPK_WORK_BLOCK<T>* WorkBlock,
+    size_t Row,
+    MLAS_TOPK_CANDIDATE* Candidates,
+    size_t Count
+    )
+/*++
+
+Routine Description:
+
+    This routine selects the best K of a set of candidates of a row and
+    stores them to the outputs.
+
+Arguments:
+
+    WorkBlock - Supplies the work block.
+
+    Row - Supplies the row index.
+
+    Candidates - Supplies the candidates.
+
+    Count - Supplies the number of candidates, at least K.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t K = WorkBlock->K;
+
+    if (Count > K) {
+        std::nth_element(Candidates, Candidates + K - 1, Candidates + Count, MlasTopKBetter);
+    }
+
+    if (WorkBlock->Sorted) {
+        std::sort(Candidates, Candidates + K, MlasTopKBetter);
+    }
+
+    const T* Input = WorkBlock->Input + Row * WorkBlock->N;
+    T* Values = WorkBlock->Values + Row * K;
+    int64_t* Indices = WorkBlock->Indices + Row * K;
+
+    for (size_t i = 0; i < K; i++) {
+        Values[i] = Input[Candidates[i].Index];
+        Indices[i] = Candidates[i].Index;
+    }
+}
+
+template<typename T>
+void
+MlasTopKThreaded(
+    void* Context,
+    ptrdiff_t ThreadId
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to select the top elements
+    of a range of row segments.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    ThreadId - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (const MLAS_TOPK_WORK_BLOCK<T>*)Context;
+
+    const size_t K = WorkBlock->K;
+    const size_t Segments = WorkBlock->Segments;
+    const size_t SegmentSize = WorkBlock->SegmentSize;
+
+    size_t UnitIndex;
+    size_t UnitCount;
+
+    MlasPartitionWork(ThreadId, WorkBlock->ThreadCount, WorkBlock->Rows * Segments, &UnitIndex, &UnitCount);
+
+    if (UnitCount == 0) {
+        return;
+    }
+
+    const size_t Capacity = std::min(SegmentSize, K + std::max(3 * K, size_t(256)));
+
+    std::vector<MLAS_TOPK_CANDIDATE> Buffer(Capacity);
+
+    for (size_t Unit = UnitIndex; Unit < UnitIndex + UnitCount; Unit++) {
+
+        const size_t Row = Unit / Segments;
+        const size_t Begin = (Unit % Segments) * SegmentSize;
+        const size_t End = std::min(Begin + SegmentSize, WorkBlock->N);
+
+        const size_t Count = MlasTopKSelectSegment(WorkBlock->Input + Row * WorkBlock->N, Begin, End, K,
+                                                   WorkBlock->Largest, Buffer.data(), Capacity);
+
+        if (Segments == 1) {
+            MlasTopKStoreRow(WorkBlock, Row, Buffer.data(), Count);
+        } else {
+            std::copy_n(Buffer.data(), Count, WorkBlock->Candidates + Unit * K);
+            WorkBlock->CandidateCounts[Unit] = Count;
+        }
+    }
+}
+
+template<typename T>
+void
+MLASCALL
+MlasTopK(
+    const T* Input,
+    size_t Rows,
+    size_t N,
+    size_t K,
+    bool Largest,
+    bool Sorted,
+    T* Values,
+    int64_t* Indices,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine selects the K largest or smallest elements of each row.
+
+Arguments:
+
+    Input - Supplies the input rows.
+
+    Rows - Supplies the number of rows.
+
+    N - Supplies the number of elements in each row.
+
+    K - Supplies the number of elements to select.
+
+    Largest - Supplies true to select the largest elements, else the
+        smallest elements.
+
+    Sorted - Supplies true to order the selected elements from best to
+        worst.
+
+    Values - Supplies the output values.
+
+    Indices - Supplies the output indices.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (K > N) {
+        MLAS_THROW_EX(std::invalid_argument, "K exceeds the number of elements in a row");
+    }
+
+    if (K == 0 || Rows == 0) {
+        return;
+    }
+
+    MLAS_TOPK_WORK_BLOCK<T> WorkBlock;
+
+    WorkBlock.Input = Input;
+    WorkBlock.Rows = Rows;
+    WorkBlock.N = N;
+    WorkBlock.K = K;
+    WorkBlock.Largest = Largest;
+    WorkBlock.Sorted = Sorted;
+    WorkBlock.Values = Values;
+    WorkBlock.Indices = Indices;
+    WorkBlock.Segments = 1;
+    WorkBlock.SegmentSize = N;
+    WorkBlock.Candidates = nullptr;
+    WorkBlock.CandidateCounts = nullptr;
+
+    //
+    // Compute the number of target threads given the amount of input.
+    //
+
+    ptrdiff_t ThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    const size_t TargetThreadCount = (Rows * N / MLAS_TOPK_THREAD_COMPLEXITY) + 1;
+
+    if (size_t(ThreadCount) > TargetThreadCount) {
+        ThreadCount = ptrdiff_t(TargetThreadCount);
+    }
+
+    //
+    // Split long rows into segments when there are fewer rows than threads.
+    // Each segment must be much longer than K for the threshold to filter.
+    //
+
+    if (size_t(ThreadCount) > Rows) {
+
+        const size_t MinimumSegment = std::max(MLAS_TOPK_MINIMUM_SEGMENT, 4 * K);
+        const size_t Segments = std::min(MlasDivRoundup(size_t(ThreadCount), Rows), N / MinimumSegment);
+
+        if (Segments > 1) {
+            WorkBlock.SegmentSize = MlasDivRoundup(N, Segments);
+            WorkBlock.Segments = MlasDivRoundup(N, WorkBlock.SegmentSize);
+        }
+    }
+
+    const size_t TotalUnits = Rows * WorkBlock.Segments;
+
+    if (size_t(ThreadCount) > TotalUnits) {
+        ThreadCount = ptrdiff_t(TotalUnits);
+    }
+
+    WorkBlock.ThreadCount = ThreadCount;
+
+    if (WorkBlock.Segments == 1) {
+        MlasExecuteThreaded(MlasTopKThreaded<T>, &WorkBlock, ThreadCount, ThreadPool);
+        return;
+    }
+
+    std::vector<MLAS_TOPK_CANDIDATE> Candidates(TotalUnits * K);
+    std::vector<size_t> CandidateCounts(TotalUnits);
+
+    WorkBlock.Candidates = Candidates.data();
+    WorkBlock.CandidateCounts = CandidateCounts.data();
+
+    MlasExecuteThreaded(MlasTopKThreaded<T>, &WorkBlock, ThreadCount, ThreadPool);
+
+    //
+    // Merge the candidates of the segments of each row.
+    //
+
+    for (size_t Row = 0; Row < Rows; Row++) {
+
+        MLAS_TOPK_CANDIDATE* RowCandidates = Candidates.data() + Row * WorkBlock.Segments * K;
+        size_t Count = 0;
+
+        for (size_t s = 0; s < WorkBlock.Segments; s++) {
+            const size_t SegmentCount = CandidateCounts[Row * WorkBlock.Segments + s];
+            std::copy_n(RowCandidates + s * K, SegmentCount, RowCandidates + Count);
+            Count += SegmentCount;
+        }
+
+        MlasTopKStoreRow(&WorkBlock, Row, RowCandidates, Count);
+    }
+}
+
+template
+void
+MLASCALL
+MlasTopK<float>(
+    const float* Input,
+    size_t Rows,
+    size_t N,
+    size_t K,
+    bool Largest,
+    bool Sorted,
+    float* Values,
+    int64_t* Indices,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasTopK<MLAS_FP16>(
+    const MLAS_FP16* Input,
+    size_t Rows,
+    size_t N,
+    size_t K,
+    bool Largest,
+    bool Sorted,
+    MLAS_FP16* Values,
+    int64_t* Indices,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+template
+void
+MLASCALL
+MlasTopK<MLAS_BF16>(
+    const MLAS_BF16* Input,
+    size_t Rows,
+    size_t N,
+    size_t K,
+    bool Largest,
+    bool Sorted,
+    MLAS_BF16* Values,
+    int64_t* Indices,
+    MLAS_THREADPOOL* ThreadPool
+    );
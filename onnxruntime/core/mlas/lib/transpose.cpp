@@ -121,6 +121,22 @@ MlasTranspose8x8Block(
     _mm_storeh_pi((__m64*)&Output[OutputStride * 7], d3);
 }
 
+MLAS_FORCEINLINE
+void
+MlasTranspose2x2Block(
+    const uint64_t* Input,
+    size_t InputStride,
+    uint64_t* Output,
+    size_t OutputStride
+    )
+{
+    __m128i a0 = _mm_loadu_si128((const __m128i*)&Input[InputStride * 0]);
+    __m128i a1 = _mm_loadu_si128((const __m128i*)&Input[InputStride * 1]);
+
+    _mm_storeu_si128((__m128i*)&Output[OutputStride * 0], _mm_unpacklo_epi64(a0, a1));
+    _mm_storeu_si128((__m128i*)&Output[OutputStride * 1], _mm_unpackhi_epi64(a0, a1));
+}
+
 #elif defined(MLAS_NEON_INTRINSICS)
 
 MLAS_FORCEINLINE
@@ -220,6 +236,22 @@ MlasTranspose8x8Block(
     vst1_u8(&Output[OutputStride * 7], vreinterpret_u8_u32(d3.val[1]));
 }
 
+MLAS_FORCEINLINE
+void
+MlasTranspose2x2Block(
+    const uint64_t* Input,
+    size_t InputStride,
+    uint64_t* Output,
+    size_t OutputStride
+    )
+{
+    uint64x2_t a0 = vld1q_u64(&Input[InputStride * 0]);
+    uint64x2_t a1 = vld1q_u64(&Input[InputStride * 1]);
+
+    vst1q_u64(&Output[OutputStride * 0], vcombine_u64(vget_low_u64(a0), vget_low_u64(a1)));
+    vst1q_u64(&Output[OutputStride * 1], vcombine_u64(vget_high_u64(a0), vget_high_u64(a1)));
+}
+
 #elif defined(MLAS_TARGET_POWER)
 
 MLAS_FORCEINLINE
@@ -810,3 +842,636 @@ MlasTranspose(
         M,
         N);
 }
+
+//
+// Define the in-register block transpose used by the N-D transpose engine for
+// each element size. Element sizes without a block kernel on the current
+// target use a block size of one and fall back to scalar copies.
+//
+
+template<typename ElementType>
+struct MLAS_TRANSPOSE_ND_BLOCK
+{
+    static constexpr size_t BlockSize = 1;
+
+    static void Transpose(const ElementType*, size_t, ElementType*, size_t) {}
+};
+
+#if defined(MLAS_SSE2_INTRINSICS) || defined(MLAS_NEON_INTRINSICS) || defined(MLAS_TARGET_POWER)
+
+template<>
+struct MLAS_TRANSPOSE_ND_BLOCK<uint32_t>
+{
+    static constexpr size_t BlockSize = 4;
+
+    static void Transpose(const uint32_t* Input, size_t InputStride, uint32_t* Output, size_t OutputStride)
+    {
+        MlasTranspose4x4Block(Input, InputStride, Output, OutputStride);
+    }
+};
+
+#endif
+
+#if defined(MLAS_SSE2_INTRINSICS) || defined(MLAS_NEON_INTRINSICS)
+
+template<>
+struct MLAS_TRANSPOSE_ND_BLOCK<uint64_t>
+{
+    static constexpr size_t BlockSize = 2;
+
+    static void Transpose(const uint64_t* Input, size_t InputStride, uint64_t* Output, size_t OutputStride)
+    {
+        MlasTranspose2x2Block(Input, InputStride, Output, OutputStride);
+    }
+};
+
+template<>
+struct MLAS_TRANSPOSE_ND_BLOCK<uint16_t>
+{
+    static constexpr size_t BlockSize = 4;
+
+    static void Transpose(const uint16_t* Input, size_t InputStride, uint16_t* Output, size_t OutputStride)
+    {
+        MlasTranspose4x4Block(Input, InputStride, Output, OutputStride);
+    }
+};
+
+template<>
+struct MLAS_TRANSPOSE_ND_BLOCK<uint8_t>
+{
+    static constexpr size_t BlockSize = 8;
+
+    static void Transpose(const uint8_t* Input, size_t InputStride, uint8_t* Output, size_t OutputStride)
+    {
+        MlasTranspose8x8Block(Input, InputStride, Output, OutputStride);
+    }
+};
+
+#elif defined(MLAS_TARGET_POWER)
+
+template<>
+struct MLAS_TRANSPOSE_ND_BLOCK<uint8_t>
+{
+    static constexpr size_t BlockSize = 16;
+
+    static void Transpose(const uint8_t* Input, size_t InputStride, uint8_t* Output, size_t OutputStride)
+    {
+        MlasTranspose16x16Block(Input, InputStride, Output, OutputStride);
+    }
+};
+
+#endif
+
+//
+// Define the number of elements along each edge of a cache tile and the
+// minimum number of bytes to assign to a thread.
+//
+
+#define MLAS_TRANSPOSE_ND_TILE_EDGE             32
+#define MLAS_TRANSPOSE_ND_TILE_AREA             (MLAS_TRANSPOSE_ND_TILE_EDGE * MLAS_TRANSPOSE_ND_TILE_EDGE)
+#define MLAS_TRANSPOSE_ND_THREAD_BYTES          (64 * 1024)
+
+struct MLAS_TRANSPOSE_ND_WORK_BLOCK {
+    const uint8_t* Input;
+    uint8_t* Output;
+    ptrdiff_t ThreadCount;
+    size_t TotalWork;
+    size_t IterationRank;
+    size_t IterationShape[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t IterationInputStride[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t IterationOutputStride[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t BlockBytes;
+    size_t M;
+    size_t N;
+    size_t TileM;
+    size_t TileN;
+    size_t InputRowStride;
+    size_t OutputRowStride;
+};
+
+template<typename ElementType>
+void
+MlasTransposeNdTile(
+    const ElementType* Input,
+    size_t InputStride,
+    ElementType* Output,
+    size_t OutputStride,
+    size_t M,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes a tile of M rows by N columns where the input rows
+    and the output rows are separated by arbitrary strides.
+
+Arguments:
+
+    Input - Supplies the input tile.
+
+    InputStride - Supplies the number of elements between input rows.
+
+    Output - Supplies the output tile.
+
+    OutputStride - Supplies the number of elements between output rows.
+
+    M - Supplies the number of input rows (output columns).
+
+    N - Supplies the number of input columns (output rows).
+
+Return Value:
+
+    None.
+
+--*/
+{
+    constexpr size_t BlockSize = MLAS_TRANSPOSE_ND_BLOCK<ElementType>::BlockSize;
+
+    size_t n = 0;
+
+    if constexpr (BlockSize > 1) {
+
+        for (; n + BlockSize <= N; n += BlockSize) {
+
+            const ElementType* s = Input + n;
+            ElementType* d = Output + n * OutputStride;
+            size_t m = M;
+
+            while (m >= BlockSize) {
+
+                MLAS_TRANSPOSE_ND_BLOCK<ElementType>::Transpose(s, InputStride, d, OutputStride);
+
+                s += InputStride * BlockSize;
+                d += BlockSize;
+                m -= BlockSize;
+            }
+
+            while (m > 0) {
+
+                for (size_t j = 0; j < BlockSize; j++) {
+                    d[j * OutputStride] = s[j];
+                }
+
+                s += InputStride;
+                d += 1;
+                m -= 1;
+            }
+        }
+    }
+
+    //
+    // Transpose the remaining columns one output row at a time.
+    //
+
+    for (; n < N; n++) {
+
+        const ElementType* s = Input + n;
+        ElementType* d = Output + n * OutputStride;
+
+        for (size_t m = 0; m < M; m++) {
+            d[m] = s[m * InputStride];
+        }
+    }
+}
+
+template<typename ElementType>
+void
+MlasTransposeNdThreaded(
+    void* Context,
+    ptrdiff_t ThreadId
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of an
+    N-D transpose operation. Each unit of work is either a cache tile of the
+    two axes that are exchanged between the innermost input and output
+    positions, or a contiguous block copy when the innermost input axis
+    remains innermost in the output.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    ThreadId - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const auto* WorkBlock = (const MLAS_TRANSPOSE_ND_WORK_BLOCK*)Context;
+
+    size_t WorkIndex;
+    size_t WorkRemaining;
+
+    MlasPartitionWork(ThreadId, WorkBlock->ThreadCount, WorkBlock->TotalWork, &WorkIndex, &WorkRemaining);
+
+    if (WorkRemaining == 0) {
+        return;
+    }
+
+    const size_t IterationRank = WorkBlock->IterationRank;
+    const size_t* IterationShape = WorkBlock->IterationShape;
+    const size_t* IterationInputStride = WorkBlock->IterationInputStride;
+    const size_t* IterationOutputStride = WorkBlock->IterationOutputStride;
+
+    //
+    // Decompose the starting work index into the iteration index space.
+    //
+
+    size_t Index[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    const uint8_t* Input = WorkBlock->Input;
+    uint8_t* Output = WorkBlock->Output;
+
+    for (size_t d = IterationRank; d > 0; d--) {
+        Index[d - 1] = WorkIndex % IterationShape[d - 1];
+        WorkIndex /= IterationShape[d - 1];
+        Input += Index[d - 1] * IterationInputStride[d - 1];
+        Output += Index[d - 1] * IterationOutputStride[d - 1];
+    }
+
+    while (true) {
+
+        if (WorkBlock->BlockBytes != 0) {
+
+            std::memcpy(Output, Input, WorkBlock->BlockBytes);
+
+        } else {
+
+            //
+            // The two trailing iteration axes index the tiles along the M
+            // and N dimensions. Trim the tiles at the matrix edges.
+            //
+
+            const size_t TileN = WorkBlock->TileN;
+            const size_t TileM = WorkBlock->TileM;
+            const size_t CountN = std::min(TileN, WorkBlock->N - Index[IterationRank - 2] * TileN);
+            const size_t CountM = std::min(TileM, WorkBlock->M - Index[IterationRank - 1] * TileM);
+
+            MlasTransposeNdTile(reinterpret_cast<const ElementType*>(Input), WorkBlock->InputRowStride,
+                reinterpret_cast<ElementType*>(Output), WorkBlock->OutputRowStride, CountM, CountN);
+        }
+
+        if (--WorkRemaining == 0) {
+            break;
+        }
+
+        //
+        // Advance to the next unit of work.
+        //
+
+        for (size_t d = IterationRank; d > 0; d--) {
+
+            Input += IterationInputStride[d - 1];
+            Output += IterationOutputStride[d - 1];
+
+            if (++Index[d - 1] < IterationShape[d - 1]) {
+                break;
+            }
+
+            Input -= IterationInputStride[d - 1] * IterationShape[d - 1];
+            Output -= IterationOutputStride[d - 1] * IterationShape[d - 1];
+            Index[d - 1] = 0;
+        }
+    }
+}
+
+size_t
+MlasTransposeNdCollapse(
+    size_t Rank,
+    const size_t* InputShape,
+    const size_t* Permutation,
+    size_t* Shape,
+    size_t* Perm
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces an N-D transpose to an equivalent transpose of lower
+    rank by removing unit dimensions and merging runs of input axes that stay
+    adjacent and in order in the output.
+
+Arguments:
+
+    Rank - Supplies the number of dimensions.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    Permutation - Supplies the input axis for each output axis.
+
+    Shape - Receives the collapsed input shape.
+
+    Perm - Receives the collapsed permutation.
+
+Return Value:
+
+    Returns the collapsed rank.
+
+--*/
+{
+    constexpr size_t RemovedAxis = std::numeric_limits<size_t>::max();
+
+    size_t AxisMap[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t SqueezedShape[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t SqueezedPerm[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t SqueezedRank = 0;
+
+    for (size_t i = 0; i < Rank; i++) {
+        if (InputShape[i] != 1) {
+            SqueezedShape[SqueezedRank] = InputShape[i];
+            AxisMap[i] = SqueezedRank++;
+        } else {
+            AxisMap[i] = RemovedAxis;
+        }
+    }
+
+    size_t p = 0;
+
+    for (size_t k = 0; k < Rank; k++) {
+        if (AxisMap[Permutation[k]] != RemovedAxis) {
+            SqueezedPerm[p++] = AxisMap[Permutation[k]];
+        }
+    }
+
+    //
+    // An input axis starts a new group unless it directly follows its
+    // predecessor in both the input and the output.
+    //
+
+    bool GroupLeader[MLAS_TRANSPOSE_MAXIMUM_RANK];
+
+    for (size_t k = 0; k < SqueezedRank; k++) {
+        GroupLeader[SqueezedPerm[k]] = (k == 0 || SqueezedPerm[k] != SqueezedPerm[k - 1] + 1);
+    }
+
+    size_t GroupIndex[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t CollapsedRank = 0;
+
+    for (size_t i = 0; i < SqueezedRank; i++) {
+        if (GroupLeader[i]) {
+            GroupIndex[i] = CollapsedRank;
+            Shape[CollapsedRank++] = SqueezedShape[i];
+        } else {
+            Shape[CollapsedRank - 1] *= SqueezedShape[i];
+        }
+    }
+
+    p = 0;
+
+    for (size_t k = 0; k < SqueezedRank; k++) {
+        if (GroupLeader[SqueezedPerm[k]]) {
+            Perm[p++] = GroupIndex[SqueezedPerm[k]];
+        }
+    }
+
+    return CollapsedRank;
+}
+
+void
+MLASCALL
+MlasTransposeNd(
+    const void* Input,
+    void* Output,
+    size_t ElementSize,
+    size_t Rank,
+    const size_t* InputShape,
+    const size_t* Permutation,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine transposes an N-D tensor. Output axis k of the output tensor
+    corresponds to input axis Permutation[k].
+
+    The transpose is first collapsed to the lowest equivalent rank. If the
+    innermost input axis remains innermost in the output, the operation is a
+    gather of contiguous blocks; small blocks are treated as wider elements.
+    Otherwise, the innermost input axis and the innermost output axis are
+    transposed in cache tiles using in-register block transposes and the
+    remaining axes are iterated around the tiles. The tiles or blocks are
+    partitioned across the thread pool.
+
+Arguments:
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+    ElementSize - Supplies the size in bytes of each element: 1, 2, 4 or 8.
+
+    Rank - Supplies the number of dimensions of the input tensor.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    Permutation - Supplies the input axis for each output axis.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (Rank > MLAS_TRANSPOSE_MAXIMUM_RANK) {
+        MLAS_THROW_EX(std::invalid_argument, "MlasTransposeNd: rank exceeds MLAS_TRANSPOSE_MAXIMUM_RANK");
+    }
+
+    if (ElementSize != 1 && ElementSize != 2 && ElementSize != 4 && ElementSize != 8) {
+        MLAS_THROW_EX(std::invalid_argument, "MlasTransposeNd: unsupported element size");
+    }
+
+    unsigned AxisSeen = 0;
+    size_t TotalElements = 1;
+
+    for (size_t k = 0; k < Rank; k++) {
+        if (Permutation[k] >= Rank || (AxisSeen & (1u << Permutation[k])) != 0) {
+            MLAS_THROW_EX(std::invalid_argument, "MlasTransposeNd: invalid permutation");
+        }
+        AxisSeen |= 1u << Permutation[k];
+        TotalElements *= InputShape[k];
+    }
+
+    if (TotalElements == 0) {
+        return;
+    }
+
+    const size_t TotalBytes = TotalElements * ElementSize;
+
+    size_t Shape[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t Perm[MLAS_TRANSPOSE_MAXIMUM_RANK];
+
+    size_t CollapsedRank = MlasTransposeNdCollapse(Rank, InputShape, Permutation, Shape, Perm);
+
+    if (CollapsedRank <= 1) {
+        std::memcpy(Output, Input, TotalBytes);
+        return;
+    }
+
+    size_t BlockBytes = 0;
+
+    if (Perm[CollapsedRank - 1] == CollapsedRank - 1) {
+
+        //
+        // The innermost input axis stays innermost. Blocks that fit in a
+        // supported element size are handled as single wide elements by the
+        // tile transpose; otherwise each block is copied as a unit.
+        //
+
+        size_t InnerBytes = Shape[CollapsedRank - 1] * ElementSize;
+
+        if (InnerBytes == 2 || InnerBytes == 4 || InnerBytes == 8) {
+            ElementSize = InnerBytes;
+        } else {
+            BlockBytes = InnerBytes;
+        }
+
+        CollapsedRank--;
+    }
+
+    size_t InputStride[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t OutputStride[MLAS_TRANSPOSE_MAXIMUM_RANK];
+    size_t InputStrideAccumulate = 1;
+    size_t OutputStrideAccumulate = 1;
+
+    for (size_t i = CollapsedRank; i > 0; i--) {
+        InputStride[i - 1] = InputStrideAccumulate;
+        InputStrideAccumulate *= Shape[i - 1];
+        OutputStride[i - 1] = OutputStrideAccumulate;
+        OutputStrideAccumulate *= Shape[Perm[i - 1]];
+    }
+
+    if (BlockBytes != 0) {
+        for (size_t i = 0; i < CollapsedRank; i++) {
+            InputStride[i] *= Shape[CollapsedRank];
+            OutputStride[i] *= Shape[CollapsedRank];
+        }
+    }
+
+    MLAS_TRANSPOSE_ND_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Input = static_cast<const uint8_t*>(Input);
+    WorkBlock.Output = static_cast<uint8_t*>(Output);
+    WorkBlock.BlockBytes = BlockBytes;
+
+    size_t IterationRank = 0;
+
+    if (BlockBytes != 0) {
+
+        //
+        // Iterate over the output axes in order so that consecutive blocks
+        // are written contiguously.
+        //
+
+        for (size_t k = 0; k < CollapsedRank; k++) {
+            WorkBlock.IterationShape[IterationRank] = Shape[Perm[k]];
+            WorkBlock.IterationInputStride[IterationRank] = InputStride[Perm[k]] * ElementSize;
+            WorkBlock.IterationOutputStride[IterationRank] = OutputStride[k] * ElementSize;
+            IterationRank++;
+        }
+
+    } else {
+
+        //
+        // Tile the plane formed by the innermost output axis (M) and the
+        // innermost input axis (N). The tile extents are widened along one
+        // axis when the other axis is short to keep the tile area constant.
+        //
+
+        const size_t AxisM = Perm[CollapsedRank - 1];
+        const size_t AxisN = CollapsedRank - 1;
+        size_t OutputPositionN = 0;
+
+        for (size_t k = 0; k < CollapsedRank; k++) {
+            if (Perm[k] == AxisN) {
+                OutputPositionN = k;
+            } else if (Perm[k] != AxisM) {
+                WorkBlock.IterationShape[IterationRank] = Shape[Perm[k]];
+                WorkBlock.IterationInputStride[IterationRank] = InputStride[Perm[k]] * ElementSize;
+                WorkBlock.IterationOutputStride[IterationRank] = OutputStride[k] * ElementSize;
+                IterationRank++;
+            }
+        }
+
+        const size_t M = Shape[AxisM];
+        const size_t N = Shape[AxisN];
+
+        size_t TileM = std::min<size_t>(M, MLAS_TRANSPOSE_ND_TILE_EDGE);
+        size_t TileN = std::min<size_t>(N, std::max<size_t>(MLAS_TRANSPOSE_ND_TILE_EDGE, MLAS_TRANSPOSE_ND_TILE_AREA / TileM));
+        TileM = std::min<size_t>(M, std::max<size_t>(TileM, MLAS_TRANSPOSE_ND_TILE_AREA / TileN));
+
+        WorkBlock.M = M;
+        WorkBlock.N = N;
+        WorkBlock.TileM = TileM;
+        WorkBlock.TileN = TileN;
+        WorkBlock.InputRowStride = InputStride[AxisM];
+        WorkBlock.OutputRowStride = OutputStride[OutputPositionN];
+
+        WorkBlock.IterationShape[IterationRank] = MlasDivRoundup(N, TileN);
+        WorkBlock.IterationInputStride[IterationRank] = TileN * ElementSize;
+        WorkBlock.IterationOutputStride[IterationRank] = TileN * WorkBlock.OutputRowStride * ElementSize;
+        IterationRank++;
+
+        WorkBlock.IterationShape[IterationRank] = MlasDivRoundup(M, TileM);
+        WorkBlock.IterationInputStride[IterationRank] = TileM * WorkBlock.InputRowStride * ElementSize;
+        WorkBlock.IterationOutputStride[IterationRank] = TileM * ElementSize;
+        IterationRank++;
+    }
+
+    size_t TotalWork = 1;
+
+    for (size_t d = 0; d < IterationRank; d++) {
+        TotalWork *= WorkBlock.IterationShape[d];
+    }
+
+    WorkBlock.IterationRank = IterationRank;
+    WorkBlock.TotalWork = TotalWork;
+
+    //
+    // Compute the number of target threads given the total number of bytes
+    // to move and the amount of work per thread.
+    //
+
+    ptrdiff_t ThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+    size_t TargetThreadCount = TotalBytes / MLAS_TRANSPOSE_ND_THREAD_BYTES + 1;
+
+    if (size_t(ThreadCount) > TargetThreadCount) {
+        ThreadCount = ptrdiff_t(TargetThreadCount);
+    }
+
+    if (size_t(ThreadCount) > TotalWork) {
+        ThreadCount = ptrdiff_t(TotalWork);
+    }
+
+    WorkBlock.ThreadCount = ThreadCount;
+
+    MLAS_THREADED_ROUTINE* ThreadedRoutine;
+
+    switch (BlockBytes != 0 ? 1 : ElementSize) {
+        case 2:
+            ThreadedRoutine = MlasTransposeNdThreaded<uint16_t>;
+            break;
+
+        case 4:
+            ThreadedRoutine = MlasTransposeNdThreaded<uint32_t>;
+            break;
+
+        case 8:
+            ThreadedRoutine = MlasTransposeNdThreaded<uint64_t>;
+            break;
+
+        default:
+            ThreadedRoutine = MlasTransposeNdThreaded<uint8_t>;
+            break;
+    }
+
+    MlasExecuteThreaded(ThreadedRoutine, &WorkBlock, ThreadCount, ThreadPool);
+}
@@ -0,0 +1,856 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    winograd.cpp
+
+Abstract:
+
+    This module implements the single precision Winograd F(4x4,3x3)
+    convolution operation.
+
+    The output image is divided into 4x4 tiles. Each tile consumes a 6x6 patch
+    of the input image, which is transformed to the Winograd domain. The
+    element wise products across input channels then become 36 independent
+    matrix multiplies, one per position of the transformed tile, that are
+    computed with the packed SGEMM kernels. The results are transformed back
+    to 4x4 output tiles.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the tile geometry for F(4x4,3x3).
+//
+
+#define MLAS_WINOGRAD_OUTPUT_TILE                   4
+#define MLAS_WINOGRAD_INPUT_TILE                    6
+#define MLAS_WINOGRAD_TILE_ELEMENTS                 36
+
+//
+// Define the minimum number of input and output channels where the cost of
+// the input and output transforms is amortized by the reduced multiplies.
+//
+
+#define MLAS_WINOGRAD_MINIMUM_CHANNELS              8
+
+//
+// Define the target number of tiles to process with a single set of matrix
+// multiplies.
+//
+
+#define MLAS_WINOGRAD_TARGET_TILES_PER_BLOCK        32
+
+//
+// Define the parameters to execute segments of a Winograd convolution
+// operation on worker threads.
+//
+
+struct MLAS_CONV_WINOGRAD_WORK_BLOCK {
+    const MLAS_CONV_PARAMETERS* Parameters;
+    const float* Input;
+    const float* Bias;
+    float* WorkingBuffer;
+    float* Output;
+    ptrdiff_t TargetThreadCount;
+};
+
+//
+// Define the filter transform matrix G.
+//
+
+static const double MlasWinogradFilterTransform[MLAS_WINOGRAD_INPUT_TILE][3] = {
+    {  1.0 / 4.0,   0.0,         0.0       },
+    { -1.0 / 6.0,  -1.0 / 6.0,  -1.0 / 6.0 },
+    { -1.0 / 6.0,   1.0 / 6.0,  -1.0 / 6.0 },
+    {  1.0 / 24.0,  1.0 / 12.0,  1.0 / 6.0 },
+    {  1.0 / 24.0, -1.0 / 12.0,  1.0 / 6.0 },
+    {  0.0,         0.0,         1.0       },
+};
+
+MLAS_FORCEINLINE
+size_t
+MlasConvWinogradAlignChannels(
+    size_t Channels
+    )
+{
+    return (Channels + 3) & ~size_t(3);
+}
+
+MLAS_FORCEINLINE
+size_t
+MlasConvWinogradTilesPerBlock(
+    const MLAS_CONV_PARAMETERS* Parameters
+    )
+{
+    const size_t TileCountW = MlasDivRoundup(Parameters->OutputShape[1], MLAS_WINOGRAD_OUTPUT_TILE);
+
+    return Parameters->u.Winograd.TileRowsPerBlock * TileCountW;
+}
+
+MLAS_FORCEINLINE
+size_t
+MlasConvWinogradWorkingBufferSizePerThread(
+    const MLAS_CONV_PARAMETERS* Parameters
+    )
+{
+    const size_t TilesPerBlock = MlasConvWinogradTilesPerBlock(Parameters);
+
+    return MLAS_WINOGRAD_TILE_ELEMENTS * TilesPerBlock *
+        (MlasConvWinogradAlignChannels(Parameters->InputChannels) +
+         MlasConvWinogradAlignChannels(Parameters->FilterCount));
+}
+
+MLAS_FORCEINLINE
+void
+MlasConvWinogradTransformInput1D(
+    const MLAS_FLOAT32X4* d,
+    size_t ds,
+    MLAS_FLOAT32X4* v,
+    size_t vs
+    )
+/*++
+
+Routine Description:
+
+    This routine applies the input transform matrix B^T to a vector of six
+    elements.
+
+Arguments:
+
+    d - Supplies the address of the source vector.
+
+    ds - Supplies the stride between elements of the source vector.
+
+    v - Supplies the address of the destination vector.
+
+    vs - Supplies the stride between elements of the destination vector.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_FLOAT32X4 d0 = d[0 * ds];
+    const MLAS_FLOAT32X4 d1 = d[1 * ds];
+    const MLAS_FLOAT32X4 d2 = d[2 * ds];
+    const MLAS_FLOAT32X4 d3 = d[3 * ds];
+    const MLAS_FLOAT32X4 d4 = d[4 * ds];
+    const MLAS_FLOAT32X4 d5 = d[5 * ds];
+
+    const MLAS_FLOAT32X4 d4_minus_d2 = MlasSubtractFloat32x4(d4, d2);
+    const MLAS_FLOAT32X4 d3_minus_d1 = MlasSubtractFloat32x4(d3, d1);
+
+    v[0 * vs] = MlasMultiplyAddFloat32x4(d2, -5.0f, MlasMultiplyAddFloat32x4(d0, 4.0f, d4));
+    v[1 * vs] = MlasMultiplyAddFloat32x4(MlasAddFloat32x4(d1, d2), -4.0f, MlasAddFloat32x4(d3, d4));
+    v[2 * vs] = MlasMultiplyAddFloat32x4(MlasSubtractFloat32x4(d1, d2), 4.0f, MlasSubtractFloat32x4(d4, d3));
+    v[3 * vs] = MlasMultiplyAddFloat32x4(d3_minus_d1, 2.0f, d4_minus_d2);
+    v[4 * vs] = MlasMultiplyAddFloat32x4(d3_minus_d1, -2.0f, d4_minus_d2);
+    v[5 * vs] = MlasMultiplyAddFloat32x4(d3, -5.0f, MlasMultiplyAddFloat32x4(d1, 4.0f, d5));
+}
+
+MLAS_FORCEINLINE
+void
+MlasConvWinogradTransformOutput1D(
+    const MLAS_FLOAT32X4* m,
+    size_t ms,
+    MLAS_FLOAT32X4* o,
+    size_t os
+    )
+/*++
+
+Routine Description:
+
+    This routine applies the output transform matrix A^T to a vector of six
+    elements.
+
+Arguments:
+
+    m - Supplies the address of the source vector.
+
+    ms - Supplies the stride between elements of the source vector.
+
+    o - Supplies the address of the destination vector of four elements.
+
+    os - Supplies the stride between elements of the destination vector.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_FLOAT32X4 m1_plus_m2 = MlasAddFloat32x4(m[1 * ms], m[2 * ms]);
+    const MLAS_FLOAT32X4 m1_minus_m2 = MlasSubtractFloat32x4(m[1 * ms], m[2 * ms]);
+    const MLAS_FLOAT32X4 m3_plus_m4 = MlasAddFloat32x4(m[3 * ms], m[4 * ms]);
+    const MLAS_FLOAT32X4 m3_minus_m4 = MlasSubtractFloat32x4(m[3 * ms], m[4 * ms]);
+
+    o[0 * os] = MlasAddFloat32x4(MlasAddFloat32x4(m[0 * ms], m1_plus_m2), m3_plus_m4);
+    o[1 * os] = MlasMultiplyAddFloat32x4(m3_minus_m4, 2.0f, m1_minus_m2);
+    o[2 * os] = MlasMultiplyAddFloat32x4(m3_plus_m4, 4.0f, m1_plus_m2);
+    o[3 * os] = MlasAddFloat32x4(MlasMultiplyAddFloat32x4(m3_minus_m4, 8.0f, m1_minus_m2), m[5 * ms]);
+}
+
+void
+MlasConvWinogradTransformInput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    float* V,
+    size_t TileRowStart,
+    size_t TileRowCount
+    )
+/*++
+
+Routine Description:
+
+    This routine gathers the 6x6 input patches for a block of output tiles and
+    transforms them to the Winograd domain. Four input channels are processed
+    in parallel with one channel per vector lane.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor for the current batch and group.
+
+    V - Supplies the buffer that receives the transformed input. The buffer is
+        organized as 36 matrices, each with one row per tile and one column per
+        input channel.
+
+    TileRowStart - Supplies the first row of tiles to transform.
+
+    TileRowCount - Supplies the number of rows of tiles to transform.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+    const size_t InputSize = Parameters->InputSize;
+    const size_t PaddingTop = Parameters->Padding[0];
+    const size_t PaddingLeft = Parameters->Padding[1];
+
+    const size_t TileCountW = MlasDivRoundup(Parameters->OutputShape[1], MLAS_WINOGRAD_OUTPUT_TILE);
+    const size_t ldV = MlasConvWinogradAlignChannels(InputChannels);
+    const size_t MatrixStride = MlasConvWinogradTilesPerBlock(Parameters) * ldV;
+
+    MLAS_DECLSPEC_ALIGN(float Patch[MLAS_WINOGRAD_TILE_ELEMENTS][4], 16);
+    MLAS_FLOAT32X4 d[MLAS_WINOGRAD_TILE_ELEMENTS];
+    MLAS_FLOAT32X4 t[MLAS_WINOGRAD_TILE_ELEMENTS];
+
+    size_t tile = 0;
+
+    for (size_t th = TileRowStart; th < TileRowStart + TileRowCount; th++) {
+
+        //
+        // N.B. The input coordinates are computed with unsigned arithmetic,
+        // so coordinates inside the leading padding wrap around and fail
+        // the bounds checks below.
+        //
+
+        const size_t ihStart = th * MLAS_WINOGRAD_OUTPUT_TILE - PaddingTop;
+
+        for (size_t tw = 0; tw < TileCountW; tw++, tile++) {
+
+            const size_t iwStart = tw * MLAS_WINOGRAD_OUTPUT_TILE - PaddingLeft;
+
+            for (size_t c = 0; c < InputChannels; c += 4) {
+
+                const size_t ChannelCount = std::min(InputChannels - c, size_t(4));
+                const float* input = Input + c * InputSize;
+
+                //
+                // Gather the input patch for the block of channels, filling
+                // the padding and the unused vector lanes with zeroes.
+                //
+
+                for (size_t i = 0; i < MLAS_WINOGRAD_INPUT_TILE; i++) {
+
+                    const size_t ih = ihStart + i;
+
+                    for (size_t j = 0; j < MLAS_WINOGRAD_INPUT_TILE; j++) {
+
+                        const size_t iw = iwStart + j;
+                        float* patch = Patch[i * MLAS_WINOGRAD_INPUT_TILE + j];
+
+                        if (ih < InputHeight && iw < InputWidth) {
+
+                            const float* p = input + ih * InputWidth + iw;
+
+                            for (size_t lane = 0; lane < ChannelCount; lane++) {
+                                patch[lane] = p[lane * InputSize];
+                            }
+
+                            for (size_t lane = ChannelCount; lane < 4; lane++) {
+                                patch[lane] = 0.0f;
+                            }
+
+                        } else {
+
+                            MlasStoreAlignedFloat32x4(patch, MlasZeroFloat32x4());
+                        }
+                    }
+                }
+
+                for (size_t k = 0; k < MLAS_WINOGRAD_TILE_ELEMENTS; k++) {
+                    d[k] = MlasLoadFloat32x4(Patch[k]);
+                }
+
+                //
+                // Compute B^T * d * B.
+                //
+
+                for (size_t j = 0; j < MLAS_WINOGRAD_INPUT_TILE; j++) {
+                    MlasConvWinogradTransformInput1D(&d[j], MLAS_WINOGRAD_INPUT_TILE,
+                        &t[j], MLAS_WINOGRAD_INPUT_TILE);
+                }
+
+                for (size_t i = 0; i < MLAS_WINOGRAD_INPUT_TILE; i++) {
+                    MlasConvWinogradTransformInput1D(&t[i * MLAS_WINOGRAD_INPUT_TILE], 1,
+                        &d[i * MLAS_WINOGRAD_INPUT_TILE], 1);
+                }
+
+                float* v = V + tile * ldV + c;
+
+                for (size_t k = 0; k < MLAS_WINOGRAD_TILE_ELEMENTS; k++) {
+                    MlasStoreFloat32x4(v, d[k]);
+                    v += MatrixStride;
+                }
+            }
+        }
+    }
+}
+
+void
+MlasConvWinogradTransformOutput(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Mt,
+    float* Output,
+    size_t TileRowStart,
+    size_t TileRowCount
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms the products for a block of tiles from the
+    Winograd domain and stores the 4x4 output tiles. Four filters are
+    processed in parallel with one filter per vector lane.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Mt - Supplies the products buffer. The buffer is organized as 36 matrices,
+        each with one row per tile and one column per filter.
+
+    Output - Supplies the output tensor for the current batch and group.
+
+    TileRowStart - Supplies the first row of tiles to transform.
+
+    TileRowCount - Supplies the number of rows of tiles to transform.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t OutputSize = Parameters->OutputSize;
+    const float Beta = Parameters->Beta;
+
+    const size_t TileCountW = MlasDivRoundup(OutputWidth, MLAS_WINOGRAD_OUTPUT_TILE);
+    const size_t ldM = MlasConvWinogradAlignChannels(FilterCount);
+    const size_t MatrixStride = MlasConvWinogradTilesPerBlock(Parameters) * ldM;
+
+    MLAS_DECLSPEC_ALIGN(float Tile[MLAS_WINOGRAD_OUTPUT_TILE * MLAS_WINOGRAD_OUTPUT_TILE][4], 16);
+    MLAS_FLOAT32X4 m[MLAS_WINOGRAD_TILE_ELEMENTS];
+    MLAS_FLOAT32X4 t[MLAS_WINOGRAD_OUTPUT_TILE * MLAS_WINOGRAD_INPUT_TILE];
+    MLAS_FLOAT32X4 o[MLAS_WINOGRAD_OUTPUT_TILE * MLAS_WINOGRAD_OUTPUT_TILE];
+
+    size_t tile = 0;
+
+    for (size_t th = TileRowStart; th < TileRowStart + TileRowCount; th++) {
+
+        const size_t ohStart = th * MLAS_WINOGRAD_OUTPUT_TILE;
+        const size_t RowCount = std::min(OutputHeight - ohStart, size_t(MLAS_WINOGRAD_OUTPUT_TILE));
+
+        for (size_t tw = 0; tw < TileCountW; tw++, tile++) {
+
+            const size_t owStart = tw * MLAS_WINOGRAD_OUTPUT_TILE;
+            const size_t ColumnCount = std::min(OutputWidth - owStart, size_t(MLAS_WINOGRAD_OUTPUT_TILE));
+
+            for (size_t f = 0; f < FilterCount; f += 4) {
+
+                const size_t FilterBlock = std::min(FilterCount - f, size_t(4));
+                const float* mt = Mt + tile * ldM + f;
+
+                for (size_t k = 0; k < MLAS_WINOGRAD_TILE_ELEMENTS; k++) {
+                    m[k] = MlasLoadFloat32x4(mt);
+                    mt += MatrixStride;
+                }
+
+                //
+                // Compute A^T * m * A.
+                //
+
+                for (size_t j = 0; j < MLAS_WINOGRAD_INPUT_TILE; j++) {
+                    MlasConvWinogradTransformOutput1D(&m[j], MLAS_WINOGRAD_INPUT_TILE,
+                        &t[j], MLAS_WINOGRAD_INPUT_TILE);
+                }
+
+                for (size_t i = 0; i < MLAS_WINOGRAD_OUTPUT_TILE; i++) {
+                    MlasConvWinogradTransformOutput1D(&t[i * MLAS_WINOGRAD_INPUT_TILE], 1,
+                        &o[i * MLAS_WINOGRAD_OUTPUT_TILE], 1);
+                }
+
+                for (size_t k = 0; k < MLAS_WINOGRAD_OUTPUT_TILE * MLAS_WINOGRAD_OUTPUT_TILE; k++) {
+                    MlasStoreAlignedFloat32x4(Tile[k], o[k]);
+                }
+
+                //
+                // Scatter the valid portion of the tile to the output tensor.
+                //
+
+                for (size_t lane = 0; lane < FilterBlock; lane++) {
+
+                    float* output = Output + (f + lane) * OutputSize + ohStart * OutputWidth + owStart;
+
+                    for (size_t y = 0; y < RowCount; y++) {
+
+                        const float* tile_row = Tile[y * MLAS_WINOGRAD_OUTPUT_TILE];
+
+                        for (size_t x = 0; x < ColumnCount; x++) {
+                            float value = tile_row[x * 4 + lane];
+                            if (Beta != 0.0f) {
+                                value += Beta * output[x];
+                            }
+                            output[x] = value;
+                        }
+
+                        output += OutputWidth;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+MlasConvWinogradThreaded(
+    void* Context,
+    ptrdiff_t Index
+    )
+/*++
+
+Routine Description:
+
+    This routine is invoked from a worker thread to execute a segment of a
+    Winograd convolution operation.
+
+Arguments:
+
+    Context - Supplies the pointer to the context for the threaded operation.
+
+    Index - Supplies the current index of the threaded operation.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const MLAS_CONV_WINOGRAD_WORK_BLOCK* WorkBlock = (MLAS_CONV_WINOGRAD_WORK_BLOCK*)Context;
+
+    const MLAS_CONV_PARAMETERS* Parameters = WorkBlock->Parameters;
+
+    const size_t GroupCount = Parameters->GroupCount;
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t OutputSize = Parameters->OutputSize;
+
+    const size_t TileCountH = MlasDivRoundup(Parameters->OutputShape[0], MLAS_WINOGRAD_OUTPUT_TILE);
+    const size_t TileCountW = MlasDivRoundup(OutputWidth, MLAS_WINOGRAD_OUTPUT_TILE);
+    const size_t TileRowsPerBlock = Parameters->u.Winograd.TileRowsPerBlock;
+    const size_t BlocksPerImage = MlasDivRoundup(TileCountH, TileRowsPerBlock);
+    const size_t TilesPerBlock = TileRowsPerBlock * TileCountW;
+
+    const size_t ldV = MlasConvWinogradAlignChannels(InputChannels);
+    const size_t ldM = MlasConvWinogradAlignChannels(FilterCount);
+
+    const size_t PackedMatrixSize = MlasGemmPackBSize(FilterCount, InputChannels);
+    const size_t AlignedN =
+        (FilterCount + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+    //
+    // Compute the range of blocks to use for this thread.
+    //
+
+    size_t BlockStart;
+    size_t BlockRemaining;
+
+    MlasPartitionWork(Index, WorkBlock->TargetThreadCount, Parameters->u.Winograd.BlockCount,
+        &BlockStart, &BlockRemaining);
+
+    const size_t BlockEnd = BlockStart + BlockRemaining;
+
+    float* V = WorkBlock->WorkingBuffer + Index * MlasConvWinogradWorkingBufferSizePerThread(Parameters);
+    float* Mt = V + MLAS_WINOGRAD_TILE_ELEMENTS * TilesPerBlock * ldV;
+
+    for (size_t block = BlockStart; block < BlockEnd; block++) {
+
+        const size_t bg = block / BlocksPerImage;
+        const size_t group = bg % GroupCount;
+
+        const size_t TileRowStart = (block % BlocksPerImage) * TileRowsPerBlock;
+        const size_t TileRowCount = std::min(TileCountH - TileRowStart, TileRowsPerBlock);
+        const size_t TileCount = TileRowCount * TileCountW;
+
+        const float* input = WorkBlock->Input + bg * InputChannels * Parameters->InputSize;
+        float* output = WorkBlock->Output + bg * FilterCount * OutputSize;
+
+        const uint8_t* PackedFilter = (const uint8_t*)Parameters->u.Winograd.PackedFilter +
+            group * MLAS_WINOGRAD_TILE_ELEMENTS * PackedMatrixSize;
+
+        const float* bias = WorkBlock->Bias;
+
+        if (bias != nullptr) {
+            bias += group * FilterCount;
+        }
+
+        MlasConvWinogradTransformInput(Parameters, input, V, TileRowStart, TileRowCount);
+
+        //
+        // Multiply the transformed input by the transformed filter for each
+        // position of the transformed tile.
+        //
+
+        for (size_t k = 0; k < MLAS_WINOGRAD_TILE_ELEMENTS; k++) {
+            MlasSgemmPackedOperation(CblasNoTrans, TileCount, 0, FilterCount, InputChannels,
+                1.0f, V + k * TilesPerBlock * ldV, ldV, PackedFilter + k * PackedMatrixSize,
+                AlignedN, 0.0f, Mt + k * TilesPerBlock * ldM, ldM);
+        }
+
+        MlasConvWinogradTransformOutput(Parameters, Mt, output, TileRowStart, TileRowCount);
+
+        //
+        // Apply the activation with optional bias to the rows of the output
+        // image produced by this block.
+        //
+
+        const size_t ohStart = TileRowStart * MLAS_WINOGRAD_OUTPUT_TILE;
+        const size_t ohEnd = std::min(Parameters->OutputShape[0],
+            (TileRowStart + TileRowCount) * MLAS_WINOGRAD_OUTPUT_TILE);
+
+        MlasActivation(Parameters->Activation, output + ohStart * OutputWidth, bias,
+            FilterCount, (ohEnd - ohStart) * OutputWidth, OutputSize);
+    }
+}
+
+bool
+MlasConvWinogradPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    const void* PackedFilter,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine determines whether a convolution is eligible for the Winograd
+    algorithm and, if so, computes the parameters to execute the operation.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the provided and computed
+        parameters for the convolution operation.
+
+    PackedFilter - Supplies the filter transformed by
+        MlasConvWinogradPackFilter.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    Returns true if the Winograd algorithm was selected, else false.
+
+--*/
+{
+    if (Parameters->Dimensions != 2) {
+        return false;
+    }
+
+    for (size_t dim = 0; dim < 2; dim++) {
+        if (Parameters->KernelShape[dim] != 3 || Parameters->StrideShape[dim] != 1 ||
+            Parameters->DilationShape[dim] != 1) {
+            return false;
+        }
+    }
+
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t FilterCount = Parameters->FilterCount;
+
+    if (InputChannels < MLAS_WINOGRAD_MINIMUM_CHANNELS ||
+        FilterCount < MLAS_WINOGRAD_MINIMUM_CHANNELS) {
+        return false;
+    }
+
+    //
+    // Small images waste too much of the tiles on the image edges.
+    //
+
+    if (Parameters->OutputShape[0] < MLAS_WINOGRAD_OUTPUT_TILE ||
+        Parameters->OutputShape[1] < MLAS_WINOGRAD_OUTPUT_TILE) {
+        return false;
+    }
+
+    //
+    // Group rows of tiles together so that each set of matrix multiplies has
+    // a reasonable number of rows.
+    //
+
+    const size_t TileCountH = MlasDivRoundup(Parameters->OutputShape[0], MLAS_WINOGRAD_OUTPUT_TILE);
+    const size_t TileCountW = MlasDivRoundup(Parameters->OutputShape[1], MLAS_WINOGRAD_OUTPUT_TILE);
+
+    size_t TileRowsPerBlock = MlasDivRoundup(MLAS_WINOGRAD_TARGET_TILES_PER_BLOCK, TileCountW);
+
+    if (TileRowsPerBlock > TileCountH) {
+        TileRowsPerBlock = TileCountH;
+    }
+
+    const size_t BlocksPerImage = MlasDivRoundup(TileCountH, TileRowsPerBlock);
+    const size_t BlockCount = Parameters->BatchCount * Parameters->GroupCount * BlocksPerImage;
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // matrix multiplies.
+    //
+
+    ptrdiff_t TargetThreadCount;
+    const double Complexity = double(MLAS_WINOGRAD_TILE_ELEMENTS) * double(TileCountH * TileCountW) *
+        double(Parameters->BatchCount * Parameters->GroupCount) * double(InputChannels) *
+        double(FilterCount);
+
+    if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * GetMlasPlatform().MaximumThreadCount)) {
+        TargetThreadCount = ptrdiff_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = GetMlasPlatform().MaximumThreadCount;
+    }
+
+    ptrdiff_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) > BlockCount) {
+        TargetThreadCount = ptrdiff_t(BlockCount);
+    }
+
+    Parameters->Algorithm = MlasConvAlgorithmWinograd;
+    Parameters->ThreadCount = TargetThreadCount;
+    Parameters->u.Winograd.PackedFilter = PackedFilter;
+    Parameters->u.Winograd.TileRowsPerBlock = TileRowsPerBlock;
+    Parameters->u.Winograd.BlockCount = BlockCount;
+
+    *WorkingBufferSize = size_t(TargetThreadCount) * MlasConvWinogradWorkingBufferSizePerThread(Parameters);
+
+    return true;
+}
+
+void
+MlasConvWinograd(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the Winograd convolution operation.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor.
+
+    Bias - Optionally supplies the bias vector.
+
+    WorkingBuffer - Supplies a working buffer sized to the number of elements
+        returned by MlasConvPrepare.
+
+    Output - Supplies the output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_CONV_WINOGRAD_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Parameters = Parameters;
+    WorkBlock.Input = Input;
+    WorkBlock.Bias = Bias;
+    WorkBlock.WorkingBuffer = WorkingBuffer;
+    WorkBlock.Output = Output;
+    WorkBlock.TargetThreadCount = Parameters->ThreadCount;
+
+    MlasExecuteThreaded(MlasConvWinogradThreaded, &WorkBlock, Parameters->ThreadCount, ThreadPool);
+}
+
+size_t
+MLASCALL
+MlasConvWinogradPackFilterSize(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the length in bytes for the packed Winograd filter
+    buffer.
+
+Arguments:
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of filters per group.
+
+Return Value:
+
+    Returns the size in bytes for the packed filter buffer.
+
+--*/
+{
+    return GroupCount * MLAS_WINOGRAD_TILE_ELEMENTS * MlasGemmPackBSize(FilterCount, InputChannels);
+}
+
+void
+MLASCALL
+MlasConvWinogradPackFilter(
+    size_t GroupCount,
+    size_t InputChannels,
+    size_t FilterCount,
+    const float* Filter,
+    void* PackedFilter
+    )
+/*++
+
+Routine Description:
+
+    This routine transforms a 3x3 filter tensor to the Winograd domain,
+    U = G * g * G^T, and packs each of the 36 resulting matrices for use by
+    the packed SGEMM kernels.
+
+    The transform is computed in double precision to avoid adding rounding
+    error beyond the error inherent to the algorithm.
+
+Arguments:
+
+    GroupCount - Supplies the number of channel groups.
+
+    InputChannels - Supplies the number of input channels per group.
+
+    FilterCount - Supplies the number of filters per group.
+
+    Filter - Supplies the filter tensor in OIHW format.
+
+    PackedFilter - Supplies the address of the packed filter buffer, sized by
+        MlasConvWinogradPackFilterSize.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t PackedMatrixSize = MlasGemmPackBSize(FilterCount, InputChannels);
+    const size_t MatrixElements = FilterCount * InputChannels;
+
+    std::unique_ptr<float[]> Matrix(new float[MatrixElements]);
+
+    uint8_t* packed = (uint8_t*)PackedFilter;
+
+    for (size_t group = 0; group < GroupCount; group++) {
+
+        for (size_t i = 0; i < MLAS_WINOGRAD_INPUT_TILE; i++) {
+
+            for (size_t j = 0; j < MLAS_WINOGRAD_INPUT_TILE; j++) {
+
+                //
+                // Compute the coefficients that map the 3x3 filter to this
+                // position of the transformed tile.
+                //
+
+                double Coefficients[3][3];
+
+                for (size_t a = 0; a < 3; a++) {
+                    for (size_t b = 0; b < 3; b++) {
+                        Coefficients[a][b] = MlasWinogradFilterTransform[i][a] * MlasWinogradFilterTransform[j][b];
+                    }
+                }
+
+                const float* filter = Filter + group * MatrixElements * 9;
+
+                for (size_t n = 0; n < MatrixElements; n++) {
+
+                    double Value = 0.0;
+
+                    for (size_t a = 0; a < 3; a++) {
+                        for (size_t b = 0; b < 3; b++) {
+                            Value += Coefficients[a][b] * double(filter[a * 3 + b]);
+                        }
+                    }
+
+                    Matrix[n] = float(Value);
+                    filter += 9;
+                }
+
+                //
+                // The matrix is stored with one row per filter, so pack the
+                // transpose to form the K=InputChannels by N=FilterCount
+                // matrix B.
+                //
+
+                MlasGemmPackB(CblasTrans, FilterCount, InputChannels, Matrix.get(), InputChannels, packed);
+
+                packed += PackedMatrixSize;
+            }
+        }
+    }
+}
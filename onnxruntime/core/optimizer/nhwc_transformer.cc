@@ -43,6 +43,32 @@ NhwcConvLookup(
   return &(iter->second);
 }
 
+/**
+ * @brief Tests whether the first input of the node is produced by a Transpose
+ * from channels last to channels first layout.
+ *
+ * fp32 convolutions and pooling already run efficiently in NCHW or NCHWc
+ * layout, so the NHWC kernels are only profitable when the model is channels
+ * last and the Transpose inserted in front of the node cancels out.
+ *
+ * Only the direct producer is checked: an fp32 node whose channels last input
+ * reaches it through another op, or that has no explicit Transpose at all,
+ * stays in NCHW layout.
+ */
+static bool
+IsInputFromChannelsLast(
+    const api::GraphRef& graph,
+    api::NodeRef& node,
+    size_t rank) {
+  const auto inputs = node.Inputs();
+  const auto producer = graph.GetNodeProducingOutput(inputs[0]);
+  if (producer == nullptr || producer->OpType() != "Transpose" || producer->Domain() != kOnnxDomain) {
+    return false;
+  }
+  const auto perm = producer->GetAttributeInts("perm");
+  return perm.has_value() && *perm == ChannelLastToFirstPerm(rank);
+}
+
 NhwcTransformer::NhwcTransformer(AllocatorPtr cpu_allocator, std::shared_ptr<KernelRegistry> cpu_kernel_registry) noexcept
     : GraphTransformer("NhwcTransformer"), cpu_allocator_(std::move(cpu_allocator)) {
   if (!cpu_kernel_registry) {
@@ -164,6 +190,77 @@ NhwcTransformer::NhwcTransformer(AllocatorPtr cpu_allocator, std::shared_ptr<Ker
           OpTransformInfo{nhwc_gavgpool_fp16.op_type_, nhwc_gavgpool_fp16.domain_, nhwc_gavgpool_fp16.version_, false});
     }
   }
+
+  {
+    // fp32 conv -> fp32 nhwc conv
+    OpKernelRegistryId nhwc_conv_fp32{
+        "NhwcFusedConv", kMSDomain, 1, {{"T", {DataTypeImpl::GetTensorType<float>()}}}};
+
+    const KernelCreateInfo* kernel_create_info{};
+    const auto status = cpu_kernel_registry->TryFindKernel(
+        kCpuExecutionProvider, nhwc_conv_fp32.op_type_, nhwc_conv_fp32.domain_,
+        nhwc_conv_fp32.version_, nhwc_conv_fp32.type_constraints_, &kernel_create_info);
+    if (status.IsOK() && kernel_create_info != nullptr) {
+      kernel_create_info = nullptr;
+      conv_table_.emplace(
+          OpIdInfo("Conv", kOnnxDomain, api::DataType::FLOAT),
+          OpTransformInfo{nhwc_conv_fp32.op_type_, nhwc_conv_fp32.domain_, nhwc_conv_fp32.version_, false});
+      conv_table_.emplace(
+          OpIdInfo("FusedConv", kMSDomain, api::DataType::FLOAT),
+          OpTransformInfo{nhwc_conv_fp32.op_type_, nhwc_conv_fp32.domain_, nhwc_conv_fp32.version_, false});
+    }
+  }
+
+  {
+    // fp32 MaxPool -> fp32 nhwc MaxPool
+    OpKernelRegistryId nhwc_maxpool_fp32{
+        "MaxPool", kMSInternalNHWCDomain, 12, {{"T", {DataTypeImpl::GetTensorType<float>()}}}};
+
+    const KernelCreateInfo* kernel_create_info{};
+    const auto status = cpu_kernel_registry->TryFindKernel(
+        kCpuExecutionProvider, nhwc_maxpool_fp32.op_type_, nhwc_maxpool_fp32.domain_,
+        nhwc_maxpool_fp32.version_, nhwc_maxpool_fp32.type_constraints_, &kernel_create_info);
+    if (status.IsOK() && kernel_create_info != nullptr) {
+      kernel_create_info = nullptr;
+      conv_table_.emplace(
+          OpIdInfo("MaxPool", kOnnxDomain, api::DataType::FLOAT),
+          OpTransformInfo{nhwc_maxpool_fp32.op_type_, nhwc_maxpool_fp32.domain_, nhwc_maxpool_fp32.version_, false});
+    }
+  }
+
+  {
+    // fp32 AveragePool -> fp32 nhwc AveragePool
+    OpKernelRegistryId nhwc_avgpool_fp32{
+        "AveragePool", kMSInternalNHWCDomain, 11, {{"T", {DataTypeImpl::GetTensorType<float>()}}}};
+
+    const KernelCreateInfo* kernel_create_info{};
+    const auto status = cpu_kernel_registry->TryFindKernel(
+        kCpuExecutionProvider, nhwc_avgpool_fp32.op_type_, nhwc_avgpool_fp32.domain_,
+        nhwc_avgpool_fp32.version_, nhwc_avgpool_fp32.type_constraints_, &kernel_create_info);
+    if (status.IsOK() && kernel_create_info != nullptr) {
+      kernel_create_info = nullptr;
+      conv_table_.emplace(
+          OpIdInfo("AveragePool", kOnnxDomain, api::DataType::FLOAT),
+          OpTransformInfo{nhwc_avgpool_fp32.op_type_, nhwc_avgpool_fp32.domain_, nhwc_avgpool_fp32.version_, false});
+    }
+  }
+
+  {
+    // fp32 GlobalAveragePool -> fp32 nhwc GlobalAveragePool
+    OpKernelRegistryId nhwc_gavgpool_fp32{
+        "GlobalAveragePool", kMSInternalNHWCDomain, 1, {{"T", {DataTypeImpl::GetTensorType<float>()}}}};
+
+    const KernelCreateInfo* kernel_create_info{};
+    const auto status = cpu_kernel_registry->TryFindKernel(
+        kCpuExecutionProvider, nhwc_gavgpool_fp32.op_type_, nhwc_gavgpool_fp32.domain_,
+        nhwc_gavgpool_fp32.version_, nhwc_gavgpool_fp32.type_constraints_, &kernel_create_info);
+    if (status.IsOK() && kernel_create_info != nullptr) {
+      kernel_create_info = nullptr;
+      conv_table_.emplace(
+          OpIdInfo("GlobalAveragePool", kOnnxDomain, api::DataType::FLOAT),
+          OpTransformInfo{nhwc_gavgpool_fp32.op_type_, nhwc_gavgpool_fp32.domain_, nhwc_gavgpool_fp32.version_, false});
+    }
+  }
 };
 
 Status NhwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const {
@@ -206,11 +303,19 @@ Status NhwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level,
       continue;
     }
 
+    size_t rank = shape->dim_size();
+
+    // Only use the fp32 NHWC kernels if the input is already channels last.
+    // The fp32 MaxPool kernel does not produce the optional Indices output.
+    if (api_graph->GetValueInfo(node->Inputs()[0])->DType() == api::DataType::FLOAT &&
+        (!IsInputFromChannelsLast(*api_graph, *node, rank) || node->Outputs().size() > 1)) {
+      continue;
+    }
+
     // Convert to channels last
     if (transform->has_channels_last_attrib_) {
       node->SetAttributeInt("channels_last", 1);
     }
-    size_t rank = shape->dim_size();
     std::vector<int64_t> input_perm = ChannelFirstToLastPerm(rank);
     std::vector<int64_t> output_perm = ChannelLastToFirstPerm(rank);
     WrapTransposesAroundNode(*api_graph, *node, {&input_perm}, {&output_perm});
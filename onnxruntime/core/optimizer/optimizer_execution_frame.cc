@@ -8,6 +8,7 @@
 #include "core/common/logging/macros.h"
 #include "core/common/status.h"
 #include "core/framework/callback.h"
+#include "core/framework/config_options.h"
 #include "core/framework/data_transfer_manager.h"
 #include "core/framework/data_types.h"
 #include "core/framework/fuse_nodes_funcs.h"
@@ -140,12 +141,15 @@ static Status TryCreateKernel(const Node& node,
   const KernelCreateInfo* kernel_create_info = nullptr;
   ORT_RETURN_IF_ERROR(kernel_registry.TryFindKernel(node, execution_provider.Type(), kernel_type_str_resolver,
                                                     &kernel_create_info));
+  // Kernels that run during optimization use the default configuration.
+  static const ConfigOptions kEmptyConfigOptions;
   OpKernelInfo kernel_info(node,
                            *kernel_create_info->kernel_def,
                            execution_provider,
                            constant_initialized_tensors,
                            ort_value_name_idx_map,
-                           data_transfer_mgr);
+                           data_transfer_mgr,
+                           kEmptyConfigOptions);
   return kernel_create_info->kernel_create_func(funcs_mgr, kernel_info, op_kernel);
 }
 
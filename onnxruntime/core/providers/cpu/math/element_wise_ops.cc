@@ -464,8 +464,75 @@ static void UntypedBroadcastVariadic(int input_count, OpKernelContext& context,
                                      AllocateTensorFunc allocate_tensor,
                                      const ProcessBroadcastSpanFuncs& funcs);
 
+// Broadcast two inputs with the MLAS element-wise engine. The engine collapses the broadcast shapes and handles
+// broadcasts along inner dimensions with stride-0 loops, which avoids the per-span overhead of BroadcastLooper for
+// patterns such as per-channel bias. Returns false if the output rank is not supported, in which case the caller
+// should fall back to UntypedBroadcastTwo.
+template <typename T>
+static bool MlasBroadcastTwo(OpKernelContext& context, MLAS_ELTWISE_BINARY_KIND kind) {
+  const Tensor& input0_tensor = *context.Input<Tensor>(0);
+  const Tensor& input1_tensor = *context.Input<Tensor>(1);
+  const auto& input0_dims = input0_tensor.Shape().GetDims();
+  const auto& input1_dims = input1_tensor.Shape().GetDims();
+
+  const size_t rank = std::max(input0_dims.size(), input1_dims.size());
+  if (rank > MLAS_ELTWISE_MAXIMUM_RANK) {
+    return false;
+  }
+
+  // validates the input shapes are compatible
+  InputBroadcaster input_broadcaster(input0_tensor, input1_tensor);
+  Tensor& output_tensor = *context.Output(0, input_broadcaster.GetOutputShape());
+  const auto& output_dims = output_tensor.Shape().GetDims();
+
+  if (output_tensor.Shape().Size() == 0) {
+    return true;
+  }
+
+  // inputs are right aligned against the output shape and broadcast dimensions have a stride of 0
+  auto compute_strides = [rank](gsl::span<const int64_t> dims, size_t* strides) {
+    const size_t offset = rank - dims.size();
+    std::fill_n(strides, offset, size_t{0});
+    size_t stride = 1;
+    for (size_t i = dims.size(); i > 0; --i) {
+      const size_t dim = narrow<size_t>(dims[i - 1]);
+      strides[offset + i - 1] = (dim == 1) ? 0 : stride;
+      stride *= dim;
+    }
+  };
+
+  size_t output_shape[MLAS_ELTWISE_MAXIMUM_RANK];
+  size_t input0_strides[MLAS_ELTWISE_MAXIMUM_RANK];
+  size_t input1_strides[MLAS_ELTWISE_MAXIMUM_RANK];
+
+  for (size_t i = 0; i < rank; ++i) {
+    output_shape[i] = narrow<size_t>(output_dims[i]);
+  }
+  compute_strides(input0_dims, input0_strides);
+  compute_strides(input1_dims, input1_strides);
+
+  MlasEltwiseBinary<T>(kind, rank, output_shape,
+                       input0_tensor.Data<T>(), input0_strides,
+                       input1_tensor.Data<T>(), input1_strides,
+                       output_tensor.MutableData<T>(),
+                       context.GetOperatorThreadPool());
+  return true;
+}
+
+// Types handled by MlasEltwiseBinary for the arithmetic operators.
+template <typename T>
+constexpr bool IsMlasEltwiseType() {
+  return std::is_same_v<T, float> || std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>;
+}
+
 template <typename T>
 Status Add<T>::Compute(OpKernelContext* context) const {
+  if constexpr (IsMlasEltwiseType<T>()) {
+    if (MlasBroadcastTwo<T>(*context, MlasEltwiseAdd)) {
+      return Status::OK();
+    }
+  }
+
   // BroadcastHelper received as argument may differ from 'helper' when parallelizing within a span
   ProcessBroadcastSpanFuncs funcs{
       [](BroadcastHelper& per_iter_bh) {
@@ -484,6 +551,12 @@ Status Add<T>::Compute(OpKernelContext* context) const {
 
 template <typename T>
 Status Sub<T>::Compute(OpKernelContext* context) const {
+  if constexpr (IsMlasEltwiseType<T>()) {
+    if (MlasBroadcastTwo<T>(*context, MlasEltwiseSub)) {
+      return Status::OK();
+    }
+  }
+
   ProcessBroadcastSpanFuncs funcs{
       [](BroadcastHelper& per_iter_bh) {
         per_iter_bh.OutputEigen<T>() = per_iter_bh.ScalarInput0<T>() - per_iter_bh.EigenInput1<T>().array();
@@ -501,6 +574,12 @@ Status Sub<T>::Compute(OpKernelContext* context) const {
 
 template <typename T>
 Status Mul<T>::Compute(OpKernelContext* context) const {
+  if constexpr (IsMlasEltwiseType<T>()) {
+    if (MlasBroadcastTwo<T>(*context, MlasEltwiseMul)) {
+      return Status::OK();
+    }
+  }
+
   ProcessBroadcastSpanFuncs funcs{
       [](BroadcastHelper& per_iter_bh) {
         per_iter_bh.OutputEigen<T>() = per_iter_bh.ScalarInput0<T>() * per_iter_bh.EigenInput1<T>().array();
@@ -518,6 +597,12 @@ Status Mul<T>::Compute(OpKernelContext* context) const {
 
 template <typename T>
 Status Div<T>::Compute(OpKernelContext* context) const {
+  if constexpr (IsMlasEltwiseType<T>()) {
+    if (MlasBroadcastTwo<T>(*context, MlasEltwiseDiv)) {
+      return Status::OK();
+    }
+  }
+
   ProcessBroadcastSpanFuncs funcs{
       [](BroadcastHelper& per_iter_bh) {
         per_iter_bh.OutputEigen<T>() = per_iter_bh.ScalarInput0<T>() / per_iter_bh.EigenInput1<T>().array();
@@ -537,6 +622,12 @@ namespace pow_internal {
 
 template <typename T, typename E>
 void PowImpl(OpKernelContext& context) {
+  if constexpr (std::is_same_v<T, float> && std::is_same_v<E, float>) {
+    if (MlasBroadcastTwo<float>(context, MlasEltwisePow)) {
+      return;
+    }
+  }
+
   ProcessBroadcastSpanFuncs funcs{
       [](BroadcastHelper& per_iter_bh) {
         const T X = per_iter_bh.ScalarInput0<T>();
@@ -733,6 +824,12 @@ struct Min_8::ComputeImpl {
         }};
 
     int input_count = inst.Node().InputArgCount().front();
+    if constexpr (IsMlasEltwiseType<T>()) {
+      if (input_count == 2 && MlasBroadcastTwo<T>(*context, MlasEltwiseMin)) {
+        return Status::OK();
+      }
+    }
+
     UntypedBroadcastVariadic(input_count, *context, typed_allocator, funcs);
 
     return Status::OK();
@@ -796,6 +893,10 @@ static Status MinMaxMLFloat16(const OpKernel& inst, OpKernelContext* context) {
       }};
 
   int input_count = inst.Node().InputArgCount().front();
+  if (input_count == 2 && MlasBroadcastTwo<MLFloat16>(*context, is_min ? MlasEltwiseMin : MlasEltwiseMax)) {
+    return Status::OK();
+  }
+
   UntypedBroadcastVariadic(input_count, *context, typed_allocator, funcs);
 
   return Status::OK();
@@ -855,6 +956,12 @@ struct Max_8::ComputeImpl {
         }};
 
     int input_count = inst.Node().InputArgCount().front();
+    if constexpr (IsMlasEltwiseType<T>()) {
+      if (input_count == 2 && MlasBroadcastTwo<T>(*context, MlasEltwiseMax)) {
+        return Status::OK();
+      }
+    }
+
     // TODO: Parallelize across spans in UntypedBroadcastVariadic to avoid specific logic here
     if (input_count == 2) {
       UntypedBroadcastTwo(*context, funcs, 1.0);
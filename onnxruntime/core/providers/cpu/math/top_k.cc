@@ -20,6 +20,7 @@
 #include "core/common/exceptions.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/tensor.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/platform/threadpool.h"
 #include "core/util/math_cpuonly.h"
 #include <queue>
@@ -326,6 +327,58 @@ static void FindTopKElements(const Tensor* input, const TensorShape& input_shape
   }
 }
 
+// Selects along the innermost axis with the MLAS threshold filter, which skips whole blocks of a row that
+// cannot beat the current K-th best element. Returns false if the MLAS routine does not apply.
+template <typename T>
+static bool TryMlasTopK(const Tensor* input, const TensorShape& input_shape, Tensor* values, Tensor* indices,
+                        const unsigned k, bool largest, bool sorted, const unsigned axis_parsed,
+                        concurrency::ThreadPool* threadpool) {
+  if constexpr (std::is_same<T, float>::value || std::is_same<T, MLFloat16>::value) {
+    if (axis_parsed + 1 != input_shape.NumDimensions()) {
+      return false;
+    }
+
+    const size_t rows = onnxruntime::narrow<size_t>(input_shape.SizeToDimension(axis_parsed));
+    const size_t cols = onnxruntime::narrow<size_t>(input_shape[axis_parsed]);
+
+    MlasTopK<T>(input->Data<T>(), rows, cols, k, largest, sorted, values->MutableData<T>(),
+                indices->MutableData<int64_t>(), threadpool);
+    return true;
+  } else {
+    return false;
+  }
+}
+
+// The comparator based implementation has no half precision support, so other axes select from a single
+// precision copy of the input and narrow the values afterwards.
+static void FindTopKElementsHalf(const Tensor* input, const TensorShape& input_shape, Tensor* values,
+                                 Tensor* indices, const TensorShape& output_shape, const unsigned k, bool largest,
+                                 bool sorted, const unsigned axis_parsed, AllocatorPtr allocator,
+                                 concurrency::ThreadPool* threadpool) {
+  Tensor input_float(DataTypeImpl::GetType<float>(), input_shape, allocator);
+  Tensor values_float(DataTypeImpl::GetType<float>(), output_shape, allocator);
+
+  const auto* input_data = input->Data<MLFloat16>();
+  auto* input_float_data = input_float.MutableData<float>();
+  for (int64_t i = 0, end = input_shape.Size(); i < end; ++i) {
+    input_float_data[i] = input_data[i].ToFloat();
+  }
+
+  if (largest) {
+    FindTopKElements<GreaterValueCmp<float>>(&input_float, input_shape, &values_float, indices, output_shape, k,
+                                             sorted, axis_parsed, threadpool);
+  } else {
+    FindTopKElements<LesserValueCmp<float>>(&input_float, input_shape, &values_float, indices, output_shape, k,
+                                            sorted, axis_parsed, threadpool);
+  }
+
+  const auto* values_float_data = values_float.Data<float>();
+  auto* values_data = values->MutableData<MLFloat16>();
+  for (int64_t i = 0, end = output_shape.Size(); i < end; ++i) {
+    values_data[i] = MLFloat16(values_float_data[i]);
+  }
+}
+
 // Wrapper over core TopK implementation
 template <typename T>
 static Status TopKImpl(OpKernelContext* p_op_kernel_context, const Tensor* input, const int axis, const unsigned k,
@@ -359,7 +412,17 @@ static Status TopKImpl(OpKernelContext* p_op_kernel_context, const Tensor* input
 
   auto* threadpool = p_op_kernel_context->GetOperatorThreadPool();
 
-  if (largest) {
+  if (TryMlasTopK<T>(input, input_shape, values, indices, k, largest, sorted,
+                     gsl::narrow_cast<unsigned>(axis_parsed), threadpool)) {
+    return Status::OK();
+  }
+
+  if constexpr (std::is_same<T, MLFloat16>::value) {
+    AllocatorPtr allocator;
+    ORT_RETURN_IF_ERROR(p_op_kernel_context->GetTempSpaceAllocator(&allocator));
+    FindTopKElementsHalf(input, input_shape, values, indices, output_shape, k, largest, sorted,
+                         gsl::narrow_cast<unsigned>(axis_parsed), allocator, threadpool);
+  } else if (largest) {
     FindTopKElements<GreaterValueCmp<T>>(input, input_shape, values, indices, output_shape, k, sorted,
                                          gsl::narrow_cast<unsigned>(axis_parsed), threadpool);
   } else {
@@ -402,6 +465,11 @@ Status GetTopK(const Tensor* input, const int axis, const unsigned k, bool large
     return Status::OK();
   }
 
+  if (TryMlasTopK<T>(input, input_shape, &output_values, &output_indices, k, largest, sorted,
+                     gsl::narrow_cast<unsigned>(axis_parsed), threadpool)) {
+    return Status::OK();
+  }
+
   if (largest) {
     FindTopKElements<GreaterValueCmp<T>>(input, input_shape, &output_values, &output_indices, output_shape, k, sorted,
                                          gsl::narrow_cast<unsigned>(axis_parsed), threadpool);
@@ -551,6 +619,11 @@ TopK<11, int64_t>::TopK(const OpKernelInfo& op_kernel_info) : OpKernel(op_kernel
   TopkOpset11ConstructorCommon(op_kernel_info, axis_, largest_, sorted_);
 }
 
+template <>
+TopK<11, MLFloat16>::TopK(const OpKernelInfo& op_kernel_info) : OpKernel(op_kernel_info) {
+  TopkOpset11ConstructorCommon(op_kernel_info, axis_, largest_, sorted_);
+}
+
 // Opset ver - 11
 template <>
 Status TopK<11, float>::Compute(OpKernelContext* p_op_kernel_context) const {
@@ -572,6 +645,11 @@ Status TopK<11, int64_t>::Compute(OpKernelContext* p_op_kernel_context) const {
   return ComputeImplOpset1011<int64_t>(p_op_kernel_context, axis_, largest_, sorted_);
 }
 
+template <>
+Status TopK<11, MLFloat16>::Compute(OpKernelContext* p_op_kernel_context) const {
+  return ComputeImplOpset1011<MLFloat16>(p_op_kernel_context, axis_, largest_, sorted_);
+}
+
 // Register necessary kernels
 // spec https://github.com/onnx/onnx/blob/main/docs/Operators.md#TopK
 
@@ -600,5 +678,6 @@ REGISTER_TOPK_TYPED_KERNEL(11, float);
 REGISTER_TOPK_TYPED_KERNEL(11, double);
 REGISTER_TOPK_TYPED_KERNEL(11, int64_t);
 REGISTER_TOPK_TYPED_KERNEL(11, int32_t);
+REGISTER_TOPK_TYPED_KERNEL(11, MLFloat16);
 
 }  // namespace onnxruntime
@@ -6,6 +6,7 @@
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
 #include "core/providers/cpu/ml/ml_common.h"
+#include "core/providers/cpu/ml/string_lookup.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -26,14 +27,20 @@ class CategoryMapper final : public OpKernel {
 
     ORT_ENFORCE(num_entries == int_categories.size());
 
-    string_to_int_map_.reserve(num_entries);
+    string_to_int_values_.reserve(num_entries);
     int_to_string_map_.reserve(num_entries);
 
     for (size_t i = 0; i < num_entries; ++i) {
       const std::string& str = string_categories[i];
       int64_t index = int_categories[i];
 
-      string_to_int_map_[str] = index;
+      // the last mapping of a duplicated string wins
+      auto inserted = string_to_int_lookup_.Insert(str);
+      if (inserted.second) {
+        string_to_int_values_.push_back(index);
+      } else {
+        string_to_int_values_[inserted.first] = index;
+      }
       int_to_string_map_[index] = str;
     }
   }
@@ -41,7 +48,8 @@ class CategoryMapper final : public OpKernel {
   Status Compute(OpKernelContext* context) const override;
 
  private:
-  std::unordered_map<std::string, int64_t> string_to_int_map_;
+  StringLookup string_to_int_lookup_;
+  std::vector<int64_t> string_to_int_values_;
   std::unordered_map<int64_t, std::string> int_to_string_map_;
 
   std::string default_string_;
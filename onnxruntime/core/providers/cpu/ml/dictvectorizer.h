@@ -2,10 +2,14 @@
 // Licensed under the MIT License.
 
 #pragma once
+#include <algorithm>
 #include <string>
+#include <tuple>
 #include <vector>
 #include "core/common/common.h"
+#include "core/common/inlined_containers.h"
 #include "core/framework/op_kernel.h"
+#include "core/providers/cpu/ml/string_lookup.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -16,24 +20,84 @@ class DictVectorizerOp final : public OpKernel {
     // In some stupid models, the vocabulary could have duplicated elements.
     // We must support that, otherwise some tests will be break.
     ORT_ENFORCE(info.GetAttrs(std::is_same<AttrType, std::string>::value ? "string_vocabulary" : "int64_vocabulary", vocabulary_).IsOK());
+
+    // Index the vocabulary so that the output is filled from the entries of the input map.
+    // Positions of a duplicated element are chained through next_position_.
+    next_position_.assign(vocabulary_.size(), kNoPosition);
+    std::vector<size_t> last_position;
+    for (size_t i = 0, end = vocabulary_.size(); i < end; ++i) {
+      size_t id;
+      bool inserted;
+      if constexpr (std::is_same<AttrType, std::string>::value) {
+        std::tie(id, inserted) = vocabulary_lookup_.Insert(vocabulary_[i]);
+      } else {
+        auto result = vocabulary_ids_.emplace(vocabulary_[i], first_position_.size());
+        id = result.first->second;
+        inserted = result.second;
+      }
+      if (inserted) {
+        first_position_.push_back(i);
+        last_position.push_back(i);
+      } else {
+        next_position_[last_position[id]] = i;
+        last_position[id] = i;
+      }
+    }
   }
   common::Status Compute(OpKernelContext* ctx) const override {
     const auto* map = ctx->Input<std::map<AttrType, TargetType> >(0);
     auto* Y = ctx->Output(0, {1, static_cast<int64_t>(vocabulary_.size())});
     auto* y_data = Y->MutableData<TargetType>();
-    for (size_t i = 0, end = vocabulary_.size(); i < end; ++i) {
-      auto index = map->find(vocabulary_[i]);
-      if (index != map->end()) {
-        *y_data++ = index->second;
-      } else {
-        // Any keys not present in the input dictionary, will be zero in the output array
-        *y_data++ = TargetType();
+
+    if (map->size() > first_position_.size()) {
+      for (size_t i = 0, end = vocabulary_.size(); i < end; ++i) {
+        auto index = map->find(vocabulary_[i]);
+        if (index != map->end()) {
+          *y_data++ = index->second;
+        } else {
+          // Any keys not present in the input dictionary, will be zero in the output array
+          *y_data++ = TargetType();
+        }
+      }
+      return Status::OK();
+    }
+
+    // The input map is usually much smaller than the vocabulary: look up its keys in the
+    // vocabulary instead of searching the map for every element of the vocabulary.
+    // Any keys not present in the input dictionary, will be zero in the output array
+    std::fill_n(y_data, vocabulary_.size(), TargetType());
+    for (const auto& entry : *map) {
+      const size_t id = FindVocabularyId(entry.first);
+      if (id == kNoPosition) {
+        continue;
+      }
+      for (size_t position = first_position_[id]; position != kNoPosition; position = next_position_[position]) {
+        y_data[position] = entry.second;
       }
     }
     return Status::OK();
   }
 
   std::vector<AttrType> vocabulary_;
+
+ private:
+  static constexpr size_t kNoPosition = StringLookup::npos;
+
+  size_t FindVocabularyId(const AttrType& key) const {
+    if constexpr (std::is_same<AttrType, std::string>::value) {
+      return vocabulary_lookup_.Find(key);
+    } else {
+      auto found = vocabulary_ids_.find(key);
+      return found == vocabulary_ids_.end() ? kNoPosition : found->second;
+    }
+  }
+
+  // Distinct vocabulary elements: their ids, the first position of each id in the output and
+  // the next position of the same element for duplicated ones.
+  StringLookup vocabulary_lookup_;
+  InlinedHashMap<AttrType, size_t> vocabulary_ids_;
+  std::vector<size_t> first_position_;
+  std::vector<size_t> next_position_;
 };
 
 }  // namespace ml
@@ -2,7 +2,6 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/ml/label_encoder.h"
-#include <algorithm>
 #include "core/common/gsl.h"
 using namespace ::onnxruntime::common;
 
@@ -28,39 +27,44 @@ Status LabelEncoder::Compute(OpKernelContext* context) const {
   const TensorShape& shape = X.Shape();
   Tensor& Y = *context->Output(0, shape);
 
+  const auto num_elements = shape.Size();
+  auto* threadpool = context->GetOperatorThreadPool();
+
   if (X.IsDataTypeString()) {
     if (!Y.IsDataType<int64_t>())
       return Status(ONNXRUNTIME, FAIL, "Input of tensor(string) must have output of tensor(int64)");
 
-    auto input = gsl::make_span(X.Data<std::string>(), onnxruntime::narrow<size_t>(shape.Size()));
-    auto output = gsl::make_span(Y.MutableData<int64_t>(), onnxruntime::narrow<size_t>(shape.Size()));
-    auto out = output.begin();
-
-    // map isn't going to change so get end() once instead of calling inside the for_each loop
-    const auto map_end = string_to_int_map_.end();
-
-    std::for_each(input.begin(), input.end(),
-                  [&out, &map_end, this](const std::string& value) {
-                    auto map_to = string_to_int_map_.find(value);
-                    *out = map_to == map_end ? default_int_ : map_to->second;
-                    ++out;
-                  });
+    auto input = gsl::make_span(X.Data<std::string>(), onnxruntime::narrow<size_t>(num_elements));
+    auto output = gsl::make_span(Y.MutableData<int64_t>(), onnxruntime::narrow<size_t>(num_elements));
+
+    concurrency::ThreadPool::TryParallelFor(
+        threadpool, num_elements, TensorOpCost{sizeof(std::string), sizeof(int64_t), kStringLookupCycles},
+        [this, &input, &output](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; ++i) {
+            const size_t index = static_cast<size_t>(i);
+            const size_t found = string_to_int_lookup_.Find(input[index]);
+            output[index] = found == StringLookup::npos ? default_int_ : string_to_int_values_[found];
+          }
+        });
   } else {
     if (!Y.IsDataTypeString())
       return Status(ONNXRUNTIME, FAIL, "Input of tensor(int64) must have output of tensor(string)");
 
-    auto input = gsl::make_span(X.Data<int64_t>(), onnxruntime::narrow<size_t>(shape.Size()));
-    auto output = gsl::make_span(Y.MutableData<std::string>(), onnxruntime::narrow<size_t>(shape.Size()));
-    auto out = output.begin();
+    auto input = gsl::make_span(X.Data<int64_t>(), onnxruntime::narrow<size_t>(num_elements));
+    auto output = gsl::make_span(Y.MutableData<std::string>(), onnxruntime::narrow<size_t>(num_elements));
 
+    // map isn't going to change so get end() once instead of calling inside the loop
     const auto map_end = int_to_string_map_.end();
 
-    std::for_each(input.begin(), input.end(),
-                  [&out, &map_end, this](const int64_t& value) {
-                    auto map_to = int_to_string_map_.find(value);
-                    *out = map_to == map_end ? default_string_ : map_to->second;
-                    ++out;
-                  });
+    concurrency::ThreadPool::TryParallelFor(
+        threadpool, num_elements, TensorOpCost{sizeof(int64_t), sizeof(std::string), kStringLookupCycles},
+        [this, &input, &output, &map_end](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; ++i) {
+            const size_t index = static_cast<size_t>(i);
+            auto map_to = int_to_string_map_.find(input[index]);
+            output[index] = map_to == map_end ? default_string_ : map_to->second;
+          }
+        });
   }
 
   return Status::OK();
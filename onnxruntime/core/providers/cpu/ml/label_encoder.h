@@ -6,6 +6,7 @@
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
 #include "core/providers/cpu/ml/ml_common.h"
+#include "core/providers/cpu/ml/string_lookup.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -22,13 +23,19 @@ class LabelEncoder final : public OpKernel {
 
     auto num_entries = string_classes.size();
 
-    string_to_int_map_.reserve(num_entries);
+    string_to_int_values_.reserve(num_entries);
     int_to_string_map_.reserve(num_entries);
 
     for (size_t i = 0; i < num_entries; ++i) {
       const std::string& str = string_classes[i];
 
-      string_to_int_map_[str] = i;
+      // the last index of a duplicated string wins
+      auto inserted = string_to_int_lookup_.Insert(str);
+      if (inserted.second) {
+        string_to_int_values_.push_back(static_cast<int64_t>(i));
+      } else {
+        string_to_int_values_[inserted.first] = static_cast<int64_t>(i);
+      }
       int_to_string_map_[i] = str;
     }
   }
@@ -36,7 +43,8 @@ class LabelEncoder final : public OpKernel {
   Status Compute(OpKernelContext* context) const override;
 
  private:
-  std::unordered_map<std::string, int64_t> string_to_int_map_;
+  StringLookup string_to_int_lookup_;
+  std::vector<int64_t> string_to_int_values_;
   std::unordered_map<int64_t, std::string> int_to_string_map_;
 
   std::string default_string_;
@@ -63,9 +71,18 @@ class LabelEncoder_2 final : public OpKernel {
                 "(name: ", info.node().Name(), ") must have the same length. ",
                 "However, the number of key is ", num_keys, " and the number of ",
                 "values is ", num_values, ".");
-    _map.reserve(num_keys);
-    for (size_t i = 0; i < num_keys; ++i)
-      _map.emplace(keys[i], values[i]);
+    if constexpr (std::is_same<TKey, std::string>::value) {
+      // the first value of a duplicated key wins, as with emplace
+      _string_values.reserve(num_keys);
+      for (size_t i = 0; i < num_keys; ++i) {
+        if (_string_lookup.Insert(keys[i]).second)
+          _string_values.push_back(values[i]);
+      }
+    } else {
+      _map.reserve(num_keys);
+      for (size_t i = 0; i < num_keys; ++i)
+        _map.emplace(keys[i], values[i]);
+    }
   }
 
   Status Compute(OpKernelContext* context) const override {
@@ -78,13 +95,27 @@ class LabelEncoder_2 final : public OpKernel {
     auto input = X.template DataAsSpan<TKey>();
     auto output = Y.template MutableDataAsSpan<TValue>();
 
-    for (int64_t i = 0; i < shape.Size(); ++i) {
-      const auto found = _map.find(input[onnxruntime::narrow<size_t>(i)]);
-      if (found == _map.end())
-        output[onnxruntime::narrow<size_t>(i)] = _default_value;
-      else
-        output[onnxruntime::narrow<size_t>(i)] = found->second;
-    }
+    const TensorOpCost cost{static_cast<double>(sizeof(TKey)), static_cast<double>(sizeof(TValue)),
+                            std::is_same<TKey, std::string>::value || std::is_same<TValue, std::string>::value
+                                ? kStringLookupCycles
+                                : kNumericLookupCycles};
+    concurrency::ThreadPool::TryParallelFor(
+        context->GetOperatorThreadPool(), shape.Size(), cost,
+        [this, &input, &output](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; ++i) {
+            const size_t index = onnxruntime::narrow<size_t>(i);
+            if constexpr (std::is_same<TKey, std::string>::value) {
+              const size_t found = _string_lookup.Find(input[index]);
+              output[index] = found == StringLookup::npos ? _default_value : _string_values[found];
+            } else {
+              const auto found = _map.find(input[index]);
+              if (found == _map.end())
+                output[index] = _default_value;
+              else
+                output[index] = found->second;
+            }
+          }
+        });
 
     return Status::OK();
   }
@@ -99,6 +130,9 @@ class LabelEncoder_2 final : public OpKernel {
   // means that the "a_key" in the input would be mapped to "a_value".
   // If _map doesn't contain "a_key", we use _default_value as its output.
   InlinedHashMap<TKey, TValue> _map;
+  // String keys are looked up in _string_lookup and their values are indexed by the key id.
+  StringLookup _string_lookup;
+  std::vector<TValue> _string_values;
   TValue _default_value;
   // ONNX attribute name to load keys.
   std::string _key_field_name;
@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+namespace ml {
+
+// Estimated cycles of a string and of a numeric key lookup, used to cost parallel batches.
+constexpr double kStringLookupCycles = 40.0;
+constexpr double kNumericLookupCycles = 10.0;
+
+// Immutable set of strings built once by a kernel constructor and then queried concurrently.
+// Every distinct key gets a dense id in insertion order, the kernels store their values in
+// arrays indexed by that id.
+//
+// std::unordered_map<std::string, T> allocates a node per key and a lookup hashes the whole
+// query, follows the bucket list and compares against std::string objects scattered in the heap.
+// Here the keys are stored back to back in one buffer and the table is open addressed with
+// linear probing, at most half full. A slot holds the length and the first 8 bytes of its key
+// next to a byte of the hash so that a probe rarely leaves the table: a miss usually stops at
+// the first empty slot and a hit on a key of 8 bytes or less is decided without reading the
+// key buffer.
+class StringLookup {
+ public:
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+  StringLookup() = default;
+
+  // Adds a key. Returns the id of the key and true if it was not present yet.
+  std::pair<size_t, bool> Insert(std::string_view key) {
+    const uint64_t hash = Hash(key);
+    if (2 * (size() + 1) > tags_.size()) {
+      Rehash(tags_.empty() ? 16 : 2 * tags_.size());
+    }
+
+    size_t found = Find(key, hash);
+    if (found != npos) {
+      return {found, false};
+    }
+
+    const size_t id = size();
+    ORT_ENFORCE(id < std::numeric_limits<uint32_t>::max() &&
+                    key.size() < std::numeric_limits<uint32_t>::max(),
+                "Too many or too long strings for the lookup table.");
+    offsets_.push_back(key_data_.size());
+    key_data_.append(key.data(), key.size());
+    hashes_.push_back(hash);
+    Place(id, hash, key);
+    return {id, true};
+  }
+
+  // Returns the id of the key or npos if it is not in the set.
+  size_t Find(std::string_view key) const {
+    if (tags_.empty()) {
+      return npos;
+    }
+    return Find(key, Hash(key));
+  }
+
+  size_t size() const { return offsets_.size(); }
+  bool empty() const { return offsets_.empty(); }
+
+  std::string_view key(size_t id) const {
+    const size_t end = id + 1 < offsets_.size() ? offsets_[id + 1] : key_data_.size();
+    return std::string_view(key_data_.data() + offsets_[id], end - offsets_[id]);
+  }
+
+ private:
+  struct Slot {
+    uint64_t prefix;
+    uint32_t length;
+    uint32_t id;
+  };
+
+  // Loads up to 8 bytes of the string, zero padded.
+  static uint64_t LoadPrefix(const char* data, size_t length) {
+    uint64_t word = 0;
+    std::memcpy(&word, data, length < sizeof(word) ? length : sizeof(word));
+    return word;
+  }
+
+  static uint64_t Mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // Hashes the string 8 bytes at a time, the categories are mostly short and the loop usually
+  // runs once or twice.
+  static uint64_t Hash(std::string_view key) {
+    constexpr uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+    const char* data = key.data();
+    size_t length = key.size();
+    uint64_t h = length * multiplier;
+    for (; length >= 8; data += 8, length -= 8) {
+      uint64_t word;
+      std::memcpy(&word, data, sizeof(word));
+      h = (h ^ word) * multiplier;
+      h ^= h >> 29;
+    }
+    if (length > 0) {
+      h = (h ^ LoadPrefix(data, length)) * multiplier;
+    }
+    return Mix(h);
+  }
+
+  // A tag is never 0, 0 marks an empty slot.
+  static uint8_t Tag(uint64_t hash) { return static_cast<uint8_t>(hash >> 57) | 0x80; }
+
+  size_t Find(std::string_view key, uint64_t hash) const {
+    const size_t mask = tags_.size() - 1;
+    const uint8_t tag = Tag(hash);
+    const uint64_t prefix = LoadPrefix(key.data(), key.size());
+    const uint32_t length = static_cast<uint32_t>(key.size());
+
+    for (size_t index = static_cast<size_t>(hash) & mask;; index = (index + 1) & mask) {
+      const uint8_t slot_tag = tags_[index];
+      if (slot_tag == 0) {
+        return npos;
+      }
+      if (slot_tag == tag) {
+        const Slot& slot = slots_[index];
+        if (slot.length == length && slot.prefix == prefix &&
+            (length <= 8 ||
+             std::memcmp(key_data_.data() + offsets_[slot.id] + 8, key.data() + 8, length - 8) == 0)) {
+          return slot.id;
+        }
+      }
+    }
+  }
+
+  void Place(size_t id, uint64_t hash, std::string_view key) {
+    const size_t mask = tags_.size() - 1;
+    size_t index = static_cast<size_t>(hash) & mask;
+    while (tags_[index] != 0) {
+      index = (index + 1) & mask;
+    }
+    tags_[index] = Tag(hash);
+    slots_[index] = Slot{LoadPrefix(key.data(), key.size()), static_cast<uint32_t>(key.size()),
+                         static_cast<uint32_t>(id)};
+  }
+
+  void Rehash(size_t capacity) {
+    tags_.assign(capacity, 0);
+    slots_.assign(capacity, Slot{0, 0, 0});
+    for (size_t id = 0; id < size(); ++id) {
+      Place(id, hashes_[id], key(id));
+    }
+  }
+
+  std::string key_data_;
+  std::vector<size_t> offsets_;
+  std::vector<uint64_t> hashes_;
+  std::vector<uint8_t> tags_;
+  std::vector<Slot> slots_;
+};
+
+}  // namespace ml
+}  // namespace onnxruntime
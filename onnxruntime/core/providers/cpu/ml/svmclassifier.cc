@@ -74,6 +74,12 @@ SVMClassifier::SVMClassifier(const OpKernelInfo& info)
   ORT_ENFORCE(coefficients_.size() > 0);
   weights_are_all_positive_ = std::all_of(coefficients_.cbegin(), coefficients_.cend(),
                                           [](float value) { return value >= 0.f; });
+
+  if (mode_ == SVM_TYPE::SVM_SVC) {
+    PrepackKernelVectors(info, support_vectors_, vector_count_, feature_count_);
+  } else {
+    PrepackKernelVectors(info, coefficients_, class_count_, feature_count_);
+  }
 }
 
 template <typename LabelType>
@@ -190,6 +196,8 @@ Status SVMClassifier::ComputeImpl(OpKernelContext& ctx,
 
   std::vector<float> kernels_data;
   std::vector<int64_t> votes_data;
+  gsl::span<float> classifier_scores;
+  int64_t num_slots_per_iteration = 0;
 
   std::vector<float> classifier_scores_data;
   std::vector<float> probsp2_data;
@@ -217,12 +225,10 @@ Status SVMClassifier::ComputeImpl(OpKernelContext& ctx,
                               threadpool);
 
   } else {
-    gsl::span<float> classifier_scores;
-
     // if we have one classifier, are writing directly to the final buffer,
     // and will add an additional score in the results, leave a space between each classifier score so that
     // we can parallelize the batch processing below.
-    int64_t num_slots_per_iteration = write_additional_scores >= 0 ? 2 : num_classifiers;
+    num_slots_per_iteration = write_additional_scores >= 0 ? 2 : num_classifiers;
 
     if (have_proba) {
       // we will write num_batches * num_classifiers scores first, and transform those to num_batches * class_count_,
@@ -240,72 +246,76 @@ Status SVMClassifier::ComputeImpl(OpKernelContext& ctx,
     votes_data.resize(num_batches * class_count_, 0);
 
     auto kernels_span = gsl::make_span<float>(kernels_data.data(), kernels_data.size());
-    auto votes_span = gsl::make_span<int64_t>(votes_data.data(), votes_data.size());
 
     // combine the input data with the support vectors and apply the kernel type
     // output is {num_batches, vector_count_}
     batched_kernel_dot<float>(x_data, support_vectors_, num_batches, vector_count_, feature_count_, 0.f, kernels_span,
                               threadpool);
+  }
 
-    for (int64_t n = 0; n < num_batches; n++) {
-      // reduce scores from kernels using coefficients, taking into account the varying number of support vectors
-      // per class.
-      // coefficients: [num_classes - 1, vector_count_]
-      //
-      // e.g. say you have 3 classes, with 3 x 3 coefficients
-      //
-      // AA AB AC
-      // BA BB BC
-      // CA CB CC
-      //
-      // you can remove the diagonal line of items comparing a class with itself leaving one less row.
-      //
-      // BA AB AC
-      // CA CB BC
-      //
-      // for each class there is a coefficient per support vector, and a class has one or more support vectors.
-      //
-      // Combine the scores for the two combinations for two classes with their coefficient.
-      // e.g. AB combines with BA.
-      // If A has 3 support vectors and B has 2, there's a 3x2 block for AB and a 2x3 block for BA to combine
-
-      auto cur_kernels = kernels_span.subspan(n * SafeInt<size_t>(vector_count_), onnxruntime::narrow<size_t>(vector_count_));
-      auto cur_scores = classifier_scores.subspan(n * SafeInt<size_t>(num_slots_per_iteration), onnxruntime::narrow<size_t>(num_classifiers));
-      auto cur_votes = votes_span.subspan(n * SafeInt<size_t>(class_count_), onnxruntime::narrow<size_t>(class_count_));
-      auto scores_iter = cur_scores.begin();
-
-      size_t classifier_idx = 0;
-      for (int64_t i = 0; i < class_count_ - 1; i++) {
-        int64_t start_index_i = starting_vector_[onnxruntime::narrow<size_t>(i)];  // start of support vectors for class i
-        int64_t class_i_support_count = vectors_per_class_[onnxruntime::narrow<size_t>(i)];
-        int64_t i_coeff_row_offset = vector_count_ * i;
-
-        for (int64_t j = i + 1; j < class_count_; j++) {
-          int64_t start_index_j = starting_vector_[onnxruntime::narrow<size_t>(j)];  // start of support vectors for class j
-          int64_t class_j_support_count = vectors_per_class_[onnxruntime::narrow<size_t>(j)];
-          int64_t j_coeff_row_offset = vector_count_ * (j - 1);
-
-          double sum = 0;
-
-          const float* val1 = &(coefficients_[j_coeff_row_offset + SafeInt<size_t>(start_index_i)]);
-          const float* val2 = &(cur_kernels[onnxruntime::narrow<size_t>(start_index_i)]);
-          for (int64_t m = 0; m < class_i_support_count; ++m, ++val1, ++val2)
-            sum += *val1 * *val2;
-
-          val1 = &(coefficients_[i_coeff_row_offset + SafeInt<size_t>(start_index_j)]);
-          val2 = &(cur_kernels[onnxruntime::narrow<size_t>(start_index_j)]);
-
-          for (int64_t m = 0; m < class_j_support_count; ++m, ++val1, ++val2)
-            sum += *val1 * *val2;
-
-          sum += rho_[classifier_idx++];
-
-          *scores_iter++ = static_cast<float>(sum);
-          ++(cur_votes[onnxruntime::narrow<size_t>(sum > 0 ? i : j)]);
-        }
+  // The scores and the votes of every batch are computed along with the final scores below.
+  auto score_batch = [this, &kernels_data, &votes_data, classifier_scores, num_slots_per_iteration,
+                      num_classifiers](ptrdiff_t n) {
+    auto kernels_span = gsl::make_span<const float>(kernels_data.data(), kernels_data.size());
+    auto votes_span = gsl::make_span<int64_t>(votes_data.data(), votes_data.size());
+
+    // reduce scores from kernels using coefficients, taking into account the varying number of support vectors
+    // per class.
+    // coefficients: [num_classes - 1, vector_count_]
+    //
+    // e.g. say you have 3 classes, with 3 x 3 coefficients
+    //
+    // AA AB AC
+    // BA BB BC
+    // CA CB CC
+    //
+    // you can remove the diagonal line of items comparing a class with itself leaving one less row.
+    //
+    // BA AB AC
+    // CA CB BC
+    //
+    // for each class there is a coefficient per support vector, and a class has one or more support vectors.
+    //
+    // Combine the scores for the two combinations for two classes with their coefficient.
+    // e.g. AB combines with BA.
+    // If A has 3 support vectors and B has 2, there's a 3x2 block for AB and a 2x3 block for BA to combine
+
+    auto cur_kernels = kernels_span.subspan(n * SafeInt<size_t>(vector_count_), onnxruntime::narrow<size_t>(vector_count_));
+    auto cur_scores = classifier_scores.subspan(n * SafeInt<size_t>(num_slots_per_iteration), onnxruntime::narrow<size_t>(num_classifiers));
+    auto cur_votes = votes_span.subspan(n * SafeInt<size_t>(class_count_), onnxruntime::narrow<size_t>(class_count_));
+    auto scores_iter = cur_scores.begin();
+
+    size_t classifier_idx = 0;
+    for (int64_t i = 0; i < class_count_ - 1; i++) {
+      int64_t start_index_i = starting_vector_[onnxruntime::narrow<size_t>(i)];  // start of support vectors for class i
+      int64_t class_i_support_count = vectors_per_class_[onnxruntime::narrow<size_t>(i)];
+      int64_t i_coeff_row_offset = vector_count_ * i;
+
+      for (int64_t j = i + 1; j < class_count_; j++) {
+        int64_t start_index_j = starting_vector_[onnxruntime::narrow<size_t>(j)];  // start of support vectors for class j
+        int64_t class_j_support_count = vectors_per_class_[onnxruntime::narrow<size_t>(j)];
+        int64_t j_coeff_row_offset = vector_count_ * (j - 1);
+
+        double sum = 0;
+
+        const float* val1 = &(coefficients_[j_coeff_row_offset + SafeInt<size_t>(start_index_i)]);
+        const float* val2 = &(cur_kernels[onnxruntime::narrow<size_t>(start_index_i)]);
+        for (int64_t m = 0; m < class_i_support_count; ++m, ++val1, ++val2)
+          sum += *val1 * *val2;
+
+        val1 = &(coefficients_[i_coeff_row_offset + SafeInt<size_t>(start_index_j)]);
+        val2 = &(cur_kernels[onnxruntime::narrow<size_t>(start_index_j)]);
+
+        for (int64_t m = 0; m < class_j_support_count; ++m, ++val1, ++val2)
+          sum += *val1 * *val2;
+
+        sum += rho_[classifier_idx++];
+
+        *scores_iter++ = static_cast<float>(sum);
+        ++(cur_votes[onnxruntime::narrow<size_t>(sum > 0 ? i : j)]);
       }
     }
-  }
+  };
 
   auto finalize_batch = [this, &final_scores, final_scores_per_batch,
                          have_proba, &probsp2_data, class_count_squared,
@@ -374,16 +384,23 @@ Status SVMClassifier::ComputeImpl(OpKernelContext& ctx,
                                          write_additional_scores, true, nullptr);
   };
 
-  // TODO: Refine this rough metric to choose when to parallelize.
-  if (num_batches > 512) {
-    concurrency::ThreadPool::TryBatchParallelFor(threadpool, num_batches, finalize_batch, -1);
-  } else {
-    {
-      for (ptrdiff_t i = 0; i < num_batches; ++i) {
-        finalize_batch(i);
-      }
-    }
-  }
+  const bool score_batches = mode_ == SVM_TYPE::SVM_SVC;
+  const double batch_cycles = static_cast<double>((score_batches ? 2 * vector_count_ : 0) +
+                                                  (have_proba ? 20 * class_count_squared : 0) +
+                                                  8 * final_scores_per_batch);
+  const TensorOpCost cost{static_cast<double>(final_scores_per_batch * sizeof(float)),
+                          static_cast<double>(final_scores_per_batch * sizeof(float)),
+                          batch_cycles};
+  concurrency::ThreadPool::TryParallelFor(
+      threadpool, num_batches, cost,
+      [&score_batch, &finalize_batch, score_batches](ptrdiff_t first, ptrdiff_t last) {
+        for (ptrdiff_t i = first; i < last; ++i) {
+          if (score_batches) {
+            score_batch(i);
+          }
+          finalize_batch(i);
+        }
+      });
 
   return Status::OK();
 }
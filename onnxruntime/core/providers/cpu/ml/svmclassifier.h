@@ -30,6 +30,32 @@ class SVMCommon {
   void set_kernel_type(KERNEL new_kernel_type) { kernel_type_ = new_kernel_type; }
   KERNEL get_kernel_type() const { return kernel_type_; }
 
+  // Prepacks the constant operand of batched_kernel_dot, the support vectors or the linear coefficients,
+  // [n, k] and stored in `vectors` which must outlive the kernel. The RBF kernel does not use the GEMM.
+  void PrepackKernelVectors(const OpKernelInfo& info, gsl::span<const float> vectors, ptrdiff_t n, ptrdiff_t k) {
+    if (kernel_type_ == KERNEL::RBF || n <= 0 || k <= 0 || vectors.size() != static_cast<size_t>(n * k)) {
+      return;
+    }
+
+    kernel_vectors_ = vectors.data();
+
+    AllocatorPtr alloc = info.GetAllocator(OrtMemType::OrtMemTypeDefault);
+    const size_t packed_size = MlasGemmPackBSize(static_cast<size_t>(n), static_cast<size_t>(k));
+    if (alloc == nullptr || packed_size == 0) {
+      return;
+    }
+
+    packed_kernel_vectors_ = IAllocator::MakeUniquePtr<void>(alloc, packed_size, true);
+    memset(packed_kernel_vectors_.get(), 0, packed_size);
+    MlasGemmPackB(CblasTrans, static_cast<size_t>(n), static_cast<size_t>(k), vectors.data(), static_cast<size_t>(k),
+                  packed_kernel_vectors_.get());
+  }
+
+  // Computes the kernel between the m rows of `a` and the n vectors of `b`, out is [m, n].
+  // The dot products of all the pairs come from one GEMM, then the non linear part of the kernel is
+  // applied to each row in parallel. The RBF kernel computes the squared distances from the differences
+  // of the pairs in parallel over the rows: expanding them as |a|^2 + |b|^2 - 2 a.b to use the GEMM
+  // cancels catastrophically in float for unscaled features that are close to each other.
   template <typename T>
   void batched_kernel_dot(const gsl::span<const T> a, const gsl::span<const T> b,
                           ptrdiff_t m, ptrdiff_t n, ptrdiff_t k,
@@ -38,61 +64,84 @@ class SVMCommon {
                           concurrency::ThreadPool* threadpool) const {
     assert(a.size() == size_t(m * k) && b.size() == size_t(k * n) && out.size() == size_t(m * n));
 
-    if (kernel_type_ == KERNEL::RBF) {
-      T* cur_out = out.data();
-      const T* cur_batch = a.data();
-
-      // each batch has 'k' features
-      for (int64_t batch = 0; batch < m; ++batch) {
-        const T* cur_support_vector = b.data();
+    if (m == 0 || n == 0) {
+      return;
+    }
 
-        // broadcast the support vectors against the k features in each batch. output is one value per support vector
-        for (int64_t support_vector = 0; support_vector < n; ++support_vector) {
-          T sum = 0.f;
-          const T* cur_input = cur_batch;
+    if (kernel_type_ == KERNEL::RBF) {
+      const TensorOpCost cost{static_cast<double>(n * k * sizeof(T)), static_cast<double>(n * sizeof(T)),
+                              static_cast<double>(n * (k * 3 + 16))};
+      concurrency::ThreadPool::TryParallelFor(
+          threadpool, m, cost,
+          [this, a, b, out, n, k](ptrdiff_t first, ptrdiff_t last) {
+            for (ptrdiff_t i = first; i < last; ++i) {
+              T* row = out.data() + i * n;
+              const T* cur_support_vector = b.data();
+              for (ptrdiff_t j = 0; j < n; ++j) {
+                T sum = 0.f;
+                const T* cur_input = a.data() + i * k;
+                for (ptrdiff_t feature = 0; feature < k; ++feature) {
+                  T val = *cur_input++ - *cur_support_vector++;
+                  sum += val * val;
+                }
+                row[j] = -gamma_ * sum;
+              }
+              MlasComputeExp(row, row, static_cast<size_t>(n));
+            }
+          });
+      return;
+    }
 
-          for (int64_t feature = 0; feature < k; ++feature) {
-            T val = *cur_input++ - *cur_support_vector++;
-            sum += val * val;
-          }
+    float alpha = 1.f;
+    float c = scalar_C;  // scalar_C is used for LINEAR in the GEMM
 
-          *cur_out++ = std::exp(-gamma_ * sum);
-        }
+    if (kernel_type_ != KERNEL::LINEAR) {
+      // kernel_type_ == POLY or SIGMOID
+      alpha = gamma_;
+      c = coef0_;
+    }
 
-        cur_batch += k;  // move to start of next batch
+    if (packed_kernel_vectors_ != nullptr && b.data() == kernel_vectors_) {
+      if (c != 0.f) {
+        std::fill(out.begin(), out.end(), c);
       }
+      MlasGemm(CblasNoTrans, static_cast<size_t>(m), static_cast<size_t>(n), static_cast<size_t>(k),
+               alpha, a.data(), static_cast<size_t>(k), packed_kernel_vectors_.get(),
+               c != 0.f ? 1.f : 0.f, out.data(), static_cast<size_t>(n), threadpool);
     } else {
-      float alpha = 1.f;
-      float beta = 1.f;
       static const TensorShape shape_C({1});
-      float c = scalar_C;  // scalar_C is used for LINEAR in the GEMM
-
-      if (kernel_type_ != KERNEL::LINEAR) {
-        // kernel_type_ == POLY or SIGMOID
-        alpha = gamma_;
-        c = coef0_;
-      }
-
       onnxruntime::Gemm<T>::ComputeGemm(CBLAS_TRANSPOSE::CblasNoTrans, CBLAS_TRANSPOSE::CblasTrans,
                                         m, n, k,
-                                        alpha, a.data(), b.data(), beta,
+                                        alpha, a.data(), b.data(), 1.f,
                                         c != 0.f ? &c : nullptr, &shape_C,
                                         out.data(),
                                         threadpool);
+    }
 
-      if (kernel_type_ == KERNEL::POLY) {
-        auto map_out = EigenVectorArrayMap<T>(out.data(), out.size());
-        if (degree_ == 2)
-          map_out = map_out.square();
-        else if (degree_ == 3)
-          map_out = map_out.cube();
-        else
-          map_out = map_out.pow(degree_);
-
-      } else if (kernel_type_ == KERNEL::SIGMOID) {
-        MlasComputeTanh(out.data(), out.data(), out.size());
-      }
+    if (kernel_type_ == KERNEL::LINEAR) {
+      return;
     }
+
+    const TensorOpCost cost{static_cast<double>(n * sizeof(T)), static_cast<double>(n * sizeof(T)),
+                            static_cast<double>(n * 16)};
+    concurrency::ThreadPool::TryParallelFor(
+        threadpool, m, cost,
+        [this, out, n](ptrdiff_t first, ptrdiff_t last) {
+          for (ptrdiff_t i = first; i < last; ++i) {
+            T* row = out.data() + i * n;
+            if (kernel_type_ == KERNEL::POLY) {
+              auto map_row = EigenVectorArrayMap<T>(row, n);
+              if (degree_ == 2)
+                map_row = map_row.square();
+              else if (degree_ == 3)
+                map_row = map_row.cube();
+              else
+                map_row = map_row.pow(degree_);
+            } else if (kernel_type_ == KERNEL::SIGMOID) {
+              MlasComputeTanh(row, row, static_cast<size_t>(n));
+            }
+          }
+        });
   }
 
  private:
@@ -100,10 +149,13 @@ class SVMCommon {
   float gamma_{0.f};
   float coef0_{0.f};
   float degree_{0.f};
+  const float* kernel_vectors_{nullptr};
+  IAllocatorUniquePtr<void> packed_kernel_vectors_;
 };
 
 class SVMClassifier final : public OpKernel, private SVMCommon {
   using SVMCommon::batched_kernel_dot;
+  using SVMCommon::PrepackKernelVectors;
   using SVMCommon::get_kernel_type;
   using SVMCommon::set_kernel_type;
 
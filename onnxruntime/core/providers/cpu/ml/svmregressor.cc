@@ -36,6 +36,12 @@ SVMRegressor<T>::SVMRegressor(const OpKernelInfo& info)
     mode_ = SVM_TYPE::SVM_LINEAR;
     set_kernel_type(KERNEL::LINEAR);
   }
+
+  if (mode_ == SVM_TYPE::SVM_SVC) {
+    PrepackKernelVectors(info, support_vectors_, vector_count_, feature_count_);
+  } else {
+    PrepackKernelVectors(info, coefficients_, 1, feature_count_);
+  }
 }
 
 template <typename T>
@@ -15,6 +15,7 @@ namespace ml {
 template <typename T>
 class SVMRegressor final : public OpKernel, private SVMCommon {
   using SVMCommon::batched_kernel_dot;
+  using SVMCommon::PrepackKernelVectors;
   using SVMCommon::get_kernel_type;
   using SVMCommon::set_kernel_type;
 
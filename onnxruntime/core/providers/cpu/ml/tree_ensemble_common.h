@@ -4,6 +4,7 @@
 #pragma once
 
 #include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_compact.h"
 #include "core/platform/ort_mutex.h"
 #include "core/platform/threadpool.h"
 #include "tree_ensemble_helper.h"
@@ -47,6 +48,8 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   // `ThresholdType` is used as well for output type (double as well for lightgbm) and not `OutputType`.
   std::vector<SparseValue<ThresholdType>> weights_;
   std::vector<TreeNodeElement<ThresholdType>*> roots_;
+  // Built by Init when all nodes share the same comparison, empty otherwise.
+  TreeEnsembleCompact<ThresholdType> compact_;
 
  public:
   TreeEnsembleCommon() {}
@@ -83,6 +86,15 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   TreeNodeElement<ThresholdType>* ProcessTreeNodeLeave(TreeNodeElement<ThresholdType>* root,
                                                        const InputType* x_data) const;
 
+  // Calls fct(j, leaf) for every tree j in [begin, end) evaluated on one row, in tree order.
+  template <typename Fct>
+  void ProcessTreesOneRow(size_t begin, size_t end, const InputType* x_data, Fct&& fct) const;
+
+  // Calls fct(i, leaf) for every row i in [begin, end) evaluated by tree j, in row order.
+  template <typename Fct>
+  void ProcessOneTreeRows(size_t j, int64_t begin, int64_t end, const InputType* x_data, int64_t stride,
+                          Fct&& fct) const;
+
   template <typename AGG>
   void ComputeAgg(concurrency::ThreadPool* ttp, const Tensor* X, Tensor* Y, Tensor* label, const AGG& agg) const;
 };
@@ -361,6 +373,12 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(
       break;
     }
   }
+
+  // Evaluation walks the compact representation whenever the ensemble fits in it.
+  compact_.Clear();
+  if (same_mode_) {
+    compact_.Build(roots_, nodes_);
+  }
   return Status::OK();
 }
 
@@ -427,9 +445,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
     if (N == 1) {
       ScoreValue<ThresholdType> score = {0, 0};
       if (n_trees_ <= parallel_tree_ || max_num_threads == 1) { /* section A: 1 output, 1 row and not enough trees to parallelize */
-        for (int64_t j = 0; j < n_trees_; ++j) {
-          agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(roots_[onnxruntime::narrow<size_t>(j)], x_data));
-        }
+        ProcessTreesOneRow(0, roots_.size(), x_data,
+                           [&agg, &score](size_t, const TreeNodeElement<ThresholdType>& leaf) {
+                             agg.ProcessTreeNodePrediction1(score, leaf);
+                           });
       } else { /* section B: 1 output, 1 row and enough trees to parallelize */
         std::vector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_trees_), {0, 0});
         concurrency::ThreadPool::TryBatchParallelFor(
@@ -466,9 +485,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           scores[SafeInt<ptrdiff_t>(i - batch)] = {0, 0};
         }
         for (j = 0; j < static_cast<size_t>(n_trees_); ++j) {
-          for (i = batch; i < batch_end; ++i) {
-            agg.ProcessTreeNodePrediction1(scores[SafeInt<ptrdiff_t>(i - batch)], *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
-          }
+          ProcessOneTreeRows(j, batch, batch_end, x_data, stride,
+                             [&agg, &scores, batch](int64_t row, const TreeNodeElement<ThresholdType>& leaf) {
+                               agg.ProcessTreeNodePrediction1(scores[SafeInt<ptrdiff_t>(row - batch)], leaf);
+                             });
         }
         for (i = batch; i < batch_end; ++i) {
           agg.FinalizeScores1(z_data + i, scores[SafeInt<ptrdiff_t>(i - batch)],
@@ -490,10 +510,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
                 scores[batch_num * SafeInt<ptrdiff_t>(N) + i] = {0, 0};
               }
               for (auto j = work.start; j < work.end; ++j) {
-                for (int64_t i = begin_n; i < end_n; ++i) {
-                  agg.ProcessTreeNodePrediction1(scores[batch_num * SafeInt<ptrdiff_t>(N) + i],
-                                                 *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
-                }
+                ProcessOneTreeRows(j, begin_n, end_n, x_data, stride,
+                                   [&agg, &scores, batch_num, N](int64_t i, const TreeNodeElement<ThresholdType>& leaf) {
+                                     agg.ProcessTreeNodePrediction1(scores[batch_num * SafeInt<ptrdiff_t>(N) + i], leaf);
+                                   });
               }
             });
         begin_n = end_n;
@@ -517,9 +537,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           SafeInt<int32_t>(N),
           [this, &agg, x_data, z_data, stride, label_data](ptrdiff_t i) {
             ScoreValue<ThresholdType> score = {0, 0};
-            for (size_t j = 0; j < static_cast<size_t>(n_trees_); ++j) {
-              agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
-            }
+            ProcessTreesOneRow(0, roots_.size(), x_data + i * stride,
+                               [&agg, &score](size_t, const TreeNodeElement<ThresholdType>& leaf) {
+                                 agg.ProcessTreeNodePrediction1(score, leaf);
+                               });
 
             agg.FinalizeScores1(z_data + i, score,
                                 label_data == nullptr ? nullptr : (label_data + i));
@@ -530,9 +551,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
     if (N == 1) {                                               /* section A2: 2+ outputs, 1 row, not enough trees to parallelize */
       if (n_trees_ <= parallel_tree_ || max_num_threads == 1) { /* section A2 */
         InlinedVector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_targets_or_classes_), {0, 0});
-        for (int64_t j = 0; j < n_trees_; ++j) {
-          agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(roots_[onnxruntime::narrow<size_t>(j)], x_data), weights_);
-        }
+        ProcessTreesOneRow(0, roots_.size(), x_data,
+                           [this, &agg, &scores](size_t, const TreeNodeElement<ThresholdType>& leaf) {
+                             agg.ProcessTreeNodePrediction(scores, leaf, weights_);
+                           });
         agg.FinalizeScores(scores, z_data, -1, label_data);
       } else { /* section B2: 2+ outputs, 1 row, enough trees to parallelize */
         auto num_threads = std::min<int32_t>(max_num_threads, SafeInt<int32_t>(n_trees_));
@@ -543,9 +565,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
             [this, &agg, &scores, num_threads, x_data](ptrdiff_t batch_num) {
               scores[batch_num].resize(onnxruntime::narrow<size_t>(n_targets_or_classes_), {0, 0});
               auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, onnxruntime::narrow<size_t>(n_trees_));
-              for (auto j = work.start; j < work.end; ++j) {
-                agg.ProcessTreeNodePrediction(scores[batch_num], *ProcessTreeNodeLeave(roots_[j], x_data), weights_);
-              }
+              ProcessTreesOneRow(work.start, work.end, x_data,
+                                 [this, &agg, &scores, batch_num](size_t, const TreeNodeElement<ThresholdType>& leaf) {
+                                   agg.ProcessTreeNodePrediction(scores[batch_num], leaf, weights_);
+                                 });
             });
         for (size_t i = 1, limit = scores.size(); i < limit; ++i) {
           agg.MergePrediction(scores[0], scores[i]);
@@ -566,9 +589,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           std::fill(scores[SafeInt<ptrdiff_t>(i - batch)].begin(), scores[SafeInt<ptrdiff_t>(i - batch)].end(), ScoreValue<ThresholdType>({0, 0}));
         }
         for (j = 0, limit = roots_.size(); j < limit; ++j) {
-          for (i = batch; i < batch_end; ++i) {
-            agg.ProcessTreeNodePrediction(scores[SafeInt<ptrdiff_t>(i - batch)], *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
-          }
+          ProcessOneTreeRows(j, batch, batch_end, x_data, stride,
+                             [this, &agg, &scores, batch](int64_t row, const TreeNodeElement<ThresholdType>& leaf) {
+                               agg.ProcessTreeNodePrediction(scores[SafeInt<ptrdiff_t>(row - batch)], leaf, weights_);
+                             });
         }
         for (i = batch; i < batch_end; ++i) {
           agg.FinalizeScores(scores[SafeInt<ptrdiff_t>(i - batch)], z_data + i * n_targets_or_classes_, -1,
@@ -591,10 +615,10 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
                 scores[batch_num * SafeInt<ptrdiff_t>(N) + i].resize(onnxruntime::narrow<size_t>(n_targets_or_classes_), {0, 0});
               }
               for (auto j = work.start; j < work.end; ++j) {
-                for (int64_t i = begin_n; i < end_n; ++i) {
-                  agg.ProcessTreeNodePrediction(scores[batch_num * SafeInt<ptrdiff_t>(N) + i],
-                                                *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
-                }
+                ProcessOneTreeRows(j, begin_n, end_n, x_data, stride,
+                                   [this, &agg, &scores, batch_num, N](int64_t i, const TreeNodeElement<ThresholdType>& leaf) {
+                                     agg.ProcessTreeNodePrediction(scores[batch_num * SafeInt<ptrdiff_t>(N) + i], leaf, weights_);
+                                   });
               }
             });
         begin_n = end_n;
@@ -618,15 +642,15 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           ttp,
           num_threads,
           [this, &agg, num_threads, x_data, z_data, label_data, N, stride](ptrdiff_t batch_num) {
-            size_t j, limit;
             InlinedVector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_targets_or_classes_));
             auto work = concurrency::ThreadPool::PartitionWork(batch_num, onnxruntime::narrow<ptrdiff_t>(num_threads), onnxruntime::narrow<ptrdiff_t>(N));
 
             for (auto i = work.start; i < work.end; ++i) {
               std::fill(scores.begin(), scores.end(), ScoreValue<ThresholdType>({0, 0}));
-              for (j = 0, limit = roots_.size(); j < limit; ++j) {
-                agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
-              }
+              ProcessTreesOneRow(0, roots_.size(), x_data + i * stride,
+                                 [this, &agg, &scores](size_t, const TreeNodeElement<ThresholdType>& leaf) {
+                                   agg.ProcessTreeNodePrediction(scores, leaf, weights_);
+                                 });
 
               agg.FinalizeScores(scores,
                                  z_data + i * n_targets_or_classes_, -1,
@@ -745,6 +769,64 @@ TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreeNodeLeave(
   return root;
 }
 
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename Fct>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreesOneRow(
+    size_t begin, size_t end, const InputType* x_data, Fct&& fct) const {
+  if (compact_.empty()) {
+    for (size_t j = begin; j < end; ++j) {
+      fct(j, *ProcessTreeNodeLeave(roots_[j], x_data));
+    }
+    return;
+  }
+
+  // Several trees are walked together on the same row.
+  constexpr size_t lanes = TreeEnsembleCompact<ThresholdType>::kMaxLanes;
+  uint32_t nodes[lanes];
+  const InputType* rows[lanes];
+  const TreeNodeElement<ThresholdType>* leaves[lanes];
+  std::fill_n(rows, lanes, x_data);
+  for (size_t j = begin; j < end; j += lanes) {
+    size_t count = std::min(lanes, end - j);
+    for (size_t k = 0; k < count; ++k) {
+      nodes[k] = compact_.root(j + k);
+    }
+    compact_.FindLeaves(count, nodes, rows, has_missing_tracks_, leaves);
+    for (size_t k = 0; k < count; ++k) {
+      fct(j + k, *leaves[k]);
+    }
+  }
+}
+
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename Fct>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessOneTreeRows(
+    size_t j, int64_t begin, int64_t end, const InputType* x_data, int64_t stride, Fct&& fct) const {
+  if (compact_.empty()) {
+    for (int64_t i = begin; i < end; ++i) {
+      fct(i, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+    }
+    return;
+  }
+
+  // Several rows are walked together through the same tree.
+  constexpr int64_t lanes = static_cast<int64_t>(TreeEnsembleCompact<ThresholdType>::kMaxLanes);
+  uint32_t nodes[lanes];
+  const InputType* rows[lanes];
+  const TreeNodeElement<ThresholdType>* leaves[lanes];
+  std::fill_n(nodes, lanes, compact_.root(j));
+  for (int64_t i = begin; i < end; i += lanes) {
+    int64_t count = std::min(lanes, end - i);
+    for (int64_t k = 0; k < count; ++k) {
+      rows[k] = x_data + (i + k) * stride;
+    }
+    compact_.FindLeaves(static_cast<size_t>(count), nodes, rows, has_missing_tracks_, leaves);
+    for (int64_t k = 0; k < count; ++k) {
+      fct(i + k, *leaves[k]);
+    }
+  }
+}
+
 // TI: input type
 // TH: threshold type, double if T==double, float otherwise
 // TO: output type
@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "tree_ensemble_aggregator.h"
+
+namespace onnxruntime {
+namespace ml {
+namespace detail {
+
+// Compiled representation of a tree ensemble in which every node uses the same comparison.
+// TreeNodeElement interleaves the threshold, the feature, the children and the weights of a node
+// and a row walks a tree with one unpredictable branch per level. This representation stores the
+// nodes as a structure of arrays, every tree in breadth first order so that the first levels,
+// visited by every row, share a few cache lines. Children are 32-bit indices. The index of a leaf
+// has kLeafBit set, its children are itself and it refers to the original TreeNodeElement so that
+// the aggregators are unchanged. FindLeaves moves up to kMaxLanes (tree, row) pairs through their
+// trees together without any branch depending on the data: the traversal of every lane is a
+// sequence of dependent loads but the lanes are independent and the processor overlaps them.
+template <typename ThresholdType>
+class TreeEnsembleCompact {
+ public:
+  static constexpr uint32_t kLeafBit = 0x80000000u;
+  static constexpr uint32_t kMissingTrackTrueBit = 0x80000000u;
+  static constexpr size_t kMaxLanes = 8;
+
+  // Builds the representation from the tree roots. Returns false if the ensemble cannot be
+  // represented, the caller keeps using TreeNodeElement in that case.
+  bool Build(const std::vector<TreeNodeElement<ThresholdType>*>& roots,
+             const std::vector<TreeNodeElement<ThresholdType>>& nodes) {
+    Clear();
+    if (nodes.size() >= static_cast<size_t>(kLeafBit)) {
+      return false;
+    }
+
+    mode_ = NODE_MODE::LEAF;
+    constexpr uint32_t not_visited = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> compact_index(nodes.size(), not_visited);
+    std::vector<const TreeNodeElement<ThresholdType>*> queue;
+    const TreeNodeElement<ThresholdType>* base = nodes.data();
+
+    auto index_of = [&](const TreeNodeElement<ThresholdType>* node) -> uint32_t {
+      uint32_t& index = compact_index[static_cast<size_t>(node - base)];
+      if (index == not_visited) {
+        uint32_t slot = static_cast<uint32_t>(feature_ids_.size());
+        if (node->is_not_leaf()) {
+          index = slot;
+          uint32_t feature = static_cast<uint32_t>(node->feature_id);
+          if (node->is_missing_track_true()) {
+            feature |= kMissingTrackTrueBit;
+          }
+          feature_ids_.push_back(feature);
+          thresholds_.push_back(node->value_or_unique_weight);
+          children_.push_back(0);
+          children_.push_back(0);
+          leaves_.push_back(nullptr);
+          queue.push_back(node);
+        } else {
+          // A leaf is a node whose children are itself, lanes which reached a leaf stay there.
+          index = kLeafBit | slot;
+          feature_ids_.push_back(0);
+          thresholds_.push_back(0);
+          children_.push_back(index);
+          children_.push_back(index);
+          leaves_.push_back(node);
+        }
+      }
+      return index;
+    };
+
+    for (const TreeNodeElement<ThresholdType>* root : roots) {
+      if (root->is_not_leaf()) {
+        if (mode_ == NODE_MODE::LEAF) {
+          mode_ = root->mode();
+        } else if (root->mode() != mode_) {
+          Clear();
+          return false;
+        }
+      }
+
+      // Breadth first: the nodes of a tree are stored level by level.
+      queue.clear();
+      roots_.push_back(index_of(root));
+      for (size_t q = 0; q < queue.size(); ++q) {
+        const TreeNodeElement<ThresholdType>* node = queue[q];
+        uint32_t index = compact_index[static_cast<size_t>(node - base)];
+        if (node->is_not_leaf() && node->mode() != mode_) {
+          Clear();
+          return false;
+        }
+        children_[2 * index] = index_of(node + node->truenode_inc_or_first_weight);
+        children_[2 * index + 1] = index_of(node + node->falsenode_inc_or_n_weights);
+      }
+    }
+
+    // Double thresholds are stored in single precision when every one of them is exactly
+    // representable, this halves the threshold array and does not change any comparison.
+    if constexpr (std::is_same<ThresholdType, double>::value) {
+      bool exact = true;
+      for (double threshold : thresholds_) {
+        if (!(static_cast<double>(static_cast<float>(threshold)) == threshold)) {
+          exact = false;
+          break;
+        }
+      }
+      if (exact) {
+        narrow_thresholds_.assign(thresholds_.begin(), thresholds_.end());
+        thresholds_.clear();
+        thresholds_.shrink_to_fit();
+      }
+    }
+    return true;
+  }
+
+  void Clear() {
+    feature_ids_.clear();
+    thresholds_.clear();
+    narrow_thresholds_.clear();
+    children_.clear();
+    roots_.clear();
+    leaves_.clear();
+  }
+
+  bool empty() const { return roots_.empty(); }
+  uint32_t root(size_t tree) const { return roots_[tree]; }
+
+  // Finds the leaf reached by every lane. Lane k starts at node `nodes[k]` (a value returned by `root`)
+  // and evaluates the row `rows[k]`. `count` must not exceed kMaxLanes.
+  template <typename InputType>
+  void FindLeaves(size_t count, const uint32_t* nodes, const InputType* const* rows, bool has_missing_tracks,
+                  const TreeNodeElement<ThresholdType>** leaves) const {
+    if (has_missing_tracks) {
+      FindLeavesMode<InputType, true>(count, nodes, rows, leaves);
+    } else {
+      FindLeavesMode<InputType, false>(count, nodes, rows, leaves);
+    }
+  }
+
+ private:
+  template <typename InputType, bool HasMissingTracks>
+  void FindLeavesMode(size_t count, const uint32_t* nodes, const InputType* const* rows,
+                      const TreeNodeElement<ThresholdType>** leaves) const {
+    switch (mode_) {
+      case NODE_MODE::BRANCH_LEQ:
+        FindLeavesStorage<InputType, HasMissingTracks, std::less_equal<>>(count, nodes, rows, leaves);
+        break;
+      case NODE_MODE::BRANCH_LT:
+        FindLeavesStorage<InputType, HasMissingTracks, std::less<>>(count, nodes, rows, leaves);
+        break;
+      case NODE_MODE::BRANCH_GTE:
+        FindLeavesStorage<InputType, HasMissingTracks, std::greater_equal<>>(count, nodes, rows, leaves);
+        break;
+      case NODE_MODE::BRANCH_GT:
+        FindLeavesStorage<InputType, HasMissingTracks, std::greater<>>(count, nodes, rows, leaves);
+        break;
+      case NODE_MODE::BRANCH_EQ:
+        FindLeavesStorage<InputType, HasMissingTracks, std::equal_to<>>(count, nodes, rows, leaves);
+        break;
+      case NODE_MODE::BRANCH_NEQ:
+        FindLeavesStorage<InputType, HasMissingTracks, std::not_equal_to<>>(count, nodes, rows, leaves);
+        break;
+      case NODE_MODE::LEAF:
+        // Every tree is a single leaf.
+        FindLeavesStorage<InputType, HasMissingTracks, std::less_equal<>>(count, nodes, rows, leaves);
+        break;
+    }
+  }
+
+  template <typename InputType, bool HasMissingTracks, typename Compare>
+  void FindLeavesStorage(size_t count, const uint32_t* nodes, const InputType* const* rows,
+                         const TreeNodeElement<ThresholdType>** leaves) const {
+    if constexpr (std::is_same<ThresholdType, double>::value) {
+      if (!narrow_thresholds_.empty()) {
+        FindLeavesImpl<InputType, HasMissingTracks, Compare>(narrow_thresholds_.data(), count, nodes, rows, leaves);
+        return;
+      }
+    }
+    FindLeavesImpl<InputType, HasMissingTracks, Compare>(thresholds_.data(), count, nodes, rows, leaves);
+  }
+
+  template <typename InputType, bool HasMissingTracks, typename Compare, typename StoredThreshold>
+  void FindLeavesImpl(const StoredThreshold* thresholds, size_t count, const uint32_t* nodes,
+                      const InputType* const* rows, const TreeNodeElement<ThresholdType>** leaves) const {
+    const uint32_t* feature_ids = feature_ids_.data();
+    const uint32_t* children = children_.data();
+    Compare compare;
+
+    uint32_t lanes[kMaxLanes];
+    uint32_t pending = 0;
+    for (size_t k = 0; k < count; ++k) {
+      lanes[k] = nodes[k];
+      pending |= ~lanes[k];
+    }
+
+    // Every iteration moves all the lanes one level down until they all reached a leaf. The loop has
+    // no branch depending on the data: a lane on a leaf loops on it.
+    while (pending & kLeafBit) {
+      pending = 0;
+      for (size_t k = 0; k < count; ++k) {
+        uint32_t node = lanes[k] & ~kLeafBit;
+        uint32_t feature = feature_ids[node];
+        InputType val = rows[k][feature & ~kMissingTrackTrueBit];
+        bool is_true = compare(val, static_cast<ThresholdType>(thresholds[node]));
+        if constexpr (HasMissingTracks && std::is_floating_point<InputType>::value) {
+          is_true |= static_cast<bool>(feature & kMissingTrackTrueBit) & static_cast<bool>(std::isnan(val));
+        }
+        node = children[2 * node + !is_true];
+        lanes[k] = node;
+        pending |= ~node;
+      }
+    }
+
+    for (size_t k = 0; k < count; ++k) {
+      leaves[k] = leaves_[lanes[k] & ~kLeafBit];
+    }
+  }
+
+  NODE_MODE mode_ = NODE_MODE::LEAF;
+  // Decision nodes: feature index (kMissingTrackTrueBit set if a missing value follows the true branch),
+  // threshold, then the true and false children at 2 * node and 2 * node + 1.
+  std::vector<uint32_t> feature_ids_;
+  std::vector<ThresholdType> thresholds_;
+  std::vector<float> narrow_thresholds_;
+  std::vector<uint32_t> children_;
+  std::vector<uint32_t> roots_;
+  std::vector<const TreeNodeElement<ThresholdType>*> leaves_;
+};
+
+}  // namespace detail
+}  // namespace ml
+}  // namespace onnxruntime
@@ -21,6 +21,8 @@
 #include "core/common/safeint.h"
 #include "core/util/math_cpuonly.h"
 
+#include <algorithm>
+
 namespace onnxruntime {
 using ConvPadVector = ConvAttributes::ConvPadVector;
 
@@ -153,6 +155,49 @@ Status Conv<T>::Compute(OpKernelContext* context) const {
   return Status::OK();
 }
 
+Status Conv<float>::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                            /*out*/ bool& is_packed,
+                            /*out*/ PrePackedWeights* /*prepacked_weights*/) {
+  is_packed = false;
+
+  // Only 2D 3x3 filters with unit strides and dilations are candidates for the
+  // Winograd algorithm, and only if the session opted in because the results
+  // differ from im2col/GEMM. MLAS makes the final decision based on the input shape.
+  if (!winograd_enabled_ || input_idx != 1 || tensor.Shape().NumDimensions() != 4) {
+    return Status::OK();
+  }
+
+  const auto& filter_shape = tensor.Shape();
+  if (filter_shape[2] != 3 || filter_shape[3] != 3) {
+    return Status::OK();
+  }
+
+  auto is_unit = [](const TensorShapeVector& values) {
+    return std::all_of(values.begin(), values.end(), [](int64_t v) { return v == 1; });
+  };
+  if (!is_unit(conv_attrs_.strides) || !is_unit(conv_attrs_.dilations)) {
+    return Status::OK();
+  }
+
+  const size_t group_count = narrow<size_t>(conv_attrs_.group);
+  const size_t filter_count = narrow<size_t>(filter_shape[0]) / group_count;
+  const size_t input_channels = narrow<size_t>(filter_shape[1]);
+
+  const size_t packed_filter_size = MlasConvWinogradPackFilterSize(group_count, input_channels, filter_count);
+  if (packed_filter_size == 0) {
+    return Status::OK();
+  }
+
+  auto* packed_filter_data = alloc->Alloc(packed_filter_size);
+  winograd_filter_ = BufferUniquePtr(packed_filter_data, BufferDeleter(std::move(alloc)));
+
+  MlasConvWinogradPackFilter(group_count, input_channels, filter_count, tensor.Data<float>(), packed_filter_data);
+
+  // The original filter is kept (is_packed stays false) so the transformed
+  // filter is not shared between sessions.
+  return Status::OK();
+}
+
 Status Conv<float>::Compute(OpKernelContext* context) const {
   size_t num_inputs = OpKernel::Node().InputDefs().size();
   const Tensor* X = context->Input<Tensor>(0);
@@ -231,7 +276,8 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
                     &activation_,
                     &WorkingBufferSize,
                     Beta,
-                    thread_pool);
+                    thread_pool,
+                    winograd_filter_.get());
 
     auto* working_data = WorkingBufferSize > 0 ? alloc->Alloc(sizeof(float) * SafeInt<size_t>(WorkingBufferSize))
                                                : nullptr;
@@ -3,9 +3,11 @@
 
 #pragma once
 
+#include "core/framework/config_options.h"
 #include "core/framework/op_kernel.h"
 #include "core/providers/cpu/nn/conv_attributes.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 
 namespace onnxruntime {
 
@@ -26,14 +28,27 @@ class Conv<float> : public OpKernel {
  public:
   Conv(const OpKernelInfo& info) : OpKernel(info), conv_attrs_(info) {
     activation_.ActivationKind = MlasIdentityActivation;
+    winograd_enabled_ =
+        info.GetConfigOptions().GetConfigOrDefault(kOrtSessionOptionsMlasConvWinograd, "0") == "1";
   }
 
   Status Compute(OpKernelContext* context) const override;
 
+  Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                 /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
  protected:
   MLAS_ACTIVATION activation_;
 
   ConvAttributes conv_attrs_;
+
+ private:
+  // Filter transformed for the Winograd algorithm. The original filter is still
+  // required for input shapes that MLAS does not run with the Winograd algorithm.
+  BufferUniquePtr winograd_filter_;
+  // The session opted in to the Winograd algorithm, see kOrtSessionOptionsMlasConvWinograd.
+  bool winograd_enabled_;
 };
 
 }  // namespace onnxruntime
@@ -22,6 +22,8 @@
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 
+#include <algorithm>
+
 namespace onnxruntime {
 
 ONNX_CPU_OPERATOR_VERSIONED_KERNEL(
@@ -36,6 +38,43 @@ ONNX_CPU_OPERATOR_KERNEL(
     KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
     ConvTranspose<float>);
 
+// The MLAS transposed convolution handles one and two dimensional kernels. A one
+// dimensional kernel is run as a two dimensional kernel with a height of one.
+static bool IsMlasConvTransposeSupported(size_t filter_rank) {
+  return filter_rank == 3 || filter_rank == 4;
+}
+
+static void GetMlasConvTransposeShapes(const TensorShape& filter_shape, const ConvTransposeAttributes& attrs,
+                                       int64_t kernel_shape[2], int64_t dilations[2], int64_t strides[2]) {
+  const size_t spatial_rank = filter_shape.NumDimensions() - 2;
+  const size_t offset = 2 - spatial_rank;
+
+  for (size_t i = 0; i < 2; ++i) {
+    kernel_shape[i] = 1;
+    dilations[i] = 1;
+    strides[i] = 1;
+  }
+  for (size_t i = 0; i < spatial_rank; ++i) {
+    kernel_shape[offset + i] = filter_shape[2 + i];
+    if (!attrs.dilations.empty()) {
+      dilations[offset + i] = attrs.dilations[i];
+    }
+    if (!attrs.strides.empty()) {
+      strides[offset + i] = attrs.strides[i];
+    }
+  }
+}
+
+static bool HasNegativePads(const ConvAttributes::ConvPadVector& pads) {
+  return std::any_of(pads.begin(), pads.end(), [](int64_t v) { return v < 0; });
+}
+
+template <typename T>
+bool ConvTranspose<T>::UseMlasPackedFilter(size_t filter_rank) const {
+  return IsMlasConvTransposeSupported(filter_rank) && !dynamic_padding_ &&
+         !HasNegativePads(conv_transpose_attrs_.pads);
+}
+
 template <typename T>
 Status ConvTranspose<T>::PrePack(const Tensor& /*tensor*/, int /*input_idx*/, AllocatorPtr /*alloc*/,
                                  /*out*/ bool& is_packed,
@@ -58,6 +97,37 @@ Status ConvTranspose<float>::PrePack(const Tensor& tensor, int input_idx, Alloca
     }
     filter_shape_ = tensor.Shape();
 
+    if (UseMlasPackedFilter(filter_shape_.NumDimensions())) {
+      // Pack the filter per stride phase for the MLAS transposed convolution.
+      int64_t kernel_shape[2], dilations[2], strides[2];
+      GetMlasConvTransposeShapes(filter_shape_, conv_transpose_attrs_, kernel_shape, dilations, strides);
+
+      const size_t group_count = onnxruntime::narrow<size_t>(conv_transpose_attrs_.group);
+      const size_t input_channels = onnxruntime::narrow<size_t>(filter_shape_[0]) / group_count;
+      const size_t filter_count = onnxruntime::narrow<size_t>(filter_shape_[1]);
+
+      size_t packed_filter_data_size =
+          MlasConvTransposePackFilterSize(group_count, input_channels, filter_count, kernel_shape);
+      if (packed_filter_data_size == 0) {
+        return Status::OK();
+      }
+
+      auto* packed_filter_data = alloc->Alloc(packed_filter_data_size);
+      transposed_filter_ = BufferUniquePtr(packed_filter_data, BufferDeleter(std::move(alloc)));
+
+      MlasConvTransposePackFilter(group_count, input_channels, filter_count, kernel_shape, dilations, strides,
+                                  tensor.Data<float>(), static_cast<float*>(packed_filter_data));
+
+      bool share_prepacked_weights = (prepacked_weights != nullptr);
+      if (share_prepacked_weights) {
+        prepacked_weights->buffers_.push_back(std::move(transposed_filter_));
+        prepacked_weights->buffer_sizes_.push_back(packed_filter_data_size);
+      }
+
+      is_packed = true;
+      return Status::OK();
+    }
+
     const size_t K = static_cast<size_t>(filter_shape_[0]) / onnxruntime::narrow<size_t>(conv_transpose_attrs_.group);
     const size_t N = onnxruntime::narrow<size_t>(filter_shape_.SizeFromDimension(1));
     auto packed_elements_per_group = N * K;
@@ -218,6 +288,78 @@ Status ConvTranspose<T>::DoConvTranspose(OpKernelContext* context, bool dynamic_
   return Status::OK();
 }
 
+template <>
+Status ConvTranspose<float>::DoMlasConvTranspose(OpKernelContext* context,
+                                                 const ConvTransposeAttributes::Prepare& p) const {
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
+
+  const size_t spatial_rank = p.kernel_shape.size();
+  const size_t offset = 2 - spatial_rank;
+
+  int64_t input_shape[2] = {1, 1};
+  int64_t output_shape[2] = {1, 1};
+  int64_t pads[4] = {0, 0, 0, 0};
+  for (size_t i = 0; i < spatial_rank; ++i) {
+    input_shape[offset + i] = p.input_shape[i];
+    output_shape[offset + i] = p.Y->Shape()[2 + i];
+    pads[offset + i] = p.pads[i];
+    pads[2 + offset + i] = p.pads[spatial_rank + i];
+  }
+
+  int64_t kernel_shape[2], dilations[2], strides[2];
+  GetMlasConvTransposeShapes(p.F ? p.F->Shape() : filter_shape_, conv_transpose_attrs_,
+                             kernel_shape, dilations, strides);
+
+  const size_t group_count = onnxruntime::narrow<size_t>(conv_transpose_attrs_.group);
+  const size_t input_channels = onnxruntime::narrow<size_t>(p.num_input_channels) / group_count;
+  const size_t filter_count = onnxruntime::narrow<size_t>(p.num_output_channels) / group_count;
+
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+
+  // Pack the filter here if it was not prepacked, e.g. if it is not a constant initializer.
+  BufferUniquePtr packed_filter_buffer;
+  const float* packed_filter = static_cast<const float*>(transposed_filter_.get());
+  if (p.F != nullptr) {
+    size_t packed_filter_size =
+        MlasConvTransposePackFilterSize(group_count, input_channels, filter_count, kernel_shape);
+    auto* packed_filter_data = alloc->Alloc(packed_filter_size);
+    packed_filter_buffer = BufferUniquePtr(packed_filter_data, BufferDeleter(alloc));
+    MlasConvTransposePackFilter(group_count, input_channels, filter_count, kernel_shape, dilations, strides,
+                                p.F->Data<float>(), static_cast<float*>(packed_filter_data));
+    packed_filter = static_cast<const float*>(packed_filter_data);
+  }
+
+  MLAS_CONV_TRANSPOSE_PARAMETERS parameters;
+  size_t working_buffer_size;
+  MlasConvTransposePrepare(&parameters,
+                           onnxruntime::narrow<size_t>(p.N),
+                           group_count,
+                           input_channels,
+                           input_shape,
+                           kernel_shape,
+                           dilations,
+                           pads,
+                           strides,
+                           output_shape,
+                           filter_count,
+                           &working_buffer_size,
+                           thread_pool);
+
+  auto* working_data = alloc->Alloc(SafeInt<size_t>(sizeof(float)) * working_buffer_size);
+  BufferUniquePtr working_buffer(working_data, BufferDeleter(std::move(alloc)));
+
+  MlasConvTranspose(&parameters,
+                    p.X->Data<float>(),
+                    packed_filter,
+                    p.B != nullptr ? p.B->Data<float>() : nullptr,
+                    static_cast<float*>(working_buffer.get()),
+                    p.Y->MutableData<float>(),
+                    thread_pool);
+
+  return Status::OK();
+}
+
 template <>
 Status ConvTranspose<float>::DoConvTranspose(OpKernelContext* context, bool dynamic_padding) const {
   concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
@@ -233,6 +375,14 @@ Status ConvTranspose<float>::DoConvTranspose(OpKernelContext* context, bool dyna
     return Status::OK();
   }
 
+  // Negative pads, either explicit or dynamic, run the GEMM + Col2im path. A prepacked
+  // filter is only in the MLAS layout if the pads cannot be negative.
+  const size_t filter_rank = p.X->Shape().NumDimensions();
+  if (IsMlasConvTransposeSupported(filter_rank) && !HasNegativePads(p.pads) &&
+      (p.F != nullptr || UseMlasPackedFilter(filter_rank))) {
+    return DoMlasConvTranspose(context, p);
+  }
+
   const int64_t input_image_size = p.input_shape.Size();
   const int64_t X_offset = p.num_input_channels / conv_transpose_attrs_.group * input_image_size;
   const int64_t Y_offset = p.Y->Shape().Size() / p.Y->Shape()[0] / conv_transpose_attrs_.group;
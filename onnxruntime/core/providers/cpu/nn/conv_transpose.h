@@ -25,7 +25,7 @@ namespace onnxruntime {
 template <typename T>
 class ConvTranspose : public OpKernel {
  public:
-  ConvTranspose(const OpKernelInfo& info) : OpKernel(info), conv_transpose_attrs_(info) {}
+  ConvTranspose(const OpKernelInfo& info) : ConvTranspose(info, false) {}
 
   Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
                  /*out*/ bool& is_packed,
@@ -38,12 +38,27 @@ class ConvTranspose : public OpKernel {
   Status Compute(OpKernelContext* context) const override;
 
  protected:
+  ConvTranspose(const OpKernelInfo& info, bool dynamic_padding)
+      : OpKernel(info), conv_transpose_attrs_(info), dynamic_padding_(dynamic_padding) {}
+
   Status DoConvTranspose(OpKernelContext* context, bool dynamic_padding) const;
 
+  // Runs the MLAS transposed convolution for one and two dimensional kernels.
+  Status DoMlasConvTranspose(OpKernelContext* context, const ConvTransposeAttributes::Prepare& p) const;
+
+  // Returns true if a filter of this rank is prepacked for the MLAS transposed convolution.
+  // The MLAS transposed convolution does not take negative pads, so a filter that may run
+  // with negative pads is prepacked for the GEMM + Col2im path instead.
+  bool UseMlasPackedFilter(size_t filter_rank) const;
+
  private:
   ConvTransposeAttributes conv_transpose_attrs_;
 
-  // for pre-packing usage
+  // The pads are an input of the kernel instead of an attribute.
+  bool dynamic_padding_;
+
+  // for pre-packing usage. One and two dimensional filters are packed for the
+  // MLAS transposed convolution, other filters are transposed per group.
   TensorShape filter_shape_;
   BufferUniquePtr transposed_filter_;
 };
@@ -5,6 +5,7 @@
 
 #include "core/common/safeint.h"
 #include "core/framework/tensor.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/platform/threadpool.h"
 #include "core/providers/common.h"
 #include "core/util/math_cpuonly.h"
@@ -80,38 +81,55 @@ Status ComputeImpl(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, boo
         const T* p_input = X_data + task_idx * norm_size;
         T* p_output = Y_data + task_idx * norm_size;
 
-        T mean = 0;
-        T mean_square = 0;
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, MLFloat16>) {
+          float mean = 0.0f;
+          float inv_std_dev = 0.0f;
+          MlasLayerNormalization<T>(p_input, nullptr, nullptr, scale_data, bias_data, p_output, nullptr,
+                                    onnxruntime::narrow<size_t>(norm_size), epsilon, simplified,
+                                    &mean, &inv_std_dev);
 
-        for (int64_t h = 0; h < norm_size; h++) {
-          mean += p_input[h];
-          mean_square += p_input[h] * p_input[h];
-        }
+          if (mean_data != nullptr) {
+            mean_data[task_idx] = gsl::narrow_cast<U>(mean);
+          }
+
+          if (inv_std_dev_data != nullptr) {
+            inv_std_dev_data[task_idx] = gsl::narrow_cast<U>(inv_std_dev);
+          }
 
-        mean = mean / norm_size;
-        if (simplified) {
-          mean_square = sqrt(mean_square / norm_size + epsilon);
         } else {
-          mean_square = sqrt(mean_square / norm_size - mean * mean + epsilon);
-        }
+          T mean = 0;
+          T mean_square = 0;
+
+          for (int64_t h = 0; h < norm_size; h++) {
+            mean += p_input[h];
+            mean_square += p_input[h] * p_input[h];
+          }
 
-        for (int64_t h = 0; h < norm_size; h++) {
+          mean = mean / norm_size;
           if (simplified) {
-            p_output[h] = p_input[h] / mean_square * scale_data[h];
-          } else if (nullptr == bias) {
-            p_output[h] = (p_input[h] - mean) / mean_square * scale_data[h];
+            mean_square = sqrt(mean_square / norm_size + epsilon);
           } else {
-            p_output[h] = (p_input[h] - mean) / mean_square * scale_data[h] + bias_data[h];
+            mean_square = sqrt(mean_square / norm_size - mean * mean + epsilon);
           }
-        }
 
-        if (mean_data != nullptr) {
-          // ONNX spec doesn't support 'double' for 'U' so when 'T' == double, 'U' == float and we need to narrow
-          mean_data[task_idx] = gsl::narrow_cast<U>(mean);
-        }
+          for (int64_t h = 0; h < norm_size; h++) {
+            if (simplified) {
+              p_output[h] = p_input[h] / mean_square * scale_data[h];
+            } else if (nullptr == bias) {
+              p_output[h] = (p_input[h] - mean) / mean_square * scale_data[h];
+            } else {
+              p_output[h] = (p_input[h] - mean) / mean_square * scale_data[h] + bias_data[h];
+            }
+          }
 
-        if (inv_std_dev_data != nullptr) {
-          inv_std_dev_data[task_idx] = gsl::narrow_cast<U>(1 / mean_square);
+          if (mean_data != nullptr) {
+            // ONNX spec doesn't support 'double' for 'U' so when 'T' == double, 'U' == float and we need to narrow
+            mean_data[task_idx] = gsl::narrow_cast<U>(mean);
+          }
+
+          if (inv_std_dev_data != nullptr) {
+            inv_std_dev_data[task_idx] = gsl::narrow_cast<U>(1 / mean_square);
+          }
         }
       },
       0);
@@ -122,11 +140,13 @@ Status ComputeImpl(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, boo
 template <typename T>
 struct SrcDispatcher {
   Status operator()(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, bool simplified, bool contrib_op) const {
-    // the contrib op kernel was always registered with the same type for all constraints.
+    // the contrib op kernel was always registered with the same type for all constraints, except for float16
+    // which the contrib op schema only allows with 'float' as the U constraint.
     // our implementation of the onnx op only supports 'float' as the U constraint.
 #if !defined(DISABLE_CONTRIB_OPS)
     if (contrib_op) {
-      return ComputeImpl<T, T>(p_ctx, orig_axis, epsilon, simplified);
+      using ContribU = std::conditional_t<std::is_same_v<T, MLFloat16>, float, T>;
+      return ComputeImpl<T, ContribU>(p_ctx, orig_axis, epsilon, simplified);
     } else
 #else
     ORT_UNUSED_PARAMETER(contrib_op);
@@ -141,7 +161,7 @@ struct SrcDispatcher {
 Status LayerNormImpl::Compute(OpKernelContext* p_ctx) const {
   const auto elem_type = p_ctx->Input<Tensor>(0)->GetElementType();
 
-  using SupportedTypeList = boost::mp11::mp_list<float, double>;
+  using SupportedTypeList = boost::mp11::mp_list<float, double, MLFloat16>;
 
   utils::MLTypeCallDispatcherFromTypeList<SupportedTypeList> t_disp(elem_type);
   return t_disp.InvokeRet<Status, SrcDispatcher>(p_ctx, axis_, epsilon_, simplified_, contrib_op_);
@@ -0,0 +1,216 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+
+#include "core/common/narrow.h"
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "core/providers/cpu/nn/pool_attributes.h"
+#include "core/util/math.h"
+
+namespace onnxruntime {
+
+/**
+ * @brief Pooling operator computed in channels last (NHWC) format.
+ * Only max pool and average pool supported.
+ *
+ * The input is gathered into an indirection buffer by an NHWC im2col and
+ * reduced by the MLAS NHWC pooling routines of the element type. NCHW inputs
+ * are transposed to channels last and back.
+ *
+ * If the kernel is registered in the internal NHWC domain, the input layout is
+ * assumed to be NHWC, otherwise it is assumed to be NCHW.
+ */
+template <typename T>
+class NhwcPool final : public OpKernel {
+ public:
+  explicit NhwcPool(const OpKernelInfo& info)
+      : OpKernel(info),
+        pool_attrs_(info, info.GetKernelDef().OpName(), info.node().SinceVersion()),
+        is_max_pool_(info.GetKernelDef().OpName() == "MaxPool"),
+        channels_last_(info.GetKernelDef().Domain() == kMSInternalNHWCDomain) {}
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  PoolAttributes pool_attrs_;
+  bool is_max_pool_;  // either max pool or average pool
+  bool channels_last_;
+};
+
+template <typename T>
+Status NhwcPool<T>::Compute(OpKernelContext* context) const {
+  const auto* X = context->Input<Tensor>(0);
+  const TensorShape& input_shape = X->Shape();
+
+  const size_t input_rank = input_shape.NumDimensions();
+  ORT_RETURN_IF_NOT(input_rank >= 3, "Input dimension cannot be less than 3.");
+
+  const int64_t N = input_shape[0];
+  const int64_t C = channels_last_ ? input_shape[input_rank - 1] : input_shape[1];
+
+  ORT_ENFORCE(input_shape.Size() > 0 || N == 0, "Invalid input shape. Only N can be zero. Got:", input_shape);
+
+  const size_t spatial_dims = input_rank - 2;
+  const size_t spatial_dim_start = channels_last_ ? 1 : 2;
+
+  // Compute the output size and effective padding for this pooling operation.
+  TensorShapeVector output_dims({N});
+  if (!channels_last_) {
+    output_dims.push_back(C);
+  }
+  TensorShapeVector pads = pool_attrs_.pads;
+  TensorShapeVector kernel_shape = pool_attrs_.kernel_shape;
+  TensorShapeVector strides = pool_attrs_.strides;
+  TensorShapeVector dilations = pool_attrs_.dilations;
+  if (pool_attrs_.global_pooling) {
+    const auto& input_dims = input_shape.GetDims();
+    if (channels_last_) {
+      kernel_shape.assign(input_dims.begin() + 1, input_dims.end() - 1);
+    } else {
+      kernel_shape.assign(input_dims.begin() + 2, input_dims.end());
+    }
+    pads.resize(kernel_shape.size() * 2, 0);
+    strides.resize(kernel_shape.size(), 1);
+    dilations.resize(kernel_shape.size(), 1);
+  }
+  ORT_RETURN_IF_NOT(kernel_shape.size() == spatial_dims,
+                    "Invalid kernel shape. Input shape ", (channels_last_ ? "(NHWC): " : "(NCHW): "), input_shape,
+                    " Kernel rank: ", kernel_shape.size());
+
+  int64_t kernel_size = 1;
+  int64_t input_image_size = 1;
+  int64_t output_image_size = 1;
+  for (size_t dim = 0; dim < spatial_dims; ++dim) {
+    int64_t kernel = kernel_shape[dim];
+    int64_t input_dim = input_shape[dim + spatial_dim_start];
+
+    kernel_size *= kernel;
+    input_image_size *= input_dim;
+
+    int64_t output_dim = 0;
+    pool_attrs_.ComputeSizePadDilations(input_dim,
+                                        strides[dim],
+                                        kernel,
+                                        &pads.at(dim),
+                                        &pads.at(spatial_dims + dim),
+                                        dilations[dim],
+                                        &output_dim);
+    output_dims.push_back(output_dim);
+
+    output_image_size *= output_dim;
+  }
+  if (channels_last_) {
+    output_dims.push_back(C);
+  }
+
+  const bool need_padding = !is_max_pool_ && pool_attrs_.count_include_pad;
+  std::vector<T> padding_data;
+  if (need_padding) {
+    padding_data.resize(static_cast<size_t>(C), T());
+  }
+
+  const auto* Xdata = X->Data<T>();
+  auto* Y = context->Output(0, output_dims);
+  auto* Ydata = Y->MutableData<T>();
+
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  // Allocate temporary buffers for transposing to channels last format.
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+  BufferUniquePtr transpose_input_buffer;
+  BufferUniquePtr transpose_output_buffer;
+  if (!channels_last_) {
+    auto* transpose_input = alloc->Alloc(SafeInt<size_t>(sizeof(T)) * C * input_image_size + MLAS_SYMM_QGEMM_BUF_OVERRUN);
+    transpose_input_buffer = BufferUniquePtr(transpose_input, BufferDeleter(alloc));
+    auto* transpose_output = alloc->Alloc(SafeInt<size_t>(sizeof(T)) * C * output_image_size);
+    transpose_output_buffer = BufferUniquePtr(transpose_output, BufferDeleter(alloc));
+  }
+
+  // Allocate indirection buffer pointers and prepare a padding vector for the
+  // im2col transform.
+  auto* col_data = alloc->Alloc(SafeInt<size_t>(sizeof(const T*)) * kernel_size * output_image_size);
+  BufferUniquePtr col_buffer(col_data, BufferDeleter(std::move(alloc)));
+
+  const int64_t output_stride = std::max((int64_t)2, (int64_t)8192 / (kernel_size * C));
+  const int64_t task_count = (output_image_size + output_stride - 1) / output_stride;
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
+
+  for (int64_t image_id = 0; image_id < N; ++image_id) {
+    const auto* input_data = Xdata;
+    auto* output_data = Ydata;
+
+    if (!channels_last_) {
+      // Transpose the input from channels first (CHW) to channels last (HWC).
+      MlasTranspose(
+          Xdata,
+          static_cast<T*>(transpose_input_buffer.get()),
+          static_cast<size_t>(C),
+          static_cast<size_t>(input_image_size));
+      input_data = static_cast<T*>(transpose_input_buffer.get());
+      output_data = static_cast<T*>(transpose_output_buffer.get());
+    }
+
+    auto worker = [&](ptrdiff_t batch) {
+      int64_t output_start = (int64_t)batch * output_stride;
+      int64_t output_count = std::min(output_stride, output_image_size - output_start);
+      auto* outputptr = output_data + output_start * C;
+      auto indirection_buffer = static_cast<T const**>(col_buffer.get()) + output_start * kernel_size;
+
+      math::Im2col<T, StorageOrder::NHWC>()(
+          input_data,
+          C,
+          input_shape.GetDims().data() + spatial_dim_start,
+          output_dims.data() + spatial_dim_start,
+          kernel_shape.data(),
+          strides.data(),
+          dilations.data(),
+          pads.data(),
+          static_cast<ptrdiff_t>(spatial_dims),
+          output_start,
+          output_count,
+          indirection_buffer,
+          need_padding ? padding_data.data() : nullptr);
+
+      if (is_max_pool_) {
+        MlasNhwcMaxPool(
+            indirection_buffer,
+            outputptr,
+            static_cast<size_t>(C),
+            static_cast<size_t>(output_count),
+            static_cast<size_t>(kernel_size));
+      } else {
+        MlasNhwcAvgPool(
+            indirection_buffer,
+            outputptr,
+            static_cast<size_t>(C),
+            static_cast<size_t>(output_count),
+            static_cast<size_t>(kernel_size));
+      }
+    };
+    concurrency::ThreadPool::TrySimpleParallelFor(thread_pool, onnxruntime::narrow<ptrdiff_t>(task_count), worker);
+
+    if (!channels_last_) {
+      // Transpose the output from channels last (NHWC) to channels first (NCHW).
+      MlasTranspose(
+          output_data,
+          Ydata,
+          static_cast<size_t>(output_image_size),
+          static_cast<size_t>(C));
+    }
+    Xdata += input_image_size * C;
+    Ydata += output_image_size * C;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
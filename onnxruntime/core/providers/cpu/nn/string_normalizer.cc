@@ -3,6 +3,7 @@
 
 #include "string_normalizer.h"
 #include "core/common/common.h"
+#include "core/common/utf8_util.h"
 #include "core/framework/tensor.h"
 #include "onnxruntime_config.h"
 
@@ -17,8 +18,11 @@
 
 #endif  // _MSC_VER
 
+#include <algorithm>
+#include <limits>
 #include <locale>
 #include <functional>
+#include <optional>
 #include <unordered_set>
 
 #if defined(__GNUC__)
@@ -205,55 +209,48 @@ const std::string default_locale("en_US.UTF-8");  // All non-MS
 
 #endif  // _MSC_VER
 
-template <class ForwardIter>
-Status CopyCaseAction(ForwardIter first, ForwardIter end, OpKernelContext* ctx,
-                      const Locale& loc,
-                      Utf8Converter& converter,
-                      size_t N, size_t C,
-                      StringNormalizer::CaseAction caseaction) {
-  std::vector<int64_t> output_dims;
-  if (N == 1) {
-    output_dims.push_back(1);
-  }
+inline bool IsAscii(const std::string& s) {
+  return utf8_util::utf8_is_ascii(reinterpret_cast<const unsigned char*>(s.data()), s.size());
+}
 
-  // Empty output case
-  if (C == 0) {
-    output_dims.push_back(1);
-    TensorShape output_shape(output_dims);
-    // This will create one empty string
-    ctx->Output(0, output_shape);
-    return Status::OK();
+// Changes the case of an ASCII string in place.
+void ChangeCaseAscii(StringNormalizer::CaseAction caseaction, std::string& str) {
+  assert(caseaction != StringNormalizer::NONE);
+  if (caseaction == StringNormalizer::LOWER) {
+    for (char& ch : str) {
+      if (ch >= 'A' && ch <= 'Z') {
+        ch = static_cast<char>(ch - 'A' + 'a');
+      }
+    }
+  } else {
+    for (char& ch : str) {
+      if (ch >= 'a' && ch <= 'z') {
+        ch = static_cast<char>(ch - 'a' + 'A');
+      }
+    }
   }
+}
 
-  output_dims.push_back(C);
-
-  TensorShape output_shape(output_dims);
-  auto output_tensor = ctx->Output(0, output_shape);
-  auto const output_data = output_tensor->MutableData<std::string>();
-
-  size_t output_idx = 0;
-  while (first != end) {
-    auto& s = *first;
-    if (caseaction == StringNormalizer::LOWER || caseaction == StringNormalizer::UPPER) {
-      std::wstring wstr = converter.from_bytes(s);
-      if (wstr == wconv_error) {
-        // Please do not include the input text in the error message as it could
-        // be deemed as a compliance violation by teams using this operator
-        return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                      "Input contains invalid utf8 chars");
-      }
-      // In place transform
-      loc.ChangeCase(caseaction, wstr);
-      *(output_data + output_idx) = converter.to_bytes(wstr);
-    } else {
-      assert(caseaction == StringNormalizer::NONE);
-      // Simple copy or move if the iterator points to a non-const string
-      *(output_data + output_idx) = std::move(s);
+// Returns true if the locale changes the case of the ASCII characters like ChangeCaseAscii.
+// This is not the case of the Turkish locales for example, where 'i' is the lower case of a dotted 'I'.
+bool LocaleChangesAsciiCase(const Locale& locale) {
+  std::string ascii(128, '\0');
+  std::wstring wascii(128, L'\0');
+  for (size_t ch = 0; ch < ascii.size(); ++ch) {
+    ascii[ch] = static_cast<char>(ch);
+    wascii[ch] = static_cast<wchar_t>(ch);
+  }
+  for (auto caseaction : {StringNormalizer::LOWER, StringNormalizer::UPPER}) {
+    std::string expected(ascii);
+    ChangeCaseAscii(caseaction, expected);
+    std::wstring changed(wascii);
+    locale.ChangeCase(caseaction, changed);
+    if (!std::equal(changed.begin(), changed.end(), expected.begin(), expected.end(),
+                    [](wchar_t wch, char ch) { return wch == static_cast<wchar_t>(ch); })) {
+      return false;
     }
-    ++output_idx;
-    ++first;
   }
-  return Status::OK();
+  return true;
 }
 }  // namespace string_normalizer
 
@@ -290,6 +287,8 @@ StringNormalizer::StringNormalizer(const OpKernelInfo& info) : OpKernel(info),
   Locale locale(locale_name_);
   Utf8Converter converter(conv_error, wconv_error);
 
+  ascii_case_change_ = LocaleChangesAsciiCase(locale);
+
   std::vector<std::string> swords = info.GetAttrsOrDefault<std::string>("stopwords");
   for (auto& sw : swords) {
     ORT_ENFORCE(!sw.empty(), "Empty stopwords not allowed");
@@ -300,6 +299,7 @@ StringNormalizer::StringNormalizer(const OpKernelInfo& info) : OpKernel(info),
       std::wstring wstr = converter.from_bytes(sw);
       ORT_ENFORCE(wstr != wconv_error, "Stopword contains invalid utf8 chars");
       locale.ChangeCase(compare_caseaction_, wstr);
+      stopwords_.insert(converter.to_bytes(wstr));
       auto p = wstopwords_.insert(std::move(wstr));
       ORT_ENFORCE(p.second, "Duplicate stopwords not allowed");
     }
@@ -333,72 +333,106 @@ Status StringNormalizer::Compute(OpKernelContext* ctx) const {
                   "Input dimensions are either[C > 0] or [1][C > 0] allowed");
   }
 
-  Status status;
-  Locale locale(locale_name_);
-  Utf8Converter converter(conv_error, wconv_error);
+  // The locale and the converter are only created for strings which are not ASCII.
+  std::optional<Locale> locale;
+  std::optional<Utf8Converter> converter;
+  std::wstring wstr;
+  auto to_wide = [&](const std::string& str, CaseAction caseaction) {
+    if (!locale) {
+      locale.emplace(locale_name_);
+      converter.emplace(conv_error, wconv_error);
+    }
+    wstr = converter->from_bytes(str);
+    if (wstr == wconv_error) {
+      return false;
+    }
+    if (caseaction != NONE) {
+      locale->ChangeCase(caseaction, wstr);
+    }
+    return true;
+  };
+
+  // Please do not include the input text in the error message as it could
+  // be deemed as a compliance violation by teams using this operator
+  auto invalid_utf8 = []() {
+    return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT, "Input contains invalid utf8 chars");
+  };
+
+  // Filter input. The kept strings are recorded with the index of their converted value when the
+  // case was already changed while comparing them to the stopwords, npos otherwise.
+  constexpr size_t npos = std::numeric_limits<size_t>::max();
   auto* const input_data = X->Data<std::string>();
-  using StrRef = std::reference_wrapper<const std::string>;
-  if (is_case_sensitive_) {
-    if (!stopwords_.empty()) {
-      InlinedVector<StrRef> filtered_strings;
-      filtered_strings.reserve(C);
-      auto first = input_data;
-      auto const last = input_data + C;
-      while (first != last) {
-        const std::string& s = *first;
-        if (0 == stopwords_.count(s)) {
-          filtered_strings.push_back(std::cref(s));
-        }
-        ++first;
+  InlinedVector<std::pair<size_t, size_t>> kept;
+  std::vector<std::string> converted;
+  std::string folded;
+  kept.reserve(C);
+  for (size_t i = 0; i < C; ++i) {
+    const std::string& s = input_data[i];
+    if (is_case_sensitive_) {
+      if (!stopwords_.empty() && stopwords_.count(s) != 0) {
+        continue;
       }
-      status = CopyCaseAction(filtered_strings.cbegin(), filtered_strings.cend(), ctx, locale, converter,
-                              N, filtered_strings.size(), case_change_action_);
-    } else {
-      // Nothing to filter. Copy input to output and change case if needed
-      status = CopyCaseAction(input_data, input_data + C, ctx, locale, converter, N, C, case_change_action_);
-    }
-  } else {
-    if (!wstopwords_.empty()) {
-      // Filter input. When no case action is required
-      // we simply store original string references.
-      // Otherwise, we store converted strings.
-      InlinedVector<StrRef> filtered_orignal_strings;
-      InlinedVector<std::string> filtered_cased_strings;
-      filtered_orignal_strings.reserve(C);
-      filtered_cased_strings.reserve(C);
-      auto first = input_data;
-      auto const last = input_data + C;
-      while (first != last) {
-        const std::string& s = *first;
-        std::wstring wstr = converter.from_bytes(s);
-        if (wstr == wconv_error) {
-          // Please do not include the input text in the error message as it could
-          // be deemed as a compliance violation by teams using this operator
-          return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                        "Input contains invalid utf8 chars");
-        }
-        locale.ChangeCase(compare_caseaction_, wstr);
-        if (0 == wstopwords_.count(wstr)) {
-          if (case_change_action_ == NONE) {
-            filtered_orignal_strings.push_back(std::cref(s));
-          } else {
-            filtered_cased_strings.push_back(converter.to_bytes(wstr));
-          }
+    } else if (!stopwords_.empty()) {
+      if (ascii_case_change_ && IsAscii(s)) {
+        folded.assign(s);
+        ChangeCaseAscii(compare_caseaction_, folded);
+        if (stopwords_.count(folded) != 0) {
+          continue;
         }
-        ++first;
-      }
-      if (case_change_action_ == NONE) {
-        status = CopyCaseAction(filtered_orignal_strings.cbegin(), filtered_orignal_strings.cend(), ctx, locale, converter,
-                                N, filtered_orignal_strings.size(), NONE);
       } else {
-        status = CopyCaseAction(filtered_cased_strings.begin(), filtered_cased_strings.end(), ctx, locale, converter,
-                                N, filtered_cased_strings.size(), NONE);
+        if (!to_wide(s, compare_caseaction_)) {
+          return invalid_utf8();
+        }
+        if (wstopwords_.count(wstr) != 0) {
+          continue;
+        }
+        if (case_change_action_ != NONE) {
+          // compare_caseaction_ is case_change_action_ in this case
+          converted.push_back(converter->to_bytes(wstr));
+          kept.emplace_back(i, converted.size() - 1);
+          continue;
+        }
       }
+    }
+    kept.emplace_back(i, npos);
+  }
+
+  std::vector<int64_t> output_dims;
+  if (N == 1) {
+    output_dims.push_back(1);
+  }
+
+  // Empty output case
+  if (kept.empty()) {
+    output_dims.push_back(1);
+    TensorShape output_shape(output_dims);
+    // This will create one empty string
+    ctx->Output(0, output_shape);
+    return Status::OK();
+  }
+
+  output_dims.push_back(static_cast<int64_t>(kept.size()));
+  TensorShape output_shape(output_dims);
+  auto output_tensor = ctx->Output(0, output_shape);
+  auto const output_data = output_tensor->MutableData<std::string>();
+
+  for (size_t output_idx = 0; output_idx < kept.size(); ++output_idx) {
+    const std::string& s = input_data[kept[output_idx].first];
+    std::string& output = output_data[output_idx];
+    if (kept[output_idx].second != npos) {
+      output = std::move(converted[kept[output_idx].second]);
+    } else if (case_change_action_ == NONE) {
+      output = s;
+    } else if (ascii_case_change_ && IsAscii(s)) {
+      output = s;
+      ChangeCaseAscii(case_change_action_, output);
     } else {
-      // Nothing to filter. Copy input to output and change case if needed
-      status = CopyCaseAction(input_data, input_data + C, ctx, locale, converter, N, C, case_change_action_);
+      if (!to_wide(s, case_change_action_)) {
+        return invalid_utf8();
+      }
+      output = converter->to_bytes(wstr);
     }
   }
-  return status;
+  return Status::OK();
 }
 }  // namespace onnxruntime
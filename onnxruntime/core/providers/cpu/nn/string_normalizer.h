@@ -29,7 +29,11 @@ class StringNormalizer : public OpKernel {
   CaseAction case_change_action_;
   CaseAction compare_caseaction_;  // used for case-insensitive compare
   std::string locale_name_;
-  // Either if these are populated but not both
+  // True if the locale changes the case of ASCII characters like the C locale. ASCII strings are
+  // then processed in place, without a conversion to wide strings.
+  bool ascii_case_change_ = false;
+  // Case sensitive stopwords are in stopwords_. Case insensitive stopwords are changed to
+  // compare_caseaction_ and stored in both: as utf8 for ASCII inputs and as wide strings for others.
   InlinedHashSet<std::string> stopwords_;
   InlinedHashSet<std::wstring> wstopwords_;
 };
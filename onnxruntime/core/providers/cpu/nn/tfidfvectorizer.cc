@@ -6,8 +6,13 @@
 #include "core/framework/tensor.h"
 #include "core/platform/threadpool.h"
 
+#include "core/common/inlined_containers.h"
+#include "core/providers/cpu/ml/string_lookup.h"
+
+#include <algorithm>
 #include <functional>
-#include <unordered_map>
+#include <limits>
+#include <numeric>
 #include <core/common/safeint.h>
 
 namespace onnxruntime {
@@ -24,61 +29,144 @@ ONNX_CPU_OPERATOR_KERNEL(
 
 namespace ngram_details {
 
-// NgrampPart implements a Trie like structure
-// for a unigram (1) it would insert into a root map with a valid id.
-// for (1,2,3) node 2 would be a child of 1 but have id == 0
-// because (1,2) does not exists. Node 3 would have a valid id.
-template <class T>
-struct NgramPart;
-
-template <>
-struct NgramPart<int64_t>;
+// Aho-Corasick automaton over the n-grams of the pool.
+// The items of the pool are mapped to dense symbols and every n-gram is a path from the root
+// of a trie over the symbols. A state is identified by the longest prefix of an n-gram ending
+// at the current position of a scan. Its failure link is the state of its longest proper suffix
+// that is also a prefix, and its output link is the closest state along the failure links which
+// ends an n-gram. A sequence of symbols is scanned with one transition per item and every
+// n-gram ending at an item is found by following the output links, instead of walking the trie
+// from every start position.
+class NgramAutomaton {
+ public:
+  static constexpr uint32_t kRoot = 0;
+  static constexpr uint32_t kNoSymbol = std::numeric_limits<uint32_t>::max();
+
+  NgramAutomaton() : ngram_id_(1, 0), depth_(1, 0), parent_(1, kRoot), symbol_(1, kNoSymbol),
+                     failure_(1, kRoot), output_(1, kRoot) {}
+
+  bool empty() const { return ngram_count_ == 0; }
+
+  void SetSymbolCount(size_t symbol_count) { root_children_.resize(symbol_count, kRoot); }
+
+  // Adds the n-gram made of the given symbols. Returns false if the n-gram was already added.
+  template <class ForwardIter>
+  bool Add(ForwardIter first, size_t ngram_size, size_t ngram_id) {
+    uint32_t state = kRoot;
+    for (size_t n = 0; n < ngram_size; ++n, ++first) {
+      const uint32_t symbol = *first;
+      uint32_t child = Child(state, symbol);
+      if (child == kRoot) {
+        child = static_cast<uint32_t>(ngram_id_.size());
+        ngram_id_.push_back(0);
+        depth_.push_back(depth_[state] + 1);
+        parent_.push_back(state);
+        symbol_.push_back(symbol);
+        if (state == kRoot) {
+          root_children_[symbol] = child;
+        } else {
+          children_.emplace(Key(state, symbol), child);
+        }
+      }
+      state = child;
+    }
+    if (ngram_id_[state] != 0) {
+      return false;
+    }
+    ngram_id_[state] = ngram_id;
+    ++ngram_count_;
+    return true;
+  }
 
-template <>
-struct NgramPart<std::string>;
+  // Computes the failure and output links once every n-gram is added.
+  void Finalize() {
+    const size_t state_count = ngram_id_.size();
+    failure_.assign(state_count, kRoot);
+    output_.assign(state_count, kRoot);
+
+    // The links of a state refer to shallower states: process the states breadth first.
+    std::vector<uint32_t> order(state_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [this](uint32_t a, uint32_t b) { return depth_[a] < depth_[b]; });
+
+    for (uint32_t state : order) {
+      if (depth_[state] <= 1) {
+        continue;
+      }
+      const uint32_t symbol = symbol_[state];
+      uint32_t suffix = failure_[parent_[state]];
+      uint32_t next = Child(suffix, symbol);
+      while (next == kRoot && suffix != kRoot) {
+        suffix = failure_[suffix];
+        next = Child(suffix, symbol);
+      }
+      failure_[state] = next;
+      output_[state] = ngram_id_[next] != 0 ? next : output_[next];
+    }
+  }
 
-using NgramPartInt = NgramPart<int64_t>;
-using NgramPartString = NgramPart<std::string>;
+  // Moves from a state to the state after the symbol, a symbol outside the pool resets the scan.
+  uint32_t Next(uint32_t state, uint32_t symbol) const {
+    if (symbol == kNoSymbol) {
+      return kRoot;
+    }
+    for (;;) {
+      const uint32_t next = Child(state, symbol);
+      if (next != kRoot || state == kRoot) {
+        return next;
+      }
+      state = failure_[state];
+    }
+  }
 
-// Avoid recursive class definitions using unique_ptr + forward declaration
-using IntMap = std::unordered_map<int64_t, std::unique_ptr<NgramPartInt>>;
+  // Calls fn(ngram_id, ngram_size) for every n-gram ending at the state.
+  template <class Fn>
+  void ForEachNgram(uint32_t state, Fn&& fn) const {
+    if (ngram_id_[state] == 0) {
+      state = output_[state];
+    }
+    for (; state != kRoot; state = output_[state]) {
+      fn(ngram_id_[state], static_cast<size_t>(depth_[state]));
+    }
+  }
 
-using StrMap = std::unordered_map<std::reference_wrapper<const std::string>, std::unique_ptr<NgramPartString>,
-                                  std::hash<std::string>, std::equal_to<std::string>>;
+ private:
+  static uint64_t Key(uint32_t state, uint32_t symbol) {
+    return (static_cast<uint64_t>(state) << 32) | symbol;
+  }
 
-template <>
-struct NgramPart<int64_t> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  IntMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
-};
+  // Returns kRoot if the state has no child for the symbol.
+  uint32_t Child(uint32_t state, uint32_t symbol) const {
+    if (state == kRoot) {
+      return root_children_[symbol];
+    }
+    auto hit = children_.find(Key(state, symbol));
+    return hit == children_.end() ? kRoot : hit->second;
+  }
 
-template <>
-struct NgramPart<std::string> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  StrMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
+  // Transitions from the root are indexed by symbol, the others are in a flat hash map.
+  std::vector<uint32_t> root_children_;
+  InlinedHashMap<uint64_t, uint32_t> children_;
+  size_t ngram_count_ = 0;
+  // Per state.
+  std::vector<size_t> ngram_id_;  // 0 - means the state does not end an n-gram
+  std::vector<uint32_t> depth_;
+  std::vector<uint32_t> parent_;
+  std::vector<uint32_t> symbol_;
+  std::vector<uint32_t> failure_;
+  std::vector<uint32_t> output_;
 };
 
 // Returns next ngram_id
-template <class K, class ForwardIter, class Map>
+template <class ForwardIter>
 inline size_t PopulateGrams(ForwardIter first, size_t ngrams, size_t ngram_size, size_t ngram_id,
-                            Map& c) {
+                            NgramAutomaton& automaton) {
   for (; ngrams > 0; --ngrams) {
-    size_t n = 1;
-    Map* m = &c;
-    while (true) {
-      auto p = m->emplace(*first, std::make_unique<NgramPart<K>>(0));
-      ++first;
-      if (n == ngram_size) {
-        ORT_ENFORCE(p.first->second->id_ == 0, "Duplicate ngram detected, size: ", ngram_size, " id: ", ngram_id);
-        p.first->second->id_ = ngram_id;
-        ++ngram_id;
-        break;
-      }
-      ++n;
-      m = &p.first->second->leafs_;
-    }
+    ORT_ENFORCE(automaton.Add(first, ngram_size, ngram_id),
+                "Duplicate ngram detected, size: ", ngram_size, " id: ", ngram_id);
+    first += ngram_size;
+    ++ngram_id;
   }
   return ngram_id;
 }
@@ -90,10 +178,6 @@ using namespace onnxruntime::ngram_details;
 
 namespace onnxruntime {
 
-inline const void* AdvanceElementPtr(const void* p, size_t elements, size_t element_size) {
-  return reinterpret_cast<const uint8_t*>(p) + elements * element_size;
-}
-
 // The weighting criteria.
 // "TF"(term frequency),
 //    the counts are propagated to output
@@ -128,11 +212,12 @@ struct TfIdfVectorizer::Impl {
   gsl::span<const int64_t> ngram_indexes_;
   gsl::span<const float> weights_;
 
-  // This map contains references to pool_string_ entries
-  // of pool_strings attribute
-  StrMap str_map_;
-  // This map contains pool_int64s entries
-  IntMap int64_map_;
+  // Symbols of the items of pool_strings or pool_int64s
+  bool pool_is_string_ = false;
+  ml::StringLookup string_symbols_;
+  InlinedHashMap<int64_t, uint32_t> int64_symbols_;
+  // n-grams of the pool within [min_gram_length, max_gram_length]
+  NgramAutomaton automaton_;
 
   size_t output_size_ = 0;
 
@@ -218,8 +303,25 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
     ORT_ENFORCE(status.IsOK() && !pool_int64s.empty(), "non-empty pool_int64s is required if pool_strings not provided");
   }
 
-  // Iterator via the pool. Insert 1 item for 1-grams, 2 items for 2-grams, etc.
+  // Map the items of the pool to symbols.
   const auto total_items = (pool_strings.empty()) ? pool_int64s.size() : pool_strings.size();
+  impl_->pool_is_string_ = !pool_strings.empty();
+  std::vector<uint32_t> pool_symbols;
+  pool_symbols.reserve(total_items);
+  if (impl_->pool_is_string_) {
+    for (const std::string& item : pool_strings) {
+      pool_symbols.push_back(static_cast<uint32_t>(impl_->string_symbols_.Insert(item).first));
+    }
+    impl_->automaton_.SetSymbolCount(impl_->string_symbols_.size());
+  } else {
+    for (int64_t item : pool_int64s) {
+      auto symbol = static_cast<uint32_t>(impl_->int64_symbols_.size());
+      pool_symbols.push_back(impl_->int64_symbols_.emplace(item, symbol).first->second);
+    }
+    impl_->automaton_.SetSymbolCount(impl_->int64_symbols_.size());
+  }
+
+  // Iterator via the pool. Insert 1 item for 1-grams, 2 items for 2-grams, etc.
   size_t ngram_id = 1;  // start with 1, 0 - means no n-gram
   // Load into dictionary only required gram sizes
   const size_t min_gram_length = onnxruntime::narrow<size_t>(impl_->min_gram_length_);
@@ -237,17 +339,14 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
       auto ngrams = items / ngram_size;
       // Skip loading into hash_set ngrams that are not in the range of [min_gram_length-max_gram_length]
       if (ngram_size >= min_gram_length && ngram_size <= max_gram_length) {
-        if (pool_strings.empty()) {
-          ngram_id = PopulateGrams<int64_t>(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->int64_map_);
-        } else {
-          ngram_id = PopulateGrams<std::string>(pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->str_map_);
-        }
+        ngram_id = PopulateGrams(pool_symbols.cbegin() + start_idx, ngrams, ngram_size, ngram_id, impl_->automaton_);
       } else {
         ngram_id += ngrams;
       }
     }
     ++ngram_size;
   }
+  impl_->automaton_.Finalize();
 }
 
 TfIdfVectorizer::~TfIdfVectorizer() = default;
@@ -314,65 +413,49 @@ void TfIdfVectorizer::OutputResult(OpKernelContext* ctx, size_t B, const std::ve
 void TfIdfVectorizer::ComputeImpl(OpKernelContext* ctx, ptrdiff_t row_num, size_t row_size,
                                   std::vector<uint32_t>& frequencies) const {
   auto X = ctx->Input<Tensor>(0);
-  const auto elem_size = X->DataType()->Size();
-
-  const void* const row_begin = AdvanceElementPtr(X->DataRaw(), row_num * row_size, elem_size);
-  const void* const row_end = AdvanceElementPtr(row_begin, row_size, elem_size);
-
   const auto& impl = *impl_;
-  const auto max_gram_length = impl.max_gram_length_;
-  const auto max_skip_distance = impl.max_skip_count_ + 1;  // Convert to distance
-  auto start_ngram_size = impl.min_gram_length_;
-
-  for (auto skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
-    auto ngram_start = row_begin;
-    auto const ngram_row_end = row_end;
-
-    while (ngram_start < ngram_row_end) {
-      // We went far enough so no n-grams of any size can be gathered
-      auto at_least_this = AdvanceElementPtr(ngram_start, SafeInt<size_t>(skip_distance) * (start_ngram_size - 1), elem_size);
-      if (at_least_this >= ngram_row_end) {
-        break;
-      }
 
-      auto ngram_item = ngram_start;
-      if (X->IsDataTypeString()) {
-        const std::string* str_item = reinterpret_cast<const std::string*>(ngram_item);
-        const StrMap* str_map = &impl.str_map_;
-        for (auto ngram_size = 1;
-             !str_map->empty() &&
-             ngram_size <= max_gram_length &&
-             str_item < ngram_row_end;
-             ++ngram_size, str_item += skip_distance) {
-          auto hit = str_map->find(*str_item);
-          if (hit == str_map->end()) {
-            break;
-          }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            impl.IncrementCount(hit->second->id_, row_num, frequencies);
-          }
-          str_map = &hit->second->leafs_;
-        }
-      } else {
-        const IntMap* int_map = &impl.int64_map_;
-        for (auto ngram_size = 1;
-             !int_map->empty() &&
-             ngram_size <= max_gram_length &&
-             ngram_item < ngram_row_end;
-             ++ngram_size, ngram_item = AdvanceElementPtr(ngram_item, skip_distance, elem_size)) {
-          int64_t val = (X->IsDataType<int32_t>()) ? int64_t{*reinterpret_cast<const int32_t*>(ngram_item)} : *reinterpret_cast<const int64_t*>(ngram_item);
-          auto hit = int_map->find(val);
-          if (hit == int_map->end()) {
-            break;
-          }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            impl.IncrementCount(hit->second->id_, row_num, frequencies);
+  // Map the items of the row to the symbols of the pool once, items which are not in the pool
+  // can not be part of any n-gram.
+  std::vector<uint32_t> symbols(row_size);
+  const size_t row_offset = SafeInt<size_t>(row_num) * row_size;
+  if (X->IsDataTypeString()) {
+    const std::string* items = X->Data<std::string>() + row_offset;
+    for (size_t i = 0; i < row_size; ++i) {
+      const size_t symbol = impl.string_symbols_.Find(items[i]);
+      symbols[i] = symbol == ml::StringLookup::npos ? NgramAutomaton::kNoSymbol : static_cast<uint32_t>(symbol);
+    }
+  } else {
+    auto map_item = [&impl](int64_t item) {
+      auto hit = impl.int64_symbols_.find(item);
+      return hit == impl.int64_symbols_.end() ? NgramAutomaton::kNoSymbol : hit->second;
+    };
+    if (X->IsDataType<int32_t>()) {
+      const int32_t* items = X->Data<int32_t>() + row_offset;
+      std::transform(items, items + row_size, symbols.begin(), map_item);
+    } else {
+      const int64_t* items = X->Data<int64_t>() + row_offset;
+      std::transform(items, items + row_size, symbols.begin(), map_item);
+    }
+  }
+
+  const size_t max_skip_distance = SafeInt<size_t>(impl.max_skip_count_) + 1;  // Convert to distance
+  size_t start_ngram_size = onnxruntime::narrow<size_t>(impl.min_gram_length_);
+  const size_t max_gram_length = onnxruntime::narrow<size_t>(impl.max_gram_length_);
+
+  for (size_t skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
+    // The n-grams with this skip distance are the contiguous n-grams of the subsequences
+    // made of every skip_distance-th item. Scan each of them once.
+    for (size_t first = 0; first < skip_distance && first < row_size; ++first) {
+      uint32_t state = NgramAutomaton::kRoot;
+      for (size_t i = first; i < row_size; i += skip_distance) {
+        state = impl.automaton_.Next(state, symbols[i]);
+        impl.automaton_.ForEachNgram(state, [&](size_t ngram_id, size_t ngram_size) {
+          if (ngram_size >= start_ngram_size) {
+            impl.IncrementCount(ngram_id, row_num, frequencies);
           }
-          int_map = &hit->second->leafs_;
-        }
+        });
       }
-      // Sliding window shift
-      ngram_start = AdvanceElementPtr(ngram_start, 1, elem_size);
     }
     // We count UniGrams only once since they are not affected
     // by skip distance
@@ -417,9 +500,7 @@ Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
   std::vector<uint32_t> frequencies;
   frequencies.resize(num_rows * impl_->output_size_, 0);
 
-  if (total_items == 0 ||
-      (X->IsDataTypeString() && impl_->str_map_.empty()) ||
-      ((X->IsDataType<int32_t>() || X->IsDataType<int64_t>()) && impl_->int64_map_.empty())) {
+  if (total_items == 0 || impl_->automaton_.empty() || X->IsDataTypeString() != impl_->pool_is_string_) {
     // TfidfVectorizer may receive an empty input when it follows a Tokenizer
     // (for example for a string containing only stopwords).
     // TfidfVectorizer returns a zero tensor of shape
@@ -6,6 +6,7 @@
 #include "core/common/inlined_containers.h"
 #include "core/common/narrow.h"
 #include "core/common/span_utils.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/providers/common.h"
 // TODO: fix the warnings
 #if defined(_MSC_VER) && !defined(__clang__)
@@ -885,6 +886,54 @@ void CommonReduce2Loops(OpKernelContext* ctx,
   NoTransposeReduce2Loops<AGG>(output, fast_shape, *input, fast_axes, ctx->GetOperatorThreadPool(), last_results);
 }
 
+// Runs Sum/Mean/SumSquare/Max/Min on the MLAS multi-axis reduction engine, which handles any
+// axis pattern after fusion without the thresholds of the fast reduce paths. Returns false
+// when the type or shape is not supported and the generic implementation must run.
+template <typename T>
+static bool MlasReduceCompute(OpKernelContext* ctx, MLAS_REDUCE_KIND kind,
+                              const gsl::span<const int64_t>& axes_, int64_t keepdims_,
+                              bool noop_with_empty_axes) {
+  if constexpr (std::is_same<T, float>::value || std::is_same<T, int32_t>::value ||
+                std::is_same<T, int64_t>::value) {
+    TensorShapeVector input_axes;
+    if (CommonFastReduceCopy(ctx, input_axes, noop_with_empty_axes)) {
+      return true;
+    }
+
+    const Tensor* input = ctx->Input<Tensor>(0);
+    TensorShapeVector fast_shape, output_shape, fast_axes;
+    FastReduceKind fast_kind = OptimizeShapeForFastReduce(
+        input->Shape().GetDims(), input_axes.empty() ? axes_ : input_axes,
+        fast_shape, output_shape, fast_axes, keepdims_ != 0, noop_with_empty_axes);
+
+    if (fast_kind == FastReduceKind::kEmpty || fast_kind == FastReduceKind::kK ||
+        fast_shape.size() > MLAS_REDUCE_MAXIMUM_RANK) {
+      return false;
+    }
+
+    size_t shape[MLAS_REDUCE_MAXIMUM_RANK];
+    bool reduce_axes[MLAS_REDUCE_MAXIMUM_RANK] = {};
+    for (size_t i = 0; i < fast_shape.size(); ++i) {
+      shape[i] = onnxruntime::narrow<size_t>(fast_shape[i]);
+    }
+    for (auto axis : fast_axes) {
+      reduce_axes[onnxruntime::narrow<size_t>(axis)] = true;
+    }
+
+    Tensor* output = ctx->Output(0, output_shape);
+    MlasReduce<T>(kind, fast_shape.size(), shape, reduce_axes, input->Data<T>(), output->MutableData<T>(),
+                  ctx->GetOperatorThreadPool());
+    return true;
+  } else {
+    ORT_UNUSED_PARAMETER(ctx);
+    ORT_UNUSED_PARAMETER(kind);
+    ORT_UNUSED_PARAMETER(axes_);
+    ORT_UNUSED_PARAMETER(keepdims_);
+    ORT_UNUSED_PARAMETER(noop_with_empty_axes);
+    return false;
+  }
+}
+
 template <typename T>
 Status ReduceL1<T>::Compute(OpKernelContext* ctx) const {
   // The following variable does not change if the input tensor and the
@@ -914,18 +963,27 @@ Status ReduceLogSumExp<T>::Compute(OpKernelContext* ctx) const {
 
 template <typename T>
 Status ReduceMax<T>::Compute(OpKernelContext* ctx) const {
+  if (MlasReduceCompute<T>(ctx, MlasReduceMax, axes_, keepdims_, false)) {
+    return Status::OK();
+  }
   CommonReduce1Loop<ReduceAggregatorMax<T>>(ctx, axes_, keepdims_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceMean<T>::Compute(OpKernelContext* ctx) const {
+  if (MlasReduceCompute<T>(ctx, MlasReduceMean, axes_, keepdims_, false)) {
+    return Status::OK();
+  }
   CommonReduce1Loop<ReduceAggregatorMean<T>>(ctx, axes_, keepdims_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceMin<T>::Compute(OpKernelContext* ctx) const {
+  if (MlasReduceCompute<T>(ctx, MlasReduceMin, axes_, keepdims_, false)) {
+    return Status::OK();
+  }
   CommonReduce1Loop<ReduceAggregatorMin<T>>(ctx, axes_, keepdims_);
   return Status::OK();
 }
@@ -938,6 +996,9 @@ Status ReduceProd<T>::Compute(OpKernelContext* ctx) const {
 
 template <typename T>
 Status ReduceSum<T>::Compute(OpKernelContext* ctx) const {
+  if (MlasReduceCompute<T>(ctx, MlasReduceSum, axes_, keepdims_, noop_with_empty_axes_)) {
+    return Status::OK();
+  }
   CommonReduce1Loop<ReduceAggregatorSum<T>>(ctx, axes_, keepdims_, noop_with_empty_axes_);
   return Status::OK();
 }
@@ -1017,6 +1078,9 @@ std::unique_ptr<Tensor> ReduceSum<T>::Impl(const Tensor& input, gsl::span<const
 
 template <typename T>
 Status ReduceSumSquare<T>::Compute(OpKernelContext* ctx) const {
+  if (MlasReduceCompute<T>(ctx, MlasReduceSumSquare, axes_, keepdims_, false)) {
+    return Status::OK();
+  }
   CommonReduce1Loop<ReduceAggregatorSumSquare<T>>(ctx, axes_, keepdims_);
   return Status::OK();
 }
@@ -0,0 +1,449 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/cpu/signal/fft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+namespace signal {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Returns the radices for a Stockham plan of size n, or an empty vector when n
+// has a prime factor other than 2, 3 or 5.
+std::vector<size_t> FactorSmoothSize(size_t n) {
+  std::vector<size_t> radices;
+  while (n % 4 == 0) {
+    radices.push_back(4);
+    n /= 4;
+  }
+  while (n % 2 == 0) {
+    radices.push_back(2);
+    n /= 2;
+  }
+  while (n % 3 == 0) {
+    radices.push_back(3);
+    n /= 3;
+  }
+  while (n % 5 == 0) {
+    radices.push_back(5);
+    n /= 5;
+  }
+  if (n != 1) {
+    radices.clear();
+  }
+  return radices;
+}
+
+size_t NextSmoothSize(size_t n) {
+  while (FactorSmoothSize(n).empty()) {
+    n++;
+  }
+  return n;
+}
+
+// Size R DFT of the values in r/i, in place. sign is -1 for the forward
+// transform and +1 for the inverse transform.
+template <typename T, size_t R>
+struct Butterfly;
+
+template <typename T>
+struct Butterfly<T, 2> {
+  static inline void Run(T* r, T* i, T /*sign*/) {
+    const T r0 = r[0] + r[1];
+    const T i0 = i[0] + i[1];
+    r[1] = r[0] - r[1];
+    i[1] = i[0] - i[1];
+    r[0] = r0;
+    i[0] = i0;
+  }
+};
+
+template <typename T>
+struct Butterfly<T, 3> {
+  static inline void Run(T* r, T* i, T sign) {
+    const T kSin60 = static_cast<T>(0.86602540378443864676);
+    const T tr = r[1] + r[2];
+    const T ti = i[1] + i[2];
+    const T dr = (r[1] - r[2]) * (sign * kSin60);
+    const T di = (i[1] - i[2]) * (sign * kSin60);
+    const T mr = r[0] - tr * static_cast<T>(0.5);
+    const T mi = i[0] - ti * static_cast<T>(0.5);
+    r[0] += tr;
+    i[0] += ti;
+    r[1] = mr - di;
+    i[1] = mi + dr;
+    r[2] = mr + di;
+    i[2] = mi - dr;
+  }
+};
+
+template <typename T>
+struct Butterfly<T, 4> {
+  static inline void Run(T* r, T* i, T sign) {
+    const T t0r = r[0] + r[2];
+    const T t0i = i[0] + i[2];
+    const T t1r = r[0] - r[2];
+    const T t1i = i[0] - i[2];
+    const T t2r = r[1] + r[3];
+    const T t2i = i[1] + i[3];
+    // sign * i * (a1 - a3)
+    const T t3r = (i[3] - i[1]) * sign;
+    const T t3i = (r[1] - r[3]) * sign;
+    r[0] = t0r + t2r;
+    i[0] = t0i + t2i;
+    r[2] = t0r - t2r;
+    i[2] = t0i - t2i;
+    r[1] = t1r + t3r;
+    i[1] = t1i + t3i;
+    r[3] = t1r - t3r;
+    i[3] = t1i - t3i;
+  }
+};
+
+template <typename T>
+struct Butterfly<T, 5> {
+  static inline void Run(T* r, T* i, T sign) {
+    const T kCos72 = static_cast<T>(0.30901699437494742410);
+    const T kCos144 = static_cast<T>(-0.80901699437494742410);
+    const T kSin72 = static_cast<T>(0.95105651629515357212);
+    const T kSin144 = static_cast<T>(0.58778525229247312917);
+    const T t1r = r[1] + r[4];
+    const T t1i = i[1] + i[4];
+    const T t2r = r[2] + r[3];
+    const T t2i = i[2] + i[3];
+    const T d1r = (r[1] - r[4]) * sign;
+    const T d1i = (i[1] - i[4]) * sign;
+    const T d2r = (r[2] - r[3]) * sign;
+    const T d2i = (i[2] - i[3]) * sign;
+    const T m1r = r[0] + kCos72 * t1r + kCos144 * t2r;
+    const T m1i = i[0] + kCos72 * t1i + kCos144 * t2i;
+    const T m2r = r[0] + kCos144 * t1r + kCos72 * t2r;
+    const T m2i = i[0] + kCos144 * t1i + kCos72 * t2i;
+    const T n1r = kSin72 * d1r + kSin144 * d2r;
+    const T n1i = kSin72 * d1i + kSin144 * d2i;
+    const T n2r = kSin144 * d1r - kSin72 * d2r;
+    const T n2i = kSin144 * d1i - kSin72 * d2i;
+    r[0] += t1r + t2r;
+    i[0] += t1i + t2i;
+    // b1/b4 = m1 +/- i * n1, b2/b3 = m2 +/- i * n2
+    r[1] = m1r - n1i;
+    i[1] = m1i + n1r;
+    r[4] = m1r + n1i;
+    i[4] = m1i - n1r;
+    r[2] = m2r - n2i;
+    i[2] = m2i + n2r;
+    r[3] = m2r + n2i;
+    i[3] = m2i - n2r;
+  }
+};
+
+// One decimation in frequency Stockham stage. The input is viewed as
+// [R][m][s] and the output as [m][R][s], so the inner loop over s is unit
+// stride for both with a single twiddle per butterfly column. The first stage
+// (s == 1) instead runs the loop over m with twiddles loaded from the table.
+template <typename T, size_t R>
+void StockhamStage(size_t m, size_t s, T sign, const T* xr, const T* xi, T* yr, T* yi,
+                   const T* twr, const T* twi) {
+  const size_t ms = m * s;
+
+  if (s == 1) {
+    for (size_t p = 0; p < m; p++) {
+      T ar[R];
+      T ai[R];
+      for (size_t j = 0; j < R; j++) {
+        ar[j] = xr[p + j * m];
+        ai[j] = xi[p + j * m];
+      }
+      Butterfly<T, R>::Run(ar, ai, sign);
+      yr[R * p] = ar[0];
+      yi[R * p] = ai[0];
+      for (size_t k = 1; k < R; k++) {
+        const T wr = twr[(k - 1) * m + p];
+        const T wi = twi[(k - 1) * m + p];
+        yr[R * p + k] = ar[k] * wr - ai[k] * wi;
+        yi[R * p + k] = ar[k] * wi + ai[k] * wr;
+      }
+    }
+    return;
+  }
+
+  for (size_t p = 0; p < m; p++) {
+    T wr[R];
+    T wi[R];
+    for (size_t k = 1; k < R; k++) {
+      wr[k] = twr[(k - 1) * m + p];
+      wi[k] = twi[(k - 1) * m + p];
+    }
+    const T* x0r = xr + s * p;
+    const T* x0i = xi + s * p;
+    T* y0r = yr + s * R * p;
+    T* y0i = yi + s * R * p;
+
+    for (size_t q = 0; q < s; q++) {
+      T ar[R];
+      T ai[R];
+      for (size_t j = 0; j < R; j++) {
+        ar[j] = x0r[q + j * ms];
+        ai[j] = x0i[q + j * ms];
+      }
+      Butterfly<T, R>::Run(ar, ai, sign);
+      y0r[q] = ar[0];
+      y0i[q] = ai[0];
+      for (size_t k = 1; k < R; k++) {
+        y0r[q + k * s] = ar[k] * wr[k] - ai[k] * wi[k];
+        y0i[q + k * s] = ar[k] * wi[k] + ai[k] * wr[k];
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+FftPlan<T>::FftPlan(size_t n, bool inverse) : n_(n), inverse_(inverse) {
+  ORT_ENFORCE(n > 0, "FFT size must be greater than zero.");
+
+  const double sign = inverse ? 1.0 : -1.0;
+  const std::vector<size_t> radices = FactorSmoothSize(n);
+
+  if (!radices.empty() || n == 1) {
+    size_t stage_size = n;
+    for (size_t radix : radices) {
+      const size_t m = stage_size / radix;
+      stages_.push_back({radix, m, twiddle_re_.size()});
+      for (size_t k = 1; k < radix; k++) {
+        for (size_t p = 0; p < m; p++) {
+          const double angle = sign * 2.0 * kPi * static_cast<double>(p * k) / static_cast<double>(stage_size);
+          twiddle_re_.push_back(static_cast<T>(std::cos(angle)));
+          twiddle_im_.push_back(static_cast<T>(std::sin(angle)));
+        }
+      }
+      stage_size = m;
+    }
+    return;
+  }
+
+  // Bluestein: X[k] = c[k] * sum(x[j] * c[j] * conj(c[k - j])) with the chirp
+  // c[j] = exp(sign * i * pi * j^2 / n), evaluated as a cyclic convolution of
+  // smooth length M >= 2n - 1.
+  const size_t M = NextSmoothSize(2 * n - 1);
+  convolution_plan_ = std::make_unique<FftPlan<T>>(M, false);
+
+  chirp_re_.resize(n);
+  chirp_im_.resize(n);
+  for (size_t j = 0; j < n; j++) {
+    // j^2 mod 2n keeps the angle small for large j.
+    const uint64_t j2 = (static_cast<uint64_t>(j) * j) % (2 * static_cast<uint64_t>(n));
+    const double angle = sign * kPi * static_cast<double>(j2) / static_cast<double>(n);
+    chirp_re_[j] = static_cast<T>(std::cos(angle));
+    chirp_im_[j] = static_cast<T>(std::sin(angle));
+  }
+
+  kernel_re_.assign(M, T(0));
+  kernel_im_.assign(M, T(0));
+  kernel_re_[0] = chirp_re_[0];
+  kernel_im_[0] = -chirp_im_[0];
+  for (size_t j = 1; j < n; j++) {
+    kernel_re_[j] = kernel_re_[M - j] = chirp_re_[j];
+    kernel_im_[j] = kernel_im_[M - j] = -chirp_im_[j];
+  }
+
+  std::vector<T> scratch(convolution_plan_->ScratchSize());
+  convolution_plan_->Execute(kernel_re_.data(), kernel_im_.data(), scratch.data());
+
+  // Fold the 1/M of the inverse convolution transform into the kernel.
+  const T scale = static_cast<T>(1.0 / static_cast<double>(M));
+  for (size_t j = 0; j < M; j++) {
+    kernel_re_[j] *= scale;
+    kernel_im_[j] *= scale;
+  }
+}
+
+template <typename T>
+size_t FftPlan<T>::ScratchSize() const {
+  if (convolution_plan_) {
+    return 2 * convolution_plan_->Size() + convolution_plan_->ScratchSize();
+  }
+  return 2 * n_;
+}
+
+template <typename T>
+void FftPlan<T>::Execute(T* re, T* im, T* scratch) const {
+  if (convolution_plan_) {
+    ExecuteBluestein(re, im, scratch);
+  } else {
+    ExecuteStockham(re, im, scratch);
+  }
+}
+
+template <typename T>
+void FftPlan<T>::ExecuteStockham(T* re, T* im, T* scratch) const {
+  const T sign = inverse_ ? T(1) : T(-1);
+
+  T* xr = re;
+  T* xi = im;
+  T* yr = scratch;
+  T* yi = scratch + n_;
+  size_t s = 1;
+
+  for (const Stage& stage : stages_) {
+    const T* twr = twiddle_re_.data() + stage.twiddle_offset;
+    const T* twi = twiddle_im_.data() + stage.twiddle_offset;
+
+    switch (stage.radix) {
+      case 2:
+        StockhamStage<T, 2>(stage.m, s, sign, xr, xi, yr, yi, twr, twi);
+        break;
+      case 3:
+        StockhamStage<T, 3>(stage.m, s, sign, xr, xi, yr, yi, twr, twi);
+        break;
+      case 4:
+        StockhamStage<T, 4>(stage.m, s, sign, xr, xi, yr, yi, twr, twi);
+        break;
+      default:
+        StockhamStage<T, 5>(stage.m, s, sign, xr, xi, yr, yi, twr, twi);
+        break;
+    }
+
+    std::swap(xr, yr);
+    std::swap(xi, yi);
+    s *= stage.radix;
+  }
+
+  if (xr != re) {
+    std::copy_n(xr, n_, re);
+    std::copy_n(xi, n_, im);
+  }
+}
+
+template <typename T>
+void FftPlan<T>::ExecuteBluestein(T* re, T* im, T* scratch) const {
+  const size_t M = convolution_plan_->Size();
+  T* ar = scratch;
+  T* ai = scratch + M;
+  T* convolution_scratch = scratch + 2 * M;
+
+  for (size_t j = 0; j < n_; j++) {
+    ar[j] = re[j] * chirp_re_[j] - im[j] * chirp_im_[j];
+    ai[j] = re[j] * chirp_im_[j] + im[j] * chirp_re_[j];
+  }
+  std::fill(ar + n_, ar + M, T(0));
+  std::fill(ai + n_, ai + M, T(0));
+
+  convolution_plan_->Execute(ar, ai, convolution_scratch);
+
+  // The inverse transform is computed as conj(FFT(conj(A * K))).
+  for (size_t j = 0; j < M; j++) {
+    const T r = ar[j] * kernel_re_[j] - ai[j] * kernel_im_[j];
+    const T i = ar[j] * kernel_im_[j] + ai[j] * kernel_re_[j];
+    ar[j] = r;
+    ai[j] = -i;
+  }
+
+  convolution_plan_->Execute(ar, ai, convolution_scratch);
+
+  for (size_t k = 0; k < n_; k++) {
+    const T cr = ar[k];
+    const T ci = -ai[k];
+    re[k] = cr * chirp_re_[k] - ci * chirp_im_[k];
+    im[k] = cr * chirp_im_[k] + ci * chirp_re_[k];
+  }
+}
+
+template <typename T>
+RealFftPlan<T>::RealFftPlan(size_t n, bool inverse) : n_(n), half_plan_(n / 2, inverse) {
+  ORT_ENFORCE(n >= 2 && n % 2 == 0, "Real FFT size must be even.");
+
+  const double sign = inverse ? 1.0 : -1.0;
+  const size_t half = n / 2;
+  twiddle_re_.resize(half + 1);
+  twiddle_im_.resize(half + 1);
+  for (size_t k = 0; k <= half; k++) {
+    const double angle = sign * 2.0 * kPi * static_cast<double>(k) / static_cast<double>(n);
+    twiddle_re_[k] = static_cast<T>(std::cos(angle));
+    twiddle_im_[k] = static_cast<T>(std::sin(angle));
+  }
+}
+
+template <typename T>
+void RealFftPlan<T>::Execute(const T* input, T* out_re, T* out_im, T* scratch) const {
+  const size_t half = n_ / 2;
+  T* zr = scratch;
+  T* zi = scratch + half;
+
+  // Pack even samples as the real part and odd samples as the imaginary part.
+  for (size_t j = 0; j < half; j++) {
+    zr[j] = input[2 * j];
+    zi[j] = input[2 * j + 1];
+  }
+
+  half_plan_.Execute(zr, zi, scratch + n_);
+
+  // Split Z into the transforms of the even (E) and odd (O) samples and
+  // combine them as X[k] = E[k] + w^k * O[k].
+  const T one_half = static_cast<T>(0.5);
+  for (size_t k = 0; k <= half; k++) {
+    const size_t k1 = (k == half) ? 0 : k;
+    const size_t k2 = (k == 0) ? 0 : half - k;
+    const T zkr = zr[k1];
+    const T zki = zi[k1];
+    const T zcr = zr[k2];
+    const T zci = -zi[k2];
+    const T er = (zkr + zcr) * one_half;
+    const T ei = (zki + zci) * one_half;
+    const T odd_r = (zki - zci) * one_half;
+    const T odd_i = (zcr - zkr) * one_half;
+    out_re[k] = er + twiddle_re_[k] * odd_r - twiddle_im_[k] * odd_i;
+    out_im[k] = ei + twiddle_re_[k] * odd_i + twiddle_im_[k] * odd_r;
+  }
+}
+
+template <typename T>
+std::shared_ptr<const FftPlan<T>> FftPlanCache<T>::GetPlan(size_t n, bool inverse) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  const auto key = std::make_pair(n, inverse);
+  auto it = plans_.find(key);
+  if (it != plans_.end()) {
+    return it->second;
+  }
+  if (plans_.size() >= kMaxCachedPlans) {
+    plans_.clear();
+  }
+  auto plan = std::make_shared<const FftPlan<T>>(n, inverse);
+  plans_.emplace(key, plan);
+  return plan;
+}
+
+template <typename T>
+std::shared_ptr<const RealFftPlan<T>> FftPlanCache<T>::GetRealPlan(size_t n, bool inverse) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  const auto key = std::make_pair(n, inverse);
+  auto it = real_plans_.find(key);
+  if (it != real_plans_.end()) {
+    return it->second;
+  }
+  if (real_plans_.size() >= kMaxCachedPlans) {
+    real_plans_.clear();
+  }
+  auto plan = std::make_shared<const RealFftPlan<T>>(n, inverse);
+  real_plans_.emplace(key, plan);
+  return plan;
+}
+
+template class FftPlan<float>;
+template class FftPlan<double>;
+template class RealFftPlan<float>;
+template class RealFftPlan<double>;
+template class FftPlanCache<float>;
+template class FftPlanCache<double>;
+
+}  // namespace signal
+}  // namespace onnxruntime
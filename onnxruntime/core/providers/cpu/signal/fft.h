@@ -0,0 +1,102 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+namespace signal {
+
+// A planned, unnormalized complex FFT of a fixed size and direction.
+//
+// Sizes whose prime factors are all 2, 3 or 5 run as a mixed radix 2/3/4/5
+// Stockham autosort transform with precomputed per-stage twiddles. Other sizes
+// use Bluestein's chirp-z algorithm on top of a smooth sized plan.
+//
+// Data is held as separate real and imaginary arrays so that every butterfly
+// stage is a set of unit stride loops the compiler can vectorize.
+template <typename T>
+class FftPlan {
+ public:
+  FftPlan(size_t n, bool inverse);
+
+  size_t Size() const { return n_; }
+
+  // Number of T elements of scratch space needed by Execute.
+  size_t ScratchSize() const;
+
+  // Transforms the n values held in re/im in place.
+  void Execute(T* re, T* im, T* scratch) const;
+
+ private:
+  struct Stage {
+    size_t radix;
+    size_t m;               // butterflies per stride, n_stage / radix
+    size_t twiddle_offset;  // (radix - 1) * m twiddles laid out as [k - 1][p]
+  };
+
+  void ExecuteStockham(T* re, T* im, T* scratch) const;
+  void ExecuteBluestein(T* re, T* im, T* scratch) const;
+
+  size_t n_;
+  bool inverse_;
+
+  std::vector<Stage> stages_;
+  std::vector<T> twiddle_re_;
+  std::vector<T> twiddle_im_;
+
+  // Bluestein state: the chirp, the transformed (and 1/M scaled) convolution
+  // kernel and the forward plan of the padded length M.
+  std::unique_ptr<FftPlan<T>> convolution_plan_;
+  std::vector<T> chirp_re_;
+  std::vector<T> chirp_im_;
+  std::vector<T> kernel_re_;
+  std::vector<T> kernel_im_;
+};
+
+// A planned FFT of n real values for even n, computed as a complex FFT of
+// n / 2 points followed by a split step. Produces the n / 2 + 1 unique bins;
+// the remaining bins follow from conjugate symmetry.
+template <typename T>
+class RealFftPlan {
+ public:
+  RealFftPlan(size_t n, bool inverse);
+
+  size_t Size() const { return n_; }
+
+  size_t ScratchSize() const { return n_ + half_plan_.ScratchSize(); }
+
+  // Reads n real values from input and writes n / 2 + 1 bins to out_re/out_im.
+  void Execute(const T* input, T* out_re, T* out_im, T* scratch) const;
+
+ private:
+  size_t n_;
+  FftPlan<T> half_plan_;
+  std::vector<T> twiddle_re_;
+  std::vector<T> twiddle_im_;
+};
+
+// Caches plans per (size, direction) so repeated DFT/STFT runs reuse twiddles.
+template <typename T>
+class FftPlanCache {
+ public:
+  std::shared_ptr<const FftPlan<T>> GetPlan(size_t n, bool inverse);
+  std::shared_ptr<const RealFftPlan<T>> GetRealPlan(size_t n, bool inverse);
+
+ private:
+  // Bounds the cache when dft_length changes between runs.
+  static constexpr size_t kMaxCachedPlans = 16;
+
+  OrtMutex mutex_;
+  std::map<std::pair<size_t, bool>, std::shared_ptr<const FftPlan<T>>> plans_;
+  std::map<std::pair<size_t, bool>, std::shared_ptr<const RealFftPlan<T>>> real_plans_;
+};
+
+}  // namespace signal
+}  // namespace onnxruntime
@@ -322,6 +322,30 @@ static Status DoUntypedTranspose(const gsl::span<const size_t>& permutations, co
   return status;
 }
 
+// Transposes tensors of 1, 2, 4 or 8 byte elements with the MLAS N-D transpose, which merges adjacent axes and
+// transposes the remaining axes in cache tiles across the thread pool.
+// Returns false if the tensor is not supported, leaving the caller to use the generic implementation.
+static bool TryMlasTranspose(const gsl::span<const size_t>& permutations, const Tensor& input, Tensor& output,
+                             const TensorShape* input_shape_override, concurrency::ThreadPool* tp) {
+  const auto& input_shape = input_shape_override ? *input_shape_override : input.Shape();
+  const size_t rank = input_shape.NumDimensions();
+  const auto element_size = input.DataType()->Size();
+
+  if (input.IsDataTypeString() || rank > MLAS_TRANSPOSE_MAXIMUM_RANK ||
+      (element_size != 1 && element_size != 2 && element_size != 4 && element_size != 8)) {
+    return false;
+  }
+
+  InlinedVector<size_t, MLAS_TRANSPOSE_MAXIMUM_RANK> input_dims(rank);
+  for (size_t i = 0; i < rank; ++i) {
+    input_dims[i] = onnxruntime::narrow<size_t>(input_shape[i]);
+  }
+
+  MlasTransposeNd(input.DataRaw(), output.MutableDataRaw(), element_size, rank, input_dims.data(),
+                  permutations.data(), tp);
+  return true;
+}
+
 bool IsTransposeReshape(const gsl::span<const size_t>& perm, gsl::span<const int64_t> input_dims) {
   // As long as the dims with values > 1 stay in the same order, it's a reshape.
   // Example: Shape=(1,1,1024,4096) -> perm=(2,0,3,1).
@@ -356,6 +380,10 @@ Status TransposeBase::DoTranspose(const gsl::span<const size_t>& permutations, c
       return Status::OK();
     }
 
+    if (TryMlasTranspose(permutations, input, output, input_shape_override, nullptr)) {
+      return Status::OK();
+    }
+
     size_t from = 0, to = 0;
     bool moving_single_axis = IsTransposeMovingSingleAxis(permutations, from, to);
 
@@ -398,6 +426,10 @@ Status Transpose::Compute(OpKernelContext* ctx) const {
     return Status::OK();
   }
 
+  if (TryMlasTranspose(*p_perm, X, Y, nullptr, ctx->GetOperatorThreadPool())) {
+    return Status::OK();
+  }
+
   size_t from = 0, to = 0;
   bool moving_single_axis = IsTransposeMovingSingleAxis(*p_perm, from, to);
 
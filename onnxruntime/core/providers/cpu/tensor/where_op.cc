@@ -4,8 +4,11 @@
 #include "core/providers/cpu/tensor/where_op.h"
 
 #include <algorithm>
+#include <array>
 #include <type_traits>
 
+#include "core/common/narrow.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/providers/cpu/math/element_wise_ops.h"  // for broadcast utilities
 
 namespace onnxruntime {
@@ -245,10 +248,82 @@ static void UntypedMerge(OpKernelContext& context,
 
   BroadcastLooper(broadcast_helper, functors);
 }
+
+// Select over condition, X and Y in a single pass with the MLAS element-wise engine. Returns false if the output
+// rank is not supported or the shapes are not compatible, in which case the caller should fall back to the
+// select/merge path, which also reports the broadcast error.
+template <typename T>
+static bool MlasSelect(OpKernelContext& context) {
+  const auto& condition = *context.Input<Tensor>(0);
+  const auto& X = *context.Input<Tensor>(1);
+  const auto& Y = *context.Input<Tensor>(2);
+  const std::array<gsl::span<const int64_t>, 3> input_dims{condition.Shape().GetDims(), X.Shape().GetDims(),
+                                                            Y.Shape().GetDims()};
+
+  size_t rank = 0;
+  for (const auto& dims : input_dims) {
+    rank = std::max(rank, dims.size());
+  }
+  if (rank > MLAS_ELTWISE_MAXIMUM_RANK) {
+    return false;
+  }
+
+  // inputs are right aligned against the output shape and broadcast dimensions have a stride of 0
+  TensorShapeVector output_dims(rank, 1);
+  for (const auto& dims : input_dims) {
+    const size_t offset = rank - dims.size();
+    for (size_t i = 0; i < dims.size(); ++i) {
+      int64_t& output_dim = output_dims[offset + i];
+      if (dims[i] != 1 && dims[i] != output_dim) {
+        if (output_dim != 1) {
+          return false;
+        }
+        output_dim = dims[i];
+      }
+    }
+  }
+
+  Tensor& output = *context.Output(0, TensorShape(output_dims));
+  if (output.Shape().Size() == 0) {
+    return true;
+  }
+
+  size_t output_shape[MLAS_ELTWISE_MAXIMUM_RANK];
+  size_t strides[3][MLAS_ELTWISE_MAXIMUM_RANK];
+
+  for (size_t i = 0; i < rank; ++i) {
+    output_shape[i] = narrow<size_t>(output_dims[i]);
+  }
+  for (size_t input = 0; input < 3; ++input) {
+    const auto& dims = input_dims[input];
+    const size_t offset = rank - dims.size();
+    std::fill_n(strides[input], offset, size_t{0});
+    size_t stride = 1;
+    for (size_t i = dims.size(); i > 0; --i) {
+      const size_t dim = narrow<size_t>(dims[i - 1]);
+      strides[input][offset + i - 1] = (dim == 1) ? 0 : stride;
+      stride *= dim;
+    }
+  }
+
+  MlasEltwiseSelect<T>(rank, output_shape,
+                       condition.Data<bool>(), strides[0],
+                       X.Data<T>(), strides[1],
+                       Y.Data<T>(), strides[2],
+                       output.MutableData<T>(),
+                       context.GetOperatorThreadPool());
+  return true;
+}
 }  // namespace
 
 template <typename T>
 Status Where<T>::Compute(OpKernelContext* context) const {
+  if constexpr (std::is_same_v<T, float> || std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>) {
+    if (MlasSelect<T>(*context)) {
+      return Status::OK();
+    }
+  }
+
   // we use a func pointer to save the overhead of std::function, so we can't capture tensor_allocator here
   const auto typed_tensor_allocation = [](const TensorAllocator& allocator,
                                           const TensorShape& shape) {
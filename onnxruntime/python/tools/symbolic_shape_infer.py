@@ -199,6 +199,7 @@ class SymbolicShapeInference:
             "Gelu": self._infer_Gelu,
             "GemmFastGelu": self._infer_GemmFastGelu,
             "GroupNorm": self._infer_GroupNorm,
+            "GroupQueryAttention": self._infer_GroupQueryAttention,
             "LayerNormalization": self._infer_LayerNormalization,
             "LongformerAttention": self._infer_LongformerAttention,
             "MultiHeadAttention": self._infer_MultiHeadAttention,
@@ -209,6 +210,7 @@ class SymbolicShapeInference:
             "RelativePositionBias": self._infer_RelativePositionBias,
             "RemovePadding": self._infer_RemovePadding,
             "RestorePadding": self._infer_RestorePadding,
+            "RotaryEmbedding": self._infer_RotaryEmbedding,
             "SimplifiedLayerNormalization": self._infer_LayerNormalization,
             "SkipLayerNormalization": self._infer_SkipLayerNormalization,
             "SkipSimplifiedLayerNormalization": self._infer_SkipLayerNormalization,
@@ -460,6 +462,8 @@ class SymbolicShapeInference:
             "PythonOp",
             "MultiHeadAttention",
             "GroupNorm",
+            "GroupQueryAttention",
+            "RotaryEmbedding",
             "BiasSplitGelu",
             "BiasAdd",
             "NhwcConv",
@@ -2302,6 +2306,30 @@ class SymbolicShapeInference:
                     vi = self.known_vi_[node.output[2]]
                     vi.CopyFrom(helper.make_tensor_value_info(vi.name, output_dtype, past_shape))
 
+    def _infer_GroupQueryAttention(self, node):  # noqa: N802
+        # Output 0 has shape (batch_size, sequence_length, hidden_size) like input 0 (query)
+        # Input 1 (key) has shape (batch_size, kv_sequence_length, kv_hidden_size)
+        # Input 3 (past_key) if exists has shape (batch_size, kv_num_heads, past_buffer_length, head_size)
+        # Output 1 and 2 (present) have shape (batch_size, kv_num_heads, present_sequence_length, head_size)
+        self._propagate_shape_and_type(node)
+
+        output_dtype = self.known_vi_[node.input[0]].type.tensor_type.elem_type
+        past_shape = self._try_get_shape(node, 3)
+        if past_shape is not None and len(past_shape) == 4:
+            present_shape = [*past_shape]
+        else:
+            key_shape = self._get_shape(node, 1)
+            kv_num_heads = get_attribute(node, "kv_num_heads")
+            if key_shape is None or len(key_shape) != 3 or not isinstance(key_shape[2], int):
+                return
+            present_shape = [key_shape[0], kv_num_heads, None, key_shape[2] // kv_num_heads]
+
+        for i in [1, 2]:
+            if len(node.output) > i and node.output[i]:
+                present_shape[2] = str(self._new_symbolic_dim_from_output(node, i, 2))
+                vi = self.known_vi_[node.output[i]]
+                vi.CopyFrom(helper.make_tensor_value_info(vi.name, output_dtype, present_shape))
+
     def _infer_FastGelu(self, node):  # noqa: N802
         self._propagate_shape_and_type(node)
 
@@ -2366,6 +2394,9 @@ class SymbolicShapeInference:
     def _infer_GroupNorm(self, node):  # noqa: N802
         self._propagate_shape_and_type(node)
 
+    def _infer_RotaryEmbedding(self, node):  # noqa: N802
+        self._propagate_shape_and_type(node)
+
     def _infer_BiasSplitGelu(self, node):  # noqa: N802
         input_shape = self._get_shape(node, 0)
         bias_shape = self._get_shape(node, 1)
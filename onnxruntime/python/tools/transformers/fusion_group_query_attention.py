@@ -0,0 +1,254 @@
+# -------------------------------------------------------------------------
+# Copyright (c) Microsoft Corporation.  All rights reserved.
+# Licensed under the MIT License.
+# --------------------------------------------------------------------------
+from logging import getLogger
+from typing import Dict, Optional, Tuple
+
+import numpy as np
+from fusion_base import Fusion
+from onnx import TensorProto, helper, numpy_helper
+from onnx_model import OnnxModel
+
+logger = getLogger(__name__)
+
+
+class FusionGroupQueryAttention(Fusion):
+    """
+    Fuse the attention of LLaMA models, where groups of query heads share a key and value head, into one
+    GroupQueryAttention node. The rotary embedding of query and key shall be fused first.
+    """
+
+    def __init__(self, model: OnnxModel):
+        super().__init__(model, "GroupQueryAttention", "Softmax")
+        # seqlens_k and total_sequence_length inputs, computed once for all the layers.
+        self.sequence_lengths: Optional[Tuple[str, str]] = None
+
+    def get_sequence_lengths(self) -> Optional[Tuple[str, str]]:
+        """
+        The past of all the sequences has the same length, which is the length of the attention mask minus the number
+        of new tokens:
+            seqlens_k = Cast(Expand(Shape(attention_mask)[1] - Shape(input_ids)[1], Shape(attention_mask)[0]))
+            total_sequence_length = Cast(Shape(attention_mask)[1])
+        """
+        if self.sequence_lengths is not None:
+            return self.sequence_lengths
+
+        if self.model.find_graph_input("attention_mask") is None or self.model.find_graph_input("input_ids") is None:
+            logger.debug("fuse_group_query_attention: graph inputs attention_mask and input_ids are required")
+            return None
+
+        for name, value in [("gqa_zero", 0), ("gqa_one", 1), ("gqa_two", 2)]:
+            if self.model.get_initializer(name) is None:
+                self.model.add_initializer(numpy_helper.from_array(np.array([value], dtype=np.int64), name))
+
+        nodes = [
+            helper.make_node("Shape", ["attention_mask"], ["attention_mask_shape"]),
+            helper.make_node("Shape", ["input_ids"], ["input_ids_shape"]),
+            helper.make_node("Slice", ["attention_mask_shape", "gqa_zero", "gqa_one", "gqa_zero"], ["batch_size"]),
+            helper.make_node("Slice", ["attention_mask_shape", "gqa_one", "gqa_two", "gqa_zero"], ["total_seq_len"]),
+            helper.make_node("Slice", ["input_ids_shape", "gqa_one", "gqa_two", "gqa_zero"], ["sequence_length"]),
+            helper.make_node("Sub", ["total_seq_len", "sequence_length"], ["past_sequence_length"]),
+            helper.make_node("Expand", ["past_sequence_length", "batch_size"], ["seqlens_k_int64"]),
+            helper.make_node("Cast", ["seqlens_k_int64"], ["seqlens_k"], to=TensorProto.INT32),
+            helper.make_node("Cast", ["total_seq_len"], ["total_sequence_length"], to=TensorProto.INT32),
+        ]
+        for node in nodes:
+            node.name = self.model.create_node_name(node.op_type, name_prefix="GroupQueryAttention_" + node.op_type)
+            self.nodes_to_add.append(node)
+            self.node_name_to_graph_name[node.name] = self.this_graph_name
+
+        self.sequence_lengths = ("seqlens_k", "total_sequence_length")
+        return self.sequence_lengths
+
+    def get_num_heads(self, reshape, head_size: int, output_name_to_node: Dict) -> Optional[int]:
+        """Number of heads of the projection before Reshape, from the shape or from the weight of the MatMul."""
+        shape = self.model.get_constant_value(reshape.input[1])
+        if shape is not None and shape.size == 4 and shape[2] > 0:
+            return int(shape[2])
+
+        projection = output_name_to_node.get(reshape.input[0])
+        if projection is not None and projection.op_type == "Add":
+            projection = self.model.match_parent(projection, "MatMul", None, output_name_to_node)
+        if projection is None or projection.op_type != "MatMul":
+            return None
+        weight = self.model.get_initializer(projection.input[1])
+        if weight is None or len(weight.dims) != 2 or weight.dims[1] % head_size != 0:
+            return None
+        return weight.dims[1] // head_size
+
+    def match_input(self, name: str, has_rotary: bool, output_name_to_node: Dict):
+        """
+        Match the query, or the present key or value, which is the key or value of the new tokens appended to the past:
+            [projection] --> Reshape --> Transpose --> RotaryEmbedding (not for value) --> Concat with past (optional)
+        Returns the nodes, the past, the rotary node and the projection.
+        """
+        nodes = []
+        past = ""
+        node = output_name_to_node.get(name)
+        if node is not None and node.op_type == "Concat":
+            if OnnxModel.get_node_attribute(node, "axis") != 2 or len(node.input) != 2:
+                return None
+            nodes.append(node)
+            past = node.input[0]
+            node = output_name_to_node.get(node.input[1])
+
+        rotary = None
+        if has_rotary:
+            if node is None or node.op_type != "RotaryEmbedding" or len(node.input) != 4:
+                return None
+            rotary = node
+            nodes.append(rotary)
+            node = output_name_to_node.get(rotary.input[0])
+
+        if node is None or node.op_type != "Transpose" or OnnxModel.get_node_attribute(node, "perm") != [0, 2, 1, 3]:
+            return None
+        reshape = self.model.get_parent(node, 0, output_name_to_node)
+        if reshape is None or reshape.op_type != "Reshape":
+            return None
+        nodes.extend([node, reshape])
+        return nodes, past, rotary, reshape
+
+    def match_repeat_kv(self, node, input_index: int, output_name_to_node: Dict):
+        """
+        Match the repeat of each key or value head to its group of query heads:
+            [present] --> Unsqueeze (axis 2) --> Expand --> Reshape
+        Returns the nodes (empty when each head has its own query head) and the present.
+        """
+        repeat_nodes = self.model.match_parent_path(
+            node, ["Reshape", "Expand", "Unsqueeze"], [input_index, 0, 0], output_name_to_node
+        )
+        if repeat_nodes is None:
+            return [], node.input[input_index]
+
+        unsqueeze = repeat_nodes[-1]
+        axes = OnnxModel.get_node_attribute(unsqueeze, "axes")
+        if axes is None and len(unsqueeze.input) > 1:
+            value = self.model.get_constant_value(unsqueeze.input[1])
+            axes = None if value is None else value.flatten().tolist()
+        if axes != [2]:
+            return None, None
+        return repeat_nodes, unsqueeze.input[0]
+
+    def fuse(self, softmax_node, input_name_to_nodes: Dict, output_name_to_node: Dict):
+        """
+        Fuse the attention of LLaMA exported from PyTorch:
+                                                         [attention mask]
+                                                                |
+            q --> MatMul --> Div (sqrt(head_size)) --> Add <----+
+                    ^                                   |
+            repeat_kv(k) --> Transpose (0, 1, 3, 2)   Softmax --> MatMul --> Transpose (0, 2, 1, 3) --> Reshape
+                                                                    ^
+                                                               repeat_kv(v)
+        where q is the rotated query, and k and v are the present key and value. repeat_kv is Unsqueeze, Expand and
+        Reshape, or nothing when num_heads equals kv_num_heads. The attention mask is assumed to be causal without
+        padding, so that the past of every sequence has the length of the attention mask minus the new tokens.
+        """
+        qk_nodes = self.model.match_parent_path(
+            softmax_node, ["Add", "Div", "MatMul"], [0, None, 0], output_name_to_node
+        )
+        if qk_nodes is None:
+            qk_nodes = self.model.match_parent_path(
+                softmax_node, ["Add", "Mul", "MatMul"], [0, None, 0], output_name_to_node
+            )
+            if qk_nodes is None:
+                return
+        add_mask, scale_node, matmul_qk = qk_nodes
+
+        scale_value = self.model.get_constant_value(scale_node.input[1])
+        if scale_value is None or scale_value.size != 1:
+            return
+        scale = 1.0 / scale_value.item() if scale_node.op_type == "Div" else scale_value.item()
+
+        k_transpose = self.model.match_parent(matmul_qk, "Transpose", 1, output_name_to_node)
+        if k_transpose is None or OnnxModel.get_node_attribute(k_transpose, "perm") != [0, 1, 3, 2]:
+            return
+
+        children = input_name_to_nodes.get(softmax_node.output[0], [])
+        if len(children) != 1 or children[0].op_type != "MatMul" or children[0].input[0] != softmax_node.output[0]:
+            return
+        matmul_qkv = children[0]
+
+        output_nodes = []
+        node = matmul_qkv
+        for op_type in ["Transpose", "Reshape"]:
+            children = input_name_to_nodes.get(node.output[0], [])
+            if len(children) != 1 or children[0].op_type != op_type:
+                return
+            node = children[0]
+            output_nodes.append(node)
+        output_transpose, output_reshape = output_nodes
+        if OnnxModel.get_node_attribute(output_transpose, "perm") != [0, 2, 1, 3]:
+            return
+
+        k_repeat, k_present = self.match_repeat_kv(k_transpose, 0, output_name_to_node)
+        v_repeat, v_present = self.match_repeat_kv(matmul_qkv, 1, output_name_to_node)
+        if k_repeat is None or v_repeat is None:
+            return
+
+        q_match = self.match_input(matmul_qk.input[0], True, output_name_to_node)
+        k_match = self.match_input(k_present, True, output_name_to_node)
+        v_match = self.match_input(v_present, False, output_name_to_node)
+        if q_match is None or k_match is None or v_match is None:
+            return
+        q_nodes, q_past, q_rotary, q_reshape = q_match
+        k_nodes, past_key, k_rotary, k_reshape = k_match
+        v_nodes, past_value, _, v_reshape = v_match
+        if q_past or bool(past_key) != bool(past_value):
+            return
+
+        cos_cache = self.model.get_initializer(q_rotary.input[2])
+        if cos_cache is None or len(cos_cache.dims) != 2 or q_rotary.input[1:] != k_rotary.input[1:]:
+            return
+        head_size = cos_cache.dims[1] * 2
+        num_heads = self.get_num_heads(q_reshape, head_size, output_name_to_node)
+        kv_num_heads = self.get_num_heads(k_reshape, head_size, output_name_to_node)
+        if num_heads is None or kv_num_heads is None or num_heads % kv_num_heads != 0:
+            logger.debug("fuse_group_query_attention: failed to detect num_heads and kv_num_heads")
+            return
+        if (num_heads != kv_num_heads) != (len(k_repeat) > 0 and len(v_repeat) > 0):
+            return
+
+        sequence_lengths = self.get_sequence_lengths()
+        if sequence_lengths is None:
+            return
+
+        # Rotate query and key in the (batch_size, sequence_length, hidden_size) layout of the projections.
+        rotated = []
+        for rotary, reshape in [(q_rotary, q_reshape), (k_rotary, k_reshape)]:
+            rotary_node = helper.make_node(
+                "RotaryEmbedding",
+                inputs=[reshape.input[0], *rotary.input[1:]],
+                outputs=[reshape.input[0] + "_rotary"],
+                name=self.model.create_node_name("RotaryEmbedding", name_prefix="RotaryEmbedding"),
+            )
+            rotary_node.domain = "com.microsoft"
+            rotary_node.attribute.extend(rotary.attribute)
+            self.nodes_to_add.append(rotary_node)
+            self.node_name_to_graph_name[rotary_node.name] = self.this_graph_name
+            rotated.append(rotary_node.output[0])
+
+        gqa_node = helper.make_node(
+            "GroupQueryAttention",
+            inputs=[rotated[0], rotated[1], v_reshape.input[0], past_key, past_value, *sequence_lengths],
+            outputs=[output_reshape.output[0], k_present, v_present],
+            name=self.model.create_node_name("GroupQueryAttention", name_prefix="GroupQueryAttention"),
+        )
+        gqa_node.domain = "com.microsoft"
+        gqa_node.attribute.extend([helper.make_attribute("num_heads", num_heads)])
+        gqa_node.attribute.extend([helper.make_attribute("kv_num_heads", kv_num_heads)])
+        if abs(scale - 1.0 / np.sqrt(head_size)) > 1e-6:
+            gqa_node.attribute.extend([helper.make_attribute("scale", scale)])
+        self.nodes_to_add.append(gqa_node)
+        self.node_name_to_graph_name[gqa_node.name] = self.this_graph_name
+
+        self.nodes_to_remove.extend([softmax_node, add_mask, scale_node, matmul_qk, k_transpose, matmul_qkv])
+        self.nodes_to_remove.extend(output_nodes)
+        self.nodes_to_remove.extend(k_repeat)
+        self.nodes_to_remove.extend(v_repeat)
+        self.nodes_to_remove.extend(q_nodes)
+        self.nodes_to_remove.extend(k_nodes)
+        self.nodes_to_remove.extend(v_nodes)
+
+        # The attention mask and the shapes of the Reshape nodes are no longer used, use prune graph to clear them.
+        self.prune_graph = True
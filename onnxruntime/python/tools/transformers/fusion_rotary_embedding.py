@@ -0,0 +1,148 @@
+# -------------------------------------------------------------------------
+# Copyright (c) Microsoft Corporation.  All rights reserved.
+# Licensed under the MIT License.
+# --------------------------------------------------------------------------
+from logging import getLogger
+from typing import Dict, Optional
+
+import numpy as np
+from fusion_base import Fusion
+from onnx import helper, numpy_helper
+from onnx_model import OnnxModel
+
+logger = getLogger(__name__)
+
+
+class FusionRotaryEmbeddings(Fusion):
+    def __init__(self, model: OnnxModel):
+        super().__init__(model, "RotaryEmbedding", "Add")
+
+    def get_axes(self, node) -> Optional[list]:
+        """Axes of Squeeze or Unsqueeze from attribute (before opset 13) or input."""
+        for attr in node.attribute:
+            if attr.name == "axes":
+                return list(helper.get_attribute_value(attr))
+        if len(node.input) > 1:
+            value = self.model.get_constant_value(node.input[1])
+            if value is not None:
+                return value.flatten().tolist()
+        return None
+
+    def get_half_cache(self, cache_input: str, output_name_to_node: Dict):
+        """
+        Match the lookup of the cached table of cosine or sine in the positions:
+            table (1, 1, max_sequence_length, head_size) --> Slice --> Squeeze --> Squeeze --> Gather --> Unsqueeze
+                                                                                                 ^
+                                                                                           position_ids
+        The table repeats its first half, and the first half is returned with the position ids.
+        The Slice that keeps the first sequence_length positions and the Squeeze nodes are optional.
+        """
+        unsqueeze = output_name_to_node.get(cache_input)
+        if unsqueeze is None or unsqueeze.op_type != "Unsqueeze" or self.get_axes(unsqueeze) != [1]:
+            return None, None
+
+        gather = self.model.get_parent(unsqueeze, 0, output_name_to_node)
+        if gather is None or gather.op_type != "Gather":
+            return None, None
+        position_ids = gather.input[1]
+
+        # Positions are looked up in the rows of the table, so only ops that keep the rows are allowed on the way.
+        table_name = gather.input[0]
+        table = self.model.get_constant_value(table_name)
+        while table is None:
+            node = output_name_to_node.get(table_name)
+            if node is None or node.op_type not in ["Squeeze", "Slice", "Cast"]:
+                return None, None
+            if node.op_type == "Slice":
+                starts = self.model.get_constant_value(node.input[1])
+                if starts is None or np.any(starts != 0):
+                    return None, None
+            table_name = node.input[0]
+            table = self.model.get_constant_value(table_name)
+
+        if table.ndim < 2 or np.prod(table.shape[:-2]) != 1 or table.shape[-1] % 2 != 0:
+            return None, None
+        head_size = table.shape[-1]
+        table = table.reshape(-1, head_size)
+        half_head_size = head_size // 2
+        if not np.array_equal(table[:, :half_head_size], table[:, half_head_size:]):
+            logger.debug("fuse_rotary_embedding: table %s does not repeat its first half", table_name)
+            return None, None
+
+        cache_name = table_name + "_half"
+        if self.model.get_initializer(cache_name) is None:
+            cache = numpy_helper.from_array(table[:, :half_head_size].astype(np.float32), cache_name)
+            self.model.add_initializer(cache, self.this_graph_name)
+        return cache_name, position_ids
+
+    def fuse(self, add_node, input_name_to_nodes: Dict, output_name_to_node: Dict):
+        """
+        Fuse the rotary embedding of GPT-NeoX and LLaMA models exported from PyTorch into one RotaryEmbedding node:
+                     +--------------------------------------------------+
+                     |                                                  v
+            [root] --+--> Slice (second half) --> Neg --> Concat --> Mul (sin) --> Add --> [output]
+                     |                                      ^                        ^
+                     +--> Slice (first half) ---------------+                        |
+                     |                                                               |
+                     +--------------------------------------------------> Mul (cos) -+
+        The root has shape (batch_size, num_heads, sequence_length, head_size).
+        """
+        for i in range(2):
+            rotate_nodes = self.model.match_parent_path(
+                add_node, ["Mul", "Concat", "Neg", "Slice"], [i, None, 0, 0], output_name_to_node
+            )
+            if rotate_nodes is not None:
+                cos_mul = self.model.get_parent(add_node, 1 - i, output_name_to_node)
+                break
+        else:
+            return
+
+        sin_mul, concat, neg, slice_second = rotate_nodes
+        if cos_mul is None or cos_mul.op_type != "Mul" or len(concat.input) != 2 or concat.input[0] != neg.output[0]:
+            return
+
+        slice_first = self.model.get_parent(concat, 1, output_name_to_node)
+        root = slice_second.input[0]
+        if slice_first is None or slice_first.op_type != "Slice" or slice_first.input[0] != root:
+            return
+        if root not in cos_mul.input:
+            return
+
+        sin_input = sin_mul.input[1 - self.model.input_index(concat.output[0], sin_mul)]
+        cos_input = cos_mul.input[1 - self.model.input_index(root, cos_mul)]
+        cos_cache, cos_positions = self.get_half_cache(cos_input, output_name_to_node)
+        sin_cache, sin_positions = self.get_half_cache(sin_input, output_name_to_node)
+        if cos_cache is None or sin_cache is None or cos_positions != sin_positions:
+            return
+
+        # The halves that are rotated shall be the halves of the head.
+        half_head_size = self.model.get_initializer(cos_cache).dims[1]
+        first_ends = self.model.get_constant_value(slice_first.input[2])
+        second_starts = self.model.get_constant_value(slice_second.input[1])
+        if first_ends is None or second_starts is None or first_ends.size != 1 or second_starts.size != 1:
+            return
+        if first_ends.item() != half_head_size or second_starts.item() != half_head_size:
+            return
+        for slice_node in [slice_first, slice_second]:
+            axes = self.model.get_constant_value(slice_node.input[3]) if len(slice_node.input) > 3 else None
+            if axes is None or axes.size != 1 or axes.item() not in [-1, 3]:
+                return
+
+        subgraph_nodes = [add_node, cos_mul, sin_mul, concat, neg, slice_first, slice_second]
+        if self.model.is_safe_to_fuse_nodes(subgraph_nodes, add_node.output, input_name_to_nodes, output_name_to_node):
+            self.nodes_to_remove.extend(subgraph_nodes)
+        else:
+            self.nodes_to_remove.append(add_node)
+
+        # The lookup of the tables is shared by the query and key of a layer, use prune graph to clear it.
+        self.prune_graph = True
+
+        rotary_node = helper.make_node(
+            "RotaryEmbedding",
+            inputs=[root, cos_positions, cos_cache, sin_cache],
+            outputs=[add_node.output[0]],
+            name=self.model.create_node_name("RotaryEmbedding", name_prefix="RotaryEmbedding"),
+        )
+        rotary_node.domain = "com.microsoft"
+        self.nodes_to_add.append(rotary_node)
+        self.node_name_to_graph_name[rotary_node.name] = self.this_graph_name
@@ -0,0 +1,51 @@
+# -------------------------------------------------------------------------
+# Copyright (c) Microsoft Corporation.  All rights reserved.
+# Licensed under the MIT License.
+# --------------------------------------------------------------------------
+from logging import getLogger
+
+from fusion_group_query_attention import FusionGroupQueryAttention
+from fusion_rotary_embedding import FusionRotaryEmbeddings
+from onnx import ModelProto
+from onnx_model_bert import BertOnnxModel
+from onnx_model_t5 import FusionSimplifiedLayerNormalization, FusionSkipSimplifiedLayerNormalization
+
+logger = getLogger(__name__)
+
+
+class LlamaOnnxModel(BertOnnxModel):
+    def __init__(self, model: ModelProto, num_heads: int = 0, hidden_size: int = 0):
+        super().__init__(model, num_heads, hidden_size)
+        self.rotary_embedding_fusion = FusionRotaryEmbeddings(self)
+        self.group_query_attention_fusion = FusionGroupQueryAttention(self)
+        self.layer_norm_fusion = FusionSimplifiedLayerNormalization(self)
+        self.skip_layer_norm_fusion = FusionSkipSimplifiedLayerNormalization(self)
+
+    def fuse_attention(self):
+        # The attention fusion matches the rotary embedding of query and key, so it runs after rotary fusion.
+        self.rotary_embedding_fusion.apply()
+        self.group_query_attention_fusion.apply()
+
+    def fuse_layer_norm(self):
+        self.layer_norm_fusion.apply()
+
+    def fuse_skip_layer_norm(self):
+        self.skip_layer_norm_fusion.apply()
+
+    def get_fused_operator_statistics(self):
+        """
+        Returns node count of fused operators.
+        """
+        op_count = {}
+        ops = [
+            "GroupQueryAttention",
+            "RotaryEmbedding",
+            "SimplifiedLayerNormalization",
+            "SkipSimplifiedLayerNormalization",
+        ]
+        for op in ops:
+            nodes = self.get_nodes_by_op_type(op)
+            op_count[op] = len(nodes)
+
+        logger.info(f"Optimized operators:{op_count}")
+        return op_count
@@ -33,6 +33,7 @@ from onnx_model_bert_keras import BertOnnxModelKeras
 from onnx_model_bert_tf import BertOnnxModelTF
 from onnx_model_clip import ClipOnnxModel
 from onnx_model_gpt2 import Gpt2OnnxModel
+from onnx_model_llama import LlamaOnnxModel
 from onnx_model_t5 import T5OnnxModel
 from onnx_model_tnlr import TnlrOnnxModel
 from onnx_model_unet import UnetOnnxModel
@@ -50,6 +51,7 @@ MODEL_TYPES = {
     "gpt2": (Gpt2OnnxModel, "pytorch", 1),
     "gpt2_tf": (Gpt2OnnxModel, "tf2onnx", 0),  # might add a class for GPT2OnnxModel for TF later.
     "gpt_neox": (BertOnnxModel, "pytorch", 0),  # GPT-NeoX
+    "llama": (LlamaOnnxModel, "pytorch", 0),  # LLaMA with grouped-query attention
     "swin": (BertOnnxModel, "pytorch", 1),
     "tnlr": (TnlrOnnxModel, "pytorch", 1),
     "t5": (T5OnnxModel, "pytorch", 2),
@@ -462,7 +464,8 @@ def _parse_arguments():
         "--convert_to_packing_mode",
         required=False,
         action="store_true",
-        help="convert the model to packing mode. Only available for BERT like model",
+        help="convert the model to packing mode that skips the padding tokens. Only available for BERT like model. "
+        "The packed operators run on both CPU and CUDA execution providers",
     )
     parser.set_defaults(convert_to_packing_mode=False)
 
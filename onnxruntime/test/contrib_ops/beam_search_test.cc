@@ -2,9 +2,13 @@
 // Licensed under the MIT License.
 
 #include <memory>
+#include <random>
+#include <string>
 #include <vector>
 #include "gtest/gtest.h"
 #include "core/common/gsl.h"
+#include "core/graph/constants.h"
+#include "core/graph/onnx_protobuf.h"
 #include "core/session/onnxruntime_cxx_api.h"
 #include "test/common/cuda_op_test_utils.h"
 
@@ -376,5 +380,317 @@ TEST(BeamSearchTest, GptBeamSearchFp16_VocabPadded) {
   }
 }
 
+namespace {
+
+// Dimensions of the tiny T5 model built below.
+constexpr int64_t kT5NumHeads = 2;
+constexpr int64_t kT5HeadSize = 4;
+constexpr int64_t kT5HiddenSize = kT5NumHeads * kT5HeadSize;
+constexpr int64_t kT5VocabSize = 12;
+
+// Adds a graph input or output. A negative dimension is left unknown.
+void AddTensorValueInfo(ONNX_NAMESPACE::ValueInfoProto* value_info, const std::string& name, int32_t elem_type,
+                        const std::vector<int64_t>& dims) {
+  value_info->set_name(name);
+  auto* tensor_type = value_info->mutable_type()->mutable_tensor_type();
+  tensor_type->set_elem_type(elem_type);
+  auto* shape = tensor_type->mutable_shape();
+  for (int64_t dim : dims) {
+    auto* dimension = shape->add_dim();
+    if (dim >= 0) {
+      dimension->set_dim_value(dim);
+    }
+  }
+}
+
+ONNX_NAMESPACE::NodeProto* AddNode(ONNX_NAMESPACE::GraphProto& graph, const std::string& op_type,
+                                   const std::vector<std::string>& inputs, const std::vector<std::string>& outputs,
+                                   const std::string& domain = "") {
+  auto* node = graph.add_node();
+  node->set_op_type(op_type);
+  node->set_domain(domain);
+  node->set_name(outputs[0] + "_" + op_type);
+  for (const auto& input : inputs) {
+    node->add_input(input);
+  }
+  for (const auto& output : outputs) {
+    node->add_output(output);
+  }
+  return node;
+}
+
+void AddIntAttribute(ONNX_NAMESPACE::NodeProto* node, const std::string& name, int64_t value) {
+  auto* attribute = node->add_attribute();
+  attribute->set_name(name);
+  attribute->set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_INT);
+  attribute->set_i(value);
+}
+
+void AddFloatInitializer(ONNX_NAMESPACE::GraphProto& graph, const std::string& name,
+                         const std::vector<int64_t>& dims, std::mt19937& generator) {
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  auto* tensor = graph.add_initializer();
+  tensor->set_name(name);
+  tensor->set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  int64_t size = 1;
+  for (int64_t dim : dims) {
+    tensor->add_dims(dim);
+    size *= dim;
+  }
+  for (int64_t i = 0; i < size; i++) {
+    tensor->add_float_data(distribution(generator));
+  }
+}
+
+void AddInt64Initializer(ONNX_NAMESPACE::GraphProto& graph, const std::string& name,
+                         const std::vector<int64_t>& values) {
+  auto* tensor = graph.add_initializer();
+  tensor->set_name(name);
+  tensor->set_data_type(ONNX_NAMESPACE::TensorProto_DataType_INT64);
+  tensor->add_dims(static_cast<int64_t>(values.size()));
+  for (int64_t value : values) {
+    tensor->add_int64_data(value);
+  }
+}
+
+// Adds the weights shared by the encoder and decoder subgraphs. They are generated from the same seed, so both
+// subgraphs and both variants of the decoder see the same values.
+void AddT5Weights(ONNX_NAMESPACE::GraphProto& graph) {
+  std::mt19937 generator(17);
+  AddFloatInitializer(graph, "encoder_embedding", {kT5VocabSize, kT5HiddenSize}, generator);
+  AddFloatInitializer(graph, "decoder_embedding", {kT5VocabSize, kT5HiddenSize}, generator);
+  for (const char* name : {"cross_key_weight", "cross_value_weight", "self_query_weight", "self_key_weight",
+                           "self_value_weight", "cross_query_weight"}) {
+    AddFloatInitializer(graph, name, {kT5HiddenSize, kT5HiddenSize}, generator);
+  }
+  AddFloatInitializer(graph, "logits_weight", {kT5HiddenSize, kT5VocabSize}, generator);
+  AddInt64Initializer(graph, "bnsh_shape", {0, 0, kT5NumHeads, kT5HeadSize});
+}
+
+// Projects hidden states (B, S, hidden_size) to the (B, num_heads, S, head_size) layout of the past state.
+void AddProjectionToBNSH(ONNX_NAMESPACE::GraphProto& graph, const std::string& input, const std::string& weight,
+                         const std::string& output) {
+  AddNode(graph, "MatMul", {input, weight}, {output + "_bsd"});
+  AddNode(graph, "Reshape", {output + "_bsd", "bnsh_shape"}, {output + "_bsnh"});
+  auto* transpose = AddNode(graph, "Transpose", {output + "_bsnh"}, {output});
+  auto* perm = transpose->add_attribute();
+  perm->set_name("perm");
+  perm->set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_INTS);
+  for (int64_t axis : {0, 2, 1, 3}) {
+    perm->add_ints(axis);
+  }
+}
+
+ONNX_NAMESPACE::GraphProto CreateT5EncoderGraph() {
+  constexpr auto int32_type = ONNX_NAMESPACE::TensorProto_DataType_INT32;
+  constexpr auto float_type = ONNX_NAMESPACE::TensorProto_DataType_FLOAT;
+
+  ONNX_NAMESPACE::GraphProto graph;
+  graph.set_name("encoder");
+  AddT5Weights(graph);
+  AddTensorValueInfo(graph.add_input(), "encoder_input_ids", int32_type, {-1, -1});
+  AddTensorValueInfo(graph.add_input(), "encoder_attention_mask", int32_type, {-1, -1});
+  AddTensorValueInfo(graph.add_input(), "decoder_input_ids", int32_type, {-1, 1});
+
+  AddNode(graph, "Gather", {"encoder_embedding", "encoder_input_ids"}, {"encoder_hidden_states"});
+  AddProjectionToBNSH(graph, "encoder_hidden_states", "cross_key_weight", "present_key_cross_0");
+  AddProjectionToBNSH(graph, "encoder_hidden_states", "cross_value_weight", "present_value_cross_0");
+  AddNode(graph, "Gather", {"decoder_embedding", "decoder_input_ids"}, {"decoder_hidden_states"});
+  AddProjectionToBNSH(graph, "decoder_hidden_states", "self_key_weight", "present_key_self_0");
+  AddProjectionToBNSH(graph, "decoder_hidden_states", "self_value_weight", "present_value_self_0");
+  AddNode(graph, "MatMul", {"decoder_hidden_states", "logits_weight"}, {"logits"});
+
+  AddTensorValueInfo(graph.add_output(), "logits", float_type, {-1, 1, kT5VocabSize});
+  AddTensorValueInfo(graph.add_output(), "encoder_hidden_states", float_type, {-1, -1, kT5HiddenSize});
+  for (const char* name : {"present_key_self_0", "present_value_self_0", "present_key_cross_0",
+                           "present_value_cross_0"}) {
+    AddTensorValueInfo(graph.add_output(), name, float_type, {-1, kT5NumHeads, -1, kT5HeadSize});
+  }
+  return graph;
+}
+
+// The decoder runs self-attention over the past state and cross-attention over the encoder output. With
+// use_decoder_masked_attention, it uses DecoderMaskedMultiHeadAttention that updates the past state in place and
+// reads it through the cache indirection. Otherwise it uses MultiHeadAttention that concatenates the past state.
+ONNX_NAMESPACE::GraphProto CreateT5DecoderGraph(bool use_decoder_masked_attention) {
+  constexpr auto int32_type = ONNX_NAMESPACE::TensorProto_DataType_INT32;
+  constexpr auto float_type = ONNX_NAMESPACE::TensorProto_DataType_FLOAT;
+
+  ONNX_NAMESPACE::GraphProto graph;
+  graph.set_name("decoder");
+  AddT5Weights(graph);
+  AddTensorValueInfo(graph.add_input(), "input_ids", int32_type, {-1, 1});
+  AddTensorValueInfo(graph.add_input(), "encoder_attention_mask", int32_type, {-1, -1});
+  for (const char* name : {"past_key_self_0", "past_value_self_0", "past_key_cross_0", "past_value_cross_0"}) {
+    AddTensorValueInfo(graph.add_input(), name, float_type, {-1, kT5NumHeads, -1, kT5HeadSize});
+  }
+  if (use_decoder_masked_attention) {
+    AddTensorValueInfo(graph.add_input(), "past_sequence_length", int32_type, {1});
+    AddTensorValueInfo(graph.add_input(), "beam_width", int32_type, {1});
+    AddTensorValueInfo(graph.add_input(), "cache_indirection", int32_type, {-1, -1, -1});
+  }
+
+  AddNode(graph, "Gather", {"decoder_embedding", "input_ids"}, {"hidden_states"});
+  AddNode(graph, "MatMul", {"hidden_states", "self_query_weight"}, {"self_query"});
+  AddNode(graph, "MatMul", {"hidden_states", "self_key_weight"}, {"self_key"});
+  AddNode(graph, "MatMul", {"hidden_states", "self_value_weight"}, {"self_value"});
+  ONNX_NAMESPACE::NodeProto* self_attention = nullptr;
+  if (use_decoder_masked_attention) {
+    self_attention = AddNode(graph, "DecoderMaskedMultiHeadAttention",
+                             {"self_query", "self_key", "self_value", "", "", "past_key_self_0", "past_value_self_0",
+                              "past_sequence_length", "beam_width", "cache_indirection"},
+                             {"self_attention", "present_key_self_0", "present_value_self_0"}, kMSDomain);
+    AddIntAttribute(self_attention, "past_present_share_buffer", 1);
+  } else {
+    self_attention = AddNode(graph, "MultiHeadAttention",
+                             {"self_query", "self_key", "self_value", "", "", "", "past_key_self_0",
+                              "past_value_self_0"},
+                             {"self_attention", "present_key_self_0", "present_value_self_0"}, kMSDomain);
+  }
+  AddIntAttribute(self_attention, "num_heads", kT5NumHeads);
+  AddNode(graph, "Add", {"hidden_states", "self_attention"}, {"self_attention_output"});
+
+  AddNode(graph, "MatMul", {"self_attention_output", "cross_query_weight"}, {"cross_query"});
+  ONNX_NAMESPACE::NodeProto* cross_attention = nullptr;
+  if (use_decoder_masked_attention) {
+    cross_attention = AddNode(graph, "DecoderMaskedMultiHeadAttention",
+                              {"cross_query", "past_key_cross_0", "past_value_cross_0", "encoder_attention_mask"},
+                              {"cross_attention"}, kMSDomain);
+  } else {
+    cross_attention = AddNode(graph, "MultiHeadAttention",
+                              {"cross_query", "past_key_cross_0", "past_value_cross_0", "", "encoder_attention_mask"},
+                              {"cross_attention"}, kMSDomain);
+  }
+  AddIntAttribute(cross_attention, "num_heads", kT5NumHeads);
+  AddNode(graph, "Add", {"self_attention_output", "cross_attention"}, {"cross_attention_output"});
+  AddNode(graph, "MatMul", {"cross_attention_output", "logits_weight"}, {"logits"});
+
+  AddTensorValueInfo(graph.add_output(), "logits", float_type, {-1, 1, kT5VocabSize});
+  for (const char* name : {"present_key_self_0", "present_value_self_0"}) {
+    AddTensorValueInfo(graph.add_output(), name, float_type, {-1, kT5NumHeads, -1, kT5HeadSize});
+  }
+  return graph;
+}
+
+// Serializes a model with a T5 BeamSearch node.
+std::string CreateT5BeamSearchModel(bool use_decoder_masked_attention) {
+  constexpr auto int32_type = ONNX_NAMESPACE::TensorProto_DataType_INT32;
+  constexpr auto float_type = ONNX_NAMESPACE::TensorProto_DataType_FLOAT;
+
+  ONNX_NAMESPACE::ModelProto model;
+  model.set_ir_version(ONNX_NAMESPACE::IR_VERSION);
+  auto* onnx_opset = model.add_opset_import();
+  onnx_opset->set_domain(kOnnxDomain);
+  onnx_opset->set_version(17);
+  auto* ms_opset = model.add_opset_import();
+  ms_opset->set_domain(kMSDomain);
+  ms_opset->set_version(1);
+
+  auto& graph = *model.mutable_graph();
+  graph.set_name("t5_beam_search");
+  AddTensorValueInfo(graph.add_input(), "input_ids", int32_type, {-1, -1});
+  for (const char* name : {"max_length", "min_length", "num_beams", "num_return_sequences"}) {
+    AddTensorValueInfo(graph.add_input(), name, int32_type, {1});
+  }
+  for (const char* name : {"length_penalty", "repetition_penalty"}) {
+    AddTensorValueInfo(graph.add_input(), name, float_type, {1});
+  }
+
+  auto* beam_search = AddNode(graph, "BeamSearch",
+                              {"input_ids", "max_length", "min_length", "num_beams", "num_return_sequences",
+                               "length_penalty", "repetition_penalty"},
+                              {"sequences", "sequences_scores"}, kMSDomain);
+  AddIntAttribute(beam_search, "model_type", 1);
+  AddIntAttribute(beam_search, "eos_token_id", 1);
+  AddIntAttribute(beam_search, "pad_token_id", 0);
+  AddIntAttribute(beam_search, "decoder_start_token_id", 2);
+  AddIntAttribute(beam_search, "early_stopping", 0);
+  auto* encoder = beam_search->add_attribute();
+  encoder->set_name("encoder");
+  encoder->set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_GRAPH);
+  *encoder->mutable_g() = CreateT5EncoderGraph();
+  auto* decoder = beam_search->add_attribute();
+  decoder->set_name("decoder");
+  decoder->set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_GRAPH);
+  *decoder->mutable_g() = CreateT5DecoderGraph(use_decoder_masked_attention);
+
+  AddTensorValueInfo(graph.add_output(), "sequences", int32_type, {-1, -1, -1});
+  AddTensorValueInfo(graph.add_output(), "sequences_scores", float_type, {-1, -1});
+
+  std::string model_data;
+  ORT_ENFORCE(model.SerializeToString(&model_data));
+  return model_data;
+}
+
+}  // namespace
+
+// DecoderMaskedMultiHeadAttention keeps the past state of every beam in place and follows the cache indirection,
+// so beam search shall produce the same sequences as with the past state reordered after each step.
+TEST(BeamSearchTest, T5BeamSearchSharedBufferDecoderMaskedAttention_CPU) {
+  std::vector<int64_t> input_ids_shape{2, 5};
+  std::vector<int32_t> input_ids{
+      0, 0, 5, 9, 3,
+      4, 7, 11, 6, 8};
+
+  std::vector<int64_t> parameter_shape{1};
+  std::vector<int32_t> max_length{10};
+  std::vector<int32_t> min_length{1};
+  std::vector<int32_t> num_beams{3};
+  std::vector<int32_t> num_return_sequences{2};
+  std::vector<float> length_penalty{1.0f};
+  std::vector<float> repetition_penalty{1.0f};
+
+  Ort::MemoryInfo info("Cpu", OrtDeviceAllocator, 0, OrtMemTypeDefault);
+  const char* input_names[] = {"input_ids", "max_length", "min_length", "num_beams", "num_return_sequences",
+                               "length_penalty", "repetition_penalty"};
+  const char* const output_names[] = {"sequences", "sequences_scores"};
+
+  std::vector<std::vector<int32_t>> sequences;
+  std::vector<std::vector<float>> sequences_scores;
+  for (bool use_decoder_masked_attention : {false, true}) {
+    std::vector<Ort::Value> ort_inputs;
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, input_ids.data(), input_ids.size(), input_ids_shape.data(), input_ids_shape.size()));
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, max_length.data(), max_length.size(), parameter_shape.data(), parameter_shape.size()));
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, min_length.data(), min_length.size(), parameter_shape.data(), parameter_shape.size()));
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, num_beams.data(), num_beams.size(), parameter_shape.data(), parameter_shape.size()));
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, num_return_sequences.data(), num_return_sequences.size(), parameter_shape.data(),
+        parameter_shape.size()));
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, length_penalty.data(), length_penalty.size(), parameter_shape.data(), parameter_shape.size()));
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, repetition_penalty.data(), repetition_penalty.size(), parameter_shape.data(), parameter_shape.size()));
+
+    std::string model_data = CreateT5BeamSearchModel(use_decoder_masked_attention);
+    Ort::SessionOptions session_options;
+    Ort::Session session(*ort_env, model_data.data(), model_data.size(), session_options);
+    auto ort_outputs = session.Run(Ort::RunOptions{}, input_names, ort_inputs.data(), ort_inputs.size(),
+                                   output_names, 2);
+    ASSERT_EQ(ort_outputs.size(), 2U);
+
+    const auto& output_sequences = ort_outputs[0];
+    ASSERT_EQ(output_sequences.GetTensorTypeAndShapeInfo().GetShape(),
+              (std::vector<int64_t>{input_ids_shape[0], num_return_sequences[0], max_length[0]}));
+    const auto* sequences_data = output_sequences.GetTensorData<int32_t>();
+    sequences.emplace_back(sequences_data,
+                           sequences_data + output_sequences.GetTensorTypeAndShapeInfo().GetElementCount());
+
+    const auto& output_scores = ort_outputs[1];
+    const auto* scores_data = output_scores.GetTensorData<float>();
+    sequences_scores.emplace_back(scores_data,
+                                  scores_data + output_scores.GetTensorTypeAndShapeInfo().GetElementCount());
+  }
+
+  ASSERT_EQ(sequences[0], sequences[1]);
+  ASSERT_EQ(sequences_scores[0].size(), sequences_scores[1].size());
+  for (size_t i = 0; i < sequences_scores[0].size(); i++) {
+    EXPECT_NEAR(sequences_scores[0][i], sequences_scores[1][i], 1e-4f);
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
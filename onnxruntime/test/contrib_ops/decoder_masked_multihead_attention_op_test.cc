@@ -3,19 +3,22 @@
 
 #include "core/platform/env_var_utils.h"
 #include "gtest/gtest.h"
+#include "test/common/random_generator.h"
 #include "test/common/tensor_op_test_utils.h"
 #include "test/common/cuda_op_test_utils.h"
 #include "test/providers/provider_test_utils.h"
 #include "test/util/include/scoped_env_vars.h"
 #include "contrib_ops/cpu/bert/attention_common.h"
 #include "test/contrib_ops/attention_op_test_helper.h"
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 namespace onnxruntime {
 
 namespace test {
 
-// This op is currently only supported on CUDA- so test it only for CUDA
+// DecoderMaskedSelfAttention is currently only supported on CUDA- so test it only for CUDA
 #ifdef USE_CUDA
 
 template <typename T>
@@ -863,5 +866,303 @@ TEST(DecoderMaskedSelfAttentionTest, Test_fp16) {
 
 #endif
 
+// Self attention of one new token against a shared past/present cache of max_sequence_length entries. With
+// beam_width > 1, the entries of the earlier tokens are read through cache_indirection. relative_position_bias
+// has shape (bias_batch_size, num_heads, 1, total_sequence_length) and is omitted when bias_batch_size is 0.
+static void RunDecoderMaskedMultiHeadAttentionCpuTest(int batch_size, int beam_width, int number_of_heads,
+                                                      int head_size, int past_sequence_length,
+                                                      int max_sequence_length, bool use_mask,
+                                                      int bias_batch_size = 0) {
+  int hidden_size = number_of_heads * head_size;
+  int total_sequence_length = past_sequence_length + 1;
+
+  RandomValueGenerator random{};
+  std::vector<int64_t> input_dims = {batch_size, 1, hidden_size};
+  std::vector<int64_t> bias_dims = {3 * hidden_size};
+  std::vector<int64_t> cache_dims = {batch_size, number_of_heads, max_sequence_length, head_size};
+
+  std::vector<float> query = random.Uniform<float>(input_dims, -1.0f, 1.0f);
+  std::vector<float> key = random.Uniform<float>(input_dims, -1.0f, 1.0f);
+  std::vector<float> value = random.Uniform<float>(input_dims, -1.0f, 1.0f);
+  std::vector<float> bias = random.Uniform<float>(bias_dims, -1.0f, 1.0f);
+  std::vector<float> past_key = random.Uniform<float>(cache_dims, -1.0f, 1.0f);
+  std::vector<float> past_value = random.Uniform<float>(cache_dims, -1.0f, 1.0f);
+
+  std::vector<int64_t> relative_position_bias_dims = {bias_batch_size, number_of_heads, 1, total_sequence_length};
+  std::vector<float> relative_position_bias;
+  if (bias_batch_size > 0) {
+    relative_position_bias = random.Uniform<float>(relative_position_bias_dims, -2.0f, 2.0f);
+  }
+
+  std::vector<int32_t> mask(static_cast<size_t>(batch_size) * total_sequence_length, 1);
+  if (use_mask) {
+    for (size_t i = 0; i < mask.size(); i += 3) {
+      mask[i] = 0;
+    }
+  }
+
+  std::vector<int32_t> cache_indirection(static_cast<size_t>(batch_size) * max_sequence_length, 0);
+  for (size_t i = 0; i < cache_indirection.size(); i++) {
+    cache_indirection[i] = static_cast<int32_t>((i * 7 + i / max_sequence_length) % beam_width);
+  }
+
+  // The present cache is the past cache with the key and value of the new token at past_sequence_length.
+  std::vector<float> present_key = past_key;
+  std::vector<float> present_value = past_value;
+  for (int b = 0; b < batch_size; b++) {
+    for (int n = 0; n < number_of_heads; n++) {
+      size_t offset = ((static_cast<size_t>(b) * number_of_heads + n) * max_sequence_length + past_sequence_length) *
+                      head_size;
+      for (int h = 0; h < head_size; h++) {
+        int i = n * head_size + h;
+        present_key[offset + h] = key[b * hidden_size + i] + bias[hidden_size + i];
+        present_value[offset + h] = value[b * hidden_size + i] + bias[2 * hidden_size + i];
+      }
+    }
+  }
+
+  std::vector<float> output(static_cast<size_t>(batch_size) * hidden_size);
+  for (int b = 0; b < batch_size; b++) {
+    for (int n = 0; n < number_of_heads; n++) {
+      std::vector<size_t> rows(total_sequence_length);
+      for (int t = 0; t < total_sequence_length; t++) {
+        int source = b;
+        if (beam_width > 1 && t < past_sequence_length) {
+          source = b - b % beam_width + cache_indirection[static_cast<size_t>(b) * max_sequence_length + t];
+        }
+        rows[t] = ((static_cast<size_t>(source) * number_of_heads + n) * max_sequence_length + t) * head_size;
+      }
+
+      std::vector<float> scores(total_sequence_length);
+      float max_score = std::numeric_limits<float>::lowest();
+      for (int t = 0; t < total_sequence_length; t++) {
+        float dot = 0.0f;
+        for (int h = 0; h < head_size; h++) {
+          int i = n * head_size + h;
+          dot += (query[b * hidden_size + i] + bias[i]) * present_key[rows[t] + h];
+        }
+        scores[t] = dot / std::sqrt(static_cast<float>(head_size));
+        if (mask[static_cast<size_t>(b) * total_sequence_length + t] == 0) {
+          scores[t] += -10000.0f;
+        }
+        if (bias_batch_size > 0) {
+          int bias_batch = bias_batch_size == 1 ? 0 : b;
+          scores[t] += relative_position_bias[(static_cast<size_t>(bias_batch) * number_of_heads + n) *
+                                                  total_sequence_length +
+                                              t];
+        }
+        max_score = std::max(max_score, scores[t]);
+      }
+
+      float sum = 0.0f;
+      for (int t = 0; t < total_sequence_length; t++) {
+        scores[t] = std::exp(scores[t] - max_score);
+        sum += scores[t];
+      }
+
+      for (int h = 0; h < head_size; h++) {
+        float result = 0.0f;
+        for (int t = 0; t < total_sequence_length; t++) {
+          result += scores[t] / sum * present_value[rows[t] + h];
+        }
+        output[b * hidden_size + n * head_size + h] = result;
+      }
+    }
+  }
+
+  OpTester tester("DecoderMaskedMultiHeadAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", static_cast<int64_t>(number_of_heads));
+  tester.AddAttribute<int64_t>("past_present_share_buffer", static_cast<int64_t>(1));
+
+  tester.AddInput<float>("query", input_dims, query);
+  tester.AddInput<float>("key", input_dims, key);
+  tester.AddInput<float>("value", input_dims, value);
+  if (use_mask) {
+    tester.AddInput<int32_t>("mask_index", {batch_size, total_sequence_length}, mask);
+  } else {
+    tester.AddOptionalInputEdge<int32_t>();
+  }
+  if (bias_batch_size > 0) {
+    tester.AddInput<float>("relative_position_bias", relative_position_bias_dims, relative_position_bias);
+  } else {
+    tester.AddOptionalInputEdge<float>();
+  }
+  tester.AddInput<float>("past_key", cache_dims, past_key);
+  tester.AddInput<float>("past_value", cache_dims, past_value);
+  tester.AddInput<int32_t>("past_sequence_length", {1}, {past_sequence_length});
+  tester.AddInput<int32_t>("beam_width", {1}, {beam_width});
+  tester.AddInput<int32_t>("cache_indirection", {batch_size / beam_width, beam_width, max_sequence_length},
+                           cache_indirection);
+  tester.AddInput<float>("bias", bias_dims, bias);
+
+  tester.AddOutput<float>("output", input_dims, output, false, 1e-4f, 1e-4f);
+  tester.AddOutput<float>("present_key", cache_dims, present_key);
+  tester.AddOutput<float>("present_value", cache_dims, present_value);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+TEST(DecoderMaskedMultiHeadAttentionTest, CpuSelfAttention) {
+  // The past lengths cover a partial key block, a full key block and several key blocks of the kernel.
+  for (int past_sequence_length : {0, 63, 200}) {
+    RunDecoderMaskedMultiHeadAttentionCpuTest(2, 1, 4, 16, past_sequence_length, past_sequence_length + 5, false);
+    RunDecoderMaskedMultiHeadAttentionCpuTest(3, 1, 2, 64, past_sequence_length, past_sequence_length + 1, true);
+  }
+}
+
+TEST(DecoderMaskedMultiHeadAttentionTest, CpuSelfAttentionWithMaskAndPast) {
+  // The mask is (batch_size, past_sequence_length + 1) and masks entries of the past as well as the new token.
+  for (int past_sequence_length : {1, 4, 70}) {
+    RunDecoderMaskedMultiHeadAttentionCpuTest(2, 1, 2, 16, past_sequence_length, past_sequence_length + 3, true);
+  }
+}
+
+TEST(DecoderMaskedMultiHeadAttentionTest, CpuSelfAttentionWithRelativePositionBias) {
+  for (int past_sequence_length : {0, 5, 90}) {
+    RunDecoderMaskedMultiHeadAttentionCpuTest(2, 1, 3, 16, past_sequence_length, past_sequence_length + 2, false, 2);
+    RunDecoderMaskedMultiHeadAttentionCpuTest(3, 1, 2, 32, past_sequence_length, past_sequence_length + 1, true, 1);
+  }
+}
+
+TEST(DecoderMaskedMultiHeadAttentionTest, CpuSelfAttentionWithCacheIndirection) {
+  for (int past_sequence_length : {1, 130}) {
+    RunDecoderMaskedMultiHeadAttentionCpuTest(6, 3, 2, 32, past_sequence_length, past_sequence_length + 4, false);
+    RunDecoderMaskedMultiHeadAttentionCpuTest(8, 4, 3, 16, past_sequence_length, past_sequence_length + 1, true);
+  }
+}
+
+// One decoding step of cross-attention: key and value are the (batch_size, num_heads, kv_sequence_length, head_size)
+// cache of the encoder output, and only the query gets its bias.
+static void RunDecoderMaskedMultiHeadAttentionCpuCrossAttentionTest(int batch_size, int number_of_heads,
+                                                                    int head_size, int kv_sequence_length,
+                                                                    bool use_mask) {
+  int hidden_size = number_of_heads * head_size;
+
+  RandomValueGenerator random{};
+  std::vector<int64_t> query_dims = {batch_size, 1, hidden_size};
+  std::vector<int64_t> bias_dims = {3 * hidden_size};
+  std::vector<int64_t> kv_dims = {batch_size, number_of_heads, kv_sequence_length, head_size};
+
+  std::vector<float> query = random.Uniform<float>(query_dims, -1.0f, 1.0f);
+  std::vector<float> key = random.Uniform<float>(kv_dims, -1.0f, 1.0f);
+  std::vector<float> value = random.Uniform<float>(kv_dims, -1.0f, 1.0f);
+  std::vector<float> bias = random.Uniform<float>(bias_dims, -1.0f, 1.0f);
+
+  std::vector<int32_t> mask(static_cast<size_t>(batch_size) * kv_sequence_length, 1);
+  if (use_mask) {
+    for (size_t i = 1; i < mask.size(); i += 4) {
+      mask[i] = 0;
+    }
+  }
+
+  std::vector<float> output(static_cast<size_t>(batch_size) * hidden_size);
+  for (int b = 0; b < batch_size; b++) {
+    for (int n = 0; n < number_of_heads; n++) {
+      size_t head_offset = (static_cast<size_t>(b) * number_of_heads + n) * kv_sequence_length * head_size;
+
+      std::vector<float> scores(kv_sequence_length);
+      float max_score = std::numeric_limits<float>::lowest();
+      for (int t = 0; t < kv_sequence_length; t++) {
+        float dot = 0.0f;
+        for (int h = 0; h < head_size; h++) {
+          int i = n * head_size + h;
+          dot += (query[b * hidden_size + i] + bias[i]) * key[head_offset + t * head_size + h];
+        }
+        scores[t] = dot / std::sqrt(static_cast<float>(head_size));
+        if (mask[static_cast<size_t>(b) * kv_sequence_length + t] == 0) {
+          scores[t] += -10000.0f;
+        }
+        max_score = std::max(max_score, scores[t]);
+      }
+
+      float sum = 0.0f;
+      for (int t = 0; t < kv_sequence_length; t++) {
+        scores[t] = std::exp(scores[t] - max_score);
+        sum += scores[t];
+      }
+
+      for (int h = 0; h < head_size; h++) {
+        float result = 0.0f;
+        for (int t = 0; t < kv_sequence_length; t++) {
+          result += scores[t] / sum * value[head_offset + t * head_size + h];
+        }
+        output[b * hidden_size + n * head_size + h] = result;
+      }
+    }
+  }
+
+  OpTester tester("DecoderMaskedMultiHeadAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", static_cast<int64_t>(number_of_heads));
+
+  tester.AddInput<float>("query", query_dims, query);
+  tester.AddInput<float>("key", kv_dims, key);
+  tester.AddInput<float>("value", kv_dims, value);
+  if (use_mask) {
+    tester.AddInput<int32_t>("mask_index", {batch_size, kv_sequence_length}, mask);
+  } else {
+    tester.AddOptionalInputEdge<int32_t>();
+  }
+  tester.AddOptionalInputEdge<float>();    // relative_position_bias
+  tester.AddOptionalInputEdge<float>();    // past_key
+  tester.AddOptionalInputEdge<float>();    // past_value
+  tester.AddOptionalInputEdge<int32_t>();  // past_sequence_length
+  tester.AddOptionalInputEdge<int32_t>();  // beam_width
+  tester.AddOptionalInputEdge<int32_t>();  // cache_indirection
+  tester.AddInput<float>("bias", bias_dims, bias);
+
+  tester.AddOutput<float>("output", query_dims, output, false, 1e-4f, 1e-4f);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+TEST(DecoderMaskedMultiHeadAttentionTest, CpuCrossAttention) {
+  for (int kv_sequence_length : {1, 64, 100}) {
+    RunDecoderMaskedMultiHeadAttentionCpuCrossAttentionTest(2, 2, 16, kv_sequence_length, false);
+    RunDecoderMaskedMultiHeadAttentionCpuCrossAttentionTest(3, 4, 8, kv_sequence_length, true);
+  }
+}
+
+TEST(DecoderMaskedMultiHeadAttentionTest, CpuSelfAttentionRejectsKvSequenceLengthMask) {
+  // MultiHeadAttention accepts a (batch_size, kv_sequence_length) mask, but the mask of this kernel covers the past
+  // tokens too, so (batch_size, 1) is rejected once there is a past.
+  constexpr int batch_size = 2;
+  constexpr int number_of_heads = 2;
+  constexpr int head_size = 8;
+  constexpr int past_sequence_length = 3;
+  constexpr int max_sequence_length = 6;
+  constexpr int hidden_size = number_of_heads * head_size;
+
+  std::vector<int64_t> input_dims = {batch_size, 1, hidden_size};
+  std::vector<int64_t> cache_dims = {batch_size, number_of_heads, max_sequence_length, head_size};
+  std::vector<float> input(static_cast<size_t>(batch_size) * hidden_size, 0.5f);
+  std::vector<float> cache(static_cast<size_t>(batch_size) * number_of_heads * max_sequence_length * head_size, 0.25f);
+
+  OpTester tester("DecoderMaskedMultiHeadAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", static_cast<int64_t>(number_of_heads));
+  tester.AddAttribute<int64_t>("past_present_share_buffer", static_cast<int64_t>(1));
+
+  tester.AddInput<float>("query", input_dims, input);
+  tester.AddInput<float>("key", input_dims, input);
+  tester.AddInput<float>("value", input_dims, input);
+  tester.AddInput<int32_t>("mask_index", {batch_size, 1}, {1, 1});
+  tester.AddOptionalInputEdge<float>();
+  tester.AddInput<float>("past_key", cache_dims, cache);
+  tester.AddInput<float>("past_value", cache_dims, cache);
+  tester.AddInput<int32_t>("past_sequence_length", {1}, {past_sequence_length});
+
+  tester.AddOutput<float>("output", input_dims, input);
+  tester.AddOutput<float>("present_key", cache_dims, cache);
+  tester.AddOutput<float>("present_value", cache_dims, cache);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectFailure, "padding mask of shape [batch, total_seq_length]", {}, nullptr,
+             &execution_providers);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
\ No newline at end of file
@@ -2,11 +2,14 @@
 // Licensed under the MIT License.
 
 #include <memory>
+#include <string>
 #include <vector>
 #include "gtest/gtest.h"
 #include "core/common/gsl.h"
+#include "core/graph/model.h"
 #include "core/session/onnxruntime_cxx_api.h"
 #include "test/common/cuda_op_test_utils.h"
+#include "test/util/include/asserts.h"
 
 extern std::unique_ptr<Ort::Env> ort_env;
 
@@ -143,5 +146,87 @@ TEST(GreedySearchTest, GptGreedySearchFp32) {
   }
 }
 
+namespace {
+
+// Serializes the model with the decoder subgraph of its GreedySearch node also used as draft_decoder, so that
+// speculative decoding accepts every draft token.
+std::string CreateModelWithDraftDecoder(const PathString& model_path, int64_t num_speculative_tokens) {
+  ONNX_NAMESPACE::ModelProto model_proto;
+  ORT_THROW_IF_ERROR(Model::Load(model_path, model_proto));
+
+  for (auto& node : *model_proto.mutable_graph()->mutable_node()) {
+    if (node.op_type() != "GreedySearch") {
+      continue;
+    }
+    ONNX_NAMESPACE::AttributeProto draft_decoder;
+    for (const auto& attribute : node.attribute()) {
+      if (attribute.name() == "decoder") {
+        draft_decoder = attribute;
+      }
+    }
+    draft_decoder.set_name("draft_decoder");
+    *node.add_attribute() = draft_decoder;
+    auto* num_speculative_tokens_attribute = node.add_attribute();
+    num_speculative_tokens_attribute->set_name("num_speculative_tokens");
+    num_speculative_tokens_attribute->set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_INT);
+    num_speculative_tokens_attribute->set_i(num_speculative_tokens);
+  }
+
+  std::string model_data;
+  ORT_ENFORCE(model_proto.SerializeToString(&model_data));
+  return model_data;
+}
+
+std::vector<int32_t> RunGreedySearchCpu(Ort::Session& session, std::vector<int32_t> input_ids,
+                                        const std::vector<int64_t>& input_ids_shape, int32_t max_length_value) {
+  std::vector<int64_t> parameter_shape{1};
+  std::vector<int32_t> max_length{max_length_value};
+  std::vector<int32_t> min_length{1};
+  std::vector<float> repetition_penalty{1.0f};
+
+  Ort::MemoryInfo info("Cpu", OrtDeviceAllocator, 0, OrtMemTypeDefault);
+  std::vector<Ort::Value> ort_inputs;
+  ort_inputs.push_back(Ort::Value::CreateTensor(
+      info, input_ids.data(), input_ids.size(), input_ids_shape.data(), input_ids_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(
+      info, max_length.data(), max_length.size(), parameter_shape.data(), parameter_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(
+      info, min_length.data(), min_length.size(), parameter_shape.data(), parameter_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(
+      info, repetition_penalty.data(), repetition_penalty.size(), parameter_shape.data(), parameter_shape.size()));
+  const char* input_names[] = {"input_ids", "max_length", "min_length", "repetition_penalty"};
+  const char* const output_names[] = {"sequences"};
+
+  auto ort_outputs = session.Run(Ort::RunOptions{}, input_names, ort_inputs.data(), ort_inputs.size(),
+                                 output_names, 1);
+  const auto& sequences = ort_outputs[0];
+  const auto* result_vals = sequences.GetTensorData<int32_t>();
+  return std::vector<int32_t>(result_vals, result_vals + sequences.GetTensorTypeAndShapeInfo().GetElementCount());
+}
+
+}  // namespace
+
+TEST(GreedySearchTest, GptGreedySearchSpeculativeDecoding_CPU) {
+  std::vector<int64_t> input_ids_shape{2, 4};
+  std::vector<int32_t> input_ids{
+      0, 0, 0, 52, 0, 0, 195, 731};
+  const PathString model_path = ORT_TSTR("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx");
+
+  for (int32_t max_length : {10, 21}) {
+    Ort::SessionOptions session_options;
+    Ort::Session session(*ort_env, model_path.c_str(), session_options);
+    std::vector<int32_t> expected_output = RunGreedySearchCpu(session, input_ids, input_ids_shape, max_length);
+    ASSERT_EQ(expected_output.size(), static_cast<size_t>(input_ids_shape[0] * max_length));
+
+    // The draft decoder is the decoder itself, so the output is the one of greedy search without speculation,
+    // whether the run ends within or after a block of draft tokens.
+    for (int64_t num_speculative_tokens : {1, 3, 4}) {
+      std::string model_data = CreateModelWithDraftDecoder(model_path, num_speculative_tokens);
+      Ort::Session speculative_session(*ort_env, model_data.data(), model_data.size(), session_options);
+      EXPECT_EQ(RunGreedySearchCpu(speculative_session, input_ids, input_ids_shape, max_length), expected_output);
+    }
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
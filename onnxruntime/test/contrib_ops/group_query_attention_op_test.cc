@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/common/random_generator.h"
+#include "test/providers/provider_test_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace onnxruntime {
+namespace test {
+
+// Causal attention of query head n over key and value head n / (num_heads / kv_num_heads), with the key and value of
+// sequence b given for its past and new tokens as (total_length, kv_num_heads * head_size).
+static void ComputeGroupQueryAttentionReference(const std::vector<std::vector<float>>& keys,
+                                                const std::vector<std::vector<float>>& values,
+                                                const std::vector<float>& query,
+                                                const std::vector<int32_t>& past_lengths, int sequence_length,
+                                                int num_heads, int kv_num_heads, int head_size,
+                                                std::vector<float>& output) {
+  const int hidden_size = num_heads * head_size;
+  const int kv_hidden_size = kv_num_heads * head_size;
+  const int group_size = num_heads / kv_num_heads;
+  output.assign(query.size(), 0.0f);
+
+  for (size_t b = 0; b < past_lengths.size(); b++) {
+    for (int s = 0; s < sequence_length; s++) {
+      const int visible = past_lengths[b] + s + 1;
+      const float* q_row = query.data() + (b * sequence_length + s) * hidden_size;
+      float* out_row = output.data() + (b * sequence_length + s) * hidden_size;
+      for (int n = 0; n < num_heads; n++) {
+        const int kv_offset = (n / group_size) * head_size;
+        std::vector<float> scores(visible);
+        float max_score = std::numeric_limits<float>::lowest();
+        for (int t = 0; t < visible; t++) {
+          float dot = 0.0f;
+          for (int h = 0; h < head_size; h++) {
+            dot += q_row[n * head_size + h] * keys[b][t * kv_hidden_size + kv_offset + h];
+          }
+          scores[t] = dot / std::sqrt(static_cast<float>(head_size));
+          max_score = std::max(max_score, scores[t]);
+        }
+
+        float sum = 0.0f;
+        for (int t = 0; t < visible; t++) {
+          scores[t] = std::exp(scores[t] - max_score);
+          sum += scores[t];
+        }
+
+        for (int h = 0; h < head_size; h++) {
+          float result = 0.0f;
+          for (int t = 0; t < visible; t++) {
+            result += scores[t] / sum * values[b][t * kv_hidden_size + kv_offset + h];
+          }
+          out_row[n * head_size + h] = result;
+        }
+      }
+    }
+  }
+}
+
+// Runs GroupQueryAttention with a past buffer of past_buffer_length tokens, or without past when it is 0.
+static void RunGroupQueryAttentionTest(const std::vector<int32_t>& past_lengths, int sequence_length,
+                                       int num_heads, int kv_num_heads, int head_size, int past_buffer_length) {
+  const int batch_size = static_cast<int>(past_lengths.size());
+  const int hidden_size = num_heads * head_size;
+  const int kv_hidden_size = kv_num_heads * head_size;
+  const int total_sequence_length = *std::max_element(past_lengths.begin(), past_lengths.end()) + sequence_length;
+  const int present_length = std::max(past_buffer_length, total_sequence_length);
+
+  RandomValueGenerator random{};
+  std::vector<std::vector<float>> keys(batch_size);
+  std::vector<std::vector<float>> values(batch_size);
+  for (int b = 0; b < batch_size; b++) {
+    const int64_t total_length = past_lengths[b] + sequence_length;
+    keys[b] = random.Uniform<float>({total_length, kv_hidden_size}, -1.0f, 1.0f);
+    values[b] = random.Uniform<float>({total_length, kv_hidden_size}, -1.0f, 1.0f);
+  }
+  std::vector<float> query = random.Uniform<float>({batch_size, sequence_length, hidden_size}, -1.0f, 1.0f);
+
+  // The past buffers hold the past of each sequence followed by unused positions.
+  std::vector<int64_t> past_dims = {batch_size, kv_num_heads, past_buffer_length, head_size};
+  std::vector<float> past_key = random.Uniform<float>(past_dims, -1.0f, 1.0f);
+  std::vector<float> past_value = random.Uniform<float>(past_dims, -1.0f, 1.0f);
+  std::vector<int64_t> present_dims = {batch_size, kv_num_heads, present_length, head_size};
+  std::vector<float> present_key(static_cast<size_t>(batch_size) * kv_num_heads * present_length * head_size, 0.0f);
+  std::vector<float> present_value(present_key.size(), 0.0f);
+  std::vector<float> key;
+  std::vector<float> value;
+  for (int b = 0; b < batch_size; b++) {
+    for (int n = 0; n < kv_num_heads; n++) {
+      const size_t past_offset = (static_cast<size_t>(b) * kv_num_heads + n) * past_buffer_length * head_size;
+      const size_t present_offset = (static_cast<size_t>(b) * kv_num_heads + n) * present_length * head_size;
+      for (int t = 0; t < past_buffer_length; t++) {
+        for (int h = 0; h < head_size; h++) {
+          if (t < past_lengths[b]) {
+            past_key[past_offset + t * head_size + h] = keys[b][t * kv_hidden_size + n * head_size + h];
+            past_value[past_offset + t * head_size + h] = values[b][t * kv_hidden_size + n * head_size + h];
+          }
+          present_key[present_offset + t * head_size + h] = past_key[past_offset + t * head_size + h];
+          present_value[present_offset + t * head_size + h] = past_value[past_offset + t * head_size + h];
+        }
+      }
+      for (int t = past_lengths[b]; t < past_lengths[b] + sequence_length; t++) {
+        for (int h = 0; h < head_size; h++) {
+          present_key[present_offset + t * head_size + h] = keys[b][t * kv_hidden_size + n * head_size + h];
+          present_value[present_offset + t * head_size + h] = values[b][t * kv_hidden_size + n * head_size + h];
+        }
+      }
+    }
+    key.insert(key.end(), keys[b].begin() + past_lengths[b] * kv_hidden_size, keys[b].end());
+    value.insert(value.end(), values[b].begin() + past_lengths[b] * kv_hidden_size, values[b].end());
+  }
+
+  std::vector<float> output;
+  ComputeGroupQueryAttentionReference(keys, values, query, past_lengths, sequence_length,
+                                      num_heads, kv_num_heads, head_size, output);
+
+  OpTester tester("GroupQueryAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", static_cast<int64_t>(num_heads));
+  tester.AddAttribute<int64_t>("kv_num_heads", static_cast<int64_t>(kv_num_heads));
+  tester.AddInput<float>("query", {batch_size, sequence_length, hidden_size}, query);
+  tester.AddInput<float>("key", {batch_size, sequence_length, kv_hidden_size}, key);
+  tester.AddInput<float>("value", {batch_size, sequence_length, kv_hidden_size}, value);
+  if (past_buffer_length > 0) {
+    tester.AddInput<float>("past_key", past_dims, past_key);
+    tester.AddInput<float>("past_value", past_dims, past_value);
+  } else {
+    tester.AddOptionalInputEdge<float>();
+    tester.AddOptionalInputEdge<float>();
+  }
+  tester.AddInput<int32_t>("seqlens_k", {batch_size}, past_lengths);
+  tester.AddInput<int32_t>("total_sequence_length", {1}, {total_sequence_length});
+  tester.AddOutput<float>("output", {batch_size, sequence_length, hidden_size}, output, false, 1e-4f, 1e-4f);
+  tester.AddOutput<float>("present_key", present_dims, present_key);
+  tester.AddOutput<float>("present_value", present_dims, present_value);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+TEST(GroupQueryAttentionTest, Prompt) {
+  RunGroupQueryAttentionTest({0, 0}, 7, 8, 2, 16, 0);
+  RunGroupQueryAttentionTest({0}, 40, 4, 4, 32, 0);
+}
+
+TEST(GroupQueryAttentionTest, Decoding) {
+  // The past buffer is allocated for the longest sequence, as when it is shared with present.
+  RunGroupQueryAttentionTest({5, 12, 0}, 1, 8, 2, 16, 16);
+  RunGroupQueryAttentionTest({31, 7}, 1, 6, 3, 32, 32);
+}
+
+TEST(GroupQueryAttentionTest, MultiQuery) {
+  RunGroupQueryAttentionTest({9, 3}, 1, 4, 1, 8, 10);
+  RunGroupQueryAttentionTest({4, 6}, 3, 4, 1, 8, 12);
+}
+
+TEST(GroupQueryAttentionTest, GrowingPast) {
+  // The past buffer only holds the past, present is longer.
+  RunGroupQueryAttentionTest({6, 2}, 1, 4, 2, 8, 6);
+  RunGroupQueryAttentionTest({6, 6}, 4, 4, 2, 8, 6);
+}
+
+TEST(GroupQueryAttentionTest, SequenceTooLong) {
+  OpTester tester("GroupQueryAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", 2);
+  tester.AddAttribute<int64_t>("kv_num_heads", 1);
+  tester.AddInput<float>("query", {1, 1, 8}, std::vector<float>(8, 1.0f));
+  tester.AddInput<float>("key", {1, 1, 4}, std::vector<float>(4, 1.0f));
+  tester.AddInput<float>("value", {1, 1, 4}, std::vector<float>(4, 1.0f));
+  tester.AddInput<float>("past_key", {1, 1, 4, 4}, std::vector<float>(16, 1.0f));
+  tester.AddInput<float>("past_value", {1, 1, 4, 4}, std::vector<float>(16, 1.0f));
+  tester.AddInput<int32_t>("seqlens_k", {1}, {4});
+  tester.AddInput<int32_t>("total_sequence_length", {1}, {4});
+  tester.AddOutput<float>("output", {1, 1, 8}, std::vector<float>(8, 1.0f));
+  tester.AddOutput<float>("present_key", {1, 1, 4, 4}, std::vector<float>(16, 1.0f));
+  tester.AddOutput<float>("present_value", {1, 1, 4, 4}, std::vector<float>(16, 1.0f));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectFailure, "more than the total_sequence_length", {}, nullptr,
+             &execution_providers);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+#include <numeric>
+#include <random>
+
+namespace onnxruntime {
+namespace test {
+
+struct MatMulNBitsTestOptions {
+  std::vector<int64_t> a_dims;  // the last dimension is K
+  int64_t N;
+  int64_t block_size;
+  int64_t bits;
+  bool has_zero_points;
+  int64_t accuracy_level = 0;
+  bool weights_are_initializers = true;  // constant weights are packed to MLAS when the layout allows
+};
+
+// Quantized values, scales and zero points are random, and the expected output is computed with B dequantized.
+static void RunMatMulNBitsTest(const MatMulNBitsTestOptions& options) {
+  const int64_t K = options.a_dims.back();
+  const int64_t N = options.N;
+  const int64_t M = std::accumulate(options.a_dims.begin(), options.a_dims.end() - 1, int64_t{1},
+                                    std::multiplies<int64_t>());
+  const int64_t k_blocks = (K + options.block_size - 1) / options.block_size;
+  const int64_t blob_size = options.block_size * options.bits / 8;
+  const int64_t zero_points_per_column = (k_blocks * options.bits + 7) / 8;
+  const int max_value = (1 << options.bits) - 1;
+
+  std::default_random_engine generator(static_cast<unsigned>(N * K + options.block_size));
+  std::uniform_real_distribution<float> float_distribution(-1.0f, 1.0f);
+  std::uniform_int_distribution<int> value_distribution(0, max_value);
+
+  std::vector<float> a(M * K);
+  for (auto& v : a) {
+    v = float_distribution(generator);
+  }
+
+  std::vector<uint8_t> quantized(N * k_blocks * options.block_size);
+  for (auto& q : quantized) {
+    q = static_cast<uint8_t>(value_distribution(generator));
+  }
+  std::vector<float> scales(N * k_blocks);
+  for (auto& s : scales) {
+    s = (std::abs(float_distribution(generator)) + 0.1f) / static_cast<float>(max_value);
+  }
+  std::vector<uint8_t> zero_points(N * k_blocks, static_cast<uint8_t>(1 << (options.bits - 1)));
+  if (options.has_zero_points) {
+    for (auto& z : zero_points) {
+      z = static_cast<uint8_t>(value_distribution(generator));
+    }
+  }
+
+  // Pack the values and zero points of 4 bits in pairs, the first one in the low bits.
+  std::vector<uint8_t> b(N * k_blocks * blob_size);
+  std::vector<uint8_t> packed_zero_points(N * zero_points_per_column, 0);
+  for (int64_t n = 0; n < N; n++) {
+    for (int64_t block = 0; block < k_blocks; block++) {
+      for (int64_t l = 0; l < options.block_size; l++) {
+        const int64_t index = (n * k_blocks + block) * options.block_size + l;
+        if (options.bits == 8) {
+          b[index] = quantized[index];
+        } else {
+          b[index / 2] |= static_cast<uint8_t>(quantized[index] << ((l & 1) * 4));
+        }
+      }
+      const uint8_t zero_point = zero_points[n * k_blocks + block];
+      if (options.bits == 8) {
+        packed_zero_points[n * zero_points_per_column + block] = zero_point;
+      } else {
+        packed_zero_points[n * zero_points_per_column + block / 2] |=
+            static_cast<uint8_t>(zero_point << ((block & 1) * 4));
+      }
+    }
+  }
+
+  std::vector<float> expected(M * N, 0.0f);
+  for (int64_t m = 0; m < M; m++) {
+    for (int64_t n = 0; n < N; n++) {
+      float sum = 0.0f;
+      for (int64_t k = 0; k < K; k++) {
+        const int64_t block = k / options.block_size;
+        const int64_t index = (n * k_blocks + block) * options.block_size + k % options.block_size;
+        const float weight = static_cast<float>(quantized[index] - zero_points[n * k_blocks + block]) *
+                             scales[n * k_blocks + block];
+        sum += a[m * K + k] * weight;
+      }
+      expected[m * N + n] = sum;
+    }
+  }
+
+  std::vector<int64_t> y_dims = options.a_dims;
+  y_dims.back() = N;
+
+  OpTester test("MatMulNBits", 1, kMSDomain);
+  test.AddAttribute<int64_t>("K", K);
+  test.AddAttribute<int64_t>("N", N);
+  test.AddAttribute<int64_t>("block_size", options.block_size);
+  test.AddAttribute<int64_t>("bits", options.bits);
+  test.AddAttribute<int64_t>("accuracy_level", options.accuracy_level);
+  test.AddInput<float>("A", options.a_dims, a);
+  test.AddInput<uint8_t>("B", {N, k_blocks, blob_size}, b, options.weights_are_initializers);
+  test.AddInput<float>("scales", {N * k_blocks}, scales, options.weights_are_initializers);
+  if (options.has_zero_points) {
+    test.AddInput<uint8_t>("zero_points", {N * zero_points_per_column}, packed_zero_points,
+                           options.weights_are_initializers);
+  }
+
+  // A quantized to int8 has an error of half a step of its block.
+  if (options.accuracy_level == 4) {
+    test.AddOutput<float>("Y", y_dims, expected, false, 0.02f, 0.05f);
+  } else {
+    test.AddOutput<float>("Y", y_dims, expected, false, 1e-4f, 1e-4f);
+  }
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+TEST(MatMulNBits, Float32_4b_Block32) {
+  for (bool has_zero_points : {false, true}) {
+    RunMatMulNBitsTest({{100, 52}, 288, 32, 4, has_zero_points});
+    RunMatMulNBitsTest({{1, 41}, 17, 32, 4, has_zero_points});
+    RunMatMulNBitsTest({{2, 3, 64}, 33, 32, 4, has_zero_points});
+  }
+}
+
+TEST(MatMulNBits, Float32_4b_BlockSizes) {
+  for (int64_t block_size : {16, 64, 128, 256}) {
+    for (bool has_zero_points : {false, true}) {
+      RunMatMulNBitsTest({{7, 300}, 70, block_size, 4, has_zero_points});
+      RunMatMulNBitsTest({{1, 300}, 70, block_size, 4, has_zero_points});
+    }
+  }
+}
+
+TEST(MatMulNBits, Float32_8b) {
+  for (int64_t block_size : {16, 32, 128}) {
+    for (bool has_zero_points : {false, true}) {
+      RunMatMulNBitsTest({{5, 200}, 66, block_size, 8, has_zero_points});
+    }
+  }
+}
+
+TEST(MatMulNBits, Float32_NotPrepacked) {
+  // Weights that are graph inputs are dequantized by the kernel for every run.
+  MatMulNBitsTestOptions options{{9, 96}, 40, 32, 4, true};
+  options.weights_are_initializers = false;
+  RunMatMulNBitsTest(options);
+}
+
+TEST(MatMulNBits, Int8Activation) {
+  for (int64_t bits : {4, 8}) {
+    for (int64_t block_size : {16, 32, 64, 128}) {
+      for (bool has_zero_points : {false, true}) {
+        MatMulNBitsTestOptions options{{6, 160}, 72, block_size, bits, has_zero_points};
+        options.accuracy_level = 4;
+        RunMatMulNBitsTest(options);
+      }
+    }
+  }
+}
+
+TEST(MatMulNBits, InvalidShapes) {
+  OpTester test("MatMulNBits", 1, kMSDomain);
+  test.AddAttribute<int64_t>("K", 64);
+  test.AddAttribute<int64_t>("N", 2);
+  test.AddAttribute<int64_t>("block_size", 32);
+  test.AddAttribute<int64_t>("bits", 4);
+  test.AddInput<float>("A", {1, 64}, std::vector<float>(64, 1.0f));
+  test.AddInput<uint8_t>("B", {2, 1, 16}, std::vector<uint8_t>(32, 0x88));
+  test.AddInput<float>("scales", {4}, std::vector<float>(4, 1.0f));
+  test.AddOutput<float>("Y", {1, 2}, std::vector<float>(2, 0.0f));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectFailure, "Input 'B' is expected to have shape", {}, nullptr,
+           &execution_providers);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
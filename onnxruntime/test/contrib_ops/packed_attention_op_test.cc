@@ -33,8 +33,9 @@ static void RunPackedAttentionTest(
     const std::vector<float>& relative_position_bias_data) {
   int min_cuda_architecture = use_float16 ? 530 : 0;
   bool enable_cuda = HasCudaEnvironment(min_cuda_architecture);
+  bool enable_cpu = !use_float16;
 
-  if (enable_cuda) {
+  if (enable_cuda || enable_cpu) {
     OpTester tester("PackedAttention", 1, onnxruntime::kMSDomain);
     tester.AddAttribute<int64_t>("num_heads", static_cast<int64_t>(number_of_heads));
 
@@ -88,9 +89,17 @@ static void RunPackedAttentionTest(
       tester.AddOutput<float>("output", output_dims, output_data);
     }
 
-    std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
-    execution_providers.push_back(DefaultCudaExecutionProvider());
-    tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+    if (enable_cuda) {
+      std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+      execution_providers.push_back(DefaultCudaExecutionProvider());
+      tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+    }
+
+    if (enable_cpu) {
+      std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+      execution_providers.push_back(DefaultCpuExecutionProvider());
+      tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+    }
   }
 }
 
@@ -433,9 +442,14 @@ static void RunModelWithRandomInput(
   std::vector<int64_t> token_offset_dims{batch_size, sequence_length};
   std::vector<int64_t> cum_seq_len_dims{batch_size + 1};
 
-  float gpu_threshold = is_float16 ? 0.1f : 0.005f;
+  float threshold = is_float16 ? 0.1f : 0.005f;
   bool enable_cuda = HasCudaEnvironment(is_float16 ? 530 : 0);
-  if (enable_cuda) {
+  bool enable_cpu = !is_float16;
+  for (bool use_cuda : {true, false}) {
+    if (use_cuda ? !enable_cuda : !enable_cpu) {
+      continue;
+    }
+
     OpTester test("PackedAttention", 1, onnxruntime::kMSDomain);
     test.AddAttribute<int64_t>("num_heads", num_heads);
     if (is_float16) {
@@ -461,8 +475,9 @@ static void RunModelWithRandomInput(
     }
 
     std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
-    execution_providers.push_back(DefaultCudaExecutionProvider());
-    test.AddReferenceOutputs(onnx_model, gpu_threshold, DefaultCudaExecutionProvider());
+    execution_providers.push_back(use_cuda ? DefaultCudaExecutionProvider() : DefaultCpuExecutionProvider());
+    test.AddReferenceOutputs(onnx_model, threshold,
+                             use_cuda ? DefaultCudaExecutionProvider() : DefaultCpuExecutionProvider());
     test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
   }
 }
@@ -56,10 +56,11 @@ static void RunPackedMultiHeadAttentionTest(
     bool broadcast_relative_position_bias) {
   int min_cuda_architecture = use_float16 ? 530 : 0;
   bool enable_cuda = HasCudaEnvironment(min_cuda_architecture);
+  bool enable_cpu = !use_float16;
 
   int64_t head_size = static_cast<int64_t>(hidden_size / number_of_heads);
 
-  if (enable_cuda) {
+  if (enable_cuda || enable_cpu) {
     OpTester tester("PackedMultiHeadAttention", 1, onnxruntime::kMSDomain);
     tester.AddAttribute<int64_t>("num_heads", static_cast<int64_t>(number_of_heads));
     if (use_scale) {
@@ -133,9 +134,17 @@ static void RunPackedMultiHeadAttentionTest(
       tester.AddOutput<float>("output", output_dims, output_data);
     }
 
-    std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
-    execution_providers.push_back(DefaultCudaExecutionProvider());
-    tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+    if (enable_cuda) {
+      std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+      execution_providers.push_back(DefaultCudaExecutionProvider());
+      tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+    }
+
+    if (enable_cpu) {
+      std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+      execution_providers.push_back(DefaultCpuExecutionProvider());
+      tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+    }
   }
 }
 
@@ -0,0 +1,306 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/common/random_generator.h"
+#include "test/providers/provider_test_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace onnxruntime {
+namespace test {
+
+// Key and value of every token of a sequence with shape (total_length, hidden_size), and the query of its new tokens.
+struct PagedAttentionSequence {
+  std::vector<float> keys;
+  std::vector<float> values;
+  std::vector<float> queries;
+};
+
+// Writes the key and value of the new tokens of each sequence to its pages and computes the expected output of
+// PagedAttention from the contiguous keys and values of the sequences.
+static void ComputePagedAttentionReference(const std::vector<PagedAttentionSequence>& sequences,
+                                           const std::vector<int32_t>& past_lengths,
+                                           const std::vector<int32_t>& page_table, int max_pages_per_sequence,
+                                           int num_heads, int head_size, int page_size,
+                                           std::vector<float>& key_cache, std::vector<float>& value_cache,
+                                           std::vector<float>& output) {
+  const int hidden_size = num_heads * head_size;
+  output.clear();
+  for (size_t b = 0; b < sequences.size(); b++) {
+    const PagedAttentionSequence& sequence = sequences[b];
+    const int total_length = static_cast<int>(sequence.keys.size()) / hidden_size;
+    const int new_length = static_cast<int>(sequence.queries.size()) / hidden_size;
+    const int past_length = past_lengths[b];
+
+    for (int t = past_length; t < total_length; t++) {
+      const int page = page_table[b * max_pages_per_sequence + t / page_size];
+      for (int n = 0; n < num_heads; n++) {
+        const size_t offset = ((static_cast<size_t>(page) * num_heads + n) * page_size + t % page_size) * head_size;
+        for (int h = 0; h < head_size; h++) {
+          key_cache[offset + h] = sequence.keys[t * hidden_size + n * head_size + h];
+          value_cache[offset + h] = sequence.values[t * hidden_size + n * head_size + h];
+        }
+      }
+    }
+
+    for (int j = 0; j < new_length; j++) {
+      std::vector<float> row(hidden_size);
+      const int visible = past_length + j + 1;
+      for (int n = 0; n < num_heads; n++) {
+        std::vector<float> scores(visible);
+        float max_score = std::numeric_limits<float>::lowest();
+        for (int t = 0; t < visible; t++) {
+          float dot = 0.0f;
+          for (int h = 0; h < head_size; h++) {
+            dot += sequence.queries[j * hidden_size + n * head_size + h] *
+                   sequence.keys[t * hidden_size + n * head_size + h];
+          }
+          scores[t] = dot / std::sqrt(static_cast<float>(head_size));
+          max_score = std::max(max_score, scores[t]);
+        }
+
+        float sum = 0.0f;
+        for (int t = 0; t < visible; t++) {
+          scores[t] = std::exp(scores[t] - max_score);
+          sum += scores[t];
+        }
+
+        for (int h = 0; h < head_size; h++) {
+          float result = 0.0f;
+          for (int t = 0; t < visible; t++) {
+            result += scores[t] / sum * sequence.values[t * hidden_size + n * head_size + h];
+          }
+          row[n * head_size + h] = result;
+        }
+      }
+      output.insert(output.end(), row.begin(), row.end());
+    }
+  }
+}
+
+static void RunPagedAttention(const std::vector<PagedAttentionSequence>& sequences,
+                              const std::vector<int32_t>& past_lengths,
+                              const std::vector<int32_t>& page_table, int max_pages_per_sequence,
+                              int num_heads, int head_size, int num_pages, int page_size,
+                              std::vector<float>& key_cache, std::vector<float>& value_cache) {
+  const int hidden_size = num_heads * head_size;
+  const int batch_size = static_cast<int>(sequences.size());
+
+  std::vector<float> query;
+  std::vector<float> key;
+  std::vector<float> value;
+  std::vector<int32_t> cumulative_sequence_length(1, 0);
+  for (int b = 0; b < batch_size; b++) {
+    const PagedAttentionSequence& sequence = sequences[b];
+    query.insert(query.end(), sequence.queries.begin(), sequence.queries.end());
+    key.insert(key.end(), sequence.keys.begin() + past_lengths[b] * hidden_size, sequence.keys.end());
+    value.insert(value.end(), sequence.values.begin() + past_lengths[b] * hidden_size, sequence.values.end());
+    cumulative_sequence_length.push_back(static_cast<int32_t>(query.size() / hidden_size));
+  }
+  const int64_t token_count = static_cast<int64_t>(query.size()) / hidden_size;
+
+  std::vector<int64_t> input_dims = {token_count, hidden_size};
+  std::vector<int64_t> cache_dims = {num_pages, num_heads, page_size, head_size};
+
+  OpTester tester("PagedAttention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", static_cast<int64_t>(num_heads));
+  tester.AddInput<float>("query", input_dims, query);
+  tester.AddInput<float>("key", input_dims, key);
+  tester.AddInput<float>("value", input_dims, value);
+  tester.AddInput<float>("key_cache", cache_dims, key_cache);
+  tester.AddInput<float>("value_cache", cache_dims, value_cache);
+  tester.AddInput<int32_t>("page_table", {batch_size, max_pages_per_sequence}, page_table);
+  tester.AddInput<int32_t>("past_sequence_lengths", {batch_size}, past_lengths);
+  tester.AddInput<int32_t>("cumulative_sequence_length", {batch_size + 1}, cumulative_sequence_length);
+
+  std::vector<float> output;
+  ComputePagedAttentionReference(sequences, past_lengths, page_table, max_pages_per_sequence,
+                                 num_heads, head_size, page_size, key_cache, value_cache, output);
+
+  tester.AddOutput<float>("output", input_dims, output, false, 1e-4f, 1e-4f);
+  tester.AddOutput<float>("key_cache_out", cache_dims, key_cache);
+  tester.AddOutput<float>("value_cache_out", cache_dims, value_cache);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+static void RunPagedAttentionTest(const std::vector<int32_t>& past_lengths, const std::vector<int32_t>& new_lengths,
+                                  int num_heads, int head_size, int page_size) {
+  const int hidden_size = num_heads * head_size;
+  const int batch_size = static_cast<int>(past_lengths.size());
+
+  int max_pages_per_sequence = 0;
+  int num_pages = 0;
+  for (int b = 0; b < batch_size; b++) {
+    const int pages = (past_lengths[b] + new_lengths[b] + page_size - 1) / page_size;
+    max_pages_per_sequence = std::max(max_pages_per_sequence, pages);
+    num_pages += pages;
+  }
+  num_pages += 3;  // pages not used by the batch
+
+  // The pages of the sequences are spread over the pool in no particular order.
+  std::vector<int32_t> free_pages(num_pages);
+  std::iota(free_pages.begin(), free_pages.end(), 0);
+  std::shuffle(free_pages.begin(), free_pages.end(), std::mt19937(123));
+  std::vector<int32_t> page_table(static_cast<size_t>(batch_size) * max_pages_per_sequence, -1);
+  size_t next_page = 0;
+  for (int b = 0; b < batch_size; b++) {
+    const int pages = (past_lengths[b] + new_lengths[b] + page_size - 1) / page_size;
+    for (int p = 0; p < pages; p++) {
+      page_table[b * max_pages_per_sequence + p] = free_pages[next_page++];
+    }
+  }
+
+  RandomValueGenerator random{};
+  std::vector<float> key_cache = random.Uniform<float>({num_pages, num_heads, page_size, head_size}, -1.0f, 1.0f);
+  std::vector<float> value_cache = random.Uniform<float>({num_pages, num_heads, page_size, head_size}, -1.0f, 1.0f);
+
+  // The reference writes the past tokens to the pages as well, so the cache holds them when the op runs.
+  std::vector<PagedAttentionSequence> sequences(batch_size);
+  std::vector<int32_t> no_past(batch_size, 0);
+  for (int b = 0; b < batch_size; b++) {
+    const int64_t total_length = past_lengths[b] + new_lengths[b];
+    sequences[b].keys = random.Uniform<float>({total_length, hidden_size}, -1.0f, 1.0f);
+    sequences[b].values = random.Uniform<float>({total_length, hidden_size}, -1.0f, 1.0f);
+  }
+  std::vector<float> unused_output;
+  ComputePagedAttentionReference(sequences, no_past, page_table, max_pages_per_sequence,
+                                 num_heads, head_size, page_size, key_cache, value_cache, unused_output);
+
+  for (int b = 0; b < batch_size; b++) {
+    sequences[b].queries = random.Uniform<float>({new_lengths[b], hidden_size}, -1.0f, 1.0f);
+  }
+  RunPagedAttention(sequences, past_lengths, page_table, max_pages_per_sequence,
+                    num_heads, head_size, num_pages, page_size, key_cache, value_cache);
+}
+
+TEST(PagedAttentionTest, Decoding) {
+  // One new token per sequence, the past ends inside a page, at the end of a page and spans several pages.
+  RunPagedAttentionTest({5, 16, 47, 0}, {1, 1, 1, 1}, 2, 16, 16);
+  RunPagedAttentionTest({130, 3}, {1, 1}, 4, 32, 64);
+}
+
+TEST(PagedAttentionTest, PromptAndDecoding) {
+  // Sequences that join with their prompt are in the same batch as sequences that decode one token.
+  RunPagedAttentionTest({0, 21, 0, 8}, {37, 1, 5, 1}, 3, 16, 8);
+  RunPagedAttentionTest({0}, {70}, 2, 64, 32);
+}
+
+TEST(PagedAttentionTest, EmptySequence) {
+  RunPagedAttentionTest({4, 9}, {0, 2}, 2, 8, 4);
+}
+
+// Token and position determine the query, key and value of a token.
+static void TokenEmbedding(int64_t request_id, int32_t token, int32_t position, int hidden_size, float* query,
+                           float* key, float* value) {
+  for (int i = 0; i < hidden_size; i++) {
+    query[i] = std::sin(0.37f * token + 0.11f * position + 0.5f * i + 0.07f * request_id);
+    key[i] = std::cos(0.23f * token + 0.05f * position + 0.3f * i);
+    value[i] = std::sin(0.19f * token - 0.13f * position + 0.7f * i);
+  }
+}
+
+// The caller of PagedAttention owns the pages. A sequence that joins the batch runs its prompt, the sequences in
+// the batch then decode one token per step, and a sequence that leaves returns its pages. Later sequences reuse
+// these pages, which still hold the keys and values of the previous owner.
+TEST(PagedAttentionTest, SequencesJoinAndLeave) {
+  constexpr int num_heads = 2;
+  constexpr int head_size = 8;
+  constexpr int hidden_size = num_heads * head_size;
+  constexpr int num_pages = 6;
+  constexpr int page_size = 4;
+
+  struct Request {
+    int64_t id;
+    int join_step;
+    int prompt_length;
+    int steps;  // the prompt step and the decoding steps
+    std::vector<int32_t> pages;
+  };
+  std::vector<Request> requests = {{0, 0, 6, 3, {}}, {1, 0, 3, 5, {}}, {2, 3, 9, 3, {}}, {3, 4, 2, 2, {}}};
+
+  std::vector<int32_t> free_pages(num_pages);
+  std::iota(free_pages.begin(), free_pages.end(), 0);
+  std::vector<int32_t> pages_of_request_0;
+  std::vector<int32_t> pages_of_request_2;
+
+  RandomValueGenerator random{};
+  std::vector<float> key_cache = random.Uniform<float>({num_pages, num_heads, page_size, head_size}, -1.0f, 1.0f);
+  std::vector<float> value_cache = random.Uniform<float>({num_pages, num_heads, page_size, head_size}, -1.0f, 1.0f);
+
+  for (int step = 0; step < 6; step++) {
+    std::vector<Request*> batch;
+    for (Request& request : requests) {
+      if (step >= request.join_step && step < request.join_step + request.steps) {
+        batch.push_back(&request);
+      }
+    }
+
+    const int batch_size = static_cast<int>(batch.size());
+    std::vector<PagedAttentionSequence> sequences(batch_size);
+    std::vector<int32_t> past_lengths(batch_size);
+    std::vector<int> total_lengths(batch_size);
+    int max_pages_per_sequence = 0;
+    for (int b = 0; b < batch_size; b++) {
+      Request& request = *batch[b];
+      const int decoded = step - request.join_step;
+      past_lengths[b] = decoded == 0 ? 0 : request.prompt_length + decoded - 1;
+      total_lengths[b] = request.prompt_length + decoded;
+      while (static_cast<int>(request.pages.size()) * page_size < total_lengths[b]) {
+        ASSERT_FALSE(free_pages.empty());
+        request.pages.push_back(free_pages.back());
+        free_pages.pop_back();
+      }
+      max_pages_per_sequence = std::max(max_pages_per_sequence, static_cast<int>(request.pages.size()));
+
+      PagedAttentionSequence& sequence = sequences[b];
+      sequence.keys.resize(static_cast<size_t>(total_lengths[b]) * hidden_size);
+      sequence.values.resize(static_cast<size_t>(total_lengths[b]) * hidden_size);
+      std::vector<float> query(hidden_size);
+      for (int t = 0; t < total_lengths[b]; t++) {
+        const int32_t token = static_cast<int32_t>(1 + (request.id * 7 + t * 3) % 49);
+        TokenEmbedding(request.id, token, t, hidden_size, query.data(), &sequence.keys[t * hidden_size],
+                       &sequence.values[t * hidden_size]);
+        if (t >= past_lengths[b]) {
+          sequence.queries.insert(sequence.queries.end(), query.begin(), query.end());
+        }
+      }
+    }
+
+    std::vector<int32_t> page_table(static_cast<size_t>(batch_size) * max_pages_per_sequence, -1);
+    for (int b = 0; b < batch_size; b++) {
+      std::copy(batch[b]->pages.begin(), batch[b]->pages.end(), page_table.begin() + b * max_pages_per_sequence);
+    }
+
+    RunPagedAttention(sequences, past_lengths, page_table, max_pages_per_sequence,
+                      num_heads, head_size, num_pages, page_size, key_cache, value_cache);
+
+    // The sequences that ran their last step leave the batch.
+    for (Request* request : batch) {
+      if (step == request->join_step + request->steps - 1) {
+        if (request->id == 0) {
+          pages_of_request_0 = request->pages;
+        } else if (request->id == 2) {
+          pages_of_request_2 = request->pages;
+        }
+        free_pages.insert(free_pages.end(), request->pages.begin(), request->pages.end());
+        request->pages.clear();
+      }
+    }
+  }
+
+  // The sequence that joined after the first one left runs on its pages.
+  EXPECT_TRUE(std::any_of(pages_of_request_2.begin(), pages_of_request_2.end(), [&](int32_t page) {
+    return std::find(pages_of_request_0.begin(), pages_of_request_0.end(), page) != pages_of_request_0.end();
+  }));
+  EXPECT_EQ(free_pages.size(), static_cast<size_t>(num_pages));
+}
+
+}  // namespace test
+}  // namespace onnxruntime
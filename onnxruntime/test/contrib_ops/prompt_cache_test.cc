@@ -0,0 +1,204 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <memory>
+#include <numeric>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/framework/allocator.h"
+#include "core/framework/tensor.h"
+#include "contrib_ops/cpu/transformers/prompt_cache.h"
+#include "test/util/include/asserts.h"
+
+namespace onnxruntime {
+namespace test {
+
+using contrib::transformers::PromptCache;
+
+namespace {
+
+void AddTokens(PromptCache& cache, const std::vector<int32_t>& tokens, size_t block_bytes) {
+  cache.Add(gsl::make_span(tokens), block_bytes, [](size_t block_index, gsl::span<uint8_t> data) {
+    std::fill(data.begin(), data.end(), static_cast<uint8_t>(block_index));
+  });
+}
+
+size_t FindLength(PromptCache& cache, const std::vector<int32_t>& tokens, size_t max_length) {
+  return cache.Find(gsl::make_span(tokens), max_length).size() * static_cast<size_t>(cache.BlockSize());
+}
+
+OrtValue CreateTensor(AllocatorPtr allocator, const TensorShape& shape, const std::vector<float>& data) {
+  OrtValue value;
+  Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), shape, allocator, value);
+  std::copy(data.begin(), data.end(), value.GetMutable<Tensor>()->MutableData<float>());
+  return value;
+}
+
+OrtValue CreateTensor(AllocatorPtr allocator, const TensorShape& shape, const std::vector<int32_t>& data) {
+  OrtValue value;
+  Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(), shape, allocator, value);
+  std::copy(data.begin(), data.end(), value.GetMutable<Tensor>()->MutableData<int32_t>());
+  return value;
+}
+
+}  // namespace
+
+TEST(PromptCacheTest, SharesPrefixBlocks) {
+  PromptCache cache(1024, 4);
+
+  std::vector<int32_t> prompt(10);
+  std::iota(prompt.begin(), prompt.end(), 0);
+  AddTokens(cache, prompt, 8);
+
+  // Only the two full blocks are cached.
+  EXPECT_EQ(cache.NumBlocks(), size_t{2});
+  EXPECT_EQ(cache.SizeInBytes(), size_t{16});
+
+  std::vector<int32_t> same_prefix{0, 1, 2, 3, 4, 5, 6, 7, 100, 101, 102, 103};
+  EXPECT_EQ(FindLength(cache, same_prefix, same_prefix.size()), size_t{8});
+  EXPECT_EQ(FindLength(cache, same_prefix, 7), size_t{4});
+  EXPECT_EQ(FindLength(cache, same_prefix, 3), size_t{0});
+
+  std::vector<int32_t> shorter_prefix{0, 1, 2, 3, 4, 5, 100, 101};
+  EXPECT_EQ(FindLength(cache, shorter_prefix, shorter_prefix.size()), size_t{4});
+
+  // A block is only found after the same previous tokens.
+  std::vector<int32_t> different_start{100, 1, 2, 3, 4, 5, 6, 7};
+  EXPECT_EQ(FindLength(cache, different_start, different_start.size()), size_t{0});
+
+  // Adding a prompt with the same prefix only adds its new blocks.
+  AddTokens(cache, same_prefix, 8);
+  EXPECT_EQ(cache.NumBlocks(), size_t{3});
+  EXPECT_EQ(FindLength(cache, same_prefix, same_prefix.size()), size_t{12});
+
+  auto blocks = cache.Find(gsl::make_span(same_prefix), same_prefix.size());
+  ASSERT_EQ(blocks.size(), size_t{3});
+  EXPECT_EQ(blocks[1]->tokens, (std::vector<int32_t>{4, 5, 6, 7}));
+  EXPECT_EQ(blocks[2]->data, std::vector<uint8_t>(8, 2));
+}
+
+TEST(PromptCacheTest, EvictsLeastRecentlyUsedBlocks) {
+  PromptCache cache(24, 4);
+
+  std::vector<int32_t> first{0, 1, 2, 3, 4, 5, 6, 7};
+  std::vector<int32_t> second{10, 11, 12, 13, 14, 15, 16, 17};
+  AddTokens(cache, first, 8);
+  AddTokens(cache, second, 8);
+
+  // The end of the least recently used prompt is evicted first.
+  EXPECT_EQ(cache.NumBlocks(), size_t{3});
+  EXPECT_EQ(cache.SizeInBytes(), size_t{24});
+  EXPECT_EQ(FindLength(cache, first, first.size()), size_t{4});
+  EXPECT_EQ(FindLength(cache, second, second.size()), size_t{8});
+
+  // The first prompt was used last, so the end of the second prompt makes room for it.
+  AddTokens(cache, first, 8);
+  EXPECT_EQ(cache.NumBlocks(), size_t{3});
+  EXPECT_EQ(FindLength(cache, first, first.size()), size_t{8});
+  EXPECT_EQ(FindLength(cache, second, second.size()), size_t{4});
+
+  // Blocks larger than the cache are not added.
+  std::vector<int32_t> third{20, 21, 22, 23};
+  AddTokens(cache, third, 32);
+  EXPECT_EQ(cache.NumBlocks(), size_t{3});
+  EXPECT_EQ(FindLength(cache, third, third.size()), size_t{0});
+}
+
+TEST(PromptCacheTest, SeedsGptFeedsFromPresentState) {
+  constexpr int num_layers = 2;
+  constexpr int64_t batch_size = 2;
+  constexpr int64_t num_heads = 2;
+  constexpr int64_t sequence_length = 10;
+  constexpr int64_t head_size = 3;
+  constexpr int first_past_input_index = 3;
+  constexpr int first_present_output_index = 1;
+
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  PromptCache cache(1 << 20, 4);
+
+  std::vector<int32_t> input_ids{0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                 0, 1, 2, 3, 4, 5, 6, 7, 9, 8};
+  std::vector<int32_t> position_ids(input_ids.size());
+  for (size_t i = 0; i < position_ids.size(); i++) {
+    position_ids[i] = static_cast<int32_t>(i % sequence_length);
+  }
+  std::vector<int32_t> attention_mask(input_ids.size(), 1);
+  const TensorShape input_shape{batch_size, sequence_length};
+
+  // The present state of the first run, where each value is unique.
+  const TensorShape present_shape{2, batch_size, num_heads, sequence_length, head_size};
+  std::vector<OrtValue> fetches{OrtValue()};
+  for (int layer = 0; layer < num_layers; layer++) {
+    std::vector<float> present(static_cast<size_t>(present_shape.Size()));
+    std::iota(present.begin(), present.end(), static_cast<float>(layer * present.size()));
+    fetches.push_back(CreateTensor(allocator, present_shape, present));
+  }
+
+  OrtValue input_ids_value = CreateTensor(allocator, input_shape, input_ids);
+  OrtValue attention_mask_value = CreateTensor(allocator, input_shape, attention_mask);
+  ASSERT_STATUS_OK(contrib::transformers::AddGptPromptToPromptCache(
+      cache, input_ids_value.Get<Tensor>(), attention_mask_value.Get<Tensor>(), first_present_output_index,
+      num_layers, fetches));
+  EXPECT_EQ(cache.NumBlocks(), size_t{2});
+
+  auto create_feeds = [&](const std::vector<int32_t>& mask) {
+    std::vector<OrtValue> feeds{CreateTensor(allocator, input_shape, input_ids),
+                                CreateTensor(allocator, input_shape, position_ids),
+                                CreateTensor(allocator, input_shape, mask)};
+    for (int layer = 0; layer < num_layers; layer++) {
+      feeds.push_back(CreateTensor(allocator, TensorShape{2, batch_size, num_heads, 0, head_size},
+                                   std::vector<float>()));
+    }
+    return feeds;
+  };
+
+  // The rows have the same first 8 tokens, so they share the blocks added from the first row.
+  std::vector<OrtValue> feeds = create_feeds(attention_mask);
+  int cached_length = -1;
+  ASSERT_STATUS_OK(contrib::transformers::SeedGptFeedsFromPromptCache(
+      cache, first_past_input_index, num_layers, allocator, feeds, cached_length));
+  ASSERT_EQ(cached_length, 8);
+
+  const int64_t new_length = sequence_length - cached_length;
+  ASSERT_EQ(feeds[0].Get<Tensor>().Shape(), TensorShape({batch_size, new_length}));
+  ASSERT_EQ(feeds[1].Get<Tensor>().Shape(), TensorShape({batch_size, new_length}));
+  for (int64_t b = 0; b < batch_size; b++) {
+    for (int64_t s = 0; s < new_length; s++) {
+      const size_t i = static_cast<size_t>(b * new_length + s);
+      const size_t j = static_cast<size_t>(b * sequence_length + cached_length + s);
+      EXPECT_EQ(feeds[0].Get<Tensor>().Data<int32_t>()[i], input_ids[j]);
+      EXPECT_EQ(feeds[1].Get<Tensor>().Data<int32_t>()[i], position_ids[j]);
+    }
+  }
+
+  for (int layer = 0; layer < num_layers; layer++) {
+    const Tensor& past = feeds[static_cast<size_t>(first_past_input_index) + layer].Get<Tensor>();
+    ASSERT_EQ(past.Shape(), TensorShape({2, batch_size, num_heads, cached_length, head_size}));
+    const float* present = fetches[static_cast<size_t>(first_present_output_index) + layer].Get<Tensor>().Data<float>();
+    const float* past_data = past.Data<float>();
+    for (int64_t kv = 0; kv < 2; kv++) {
+      for (int64_t b = 0; b < batch_size; b++) {
+        for (int64_t h = 0; h < num_heads; h++) {
+          const float* past_head = past_data + ((kv * batch_size + b) * num_heads + h) * cached_length * head_size;
+          const float* present_head = present + (kv * batch_size * num_heads + h) * sequence_length * head_size;
+          for (int64_t i = 0; i < cached_length * head_size; i++) {
+            EXPECT_EQ(past_head[i], present_head[i]);
+          }
+        }
+      }
+    }
+  }
+
+  // The feeds of prompts with padding are unchanged.
+  std::vector<int32_t> padded_mask(attention_mask);
+  padded_mask[0] = 0;
+  feeds = create_feeds(padded_mask);
+  ASSERT_STATUS_OK(contrib::transformers::SeedGptFeedsFromPromptCache(
+      cache, first_past_input_index, num_layers, allocator, feeds, cached_length));
+  EXPECT_EQ(cached_length, 0);
+  EXPECT_EQ(feeds[0].Get<Tensor>().Shape(), input_shape);
+  EXPECT_EQ(feeds[first_past_input_index].Get<Tensor>().Shape()[3], 0);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
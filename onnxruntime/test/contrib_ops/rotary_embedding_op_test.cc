@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/common/random_generator.h"
+#include "test/providers/provider_test_utils.h"
+#include <cmath>
+
+namespace onnxruntime {
+namespace test {
+
+// Tables of the cosine and sine of position p and angle i with the frequencies of LLaMA.
+static void ComputeRotaryCache(int max_sequence_length, int head_size, std::vector<float>& cos_cache,
+                               std::vector<float>& sin_cache) {
+  const int half_head_size = head_size / 2;
+  cos_cache.resize(static_cast<size_t>(max_sequence_length) * half_head_size);
+  sin_cache.resize(cos_cache.size());
+  for (int p = 0; p < max_sequence_length; p++) {
+    for (int i = 0; i < half_head_size; i++) {
+      const double angle = p * std::pow(10000.0, -2.0 * i / head_size);
+      cos_cache[p * half_head_size + i] = static_cast<float>(std::cos(angle));
+      sin_cache[p * half_head_size + i] = static_cast<float>(std::sin(angle));
+    }
+  }
+}
+
+// Rotates a head with the angles of its position, evaluating the trigonometric functions directly.
+static void RotateHead(const float* x, float* y, int64_t position, int head_size, bool interleaved) {
+  const int half_head_size = head_size / 2;
+  for (int i = 0; i < half_head_size; i++) {
+    const double angle = position * std::pow(10000.0, -2.0 * i / head_size);
+    const int first = interleaved ? 2 * i : i;
+    const int second = interleaved ? 2 * i + 1 : i + half_head_size;
+    y[first] = static_cast<float>(x[first] * std::cos(angle) - x[second] * std::sin(angle));
+    y[second] = static_cast<float>(x[second] * std::cos(angle) + x[first] * std::sin(angle));
+  }
+}
+
+static void RunRotaryEmbeddingTest(int batch_size, int sequence_length, int num_heads, int head_size,
+                                   bool is_4d, bool interleaved, const std::vector<int64_t>& position_ids,
+                                   int max_sequence_length) {
+  std::vector<int64_t> input_dims;
+  if (is_4d) {
+    input_dims = {batch_size, num_heads, sequence_length, head_size};
+  } else {
+    input_dims = {batch_size, sequence_length, num_heads * head_size};
+  }
+
+  RandomValueGenerator random{};
+  std::vector<float> input = random.Uniform<float>(input_dims, -1.0f, 1.0f);
+  std::vector<float> cos_cache;
+  std::vector<float> sin_cache;
+  ComputeRotaryCache(max_sequence_length, head_size, cos_cache, sin_cache);
+
+  const bool is_start_position = position_ids.size() == 1;
+  std::vector<float> output(input.size());
+  for (int b = 0; b < batch_size; b++) {
+    for (int s = 0; s < sequence_length; s++) {
+      const int64_t position = is_start_position ? position_ids[0] + s : position_ids[b * sequence_length + s];
+      for (int n = 0; n < num_heads; n++) {
+        const size_t offset = is_4d ? ((static_cast<size_t>(b) * num_heads + n) * sequence_length + s) * head_size
+                                    : ((static_cast<size_t>(b) * sequence_length + s) * num_heads + n) * head_size;
+        RotateHead(input.data() + offset, output.data() + offset, position, head_size, interleaved);
+      }
+    }
+  }
+
+  std::vector<int64_t> position_dims;
+  if (is_start_position) {
+    position_dims = {1};
+  } else {
+    position_dims = {batch_size, sequence_length};
+  }
+  std::vector<int64_t> cache_dims = {max_sequence_length, head_size / 2};
+
+  OpTester tester("RotaryEmbedding", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("interleaved", interleaved ? 1 : 0);
+  tester.AddInput<float>("input", input_dims, input);
+  tester.AddInput<int64_t>("position_ids", position_dims, position_ids);
+  tester.AddInput<float>("cos_cache", cache_dims, cos_cache);
+  tester.AddInput<float>("sin_cache", cache_dims, sin_cache);
+  tester.AddOutput<float>("output", input_dims, output, false, 1e-5f, 1e-5f);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+TEST(RotaryEmbeddingTest, Prompt) {
+  // Every sequence starts at its own position, as with left padding.
+  RunRotaryEmbeddingTest(2, 5, 3, 16, false, false, {0, 1, 2, 3, 4, 3, 4, 5, 6, 7}, 32);
+  RunRotaryEmbeddingTest(2, 5, 3, 16, false, true, {0, 1, 2, 3, 4, 3, 4, 5, 6, 7}, 32);
+}
+
+TEST(RotaryEmbeddingTest, Decoding) {
+  RunRotaryEmbeddingTest(3, 1, 4, 32, false, false, {17, 2, 63}, 64);
+}
+
+TEST(RotaryEmbeddingTest, StartPosition) {
+  RunRotaryEmbeddingTest(2, 6, 2, 8, false, false, {9}, 16);
+  RunRotaryEmbeddingTest(2, 6, 2, 8, true, true, {9}, 16);
+}
+
+TEST(RotaryEmbeddingTest, FourDimensions) {
+  RunRotaryEmbeddingTest(2, 3, 4, 8, true, false, {0, 1, 2, 5, 6, 7}, 8);
+}
+
+TEST(RotaryEmbeddingTest, PositionOutOfRange) {
+  std::vector<float> cos_cache;
+  std::vector<float> sin_cache;
+  ComputeRotaryCache(4, 8, cos_cache, sin_cache);
+
+  OpTester tester("RotaryEmbedding", 1, onnxruntime::kMSDomain);
+  tester.AddInput<float>("input", {1, 2, 8}, std::vector<float>(16, 1.0f));
+  tester.AddInput<int64_t>("position_ids", {1, 2}, {3, 4});
+  tester.AddInput<float>("cos_cache", {4, 4}, cos_cache);
+  tester.AddInput<float>("sin_cache", {4, 4}, sin_cache);
+  tester.AddOutput<float>("output", {1, 2, 8}, std::vector<float>(16, 1.0f));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectFailure, "is out of the range of 'cos_cache'", {}, nullptr,
+             &execution_providers);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -1,12 +1,21 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <random>
+#include <string>
 #include <vector>
 #include "gtest/gtest.h"
 #include "core/common/gsl.h"
+#include "core/graph/model.h"
 #include "core/session/onnxruntime_cxx_api.h"
+#include "contrib_ops/cpu/transformers/sampling_cpu_helper.h"
 #include "test/common/cuda_op_test_utils.h"
+#include "test/util/include/asserts.h"
 
 extern std::unique_ptr<Ort::Env> ort_env;
 
@@ -156,5 +165,250 @@ TEST(SamplingTest, Gpt2Sampling_CPU) {
   ASSERT_TRUE(std::equal(expected_output.cbegin(), expected_output.cend(), result_span.begin(), result_span.end()));
 }
 #endif
+
+TEST(SamplingTest, Gpt2SamplingSpeculativeDecoding_CPU) {
+  std::vector<int32_t> input_ids{
+      0, 0, 0, 0, 0, 52, 195, 731, 321, 301, 734, 620,
+      41, 554, 74, 622, 206, 222, 75, 223, 221, 198, 224, 572,
+      0, 0, 0, 52, 328, 219, 328, 206, 288, 227, 896, 328};
+
+  const int64_t batch_size = 3;
+  const int64_t sequence_length = 12;
+  const int32_t max_length_value = 24;
+  const int32_t vocab_size = 1000;
+  std::vector<int64_t> input_ids_shape{batch_size, sequence_length};
+  std::vector<int64_t> parameter_shape{1};
+
+  // The decoder is also used as draft_decoder, which exercises the verification and rollback of speculative
+  // sampling.
+  ONNX_NAMESPACE::ModelProto model_proto;
+  ASSERT_STATUS_OK(Model::Load(ORT_TSTR("testdata/transformers/tiny_gpt2_sampling.onnx"), model_proto));
+  for (auto& node : *model_proto.mutable_graph()->mutable_node()) {
+    if (node.op_type() != "Sampling") {
+      continue;
+    }
+    ONNX_NAMESPACE::AttributeProto draft_decoder;
+    for (const auto& attribute : node.attribute()) {
+      if (attribute.name() == "decoder") {
+        draft_decoder = attribute;
+      }
+    }
+    draft_decoder.set_name("draft_decoder");
+    *node.add_attribute() = draft_decoder;
+  }
+  std::string model_data;
+  ASSERT_TRUE(model_proto.SerializeToString(&model_data));
+
+  auto run = [&]() {
+    std::vector<int32_t> max_length{max_length_value};
+    std::vector<int32_t> min_length{1};
+    std::vector<float> repetition_penalty{1.0f};
+
+    Ort::MemoryInfo info("Cpu", OrtDeviceAllocator, 0, OrtMemTypeDefault);
+    std::vector<Ort::Value> ort_inputs;
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, input_ids.data(), input_ids.size(), input_ids_shape.data(), input_ids_shape.size()));
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, max_length.data(), max_length.size(), parameter_shape.data(), parameter_shape.size()));
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, min_length.data(), min_length.size(), parameter_shape.data(), parameter_shape.size()));
+    ort_inputs.push_back(Ort::Value::CreateTensor(
+        info, repetition_penalty.data(), repetition_penalty.size(), parameter_shape.data(), parameter_shape.size()));
+    const char* input_names[] = {"input_ids", "max_length", "min_length", "repetition_penalty"};
+    const char* const output_names[] = {"sequences"};
+
+    Ort::SessionOptions session_options;
+    Ort::Session session(*ort_env, model_data.data(), model_data.size(), session_options);
+    auto ort_outputs = session.Run(Ort::RunOptions{}, input_names, ort_inputs.data(), ort_inputs.size(),
+                                   output_names, 1);
+
+    const auto& sequences = ort_outputs[0];
+    auto result_ts = sequences.GetTensorTypeAndShapeInfo();
+    EXPECT_EQ(ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32, result_ts.GetElementType());
+    EXPECT_EQ(result_ts.GetShape(), (std::vector<int64_t>{batch_size, max_length_value}));
+    const auto* result_vals = sequences.GetTensorData<int32_t>();
+    return std::vector<int32_t>(result_vals, result_vals + result_ts.GetElementCount());
+  };
+
+  const std::vector<int32_t> output = run();
+  ASSERT_EQ(output.size(), static_cast<size_t>(batch_size * max_length_value));
+  for (int64_t b = 0; b < batch_size; b++) {
+    // The prompt is kept and every generated token is in the vocabulary.
+    for (int64_t t = 0; t < sequence_length; t++) {
+      EXPECT_EQ(output[b * max_length_value + t], input_ids[b * sequence_length + t]);
+    }
+    for (int64_t t = sequence_length; t < max_length_value; t++) {
+      EXPECT_GE(output[b * max_length_value + t], 0);
+      EXPECT_LT(output[b * max_length_value + t], vocab_size);
+    }
+  }
+
+  // The default seed makes speculative sampling deterministic as well.
+  EXPECT_EQ(run(), output);
+}
+
+namespace {
+
+// Top-p filtering of one row by sorting the whole vocabulary, followed by torch.multinomial().
+int32_t ReferenceSample(std::vector<float>& scores, const contrib::transformers::IGenerationParameters& parameters,
+                        double uniform) {
+  const size_t vocab_size = scores.size();
+  std::vector<int32_t> sorted_indices(vocab_size);
+  std::iota(sorted_indices.begin(), sorted_indices.end(), 0);
+  std::sort(sorted_indices.begin(), sorted_indices.end(), [&scores](int32_t a, int32_t b) {
+    return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+  });
+
+  const float max_score = scores[sorted_indices[0]];
+  double sum = 0.0;
+  for (float score : scores) {
+    sum += std::exp(static_cast<double>(score) - max_score);
+  }
+
+  std::vector<bool> removed(vocab_size, false);
+  if (parameters.custom_sampling) {
+    float cumulative_prob = 0.0f;
+    for (size_t i = 0; i + 1 < vocab_size; i++) {
+      cumulative_prob += static_cast<float>(std::exp(static_cast<double>(scores[sorted_indices[i]]) - max_score) / sum);
+      if (cumulative_prob > parameters.top_p) {
+        removed[sorted_indices[i + 1]] = true;
+      }
+    }
+  } else {
+    // The tail is accumulated from the token with the lowest score.
+    float cumulative_prob = 0.0f;
+    for (size_t i = vocab_size; i-- > static_cast<size_t>(parameters.min_tokens_to_keep);) {
+      cumulative_prob += static_cast<float>(std::exp(static_cast<double>(scores[sorted_indices[i]]) - max_score) / sum);
+      if (cumulative_prob <= 1.0f - parameters.top_p) {
+        removed[sorted_indices[i]] = true;
+      }
+    }
+    removed[sorted_indices[0]] = false;
+  }
+
+  double total = 0.0;
+  std::vector<double> cdf(vocab_size);
+  for (size_t i = 0; i < vocab_size; i++) {
+    if (removed[i]) {
+      scores[i] = parameters.filter_value;
+    } else {
+      total += std::exp(static_cast<double>(scores[i]) - max_score);
+    }
+    cdf[i] = total;
+  }
+  return static_cast<int32_t>(std::upper_bound(cdf.begin(), cdf.end(), uniform * total) - cdf.begin());
+}
+
+void RunSamplingCpuHelperTest(float top_p, int min_tokens_to_keep, bool custom_sampling) {
+  constexpr int batch_size = 4;
+  constexpr int vocab_size = 1000;
+  constexpr int seed = 17;
+
+  contrib::transformers::IGenerationParameters parameters{};
+  parameters.batch_size = batch_size;
+  parameters.vocab_size = vocab_size;
+  parameters.top_p = top_p;
+  parameters.min_tokens_to_keep = min_tokens_to_keep;
+  parameters.custom_sampling = custom_sampling;
+  parameters.filter_value = -std::numeric_limits<float>::infinity();
+
+  std::vector<float> probs(batch_size * vocab_size);
+  std::vector<int32_t> candidate_indices(batch_size * vocab_size);
+  std::vector<int32_t> next_tokens(batch_size);
+  contrib::transformers::ISamplingState<float> sampling_state;
+  sampling_state.generator = std::default_random_engine{seed};
+  sampling_state.probs = gsl::make_span(probs);
+  sampling_state.candidate_indices = gsl::make_span(candidate_indices);
+  contrib::transformers::IGreedySearchState<float> greedy_state;
+  greedy_state.next_tokens = gsl::make_span(next_tokens);
+
+  std::default_random_engine reference_generator{seed};
+  std::uniform_real_distribution<double> uniform_distribution(0.0, 1.0);
+  std::default_random_engine score_generator{static_cast<unsigned>(vocab_size + min_tokens_to_keep)};
+  std::normal_distribution<float> score_distribution(0.0f, 3.0f);
+
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  for (int step = 0; step < 3; step++) {
+    std::vector<float> scores(batch_size * vocab_size);
+    for (float& score : scores) {
+      score = score_distribution(score_generator);
+    }
+    // Tokens masked by logits processors are never sampled.
+    scores[vocab_size + 1] = -std::numeric_limits<float>::infinity();
+
+    std::vector<float> expected_scores = scores;
+    std::vector<int32_t> expected_tokens(batch_size);
+    for (int i = 0; i < batch_size; i++) {
+      std::vector<float> row(expected_scores.begin() + i * vocab_size, expected_scores.begin() + (i + 1) * vocab_size);
+      expected_tokens[i] = ReferenceSample(row, parameters, uniform_distribution(reference_generator));
+      std::copy(row.begin(), row.end(), expected_scores.begin() + i * vocab_size);
+    }
+
+    gsl::span<float> next_token_scores = gsl::make_span(scores);
+    ASSERT_STATUS_OK(contrib::SamplingCpuHelper::Sample<float>(allocator, nullptr, next_token_scores,
+                                                               &sampling_state, &greedy_state, &parameters,
+                                                               nullptr));
+    EXPECT_EQ(next_tokens, expected_tokens);
+    EXPECT_EQ(scores, expected_scores);
+  }
+}
+
+}  // namespace
+
+TEST(SamplingTest, CpuHelperFilterWithoutSampling) {
+  constexpr int batch_size = 3;
+  constexpr int vocab_size = 500;
+  constexpr int seed = 5;
+
+  contrib::transformers::IGenerationParameters parameters{};
+  parameters.batch_size = batch_size;
+  parameters.vocab_size = vocab_size;
+  parameters.top_p = 0.6f;
+  parameters.filter_value = -std::numeric_limits<float>::infinity();
+
+  std::default_random_engine score_generator{static_cast<unsigned>(seed)};
+  std::normal_distribution<float> score_distribution(0.0f, 3.0f);
+  std::vector<float> scores(batch_size * vocab_size);
+  for (float& score : scores) {
+    score = score_distribution(score_generator);
+  }
+  std::vector<float> sampled_scores = scores;
+
+  std::vector<float> probs(batch_size * vocab_size);
+  std::vector<int32_t> candidate_indices(batch_size * vocab_size);
+  std::vector<int32_t> next_tokens(batch_size);
+  contrib::transformers::ISamplingState<float> sampling_state;
+  sampling_state.generator = std::default_random_engine{seed};
+  sampling_state.probs = gsl::make_span(probs);
+  sampling_state.candidate_indices = gsl::make_span(candidate_indices);
+  contrib::transformers::IGreedySearchState<float> greedy_state;
+  greedy_state.next_tokens = gsl::make_span(next_tokens);
+
+  // Filtering leaves the scores that Sample() samples from and does not draw from the generator.
+  gsl::span<float> next_token_scores = gsl::make_span(scores);
+  contrib::SamplingCpuHelper::FilterNextTokenScores<float>(nullptr, next_token_scores, &sampling_state, &parameters);
+  EXPECT_EQ(sampling_state.generator, std::default_random_engine{seed});
+
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  gsl::span<float> sampled_next_token_scores = gsl::make_span(sampled_scores);
+  ASSERT_STATUS_OK(contrib::SamplingCpuHelper::Sample<float>(allocator, nullptr, sampled_next_token_scores,
+                                                             &sampling_state, &greedy_state, &parameters, nullptr));
+  EXPECT_EQ(scores, sampled_scores);
+}
+
+TEST(SamplingTest, CpuHelperTopP) {
+  for (float top_p : {0.0f, 0.3f, 0.9f, 0.999f, 1.0f}) {
+    for (int min_tokens_to_keep : {0, 1, 5}) {
+      RunSamplingCpuHelperTest(top_p, min_tokens_to_keep, false);
+    }
+  }
+}
+
+TEST(SamplingTest, CpuHelperCustomTopP) {
+  for (float top_p : {0.0f, 0.3f, 0.9f, 0.95f}) {
+    RunSamplingCpuHelperTest(top_p, 0, true);
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -543,6 +543,54 @@ TEST(SkipLayerNormTest, SkipLayerNormBatch2_Bias_ProducingOptionalOutput) {
           hidden_size);
 }
 
+// The CPU float16 kernel computes in float and rounds the outputs.
+TEST(SkipLayerNormTest, SkipLayerNormBatch2_Bias_ProducingOptionalOutput_Float16_CPU) {
+  std::vector<int64_t> dims = {2, 2, 4};
+  std::vector<int64_t> vector_dims = {4};
+
+  std::vector<float> input_data = {
+      0.7f, -0.4f, -0.2f, 1.2f,
+      0.4f, 0.3f, 0.1f, -0.4f,
+      0.7f, -0.4f, -0.2f, 1.2f,
+      0.4f, 0.3f, 0.1f, -0.4f};
+
+  std::vector<float> skip_data = {
+      0.1f, -0.2f, 0.3f, 1.0f,
+      0.5f, 0.1f, 0.4f, 1.6f,
+      1.8f, -0.3f, 0.0f, 1.f,
+      -0.5f, 0.4f, 0.8f, -0.6f};
+
+  std::vector<float> bias_data = {
+      0.1f, -0.1f, 0.2f, -0.2f};
+
+  std::vector<float> output_data = {
+      0.28433859348297119f, -0.17090578377246857f, -0.92897164821624756f, 4.6924152374267578f,
+      0.46111652255058289f, -0.21333980560302734f, -0.29631003737449646f, 3.5148544311523438f,
+      0.55470430850982666f, -0.15080101788043976f, -2.3229825496673584f, 3.255286693572998f,
+      0.15631480515003204f, 0.21066918969154358f, 4.9432611465454102f, -1.7957965135574341f};
+
+  std::vector<float> sum_data(input_data.size());
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    sum_data[i] = input_data[i] + skip_data[i] + bias_data[i % bias_data.size()];
+  }
+
+  OpTester test("SkipLayerNormalization", 1, onnxruntime::kMSDomain);
+  test.AddInput<MLFloat16>("input", dims, ToFloat16(input_data));
+  test.AddInput<MLFloat16>("skip", dims, ToFloat16(skip_data));
+  test.AddInput<MLFloat16>("gamma", vector_dims, ToFloat16({0.3f, 0.2f, 4.0f, 2.2f}));
+  test.AddInput<MLFloat16>("beta", vector_dims, ToFloat16({0.2f, 0.1f, 0.4f, 1.6f}));
+  test.AddInput<MLFloat16>("bias", vector_dims, ToFloat16(bias_data));
+  test.AddAttribute("epsilon", epsilon_);
+  test.AddOutput<MLFloat16>("output", dims, ToFloat16(output_data));
+  test.AddOptionalOutputEdge<MLFloat16>();
+  test.AddOptionalOutputEdge<MLFloat16>();
+  test.AddOutput<MLFloat16>("skip_input_bias_add_output", dims, ToFloat16(sum_data));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
 TEST(SkipLayerNormTest, SkipLayerNormBatch1_Float16_vec_token_count) {
   int batch_size = 1;
   int sequence_length = 2;
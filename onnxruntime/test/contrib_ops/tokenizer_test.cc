@@ -277,6 +277,35 @@ TEST(ContribOpTest, TokenizerCharLevel_MixedCharsWithMarkersC) {
   }
 }
 
+TEST(ContribOpTest, TokenizerCharLevel_AsciiAndMixedCharsWithMarkersNC) {
+  // Char level tokenezation of ASCII strings longer than a word of 8 bytes,
+  // an empty string and a string which is ASCII except for its last char
+  // with start/end text markers
+  // [N][C] dimensions
+  // Output [N][C][D]
+  {
+    OpTester test("Tokenizer", opset_ver, domain);
+    InitTestAttr(test, true, {""}, 1);
+
+    std::vector<int64_t> dims{2, 2};
+    std::vector<std::string> input{"abcdefghij", "", u8"abcdefghiñ", "xyz"};
+    test.AddInput<std::string>("T", dims, input);
+
+    std::vector<int64_t> output_dims(dims);
+    // The longest strings have 10 chars, plus start/end text markers
+    output_dims.push_back(int64_t(10 + 2));
+    std::vector<std::string> output{
+        start_mark, "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", end_mark,
+        start_mark, end_mark, padval, padval, padval, padval, padval, padval, padval, padval, padval, padval,
+        start_mark, "a", "b", "c", "d", "e", "f", "g", "h", "i", u8"ñ", end_mark,
+        start_mark, "x", "y", "z", end_mark, padval, padval, padval, padval, padval, padval, padval};
+
+    test.AddOutput<std::string>("Y", output_dims, output);
+
+    test.Run(OpTester::ExpectResult::kExpectSuccess);
+  }
+}
+
 TEST(ContribOpTest, TokenizerCharLevel_EmptyOutputC) {
   // Special case where empty output is produced
   // For [C] we expect [C][0] output
@@ -677,6 +706,33 @@ TEST(ContribOpTest, TokenizerWithSeparators_MixCharCommonPrefixC) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }  // namespace test
 
+TEST(ContribOpTest, TokenizerWithSeparators_PaddingAcrossRowsWithMarkersC) {
+  // Rows with a different number of tokens after two separators,
+  // one of them with no token left
+  // [C] dimensions
+  // Output [C][D]
+  {
+    OpTester test("Tokenizer", opset_ver, domain);
+    InitTestAttr(test, true, {" ", ","}, 1);
+
+    std::vector<int64_t> dims{3};
+    std::vector<std::string> input{"a,bc def", " ,", "gh"};
+    test.AddInput<std::string>("T", dims, input);
+
+    std::vector<int64_t> output_dims(dims);
+    // The first row has 3 tokens, plus start/end text markers
+    output_dims.push_back(int64_t(3 + 2));
+    std::vector<std::string> output{
+        start_mark, "a", "bc", "def", end_mark,
+        start_mark, end_mark, padval, padval, padval,
+        start_mark, "gh", end_mark, padval, padval};
+
+    test.AddOutput<std::string>("Y", output_dims, output);
+
+    test.Run(OpTester::ExpectResult::kExpectSuccess);
+  }
+}
+
 TEST(ContribOpTest, TokenizerExpression_RegEx) {
   OpTester test("Tokenizer", opset_ver, domain);
   const std::string tokenexp(u8"a.");
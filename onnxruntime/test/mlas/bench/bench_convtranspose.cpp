@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mlas.h"
+#include "bench_util.h"
+
+#include <stdexcept>
+
+static const std::vector<std::string> convtranspose_bench_arg_names = {"N", "Cin", "Cout", "H", "W", "K", "S", "P"};
+
+//
+// Square two dimensional transposed convolutions with symmetric padding.
+//
+void CONVTRANSPOSE(benchmark::State& state) {
+  for (size_t i = 0; i < 8; i++) {
+    if (state.range(i) < 0 || (i < 7 && state.range(i) == 0)) throw std::invalid_argument("Invalid argument!");
+  }
+
+  const size_t batch = static_cast<size_t>(state.range(0));
+  const size_t input_channels = static_cast<size_t>(state.range(1));
+  const size_t filter_count = static_cast<size_t>(state.range(2));
+  const int64_t height = state.range(3);
+  const int64_t width = state.range(4);
+  const int64_t kernel = state.range(5);
+  const int64_t stride = state.range(6);
+  const int64_t pad = state.range(7);
+
+  const int64_t input_shape[] = {height, width};
+  const int64_t kernel_shape[] = {kernel, kernel};
+  const int64_t dilations[] = {1, 1};
+  const int64_t padding[] = {pad, pad, pad, pad};
+  const int64_t strides[] = {stride, stride};
+  const int64_t output_shape[] = {stride * (height - 1) + kernel - 2 * pad, stride * (width - 1) + kernel - 2 * pad};
+
+  auto input = RandomVectorUniform(batch * input_channels * static_cast<size_t>(height * width), -1.0f, 1.0f);
+  auto filter = RandomVectorUniform(input_channels * filter_count * static_cast<size_t>(kernel * kernel), -1.0f, 1.0f);
+  auto bias = RandomVectorUniform(filter_count, -1.0f, 1.0f);
+  std::vector<float> output(batch * filter_count * static_cast<size_t>(output_shape[0] * output_shape[1]));
+  std::vector<float> packed_filter(
+      MlasConvTransposePackFilterSize(1, input_channels, filter_count, kernel_shape) / sizeof(float));
+
+  MlasConvTransposePackFilter(1, input_channels, filter_count, kernel_shape, dilations, strides,
+                              filter.data(), packed_filter.data());
+
+  MLAS_CONV_TRANSPOSE_PARAMETERS parameters;
+  size_t working_buffer_size;
+  MlasConvTransposePrepare(&parameters, batch, 1, input_channels, input_shape, kernel_shape, dilations, padding,
+                           strides, output_shape, filter_count, &working_buffer_size, nullptr);
+  std::vector<float> working_buffer(working_buffer_size);
+
+  MlasConvTranspose(&parameters, input.data(), packed_filter.data(), bias.data(), working_buffer.data(),
+                    output.data(), nullptr);
+
+  for (auto _ : state) {
+    MlasConvTranspose(&parameters, input.data(), packed_filter.data(), bias.data(), working_buffer.data(),
+                      output.data(), nullptr);
+  }
+}
+
+static void DecoderShapes(benchmark::internal::Benchmark* b) {
+  b->ArgNames(convtranspose_bench_arg_names);
+  // Segmentation decoder upsampling (2x2 stride 2 and 4x4 stride 2).
+  b->Args({1, 256, 128, 32, 32, 2, 2, 0});
+  b->Args({1, 128, 64, 64, 64, 2, 2, 0});
+  b->Args({1, 256, 128, 32, 32, 4, 2, 1});
+  b->Args({1, 64, 32, 128, 128, 4, 2, 1});
+  // Super resolution tail (3x3 stride 2 and 9x9 stride 3).
+  b->Args({1, 64, 64, 64, 64, 3, 2, 1});
+  b->Args({1, 56, 1, 64, 64, 9, 3, 3});
+}
+
+BENCHMARK(CONVTRANSPOSE)->Apply(DecoderShapes)->UseRealTime();
@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mlas.h"
+#include "bench_util.h"
+#include "core/framework/float16.h"
+
+#include <stdexcept>
+
+static const std::vector<std::string> fused_softmax_bench_arg_names = {"Heads", "S", "T"};
+
+template <typename T>
+void FusedSoftmaxImpl(benchmark::State& state, bool causal) {
+  if (state.range(0) <= 0) throw std::invalid_argument("Heads must greater than 0!");
+  if (state.range(1) <= 0) throw std::invalid_argument("S must greater than 0!");
+  if (state.range(2) < state.range(1)) throw std::invalid_argument("T must not be less than S!");
+
+  const size_t heads = static_cast<size_t>(state.range(0));
+  const size_t S = static_cast<size_t>(state.range(1));
+  const size_t T_ = static_cast<size_t>(state.range(2));
+  const size_t count = heads * S * T_;
+
+  auto input = RandomVectorUniform(count, -4.0f, 4.0f);
+  auto mask = RandomVectorUniform(S * T_, -1.0f, 0.0f);
+  auto bias = RandomVectorUniform(count, -1.0f, 1.0f);
+  std::vector<T> output(count);
+
+  MLAS_FUSED_SOFTMAX_PARAMS params;
+  params.HeadCount = heads;
+  params.SequenceLength = S;
+  params.TotalSequenceLength = T_;
+  params.Scale = 0.125f;
+  params.Mask.Data = mask.data();
+  params.Mask.RowStride = T_;
+  params.Bias.Data = bias.data();
+  params.Bias.HeadStride = S * T_;
+  params.Bias.RowStride = T_;
+  params.Causal = causal;
+  params.PastSequenceLength = T_ - S;
+
+  MlasComputeFusedSoftmax<T>(input.data(), output.data(), params, nullptr);
+
+  for (auto _ : state) {
+    MlasComputeFusedSoftmax<T>(input.data(), output.data(), params, nullptr);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * count * (2 * sizeof(float) + sizeof(T)));
+}
+
+void FUSED_SOFTMAX(benchmark::State& state, bool fp16, bool causal) {
+  if (fp16) {
+    FusedSoftmaxImpl<MLAS_FP16>(state, causal);
+  } else {
+    FusedSoftmaxImpl<float>(state, causal);
+  }
+}
+
+static void FusedSoftmaxSizes(benchmark::internal::Benchmark* b) {
+  b->ArgNames(fused_softmax_bench_arg_names);
+  // BERT style encoder shapes and single token decoding against a long past.
+  b->Args({12, 128, 128});
+  b->Args({12, 384, 384});
+  b->Args({16, 512, 512});
+  b->Args({32, 1, 2048});
+}
+
+BENCHMARK_CAPTURE(FUSED_SOFTMAX, Float, false, false)->Apply(FusedSoftmaxSizes)->UseRealTime();
+BENCHMARK_CAPTURE(FUSED_SOFTMAX, Float_Causal, false, true)->Apply(FusedSoftmaxSizes)->UseRealTime();
+BENCHMARK_CAPTURE(FUSED_SOFTMAX, Fp16, true, false)->Apply(FusedSoftmaxSizes)->UseRealTime();
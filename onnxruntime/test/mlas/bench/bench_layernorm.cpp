@@ -0,0 +1,78 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mlas.h"
+#include "bench_util.h"
+#include "core/framework/float16.h"
+
+#include <stdexcept>
+
+static const std::vector<std::string> layernorm_bench_arg_names = {"Rows", "N"};
+
+template <typename T>
+static std::vector<T> ToBenchType(const std::vector<float>& v) {
+  std::vector<T> r;
+  r.reserve(v.size());
+  for (float f : v) {
+    r.push_back(T(f));
+  }
+  return r;
+}
+
+template <typename T>
+void LayerNormImpl(benchmark::State& state, bool simplified, bool skip) {
+  if (state.range(0) <= 0) throw std::invalid_argument("Rows must greater than 0!");
+  if (state.range(1) <= 0) throw std::invalid_argument("N must greater than 0!");
+
+  const size_t rows = static_cast<size_t>(state.range(0));
+  const size_t N = static_cast<size_t>(state.range(1));
+
+  auto input = ToBenchType<T>(RandomVectorUniform(rows * N, -2.0f, 2.0f));
+  auto skip_data = ToBenchType<T>(RandomVectorUniform(rows * N, -1.0f, 1.0f));
+  auto bias = ToBenchType<T>(RandomVectorUniform(N, -0.5f, 0.5f));
+  auto gamma = ToBenchType<T>(RandomVectorUniform(N, 0.5f, 1.5f));
+  auto beta = ToBenchType<T>(RandomVectorUniform(N, -0.5f, 0.5f));
+  std::vector<T> output(rows * N);
+  std::vector<T> skip_output(rows * N);
+
+  auto run = [&]() {
+    for (size_t r = 0; r < rows; r++) {
+      MlasLayerNormalization<T>(input.data() + r * N,
+                                skip ? skip_data.data() + r * N : nullptr,
+                                skip ? bias.data() : nullptr,
+                                gamma.data(),
+                                simplified ? nullptr : beta.data(),
+                                output.data() + r * N,
+                                skip ? skip_output.data() + r * N : nullptr,
+                                N, 1e-5f, simplified, nullptr, nullptr);
+    }
+  };
+
+  run();
+
+  for (auto _ : state) {
+    run();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * rows * N * sizeof(T) * (skip ? 4 : 2));
+}
+
+void LAYERNORM(benchmark::State& state, bool fp16, bool simplified, bool skip) {
+  if (fp16) {
+    LayerNormImpl<MLAS_FP16>(state, simplified, skip);
+  } else {
+    LayerNormImpl<float>(state, simplified, skip);
+  }
+}
+
+static void LayerNormSizes(benchmark::internal::Benchmark* b) {
+  b->ArgNames(layernorm_bench_arg_names);
+  ArgsProduct(b, {{1, 128}, {768, 1024, 4096, 5120}});
+}
+
+BENCHMARK_CAPTURE(LAYERNORM, LayerNorm_Float, false, false, false)->Apply(LayerNormSizes)->UseRealTime();
+BENCHMARK_CAPTURE(LAYERNORM, RMSNorm_Float, false, true, false)->Apply(LayerNormSizes)->UseRealTime();
+BENCHMARK_CAPTURE(LAYERNORM, SkipLayerNorm_Float, false, false, true)->Apply(LayerNormSizes)->UseRealTime();
+BENCHMARK_CAPTURE(LAYERNORM, LayerNorm_Fp16, true, false, false)->Apply(LayerNormSizes)->UseRealTime();
+BENCHMARK_CAPTURE(LAYERNORM, RMSNorm_Fp16, true, true, false)->Apply(LayerNormSizes)->UseRealTime();
+BENCHMARK_CAPTURE(LAYERNORM, SkipLayerNorm_Fp16, true, false, true)->Apply(LayerNormSizes)->UseRealTime();
@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mlas.h"
+#include "bench_util.h"
+#include "core/framework/float16.h"
+
+#include <stdexcept>
+
+static const std::vector<std::string> reduce_bench_arg_names = {"Pattern", "Size"};
+
+//
+// The common axis patterns of an NCHW tensor of shape {8, 64, Size, Size}.
+//
+
+struct ReduceBenchPattern {
+  const char* Name;
+  bool Axes[4];
+};
+
+static const ReduceBenchPattern reduce_bench_patterns[] = {
+    {"W", {false, false, false, true}},       // last axis (softmax style)
+    {"HW", {false, false, true, true}},       // global pooling
+    {"NHW", {true, false, true, true}},       // batch statistics
+    {"C", {false, true, false, false}},       // channel reduction
+    {"N", {true, false, false, false}},       // leading axis
+    {"NCHW", {true, true, true, true}},       // full reduction
+};
+
+template <typename T>
+void ReduceImpl(benchmark::State& state, MLAS_REDUCE_KIND kind) {
+  const auto pattern = static_cast<size_t>(state.range(0));
+  if (pattern >= std::size(reduce_bench_patterns)) throw std::invalid_argument("Unknown pattern!");
+  if (state.range(1) <= 0) throw std::invalid_argument("Size must greater than 0!");
+
+  const size_t size = static_cast<size_t>(state.range(1));
+  const size_t shape[4] = {8, 64, size, size};
+  const size_t count = shape[0] * shape[1] * shape[2] * shape[3];
+
+  auto values = RandomVectorUniform(count, -2.0f, 2.0f);
+  std::vector<T> input;
+  input.reserve(count);
+  for (float f : values) {
+    input.push_back(T(f));
+  }
+  std::vector<T> output(count);
+
+  const bool* axes = reduce_bench_patterns[pattern].Axes;
+  state.SetLabel(reduce_bench_patterns[pattern].Name);
+
+  MLAS_THREADPOOL* tp = nullptr;
+
+  MlasReduce<T>(kind, 4, shape, axes, input.data(), output.data(), tp);
+
+  for (auto _ : state) {
+    MlasReduce<T>(kind, 4, shape, axes, input.data(), output.data(), tp);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * count * sizeof(T));
+}
+
+void REDUCE(benchmark::State& state, bool fp16, MLAS_REDUCE_KIND kind) {
+  if (fp16) {
+    ReduceImpl<MLAS_FP16>(state, kind);
+  } else {
+    ReduceImpl<float>(state, kind);
+  }
+}
+
+void REDUCE_MEAN_VARIANCE(benchmark::State& state) {
+  const auto pattern = static_cast<size_t>(state.range(0));
+  if (pattern >= std::size(reduce_bench_patterns)) throw std::invalid_argument("Unknown pattern!");
+  if (state.range(1) <= 0) throw std::invalid_argument("Size must greater than 0!");
+
+  const size_t size = static_cast<size_t>(state.range(1));
+  const size_t shape[4] = {8, 64, size, size};
+  const size_t count = shape[0] * shape[1] * shape[2] * shape[3];
+
+  auto input = RandomVectorUniform(count, -2.0f, 2.0f);
+  std::vector<float> mean(count);
+  std::vector<float> variance(count);
+
+  const bool* axes = reduce_bench_patterns[pattern].Axes;
+  state.SetLabel(reduce_bench_patterns[pattern].Name);
+
+  MLAS_THREADPOOL* tp = nullptr;
+
+  MlasReduceMeanVariance(4, shape, axes, input.data(), mean.data(), variance.data(), tp);
+
+  for (auto _ : state) {
+    MlasReduceMeanVariance(4, shape, axes, input.data(), mean.data(), variance.data(), tp);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * count * sizeof(float));
+}
+
+static void ReduceSizes(benchmark::internal::Benchmark* b) {
+  b->ArgNames(reduce_bench_arg_names);
+  ArgsProduct(b, {{0, 1, 2, 3, 4, 5}, {7, 28, 56}});
+}
+
+BENCHMARK_CAPTURE(REDUCE, Sum_Float, false, MlasReduceSum)->Apply(ReduceSizes)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, Mean_Float, false, MlasReduceMean)->Apply(ReduceSizes)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, SumSquare_Float, false, MlasReduceSumSquare)->Apply(ReduceSizes)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, Max_Float, false, MlasReduceMax)->Apply(ReduceSizes)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, Min_Float, false, MlasReduceMin)->Apply(ReduceSizes)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, Sum_Fp16, true, MlasReduceSum)->Apply(ReduceSizes)->UseRealTime();
+BENCHMARK_CAPTURE(REDUCE, Max_Fp16, true, MlasReduceMax)->Apply(ReduceSizes)->UseRealTime();
+BENCHMARK(REDUCE_MEAN_VARIANCE)->Apply(ReduceSizes)->UseRealTime();
@@ -5,6 +5,7 @@
 #include "bench_util.h"
 
 #include <stdexcept>
+#include <memory>
 #include <numeric>
 
 static std::vector<std::string> BuildArgNamesForConv(size_t rank) {
@@ -38,8 +39,7 @@ static const std::vector<std::string>& ArgNamesForConv(size_t rank) {
   return rank_to_args_name[rank];
 }
 
-// dummy for some strange build error when using Bench capture
-void SCONV_NCHW(benchmark::State& state, const char* /*dummy*/) {
+static void SconvNchw(benchmark::State& state, bool use_winograd) {
   const int64_t rank = state.range(0);                       // Rank
   const int64_t batch_size = state.range(1);                 // N
   const int64_t groups = state.range(2);                     // G
@@ -91,6 +91,30 @@ void SCONV_NCHW(benchmark::State& state, const char* /*dummy*/) {
   std::vector<int64_t> y_shape = {batch_size, GF};
   y_shape.insert(y_shape.end(), output_shape.begin(), output_shape.end());
 
+  auto X = RandomVectorUniform(x_shape, -2.0, 2.0);
+  auto F = RandomVectorUniform(f_shape, -1.0, 1.0);
+  int64_t y_size = std::accumulate(y_shape.begin(), y_shape.end(), 1LL, std::multiplies<int64_t>());
+  std::vector<float> Y(static_cast<size_t>(y_size));
+
+  // The packed SGEMM kernels require the packed filter to be aligned.
+  std::vector<uint8_t> packed_filter_buffer;
+  void* packed_filter = nullptr;
+  if (use_winograd) {
+    constexpr size_t packed_filter_alignment = 64;
+    size_t packed_filter_size = MlasConvWinogradPackFilterSize(static_cast<size_t>(groups),
+                                                               static_cast<size_t>(input_channels_per_group),
+                                                               static_cast<size_t>(output_channels_per_group));
+    packed_filter_buffer.resize(packed_filter_size + packed_filter_alignment);
+    packed_filter = packed_filter_buffer.data();
+    size_t space = packed_filter_buffer.size();
+    std::align(packed_filter_alignment, packed_filter_size, packed_filter, space);
+    MlasConvWinogradPackFilter(static_cast<size_t>(groups),
+                               static_cast<size_t>(input_channels_per_group),
+                               static_cast<size_t>(output_channels_per_group),
+                               F.data(),
+                               packed_filter);
+  }
+
   MLAS_ACTIVATION activation;
   activation.ActivationKind = MlasIdentityActivation;
   MLAS_CONV_PARAMETERS Parameters;
@@ -110,12 +134,14 @@ void SCONV_NCHW(benchmark::State& state, const char* /*dummy*/) {
                   &activation,
                   &WorkingBufferSize,
                   0.0f,
-                  nullptr);
+                  nullptr,
+                  packed_filter);
+
+  if (use_winograd && Parameters.Algorithm != MlasConvAlgorithmWinograd) {
+    state.SkipWithError("Convolution is not eligible for the Winograd algorithm");
+    return;
+  }
 
-  auto X = RandomVectorUniform(x_shape, -2.0, 2.0);
-  auto F = RandomVectorUniform(f_shape, -1.0, 1.0);
-  int64_t y_size = std::accumulate(y_shape.begin(), y_shape.end(), 1LL, std::multiplies<int64_t>());
-  std::vector<float> Y(static_cast<size_t>(y_size));
   std::vector<float> working_buffer(WorkingBufferSize);
 
   // warm up first round.
@@ -138,6 +164,15 @@ void SCONV_NCHW(benchmark::State& state, const char* /*dummy*/) {
   }
 }
 
+// dummy for some strange build error when using Bench capture
+void SCONV_NCHW(benchmark::State& state, const char* /*dummy*/) {
+  SconvNchw(state, false);
+}
+
+void SCONV_NCHW_WINOGRAD(benchmark::State& state, const char* /*dummy*/) {
+  SconvNchw(state, true);
+}
+
 static void ResNet50(benchmark::internal::Benchmark* b) {
   b->ArgNames(ArgNamesForConv(2));
 
@@ -246,3 +281,23 @@ static void General_Conv2d(benchmark::internal::Benchmark* b) {
 }
 
 BENCHMARK_CAPTURE(SCONV_NCHW, 2d, "")->Apply(General_Conv2d)->UseRealTime();
+
+static void Winograd_Conv2d(benchmark::internal::Benchmark* b) {
+  b->ArgNames(ArgNamesForConv(2));
+
+  // 3x3 stride 1 convolutions from ResNet50 and detection/segmentation backbones.
+  //    Rank, N, G, Cpg, Fpg,   I,    , K, , P, , , , S, , D, ,
+  b->Args({2, 1, 1, 64, 64, 56, 56, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+  b->Args({2, 1, 1, 128, 128, 28, 28, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+  b->Args({2, 1, 1, 256, 256, 14, 14, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+  b->Args({2, 1, 1, 512, 512, 7, 7, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+  b->Args({2, 1, 1, 32, 32, 160, 160, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+  b->Args({2, 1, 1, 64, 64, 80, 80, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+  b->Args({2, 1, 1, 128, 128, 40, 40, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+  b->Args({2, 1, 1, 256, 256, 20, 20, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+  b->Args({2, 1, 1, 256, 128, 64, 64, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+  b->Args({2, 4, 1, 64, 64, 56, 56, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1});
+}
+
+BENCHMARK_CAPTURE(SCONV_NCHW, Winograd_Shapes, "")->Apply(Winograd_Conv2d)->UseRealTime();
+BENCHMARK_CAPTURE(SCONV_NCHW_WINOGRAD, Winograd_Shapes, "")->Apply(Winograd_Conv2d)->UseRealTime();
@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mlas.h"
+#include "bench_util.h"
+#include "core/framework/float16.h"
+
+#include <stdexcept>
+
+static const std::vector<std::string> topk_bench_arg_names = {"Rows", "N", "K"};
+
+template <typename T>
+void TopKImpl(benchmark::State& state) {
+  if (state.range(0) <= 0) throw std::invalid_argument("Rows must greater than 0!");
+  if (state.range(1) <= 0) throw std::invalid_argument("N must greater than 0!");
+  if (state.range(2) <= 0 || state.range(2) > state.range(1)) throw std::invalid_argument("K must be in [1, N]!");
+
+  const size_t rows = static_cast<size_t>(state.range(0));
+  const size_t N = static_cast<size_t>(state.range(1));
+  const size_t K = static_cast<size_t>(state.range(2));
+
+  auto values = RandomVectorUniform(rows * N, -10.0f, 10.0f);
+  std::vector<T> input;
+  input.reserve(rows * N);
+  for (float f : values) {
+    input.push_back(T(f));
+  }
+  std::vector<T> output(rows * K);
+  std::vector<int64_t> indices(rows * K);
+
+  MlasTopK<T>(input.data(), rows, N, K, true, true, output.data(), indices.data(), nullptr);
+
+  for (auto _ : state) {
+    MlasTopK<T>(input.data(), rows, N, K, true, true, output.data(), indices.data(), nullptr);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * rows * N * sizeof(T));
+}
+
+void TOPK(benchmark::State& state, int type) {
+  if (type == 1) {
+    TopKImpl<MLAS_FP16>(state);
+  } else if (type == 2) {
+    TopKImpl<MLAS_BF16>(state);
+  } else {
+    TopKImpl<float>(state);
+  }
+}
+
+static void TopKSizes(benchmark::internal::Benchmark* b) {
+  b->ArgNames(topk_bench_arg_names);
+  // Vocabulary sampling and recommendation ranking shapes.
+  ArgsProduct(b, {{1, 16}, {50257, 250000, 1000000}, {1, 10, 50, 64}});
+}
+
+BENCHMARK_CAPTURE(TOPK, Float, 0)->Apply(TopKSizes)->UseRealTime();
+BENCHMARK_CAPTURE(TOPK, Fp16, 1)->Apply(TopKSizes)->UseRealTime();
+BENCHMARK_CAPTURE(TOPK, Bf16, 2)->Apply(TopKSizes)->UseRealTime();
@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "mlas.h"
+#include "bench_util.h"
+
+#include <numeric>
+#include <stdexcept>
+
+//
+// Shapes are given as the dimensions of a rank 4 input tensor.
+//
+static const std::vector<std::string> transpose_bench_arg_names = {"D0", "D1", "D2", "D3"};
+
+void TRANSPOSE_ND(benchmark::State& state, size_t element_size, std::vector<size_t> permutation) {
+  std::vector<size_t> shape(4);
+  for (size_t d = 0; d < 4; d++) {
+    if (state.range(d) <= 0) throw std::invalid_argument("Dimensions must greater than 0!");
+    shape[d] = static_cast<size_t>(state.range(d));
+  }
+
+  const size_t bytes = std::accumulate(shape.begin(), shape.end(), element_size, std::multiplies<size_t>());
+  std::vector<uint8_t> input(bytes);
+  std::vector<uint8_t> output(bytes);
+  std::iota(input.begin(), input.end(), uint8_t(0));
+
+  MlasTransposeNd(input.data(), output.data(), element_size, shape.size(), shape.data(), permutation.data(), nullptr);
+
+  for (auto _ : state) {
+    MlasTransposeNd(input.data(), output.data(), element_size, shape.size(), shape.data(), permutation.data(), nullptr);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * bytes * 2);
+}
+
+static void AttentionHeadShapes(benchmark::internal::Benchmark* b) {
+  b->ArgNames(transpose_bench_arg_names);
+  // batch, sequence, heads, head size
+  b->Args({1, 128, 12, 64});
+  b->Args({1, 512, 16, 64});
+  b->Args({8, 128, 12, 64});
+  b->Args({1, 2048, 32, 128});
+}
+
+static void ImageShapes(benchmark::internal::Benchmark* b) {
+  b->ArgNames(transpose_bench_arg_names);
+  b->Args({1, 3, 224, 224});
+  b->Args({1, 64, 112, 112});
+  b->Args({1, 256, 56, 56});
+  b->Args({8, 512, 14, 14});
+}
+
+BENCHMARK_CAPTURE(TRANSPOSE_ND, Heads_Float, 4, {0, 2, 1, 3})->Apply(AttentionHeadShapes)->UseRealTime();
+BENCHMARK_CAPTURE(TRANSPOSE_ND, HeadsKT_Float, 4, {0, 2, 3, 1})->Apply(AttentionHeadShapes)->UseRealTime();
+BENCHMARK_CAPTURE(TRANSPOSE_ND, Heads_Fp16, 2, {0, 2, 1, 3})->Apply(AttentionHeadShapes)->UseRealTime();
+BENCHMARK_CAPTURE(TRANSPOSE_ND, NchwToNhwc_Float, 4, {0, 2, 3, 1})->Apply(ImageShapes)->UseRealTime();
+BENCHMARK_CAPTURE(TRANSPOSE_ND, NhwcToNchw_Float, 4, {0, 3, 1, 2})->Apply(ImageShapes)->UseRealTime();
+BENCHMARK_CAPTURE(TRANSPOSE_ND, NchwToNhwc_U8, 1, {0, 2, 3, 1})->Apply(ImageShapes)->UseRealTime();
+BENCHMARK_CAPTURE(TRANSPOSE_ND, NchwToNhwc_Int64, 8, {0, 2, 3, 1})->Apply(ImageShapes)->UseRealTime();
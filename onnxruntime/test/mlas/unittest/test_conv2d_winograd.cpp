@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+template <bool Threaded>
+class MlasConv2DWinogradTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferFilter;
+  MatrixGuardBuffer<float> BufferBias;
+  MatrixGuardBuffer<float> BufferOutput;
+  MatrixGuardBuffer<float> BufferOutputReference;
+  MatrixGuardBuffer<float> BufferWorking;
+  MatrixGuardBuffer<uint8_t> BufferPackedFilter;
+  MLAS_THREADPOOL* threadpool_;
+
+  void ReferenceConv2D(size_t BatchCount,
+                       size_t GroupCount,
+                       size_t InputChannels,
+                       size_t InputHeight,
+                       size_t InputWidth,
+                       size_t FilterCount,
+                       size_t PaddingTop,
+                       size_t PaddingLeft,
+                       size_t OutputHeight,
+                       size_t OutputWidth,
+                       const float* Input,
+                       const float* Filter,
+                       const float* Bias,
+                       bool Relu,
+                       float* Output) {
+    for (size_t bg = 0; bg < BatchCount * GroupCount; bg++) {
+      const size_t g = bg % GroupCount;
+      const float* input = Input + bg * InputChannels * InputHeight * InputWidth;
+
+      for (size_t f = 0; f < FilterCount; f++) {
+        const float* filter = Filter + (g * FilterCount + f) * InputChannels * 9;
+
+        for (size_t oh = 0; oh < OutputHeight; oh++) {
+          for (size_t ow = 0; ow < OutputWidth; ow++) {
+            double sum = Bias[g * FilterCount + f];
+
+            for (size_t c = 0; c < InputChannels; c++) {
+              for (size_t ky = 0; ky < 3; ky++) {
+                size_t ih = oh + ky - PaddingTop;
+                if (ih >= InputHeight) continue;
+
+                for (size_t kx = 0; kx < 3; kx++) {
+                  size_t iw = ow + kx - PaddingLeft;
+                  if (iw >= InputWidth) continue;
+
+                  sum += double(input[(c * InputHeight + ih) * InputWidth + iw]) * double(filter[c * 9 + ky * 3 + kx]);
+                }
+              }
+            }
+
+            if (Relu && sum < 0.0) {
+              sum = 0.0;
+            }
+
+            *Output++ = float(sum);
+          }
+        }
+      }
+    }
+  }
+
+  void Test(size_t BatchCount,
+            size_t GroupCount,
+            size_t InputChannels,
+            size_t InputHeight,
+            size_t InputWidth,
+            size_t FilterCount,
+            size_t PaddingTop,
+            size_t PaddingLeft,
+            size_t PaddingBottom,
+            size_t PaddingRight,
+            bool Relu) {
+    const size_t OutputHeight = InputHeight + PaddingTop + PaddingBottom - 2;
+    const size_t OutputWidth = InputWidth + PaddingLeft + PaddingRight - 2;
+
+    const size_t InputElements = BatchCount * GroupCount * InputChannels * InputHeight * InputWidth;
+    const size_t FilterElements = GroupCount * FilterCount * InputChannels * 9;
+    const size_t BiasElements = GroupCount * FilterCount;
+    const size_t OutputElements = BatchCount * GroupCount * FilterCount * OutputHeight * OutputWidth;
+
+    float* Input = BufferInput.GetBuffer(InputElements);
+    float* Filter = BufferFilter.GetBuffer(FilterElements);
+    float* Bias = BufferBias.GetBuffer(BiasElements);
+    float* Output = BufferOutput.GetBuffer(OutputElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputElements);
+
+    std::default_random_engine generator(static_cast<unsigned>(InputElements + FilterElements));
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    for (size_t i = 0; i < InputElements; i++) {
+      Input[i] = distribution(generator);
+    }
+    for (size_t i = 0; i < FilterElements; i++) {
+      Filter[i] = distribution(generator);
+    }
+    for (size_t i = 0; i < BiasElements; i++) {
+      Bias[i] = distribution(generator);
+    }
+
+    const size_t PackedFilterSize = MlasConvWinogradPackFilterSize(GroupCount, InputChannels, FilterCount);
+    uint8_t* PackedFilter = BufferPackedFilter.GetBuffer(PackedFilterSize, true);
+    MlasConvWinogradPackFilter(GroupCount, InputChannels, FilterCount, Filter, PackedFilter);
+
+    int64_t InputShape[] = {int64_t(InputHeight), int64_t(InputWidth)};
+    int64_t KernelShape[] = {3, 3};
+    int64_t DilationShape[] = {1, 1};
+    int64_t Padding[] = {int64_t(PaddingTop), int64_t(PaddingLeft), int64_t(PaddingBottom), int64_t(PaddingRight)};
+    int64_t StrideShape[] = {1, 1};
+    int64_t OutputShape[] = {int64_t(OutputHeight), int64_t(OutputWidth)};
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = Relu ? MlasReluActivation : MlasIdentityActivation;
+
+    MLAS_CONV_PARAMETERS Parameters;
+    size_t WorkingBufferSize;
+
+    MlasConvPrepare(&Parameters, 2, BatchCount, GroupCount, InputChannels, InputShape, KernelShape,
+                    DilationShape, Padding, StrideShape, OutputShape, FilterCount, &Activation,
+                    &WorkingBufferSize, 0.0f, threadpool_, PackedFilter);
+
+    ASSERT_EQ(Parameters.Algorithm, MlasConvAlgorithmWinograd);
+
+    MlasConv(&Parameters, Input, Filter, Bias, BufferWorking.GetBuffer(WorkingBufferSize), Output, threadpool_);
+
+    ReferenceConv2D(BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+                    PaddingTop, PaddingLeft, OutputHeight, OutputWidth, Input, Filter, Bias, Relu,
+                    OutputReference);
+
+    //
+    // The Winograd transforms introduce rounding error that grows with the
+    // reduction size, so compare against a tolerance instead of exactly.
+    //
+
+    constexpr float AbsoluteTolerance = 1e-3f;
+    constexpr float RelativeTolerance = 1e-3f;
+
+    for (size_t i = 0; i < OutputElements; i++) {
+      float diff = std::fabs(Output[i] - OutputReference[i]);
+      ASSERT_TRUE(diff <= AbsoluteTolerance || diff <= std::fabs(OutputReference[i]) * RelativeTolerance)
+          << "B" << BatchCount << "/G" << GroupCount << "/Cpg" << InputChannels << "/Fpg" << FilterCount
+          << "/H" << InputHeight << "/W" << InputWidth << "/Pad" << PaddingTop << "," << PaddingLeft << ","
+          << PaddingBottom << "," << PaddingRight << " @" << i << ", got: " << Output[i]
+          << ", expecting: " << OutputReference[i];
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(Threaded ? "Conv2dWinograd_Threaded" : "Conv2dWinograd_SingleThread");
+    return suite_name.c_str();
+  }
+
+  MlasConv2DWinogradTest() : threadpool_(Threaded ? GetMlasThreadPool() : nullptr) {}
+
+  void ExecuteShort(void) override {
+    Test(1, 1, 8, 4, 4, 8, 1, 1, 1, 1, false);
+    Test(1, 1, 8, 6, 6, 8, 0, 0, 0, 0, false);
+    Test(1, 1, 16, 14, 14, 32, 1, 1, 1, 1, false);
+    Test(1, 1, 13, 17, 23, 11, 1, 1, 1, 1, true);
+    Test(2, 2, 9, 9, 30, 10, 1, 0, 0, 1, false);
+    Test(1, 1, 64, 56, 56, 64, 1, 1, 1, 1, true);
+    Test(3, 1, 32, 28, 7, 24, 1, 1, 1, 1, false);
+    Test(1, 4, 8, 19, 5, 12, 2, 2, 2, 2, true);
+  }
+};
+
+template <>
+MlasConv2DWinogradTest<false>* MlasTestFixture<MlasConv2DWinogradTest<false>>::mlas_tester(nullptr);
+template <>
+MlasConv2DWinogradTest<true>* MlasTestFixture<MlasConv2DWinogradTest<true>>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasConv2DWinogradTest<false>>::RegisterShortExecute();
+    if (GetMlasThreadPool() != nullptr) {
+      count += MlasDirectShortExecuteTests<MlasConv2DWinogradTest<true>>::RegisterShortExecute();
+    }
+  }
+  return count;
+});
@@ -0,0 +1,174 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+//
+// Tests the stride phase transposed convolution against a reference that
+// scatters every input element through the kernel.
+//
+
+class MlasConvTransposeTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferFilter;
+  MatrixGuardBuffer<float> BufferPackedFilter;
+  MatrixGuardBuffer<float> BufferBias;
+  MatrixGuardBuffer<float> BufferWorking;
+  MatrixGuardBuffer<float> BufferOutput;
+  MatrixGuardBuffer<double> BufferOutputReference;
+
+  void ReferenceConvTranspose(size_t BatchCount, size_t GroupCount, size_t InputChannels,
+                              size_t InputHeight, size_t InputWidth, size_t FilterCount,
+                              size_t KernelHeight, size_t KernelWidth,
+                              size_t PaddingTop, size_t PaddingLeft,
+                              size_t DilationHeight, size_t DilationWidth,
+                              size_t StrideHeight, size_t StrideWidth,
+                              size_t OutputHeight, size_t OutputWidth,
+                              const float* Input, const float* Filter, const float* Bias, double* Output) {
+    const size_t OutputSize = OutputHeight * OutputWidth;
+
+    for (size_t b = 0; b < BatchCount; b++) {
+      for (size_t g = 0; g < GroupCount; g++) {
+        for (size_t f = 0; f < FilterCount; f++) {
+          double* output = Output + ((b * GroupCount + g) * FilterCount + f) * OutputSize;
+          const double bias = (Bias != nullptr) ? Bias[g * FilterCount + f] : 0.0;
+          for (size_t i = 0; i < OutputSize; i++) {
+            output[i] = bias;
+          }
+        }
+        for (size_t ic = 0; ic < InputChannels; ic++) {
+          const float* input = Input + ((b * GroupCount + g) * InputChannels + ic) * InputHeight * InputWidth;
+          for (size_t f = 0; f < FilterCount; f++) {
+            const float* filter = Filter + ((g * InputChannels + ic) * FilterCount + f) * KernelHeight * KernelWidth;
+            double* output = Output + ((b * GroupCount + g) * FilterCount + f) * OutputSize;
+            for (size_t ih = 0; ih < InputHeight; ih++) {
+              for (size_t iw = 0; iw < InputWidth; iw++) {
+                for (size_t kh = 0; kh < KernelHeight; kh++) {
+                  const ptrdiff_t oh = ptrdiff_t(ih * StrideHeight + kh * DilationHeight) - ptrdiff_t(PaddingTop);
+                  if (oh < 0 || size_t(oh) >= OutputHeight) continue;
+                  for (size_t kw = 0; kw < KernelWidth; kw++) {
+                    const ptrdiff_t ow = ptrdiff_t(iw * StrideWidth + kw * DilationWidth) - ptrdiff_t(PaddingLeft);
+                    if (ow < 0 || size_t(ow) >= OutputWidth) continue;
+                    output[size_t(oh) * OutputWidth + size_t(ow)] +=
+                        double(input[ih * InputWidth + iw]) * double(filter[kh * KernelWidth + kw]);
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  void Test(size_t BatchCount, size_t GroupCount, size_t InputChannels, size_t InputHeight, size_t InputWidth,
+            size_t FilterCount, size_t KernelHeight, size_t KernelWidth,
+            size_t PaddingTop, size_t PaddingLeft, size_t PaddingBottom, size_t PaddingRight,
+            size_t DilationHeight, size_t DilationWidth, size_t StrideHeight, size_t StrideWidth,
+            size_t OutputPaddingHeight, size_t OutputPaddingWidth, bool UseBias) {
+    const size_t OutputHeight = StrideHeight * (InputHeight - 1) + OutputPaddingHeight +
+                                DilationHeight * (KernelHeight - 1) + 1 - PaddingTop - PaddingBottom;
+    const size_t OutputWidth = StrideWidth * (InputWidth - 1) + OutputPaddingWidth +
+                               DilationWidth * (KernelWidth - 1) + 1 - PaddingLeft - PaddingRight;
+
+    const size_t InputElements = BatchCount * GroupCount * InputChannels * InputHeight * InputWidth;
+    const size_t FilterElements = GroupCount * InputChannels * FilterCount * KernelHeight * KernelWidth;
+    const size_t OutputElements = BatchCount * GroupCount * FilterCount * OutputHeight * OutputWidth;
+
+    const int64_t InputShape[] = {int64_t(InputHeight), int64_t(InputWidth)};
+    const int64_t KernelShape[] = {int64_t(KernelHeight), int64_t(KernelWidth)};
+    const int64_t DilationShape[] = {int64_t(DilationHeight), int64_t(DilationWidth)};
+    const int64_t Padding[] = {int64_t(PaddingTop), int64_t(PaddingLeft), int64_t(PaddingBottom), int64_t(PaddingRight)};
+    const int64_t StrideShape[] = {int64_t(StrideHeight), int64_t(StrideWidth)};
+    const int64_t OutputShape[] = {int64_t(OutputHeight), int64_t(OutputWidth)};
+
+    float* Input = BufferInput.GetBuffer(InputElements);
+    float* Filter = BufferFilter.GetBuffer(FilterElements);
+    float* Bias = BufferBias.GetBuffer(GroupCount * FilterCount);
+    float* Output = BufferOutput.GetBuffer(OutputElements);
+    double* OutputReference = BufferOutputReference.GetBuffer(OutputElements);
+
+    std::default_random_engine generator(static_cast<unsigned>(InputElements * 7 + FilterElements));
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    for (size_t i = 0; i < InputElements; i++) Input[i] = distribution(generator);
+    for (size_t i = 0; i < FilterElements; i++) Filter[i] = distribution(generator);
+    for (size_t i = 0; i < GroupCount * FilterCount; i++) Bias[i] = distribution(generator);
+
+    float* PackedFilter = BufferPackedFilter.GetBuffer(
+        MlasConvTransposePackFilterSize(GroupCount, InputChannels, FilterCount, KernelShape) / sizeof(float));
+    MlasConvTransposePackFilter(GroupCount, InputChannels, FilterCount, KernelShape, DilationShape, StrideShape,
+                                Filter, PackedFilter);
+
+    MLAS_CONV_TRANSPOSE_PARAMETERS Parameters;
+    size_t WorkingBufferSize;
+    MLAS_THREADPOOL* threadpool = GetMlasThreadPool();
+
+    MlasConvTransposePrepare(&Parameters, BatchCount, GroupCount, InputChannels, InputShape, KernelShape,
+                             DilationShape, Padding, StrideShape, OutputShape, FilterCount,
+                             &WorkingBufferSize, threadpool);
+
+    float* WorkingBuffer = BufferWorking.GetBuffer(WorkingBufferSize);
+
+    std::fill_n(Output, OutputElements, std::numeric_limits<float>::quiet_NaN());
+
+    MlasConvTranspose(&Parameters, Input, PackedFilter, UseBias ? Bias : nullptr, WorkingBuffer, Output, threadpool);
+
+    ReferenceConvTranspose(BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+                           KernelHeight, KernelWidth, PaddingTop, PaddingLeft, DilationHeight, DilationWidth,
+                           StrideHeight, StrideWidth, OutputHeight, OutputWidth,
+                           Input, Filter, UseBias ? Bias : nullptr, OutputReference);
+
+    for (size_t i = 0; i < OutputElements; i++) {
+      ASSERT_NEAR(Output[i], OutputReference[i], 1e-4 * (1.0 + std::fabs(OutputReference[i])))
+          << " @" << i << " B" << BatchCount << "/G" << GroupCount << "/Cin" << InputChannels << "/"
+          << InputHeight << "x" << InputWidth << "/Cout" << FilterCount << "/K" << KernelHeight << "x" << KernelWidth
+          << "/P" << PaddingTop << "," << PaddingLeft << "," << PaddingBottom << "," << PaddingRight
+          << "/D" << DilationHeight << "x" << DilationWidth << "/S" << StrideHeight << "x" << StrideWidth;
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name("ConvTranspose");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    // Unit stride.
+    Test(1, 1, 3, 7, 9, 5, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, true);
+    Test(2, 1, 8, 5, 5, 4, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, false);
+
+    // Decoder upsampling with kernel equal to and larger than the stride.
+    Test(1, 1, 16, 8, 8, 8, 2, 2, 0, 0, 0, 0, 1, 1, 2, 2, 0, 0, true);
+    Test(2, 1, 8, 6, 7, 12, 4, 4, 1, 1, 1, 1, 1, 1, 2, 2, 0, 0, true);
+    Test(1, 1, 5, 9, 6, 3, 3, 3, 1, 1, 1, 1, 1, 1, 2, 2, 1, 1, true);
+    Test(1, 1, 4, 5, 5, 6, 5, 5, 2, 2, 2, 2, 1, 1, 3, 3, 2, 0, false);
+
+    // Kernel smaller than the stride leaves phases with bias only.
+    Test(1, 1, 3, 4, 5, 2, 2, 1, 0, 0, 0, 0, 1, 1, 3, 3, 0, 0, true);
+
+    // Dilation, asymmetric padding and strides.
+    Test(1, 1, 6, 7, 5, 4, 3, 2, 2, 0, 1, 1, 2, 3, 2, 1, 0, 0, true);
+    Test(1, 1, 3, 6, 6, 5, 4, 3, 3, 2, 0, 1, 2, 2, 4, 2, 1, 1, true);
+
+    // Groups.
+    Test(2, 3, 4, 6, 6, 5, 3, 3, 1, 1, 1, 1, 1, 1, 2, 2, 1, 1, true);
+    Test(1, 8, 1, 9, 9, 1, 4, 4, 1, 1, 1, 1, 1, 1, 2, 2, 0, 0, true);
+
+    // One dimensional.
+    Test(2, 1, 7, 1, 33, 5, 1, 5, 0, 2, 0, 2, 1, 1, 1, 2, 1, 0, true);
+
+    // Large enough to use several tiles per phase.
+    Test(1, 1, 32, 40, 40, 16, 4, 4, 1, 1, 1, 1, 1, 1, 2, 2, 0, 0, true);
+    Test(1, 2, 64, 24, 28, 32, 3, 3, 1, 1, 1, 1, 1, 1, 2, 2, 1, 1, true);
+  }
+};
+
+template <>
+MlasConvTransposeTest* MlasTestFixture<MlasConvTransposeTest>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  return is_short_execute ? MlasDirectShortExecuteTests<MlasConvTransposeTest>::RegisterShortExecute() : 0;
+});
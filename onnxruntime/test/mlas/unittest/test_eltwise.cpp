@@ -0,0 +1,394 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_fp16.h"
+
+//
+// Tests the broadcast element-wise binary and select operations against a
+// reference that walks the full output index space.
+//
+
+//
+// Broadcasts the input shape (right aligned) against the output shape.
+//
+static size_t ComputeEltwiseStrides(const std::vector<size_t>& OutputShape,
+                                    const std::vector<size_t>& InputShape,
+                                    std::vector<size_t>& Strides) {
+  const size_t Rank = OutputShape.size();
+  const size_t Offset = Rank - InputShape.size();
+  Strides.assign(Rank, 0);
+  size_t Stride = 1;
+  for (size_t d = InputShape.size(); d > 0; d--) {
+    if (InputShape[d - 1] != 1) {
+      Strides[Offset + d - 1] = Stride;
+    }
+    Stride *= InputShape[d - 1];
+  }
+  return Stride;
+}
+
+template <typename T>
+class MlasEltwiseBinaryTest : public MlasTestBase {
+ private:
+  using ComputeType = typename std::conditional<std::is_same<T, MLFp16>::value, float, T>::type;
+  using MlasType = typename std::conditional<std::is_same<T, MLFp16>::value, MLAS_FP16, T>::type;
+
+  MatrixGuardBuffer<T> BufferA;
+  MatrixGuardBuffer<T> BufferB;
+  MatrixGuardBuffer<T> BufferC;
+  MatrixGuardBuffer<T> BufferCReference;
+
+  static ComputeType Reference(MLAS_ELTWISE_BINARY_KIND Kind, ComputeType a, ComputeType b) {
+    switch (Kind) {
+      case MlasEltwiseAdd:
+        return a + b;
+      case MlasEltwiseSub:
+        return a - b;
+      case MlasEltwiseMul:
+        return a * b;
+      case MlasEltwiseDiv:
+        return a / b;
+      case MlasEltwiseMin:
+        return std::min(a, b);
+      case MlasEltwisePow:
+        if constexpr (std::is_integral<ComputeType>::value) {
+          return 0;
+        } else {
+          return std::pow(a, b);
+        }
+      default:
+        return std::max(a, b);
+    }
+  }
+
+  static const char* KindName(MLAS_ELTWISE_BINARY_KIND Kind) {
+    static const char* names[] = {"Add", "Sub", "Mul", "Div", "Min", "Max", "Pow"};
+    return names[Kind];
+  }
+
+  static void Fill(T* Buffer, size_t Elements, std::default_random_engine& generator, bool Positive = false) {
+    if constexpr (std::is_integral<T>::value) {
+      // Nonzero values so that division is defined.
+      std::uniform_int_distribution<int32_t> distribution(1, 1000);
+      for (size_t i = 0; i < Elements; i++) {
+        T value = static_cast<T>(distribution(generator));
+        Buffer[i] = (i & 1) ? T(-value) : value;
+      }
+    } else {
+      std::uniform_real_distribution<float> distribution(0.5f, 4.0f);
+      for (size_t i = 0; i < Elements; i++) {
+        float value = distribution(generator);
+        Buffer[i] = T(((i & 1) && !Positive) ? -value : value);
+      }
+    }
+  }
+
+  void Test(MLAS_ELTWISE_BINARY_KIND Kind,
+            const std::vector<size_t>& OutputShape,
+            const std::vector<size_t>& ShapeA,
+            const std::vector<size_t>& ShapeB,
+            MLAS_THREADPOOL* threadpool,
+            const float* ScalarB = nullptr) {
+    std::vector<size_t> StridesA;
+    std::vector<size_t> StridesB;
+    const size_t ElementsA = ComputeEltwiseStrides(OutputShape, ShapeA, StridesA);
+    const size_t ElementsB = ComputeEltwiseStrides(OutputShape, ShapeB, StridesB);
+
+    size_t ElementsC = 1;
+    for (size_t d : OutputShape) {
+      ElementsC *= d;
+    }
+
+    T* A = BufferA.GetBuffer(ElementsA);
+    T* B = BufferB.GetBuffer(ElementsB);
+    T* C = BufferC.GetBuffer(ElementsC);
+    T* CReference = BufferCReference.GetBuffer(ElementsC);
+
+    std::default_random_engine generator(static_cast<unsigned>(ElementsA * 31 + ElementsB));
+    // Pow uses positive bases so that fractional exponents are defined.
+    Fill(A, ElementsA, generator, Kind == MlasEltwisePow);
+    Fill(B, ElementsB, generator);
+    if (ScalarB != nullptr) {
+      B[0] = T(*ScalarB);
+    }
+
+    const size_t Rank = OutputShape.size();
+    std::vector<size_t> Index(Rank, 0);
+    for (size_t i = 0; i < ElementsC; i++) {
+      size_t OffsetA = 0;
+      size_t OffsetB = 0;
+      for (size_t d = 0; d < Rank; d++) {
+        OffsetA += Index[d] * StridesA[d];
+        OffsetB += Index[d] * StridesB[d];
+      }
+      CReference[i] = T(Reference(Kind, ComputeType(A[OffsetA]), ComputeType(B[OffsetB])));
+      for (size_t d = Rank; d > 0; d--) {
+        if (++Index[d - 1] < OutputShape[d - 1]) {
+          break;
+        }
+        Index[d - 1] = 0;
+      }
+    }
+
+    MlasEltwiseBinary<MlasType>(Kind, Rank, OutputShape.data(),
+                                reinterpret_cast<const MlasType*>(A), StridesA.data(),
+                                reinterpret_cast<const MlasType*>(B), StridesB.data(),
+                                reinterpret_cast<MlasType*>(C), threadpool);
+
+    // Pow is computed with multiplies for the exponents 2 and 3, which may round differently than std::pow.
+    const float Tolerance = (Kind == MlasEltwisePow) ? 1e-5f : 1e-6f;
+
+    for (size_t i = 0; i < ElementsC; i++) {
+      if constexpr (std::is_same<T, float>::value) {
+        ASSERT_TRUE(C[i] == CReference[i] || std::fabs(C[i] - CReference[i]) <= std::fabs(CReference[i]) * Tolerance)
+            << KindName(Kind) << " @" << i << " of " << ElementsC << ", got: " << C[i]
+            << ", expecting: " << CReference[i];
+      } else if constexpr (std::is_same<T, MLFp16>::value) {
+        if (Kind == MlasEltwisePow) {
+          ASSERT_TRUE(std::fabs(C[i].ToFloat() - CReference[i].ToFloat()) <= std::fabs(CReference[i].ToFloat()) * 1e-3f)
+              << KindName(Kind) << " @" << i << " of " << ElementsC << ", got: " << C[i].ToFloat()
+              << ", expecting: " << CReference[i].ToFloat();
+        } else {
+          ASSERT_EQ(C[i].val, CReference[i].val)
+              << KindName(Kind) << " @" << i << " of " << ElementsC << ", got: " << C[i].ToFloat()
+              << ", expecting: " << CReference[i].ToFloat();
+        }
+      } else {
+        ASSERT_EQ(C[i], CReference[i]) << KindName(Kind) << " @" << i << " of " << ElementsC;
+      }
+    }
+  }
+
+  //
+  // Places the same pairs with NaN in the vectorized body and in the scalar
+  // tail of a row, which must produce the same results.
+  //
+  void TestNaN(MLAS_ELTWISE_BINARY_KIND Kind, MLAS_THREADPOOL* threadpool) {
+    // The last 3 elements are in the tail of the row for vectors of 4, 8 and
+    // 16 elements, the first 3 in the vectorized body.
+    constexpr size_t N = 39;
+    constexpr size_t TailStart = 36;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const std::vector<std::pair<float, float>> Pairs{{nan, 1.5f}, {-2.5f, nan}, {nan, nan}};
+
+    float* A = BufferA.GetBuffer(N);
+    float* B = BufferB.GetBuffer(N);
+    float* C = BufferC.GetBuffer(N);
+
+    // The second run broadcasts a NaN as the first input along the row.
+    for (bool BroadcastA : {false, true}) {
+      for (size_t i = 0; i < N; i++) {
+        A[i] = float(i % 7) - 3.0f;
+        B[i] = float(i % 5) - 2.0f;
+      }
+      for (size_t p = 0; p < Pairs.size(); p++) {
+        A[p] = A[TailStart + p] = Pairs[p].first;
+        B[p] = B[TailStart + p] = Pairs[p].second;
+      }
+      if (BroadcastA) {
+        A[0] = nan;
+      }
+
+      const size_t Shape[] = {N};
+      const size_t StridesA[] = {BroadcastA ? size_t(0) : size_t(1)};
+      const size_t StridesB[] = {1};
+      MlasEltwiseBinary<float>(Kind, 1, Shape, A, StridesA, B, StridesB, C, threadpool);
+
+      for (size_t p = 0; p < Pairs.size(); p++) {
+        ASSERT_EQ(std::isnan(C[TailStart + p]), std::isnan(C[p]))
+            << KindName(Kind) << " broadcast " << BroadcastA << " pair " << p << ", tail: " << C[TailStart + p]
+            << ", body: " << C[p];
+        if (!std::isnan(C[p])) {
+          ASSERT_EQ(C[TailStart + p], C[p])
+              << KindName(Kind) << " broadcast " << BroadcastA << " pair " << p;
+        }
+      }
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name = std::string("EltwiseBinary_") +
+                                          (std::is_same<T, float>::value     ? "Float"
+                                           : std::is_same<T, MLFp16>::value  ? "Fp16"
+                                           : std::is_same<T, int32_t>::value ? "Int32"
+                                                                             : "Int64");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    MLAS_THREADPOOL* threadpool = GetMlasThreadPool();
+
+    for (MLAS_ELTWISE_BINARY_KIND Kind : {MlasEltwiseAdd, MlasEltwiseSub, MlasEltwiseMul,
+                                          MlasEltwiseDiv, MlasEltwiseMin, MlasEltwiseMax}) {
+      // Same shape.
+      Test(Kind, {1}, {1}, {1}, threadpool);
+      Test(Kind, {37}, {37}, {37}, threadpool);
+      Test(Kind, {3, 5, 67}, {3, 5, 67}, {3, 5, 67}, threadpool);
+      // Scalar operands.
+      Test(Kind, {2, 45}, {2, 45}, {1}, threadpool);
+      Test(Kind, {2, 45}, {1}, {2, 45}, threadpool);
+      // Row and column broadcasts.
+      Test(Kind, {7, 33}, {7, 33}, {33}, threadpool);
+      Test(Kind, {7, 33}, {7, 1}, {7, 33}, threadpool);
+      Test(Kind, {7, 33}, {7, 1}, {1, 33}, threadpool);
+      // Per-channel bias patterns.
+      Test(Kind, {2, 16, 5, 5}, {2, 16, 5, 5}, {16, 1, 1}, threadpool);
+      Test(Kind, {2, 5, 5, 19}, {2, 5, 5, 19}, {19}, threadpool);
+      // Mixed broadcasts on both inputs and unit dimensions.
+      Test(Kind, {4, 1, 6, 9}, {4, 1, 1, 9}, {1, 6, 1}, threadpool);
+      Test(Kind, {3, 1, 2, 1, 5, 7}, {3, 1, 2, 1, 5, 1}, {1, 1, 7}, threadpool);
+      // Empty output.
+      Test(Kind, {4, 0, 3}, {4, 1, 3}, {0, 1}, threadpool);
+      // Large enough to be partitioned across threads.
+      Test(Kind, {64, 1031}, {64, 1031}, {1031}, threadpool);
+      Test(Kind, {128, 257}, {128, 1}, {128, 257}, threadpool);
+    }
+
+    if constexpr (std::is_same<T, float>::value) {
+      TestNaN(MlasEltwiseMin, threadpool);
+      TestNaN(MlasEltwiseMax, threadpool);
+    }
+
+    if constexpr (!std::is_integral<T>::value) {
+      Test(MlasEltwisePow, {37}, {37}, {37}, threadpool);
+      Test(MlasEltwisePow, {7, 33}, {7, 1}, {1, 33}, threadpool);
+      Test(MlasEltwisePow, {64, 1031}, {64, 1031}, {1031}, threadpool);
+      // Broadcast exponents, including the vectorized squares and cubes.
+      for (float Exponent : {2.0f, 3.0f, 0.5f, -1.5f}) {
+        Test(MlasEltwisePow, {2, 45}, {2, 45}, {1}, threadpool, &Exponent);
+        Test(MlasEltwisePow, {130, 67}, {130, 67}, {1}, threadpool, &Exponent);
+        Test(MlasEltwisePow, {5, 3}, {1}, {1}, threadpool, &Exponent);
+      }
+    }
+  }
+};
+
+template <typename T>
+class MlasEltwiseSelectTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<bool> BufferCondition;
+  MatrixGuardBuffer<T> BufferA;
+  MatrixGuardBuffer<T> BufferB;
+  MatrixGuardBuffer<T> BufferC;
+
+  void Test(const std::vector<size_t>& OutputShape,
+            const std::vector<size_t>& ShapeCondition,
+            const std::vector<size_t>& ShapeA,
+            const std::vector<size_t>& ShapeB,
+            MLAS_THREADPOOL* threadpool) {
+    std::vector<size_t> StridesCondition;
+    std::vector<size_t> StridesA;
+    std::vector<size_t> StridesB;
+    const size_t ElementsCondition = ComputeEltwiseStrides(OutputShape, ShapeCondition, StridesCondition);
+    const size_t ElementsA = ComputeEltwiseStrides(OutputShape, ShapeA, StridesA);
+    const size_t ElementsB = ComputeEltwiseStrides(OutputShape, ShapeB, StridesB);
+
+    size_t ElementsC = 1;
+    for (size_t d : OutputShape) {
+      ElementsC *= d;
+    }
+
+    bool* Condition = BufferCondition.GetBuffer(ElementsCondition);
+    T* A = BufferA.GetBuffer(ElementsA);
+    T* B = BufferB.GetBuffer(ElementsB);
+    T* C = BufferC.GetBuffer(ElementsC);
+
+    std::default_random_engine generator(static_cast<unsigned>(ElementsCondition * 131 + ElementsA * 31 + ElementsB));
+    std::uniform_int_distribution<int32_t> distribution(-1000, 1000);
+    for (size_t i = 0; i < ElementsCondition; i++) {
+      Condition[i] = (distribution(generator) & 1) != 0;
+    }
+    for (size_t i = 0; i < ElementsA; i++) {
+      A[i] = T(distribution(generator));
+    }
+    for (size_t i = 0; i < ElementsB; i++) {
+      B[i] = T(distribution(generator) + 5000);
+    }
+
+    MlasEltwiseSelect<T>(OutputShape.size(), OutputShape.data(),
+                         Condition, StridesCondition.data(),
+                         A, StridesA.data(), B, StridesB.data(), C, threadpool);
+
+    const size_t Rank = OutputShape.size();
+    std::vector<size_t> Index(Rank, 0);
+    for (size_t i = 0; i < ElementsC; i++) {
+      size_t OffsetCondition = 0;
+      size_t OffsetA = 0;
+      size_t OffsetB = 0;
+      for (size_t d = 0; d < Rank; d++) {
+        OffsetCondition += Index[d] * StridesCondition[d];
+        OffsetA += Index[d] * StridesA[d];
+        OffsetB += Index[d] * StridesB[d];
+      }
+      const T Expected = Condition[OffsetCondition] ? A[OffsetA] : B[OffsetB];
+      ASSERT_EQ(C[i], Expected) << "@" << i << " of " << ElementsC;
+      for (size_t d = Rank; d > 0; d--) {
+        if (++Index[d - 1] < OutputShape[d - 1]) {
+          break;
+        }
+        Index[d - 1] = 0;
+      }
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name = std::string("EltwiseSelect_") +
+                                          (std::is_same<T, float>::value     ? "Float"
+                                           : std::is_same<T, int32_t>::value ? "Int32"
+                                                                             : "Int64");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    MLAS_THREADPOOL* threadpool = GetMlasThreadPool();
+
+    // Same shape.
+    Test({1}, {1}, {1}, {1}, threadpool);
+    Test({37}, {37}, {37}, {37}, threadpool);
+    Test({3, 5, 67}, {3, 5, 67}, {3, 5, 67}, {3, 5, 67}, threadpool);
+    // Scalar values and conditions.
+    Test({2, 45}, {2, 45}, {1}, {2, 45}, threadpool);
+    Test({2, 45}, {2, 45}, {2, 45}, {1}, threadpool);
+    Test({2, 45}, {2, 45}, {1}, {1}, threadpool);
+    Test({2, 45}, {1}, {2, 45}, {2, 45}, threadpool);
+    // Row and column broadcasts.
+    Test({7, 33}, {7, 1}, {7, 33}, {33}, threadpool);
+    Test({7, 33}, {33}, {7, 1}, {1, 33}, threadpool);
+    Test({4, 1, 6, 9}, {4, 1, 1, 9}, {1, 6, 1}, {9}, threadpool);
+    // Empty output.
+    Test({4, 0, 3}, {4, 1, 3}, {0, 1}, {1}, threadpool);
+    // Large enough to be partitioned across threads.
+    Test({64, 1031}, {64, 1031}, {1031}, {64, 1}, threadpool);
+  }
+};
+
+template <>
+MlasEltwiseBinaryTest<float>* MlasTestFixture<MlasEltwiseBinaryTest<float>>::mlas_tester(nullptr);
+template <>
+MlasEltwiseBinaryTest<MLFp16>* MlasTestFixture<MlasEltwiseBinaryTest<MLFp16>>::mlas_tester(nullptr);
+template <>
+MlasEltwiseBinaryTest<int32_t>* MlasTestFixture<MlasEltwiseBinaryTest<int32_t>>::mlas_tester(nullptr);
+template <>
+MlasEltwiseBinaryTest<int64_t>* MlasTestFixture<MlasEltwiseBinaryTest<int64_t>>::mlas_tester(nullptr);
+template <>
+MlasEltwiseSelectTest<float>* MlasTestFixture<MlasEltwiseSelectTest<float>>::mlas_tester(nullptr);
+template <>
+MlasEltwiseSelectTest<int32_t>* MlasTestFixture<MlasEltwiseSelectTest<int32_t>>::mlas_tester(nullptr);
+template <>
+MlasEltwiseSelectTest<int64_t>* MlasTestFixture<MlasEltwiseSelectTest<int64_t>>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasEltwiseBinaryTest<float>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasEltwiseBinaryTest<MLFp16>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasEltwiseBinaryTest<int32_t>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasEltwiseBinaryTest<int64_t>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasEltwiseSelectTest<float>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasEltwiseSelectTest<int32_t>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasEltwiseSelectTest<int64_t>>::RegisterShortExecute();
+  }
+  return count;
+});
@@ -0,0 +1,153 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_fp16.h"
+
+//
+// Tests the fused attention softmax against scale, mask and bias applied as
+// separate steps followed by a softmax of each row.
+//
+
+template <typename T>
+class MlasFusedSoftmaxTest : public MlasTestBase {
+ private:
+  static constexpr bool IsFloat = std::is_same<T, float>::value;
+
+  using MlasType = typename std::conditional<IsFloat, float, MLAS_FP16>::type;
+
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferMask;
+  MatrixGuardBuffer<float> BufferBias;
+  MatrixGuardBuffer<T> BufferOutput;
+  MatrixGuardBuffer<float> BufferOutputReference;
+
+  void Test(size_t B, size_t N, size_t S, size_t T_, bool MaskPerQuery, bool HasBias, bool BroadcastBias,
+            bool Causal, size_t Past, bool InPlace) {
+    const size_t Count = B * N * S * T_;
+
+    float* Input = BufferInput.GetBuffer(Count);
+    float* Mask = BufferMask.GetBuffer(B * S * T_);
+    float* Bias = BufferBias.GetBuffer(B * N * S * T_);
+    float* OutputReference = BufferOutputReference.GetBuffer(Count);
+
+    std::default_random_engine generator(static_cast<unsigned>(Count + Past * 3 + S));
+    std::uniform_real_distribution<float> distribution(-8.0f, 8.0f);
+    std::uniform_int_distribution<int> mask_distribution(0, 3);
+
+    for (size_t i = 0; i < Count; i++) {
+      Input[i] = distribution(generator);
+    }
+
+    for (size_t i = 0; i < B * S * T_; i++) {
+      Mask[i] = mask_distribution(generator) == 0 ? -10000.0f : 0.0f;
+    }
+
+    for (size_t i = 0; i < B * N * S * T_; i++) {
+      Bias[i] = distribution(generator) * 0.25f;
+    }
+
+    MLAS_FUSED_SOFTMAX_PARAMS Params;
+    Params.BatchCount = B;
+    Params.HeadCount = N;
+    Params.SequenceLength = S;
+    Params.TotalSequenceLength = T_;
+    Params.Scale = 0.125f;
+    Params.Causal = Causal;
+    Params.PastSequenceLength = Past;
+
+    // The mask is either B x S x T or a key padding mask of B x T, broadcast over heads.
+    Params.Mask.Data = Mask;
+    Params.Mask.BatchStride = MaskPerQuery ? S * T_ : T_;
+    Params.Mask.HeadStride = 0;
+    Params.Mask.RowStride = MaskPerQuery ? T_ : 0;
+
+    if (HasBias) {
+      Params.Bias.Data = Bias;
+      Params.Bias.BatchStride = BroadcastBias ? 0 : N * S * T_;
+      Params.Bias.HeadStride = S * T_;
+      Params.Bias.RowStride = T_;
+    }
+
+    // Reference: apply each step to a copy of the scores, then a plain softmax.
+    for (size_t b = 0; b < B; b++) {
+      for (size_t h = 0; h < N; h++) {
+        for (size_t s = 0; s < S; s++) {
+          const size_t row = (b * N + h) * S + s;
+          const float* mask_row = Mask + b * Params.Mask.BatchStride + s * Params.Mask.RowStride;
+          const float* bias_row = Bias + b * Params.Bias.BatchStride + h * Params.Bias.HeadStride + s * T_;
+          const size_t valid = Causal ? std::min(T_, Past + s + 1) : T_;
+
+          double maximum = -std::numeric_limits<double>::infinity();
+          std::vector<double> x(valid);
+          for (size_t t = 0; t < valid; t++) {
+            x[t] = double(Input[row * T_ + t]) * Params.Scale + mask_row[t] + (HasBias ? bias_row[t] : 0.0);
+            maximum = std::max(maximum, x[t]);
+          }
+
+          double sum = 0.0;
+          for (size_t t = 0; t < valid; t++) {
+            x[t] = std::exp(x[t] - maximum);
+            sum += x[t];
+          }
+
+          for (size_t t = 0; t < T_; t++) {
+            OutputReference[row * T_ + t] = t < valid ? float(x[t] / sum) : 0.0f;
+          }
+        }
+      }
+    }
+
+    T* Output;
+    if constexpr (IsFloat) {
+      Output = InPlace ? Input : BufferOutput.GetBuffer(Count);
+    } else {
+      Output = BufferOutput.GetBuffer(Count);
+    }
+
+    MlasComputeFusedSoftmax<MlasType>(Input, reinterpret_cast<MlasType*>(Output), Params, GetMlasThreadPool());
+
+    const float AbsoluteTolerance = IsFloat ? 1e-6f : 1e-3f;
+    const float RelativeTolerance = IsFloat ? 1e-5f : 2e-3f;
+
+    for (size_t i = 0; i < Count; i++) {
+      const float actual = float(Output[i]);
+      const float diff = std::fabs(actual - OutputReference[i]);
+      ASSERT_TRUE(diff <= AbsoluteTolerance || diff <= std::fabs(OutputReference[i]) * RelativeTolerance)
+          << "B=" << B << " N=" << N << " S=" << S << " T=" << T_ << " causal=" << Causal << " past=" << Past
+          << " @" << i << ", got: " << actual << ", expecting: " << OutputReference[i];
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(IsFloat ? "FusedSoftmax_Float" : "FusedSoftmax_Fp16");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (bool InPlace : {false, true}) {
+      Test(1, 1, 1, 1, true, false, false, false, 0, InPlace);
+      Test(2, 3, 5, 7, true, true, false, false, 0, InPlace);
+      Test(2, 3, 5, 7, false, true, true, false, 0, InPlace);
+      Test(2, 4, 9, 9, true, false, false, true, 0, InPlace);
+      Test(1, 2, 6, 19, false, true, false, true, 13, InPlace);
+      Test(3, 12, 16, 128, true, true, true, false, 0, InPlace);
+      Test(2, 8, 33, 97, false, true, false, true, 64, InPlace);
+      Test(1, 16, 1, 513, false, true, true, true, 512, InPlace);
+    }
+  }
+};
+
+template <>
+MlasFusedSoftmaxTest<float>* MlasTestFixture<MlasFusedSoftmaxTest<float>>::mlas_tester(nullptr);
+template <>
+MlasFusedSoftmaxTest<MLFp16>* MlasTestFixture<MlasFusedSoftmaxTest<MLFp16>>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasFusedSoftmaxTest<float>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasFusedSoftmaxTest<MLFp16>>::RegisterShortExecute();
+  }
+  return count;
+});
@@ -0,0 +1,133 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_fp16.h"
+
+//
+// Tests the layer normalization routines against a double precision
+// reference, with and without the fused residual add.
+//
+
+template <typename T>
+class MlasLayerNormTest : public MlasTestBase {
+ private:
+  using MlasType = typename std::conditional<std::is_same<T, MLFp16>::value, MLAS_FP16, T>::type;
+
+  static constexpr bool IsHalf = std::is_same<T, MLFp16>::value;
+
+  MatrixGuardBuffer<T> BufferInput;
+  MatrixGuardBuffer<T> BufferSkip;
+  MatrixGuardBuffer<T> BufferBias;
+  MatrixGuardBuffer<T> BufferGamma;
+  MatrixGuardBuffer<T> BufferBeta;
+  MatrixGuardBuffer<T> BufferOutput;
+  MatrixGuardBuffer<T> BufferSkipOutput;
+
+  static const MlasType* AsMlas(const T* p) { return reinterpret_cast<const MlasType*>(p); }
+  static MlasType* AsMlas(T* p) { return reinterpret_cast<MlasType*>(p); }
+
+  void Test(size_t N, bool Simplified, bool UseSkip, bool UseBias, bool UseBeta, bool UseSkipOutput) {
+    T* Input = BufferInput.GetBuffer(N);
+    T* Skip = BufferSkip.GetBuffer(N);
+    T* Bias = BufferBias.GetBuffer(N);
+    T* Gamma = BufferGamma.GetBuffer(N);
+    T* Beta = BufferBeta.GetBuffer(N);
+    T* Output = BufferOutput.GetBuffer(N);
+    T* SkipOutput = BufferSkipOutput.GetBuffer(N);
+
+    std::default_random_engine generator(static_cast<unsigned>(N * 7 + Simplified));
+    std::uniform_real_distribution<float> distribution(-2.0f, 2.0f);
+
+    for (size_t i = 0; i < N; i++) {
+      Input[i] = T(distribution(generator) + 0.5f);
+      Skip[i] = T(distribution(generator));
+      Bias[i] = T(distribution(generator) * 0.25f);
+      Gamma[i] = T(distribution(generator));
+      Beta[i] = T(distribution(generator));
+    }
+
+    const float Epsilon = 1e-5f;
+    float Mean = -1.0f;
+    float InvStdDev = -1.0f;
+
+    MlasLayerNormalization<MlasType>(AsMlas(Input),
+                                     UseSkip ? AsMlas(Skip) : nullptr,
+                                     UseBias ? AsMlas(Bias) : nullptr,
+                                     AsMlas(Gamma),
+                                     UseBeta ? AsMlas(Beta) : nullptr,
+                                     AsMlas(Output),
+                                     UseSkipOutput ? AsMlas(SkipOutput) : nullptr,
+                                     N, Epsilon, Simplified, &Mean, &InvStdDev);
+
+    std::vector<double> X(N);
+    double Sum = 0.0;
+    double SumSquare = 0.0;
+    for (size_t i = 0; i < N; i++) {
+      double x = float(Input[i]);
+      if (UseSkip) {
+        x += float(Skip[i]);
+        if (UseBias) {
+          x += float(Bias[i]);
+        }
+      }
+      X[i] = x;
+      Sum += x;
+      SumSquare += x * x;
+    }
+
+    double ReferenceMean = Simplified ? 0.0 : Sum / N;
+    double Variance = Simplified ? SumSquare / N : SumSquare / N - ReferenceMean * ReferenceMean;
+    double ReferenceInvStdDev = 1.0 / std::sqrt(Variance + Epsilon);
+
+    const float Tolerance = IsHalf ? 1e-2f : 1e-4f;
+
+    ASSERT_NEAR(Mean, ReferenceMean, 1e-4 + std::fabs(ReferenceMean) * 1e-4) << "N=" << N;
+    ASSERT_NEAR(InvStdDev, ReferenceInvStdDev, ReferenceInvStdDev * 1e-4) << "N=" << N;
+
+    for (size_t i = 0; i < N; i++) {
+      double y = (X[i] - ReferenceMean) * ReferenceInvStdDev * float(Gamma[i]);
+      if (UseBeta) {
+        y += float(Beta[i]);
+      }
+      ASSERT_NEAR(float(Output[i]), y, Tolerance * (1.0 + std::fabs(y)))
+          << "N=" << N << " Simplified=" << Simplified << " Skip=" << UseSkip << " Bias=" << UseBias
+          << " Beta=" << UseBeta << " @" << i;
+
+      if (UseSkip && UseSkipOutput) {
+        ASSERT_NEAR(float(SkipOutput[i]), X[i], Tolerance * (1.0 + std::fabs(X[i])))
+            << "N=" << N << " SkipOutput @" << i;
+      }
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name = std::string("LayerNorm_") + (IsHalf ? "Fp16" : "Float");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (size_t N : {1, 3, 4, 8, 17, 64, 255, 256, 257, 768, 1024, 4099}) {
+      for (bool Simplified : {false, true}) {
+        Test(N, Simplified, false, false, !Simplified, false);
+        Test(N, Simplified, true, false, false, false);
+        Test(N, Simplified, true, true, true, true);
+        Test(N, Simplified, true, true, false, true);
+      }
+    }
+  }
+};
+
+template <>
+MlasLayerNormTest<float>* MlasTestFixture<MlasLayerNormTest<float>>::mlas_tester(nullptr);
+template <>
+MlasLayerNormTest<MLFp16>* MlasTestFixture<MlasLayerNormTest<MLFp16>>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasLayerNormTest<float>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasLayerNormTest<MLFp16>>::RegisterShortExecute();
+  }
+  return count;
+});
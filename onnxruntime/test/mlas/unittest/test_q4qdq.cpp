@@ -111,6 +111,45 @@ class MlasQ4dqTest : public MlasTestBase {
 #endif  // x64
   }
 
+  /* Block quantized data from another quantizer, packed with its scales and zero points */
+  void TestPackQuantized(size_t N, size_t K, MLAS_BLK_QUANT_TYPE qtype) {
+    const size_t BlkLen = qtype == BlkQ4Sym64 ? 64 : (qtype == BlkQ4Sym128 ? 128 : 32);
+    const size_t KBlocks = (K + BlkLen - 1) / BlkLen;
+    const size_t ZpStride = (KBlocks + 1) / 2;
+
+    std::vector<uint8_t> QuantData(N * KBlocks * BlkLen / 2);
+    std::vector<float> Scales(N * KBlocks);
+    std::vector<uint8_t> ZeroPoints(N * ZpStride);
+    for (size_t i = 0; i < QuantData.size(); i++) {
+      QuantData[i] = static_cast<uint8_t>((i * 37 + 11) % 256);
+    }
+    for (size_t i = 0; i < Scales.size(); i++) {
+      Scales[i] = 0.25f * static_cast<float>(i % 7 + 1);
+    }
+    for (size_t i = 0; i < ZeroPoints.size(); i++) {
+      ZeroPoints[i] = static_cast<uint8_t>((i * 13 + 5) % 256);
+    }
+
+    size_t qsize = MlasQ4GemmPackBSize(qtype, N, K);
+    uint8_t* Packed = PackedBuf.GetBuffer(qsize, true);
+    float* Output = FpOutBuf.GetBuffer(N * K, true);
+    MlasQ4GemmPackBQuantized(qtype, Packed, QuantData.data(), Scales.data(), ZeroPoints.data(), N, K);
+    MlasQ4GemmUnPackB(qtype, Output, Packed, N, K, N);
+
+    for (size_t n = 0; n < N; n++) {
+      for (size_t k = 0; k < K; k++) {
+        const size_t b = k / BlkLen;
+        const uint8_t byte = QuantData[(n * KBlocks * BlkLen + k) / 2];
+        const int q = (k & 1) ? (byte >> 4) : (byte & 0x0F);
+        const uint8_t zp_pair = ZeroPoints[n * ZpStride + b / 2];
+        const int zp = qtype != BlkQ4Zp8 ? 8 : ((b & 1) ? (zp_pair >> 4) : (zp_pair & 0x0F));
+        const float expected = static_cast<float>(q - zp) * Scales[n * KBlocks + b];
+        ASSERT_EQ(Output[k * N + n], expected) << ", index=[" << k << "," << n << "], [" << N << "x"
+                                                << K << "] QType: " << qtype;
+      }
+    }
+  }
+
  public:
   static const char* GetTestSuiteName() {
     static const std::string suite_name("Q4DQ");
@@ -136,6 +175,13 @@ class MlasQ4dqTest : public MlasTestBase {
     Test(static_cast<size_t>(4 * 20) + 3, static_cast<size_t>(32 * 15) + 17, BlkQ4Sym);
     Test(static_cast<size_t>(4 * 20) + 3, static_cast<size_t>(32 * 15) + 17, BlkQ4Sym64);
     Test(static_cast<size_t>(4 * 20) + 3, static_cast<size_t>(32 * 15) + 17, BlkQ4Sym128);
+
+    TestPackQuantized(1, 20, BlkQ4Sym);
+    TestPackQuantized(3, 52, BlkQ4Zp8);
+    TestPackQuantized(3, 52, BlkQ4Sym64);
+    TestPackQuantized(static_cast<size_t>(4 * 10) + 1, static_cast<size_t>(32 * 9) + 17, BlkQ4Zp8);
+    TestPackQuantized(static_cast<size_t>(4 * 10) + 1, static_cast<size_t>(32 * 9) + 17, BlkQ4Sym);
+    TestPackQuantized(static_cast<size_t>(4 * 20) + 3, static_cast<size_t>(32 * 15) + 17, BlkQ4Sym128);
   }
 
   MlasQ4dqTest() = default;
@@ -0,0 +1,290 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_fp16.h"
+
+//
+// Tests the multi-axis reduction routines against a double precision
+// reference over the common axis patterns.
+//
+
+struct MlasReduceTestCase {
+  std::vector<size_t> Shape;
+  std::vector<bool> Axes;
+};
+
+static const std::vector<MlasReduceTestCase>& GetReduceTestCases() {
+  static const std::vector<MlasReduceTestCase> cases = {
+      {{1}, {true}},
+      {{37}, {true}},
+      {{1, 1, 1}, {true, false, true}},
+      {{5, 133}, {false, true}},               // KR: rows
+      {{133, 5}, {true, false}},               // RK: columns
+      {{300, 17}, {true, false}},              // RK: narrow columns
+      {{3, 41, 19}, {false, true, false}},     // KRK
+      {{7, 6, 29}, {true, false, true}},       // RKR
+      {{2, 3, 5, 7}, {false, false, true, true}},  // NCHW over H, W
+      {{2, 3, 5, 7}, {true, false, true, true}},   // NCHW over N, H, W
+      {{2, 3, 5, 7}, {true, true, true, true}},    // full reduce
+      {{2, 1, 5, 1, 9}, {true, false, false, true, true}},
+      {{4, 3, 2, 5, 3}, {true, false, true, false, true}},
+      {{2, 0, 3}, {false, true, false}},       // empty reduction
+      {{1, 9000}, {false, true}},              // long row, split across threads
+      {{2000, 3}, {true, false}},              // tall columns, split across threads
+  };
+  return cases;
+}
+
+static void ReduceTestReference(const MlasReduceTestCase& Case, const std::vector<double>& Input,
+                                std::vector<size_t>& OutputIndex, size_t& OutputCount) {
+  const size_t Rank = Case.Shape.size();
+  OutputCount = 1;
+  for (size_t d = 0; d < Rank; d++) {
+    if (!Case.Axes[d]) {
+      OutputCount *= Case.Shape[d];
+    }
+  }
+
+  OutputIndex.resize(Input.size());
+  std::vector<size_t> Index(Rank, 0);
+  for (size_t i = 0; i < Input.size(); i++) {
+    size_t o = 0;
+    for (size_t d = 0; d < Rank; d++) {
+      if (!Case.Axes[d]) {
+        o = o * Case.Shape[d] + Index[d];
+      }
+    }
+    OutputIndex[i] = o;
+    for (size_t d = Rank; d > 0; d--) {
+      if (++Index[d - 1] < Case.Shape[d - 1]) {
+        break;
+      }
+      Index[d - 1] = 0;
+    }
+  }
+}
+
+template <typename T>
+class MlasReduceTest : public MlasTestBase {
+ private:
+  using MlasType = typename std::conditional<std::is_same<T, MLFp16>::value, MLAS_FP16, T>::type;
+
+  static constexpr bool IsHalf = std::is_same<T, MLFp16>::value;
+  static constexpr bool IsInteger = std::is_integral<T>::value;
+
+  MatrixGuardBuffer<T> BufferInput;
+  MatrixGuardBuffer<T> BufferOutput;
+
+  void Test(const MlasReduceTestCase& Case, MLAS_REDUCE_KIND Kind) {
+    size_t InputCount = 1;
+    for (size_t s : Case.Shape) {
+      InputCount *= s;
+    }
+
+    T* Input = BufferInput.GetBuffer(std::max<size_t>(InputCount, 1));
+
+    std::default_random_engine generator(static_cast<unsigned>(InputCount * 5 + Kind));
+    std::uniform_int_distribution<int> distribution(-50, 50);
+
+    std::vector<double> Values(InputCount);
+    for (size_t i = 0; i < InputCount; i++) {
+      int v = distribution(generator);
+      if constexpr (IsInteger) {
+        Input[i] = T(v);
+      } else {
+        Input[i] = T(v * 0.0625f);
+      }
+      Values[i] = double(float(Input[i]));
+    }
+
+    std::vector<size_t> OutputIndex;
+    size_t OutputCount;
+    ReduceTestReference(Case, Values, OutputIndex, OutputCount);
+
+    std::vector<double> Expected(OutputCount);
+    std::vector<size_t> Counts(OutputCount, 0);
+    for (size_t o = 0; o < OutputCount; o++) {
+      if (Kind == MlasReduceMax) {
+        Expected[o] = IsInteger ? double(std::numeric_limits<T>::lowest()) : -INFINITY;
+      } else if (Kind == MlasReduceMin) {
+        Expected[o] = IsInteger ? double(std::numeric_limits<T>::max()) : INFINITY;
+      } else {
+        Expected[o] = 0.0;
+      }
+    }
+    for (size_t i = 0; i < InputCount; i++) {
+      double& e = Expected[OutputIndex[i]];
+      double x = Values[i];
+      switch (Kind) {
+        case MlasReduceMax:
+          e = std::max(e, x);
+          break;
+        case MlasReduceMin:
+          e = std::min(e, x);
+          break;
+        case MlasReduceSumSquare:
+          e += x * x;
+          break;
+        default:
+          e += x;
+          break;
+      }
+      Counts[OutputIndex[i]]++;
+    }
+    if (Kind == MlasReduceMean) {
+      for (size_t o = 0; o < OutputCount; o++) {
+        if (IsInteger) {
+          Expected[o] = Counts[o] > 0 ? double(int64_t(Expected[o]) / int64_t(Counts[o])) : 0.0;
+        } else {
+          Expected[o] /= double(Counts[o]);
+        }
+      }
+    }
+
+    T* Output = BufferOutput.GetBuffer(std::max<size_t>(OutputCount, 1));
+
+    std::unique_ptr<bool[]> Axes(new bool[Case.Axes.size()]);
+    std::copy(Case.Axes.begin(), Case.Axes.end(), Axes.get());
+
+    MlasReduce<MlasType>(Kind, Case.Shape.size(), Case.Shape.data(), Axes.get(),
+                         reinterpret_cast<const MlasType*>(Input), reinterpret_cast<MlasType*>(Output), GetMlasThreadPool());
+
+    const double Tolerance = IsHalf ? 4e-3 : 1e-5;
+
+    for (size_t o = 0; o < OutputCount; o++) {
+      const double e = Expected[o];
+      double y;
+      if constexpr (IsInteger) {
+        y = double(Output[o]);
+      } else {
+        y = double(float(Output[o]));
+      }
+      if (std::isnan(e)) {
+        ASSERT_TRUE(std::isnan(y)) << "Kind=" << Kind << " Shape=" << ShapeString(Case) << " @" << o;
+      } else if (std::isinf(e) || IsInteger) {
+        ASSERT_EQ(y, e) << "Kind=" << Kind << " Shape=" << ShapeString(Case) << " @" << o;
+      } else {
+        ASSERT_NEAR(y, e, Tolerance * (1.0 + std::fabs(e)))
+            << "Kind=" << Kind << " Shape=" << ShapeString(Case) << " @" << o;
+      }
+    }
+  }
+
+  static std::string ShapeString(const MlasReduceTestCase& Case) {
+    std::string s;
+    for (size_t d = 0; d < Case.Shape.size(); d++) {
+      s += (d ? "x" : "") + std::to_string(Case.Shape[d]) + (Case.Axes[d] ? "r" : "");
+    }
+    return s;
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name =
+        std::string("Reduce_") + (IsHalf ? "Fp16" : (IsInteger ? "Int32" : "Float"));
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (const auto& Case : GetReduceTestCases()) {
+      for (MLAS_REDUCE_KIND Kind : {MlasReduceSum, MlasReduceMean, MlasReduceSumSquare, MlasReduceMax, MlasReduceMin}) {
+        if (IsHalf && Kind == MlasReduceSumSquare) {
+          continue;
+        }
+        Test(Case, Kind);
+      }
+    }
+  }
+};
+
+class MlasReduceMeanVarianceTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferMean;
+  MatrixGuardBuffer<float> BufferVariance;
+
+  void Test(const MlasReduceTestCase& Case) {
+    size_t InputCount = 1;
+    for (size_t s : Case.Shape) {
+      InputCount *= s;
+    }
+    if (InputCount == 0) {
+      return;
+    }
+
+    float* Input = BufferInput.GetBuffer(InputCount);
+
+    std::default_random_engine generator(static_cast<unsigned>(InputCount));
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    std::vector<double> Values(InputCount);
+    for (size_t i = 0; i < InputCount; i++) {
+      // Offset the values so a naive sum of squares would lose precision.
+      Input[i] = 100.0f + distribution(generator);
+      Values[i] = Input[i];
+    }
+
+    std::vector<size_t> OutputIndex;
+    size_t OutputCount;
+    ReduceTestReference(Case, Values, OutputIndex, OutputCount);
+
+    std::vector<double> Sum(OutputCount, 0.0);
+    std::vector<double> SumSquare(OutputCount, 0.0);
+    std::vector<size_t> Counts(OutputCount, 0);
+    for (size_t i = 0; i < InputCount; i++) {
+      Sum[OutputIndex[i]] += Values[i];
+      Counts[OutputIndex[i]]++;
+    }
+    for (size_t i = 0; i < InputCount; i++) {
+      const double d = Values[i] - Sum[OutputIndex[i]] / Counts[OutputIndex[i]];
+      SumSquare[OutputIndex[i]] += d * d;
+    }
+
+    float* Mean = BufferMean.GetBuffer(OutputCount);
+    float* Variance = BufferVariance.GetBuffer(OutputCount);
+
+    std::unique_ptr<bool[]> Axes(new bool[Case.Axes.size()]);
+    std::copy(Case.Axes.begin(), Case.Axes.end(), Axes.get());
+
+    MlasReduceMeanVariance(Case.Shape.size(), Case.Shape.data(), Axes.get(), Input, Mean, Variance, GetMlasThreadPool());
+
+    for (size_t o = 0; o < OutputCount; o++) {
+      const double m = Sum[o] / Counts[o];
+      const double v = SumSquare[o] / Counts[o];
+      ASSERT_NEAR(Mean[o], m, 1e-4 * std::fabs(m)) << "@" << o;
+      ASSERT_NEAR(Variance[o], v, 1e-3 * v + 1e-5) << "@" << o;
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name("Reduce_MeanVariance");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (const auto& Case : GetReduceTestCases()) {
+      Test(Case);
+    }
+  }
+};
+
+template <>
+MlasReduceTest<float>* MlasTestFixture<MlasReduceTest<float>>::mlas_tester(nullptr);
+template <>
+MlasReduceTest<MLFp16>* MlasTestFixture<MlasReduceTest<MLFp16>>::mlas_tester(nullptr);
+template <>
+MlasReduceTest<int32_t>* MlasTestFixture<MlasReduceTest<int32_t>>::mlas_tester(nullptr);
+template <>
+MlasReduceMeanVarianceTest* MlasTestFixture<MlasReduceMeanVarianceTest>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasReduceTest<float>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasReduceTest<MLFp16>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasReduceTest<int32_t>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasReduceMeanVarianceTest>::RegisterShortExecute();
+  }
+  return count;
+});
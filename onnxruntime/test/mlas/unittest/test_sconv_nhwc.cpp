@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+//
+// Tests the single precision NHWC depthwise convolution and pooling kernels
+// that consume an indirection buffer of input pixel pointers.
+//
+
+class MlasSconvNhwcTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferFilter;
+  MatrixGuardBuffer<float> BufferBias;
+  MatrixGuardBuffer<float> BufferOutput;
+  MatrixGuardBuffer<float> BufferOutputReference;
+
+  std::vector<const float*> Indirection;
+  std::vector<float> ZeroPadding;
+
+  //
+  // Builds the indirection buffer for a 2D window over an NHWC image. Padding
+  // positions point to the zero vector or are nullptr if UseZeroPadding is
+  // false.
+  //
+  size_t BuildIndirection(const float* Input,
+                          size_t Channels,
+                          size_t InputHeight,
+                          size_t InputWidth,
+                          size_t KernelHeight,
+                          size_t KernelWidth,
+                          size_t Padding,
+                          size_t Stride,
+                          bool UseZeroPadding,
+                          size_t& OutputHeight,
+                          size_t& OutputWidth) {
+    OutputHeight = (InputHeight + 2 * Padding - KernelHeight) / Stride + 1;
+    OutputWidth = (InputWidth + 2 * Padding - KernelWidth) / Stride + 1;
+
+    ZeroPadding.assign(Channels, 0.0f);
+    Indirection.clear();
+
+    for (size_t oh = 0; oh < OutputHeight; oh++) {
+      for (size_t ow = 0; ow < OutputWidth; ow++) {
+        for (size_t ky = 0; ky < KernelHeight; ky++) {
+          for (size_t kx = 0; kx < KernelWidth; kx++) {
+            size_t ih = oh * Stride + ky - Padding;
+            size_t iw = ow * Stride + kx - Padding;
+            if (ih < InputHeight && iw < InputWidth) {
+              Indirection.push_back(Input + (ih * InputWidth + iw) * Channels);
+            } else {
+              Indirection.push_back(UseZeroPadding ? ZeroPadding.data() : nullptr);
+            }
+          }
+        }
+      }
+    }
+
+    return OutputHeight * OutputWidth;
+  }
+
+  void CompareOutput(const float* Output, const float* OutputReference, size_t Elements, const char* Kind,
+                     size_t Channels, size_t KernelSize) {
+    for (size_t i = 0; i < Elements; i++) {
+      float diff = std::fabs(Output[i] - OutputReference[i]);
+      ASSERT_TRUE(diff <= 1e-5f || diff <= std::fabs(OutputReference[i]) * 1e-5f)
+          << Kind << " C" << Channels << "/K" << KernelSize << " @" << i << ", got: " << Output[i]
+          << ", expecting: " << OutputReference[i];
+    }
+  }
+
+  void Test(size_t Channels, size_t InputHeight, size_t InputWidth, size_t KernelHeight, size_t KernelWidth,
+            size_t Padding, size_t Stride) {
+    const size_t InputElements = InputHeight * InputWidth * Channels;
+    const size_t KernelSize = KernelHeight * KernelWidth;
+
+    float* Input = BufferInput.GetBuffer(InputElements);
+    float* Filter = BufferFilter.GetBuffer(KernelSize * Channels);
+    float* Bias = BufferBias.GetBuffer(Channels);
+
+    std::default_random_engine generator(static_cast<unsigned>(InputElements + KernelSize));
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    for (size_t i = 0; i < InputElements; i++) {
+      Input[i] = distribution(generator);
+    }
+    for (size_t i = 0; i < KernelSize * Channels; i++) {
+      Filter[i] = distribution(generator);
+    }
+    for (size_t i = 0; i < Channels; i++) {
+      Bias[i] = distribution(generator);
+    }
+
+    size_t OutputHeight;
+    size_t OutputWidth;
+
+    //
+    // Depthwise convolution with and without the bias.
+    //
+
+    size_t OutputCount = BuildIndirection(Input, Channels, InputHeight, InputWidth, KernelHeight, KernelWidth,
+                                          Padding, Stride, true, OutputHeight, OutputWidth);
+    size_t OutputElements = OutputCount * Channels;
+
+    float* Output = BufferOutput.GetBuffer(OutputElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputElements);
+
+    for (const float* bias : {static_cast<const float*>(nullptr), static_cast<const float*>(Bias)}) {
+      MlasConvDepthwise(Indirection.data(), Filter, bias, Output, Channels, OutputCount, KernelSize);
+
+      for (size_t p = 0; p < OutputCount; p++) {
+        for (size_t c = 0; c < Channels; c++) {
+          float sum = (bias != nullptr) ? bias[c] : 0.0f;
+          for (size_t k = 0; k < KernelSize; k++) {
+            sum += Indirection[p * KernelSize + k][c] * Filter[k * Channels + c];
+          }
+          OutputReference[p * Channels + c] = sum;
+        }
+      }
+
+      CompareOutput(Output, OutputReference, OutputElements, "DepthwiseConv", Channels, KernelSize);
+    }
+
+    //
+    // Pooling with padding excluded and included.
+    //
+
+    for (bool IncludePadding : {false, true}) {
+      OutputCount = BuildIndirection(Input, Channels, InputHeight, InputWidth, KernelHeight, KernelWidth,
+                                     Padding, Stride, IncludePadding, OutputHeight, OutputWidth);
+
+      if (!IncludePadding) {
+        MlasNhwcMaxPool(Indirection.data(), Output, Channels, OutputCount, KernelSize);
+
+        for (size_t p = 0; p < OutputCount; p++) {
+          for (size_t c = 0; c < Channels; c++) {
+            float m = std::numeric_limits<float>::lowest();
+            for (size_t k = 0; k < KernelSize; k++) {
+              const float* in = Indirection[p * KernelSize + k];
+              if (in != nullptr) {
+                m = std::max(m, in[c]);
+              }
+            }
+            OutputReference[p * Channels + c] = m;
+          }
+        }
+
+        CompareOutput(Output, OutputReference, OutputElements, "MaxPool", Channels, KernelSize);
+      }
+
+      MlasNhwcAvgPool(Indirection.data(), Output, Channels, OutputCount, KernelSize);
+
+      for (size_t p = 0; p < OutputCount; p++) {
+        for (size_t c = 0; c < Channels; c++) {
+          float sum = 0.0f;
+          size_t count = 0;
+          for (size_t k = 0; k < KernelSize; k++) {
+            const float* in = Indirection[p * KernelSize + k];
+            if (in != nullptr) {
+              sum += in[c];
+              count++;
+            }
+          }
+          OutputReference[p * Channels + c] = sum / float(count);
+        }
+      }
+
+      CompareOutput(Output, OutputReference, OutputElements,
+                    IncludePadding ? "AvgPoolIncludePad" : "AvgPool", Channels, KernelSize);
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name("SconvNhwc");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (size_t Channels : {1, 3, 4, 7, 16, 23, 32, 67}) {
+      Test(Channels, 7, 7, 3, 3, 1, 1);
+      Test(Channels, 9, 6, 3, 3, 1, 2);
+      Test(Channels, 8, 8, 5, 5, 2, 1);
+      Test(Channels, 5, 11, 1, 1, 0, 1);
+      Test(Channels, 6, 6, 2, 2, 0, 2);
+    }
+  }
+};
+
+template <>
+MlasSconvNhwcTest* MlasTestFixture<MlasSconvNhwcTest>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  return is_short_execute ? MlasDirectShortExecuteTests<MlasSconvNhwcTest>::RegisterShortExecute() : 0;
+});
@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_fp16.h"
+
+//
+// Tests the top-K selection routine against a stable sort of each row.
+//
+
+struct MLBf16 {
+  uint16_t val{0};
+
+  MLBf16() = default;
+  explicit MLBf16(float ff) {
+    uint32_t bits;
+    std::memcpy(&bits, &ff, sizeof(bits));
+    val = static_cast<uint16_t>((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+  }
+
+  operator float() const {
+    const uint32_t bits = uint32_t(val) << 16;
+    float ff;
+    std::memcpy(&ff, &bits, sizeof(ff));
+    return ff;
+  }
+};
+
+template <typename T>
+class MlasTopKTest : public MlasTestBase {
+ private:
+  static constexpr bool IsFloat = std::is_same<T, float>::value;
+  static constexpr bool IsHalf = std::is_same<T, MLFp16>::value;
+
+  using MlasType = typename std::conditional<
+      IsFloat, float, typename std::conditional<IsHalf, MLAS_FP16, MLAS_BF16>::type>::type;
+
+  MatrixGuardBuffer<T> BufferInput;
+  MatrixGuardBuffer<T> BufferValues;
+  MatrixGuardBuffer<int64_t> BufferIndices;
+
+  void Test(size_t Rows, size_t N, size_t K, bool Largest, bool Sorted, int Range) {
+    T* Input = BufferInput.GetBuffer(Rows * N);
+    T* Values = BufferValues.GetBuffer(Rows * K);
+    int64_t* Indices = BufferIndices.GetBuffer(Rows * K);
+
+    // A small value range produces many ties, which must resolve to the lowest index.
+    std::default_random_engine generator(static_cast<unsigned>(Rows * 131 + N * 7 + K));
+    std::uniform_int_distribution<int> distribution(-Range, Range);
+
+    for (size_t i = 0; i < Rows * N; i++) {
+      Input[i] = T(static_cast<float>(distribution(generator)) * 0.25f);
+    }
+
+    MlasTopK<MlasType>(reinterpret_cast<const MlasType*>(Input), Rows, N, K, Largest, Sorted,
+                       reinterpret_cast<MlasType*>(Values), Indices, GetMlasThreadPool());
+
+    std::vector<int64_t> Order(N);
+
+    for (size_t r = 0; r < Rows; r++) {
+      const T* Row = Input + r * N;
+
+      std::iota(Order.begin(), Order.end(), int64_t(0));
+      std::stable_sort(Order.begin(), Order.end(), [&](int64_t a, int64_t b) {
+        return Largest ? float(Row[a]) > float(Row[b]) : float(Row[a]) < float(Row[b]);
+      });
+
+      std::vector<int64_t> Actual(Indices + r * K, Indices + (r + 1) * K);
+      std::vector<int64_t> Expected(Order.begin(), Order.begin() + K);
+
+      if (!Sorted) {
+        std::sort(Actual.begin(), Actual.end());
+        std::sort(Expected.begin(), Expected.end());
+      }
+
+      for (size_t i = 0; i < K; i++) {
+        ASSERT_EQ(Actual[i], Expected[i]) << "Rows=" << Rows << " N=" << N << " K=" << K << " Largest=" << Largest
+                                          << " Sorted=" << Sorted << " row " << r << " @" << i;
+        ASSERT_EQ(float(Values[r * K + i]), float(Row[Indices[r * K + i]]));
+      }
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name = std::string("TopK_") + (IsFloat ? "Float" : (IsHalf ? "Fp16" : "Bf16"));
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (bool Largest : {true, false}) {
+      for (bool Sorted : {true, false}) {
+        Test(1, 1, 1, Largest, Sorted, 10);
+        Test(3, 17, 1, Largest, Sorted, 10);
+        Test(3, 17, 17, Largest, Sorted, 10);
+        Test(4, 100, 5, Largest, Sorted, 3);
+        Test(2, 1000, 50, Largest, Sorted, 1000);
+        Test(2, 1000, 900, Largest, Sorted, 1000);
+        Test(1, 5000, 64, Largest, Sorted, 2);
+        Test(1, 50000, 50, Largest, Sorted, 100000);
+        Test(7, 3001, 33, Largest, Sorted, 500);
+      }
+    }
+  }
+};
+
+template <>
+MlasTopKTest<float>* MlasTestFixture<MlasTopKTest<float>>::mlas_tester(nullptr);
+template <>
+MlasTopKTest<MLFp16>* MlasTestFixture<MlasTopKTest<MLFp16>>::mlas_tester(nullptr);
+template <>
+MlasTopKTest<MLBf16>* MlasTestFixture<MlasTopKTest<MLBf16>>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasTopKTest<float>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasTopKTest<MLFp16>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasTopKTest<MLBf16>>::RegisterShortExecute();
+  }
+  return count;
+});
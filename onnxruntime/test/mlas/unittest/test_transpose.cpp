@@ -45,6 +45,121 @@ class MlasTransposeTest : public MlasTestBase {
   }
 };
 
+template <typename ElementType>
+class MlasTransposeNdTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<ElementType> BufferInput;
+  MatrixGuardBuffer<ElementType> BufferOutput;
+  MatrixGuardBuffer<ElementType> BufferOutputReference;
+
+  void Test(const std::vector<size_t>& Shape, const std::vector<size_t>& Permutation, MLAS_THREADPOOL* threadpool) {
+    const size_t Rank = Shape.size();
+    size_t Elements = 1;
+    for (size_t d : Shape) {
+      Elements *= d;
+    }
+
+    ElementType* Input = BufferInput.GetBuffer(Elements);
+    ElementType* Output = BufferOutput.GetBuffer(Elements);
+    ElementType* OutputReference = BufferOutputReference.GetBuffer(Elements);
+
+    for (size_t i = 0; i < Elements; i++) {
+      Input[i] = static_cast<ElementType>(i * 2654435761u + 1);
+    }
+
+    std::vector<size_t> InputStrides(Rank);
+    size_t Stride = 1;
+    for (size_t d = Rank; d > 0; d--) {
+      InputStrides[d - 1] = Stride;
+      Stride *= Shape[d - 1];
+    }
+
+    std::vector<size_t> Index(Rank, 0);
+    for (size_t i = 0; i < Elements; i++) {
+      size_t Offset = 0;
+      for (size_t k = 0; k < Rank; k++) {
+        Offset += Index[k] * InputStrides[Permutation[k]];
+      }
+      OutputReference[i] = Input[Offset];
+      for (size_t k = Rank; k > 0; k--) {
+        if (++Index[k - 1] < Shape[Permutation[k - 1]]) {
+          break;
+        }
+        Index[k - 1] = 0;
+      }
+    }
+
+    MlasTransposeNd(Input, Output, sizeof(ElementType), Rank, Shape.data(), Permutation.data(), threadpool);
+
+    std::ostringstream description;
+    description << " shape [";
+    for (size_t d : Shape) {
+      description << d << ",";
+    }
+    description << "] perm [";
+    for (size_t p : Permutation) {
+      description << p << ",";
+    }
+    description << "]";
+
+    ASSERT_EQ(memcmp(Output, OutputReference, Elements * sizeof(ElementType)), 0) << description.str();
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name = std::string("TransposeNd_Size") + std::to_string(int(sizeof(ElementType)));
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    MLAS_THREADPOOL* threadpool = GetMlasThreadPool();
+
+    // Two dimensional transposes around the block and tile sizes.
+    for (size_t m : {1, 3, 8, 17, 33, 70}) {
+      for (size_t n : {2, 5, 16, 31, 64, 129}) {
+        Test({m, n}, {1, 0}, threadpool);
+      }
+    }
+
+    // Attention head reshuffles.
+    Test({2, 7, 4, 16}, {0, 2, 1, 3}, threadpool);
+    Test({3, 5, 6, 1}, {0, 2, 1, 3}, threadpool);
+    Test({2, 9, 3, 2}, {0, 2, 1, 3}, threadpool);
+    Test({2, 4, 9, 16}, {0, 1, 3, 2}, threadpool);
+    Test({2, 9, 4, 16}, {0, 2, 3, 1}, threadpool);
+
+    // NCHW <-> NHWC.
+    Test({2, 3, 13, 11}, {0, 2, 3, 1}, threadpool);
+    Test({2, 64, 9, 9}, {0, 2, 3, 1}, threadpool);
+    Test({2, 13, 11, 3}, {0, 3, 1, 2}, threadpool);
+    Test({1, 9, 9, 67}, {0, 3, 1, 2}, threadpool);
+
+    // Higher rank permutations with unit dimensions and mergeable axes.
+    Test({3, 1, 4, 5, 6}, {4, 2, 0, 3, 1}, threadpool);
+    Test({2, 3, 4, 5, 6, 7}, {5, 0, 1, 4, 3, 2}, threadpool);
+    Test({2, 3, 4, 5, 6, 7}, {1, 2, 0, 4, 5, 3}, threadpool);
+    Test({4, 1, 1, 6, 1, 5}, {5, 4, 3, 2, 1, 0}, threadpool);
+    Test({2, 2, 2, 2, 2, 2, 2, 2}, {7, 6, 5, 4, 3, 2, 1, 0}, threadpool);
+
+    // Reshapes and empty tensors.
+    Test({1, 5, 1, 7}, {2, 1, 0, 3}, threadpool);
+    Test({4, 0, 3}, {2, 1, 0}, threadpool);
+
+    // Large enough to be partitioned across threads.
+    Test({8, 256, 300}, {0, 2, 1}, threadpool);
+    Test({4, 128, 12, 64}, {0, 2, 1, 3}, threadpool);
+  }
+};
+
+template <>
+MlasTransposeNdTest<uint64_t>* MlasTestFixture<MlasTransposeNdTest<uint64_t>>::mlas_tester(nullptr);
+template <>
+MlasTransposeNdTest<uint32_t>* MlasTestFixture<MlasTransposeNdTest<uint32_t>>::mlas_tester(nullptr);
+template <>
+MlasTransposeNdTest<uint16_t>* MlasTestFixture<MlasTransposeNdTest<uint16_t>>::mlas_tester(nullptr);
+template <>
+MlasTransposeNdTest<uint8_t>* MlasTestFixture<MlasTransposeNdTest<uint8_t>>::mlas_tester(nullptr);
+
 template <>
 MlasTransposeTest<uint32_t>* MlasTestFixture<MlasTransposeTest<uint32_t>>::mlas_tester(nullptr);
 template <>
@@ -58,6 +173,10 @@ static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_exe
     count += MlasDirectShortExecuteTests<MlasTransposeTest<uint32_t>>::RegisterShortExecute();
     count += MlasDirectShortExecuteTests<MlasTransposeTest<uint16_t>>::RegisterShortExecute();
     count += MlasDirectShortExecuteTests<MlasTransposeTest<uint8_t>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasTransposeNdTest<uint64_t>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasTransposeNdTest<uint32_t>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasTransposeNdTest<uint16_t>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasTransposeNdTest<uint8_t>>::RegisterShortExecute();
   }
   return count;
 });
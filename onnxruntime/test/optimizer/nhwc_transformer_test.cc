@@ -516,6 +516,73 @@ TEST(NhwcTransformerTests, ConvMixTensorRanks) {
                     TransformerLevel::Level3);
 }
 
+TEST(NhwcTransformerTests, ConvMaxPoolFloatChannelsLast) {
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({2, 13, 13, 23}, -1.5f, 1.5f);
+    auto* transpose1_output_arg = builder.MakeIntermediate();
+    auto* conv1_output_arg = builder.MakeIntermediate();
+    auto* maxpool_output_arg = builder.MakeIntermediate();
+    auto* conv2_output_arg = builder.MakeIntermediate();
+    auto* output_arg = builder.MakeOutput();
+    auto* conv1_weight_arg = builder.MakeInitializer<float>({30, 23, 3, 3}, -1.5f, 1.5f);
+    auto* conv1_bias_arg = builder.MakeInitializer<float>({30}, -1.5f, 1.5f);
+    auto* conv2_weight_arg = builder.MakeInitializer<float>({30, 1, 3, 3}, -1.5f, 1.5f);
+
+    Node& transpose1_node = builder.AddNode("Transpose", {input_arg}, {transpose1_output_arg});
+    transpose1_node.AddAttribute("perm", std::vector<int64_t>{0, 3, 1, 2});
+
+    Node& conv1_node = builder.AddNode("Conv", {transpose1_output_arg, conv1_weight_arg, conv1_bias_arg}, {conv1_output_arg});
+    conv1_node.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+
+    Node& pool_node = builder.AddNode("MaxPool", {conv1_output_arg}, {maxpool_output_arg});
+    pool_node.AddAttribute("kernel_shape", std::vector<int64_t>{3, 3});
+    pool_node.AddAttribute("strides", std::vector<int64_t>{2, 2});
+
+    Node& conv2_node = builder.AddConvNode(maxpool_output_arg, conv2_weight_arg, conv2_output_arg);
+    conv2_node.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+    conv2_node.AddAttribute("group", static_cast<int64_t>(30));
+
+    Node& transpose2_node = builder.AddNode("Transpose", {conv2_output_arg}, {output_arg});
+    transpose2_node.AddAttribute("perm", std::vector<int64_t>{0, 2, 3, 1});
+  };
+
+  auto check_nhwc_graph = [&](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcFusedConv"], 2);
+    EXPECT_EQ(op_to_count["com.ms.internal.nhwc.MaxPool"], 1);
+    EXPECT_EQ(op_to_count["Transpose"], 0);
+  };
+
+  // The channel counts are chosen so that the NCHWc transformer leaves the
+  // nodes for the NHWC transformer.
+  TransformerTester(build_test_case,
+                    check_nhwc_graph,
+                    TransformerLevel::Level2,
+                    TransformerLevel::Level3);
+}
+
+TEST(NhwcTransformerTests, ConvFloatChannelsFirst) {
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({1, 23, 13, 13}, -1.5f, 1.5f);
+    auto* output_arg = builder.MakeOutput();
+    auto* weight_arg = builder.MakeInitializer<float>({30, 23, 3, 3}, -1.5f, 1.5f);
+
+    builder.AddConvNode(input_arg, weight_arg, output_arg);
+  };
+
+  auto check_nhwc_graph = [&](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcFusedConv"], 0);
+    EXPECT_EQ(op_to_count["Transpose"], 0);
+  };
+
+  // fp32 convolutions with channels first inputs are not transformed.
+  TransformerTester(build_test_case,
+                    check_nhwc_graph,
+                    TransformerLevel::Level2,
+                    TransformerLevel::Level3);
+}
+
 #ifdef MLAS_F16VEC_INTRINSICS_SUPPORTED
 
 std::vector<MLFloat16> randomfp16(const std::vector<int64_t>& shape, MLFloat16 min, MLFloat16 max) {
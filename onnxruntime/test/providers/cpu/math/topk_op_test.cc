@@ -646,10 +646,6 @@ TEST(TopKOperator, NthElement_double) {
 }
 
 TEST(TopKOperator, NthElementHalf) {
-  if (!HasCudaEnvironment(600)) {
-    return;
-  }
-
   std::vector<float> input_vals_f = {10.0f, 8.0f, 7.0f, 4.0f, 5.0f, 6.0f};
   std::vector<float> expected_vals_f = {10.0f, 8.0f, 7.0f, 6.0f};
   std::vector<MLFloat16> input_vals(6);
@@ -663,10 +659,6 @@ TEST(TopKOperator, NthElementHalf) {
 }
 
 TEST(TopKOperator, NthElementHalf_NegtiveVals) {
-  if (!HasCudaEnvironment(600)) {
-    return;
-  }
-
   std::vector<float> input_vals_f = {10.0f, -8.0f, -7.0f, -4.0f, -5.0f, -6.0f};
   std::vector<float> expected_vals_f = {10.0f, -4.0f, -5.0f, -6.0f};
   std::vector<MLFloat16> input_vals(6);
@@ -679,6 +671,54 @@ TEST(TopKOperator, NthElementHalf_NegtiveVals) {
   RunTest(11, 4, input_vals, input_dimensions, expected_vals, expected_indices, expected_dimensions, false);
 }
 
+TEST(TopKOperator, HalfExplicitAxisSmallestElements) {
+  std::vector<float> input_vals_f = {0.1f, 0.3f, 0.2f, 0.4f, 0.1f, 0.3f, 0.3f, 0.2f};
+  std::vector<float> expected_vals_f = {0.1f, 0.2f, 0.1f, 0.3f};
+  std::vector<MLFloat16> input_vals(8);
+  std::vector<MLFloat16> expected_vals(4);
+  ConvertFloatToMLFloat16(input_vals_f.data(), input_vals.data(), 8);
+  ConvertFloatToMLFloat16(expected_vals_f.data(), expected_vals.data(), 4);
+  std::vector<int64_t> input_dimensions = {4, 2};
+  std::vector<int64_t> expected_indices = {0, 3, 2, 0};
+  std::vector<int64_t> expected_dimensions = {2, 2};
+  int64_t axis = 0;
+  RunTest(11, 2, input_vals, input_dimensions, expected_vals, expected_indices, expected_dimensions, false, axis, 0);
+}
+
+// a wide innermost axis with a small k, where most blocks of each row are rejected by the running threshold.
+// the values repeat so that ties must resolve to the lowest index.
+TEST(TopKOperator, WideRowSmallK) {
+  constexpr int64_t rows = 3;
+  constexpr int64_t cols = 50000;
+  constexpr int64_t k = 5;
+  std::vector<float> input_vals(rows * cols);
+  for (int64_t i = 0; i < rows * cols; ++i) {
+    input_vals[i] = static_cast<float>((i * 7919) % 1009);
+  }
+
+  std::vector<int64_t> input_dimensions = {rows, cols};
+  std::vector<int64_t> expected_dimensions = {rows, k};
+
+  for (int64_t largest : {1, 0}) {
+    std::vector<float> expected_vals;
+    std::vector<int64_t> expected_indices;
+    for (int64_t r = 0; r < rows; ++r) {
+      std::vector<int64_t> order(cols);
+      std::iota(order.begin(), order.end(), 0);
+      const float* row = input_vals.data() + r * cols;
+      std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+        return largest ? row[a] > row[b] : row[a] < row[b];
+      });
+      for (int64_t i = 0; i < k; ++i) {
+        expected_vals.push_back(row[order[i]]);
+        expected_indices.push_back(order[i]);
+      }
+    }
+    RunTest(11, k, input_vals, input_dimensions, expected_vals, expected_indices, expected_dimensions, false, -1,
+            largest);
+  }
+}
+
 // test dimension in range (GridDim::maxThreadsPerBlock, GridDim::maxThreadsPerBlock * 2], ie. [257, 512]
 TEST(TopKOperator, SmallArrayTopKSorted) {
   std::vector<float> input_vals(400, 0.0f);
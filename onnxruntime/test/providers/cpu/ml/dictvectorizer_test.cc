@@ -25,6 +25,26 @@ TEST(MLOpTest, DictVectorizerStringInput) {
   test.Run();
 }
 
+TEST(MLOpTest, DictVectorizerDuplicatedVocabulary) {
+  OpTester test("DictVectorizer", 1, onnxruntime::kMLDomain);
+
+  test.AddAttribute("string_vocabulary",
+                    std::vector<std::string>{"a", "category_long_1", "b", "a", "c", "category_long_1", "d", "e"});
+
+  std::map<std::string, int64_t> map;
+  map["a"] = 1;
+  map["category_long_1"] = 2;
+  map["category_long_2"] = 3;
+  map["z"] = 4;
+
+  test.AddInput<std::string, int64_t>("X", map);
+
+  std::vector<int64_t> dims{1, 8};
+  test.AddOutput<int64_t>("Y", dims,
+                          {1, 2, 0, 1, 0, 2, 0, 0});
+  test.Run();
+}
+
 TEST(MLOpTest, DictVectorizerInt64Input) {
   OpTester test("DictVectorizer", 1, onnxruntime::kMLDomain);
 
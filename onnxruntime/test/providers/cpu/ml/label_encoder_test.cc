@@ -63,6 +63,34 @@ TEST(LabelEncoder, StringToIntOpset2) {
   test.Run();
 }
 
+TEST(LabelEncoder, StringToIntOpset2LargeBatch) {
+  // Keys longer than 8 characters sharing a prefix, a duplicated key keeps its first value.
+  const std::vector<std::string> keys{"category_0001", "category_0002", "category_0003", "cat", "category_0001", ""};
+  const std::vector<std::int64_t> values{1, 2, 3, 4, 5, 6};
+  const std::vector<std::string> candidates{"category_0001", "category_0002", "category_0003", "cat",
+                                            "category_0004", "category_000", "", "dog"};
+  const std::vector<std::int64_t> expected{1, 2, 3, 4, -1, -1, 6, -1};
+
+  constexpr size_t batch = 4096;
+  std::vector<std::string> input;
+  std::vector<std::int64_t> output;
+  for (size_t i = 0; i < batch; ++i) {
+    input.push_back(candidates[(i * 7) % candidates.size()]);
+    output.push_back(expected[(i * 7) % candidates.size()]);
+  }
+
+  OpTester test("LabelEncoder", 2, onnxruntime::kMLDomain);
+
+  test.AddAttribute("keys_strings", keys);
+  test.AddAttribute("values_int64s", values);
+  test.AddAttribute("default_int64", (std::int64_t)-1);
+
+  test.AddInput<std::string>("X", {static_cast<int64_t>(batch)}, input);
+  test.AddOutput<std::int64_t>("Y", {static_cast<int64_t>(batch)}, output);
+
+  test.Run();
+}
+
 TEST(LabelEncoder, IntToStringOpset2) {
   std::vector<std::int64_t> dims{1, 5};
 
@@ -32,6 +32,39 @@ TEST(MLOpTest, SVMRegressorSVC) {
   test.Run();
 }
 
+// Unscaled features far from the origin and close to the support vectors. The squared distances of
+// about 1 are lost if they are computed as |x|^2 + |sv|^2 - 2 x.sv in float, every kernel value
+// would then be 1 or 0.
+TEST(MLOpTest, SVMRegressorSVCLargeOffsetFeatures) {
+  OpTester test("SVMRegressor", 1, onnxruntime::kMLDomain);
+
+  std::vector<float> dual_coefficients = {0.75f, -1.25f, 0.5f};
+  std::vector<float> support_vectors = {10000.f, 20000.5f, -15000.f,
+                                        10000.5f, 20000.f, -15000.25f,
+                                        10001.f, 20001.f, -14999.5f};
+  std::vector<float> rho = {0.125f};
+  std::vector<float> kernel_params = {0.5f, 0.f, 3.f};  // gamma, coef0, degree
+
+  std::vector<float> X = {10000.f, 20000.5f, -15000.f,
+                          10000.25f, 20000.25f, -15000.f,
+                          10000.75f, 20000.5f, -14999.75f,
+                          10001.5f, 20001.5f, -14999.f};
+  // Computed with the difference of each pair of features.
+  std::vector<float> predictions = {0.167633757f, -0.0571623445f, 0.144676775f, 0.445528448f};
+
+  test.AddAttribute("kernel_type", std::string("RBF"));
+  test.AddAttribute("coefficients", dual_coefficients);
+  test.AddAttribute("support_vectors", support_vectors);
+  test.AddAttribute("rho", rho);
+  test.AddAttribute("kernel_params", kernel_params);
+  test.AddAttribute("n_supports", static_cast<int64_t>(3));
+
+  test.AddInput<float>("X", {4, 3}, X);
+  test.AddOutput<float>("Y", {4, 1}, predictions);
+
+  test.Run();
+}
+
 TEST(MLOpTest, SVMRegressorNuSVC) {
   OpTester test("SVMRegressor", 1, onnxruntime::kMLDomain);
 
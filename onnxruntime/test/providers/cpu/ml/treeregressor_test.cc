@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <functional>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -760,5 +762,103 @@ TEST(MLOpTest, TreeRegressorTrueNodeBeforeNode) {
   test.Run();
 }
 
+// Builds 100 trees of depth 4 with the nodes numbered depth first and checks the regressor against
+// a direct evaluation of the trees. Half of the nodes send missing values to the true branch.
+void GenDeepTreesAndRunTest(const std::string& mode, int64_t n_obs) {
+  OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+
+  constexpr int64_t n_trees = 100, depth = 4, n_features = 5;
+  std::vector<int64_t> treeids, nodeids, featureids, truenodeids, falsenodeids, missing_tracks;
+  std::vector<float> thresholds;
+  std::vector<std::string> modes;
+  std::vector<int64_t> target_treeids, target_nodeids, target_ids;
+  std::vector<float> target_weights;
+
+  for (int64_t t = 0; t < n_trees; ++t) {
+    int64_t next_id = 0;
+    std::function<int64_t(int64_t)> add_node = [&](int64_t level) -> int64_t {
+      int64_t id = next_id++;
+      size_t pos = treeids.size();
+      treeids.push_back(t);
+      nodeids.push_back(id);
+      truenodeids.push_back(0);
+      falsenodeids.push_back(0);
+      if (level == depth) {
+        featureids.push_back(0);
+        thresholds.push_back(0.f);
+        modes.push_back("LEAF");
+        missing_tracks.push_back(0);
+        target_treeids.push_back(t);
+        target_nodeids.push_back(id);
+        target_ids.push_back(0);
+        target_weights.push_back(static_cast<float>((t * 7 + id * 3) % 11) - 5.f);
+        return id;
+      }
+      featureids.push_back((t + id) % n_features);
+      thresholds.push_back(static_cast<float>((t * 5 + id * 13) % 17) / 4.f - 2.f);
+      modes.push_back(mode);
+      missing_tracks.push_back((t + id) % 2);
+      truenodeids[pos] = add_node(level + 1);
+      falsenodeids[pos] = add_node(level + 1);
+      return id;
+    };
+    add_node(0);
+  }
+
+  std::vector<float> X(static_cast<size_t>(n_obs * n_features));
+  for (size_t i = 0; i < X.size(); ++i) {
+    X[i] = i % 13 == 5 ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>((i * 37) % 19) / 4.f - 2.2f;
+  }
+
+  // Nodes are stored in id order, the node with id k of a tree is at tree_start + k.
+  std::vector<float> leaf_weights(treeids.size(), 0.f);
+  for (size_t i = 0; i < target_nodeids.size(); ++i) {
+    leaf_weights[static_cast<size_t>(target_treeids[i] * ((int64_t{2} << depth) - 1) + target_nodeids[i])] =
+        target_weights[i];
+  }
+
+  std::vector<float> Y;
+  for (int64_t r = 0; r < n_obs; ++r) {
+    const float* x = X.data() + r * n_features;
+    float sum = 0.f;
+    for (size_t tree_start = 0; tree_start < treeids.size(); tree_start += (size_t{2} << depth) - 1) {
+      size_t n = tree_start;
+      while (modes[n] != "LEAF") {
+        float val = x[featureids[n]];
+        bool is_true = mode == "BRANCH_LEQ" ? val <= thresholds[n] : val > thresholds[n];
+        is_true = is_true || (missing_tracks[n] == 1 && std::isnan(val));
+        n = tree_start + static_cast<size_t>(is_true ? truenodeids[n] : falsenodeids[n]);
+      }
+      sum += leaf_weights[n];
+    }
+    Y.push_back(sum);
+  }
+
+  test.AddAttribute("nodes_truenodeids", truenodeids);
+  test.AddAttribute("nodes_falsenodeids", falsenodeids);
+  test.AddAttribute("nodes_treeids", treeids);
+  test.AddAttribute("nodes_nodeids", nodeids);
+  test.AddAttribute("nodes_featureids", featureids);
+  test.AddAttribute("nodes_values", thresholds);
+  test.AddAttribute("nodes_modes", modes);
+  test.AddAttribute("nodes_missing_value_tracks_true", missing_tracks);
+  test.AddAttribute("target_treeids", target_treeids);
+  test.AddAttribute("target_nodeids", target_nodeids);
+  test.AddAttribute("target_ids", target_ids);
+  test.AddAttribute("target_weights", target_weights);
+  test.AddAttribute("n_targets", int64_t{1});
+
+  test.AddInput<float>("X", {n_obs, n_features}, X);
+  test.AddOutput<float>("Y", {n_obs, 1}, Y);
+  test.Run();
+}
+
+TEST(MLOpTest, TreeRegressorDeepTreesMissingTracks) {
+  GenDeepTreesAndRunTest("BRANCH_LEQ", 1);
+  GenDeepTreesAndRunTest("BRANCH_LEQ", 37);
+  GenDeepTreesAndRunTest("BRANCH_GT", 37);
+  GenDeepTreesAndRunTest("BRANCH_GT", 203);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -26,6 +26,8 @@ struct ConvOpAndTestAttributes {
   std::unordered_set<std::string> excluded_providers;
   string activation = "";
   vector<float> activation_parameters = {};
+  // With an activation, run NhwcFusedConv if set, otherwise FusedConv.
+  bool channels_last = true;
 };
 
 void TestConvFp16Op(const ConvOpAndTestAttributes& attributes,
@@ -39,7 +41,8 @@ void TestConvFp16Op(const ConvOpAndTestAttributes& attributes,
                     int opset = 11) {
   std::unique_ptr<OpTester> tester;
   if (!attributes.activation.empty()) {
-    tester = std::make_unique<OpTester>("NhwcFusedConv", 1, onnxruntime::kMSDomain);
+    tester = std::make_unique<OpTester>(attributes.channels_last ? "NhwcFusedConv" : "FusedConv", 1,
+                                        onnxruntime::kMSDomain);
     tester->AddAttribute("activation", attributes.activation);
 
     if (!attributes.activation_parameters.empty()) {
@@ -972,6 +975,144 @@ TEST(ConvFp16Test, Conv2D_Bias_Z_Relu) {
   TestConvFp16Op(attrs, {X, W, B, Z}, {X_shape, W_shape, B_shape, Z_shape}, expected_vals, Y_shape);
 }
 
+TEST(ConvFp16Test, NhwcFusedConv_Group_Bias_Z_Relu) {
+  // Two groups of two channels, computed with one GEMM per group.
+  ConvOpAndTestAttributes attrs = {
+      "",                           // auto_pad
+      vector<int64_t>{1, 1},        // dilations
+      2,                            // group
+      vector<int64_t>{2, 2},        // kernel_shape
+      vector<int64_t>{0, 0, 0, 0},  // pads
+      vector<int64_t>{1, 1},        // strides
+      {},                           // excluded EPs
+      "Relu"                        // activation
+  };
+
+  vector<MLFloat16> X = {MLFloat16(-5.0f), MLFloat16(2.0f), MLFloat16(-2.0f), MLFloat16(5.0f), MLFloat16(1.0f),
+                         MLFloat16(-3.0f), MLFloat16(4.0f), MLFloat16(0.0f), MLFloat16(-4.0f), MLFloat16(3.0f),
+                         MLFloat16(-1.0f), MLFloat16(-5.0f), MLFloat16(2.0f), MLFloat16(-2.0f), MLFloat16(5.0f),
+                         MLFloat16(1.0f), MLFloat16(-3.0f), MLFloat16(4.0f), MLFloat16(0.0f), MLFloat16(-4.0f),
+                         MLFloat16(3.0f), MLFloat16(-1.0f), MLFloat16(-5.0f), MLFloat16(2.0f), MLFloat16(-2.0f),
+                         MLFloat16(5.0f), MLFloat16(1.0f), MLFloat16(-3.0f), MLFloat16(4.0f), MLFloat16(0.0f),
+                         MLFloat16(-4.0f), MLFloat16(3.0f), MLFloat16(-1.0f), MLFloat16(-5.0f), MLFloat16(2.0f),
+                         MLFloat16(-2.0f)};
+  vector<int64_t> X_shape = {1, 3, 3, 4};
+  vector<MLFloat16> W = {MLFloat16(-1.5f), MLFloat16(1.0f), MLFloat16(0.0f), MLFloat16(-1.0f), MLFloat16(1.5f),
+                         MLFloat16(0.5f), MLFloat16(-0.5f), MLFloat16(-1.5f), MLFloat16(1.0f), MLFloat16(0.0f),
+                         MLFloat16(-1.0f), MLFloat16(1.5f), MLFloat16(0.5f), MLFloat16(-0.5f), MLFloat16(-1.5f),
+                         MLFloat16(1.0f), MLFloat16(0.0f), MLFloat16(-1.0f), MLFloat16(1.5f), MLFloat16(0.5f),
+                         MLFloat16(-0.5f), MLFloat16(-1.5f), MLFloat16(1.0f), MLFloat16(0.0f), MLFloat16(-1.0f),
+                         MLFloat16(1.5f), MLFloat16(0.5f), MLFloat16(-0.5f), MLFloat16(-1.5f), MLFloat16(1.0f),
+                         MLFloat16(0.0f), MLFloat16(-1.0f)};
+  vector<int64_t> W_shape = {4, 2, 2, 2};
+  vector<MLFloat16> B = {MLFloat16(1.0f), MLFloat16(-2.0f), MLFloat16(0.5f), MLFloat16(-0.5f)};
+  vector<int64_t> B_shape = {4};
+  vector<MLFloat16> Z = {MLFloat16(-2.0f), MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(2.0f),
+                         MLFloat16(-2.0f), MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(2.0f),
+                         MLFloat16(-2.0f), MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(2.0f),
+                         MLFloat16(-2.0f)};
+  vector<int64_t> Z_shape = {1, 2, 2, 4};
+  vector<int64_t> Y_shape = {1, 2, 2, 4};
+  auto expected_vals = {MLFloat16(7.0f), MLFloat16(0.0f), MLFloat16(2.5f), MLFloat16(7.5f), MLFloat16(0.0f),
+                        MLFloat16(0.0f), MLFloat16(1.5f), MLFloat16(0.0f), MLFloat16(0.0f), MLFloat16(0.0f),
+                        MLFloat16(0.5f), MLFloat16(0.0f), MLFloat16(22.5f), MLFloat16(0.0f), MLFloat16(4.5f),
+                        MLFloat16(0.0f)};
+  TestConvFp16Op(attrs, {X, W, B, Z}, {X_shape, W_shape, B_shape, Z_shape}, expected_vals, Y_shape);
+  TestConvFp16Op(attrs, {X, W, B, Z}, {X_shape, W_shape, B_shape, Z_shape}, expected_vals, Y_shape, true);
+}
+
+TEST(ConvFp16Test, NhwcFusedConv_Depthwise_Bias_Z_Relu) {
+  // One channel per group, computed with the depthwise kernel from the indirection buffer.
+  ConvOpAndTestAttributes attrs = {
+      "",                           // auto_pad
+      vector<int64_t>{1, 1},        // dilations
+      3,                            // group
+      vector<int64_t>{2, 2},        // kernel_shape
+      vector<int64_t>{1, 1, 0, 0},  // pads
+      vector<int64_t>{1, 1},        // strides
+      {},                           // excluded EPs
+      "Relu"                        // activation
+  };
+
+  vector<MLFloat16> X = {MLFloat16(-4.0f), MLFloat16(-1.0f), MLFloat16(2.0f), MLFloat16(-3.0f), MLFloat16(0.0f),
+                         MLFloat16(3.0f), MLFloat16(-2.0f), MLFloat16(1.0f), MLFloat16(-4.0f), MLFloat16(-1.0f),
+                         MLFloat16(2.0f), MLFloat16(-3.0f), MLFloat16(0.0f), MLFloat16(3.0f), MLFloat16(-2.0f),
+                         MLFloat16(1.0f), MLFloat16(-4.0f), MLFloat16(-1.0f), MLFloat16(2.0f), MLFloat16(-3.0f),
+                         MLFloat16(0.0f), MLFloat16(3.0f), MLFloat16(-2.0f), MLFloat16(1.0f), MLFloat16(-4.0f),
+                         MLFloat16(-1.0f), MLFloat16(2.0f)};
+  vector<int64_t> X_shape = {1, 3, 3, 3};
+  vector<MLFloat16> W = {MLFloat16(1.0f), MLFloat16(-1.0f), MLFloat16(0.5f), MLFloat16(2.0f),
+                         MLFloat16(-0.5f), MLFloat16(1.0f), MLFloat16(1.0f), MLFloat16(-1.0f),
+                         MLFloat16(2.0f), MLFloat16(0.5f), MLFloat16(-1.0f), MLFloat16(1.0f)};
+  vector<int64_t> W_shape = {3, 1, 2, 2};
+  vector<MLFloat16> B = {MLFloat16(0.5f), MLFloat16(-1.0f), MLFloat16(2.0f)};
+  vector<int64_t> B_shape = {3};
+  vector<MLFloat16> Z = {MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(-1.0f), MLFloat16(0.0f),
+                         MLFloat16(1.0f), MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(-1.0f),
+                         MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f),
+                         MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(-1.0f), MLFloat16(0.0f),
+                         MLFloat16(1.0f), MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(-1.0f),
+                         MLFloat16(0.0f), MLFloat16(1.0f)};
+  vector<int64_t> Z_shape = {1, 3, 3, 3};
+  vector<int64_t> Y_shape = {1, 3, 3, 3};
+  auto expected_vals = {MLFloat16(0.0f), MLFloat16(0.0f), MLFloat16(5.0f), MLFloat16(0.0f), MLFloat16(0.0f),
+                        MLFloat16(4.0f), MLFloat16(0.0f), MLFloat16(0.0f), MLFloat16(0.0f), MLFloat16(1.5f),
+                        MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(0.0f), MLFloat16(0.0f), MLFloat16(9.5f),
+                        MLFloat16(0.5f), MLFloat16(7.0f), MLFloat16(8.0f), MLFloat16(4.5f), MLFloat16(4.0f),
+                        MLFloat16(1.5f), MLFloat16(5.5f), MLFloat16(0.0f), MLFloat16(0.0f), MLFloat16(0.0f),
+                        MLFloat16(0.0f), MLFloat16(0.0f)};
+  TestConvFp16Op(attrs, {X, W, B, Z}, {X_shape, W_shape, B_shape, Z_shape}, expected_vals, Y_shape);
+  TestConvFp16Op(attrs, {X, W, B, Z}, {X_shape, W_shape, B_shape, Z_shape}, expected_vals, Y_shape, true);
+}
+
+TEST(ConvFp16Test, FusedConv_Group_Bias_Z_LeakyRelu) {
+  // Channels first: Z and the activation are applied after the output is transposed back.
+  ConvOpAndTestAttributes attrs = {
+      "",                           // auto_pad
+      vector<int64_t>{1, 1},        // dilations
+      2,                            // group
+      vector<int64_t>{2, 2},        // kernel_shape
+      vector<int64_t>{0, 0, 0, 0},  // pads
+      vector<int64_t>{1, 1},        // strides
+      {},                           // excluded EPs
+      "LeakyRelu",                  // activation
+      vector<float>{0.5f},          // activation_parameters
+      false                         // channels_last
+  };
+
+  vector<MLFloat16> X = {MLFloat16(-4.0f), MLFloat16(1.0f), MLFloat16(-3.0f), MLFloat16(2.0f), MLFloat16(-2.0f),
+                         MLFloat16(3.0f), MLFloat16(-1.0f), MLFloat16(4.0f), MLFloat16(0.0f), MLFloat16(-4.0f),
+                         MLFloat16(1.0f), MLFloat16(-3.0f), MLFloat16(2.0f), MLFloat16(-2.0f), MLFloat16(3.0f),
+                         MLFloat16(-1.0f), MLFloat16(4.0f), MLFloat16(0.0f), MLFloat16(-4.0f), MLFloat16(1.0f),
+                         MLFloat16(-3.0f), MLFloat16(2.0f), MLFloat16(-2.0f), MLFloat16(3.0f), MLFloat16(-1.0f),
+                         MLFloat16(4.0f), MLFloat16(0.0f), MLFloat16(-4.0f), MLFloat16(1.0f), MLFloat16(-3.0f),
+                         MLFloat16(2.0f), MLFloat16(-2.0f), MLFloat16(3.0f), MLFloat16(-1.0f), MLFloat16(4.0f),
+                         MLFloat16(0.0f)};
+  vector<int64_t> X_shape = {1, 4, 3, 3};
+  vector<MLFloat16> W = {MLFloat16(-1.0f), MLFloat16(0.5f), MLFloat16(-0.5f), MLFloat16(1.0f), MLFloat16(0.0f),
+                         MLFloat16(-1.0f), MLFloat16(0.5f), MLFloat16(-0.5f), MLFloat16(1.0f), MLFloat16(0.0f),
+                         MLFloat16(-1.0f), MLFloat16(0.5f), MLFloat16(-0.5f), MLFloat16(1.0f), MLFloat16(0.0f),
+                         MLFloat16(-1.0f), MLFloat16(0.5f), MLFloat16(-0.5f), MLFloat16(1.0f), MLFloat16(0.0f),
+                         MLFloat16(-1.0f), MLFloat16(0.5f), MLFloat16(-0.5f), MLFloat16(1.0f), MLFloat16(0.0f),
+                         MLFloat16(-1.0f), MLFloat16(0.5f), MLFloat16(-0.5f), MLFloat16(1.0f), MLFloat16(0.0f),
+                         MLFloat16(-1.0f), MLFloat16(0.5f)};
+  vector<int64_t> W_shape = {4, 2, 2, 2};
+  vector<MLFloat16> B = {MLFloat16(-1.0f), MLFloat16(0.5f), MLFloat16(1.0f), MLFloat16(-0.5f)};
+  vector<int64_t> B_shape = {4};
+  vector<MLFloat16> Z = {MLFloat16(-2.0f), MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(-2.0f),
+                         MLFloat16(-1.0f), MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(-2.0f), MLFloat16(-1.0f),
+                         MLFloat16(0.0f), MLFloat16(1.0f), MLFloat16(-2.0f), MLFloat16(-1.0f), MLFloat16(0.0f),
+                         MLFloat16(1.0f)};
+  vector<int64_t> Z_shape = {1, 4, 2, 2};
+  vector<int64_t> Y_shape = {1, 4, 2, 2};
+  auto expected_vals = {MLFloat16(-0.25f), MLFloat16(0.0f), MLFloat16(0.0f), MLFloat16(0.5f), MLFloat16(-1.75f),
+                        MLFloat16(-1.25f), MLFloat16(-0.75f), MLFloat16(-0.25f), MLFloat16(0.0f),
+                        MLFloat16(1.5f), MLFloat16(3.5f), MLFloat16(5.0f), MLFloat16(-4.25f), MLFloat16(3.5f),
+                        MLFloat16(4.0f), MLFloat16(-3.25f)};
+  TestConvFp16Op(attrs, {X, W, B, Z}, {X_shape, W_shape, B_shape, Z_shape}, expected_vals, Y_shape);
+  TestConvFp16Op(attrs, {X, W, B, Z}, {X_shape, W_shape, B_shape, Z_shape}, expected_vals, Y_shape, true);
+}
+
 #endif  // CONTRIB_OPS
 
 #ifndef ENABLE_TRAINING
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include "core/framework/session_options.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 using namespace std;
@@ -736,5 +738,65 @@ TEST(ConvTest, Conv_AutoPad_with_non_default_strides) {
   TestConvOp(attrs, {X, W}, {X_shape, W_shape}, expected_vals, Y_shape, true);
 }
 
+#ifndef ENABLE_TRAINING
+// Prepacking is disabled in full training build so no need to test the feature in a training build.
+
+// 8 input and output channels and a 6x6 output qualify a 3x3 unit stride Conv with constant
+// weights for the Winograd algorithm once the session opts in with kOrtSessionOptionsMlasConvWinograd.
+TEST(ConvTest, Conv2D_Winograd) {
+  constexpr int64_t C = 8, M = 8, H = 6, W = 6;
+
+  vector<float> X(C * H * W);
+  for (size_t i = 0; i < X.size(); ++i) {
+    X[i] = static_cast<float>(static_cast<int64_t>(i * 37 % 23) - 11) / 8.0f;
+  }
+  vector<float> weights(M * C * 3 * 3);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    weights[i] = static_cast<float>(static_cast<int64_t>(i * 29 % 19) - 9) / 16.0f;
+  }
+  vector<float> B(M);
+  for (size_t i = 0; i < B.size(); ++i) {
+    B[i] = static_cast<float>(i) / 4.0f - 1.0f;
+  }
+
+  vector<float> expected(M * H * W);
+  for (int64_t m = 0; m < M; ++m) {
+    for (int64_t y = 0; y < H; ++y) {
+      for (int64_t x = 0; x < W; ++x) {
+        double sum = B[m];
+        for (int64_t c = 0; c < C; ++c) {
+          for (int64_t ky = 0; ky < 3; ++ky) {
+            for (int64_t kx = 0; kx < 3; ++kx) {
+              const int64_t iy = y + ky - 1;
+              const int64_t ix = x + kx - 1;
+              if (iy >= 0 && iy < H && ix >= 0 && ix < W) {
+                sum += static_cast<double>(X[(c * H + iy) * W + ix]) * weights[((m * C + c) * 3 + ky) * 3 + kx];
+              }
+            }
+          }
+        }
+        expected[(m * H + y) * W + x] = static_cast<float>(sum);
+      }
+    }
+  }
+
+  OpTester test("Conv", 11);
+  test.AddAttribute("kernel_shape", vector<int64_t>{3, 3});
+  test.AddAttribute("pads", vector<int64_t>{1, 1, 1, 1});
+  test.AddInput<float>("X", {1, C, H, W}, X);
+  test.AddInput<float>("W", {M, C, 3, 3}, weights, true);
+  test.AddInput<float>("B", {M}, B, true);
+  test.AddOutput<float>("Y", {1, M, H, W}, expected);
+  test.SetOutputAbsErr("Y", 1e-4f);
+
+  SessionOptions so;
+  // Keep the Conv node, the NCHWc transformer would replace it at the highest level.
+  so.graph_optimization_level = TransformerLevel::Level2;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsMlasConvWinograd, "1"));
+  test.Run(so, OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider, kQnnExecutionProvider});
+}
+
+#endif
+
 }  // namespace test
 }  // namespace onnxruntime
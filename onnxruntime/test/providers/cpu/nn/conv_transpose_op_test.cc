@@ -1130,6 +1130,94 @@ TEST(ConvTransposeTest, ConvTranspose_AutoPad_with_non_default_strides) {
                       {kTensorrtExecutionProvider, kOpenVINOExecutionProvider, kQnnExecutionProvider});  // Accuracy Mismatch on OpenVINO-EP
 }
 
+// The output_shape is larger than the natural output size of 4x4. The pads stay zero and the
+// output positions past the natural output only receive the bias.
+TEST(ConvTransposeTest, ConvTranspose_2D_OutputShapeLargerThanNatural) {
+  ConvTransposeOpAttributes attrs = {
+      vector<int64_t>{2, 2},  // kernel_shape
+      {},                     // output_padding
+      vector<int64_t>{5, 5},  // output_shape
+      {},                     // pads
+      vector<int64_t>{2, 2},  // strides
+      vector<int64_t>{1, 1},  // dilations
+      1,                      // group
+      "NOTSET"                // auto_pad
+  };
+
+  vector<float> X = {1.0f, 2.0f,
+                     3.0f, 4.0f};
+  vector<int64_t> X_shape = {1, 1, 2, 2};
+  vector<float> W = {1.0f, 2.0f,
+                     3.0f, 4.0f,
+
+                     1.0f, 1.0f,
+                     1.0f, 1.0f};
+  vector<int64_t> W_shape = {1, 2, 2, 2};
+  vector<float> B = {0.5f, -1.0f};
+  vector<int64_t> B_shape = {2};
+  vector<int64_t> Y_shape = {1, 2, 5, 5};
+  auto expected_vals = {1.5f, 2.5f, 2.5f, 4.5f, 0.5f,
+                        3.5f, 4.5f, 6.5f, 8.5f, 0.5f,
+                        3.5f, 6.5f, 4.5f, 8.5f, 0.5f,
+                        9.5f, 12.5f, 12.5f, 16.5f, 0.5f,
+                        0.5f, 0.5f, 0.5f, 0.5f, 0.5f,
+
+                        0.0f, 0.0f, 1.0f, 1.0f, -1.0f,
+                        0.0f, 0.0f, 1.0f, 1.0f, -1.0f,
+                        2.0f, 2.0f, 3.0f, 3.0f, -1.0f,
+                        2.0f, 2.0f, 3.0f, 3.0f, -1.0f,
+                        -1.0f, -1.0f, -1.0f, -1.0f, -1.0f};
+
+  TestConvTransposeOp(attrs, {X, W, B}, {X_shape, W_shape, B_shape}, expected_vals, Y_shape,
+                      OpTester::ExpectResult::kExpectSuccess, "",
+                      {kTensorrtExecutionProvider, kCudaExecutionProvider, kRocmExecutionProvider,
+                       kDmlExecutionProvider, kOpenVINOExecutionProvider, kQnnExecutionProvider});
+}
+
+// Negative pads grow the output. The MLAS transposed convolution does not take them, so these
+// run the GEMM + Col2im path, also when the filter is a prepacked initializer.
+TEST(ConvTransposeTest, ConvTranspose_2D_NegativePads) {
+  ConvTransposeOpAttributes attrs = {
+      vector<int64_t>{2, 2},           // kernel_shape
+      {},                              // output_padding
+      {},                              // output_shape
+      vector<int64_t>{-1, 0, 0, -1},  // pads
+      vector<int64_t>{2, 2},           // strides
+      vector<int64_t>{1, 1},           // dilations
+      1,                               // group
+      "NOTSET"                         // auto_pad
+  };
+
+  vector<float> X = {1.0f, 2.0f,
+                     3.0f, 4.0f};
+  vector<int64_t> X_shape = {1, 1, 2, 2};
+  vector<float> W = {1.0f, 2.0f,
+                     3.0f, 4.0f,
+
+                     1.0f, 1.0f,
+                     1.0f, 1.0f};
+  vector<int64_t> W_shape = {1, 2, 2, 2};
+  vector<float> B = {0.5f, -1.0f};
+  vector<int64_t> B_shape = {2};
+  vector<int64_t> Y_shape = {1, 2, 5, 5};
+  auto expected_vals = {0.5f, 0.5f, 0.5f, 0.5f, 0.5f,
+                        1.5f, 2.5f, 2.5f, 4.5f, 0.5f,
+                        3.5f, 4.5f, 6.5f, 8.5f, 0.5f,
+                        3.5f, 6.5f, 4.5f, 8.5f, 0.5f,
+                        9.5f, 12.5f, 12.5f, 16.5f, 0.5f,
+
+                        -1.0f, -1.0f, -1.0f, -1.0f, -1.0f,
+                        0.0f, 0.0f, 1.0f, 1.0f, -1.0f,
+                        0.0f, 0.0f, 1.0f, 1.0f, -1.0f,
+                        2.0f, 2.0f, 3.0f, 3.0f, -1.0f,
+                        2.0f, 2.0f, 3.0f, 3.0f, -1.0f};
+
+  TestConvTransposeOp(attrs, {X, W, B}, {X_shape, W_shape, B_shape}, expected_vals, Y_shape,
+                      OpTester::ExpectResult::kExpectSuccess, "",
+                      {kTensorrtExecutionProvider, kCudaExecutionProvider, kRocmExecutionProvider,
+                       kDmlExecutionProvider, kOpenVINOExecutionProvider, kQnnExecutionProvider});
+}
+
 #ifndef ENABLE_TRAINING
 // Prepacking is disabled in full training build so no need to test the feature in a training build.
 TEST(ConvTransposeTest, SharedPrepackedWeights) {
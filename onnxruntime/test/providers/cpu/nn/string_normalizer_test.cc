@@ -1,8 +1,8 @@
 ﻿// Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
-#if ((__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)))
-// TODO: handle the u8string.
-#else
+#include <locale>
+#include <stdexcept>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -38,6 +38,9 @@ void InitTestAttr(OpTester& test, const std::string& case_change_action,
 
 using namespace str_normalizer_test;
 
+#if ((__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)))
+// TODO: handle the u8string.
+#else
 TEST(ContribOpTest, StringNormalizerTest) {
   // - casesensitive approach
   // - no stopwords.
@@ -202,6 +205,93 @@ TEST(ContribOpTest, StringNormalizerTest) {
   }
 }
 
+#endif
+
+// The tests below spell the non-ASCII characters as UTF-8 escapes, so they do not depend on u8 literals.
+// Strings which are ASCII are case mapped without the locale, the others through the locale.
+
+TEST(ContribOpTest, StringNormalizerCaseInsensitiveMixedAsciiNonAscii) {
+  // Stopwords with and without non-ASCII chars, compared to ASCII and non-ASCII strings.
+  const std::vector<std::string> stopwords = {"Monday", "\xC3\x89t\xC3\xA9"};  // Monday, Été
+  const std::vector<std::string> input = {"MONDAY",
+                                          "Tuesday",
+                                          "\xC3\xA9t\xC3\xA9",  // été
+                                          "\xC3\x89T\xC3\x89",  // ÉTÉ
+                                          "Wednesday",
+                                          "\xC3\x87" "a"};  // Ça
+  std::vector<int64_t> dims{static_cast<int64_t>(input.size())};
+  {
+    OpTester test("StringNormalizer", opset_ver, domain);
+    InitTestAttr(test, "LOWER", false, stopwords, test_locale);
+    test.AddInput<std::string>("T", dims, input);
+    std::vector<std::string> output = {"tuesday", "wednesday", "\xC3\xA7" "a"};  // ça
+    test.AddOutput<std::string>("Y", {3}, output);
+    test.Run(OpTester::ExpectResult::kExpectSuccess);
+  }
+  {
+    OpTester test("StringNormalizer", opset_ver, domain);
+    InitTestAttr(test, "UPPER", false, stopwords, test_locale);
+    test.AddInput<std::string>("T", dims, input);
+    std::vector<std::string> output = {"TUESDAY", "WEDNESDAY", "\xC3\x87" "A"};  // ÇA
+    test.AddOutput<std::string>("Y", {3}, output);
+    test.Run(OpTester::ExpectResult::kExpectSuccess);
+  }
+  {
+    OpTester test("StringNormalizer", opset_ver, domain);
+    InitTestAttr(test, "NONE", false, stopwords, test_locale);
+    test.AddInput<std::string>("T", dims, input);
+    std::vector<std::string> output = {"Tuesday", "Wednesday", "\xC3\x87" "a"};
+    test.AddOutput<std::string>("Y", {3}, output);
+    test.Run(OpTester::ExpectResult::kExpectSuccess);
+  }
+}
+
+TEST(ContribOpTest, StringNormalizerCaseInsensitiveKelvinSign) {
+  // The lower case of U+212A KELVIN SIGN is the ASCII 'k', so it matches the ASCII strings
+  // 'k' and 'K' although it is not ASCII itself, and the other way around.
+  const std::string kelvin_sign("\xE2\x84\xAA");
+  {
+    OpTester test("StringNormalizer", opset_ver, domain);
+    InitTestAttr(test, "NONE", false, {kelvin_sign}, test_locale);
+    std::vector<int64_t> dims{4};
+    std::vector<std::string> input = {"k", "K", "kelvin", kelvin_sign};
+    test.AddInput<std::string>("T", dims, input);
+    std::vector<std::string> output = {"kelvin"};
+    test.AddOutput<std::string>("Y", {1}, output);
+    test.Run(OpTester::ExpectResult::kExpectSuccess);
+  }
+  {
+    OpTester test("StringNormalizer", opset_ver, domain);
+    InitTestAttr(test, "NONE", false, {"k"}, test_locale);
+    std::vector<int64_t> dims{3};
+    std::vector<std::string> input = {kelvin_sign, "K", "Kelvin"};
+    test.AddInput<std::string>("T", dims, input);
+    std::vector<std::string> output = {"Kelvin"};
+    test.AddOutput<std::string>("Y", {1}, output);
+    test.Run(OpTester::ExpectResult::kExpectSuccess);
+  }
+}
+
+#ifndef _MSC_VER
+TEST(ContribOpTest, StringNormalizerTurkishLocaleAsciiStrings) {
+  // The Turkish lower case of 'I' is the dotless U+0131, so ASCII strings are case mapped through the locale.
+  const std::string turkish_locale("tr_TR.UTF-8");
+  try {
+    std::locale locale(turkish_locale.c_str());
+  } catch (const std::runtime_error&) {
+    GTEST_SKIP() << "Locale " << turkish_locale << " is not available";
+  }
+
+  OpTester test("StringNormalizer", opset_ver, domain);
+  InitTestAttr(test, "LOWER", false, {"istanbul"}, turkish_locale);
+  std::vector<int64_t> dims{3};
+  std::vector<std::string> input = {"ISTANBUL", "istanbul", "Izmir"};
+  test.AddInput<std::string>("T", dims, input);
+  std::vector<std::string> output = {"\xC4\xB1stanbul", "\xC4\xB1zmir"};  // ıstanbul, ızmir
+  test.AddOutput<std::string>("Y", {2}, output);
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+#endif
+
 }  // namespace test
 }  // namespace onnxruntime
-#endif
\ No newline at end of file
@@ -689,6 +689,54 @@ TEST(TfIdfVectorizerTest, String_TFIDFWeights_onlyBigrams_Skip5_2rows) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }
 
+TEST(TfIdfVectorizerTest, Int64_TF_OverlappingNgrams_Skip1) {
+  OpTester test("TfIdfVectorizer", opset_ver);
+  // s=1, Min=1, Max=3, no weights, int64
+  // max_skip_count=1 scans with skip 0 (adjacent items) and skip 1 (every other item).
+  // n-grams overlap and share prefixes and suffixes: a match of (1, 2, 3) also ends
+  // the bigram (2, 3), and (2, 3, 1) starts inside it.
+  InitTestAttr(test, "TF", 1, 3, 1,
+               {0, 2, 6},
+               {0, 1, 2, 3, 4, 5},  // 6 output indexes
+               {},
+               {1, 2,               // 1-grams
+                2, 3, 1, 2,         // bi-grams
+                1, 2, 3, 2, 3, 1},  // tri-grams
+               {});
+
+  test.AddInput<int64_t>("T", {8}, {1, 2, 3, 1, 2, 9, 3, 1});
+
+  // Skip 0 (items 1 apart): (1, 2) x2, (2, 3) x1, (1, 2, 3) x1, (2, 3, 1) x1
+  // Skip 1 (items 2 apart): (2, 3) x1 from the subsequence 1, 3, 2, 3
+  test.AddOutput<float>("Y", {6}, {3.f, 2.f, 2.f, 2.f, 1.f, 1.f});
+
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
+TEST(TfIdfVectorizerTest, String_TF_NgramsBehindOutOfRangePrefixes_Skip0) {
+  OpTester test("TfIdfVectorizer", opset_ver);
+  // s=0, Min=2, Max=4, no weights, string
+  // 1-grams are outside of the range and are not counted, their states only
+  // prefix longer n-grams. Matching (a, b, c, d) must still report the bigram
+  // (c, d) through the state (b, c, d), which only prefixes (b, c, d, e).
+  InitTestAttr(test, "TF", 2, 4, 0,
+               {0, 2, 6, 6},
+               {0, 1, 2, 3, 4, 5},  // 6 output indexes
+               {},
+               {},
+               {"a", "c",            // 1-grams
+                "c", "d", "d", "e",  // bi-grams
+                "a", "b", "c", "d",  // 4-grams
+                "b", "c", "d", "e"});
+
+  test.AddInput<std::string>("T", {7}, {"a", "b", "c", "d", "e", "c", "d"});
+
+  // (c, d) x2, (d, e) x1, (a, b, c, d) x1, (b, c, d, e) x1; 1-grams stay 0
+  test.AddOutput<float>("Y", {6}, {0.f, 0.f, 2.f, 1.f, 1.f, 1.f});
+
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
 // This test runs the inference 100 times to test the improvement
 // It enables profiling while running inference multiple times.
 // So we can manually inspect the profiling output
@@ -5243,5 +5243,53 @@ TEST(ReductionOpTest, ReduceSum_RKRK_keepdims) {
   test.Run();
 }
 
+// Reductions over non-adjacent axes of a 5-D tensor, which fuse to more than three
+// alternating dimensions, checked against a direct reference for each operator.
+TEST(ReductionOpTest, Reduce_KRKRK_multi_axis) {
+  const std::vector<int64_t> dims{3, 4, 5, 6, 7};
+  const std::vector<int64_t> axes{1, 3};
+  std::vector<float> data(3 * 4 * 5 * 6 * 7);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<float>(static_cast<int>((i * 37) % 101) - 50) * 0.125f;
+  }
+
+  for (const char* op : {"ReduceSum", "ReduceMean", "ReduceSumSquare", "ReduceMax", "ReduceMin"}) {
+    const std::string op_name(op);
+    std::vector<float> expected(3 * 5 * 7);
+    for (int64_t a = 0; a < 3; ++a) {
+      for (int64_t c = 0; c < 5; ++c) {
+        for (int64_t e = 0; e < 7; ++e) {
+          double acc = op_name == "ReduceMax" ? -1e30 : (op_name == "ReduceMin" ? 1e30 : 0.0);
+          for (int64_t b = 0; b < 4; ++b) {
+            for (int64_t d = 0; d < 6; ++d) {
+              const double x = data[(((a * 4 + b) * 5 + c) * 6 + d) * 7 + e];
+              if (op_name == "ReduceMax") {
+                acc = std::max(acc, x);
+              } else if (op_name == "ReduceMin") {
+                acc = std::min(acc, x);
+              } else if (op_name == "ReduceSumSquare") {
+                acc += x * x;
+              } else {
+                acc += x;
+              }
+            }
+          }
+          if (op_name == "ReduceMean") {
+            acc /= 24.0;
+          }
+          expected[(a * 5 + c) * 7 + e] = static_cast<float>(acc);
+        }
+      }
+    }
+
+    OpTester test(op);
+    test.AddAttribute("axes", axes);
+    test.AddAttribute("keepdims", (int64_t)1);
+    test.AddInput<float>("data", dims, data);
+    test.AddOutput<float>("reduced", {3, 1, 5, 1, 7}, expected);
+    test.Run();
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <vector>
 
@@ -149,6 +151,125 @@ TEST(SignalOpsTest, DFT_invertible_complex) {
   TestDFTInvertible(true);
 }
 
+// Reference DFT of one signal of (real, imaginary) pairs, zero padded or truncated to dft_length.
+static vector<double> NaiveDFT(const vector<double>& signal, size_t dft_length, bool inverse) {
+  const size_t number_of_samples = std::min(signal.size() / 2, dft_length);
+  const double sign = inverse ? 1.0 : -1.0;
+  vector<double> output(dft_length * 2, 0.0);
+  for (size_t k = 0; k < dft_length; k++) {
+    for (size_t n = 0; n < number_of_samples; n++) {
+      const double angle = sign * 2.0 * M_PI * static_cast<double>((n * k) % dft_length) / dft_length;
+      output[k * 2] += signal[n * 2] * std::cos(angle) - signal[n * 2 + 1] * std::sin(angle);
+      output[k * 2 + 1] += signal[n * 2] * std::sin(angle) + signal[n * 2 + 1] * std::cos(angle);
+    }
+    if (inverse) {
+      output[k * 2] /= dft_length;
+      output[k * 2 + 1] /= dft_length;
+    }
+  }
+  return output;
+}
+
+// Compares DFT against the naive reference for sizes covering every radix, the
+// real input path and the Bluestein fallback.
+static void TestDFTAgainstReference(int64_t signal_length, int64_t dft_length, bool complex, bool onesided,
+                                    bool inverse) {
+  OpTester test("DFT", kMinOpsetVersion);
+
+  constexpr int64_t num_batches = 3;
+  const int64_t components = complex ? 2 : 1;
+  RandomValueGenerator random(GetTestRandomSeed());
+  vector<int64_t> input_shape{num_batches, signal_length, components};
+  vector<float> input = random.Uniform<float>(input_shape, -1.f, 1.f);
+
+  const int64_t output_length = onesided ? (dft_length >> 1) + 1 : dft_length;
+  vector<int64_t> output_shape{num_batches, output_length, 2};
+  vector<float> expected_output;
+  for (int64_t b = 0; b < num_batches; b++) {
+    vector<double> signal(static_cast<size_t>(signal_length * 2), 0.0);
+    for (int64_t n = 0; n < signal_length; n++) {
+      signal[n * 2] = input[(b * signal_length + n) * components];
+      signal[n * 2 + 1] = complex ? input[(b * signal_length + n) * components + 1] : 0.0;
+    }
+    vector<double> reference = NaiveDFT(signal, static_cast<size_t>(dft_length), inverse);
+    for (int64_t k = 0; k < output_length * 2; k++) {
+      expected_output.push_back(static_cast<float>(reference[k]));
+    }
+  }
+
+  test.AddInput<float>("input", input_shape, input);
+  test.AddInput<int64_t>("dft_length", {}, {dft_length});
+  test.AddAttribute<int64_t>("onesided", static_cast<int64_t>(onesided));
+  test.AddAttribute<int64_t>("inverse", static_cast<int64_t>(inverse));
+  test.AddOutput<float>("output", output_shape, expected_output);
+  test.SetOutputAbsErr("output", 0.001f);
+  test.Run();
+}
+
+TEST(SignalOpsTest, DFTFloat_mixed_radix) {
+  for (int64_t n : {6, 12, 15, 60, 320, 400, 1000}) {
+    TestDFTAgainstReference(n, n, false, true, false);
+    TestDFTAgainstReference(n, n, false, false, false);
+    TestDFTAgainstReference(n, n, true, false, false);
+    TestDFTAgainstReference(n, n, true, false, true);
+  }
+}
+
+TEST(SignalOpsTest, DFTFloat_bluestein) {
+  for (int64_t n : {7, 13, 21, 97, 202}) {
+    TestDFTAgainstReference(n, n, false, true, false);
+    TestDFTAgainstReference(n, n, true, false, false);
+    TestDFTAgainstReference(n, n, false, true, true);
+  }
+}
+
+TEST(SignalOpsTest, DFTFloat_dft_length) {
+  // Zero padded and truncated signals.
+  TestDFTAgainstReference(300, 400, false, true, false);
+  TestDFTAgainstReference(400, 320, false, true, false);
+  TestDFTAgainstReference(9, 11, true, false, false);
+  TestDFTAgainstReference(16, 10, true, false, true);
+}
+
+TEST(SignalOpsTest, STFTFloat_speech_frames) {
+  constexpr int64_t num_batches = 2;
+  constexpr int64_t signal_length = 1600;
+  constexpr int64_t frame_length = 400;
+  constexpr int64_t frame_step = 160;
+  constexpr int64_t n_frames = (signal_length - frame_length) / frame_step + 1;
+  constexpr int64_t output_length = (frame_length >> 1) + 1;
+
+  OpTester test("STFT", kMinOpsetVersion);
+
+  RandomValueGenerator random(GetTestRandomSeed());
+  vector<float> signal = random.Uniform<float>({num_batches, signal_length, 1}, -1.f, 1.f);
+  vector<float> window(frame_length);
+  for (int64_t n = 0; n < frame_length; n++) {
+    window[n] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * n / frame_length));
+  }
+
+  vector<float> expected_output;
+  for (int64_t b = 0; b < num_batches; b++) {
+    for (int64_t f = 0; f < n_frames; f++) {
+      vector<double> frame(frame_length * 2, 0.0);
+      for (int64_t n = 0; n < frame_length; n++) {
+        frame[n * 2] = static_cast<double>(signal[b * signal_length + f * frame_step + n]) * window[n];
+      }
+      vector<double> reference = NaiveDFT(frame, frame_length, false);
+      for (int64_t k = 0; k < output_length * 2; k++) {
+        expected_output.push_back(static_cast<float>(reference[k]));
+      }
+    }
+  }
+
+  test.AddInput<float>("signal", {num_batches, signal_length, 1}, signal);
+  test.AddInput<int64_t>("frame_step", {}, {frame_step});
+  test.AddInput<float>("window", {frame_length}, window);
+  test.AddOutput<float>("output", {num_batches, n_frames, output_length, 2}, expected_output);
+  test.SetOutputAbsErr("output", 0.001f);
+  test.Run();
+}
+
 TEST(SignalOpsTest, STFTFloat) {
   OpTester test("STFT", kMinOpsetVersion);
 
@@ -0,0 +1,195 @@
+# -------------------------------------------------------------------------
+# Copyright (c) Microsoft Corporation.  All rights reserved.
+# Licensed under the MIT License.  See License.txt in the project root for
+# license information.
+# --------------------------------------------------------------------------
+
+import math
+from typing import List
+
+import numpy as np
+import onnx
+from onnx import TensorProto, helper, numpy_helper
+
+
+def int64_tensor(name: str, values: List[int]):
+    return helper.make_tensor(name, TensorProto.INT64, [len(values)], values)
+
+
+def create_rotary_nodes(prefix: str, root: str, output: str) -> List[onnx.NodeProto]:
+    # rotate_half(x) = cat(-x[..., head_size / 2:], x[..., :head_size / 2]) and x * cos + rotate_half(x) * sin
+    return [
+        helper.make_node("Slice", [root, "zero", "half_head_size", "three"], [prefix + "_x1"], prefix + "_slice_x1"),
+        helper.make_node(
+            "Slice", [root, "half_head_size", "int64_max", "three"], [prefix + "_x2"], prefix + "_slice_x2"
+        ),
+        helper.make_node("Neg", [prefix + "_x2"], [prefix + "_neg_x2"], prefix + "_neg"),
+        helper.make_node(
+            "Concat", [prefix + "_neg_x2", prefix + "_x1"], [prefix + "_rotate_half"], prefix + "_concat", axis=-1
+        ),
+        helper.make_node("Mul", [root, "cos"], [prefix + "_mul_cos"], prefix + "_mul_cos"),
+        helper.make_node("Mul", [prefix + "_rotate_half", "sin"], [prefix + "_mul_sin"], prefix + "_mul_sin"),
+        helper.make_node("Add", [prefix + "_mul_cos", prefix + "_mul_sin"], [output], prefix + "_add"),
+    ]
+
+
+def create_repeat_kv_nodes(prefix: str, root: str, shape_5d: str, shape_4d: str) -> List[onnx.NodeProto]:
+    # repeat_kv(x) = x[:, :, None, :, :].expand(B, kv_num_heads, n_rep, T, H).reshape(B, num_heads, T, H)
+    return [
+        helper.make_node("Unsqueeze", [root, "two"], [prefix + "_unsqueeze"], prefix + "_unsqueeze"),
+        helper.make_node("Expand", [prefix + "_unsqueeze", shape_5d], [prefix + "_expand"], prefix + "_expand"),
+        helper.make_node("Reshape", [prefix + "_expand", shape_4d], [prefix + "_repeat"], prefix + "_repeat"),
+    ]
+
+
+def create_llama_attention(
+    batch_size=2,
+    sequence_length=1,
+    past_sequence_length=5,
+    num_heads=4,
+    kv_num_heads=2,
+    head_size=8,
+    vocab_size=16,
+    max_position_embeddings=32,
+):
+    """
+    One attention layer of LLaMA as exported from PyTorch: embedding, projections, rotary embedding of query and
+    key, key and value appended to the past (when past_sequence_length > 0), repeat_kv of key and value to the heads of
+    query, causal attention and output projection.
+    """
+    hidden_size = num_heads * head_size
+    kv_hidden_size = kv_num_heads * head_size
+    total_sequence_length = past_sequence_length + sequence_length
+    n_rep = num_heads // kv_num_heads
+    has_past = past_sequence_length > 0
+
+    nodes = [
+        helper.make_node("Gather", ["embed_tokens", "input_ids"], ["hidden_states"], "embed"),
+        helper.make_node("MatMul", ["hidden_states", "q_proj"], ["q_proj_out"], "q_proj"),
+        helper.make_node("MatMul", ["hidden_states", "k_proj"], ["k_proj_out"], "k_proj"),
+        helper.make_node("MatMul", ["hidden_states", "v_proj"], ["v_proj_out"], "v_proj"),
+        # Query uses -1 for the number of heads, key and value have it in the shape.
+        helper.make_node("Reshape", ["q_proj_out", "q_shape"], ["q_4d"], "q_reshape"),
+        helper.make_node("Reshape", ["k_proj_out", "kv_shape"], ["k_4d"], "k_reshape"),
+        helper.make_node("Reshape", ["v_proj_out", "kv_shape"], ["v_4d"], "v_reshape"),
+        helper.make_node("Transpose", ["q_4d"], ["q"], "q_transpose", perm=[0, 2, 1, 3]),
+        helper.make_node("Transpose", ["k_4d"], ["k"], "k_transpose", perm=[0, 2, 1, 3]),
+        helper.make_node(
+            "Transpose", ["v_4d"], ["v" if has_past else "present_value"], "v_transpose", perm=[0, 2, 1, 3]
+        ),
+    ]
+
+    # cos = cos_cached[:, :, :seq_len].squeeze(1).squeeze(0)[position_ids].unsqueeze(1), and the same for sin.
+    for name in ["cos", "sin"]:
+        nodes.extend(
+            [
+                helper.make_node(
+                    "Slice", [name + "_cached", "zero", "total_length", "two"], [name + "_slice"], name + "_slice"
+                ),
+                helper.make_node("Squeeze", [name + "_slice", "one"], [name + "_squeeze1"], name + "_squeeze1"),
+                helper.make_node("Squeeze", [name + "_squeeze1", "zero"], [name + "_squeeze0"], name + "_squeeze0"),
+                helper.make_node("Gather", [name + "_squeeze0", "position_ids"], [name + "_gather"], name + "_gather"),
+                helper.make_node("Unsqueeze", [name + "_gather", "one"], [name], name + "_unsqueeze"),
+            ]
+        )
+
+    nodes.extend(create_rotary_nodes("q", "q", "q_rotary"))
+    nodes.extend(create_rotary_nodes("k", "k", "k_rotary" if has_past else "present_key"))
+    if has_past:
+        nodes.extend(
+            [
+                helper.make_node("Concat", ["past_key", "k_rotary"], ["present_key"], "concat_key", axis=2),
+                helper.make_node("Concat", ["past_value", "v"], ["present_value"], "concat_value", axis=2),
+            ]
+        )
+
+    if n_rep > 1:
+        nodes.extend(create_repeat_kv_nodes("k", "present_key", "repeat_shape_5d", "repeat_shape_4d"))
+        nodes.extend(create_repeat_kv_nodes("v", "present_value", "repeat_shape_5d", "repeat_shape_4d"))
+        k_repeat, v_repeat = "k_repeat", "v_repeat"
+    else:
+        k_repeat, v_repeat = "present_key", "present_value"
+
+    # Additive mask of padding and future positions.
+    nodes.extend(
+        [
+            helper.make_node("Cast", ["attention_mask"], ["mask_float"], "mask_cast", to=TensorProto.FLOAT),
+            helper.make_node("Sub", ["float_one", "mask_float"], ["mask_inverted"], "mask_sub"),
+            helper.make_node("Mul", ["mask_inverted", "mask_min"], ["mask_padding"], "mask_mul"),
+            helper.make_node("Unsqueeze", ["mask_padding", "one_two"], ["mask_padding_4d"], "mask_unsqueeze"),
+            helper.make_node("Add", ["mask_padding_4d", "causal_mask"], ["mask_4d"], "mask_add"),
+            helper.make_node("Transpose", [k_repeat], ["k_transposed"], "k_repeat_transpose", perm=[0, 1, 3, 2]),
+            helper.make_node("MatMul", ["q_rotary", "k_transposed"], ["qk"], "matmul_qk"),
+            helper.make_node("Div", ["qk", "sqrt_head_size"], ["qk_scaled"], "qk_div"),
+            helper.make_node("Add", ["qk_scaled", "mask_4d"], ["qk_masked"], "qk_add_mask"),
+            helper.make_node("Softmax", ["qk_masked"], ["attention_probs"], "softmax", axis=-1),
+            helper.make_node("MatMul", ["attention_probs", v_repeat], ["attention_4d"], "matmul_qkv"),
+            helper.make_node(
+                "Transpose", ["attention_4d"], ["attention_transposed"], "output_transpose", perm=[0, 2, 1, 3]
+            ),
+            helper.make_node("Reshape", ["attention_transposed", "output_shape"], ["attention"], "output_reshape"),
+            helper.make_node("MatMul", ["attention", "o_proj"], ["output"], "o_proj"),
+        ]
+    )
+
+    # The table repeats the angles of the first half of the head in the second half.
+    inv_freq = 1.0 / (10000 ** (np.arange(0, head_size, 2, dtype=np.float32) / head_size))
+    freqs = np.outer(np.arange(max_position_embeddings, dtype=np.float32), inv_freq)
+    emb = np.concatenate((freqs, freqs), axis=-1)[np.newaxis, np.newaxis, :, :]
+
+    # New token s is at position past_sequence_length + s and does not see the positions after it.
+    causal_mask = np.triu(
+        np.full((sequence_length, total_sequence_length), -10000.0, dtype=np.float32), past_sequence_length + 1
+    )
+
+    rng = np.random.default_rng(0)
+    initializers = [
+        numpy_helper.from_array(rng.uniform(-1, 1, (vocab_size, hidden_size)).astype(np.float32), "embed_tokens"),
+        numpy_helper.from_array(rng.uniform(-1, 1, (hidden_size, hidden_size)).astype(np.float32), "q_proj"),
+        numpy_helper.from_array(rng.uniform(-1, 1, (hidden_size, kv_hidden_size)).astype(np.float32), "k_proj"),
+        numpy_helper.from_array(rng.uniform(-1, 1, (hidden_size, kv_hidden_size)).astype(np.float32), "v_proj"),
+        numpy_helper.from_array(rng.uniform(-1, 1, (hidden_size, hidden_size)).astype(np.float32), "o_proj"),
+        numpy_helper.from_array(np.cos(emb).astype(np.float32), "cos_cached"),
+        numpy_helper.from_array(np.sin(emb).astype(np.float32), "sin_cached"),
+        numpy_helper.from_array(causal_mask.reshape(1, 1, sequence_length, total_sequence_length), "causal_mask"),
+        numpy_helper.from_array(np.array(math.sqrt(head_size), dtype=np.float32), "sqrt_head_size"),
+        numpy_helper.from_array(np.array(1.0, dtype=np.float32), "float_one"),
+        numpy_helper.from_array(np.array(-10000.0, dtype=np.float32), "mask_min"),
+        int64_tensor("zero", [0]),
+        int64_tensor("one", [1]),
+        int64_tensor("two", [2]),
+        int64_tensor("three", [3]),
+        int64_tensor("one_two", [1, 2]),
+        int64_tensor("half_head_size", [head_size // 2]),
+        int64_tensor("int64_max", [np.iinfo(np.int64).max]),
+        int64_tensor("total_length", [total_sequence_length]),
+        int64_tensor("q_shape", [0, 0, -1, head_size]),
+        int64_tensor("kv_shape", [0, 0, kv_num_heads, head_size]),
+        int64_tensor("repeat_shape_5d", [batch_size, kv_num_heads, n_rep, total_sequence_length, head_size]),
+        int64_tensor("repeat_shape_4d", [batch_size, num_heads, total_sequence_length, head_size]),
+        int64_tensor("output_shape", [0, 0, hidden_size]),
+    ]
+
+    present_shape = [batch_size, kv_num_heads, total_sequence_length, head_size]
+    inputs = [
+        helper.make_tensor_value_info("input_ids", TensorProto.INT64, [batch_size, sequence_length]),
+        helper.make_tensor_value_info("attention_mask", TensorProto.INT64, [batch_size, total_sequence_length]),
+        helper.make_tensor_value_info("position_ids", TensorProto.INT64, [batch_size, sequence_length]),
+    ]
+    if has_past:
+        past_shape = [batch_size, kv_num_heads, past_sequence_length, head_size]
+        inputs.append(helper.make_tensor_value_info("past_key", TensorProto.FLOAT, past_shape))
+        inputs.append(helper.make_tensor_value_info("past_value", TensorProto.FLOAT, past_shape))
+    outputs = [
+        helper.make_tensor_value_info("output", TensorProto.FLOAT, [batch_size, sequence_length, hidden_size]),
+        helper.make_tensor_value_info("present_key", TensorProto.FLOAT, present_shape),
+        helper.make_tensor_value_info("present_value", TensorProto.FLOAT, present_shape),
+    ]
+
+    graph = helper.make_graph(nodes, "LlamaAttention", inputs, outputs, initializers)
+    return helper.make_model(graph, opset_imports=[helper.make_opsetid("", 13)])
+
+
+if __name__ == "__main__":
+    model = create_llama_attention()
+    onnx.save(model, "llama_attention.onnx")
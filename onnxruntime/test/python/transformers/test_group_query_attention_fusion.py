@@ -0,0 +1,68 @@
+# -------------------------------------------------------------------------
+# Copyright (c) Microsoft Corporation.  All rights reserved.
+# Licensed under the MIT License.  See License.txt in the project root for
+# license information.
+# --------------------------------------------------------------------------
+
+import unittest
+
+from llama_model_generator import create_llama_attention
+from parity_utilities import find_transformers_source
+
+if find_transformers_source():
+    from onnx_model import OnnxModel
+    from optimizer import optimize_by_fusion
+else:
+    from onnxruntime.transformers.onnx_model import OnnxModel
+    from onnxruntime.transformers.optimizer import optimize_by_fusion
+
+
+class TestGroupQueryAttentionFusion(unittest.TestCase):
+    def verify_fusion(self, model, num_heads, kv_num_heads, has_past):
+        optimized_model = optimize_by_fusion(model, model_type="llama")
+
+        op_count = optimized_model.get_fused_operator_statistics()
+        self.assertEqual(op_count["RotaryEmbedding"], 2)
+        self.assertEqual(op_count["GroupQueryAttention"], 1)
+        for op_type in ["Softmax", "Concat", "Neg", "Transpose"]:
+            self.assertEqual(len(optimized_model.get_nodes_by_op_type(op_type)), 0)
+
+        gqa_node = optimized_model.get_nodes_by_op_type("GroupQueryAttention")[0]
+        self.assertEqual(OnnxModel.get_node_attribute(gqa_node, "num_heads"), num_heads)
+        self.assertEqual(OnnxModel.get_node_attribute(gqa_node, "kv_num_heads"), kv_num_heads)
+        self.assertIsNone(OnnxModel.get_node_attribute(gqa_node, "scale"))
+        self.assertEqual(list(gqa_node.output), ["attention", "present_key", "present_value"])
+        if has_past:
+            self.assertEqual(list(gqa_node.input[3:5]), ["past_key", "past_value"])
+        else:
+            self.assertEqual(list(gqa_node.input[3:5]), ["", ""])
+
+        # Query and key are rotated in the layout of the projections with the half tables of cos and sin.
+        for rotary_node in optimized_model.get_nodes_by_op_type("RotaryEmbedding"):
+            self.assertIn(rotary_node.input[0], ["q_proj_out", "k_proj_out"])
+            self.assertEqual(rotary_node.input[1], "position_ids")
+            self.assertEqual(list(optimized_model.get_initializer(rotary_node.input[2]).dims), [32, 4])
+
+        graph_inputs = [graph_input.name for graph_input in optimized_model.model.graph.input]
+        self.assertIn("attention_mask", graph_inputs)
+
+    def test_decoding(self):
+        model = create_llama_attention(sequence_length=1, past_sequence_length=5, num_heads=4, kv_num_heads=2)
+        self.verify_fusion(model, 4, 2, True)
+
+    def test_prompt(self):
+        model = create_llama_attention(sequence_length=6, past_sequence_length=0, num_heads=4, kv_num_heads=2)
+        self.verify_fusion(model, 4, 2, False)
+
+    def test_multi_query(self):
+        model = create_llama_attention(sequence_length=3, past_sequence_length=4, num_heads=4, kv_num_heads=1)
+        self.verify_fusion(model, 4, 1, True)
+
+    def test_multi_head(self):
+        # Without groups there is no repeat of key and value.
+        model = create_llama_attention(sequence_length=1, past_sequence_length=2, num_heads=2, kv_num_heads=2)
+        self.verify_fusion(model, 2, 2, True)
+
+
+if __name__ == "__main__":
+    unittest.main()